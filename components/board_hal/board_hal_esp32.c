@@ -0,0 +1,231 @@
+/**
+ * @file board_hal_esp32.c
+ * @brief 板级硬件抽象层芯片后端：转发到 gpio/ledc/led_strip/esp_pm 驱动
+ */
+
+#include "board_hal.h"
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "soc/gpio_reg.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "led_strip.h"
+
+static const char *TAG = "BOARD_HAL";
+
+#define BOARD_HAL_LED_RMT_RESOLUTION_HZ 10000000    // WS2812 RMT时钟 10MHz
+#define BOARD_HAL_PWM_SPEED_MODE        LEDC_LOW_SPEED_MODE
+
+// ==================== 静态变量 ====================
+
+static uint32_t s_pwm_configured = 0;      // 已配置的PWM通道位图
+
+// ==================== GPIO ====================
+
+esp_err_t board_hal_gpio_config(const board_hal_gpio_config_t *config)
+{
+    if (config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    gpio_config_t io_conf = {
+        .pin_bit_mask = config->pin_bit_mask,
+        .mode = config->mode == BOARD_HAL_GPIO_MODE_OUTPUT ? GPIO_MODE_OUTPUT :
+                config->mode == BOARD_HAL_GPIO_MODE_INPUT ? GPIO_MODE_INPUT : GPIO_MODE_DISABLE,
+        .pull_up_en = config->pull_up_en ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE,
+        .pull_down_en = config->pull_down_en ? GPIO_PULLDOWN_ENABLE : GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    return gpio_config(&io_conf);
+}
+
+esp_err_t board_hal_gpio_reset_pin(int pin)
+{
+    return gpio_reset_pin(pin);
+}
+
+esp_err_t board_hal_gpio_set_direction(int pin, board_hal_gpio_mode_t mode)
+{
+    gpio_mode_t gpio_mode = mode == BOARD_HAL_GPIO_MODE_OUTPUT ? GPIO_MODE_OUTPUT :
+                            mode == BOARD_HAL_GPIO_MODE_INPUT ? GPIO_MODE_INPUT : GPIO_MODE_DISABLE;
+    return gpio_set_direction(pin, gpio_mode);
+}
+
+esp_err_t board_hal_gpio_pullup_en(int pin)
+{
+    return gpio_pullup_en(pin);
+}
+
+esp_err_t board_hal_gpio_set_level(int pin, uint32_t level)
+{
+    return gpio_set_level(pin, level);
+}
+
+int board_hal_gpio_get_level(int pin)
+{
+    return gpio_get_level(pin);
+}
+
+void board_hal_gpio_write_mask(uint64_t high_mask, uint64_t low_mask)
+{
+    // GPIO0-31和GPIO32-48各一次寄存器写入
+    if ((uint32_t)high_mask != 0) {
+        REG_WRITE(GPIO_OUT_W1TS_REG, (uint32_t)high_mask);
+    }
+    if ((uint32_t)low_mask != 0) {
+        REG_WRITE(GPIO_OUT_W1TC_REG, (uint32_t)low_mask);
+    }
+    if ((uint32_t)(high_mask >> 32) != 0) {
+        REG_WRITE(GPIO_OUT1_W1TS_REG, (uint32_t)(high_mask >> 32));
+    }
+    if ((uint32_t)(low_mask >> 32) != 0) {
+        REG_WRITE(GPIO_OUT1_W1TC_REG, (uint32_t)(low_mask >> 32));
+    }
+}
+
+void board_hal_gpio_keep_in_sleep(int pin)
+{
+    gpio_sleep_sel_dis(pin);
+}
+
+// ==================== PWM ====================
+
+esp_err_t board_hal_pwm_init(uint32_t channel, int pin, uint32_t freq_hz, uint32_t resolution_bits)
+{
+    if (channel >= BOARD_HAL_PWM_CHANNELS || channel >= LEDC_TIMER_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ledc_timer_config_t ledc_timer = {
+        .duty_resolution = (ledc_timer_bit_t)resolution_bits,
+        .freq_hz = freq_hz,
+        .speed_mode = BOARD_HAL_PWM_SPEED_MODE,
+        .timer_num = (ledc_timer_t)channel,
+        .clk_cfg = LEDC_AUTO_CLK,
+    };
+    esp_err_t ret = ledc_timer_config(&ledc_timer);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ledc_channel_config_t ledc_channel = {
+        .channel = (ledc_channel_t)channel,
+        .duty = 0,
+        .gpio_num = pin,
+        .speed_mode = BOARD_HAL_PWM_SPEED_MODE,
+        .timer_sel = (ledc_timer_t)channel,
+        .intr_type = LEDC_INTR_DISABLE
+    };
+    ret = ledc_channel_config(&ledc_channel);
+    if (ret == ESP_OK) {
+        s_pwm_configured |= 1u << channel;
+    }
+    return ret;
+}
+
+esp_err_t board_hal_pwm_set_duty(uint32_t channel, uint32_t duty)
+{
+    if (channel >= BOARD_HAL_PWM_CHANNELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if ((s_pwm_configured & (1u << channel)) == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ledc_set_duty(BOARD_HAL_PWM_SPEED_MODE, (ledc_channel_t)channel, duty);
+    if (ret == ESP_OK) {
+        ret = ledc_update_duty(BOARD_HAL_PWM_SPEED_MODE, (ledc_channel_t)channel);
+    }
+    return ret;
+}
+
+// ==================== WS2812灯带 ====================
+
+esp_err_t board_hal_led_strip_new(int pin, uint32_t num_leds, board_hal_led_strip_t *strip)
+{
+    if (strip == NULL || num_leds == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = pin,
+        .max_leds = num_leds,
+    };
+    led_strip_rmt_config_t rmt_config = {
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = BOARD_HAL_LED_RMT_RESOLUTION_HZ,
+        .flags.with_dma = false,
+    };
+
+    led_strip_handle_t handle = NULL;
+    esp_err_t ret = led_strip_new_rmt_device(&strip_config, &rmt_config, &handle);
+    *strip = (board_hal_led_strip_t)handle;
+    return ret;
+}
+
+esp_err_t board_hal_led_strip_set_pixel(board_hal_led_strip_t strip, uint32_t index,
+                                        uint32_t red, uint32_t green, uint32_t blue)
+{
+    if (strip == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return led_strip_set_pixel((led_strip_handle_t)strip, index, red, green, blue);
+}
+
+esp_err_t board_hal_led_strip_refresh(board_hal_led_strip_t strip)
+{
+    if (strip == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return led_strip_refresh((led_strip_handle_t)strip);
+}
+
+esp_err_t board_hal_led_strip_clear(board_hal_led_strip_t strip)
+{
+    if (strip == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return led_strip_clear((led_strip_handle_t)strip);
+}
+
+esp_err_t board_hal_led_strip_del(board_hal_led_strip_t strip)
+{
+    if (strip == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return led_strip_del((led_strip_handle_t)strip);
+}
+
+// ==================== PM锁 ====================
+
+esp_err_t board_hal_pm_lock_create(board_hal_pm_lock_type_t type, const char *name, board_hal_pm_lock_t *lock)
+{
+    if (lock == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 未启用CONFIG_PM_ENABLE时创建失败，句柄保持NULL，加锁操作直接跳过
+    esp_pm_lock_handle_t handle = NULL;
+    esp_err_t ret = esp_pm_lock_create(type == BOARD_HAL_PM_CPU_FREQ_MAX ? ESP_PM_CPU_FREQ_MAX : ESP_PM_NO_LIGHT_SLEEP,
+                                       0, name, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGD(TAG, "PM lock '%s' unavailable: %s", name, esp_err_to_name(ret));
+        handle = NULL;
+    }
+    *lock = (board_hal_pm_lock_t)handle;
+    return ret;
+}
+
+void board_hal_pm_lock_acquire(board_hal_pm_lock_t lock)
+{
+    if (lock != NULL) {
+        esp_pm_lock_acquire((esp_pm_lock_handle_t)lock);
+    }
+}
+
+void board_hal_pm_lock_release(board_hal_pm_lock_t lock)
+{
+    if (lock != NULL) {
+        esp_pm_lock_release((esp_pm_lock_handle_t)lock);
+    }
+}
@@ -0,0 +1,556 @@
+/**
+ * @file board_hal_sim.c
+ * @brief 板级硬件抽象层仿真后端（Linux目标）
+ */
+
+#include "board_hal.h"
+#include "board_hal_sim.h"
+#include "board_hal_time.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+
+static const char *TAG = "BOARD_HAL_SIM";
+
+#define BOARD_HAL_SIM_EDGE_MASK     (BOARD_HAL_SIM_EDGE_LOG_LEN - 1)
+
+_Static_assert((BOARD_HAL_SIM_EDGE_LOG_LEN & BOARD_HAL_SIM_EDGE_MASK) == 0, "BOARD_HAL_SIM_EDGE_LOG_LEN must be a power of two");
+
+/**
+ * @brief 虚拟GPIO
+ */
+typedef struct {
+    board_hal_gpio_mode_t mode;
+    bool pull_up;
+    bool pull_down;
+    bool driven;                // 输入电平由 board_hal_sim_set_input 驱动
+    uint8_t out_level;          // 输出寄存器
+    uint8_t in_level;           // 外部驱动的输入电平
+} sim_gpio_t;
+
+/**
+ * @brief 虚拟灯带
+ */
+struct board_hal_led_strip {
+    bool used;
+    int pin;
+    uint32_t num_leds;
+    uint8_t *pixels;            // set_pixel 写入的缓冲区
+    uint8_t *frame;             // 最近一次刷新发送的帧
+    uint32_t refresh_count;
+    int64_t last_refresh_us;
+};
+
+/**
+ * @brief 虚拟PM锁
+ */
+struct board_hal_pm_lock {
+    board_hal_pm_lock_type_t type;
+    const char *name;
+    uint32_t count;
+};
+
+// ==================== 静态变量 ====================
+
+static sim_gpio_t s_gpio[BOARD_HAL_GPIO_COUNT];
+static board_hal_sim_edge_t s_edges[BOARD_HAL_SIM_EDGE_LOG_LEN];
+static uint32_t s_edge_head = 0;           // 单调递增的写入计数
+static board_hal_sim_pwm_t s_pwm[BOARD_HAL_PWM_CHANNELS];
+static struct board_hal_led_strip s_strips[BOARD_HAL_SIM_MAX_LED_STRIPS];
+static uint32_t s_pm_held[2];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// ==================== 静态函数声明 ====================
+
+static bool pin_valid(int pin);
+static uint8_t pin_level(const sim_gpio_t *gpio);
+static void update_pin(int pin, const sim_gpio_t *next, bool external);
+
+// ==================== GPIO ====================
+
+esp_err_t board_hal_gpio_config(const board_hal_gpio_config_t *config)
+{
+    if (config == NULL || (config->pin_bit_mask >> BOARD_HAL_GPIO_COUNT) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (int pin = 0; pin < BOARD_HAL_GPIO_COUNT; pin++) {
+        if ((config->pin_bit_mask & (1ULL << pin)) == 0) {
+            continue;
+        }
+        sim_gpio_t next = s_gpio[pin];
+        next.mode = config->mode;
+        next.pull_up = config->pull_up_en;
+        next.pull_down = config->pull_down_en;
+        update_pin(pin, &next, false);
+    }
+    return ESP_OK;
+}
+
+esp_err_t board_hal_gpio_reset_pin(int pin)
+{
+    if (!pin_valid(pin)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sim_gpio_t next = s_gpio[pin];
+    next.mode = BOARD_HAL_GPIO_MODE_DISABLE;
+    next.pull_up = true;
+    next.pull_down = false;
+    update_pin(pin, &next, false);
+    return ESP_OK;
+}
+
+esp_err_t board_hal_gpio_set_direction(int pin, board_hal_gpio_mode_t mode)
+{
+    if (!pin_valid(pin)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sim_gpio_t next = s_gpio[pin];
+    next.mode = mode;
+    update_pin(pin, &next, false);
+    return ESP_OK;
+}
+
+esp_err_t board_hal_gpio_pullup_en(int pin)
+{
+    if (!pin_valid(pin)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sim_gpio_t next = s_gpio[pin];
+    next.pull_up = true;
+    update_pin(pin, &next, false);
+    return ESP_OK;
+}
+
+esp_err_t board_hal_gpio_set_level(int pin, uint32_t level)
+{
+    if (!pin_valid(pin)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sim_gpio_t next = s_gpio[pin];
+    next.out_level = level ? 1 : 0;
+    update_pin(pin, &next, false);
+    return ESP_OK;
+}
+
+int board_hal_gpio_get_level(int pin)
+{
+    if (!pin_valid(pin)) {
+        return 0;
+    }
+    return pin_level(&s_gpio[pin]);
+}
+
+void board_hal_gpio_write_mask(uint64_t high_mask, uint64_t low_mask)
+{
+    for (int pin = 0; pin < BOARD_HAL_GPIO_COUNT; pin++) {
+        uint64_t bit = 1ULL << pin;
+        if ((high_mask | low_mask) & bit) {
+            sim_gpio_t next = s_gpio[pin];
+            next.out_level = (high_mask & bit) ? 1 : 0;
+            update_pin(pin, &next, false);
+        }
+    }
+}
+
+void board_hal_gpio_keep_in_sleep(int pin)
+{
+    (void)pin;  // 仿真中没有睡眠
+}
+
+// ==================== PWM ====================
+
+esp_err_t board_hal_pwm_init(uint32_t channel, int pin, uint32_t freq_hz, uint32_t resolution_bits)
+{
+    if (channel >= BOARD_HAL_PWM_CHANNELS || !pin_valid(pin) || freq_hz == 0 ||
+        resolution_bits == 0 || resolution_bits > 20) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_pwm[channel] = (board_hal_sim_pwm_t) {
+        .configured = true,
+        .pin = pin,
+        .freq_hz = freq_hz,
+        .resolution_bits = resolution_bits,
+    };
+    portEXIT_CRITICAL(&s_lock);
+
+    ESP_LOGI(TAG, "PWM channel %" PRIu32 " on GPIO%d: %" PRIu32 " Hz, %" PRIu32 " bit",
+             channel, pin, freq_hz, resolution_bits);
+    return ESP_OK;
+}
+
+esp_err_t board_hal_pwm_set_duty(uint32_t channel, uint32_t duty)
+{
+    if (channel >= BOARD_HAL_PWM_CHANNELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&s_lock);
+    if (!s_pwm[channel].configured) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else if (duty >= (1u << s_pwm[channel].resolution_bits)) {
+        ret = ESP_ERR_INVALID_ARG;
+    } else {
+        s_pwm[channel].duty = duty;
+        s_pwm[channel].updates++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return ret;
+}
+
+// ==================== WS2812灯带 ====================
+
+esp_err_t board_hal_led_strip_new(int pin, uint32_t num_leds, board_hal_led_strip_t *strip)
+{
+    if (strip == NULL || num_leds == 0 || !pin_valid(pin)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    board_hal_led_strip_t slot = NULL;
+    for (int i = 0; i < BOARD_HAL_SIM_MAX_LED_STRIPS; i++) {
+        if (!s_strips[i].used) {
+            slot = &s_strips[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint8_t *pixels = calloc(num_leds, 3);
+    uint8_t *frame = calloc(num_leds, 3);
+    if (pixels == NULL || frame == NULL) {
+        free(pixels);
+        free(frame);
+        return ESP_ERR_NO_MEM;
+    }
+
+    *slot = (struct board_hal_led_strip) {
+        .used = true,
+        .pin = pin,
+        .num_leds = num_leds,
+        .pixels = pixels,
+        .frame = frame,
+    };
+    *strip = slot;
+
+    ESP_LOGI(TAG, "LED strip on GPIO%d: %" PRIu32 " LEDs", pin, num_leds);
+    return ESP_OK;
+}
+
+esp_err_t board_hal_led_strip_set_pixel(board_hal_led_strip_t strip, uint32_t index,
+                                        uint32_t red, uint32_t green, uint32_t blue)
+{
+    if (strip == NULL || !strip->used || index >= strip->num_leds) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t *pixel = &strip->pixels[index * 3];
+    pixel[0] = (uint8_t)red;
+    pixel[1] = (uint8_t)green;
+    pixel[2] = (uint8_t)blue;
+    return ESP_OK;
+}
+
+esp_err_t board_hal_led_strip_refresh(board_hal_led_strip_t strip)
+{
+    if (strip == NULL || !strip->used) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    memcpy(strip->frame, strip->pixels, strip->num_leds * 3);
+    strip->refresh_count++;
+    strip->last_refresh_us = board_hal_time_get_us();
+    portEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+esp_err_t board_hal_led_strip_clear(board_hal_led_strip_t strip)
+{
+    if (strip == NULL || !strip->used) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 与 led_strip_clear 一致：清空缓冲区并立即发送
+    memset(strip->pixels, 0, strip->num_leds * 3);
+    return board_hal_led_strip_refresh(strip);
+}
+
+esp_err_t board_hal_led_strip_del(board_hal_led_strip_t strip)
+{
+    if (strip == NULL || !strip->used) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    free(strip->pixels);
+    free(strip->frame);
+    memset(strip, 0, sizeof(*strip));
+    return ESP_OK;
+}
+
+// ==================== PM锁 ====================
+
+esp_err_t board_hal_pm_lock_create(board_hal_pm_lock_type_t type, const char *name, board_hal_pm_lock_t *lock)
+{
+    if (lock == NULL || type > BOARD_HAL_PM_NO_LIGHT_SLEEP) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    board_hal_pm_lock_t new_lock = calloc(1, sizeof(*new_lock));
+    if (new_lock == NULL) {
+        *lock = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    new_lock->type = type;
+    new_lock->name = name;
+    *lock = new_lock;
+    return ESP_OK;
+}
+
+void board_hal_pm_lock_acquire(board_hal_pm_lock_t lock)
+{
+    if (lock == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    lock->count++;
+    s_pm_held[lock->type]++;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void board_hal_pm_lock_release(board_hal_pm_lock_t lock)
+{
+    if (lock == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    if (lock->count > 0) {
+        lock->count--;
+        s_pm_held[lock->type]--;
+    } else {
+        ESP_LOGW(TAG, "PM lock '%s' released more times than acquired", lock->name);
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+// ==================== 仿真检查接口 ====================
+
+esp_err_t board_hal_sim_set_input(int pin, int level)
+{
+    if (!pin_valid(pin)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sim_gpio_t next = s_gpio[pin];
+    next.driven = true;
+    next.in_level = level ? 1 : 0;
+    update_pin(pin, &next, true);
+    return ESP_OK;
+}
+
+board_hal_gpio_mode_t board_hal_sim_get_mode(int pin)
+{
+    if (!pin_valid(pin)) {
+        return BOARD_HAL_GPIO_MODE_DISABLE;
+    }
+    return s_gpio[pin].mode;
+}
+
+uint32_t board_hal_sim_get_edge_count(void)
+{
+    return s_edge_head;
+}
+
+esp_err_t board_hal_sim_get_edge(uint32_t seq, board_hal_sim_edge_t *edge)
+{
+    if (edge == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&s_lock);
+    if (seq >= s_edge_head || s_edge_head - seq > BOARD_HAL_SIM_EDGE_LOG_LEN) {
+        ret = ESP_ERR_NOT_FOUND;
+    } else {
+        *edge = s_edges[seq & BOARD_HAL_SIM_EDGE_MASK];
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return ret;
+}
+
+void board_hal_sim_clear_edges(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_edge_head = 0;
+    memset(s_edges, 0, sizeof(s_edges));
+    portEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t board_hal_sim_get_pwm(uint32_t channel, board_hal_sim_pwm_t *pwm)
+{
+    if (channel >= BOARD_HAL_PWM_CHANNELS || pwm == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    *pwm = s_pwm[channel];
+    portEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+esp_err_t board_hal_sim_get_led_frame(int pin, board_hal_sim_led_frame_t *frame)
+{
+    if (frame == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (int i = 0; i < BOARD_HAL_SIM_MAX_LED_STRIPS; i++) {
+        const struct board_hal_led_strip *strip = &s_strips[i];
+        if (strip->used && strip->pin == pin) {
+            portENTER_CRITICAL(&s_lock);
+            *frame = (board_hal_sim_led_frame_t) {
+                .pin = strip->pin,
+                .num_leds = strip->num_leds,
+                .refresh_count = strip->refresh_count,
+                .last_refresh_us = strip->last_refresh_us,
+                .rgb = strip->frame,
+            };
+            portEXIT_CRITICAL(&s_lock);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+uint32_t board_hal_sim_get_pm_lock_count(board_hal_pm_lock_type_t type)
+{
+    if (type > BOARD_HAL_PM_NO_LIGHT_SLEEP) {
+        return 0;
+    }
+    return s_pm_held[type];
+}
+
+void board_hal_sim_print_state(void)
+{
+    static const char *mode_names[] = { "禁用", "输入", "输出" };
+
+    printf("\n=== 仿真外设状态 ===\n");
+    board_hal_sim_clock_stats_t clock;
+    board_hal_sim_clock_get_stats(&clock);
+    printf("时钟: %s t=%" PRId64 " ms, 虚拟跳过 %" PRId64 " ms, 跳变 %" PRIu32 " 次, 唤醒 %" PRIu32 " 次, 等待中 %d\n",
+           board_hal_sim_clock_mode_name(clock.mode), clock.now_us / 1000, clock.virtual_us / 1000,
+           clock.jumps, clock.wakeups, clock.sleepers);
+    printf("GPIO:\n");
+    for (int pin = 0; pin < BOARD_HAL_GPIO_COUNT; pin++) {
+        const sim_gpio_t *gpio = &s_gpio[pin];
+        if (gpio->mode == BOARD_HAL_GPIO_MODE_DISABLE && !gpio->driven && gpio->out_level == 0) {
+            continue;
+        }
+        printf("  GPIO%-2d %s 电平=%d%s%s\n", pin, mode_names[gpio->mode], pin_level(gpio),
+               gpio->pull_up ? " 上拉" : "", gpio->driven ? " (外部驱动)" : "");
+    }
+
+    printf("PWM:\n");
+    for (int channel = 0; channel < BOARD_HAL_PWM_CHANNELS; channel++) {
+        const board_hal_sim_pwm_t *pwm = &s_pwm[channel];
+        if (!pwm->configured) {
+            continue;
+        }
+        uint32_t max_duty = (1u << pwm->resolution_bits) - 1;
+        printf("  通道%d GPIO%d %" PRIu32 "Hz 占空比=%" PRIu32 "/%" PRIu32 " (%" PRIu32 "%%) 更新%" PRIu32 "次\n",
+               channel, pwm->pin, pwm->freq_hz, pwm->duty, max_duty,
+               max_duty > 0 ? pwm->duty * 100 / max_duty : 0, pwm->updates);
+    }
+
+    printf("灯带:\n");
+    for (int i = 0; i < BOARD_HAL_SIM_MAX_LED_STRIPS; i++) {
+        const struct board_hal_led_strip *strip = &s_strips[i];
+        if (!strip->used) {
+            continue;
+        }
+        printf("  GPIO%d %" PRIu32 "颗 刷新%" PRIu32 "次 帧:", strip->pin, strip->num_leds, strip->refresh_count);
+        for (uint32_t led = 0; led < strip->num_leds; led++) {
+            const uint8_t *rgb = &strip->frame[led * 3];
+            printf(" %02x%02x%02x", rgb[0], rgb[1], rgb[2]);
+        }
+        printf("\n");
+    }
+
+    printf("PM锁: 最高频率 %" PRIu32 ", 禁止浅睡眠 %" PRIu32 "\n",
+           s_pm_held[BOARD_HAL_PM_CPU_FREQ_MAX], s_pm_held[BOARD_HAL_PM_NO_LIGHT_SLEEP]);
+    printf("GPIO跳变: %" PRIu32 " 条\n", s_edge_head);
+    printf("================\n");
+}
+
+void board_hal_sim_print_edges(uint32_t count)
+{
+    uint32_t head = s_edge_head;
+    uint32_t kept = head < BOARD_HAL_SIM_EDGE_LOG_LEN ? head : BOARD_HAL_SIM_EDGE_LOG_LEN;
+    if (count == 0 || count > kept) {
+        count = kept;
+    }
+
+    printf("\n=== GPIO跳变 (最近%" PRIu32 "条, 共%" PRIu32 "条) ===\n", count, head);
+    printf("%8s %14s %6s %4s\n", "序号", "时间(us)", "GPIO", "电平");
+    for (uint32_t seq = head - count; seq < head; seq++) {
+        board_hal_sim_edge_t edge;
+        if (board_hal_sim_get_edge(seq, &edge) != ESP_OK) {
+            continue;
+        }
+        printf("%8" PRIu32 " %14" PRId64 " %6d %4d%s\n", seq, edge.time_us, edge.pin, edge.level,
+               edge.external ? "  (外部)" : "");
+    }
+    printf("================\n");
+}
+
+// ==================== 静态函数实现 ====================
+
+static bool pin_valid(int pin)
+{
+    return pin >= 0 && pin < BOARD_HAL_GPIO_COUNT;
+}
+
+static uint8_t pin_level(const sim_gpio_t *gpio)
+{
+    // 输出引脚读回输出寄存器；输入引脚未被外部驱动时由上下拉决定
+    switch (gpio->mode) {
+        case BOARD_HAL_GPIO_MODE_OUTPUT:
+            return gpio->out_level;
+        case BOARD_HAL_GPIO_MODE_INPUT:
+            if (gpio->driven) {
+                return gpio->in_level;
+            }
+            return gpio->pull_up && !gpio->pull_down ? 1 : 0;
+        default:
+            return 0;
+    }
+}
+
+static void update_pin(int pin, const sim_gpio_t *next, bool external)
+{
+    portENTER_CRITICAL(&s_lock);
+    uint8_t before = pin_level(&s_gpio[pin]);
+    s_gpio[pin] = *next;
+    uint8_t after = pin_level(&s_gpio[pin]);
+
+    if (before != after) {
+        board_hal_sim_edge_t *edge = &s_edges[s_edge_head & BOARD_HAL_SIM_EDGE_MASK];
+        edge->time_us = board_hal_time_get_us();
+        edge->pin = (uint8_t)pin;
+        edge->level = after;
+        edge->external = external;
+        s_edge_head++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,408 @@
+/**
+ * @file board_hal_sim_clock.c
+ * @brief 板级硬件抽象层仿真后端的时间源与虚拟时钟（Linux目标）
+ */
+
+#include "board_hal_time.h"
+#include "board_hal_sim.h"
+#include <stdio.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "BOARD_HAL_CLOCK";
+
+#define CLOCK_TASK_STACK_SIZE       2048
+#define CLOCK_TICK_US               (1000000 / configTICK_RATE_HZ)
+
+/**
+ * @brief 虚拟时钟下的一个等待任务
+ */
+typedef struct {
+    TaskHandle_t task;          // NULL表示空闲槽位
+    int64_t wake_us;
+    uint32_t seq;               // 同一时刻到期时按登记顺序唤醒
+    bool notify;                // true: 以通知位唤醒，false: 释放信号量
+    bool fired;
+    SemaphoreHandle_t sem;
+    StaticSemaphore_t sem_buffer;
+} sim_sleeper_t;
+
+// ==================== 静态变量 ====================
+
+static portMUX_TYPE s_clock_lock = portMUX_INITIALIZER_UNLOCKED;
+static board_hal_sim_clock_mode_t s_mode = BOARD_HAL_SIM_CLOCK_DEFAULT_MODE;
+static int64_t s_now_us = 0;                // 虚拟模式下的当前时间
+static int64_t s_offset_us = 0;             // 真实模式下相对 esp_timer 的偏移，保证切换后时间连续
+static int64_t s_step_target_us = 0;        // STEP模式下允许前进到的时间
+static int64_t s_virtual_us = 0;
+static uint32_t s_jumps = 0;
+static uint32_t s_wakeups = 0;
+static uint32_t s_sleeper_seq = 0;
+static sim_sleeper_t s_sleepers[BOARD_HAL_SIM_CLOCK_MAX_SLEEPERS];
+static TaskHandle_t s_clock_task = NULL;
+
+// ==================== 静态函数声明 ====================
+
+static int64_t now_locked(void);
+static esp_err_t ensure_clock_task(void);
+static int add_sleeper(int64_t wake_us, bool notify);
+static void remove_sleeper(int slot);
+static void wake_sleeper(TaskHandle_t task, SemaphoreHandle_t sem);
+static void sleep_until(int64_t wake_us);
+static TickType_t us_to_ticks_ceil(int64_t us);
+static void clock_task(void *arg);
+
+// ==================== 时间源 ====================
+
+int64_t board_hal_time_get_us(void)
+{
+    portENTER_CRITICAL(&s_clock_lock);
+    int64_t now = now_locked();
+    portEXIT_CRITICAL(&s_clock_lock);
+    return now;
+}
+
+TickType_t board_hal_time_get_ticks(void)
+{
+    return (TickType_t)(board_hal_time_get_us() / CLOCK_TICK_US);
+}
+
+void board_hal_time_delay_ms(uint32_t ms)
+{
+    if (ms == 0) {
+        taskYIELD();
+        return;
+    }
+    sleep_until(board_hal_time_get_us() + (int64_t)ms * 1000);
+}
+
+void board_hal_time_delay_until(TickType_t *last_wake, TickType_t period)
+{
+    *last_wake += period;
+    int32_t remaining = (int32_t)(*last_wake - board_hal_time_get_ticks());
+    if (remaining > 0) {
+        sleep_until(board_hal_time_get_us() + (int64_t)remaining * CLOCK_TICK_US);
+    }
+}
+
+BaseType_t board_hal_time_notify_wait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                                      uint32_t *value, TickType_t timeout)
+{
+    int64_t deadline = timeout == portMAX_DELAY ? INT64_MAX :
+                       board_hal_time_get_us() + (int64_t)timeout * CLOCK_TICK_US;
+    uint32_t entry_mask = clear_on_entry | BOARD_HAL_TIME_NOTIFY_TIMEOUT_BIT;
+
+    while (true) {
+        int64_t now = board_hal_time_get_us();
+        int slot = -1;
+        TickType_t wait;
+        if (deadline == INT64_MAX) {
+            wait = portMAX_DELAY;
+        } else if (now >= deadline) {
+            wait = 0;
+        } else if (board_hal_sim_clock_get_mode() == BOARD_HAL_SIM_CLOCK_REAL) {
+            wait = us_to_ticks_ceil(deadline - now);
+        } else {
+            slot = add_sleeper(deadline, true);
+            wait = slot >= 0 ? portMAX_DELAY : 1;
+        }
+
+        uint32_t bits = 0;
+        BaseType_t notified = xTaskNotifyWait(entry_mask, clear_on_exit | BOARD_HAL_TIME_NOTIFY_TIMEOUT_BIT,
+                                              &bits, wait);
+        if (slot >= 0) {
+            remove_sleeper(slot);
+        }
+        // 之后的重试只清除超时位，不能丢掉调用者的通知
+        entry_mask = BOARD_HAL_TIME_NOTIFY_TIMEOUT_BIT;
+
+        bits &= ~BOARD_HAL_TIME_NOTIFY_TIMEOUT_BIT;
+        if (notified == pdTRUE && bits != 0) {
+            if (value != NULL) {
+                *value = bits;
+            }
+            return pdTRUE;
+        }
+        if (wait == 0) {
+            return pdFALSE;
+        }
+    }
+}
+
+// ==================== 虚拟时钟 ====================
+
+esp_err_t board_hal_sim_clock_set_mode(board_hal_sim_clock_mode_t mode)
+{
+    if (mode > BOARD_HAL_SIM_CLOCK_STEP) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (mode != BOARD_HAL_SIM_CLOCK_REAL) {
+        esp_err_t ret = ensure_clock_task();
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    TaskHandle_t tasks[BOARD_HAL_SIM_CLOCK_MAX_SLEEPERS];
+    SemaphoreHandle_t sems[BOARD_HAL_SIM_CLOCK_MAX_SLEEPERS];
+    int count = 0;
+
+    portENTER_CRITICAL(&s_clock_lock);
+    int64_t now = now_locked();
+    if (mode == BOARD_HAL_SIM_CLOCK_REAL) {
+        s_offset_us = now - esp_timer_get_time();
+        // 等待中的任务醒来后按剩余时间改为真实延时
+        for (int i = 0; i < BOARD_HAL_SIM_CLOCK_MAX_SLEEPERS; i++) {
+            sim_sleeper_t *sleeper = &s_sleepers[i];
+            if (sleeper->task != NULL && !sleeper->fired) {
+                sleeper->fired = true;
+                tasks[count] = sleeper->task;
+                sems[count] = sleeper->notify ? NULL : sleeper->sem;
+                count++;
+            }
+        }
+    } else {
+        s_now_us = now;
+        s_step_target_us = now;
+    }
+    board_hal_sim_clock_mode_t old_mode = s_mode;
+    s_mode = mode;
+    portEXIT_CRITICAL(&s_clock_lock);
+
+    for (int i = 0; i < count; i++) {
+        wake_sleeper(tasks[i], sems[i]);
+    }
+
+    if (old_mode != mode) {
+        ESP_LOGI(TAG, "Clock mode %s -> %s at %" PRId64 " us",
+                 board_hal_sim_clock_mode_name(old_mode), board_hal_sim_clock_mode_name(mode), now);
+    }
+    return ESP_OK;
+}
+
+board_hal_sim_clock_mode_t board_hal_sim_clock_get_mode(void)
+{
+    return s_mode;
+}
+
+esp_err_t board_hal_sim_clock_advance(uint64_t us)
+{
+    portENTER_CRITICAL(&s_clock_lock);
+    if (s_mode != BOARD_HAL_SIM_CLOCK_STEP) {
+        portEXIT_CRITICAL(&s_clock_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    int64_t target = s_step_target_us + (int64_t)us;
+    s_step_target_us = target;
+    portEXIT_CRITICAL(&s_clock_lock);
+
+    // 时钟任务只在其他任务都阻塞时运行，这里让出CPU直到推进完成
+    while (board_hal_sim_clock_get_mode() == BOARD_HAL_SIM_CLOCK_STEP && board_hal_time_get_us() < target) {
+        vTaskDelay(1);
+    }
+    return ESP_OK;
+}
+
+esp_err_t board_hal_sim_clock_get_stats(board_hal_sim_clock_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_clock_lock);
+    stats->mode = s_mode;
+    stats->now_us = now_locked();
+    stats->virtual_us = s_virtual_us;
+    stats->jumps = s_jumps;
+    stats->wakeups = s_wakeups;
+    stats->sleepers = 0;
+    for (int i = 0; i < BOARD_HAL_SIM_CLOCK_MAX_SLEEPERS; i++) {
+        if (s_sleepers[i].task != NULL && !s_sleepers[i].fired) {
+            stats->sleepers++;
+        }
+    }
+    portEXIT_CRITICAL(&s_clock_lock);
+    return ESP_OK;
+}
+
+const char *board_hal_sim_clock_mode_name(board_hal_sim_clock_mode_t mode)
+{
+    switch (mode) {
+        case BOARD_HAL_SIM_CLOCK_REAL:
+            return "real";
+        case BOARD_HAL_SIM_CLOCK_VIRTUAL:
+            return "virtual";
+        case BOARD_HAL_SIM_CLOCK_STEP:
+            return "step";
+        default:
+            return "invalid";
+    }
+}
+
+// ==================== 静态函数实现 ====================
+
+static int64_t now_locked(void)
+{
+    return s_mode == BOARD_HAL_SIM_CLOCK_REAL ? esp_timer_get_time() + s_offset_us : s_now_us;
+}
+
+static esp_err_t ensure_clock_task(void)
+{
+    if (s_clock_task != NULL) {
+        return ESP_OK;
+    }
+
+    // 信号量在登记等待前全部创建好，时钟任务唤醒时总能拿到有效句柄
+    for (int i = 0; i < BOARD_HAL_SIM_CLOCK_MAX_SLEEPERS; i++) {
+        if (s_sleepers[i].sem == NULL) {
+            s_sleepers[i].sem = xSemaphoreCreateBinaryStatic(&s_sleepers[i].sem_buffer);
+        }
+    }
+
+    // 空闲优先级：只有其他任务都阻塞或让出时才推进虚拟时间
+    if (xTaskCreate(clock_task, "sim_clock", CLOCK_TASK_STACK_SIZE, NULL,
+                    tskIDLE_PRIORITY, &s_clock_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create clock task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static int add_sleeper(int64_t wake_us, bool notify)
+{
+    if (ensure_clock_task() != ESP_OK) {
+        return -1;
+    }
+
+    int slot = -1;
+    portENTER_CRITICAL(&s_clock_lock);
+    for (int i = 0; i < BOARD_HAL_SIM_CLOCK_MAX_SLEEPERS; i++) {
+        if (s_sleepers[i].task == NULL) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot >= 0) {
+        sim_sleeper_t *sleeper = &s_sleepers[slot];
+        sleeper->task = xTaskGetCurrentTaskHandle();
+        sleeper->wake_us = wake_us;
+        sleeper->seq = s_sleeper_seq++;
+        sleeper->notify = notify;
+        sleeper->fired = false;
+    }
+    portEXIT_CRITICAL(&s_clock_lock);
+
+    if (slot < 0) {
+        ESP_LOGW(TAG, "Too many sleepers, falling back to polling");
+    }
+    return slot;
+}
+
+static void remove_sleeper(int slot)
+{
+    portENTER_CRITICAL(&s_clock_lock);
+    s_sleepers[slot].task = NULL;
+    portEXIT_CRITICAL(&s_clock_lock);
+}
+
+static void wake_sleeper(TaskHandle_t task, SemaphoreHandle_t sem)
+{
+    if (sem != NULL) {
+        xSemaphoreGive(sem);
+    } else {
+        xTaskNotify(task, BOARD_HAL_TIME_NOTIFY_TIMEOUT_BIT, eSetBits);
+    }
+}
+
+static void sleep_until(int64_t wake_us)
+{
+    while (true) {
+        int64_t now = board_hal_time_get_us();
+        if (now >= wake_us) {
+            return;
+        }
+
+        if (board_hal_sim_clock_get_mode() == BOARD_HAL_SIM_CLOCK_REAL) {
+            vTaskDelay(us_to_ticks_ceil(wake_us - now));
+            continue;
+        }
+
+        int slot = add_sleeper(wake_us, false);
+        if (slot < 0) {
+            vTaskDelay(1);
+            continue;
+        }
+        xSemaphoreTake(s_sleepers[slot].sem, portMAX_DELAY);
+        remove_sleeper(slot);
+    }
+}
+
+static TickType_t us_to_ticks_ceil(int64_t us)
+{
+    return (TickType_t)((us + CLOCK_TICK_US - 1) / CLOCK_TICK_US);
+}
+
+static void clock_task(void *arg)
+{
+    (void)arg;
+
+    while (true) {
+        TaskHandle_t tasks[BOARD_HAL_SIM_CLOCK_MAX_SLEEPERS];
+        SemaphoreHandle_t sems[BOARD_HAL_SIM_CLOCK_MAX_SLEEPERS];
+        int count = 0;
+
+        portENTER_CRITICAL(&s_clock_lock);
+        if (s_mode != BOARD_HAL_SIM_CLOCK_REAL) {
+            int64_t limit = s_mode == BOARD_HAL_SIM_CLOCK_VIRTUAL ? INT64_MAX : s_step_target_us;
+            int64_t earliest = INT64_MAX;
+            for (int i = 0; i < BOARD_HAL_SIM_CLOCK_MAX_SLEEPERS; i++) {
+                const sim_sleeper_t *sleeper = &s_sleepers[i];
+                if (sleeper->task != NULL && !sleeper->fired && sleeper->wake_us < earliest) {
+                    earliest = sleeper->wake_us;
+                }
+            }
+
+            int64_t next = earliest <= limit ? earliest : limit;
+            if (next != INT64_MAX && next > s_now_us) {
+                s_virtual_us += next - s_now_us;
+                s_now_us = next;
+                s_jumps++;
+            }
+
+            // 到期的任务按登记顺序唤醒
+            while (count < BOARD_HAL_SIM_CLOCK_MAX_SLEEPERS) {
+                sim_sleeper_t *first = NULL;
+                for (int i = 0; i < BOARD_HAL_SIM_CLOCK_MAX_SLEEPERS; i++) {
+                    sim_sleeper_t *sleeper = &s_sleepers[i];
+                    if (sleeper->task != NULL && !sleeper->fired && sleeper->wake_us <= s_now_us &&
+                        (first == NULL || (int32_t)(sleeper->seq - first->seq) < 0)) {
+                        first = sleeper;
+                    }
+                }
+                if (first == NULL) {
+                    break;
+                }
+                first->fired = true;
+                tasks[count] = first->task;
+                sems[count] = first->notify ? NULL : first->sem;
+                count++;
+            }
+            s_wakeups += count;
+        }
+        portEXIT_CRITICAL(&s_clock_lock);
+
+        for (int i = 0; i < count; i++) {
+            wake_sleeper(tasks[i], sems[i]);
+        }
+
+        if (count > 0) {
+            taskYIELD();
+        } else {
+            vTaskDelay(1);
+        }
+    }
+}
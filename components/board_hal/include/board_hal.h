@@ -0,0 +1,322 @@
+/**
+ * @file board_hal.h
+ * @brief ESP32S3 板级硬件抽象层
+ *
+ * 硬件控制等组件只通过本接口访问GPIO、风扇PWM、WS2812灯带、PM锁和CPU周期
+ * 计数器，不直接调用 driver/led_strip/esp_pm。按目标选择后端：
+ *   - 芯片目标 (board_hal_esp32.c): 转发到 gpio/ledc/led_strip/esp_pm 驱动
+ *   - Linux目标 (board_hal_sim.c): 虚拟GPIO（记录电平跳变）、虚拟LEDC占空比
+ *     寄存器、捕获刷新帧的灯带，PM锁只计数
+ *
+ * 仿真后端的检查接口见 board_hal_sim.h。
+ */
+
+#ifndef BOARD_HAL_H
+#define BOARD_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include "esp_timer.h"
+#else
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== 配置 ====================
+
+#define BOARD_HAL_GPIO_COUNT        49      /*!< GPIO数量 (ESP32S3: GPIO0-48) */
+#define BOARD_HAL_PWM_CHANNELS      8       /*!< PWM通道数 */
+#define BOARD_HAL_SIM_CPU_MHZ       240     /*!< 仿真后端的CPU频率 (MHz)，用于换算周期计数 */
+
+// ==================== 类型定义 ====================
+
+/**
+ * @brief GPIO模式
+ */
+typedef enum {
+    BOARD_HAL_GPIO_MODE_DISABLE = 0,    /*!< 禁用输入输出 */
+    BOARD_HAL_GPIO_MODE_INPUT,          /*!< 输入 */
+    BOARD_HAL_GPIO_MODE_OUTPUT,         /*!< 输出 */
+} board_hal_gpio_mode_t;
+
+/**
+ * @brief GPIO配置
+ */
+typedef struct {
+    uint64_t pin_bit_mask;              /*!< 引脚位掩码 */
+    board_hal_gpio_mode_t mode;         /*!< 模式 */
+    bool pull_up_en;                    /*!< 启用上拉 */
+    bool pull_down_en;                  /*!< 启用下拉 */
+} board_hal_gpio_config_t;
+
+/**
+ * @brief PM锁类型
+ */
+typedef enum {
+    BOARD_HAL_PM_CPU_FREQ_MAX = 0,      /*!< 保持最高CPU频率 */
+    BOARD_HAL_PM_NO_LIGHT_SLEEP,        /*!< 禁止浅睡眠 */
+} board_hal_pm_lock_type_t;
+
+typedef struct board_hal_led_strip *board_hal_led_strip_t;  /*!< 灯带句柄 */
+typedef struct board_hal_pm_lock *board_hal_pm_lock_t;      /*!< PM锁句柄 */
+
+// ==================== GPIO ====================
+
+/**
+ * @brief 按位掩码配置一组GPIO
+ *
+ * @param config 配置
+ * @return
+ *     - ESP_OK: 配置成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t board_hal_gpio_config(const board_hal_gpio_config_t *config);
+
+/**
+ * @brief 把GPIO恢复为默认状态（断开外设、启用上拉、禁用输入输出）
+ *
+ * @param pin GPIO编号
+ * @return
+ *     - ESP_OK: 成功
+ *     - ESP_ERR_INVALID_ARG: 引脚无效
+ */
+esp_err_t board_hal_gpio_reset_pin(int pin);
+
+/**
+ * @brief 设置GPIO方向
+ *
+ * @param pin GPIO编号
+ * @param mode 模式
+ * @return
+ *     - ESP_OK: 成功
+ *     - ESP_ERR_INVALID_ARG: 引脚无效
+ */
+esp_err_t board_hal_gpio_set_direction(int pin, board_hal_gpio_mode_t mode);
+
+/**
+ * @brief 启用GPIO上拉
+ *
+ * @param pin GPIO编号
+ * @return
+ *     - ESP_OK: 成功
+ *     - ESP_ERR_INVALID_ARG: 引脚无效
+ */
+esp_err_t board_hal_gpio_pullup_en(int pin);
+
+/**
+ * @brief 设置GPIO输出电平
+ *
+ * @param pin GPIO编号
+ * @param level 0低电平，非0高电平
+ * @return
+ *     - ESP_OK: 成功
+ *     - ESP_ERR_INVALID_ARG: 引脚无效
+ */
+esp_err_t board_hal_gpio_set_level(int pin, uint32_t level);
+
+/**
+ * @brief 读取GPIO电平
+ *
+ * @param pin GPIO编号
+ * @return 电平 (0/1)，引脚无效时返回0
+ */
+int board_hal_gpio_get_level(int pin);
+
+/**
+ * @brief 一次写入一组GPIO的输出电平
+ *
+ * 芯片目标上直接写 W1TS/W1TC 寄存器，同一组内的引脚同时变化。
+ * 引脚须已配置为输出。
+ *
+ * @param high_mask 置高的引脚位掩码
+ * @param low_mask 置低的引脚位掩码
+ */
+void board_hal_gpio_write_mask(uint64_t high_mask, uint64_t low_mask);
+
+/**
+ * @brief 浅睡眠期间保持GPIO的正常模式配置，避免睡眠时电平被切换
+ *
+ * @param pin GPIO编号
+ */
+void board_hal_gpio_keep_in_sleep(int pin);
+
+// ==================== PWM ====================
+
+/**
+ * @brief 配置PWM通道
+ *
+ * @param channel 通道号 (0 ~ BOARD_HAL_PWM_CHANNELS-1)，同时使用同号定时器
+ * @param pin 输出GPIO
+ * @param freq_hz PWM频率 (Hz)
+ * @param resolution_bits 占空比分辨率 (位)
+ * @return
+ *     - ESP_OK: 配置成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t board_hal_pwm_init(uint32_t channel, int pin, uint32_t freq_hz, uint32_t resolution_bits);
+
+/**
+ * @brief 设置并生效PWM占空比
+ *
+ * @param channel 通道号
+ * @param duty 占空比 (0 ~ 2^resolution_bits - 1)
+ * @return
+ *     - ESP_OK: 设置成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 通道未配置
+ */
+esp_err_t board_hal_pwm_set_duty(uint32_t channel, uint32_t duty);
+
+// ==================== WS2812灯带 ====================
+
+/**
+ * @brief 创建WS2812灯带
+ *
+ * @param pin 数据GPIO
+ * @param num_leds LED数量
+ * @param strip 返回的灯带句柄
+ * @return
+ *     - ESP_OK: 创建成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NO_MEM: 内存或通道不足
+ */
+esp_err_t board_hal_led_strip_new(int pin, uint32_t num_leds, board_hal_led_strip_t *strip);
+
+/**
+ * @brief 设置一个像素的颜色（写入缓冲区，刷新后生效）
+ *
+ * @param strip 灯带句柄
+ * @param index 像素序号
+ * @param red 红色分量
+ * @param green 绿色分量
+ * @param blue 蓝色分量
+ * @return
+ *     - ESP_OK: 设置成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t board_hal_led_strip_set_pixel(board_hal_led_strip_t strip, uint32_t index,
+                                        uint32_t red, uint32_t green, uint32_t blue);
+
+/**
+ * @brief 把缓冲区发送到灯带
+ *
+ * @param strip 灯带句柄
+ * @return
+ *     - ESP_OK: 刷新成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t board_hal_led_strip_refresh(board_hal_led_strip_t strip);
+
+/**
+ * @brief 熄灭全部像素
+ *
+ * @param strip 灯带句柄
+ * @return
+ *     - ESP_OK: 成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t board_hal_led_strip_clear(board_hal_led_strip_t strip);
+
+/**
+ * @brief 删除灯带，释放通道
+ *
+ * @param strip 灯带句柄
+ * @return
+ *     - ESP_OK: 删除成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t board_hal_led_strip_del(board_hal_led_strip_t strip);
+
+// ==================== PM锁 ====================
+
+/**
+ * @brief 创建PM锁
+ *
+ * @param type 锁类型
+ * @param name 名称（静态字符串）
+ * @param lock 返回的锁句柄
+ * @return
+ *     - ESP_OK: 创建成功
+ *     - ESP_ERR_NOT_SUPPORTED: 未启用电源管理，句柄置为NULL
+ *     - ESP_ERR_NO_MEM: 内存不足
+ */
+esp_err_t board_hal_pm_lock_create(board_hal_pm_lock_type_t type, const char *name, board_hal_pm_lock_t *lock);
+
+/**
+ * @brief 持有PM锁，句柄为NULL时什么也不做
+ *
+ * @param lock 锁句柄
+ */
+void board_hal_pm_lock_acquire(board_hal_pm_lock_t lock);
+
+/**
+ * @brief 释放PM锁，句柄为NULL时什么也不做
+ *
+ * @param lock 锁句柄
+ */
+void board_hal_pm_lock_release(board_hal_pm_lock_t lock);
+
+// ==================== CPU ====================
+
+#if CONFIG_IDF_TARGET_LINUX
+
+// 主机没有可用的周期计数器，按 BOARD_HAL_SIM_CPU_MHZ 由微秒时间换算，精度为1us
+static inline uint32_t board_hal_cpu_get_cycle_count(void)
+{
+    return (uint32_t)(esp_timer_get_time() * BOARD_HAL_SIM_CPU_MHZ);
+}
+
+static inline int board_hal_cpu_get_core_id(void)
+{
+    return 0;
+}
+
+static inline uint32_t board_hal_cpu_get_mhz(void)
+{
+    return BOARD_HAL_SIM_CPU_MHZ;
+}
+
+#else
+
+// 强制内联：IRAM中的调用者（如 event_trace_emit）在cache关闭时也不会跳到flash中的副本
+
+/**
+ * @brief 读取当前核心的CPU周期计数
+ */
+FORCE_INLINE_ATTR uint32_t board_hal_cpu_get_cycle_count(void)
+{
+    return esp_cpu_get_cycle_count();
+}
+
+/**
+ * @brief 获取当前核心号
+ */
+FORCE_INLINE_ATTR int board_hal_cpu_get_core_id(void)
+{
+    return esp_cpu_get_core_id();
+}
+
+/**
+ * @brief 获取当前CPU频率 (MHz)
+ */
+FORCE_INLINE_ATTR uint32_t board_hal_cpu_get_mhz(void)
+{
+    return esp_rom_get_cpu_ticks_per_us();
+}
+
+#endif /* CONFIG_IDF_TARGET_LINUX */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOARD_HAL_H */
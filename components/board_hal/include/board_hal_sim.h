@@ -0,0 +1,245 @@
+/**
+ * @file board_hal_sim.h
+ * @brief 板级硬件抽象层仿真后端的检查接口（仅Linux目标）
+ *
+ * 功能测试通过这些接口驱动输入引脚，并检查输出：GPIO电平跳变日志（带时间戳，
+ * 环形缓冲区写满后覆盖最旧记录）、PWM占空比寄存器、每条灯带最近一次刷新的帧
+ * 和PM锁持有计数。
+ *
+ * 虚拟时钟替代 board_hal_time.h 的时间源：
+ *   - REAL: 真实时间
+ *   - VIRTUAL: 所有任务都阻塞时，时间直接跳到最早的唤醒时刻
+ *   - STEP: 同VIRTUAL，但只在 board_hal_sim_clock_advance 给出的范围内前进
+ * 时钟由空闲优先级的任务推进，只有更高优先级的任务都阻塞时才前进，
+ * 因此同样的输入总是得到同样的虚拟时间线。切换模式时时间保持连续。
+ */
+
+#ifndef BOARD_HAL_SIM_H
+#define BOARD_HAL_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "board_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== 配置 ====================
+
+#define BOARD_HAL_SIM_EDGE_LOG_LEN  256     /*!< 电平跳变日志长度 */
+#define BOARD_HAL_SIM_MAX_LED_STRIPS 4      /*!< 最多仿真的灯带数 */
+#define BOARD_HAL_SIM_CLOCK_MAX_SLEEPERS 16 /*!< 虚拟时钟下同时等待的任务数上限 */
+
+#ifndef BOARD_HAL_SIM_CLOCK_DEFAULT_MODE
+#define BOARD_HAL_SIM_CLOCK_DEFAULT_MODE BOARD_HAL_SIM_CLOCK_REAL  /*!< 启动时的时钟模式 */
+#endif
+
+// ==================== 类型定义 ====================
+
+/**
+ * @brief 时钟模式
+ */
+typedef enum {
+    BOARD_HAL_SIM_CLOCK_REAL = 0,       /*!< 真实时间 */
+    BOARD_HAL_SIM_CLOCK_VIRTUAL,        /*!< 虚拟时间，空闲时自动前进 */
+    BOARD_HAL_SIM_CLOCK_STEP,           /*!< 虚拟时间，只在 advance 给出的范围内前进 */
+} board_hal_sim_clock_mode_t;
+
+/**
+ * @brief 时钟统计
+ */
+typedef struct {
+    board_hal_sim_clock_mode_t mode;    /*!< 当前模式 */
+    int64_t now_us;                     /*!< 当前时间 (us) */
+    int64_t virtual_us;                 /*!< 累计虚拟跳过的时间 (us) */
+    uint32_t jumps;                     /*!< 时间跳变次数 */
+    uint32_t wakeups;                   /*!< 唤醒的等待任务数 */
+    uint8_t sleepers;                   /*!< 当前等待中的任务数 */
+} board_hal_sim_clock_stats_t;
+
+/**
+ * @brief 一次GPIO电平跳变
+ */
+typedef struct {
+    int64_t time_us;            /*!< 跳变时间 (时间源, us)，虚拟时钟下为虚拟时间 */
+    uint8_t pin;                /*!< GPIO编号 */
+    uint8_t level;              /*!< 跳变后的电平 */
+    bool external;              /*!< true: 由 board_hal_sim_set_input 驱动的输入 */
+} board_hal_sim_edge_t;
+
+/**
+ * @brief PWM通道状态
+ */
+typedef struct {
+    bool configured;            /*!< 是否已配置 */
+    int pin;                    /*!< 输出GPIO */
+    uint32_t freq_hz;           /*!< 频率 (Hz) */
+    uint32_t resolution_bits;   /*!< 分辨率 (位) */
+    uint32_t duty;              /*!< 当前占空比寄存器值 */
+    uint32_t updates;           /*!< 占空比更新次数 */
+} board_hal_sim_pwm_t;
+
+/**
+ * @brief 灯带最近一次刷新的帧
+ */
+typedef struct {
+    int pin;                    /*!< 数据GPIO */
+    uint32_t num_leds;          /*!< LED数量 */
+    uint32_t refresh_count;     /*!< 刷新次数 */
+    int64_t last_refresh_us;    /*!< 最近一次刷新时间 (us) */
+    const uint8_t *rgb;         /*!< 帧数据，每个LED依次为R、G、B */
+} board_hal_sim_led_frame_t;
+
+// ==================== GPIO ====================
+
+/**
+ * @brief 从外部驱动输入引脚的电平（如电源正常信号）
+ *
+ * @param pin GPIO编号
+ * @param level 电平
+ * @return
+ *     - ESP_OK: 成功
+ *     - ESP_ERR_INVALID_ARG: 引脚无效
+ */
+esp_err_t board_hal_sim_set_input(int pin, int level);
+
+/**
+ * @brief 获取引脚当前模式
+ *
+ * @param pin GPIO编号
+ * @return 模式，引脚无效时返回 BOARD_HAL_GPIO_MODE_DISABLE
+ */
+board_hal_gpio_mode_t board_hal_sim_get_mode(int pin);
+
+/**
+ * @brief 获取已记录的跳变总数（单调递增，包含已被覆盖的记录）
+ *
+ * @return 跳变总数
+ */
+uint32_t board_hal_sim_get_edge_count(void);
+
+/**
+ * @brief 按序号获取一条跳变记录
+ *
+ * @param seq 序号 (0 ~ 跳变总数-1)
+ * @param edge 存储记录的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NOT_FOUND: 记录不存在或已被覆盖
+ */
+esp_err_t board_hal_sim_get_edge(uint32_t seq, board_hal_sim_edge_t *edge);
+
+/**
+ * @brief 清空跳变日志
+ */
+void board_hal_sim_clear_edges(void);
+
+// ==================== PWM / 灯带 / PM锁 ====================
+
+/**
+ * @brief 获取PWM通道状态
+ *
+ * @param channel 通道号
+ * @param pwm 存储状态的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t board_hal_sim_get_pwm(uint32_t channel, board_hal_sim_pwm_t *pwm);
+
+/**
+ * @brief 按数据引脚获取灯带最近一次刷新的帧
+ *
+ * 帧数据指针在灯带删除前有效。
+ *
+ * @param pin 数据GPIO
+ * @param frame 存储帧的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NOT_FOUND: 该引脚上没有灯带
+ */
+esp_err_t board_hal_sim_get_led_frame(int pin, board_hal_sim_led_frame_t *frame);
+
+/**
+ * @brief 获取某类PM锁当前的持有总数
+ *
+ * @param type 锁类型
+ * @return 持有总数
+ */
+uint32_t board_hal_sim_get_pm_lock_count(board_hal_pm_lock_type_t type);
+
+// ==================== 虚拟时钟 ====================
+
+/**
+ * @brief 切换时钟模式
+ *
+ * 切换到REAL时唤醒全部等待任务，剩余的等待改为真实延时。
+ *
+ * @param mode 模式
+ * @return
+ *     - ESP_OK: 切换成功
+ *     - ESP_ERR_INVALID_ARG: 模式无效
+ *     - ESP_ERR_NO_MEM: 时钟任务创建失败
+ */
+esp_err_t board_hal_sim_clock_set_mode(board_hal_sim_clock_mode_t mode);
+
+/**
+ * @brief 获取时钟模式
+ *
+ * @return 当前模式
+ */
+board_hal_sim_clock_mode_t board_hal_sim_clock_get_mode(void);
+
+/**
+ * @brief STEP模式下把虚拟时间向前推进，等到推进完成后返回
+ *
+ * 期间到期的等待任务按唤醒时刻依次运行。
+ *
+ * @param us 推进的时间 (us)
+ * @return
+ *     - ESP_OK: 推进完成
+ *     - ESP_ERR_INVALID_STATE: 不在STEP模式
+ */
+esp_err_t board_hal_sim_clock_advance(uint64_t us);
+
+/**
+ * @brief 获取时钟统计
+ *
+ * @param stats 存储统计的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t board_hal_sim_clock_get_stats(board_hal_sim_clock_stats_t *stats);
+
+/**
+ * @brief 获取时钟模式名称
+ *
+ * @param mode 模式
+ * @return 名称字符串
+ */
+const char *board_hal_sim_clock_mode_name(board_hal_sim_clock_mode_t mode);
+
+// ==================== 打印 ====================
+
+/**
+ * @brief 打印仿真外设状态：时钟、已使用的GPIO、PWM通道、灯带帧和PM锁
+ */
+void board_hal_sim_print_state(void);
+
+/**
+ * @brief 打印最近的GPIO跳变
+ *
+ * @param count 打印条数，0打印全部保留的记录
+ */
+void board_hal_sim_print_edges(uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOARD_HAL_SIM_H */
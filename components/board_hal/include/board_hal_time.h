@@ -0,0 +1,118 @@
+/**
+ * @file board_hal_time.h
+ * @brief 板级硬件抽象层时间源：延时、单调时间和节拍计数
+ *
+ * 电源时序、监控周期、配置渐变等业务逻辑通过本接口计时，不直接调用
+ * vTaskDelay / esp_timer_get_time / xTaskGetTickCount。芯片目标上是对这些
+ * 函数的内联转发；Linux目标上可切换为虚拟时钟（见 board_hal_sim.h），
+ * 所有任务都阻塞时虚拟时间直接跳到最早的唤醒时刻，数小时的监控周期和
+ * 数秒的复位时序可在毫秒内确定性地完成。
+ *
+ * 测量真实耗时（延迟统计、基准测试）仍直接使用 esp_timer_get_time。
+ */
+
+#ifndef BOARD_HAL_TIME_H
+#define BOARD_HAL_TIME_H
+
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_timer.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 虚拟时钟以任务通知唤醒 board_hal_time_notify_wait 时使用的通知位
+ *
+ * 使用 board_hal_time_notify_wait 的任务不能把该位用于其他用途。
+ */
+#define BOARD_HAL_TIME_NOTIFY_TIMEOUT_BIT   (1UL << 31)
+
+#if CONFIG_IDF_TARGET_LINUX
+
+/**
+ * @brief 获取单调时间
+ *
+ * @return 自启动以来的时间 (us)，虚拟时钟下为虚拟时间
+ */
+int64_t board_hal_time_get_us(void);
+
+/**
+ * @brief 获取节拍计数，与 board_hal_time_get_us 同源
+ *
+ * @return 节拍计数
+ */
+TickType_t board_hal_time_get_ticks(void);
+
+/**
+ * @brief 阻塞当前任务指定时间
+ *
+ * @param ms 延时 (ms)
+ */
+void board_hal_time_delay_ms(uint32_t ms);
+
+/**
+ * @brief 周期性延时，语义同 vTaskDelayUntil
+ *
+ * @param last_wake 上次唤醒的节拍，返回时更新为本次唤醒节拍
+ * @param period 周期 (节拍)
+ */
+void board_hal_time_delay_until(TickType_t *last_wake, TickType_t period);
+
+/**
+ * @brief 带超时等待任务通知，语义同 xTaskNotifyWait
+ *
+ * 只带 BOARD_HAL_TIME_NOTIFY_TIMEOUT_BIT 的通知视为超时。
+ *
+ * @param clear_on_entry 进入时清除的位
+ * @param clear_on_exit 收到通知后清除的位
+ * @param value 返回通知值，可为NULL
+ * @param timeout 超时 (节拍)，portMAX_DELAY 表示无限等待
+ * @return pdTRUE: 收到通知；pdFALSE: 超时
+ */
+BaseType_t board_hal_time_notify_wait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                                      uint32_t *value, TickType_t timeout);
+
+#else
+
+// 芯片目标直接使用 esp_timer 和 FreeRTOS
+
+static inline int64_t board_hal_time_get_us(void)
+{
+    return esp_timer_get_time();
+}
+
+static inline TickType_t board_hal_time_get_ticks(void)
+{
+    return xTaskGetTickCount();
+}
+
+static inline void board_hal_time_delay_ms(uint32_t ms)
+{
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+static inline void board_hal_time_delay_until(TickType_t *last_wake, TickType_t period)
+{
+    vTaskDelayUntil(last_wake, period);
+}
+
+static inline BaseType_t board_hal_time_notify_wait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                                                    uint32_t *value, TickType_t timeout)
+{
+    return xTaskNotifyWait(clear_on_entry, clear_on_exit, value, timeout);
+}
+
+#endif /* CONFIG_IDF_TARGET_LINUX */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOARD_HAL_TIME_H */
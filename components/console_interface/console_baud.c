@@ -0,0 +1,388 @@
+/**
+ * @file console_baud.c
+ * @brief 控制台UART波特率协商实现
+ */
+
+#include "console_baud.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "driver/uart.h"
+#endif
+
+static const char *TAG = "CONSOLE_BAUD";
+
+static const char *NVS_NAMESPACE = "console";
+static const char *NVS_KEY_BAUD = "baud_rate";
+
+// 从XTAL时钟分频得到的标准速率，2M为XTAL/20
+static const uint32_t s_supported_rates[] = {
+    115200, 230400, 460800, 921600, 1500000, 2000000
+};
+
+// ==================== 内部状态 ====================
+
+typedef struct {
+    bool initialized;
+    bool uart_driver;
+    bool persist;                   // 确认后保存到NVS
+    uint32_t target;                // 挂起的目标波特率
+    esp_timer_handle_t fallback_timer;
+    console_baud_status_t status;
+} console_baud_ctx_t;
+
+static console_baud_ctx_t s_baud = {
+    .status = { .current = CONSOLE_BAUD_DEFAULT, .previous = CONSOLE_BAUD_DEFAULT },
+};
+static portMUX_TYPE s_baud_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// ==================== 硬件 ====================
+
+// 等待已排队的输出发送完成
+static void wait_tx_done(void)
+{
+#if !CONFIG_IDF_TARGET_LINUX
+    if (s_baud.uart_driver) {
+        uart_wait_tx_done(CONFIG_ESP_CONSOLE_UART_NUM, pdMS_TO_TICKS(1000));
+    }
+#endif
+}
+
+// 切换硬件波特率并丢弃切换前后收到的残缺字节；仿真目标没有UART，只记录状态
+static void set_hw_baud(uint32_t baud)
+{
+#if !CONFIG_IDF_TARGET_LINUX
+    if (s_baud.uart_driver) {
+        uart_set_baudrate(CONFIG_ESP_CONSOLE_UART_NUM, baud);
+        uart_flush_input(CONFIG_ESP_CONSOLE_UART_NUM);
+    }
+#endif
+}
+
+// ==================== NVS ====================
+
+static esp_err_t nvs_write_baud(uint32_t baud)
+{
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ret = baud ? nvs_set_u32(nvs_handle, NVS_KEY_BAUD, baud) : nvs_erase_key(nvs_handle, NVS_KEY_BAUD);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = ESP_OK;
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save baud rate: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    s_baud.status.saved = baud;
+    return ESP_OK;
+}
+
+static uint32_t nvs_read_baud(void)
+{
+    nvs_handle_t nvs_handle;
+    uint32_t baud = 0;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) == ESP_OK) {
+        if (nvs_get_u32(nvs_handle, NVS_KEY_BAUD, &baud) != ESP_OK) {
+            baud = 0;
+        }
+        nvs_close(nvs_handle);
+    }
+    return baud;
+}
+
+// ==================== 协商 ====================
+
+// 确认期超时：对端没有在新波特率下发来有效输入，恢复原波特率
+static void fallback_timer_callback(void *arg)
+{
+    portENTER_CRITICAL(&s_baud_lock);
+    if (s_baud.status.state != CONSOLE_BAUD_STATE_CONFIRMING) {
+        portEXIT_CRITICAL(&s_baud_lock);
+        return;
+    }
+    uint32_t failed = s_baud.status.current;
+    s_baud.status.current = s_baud.status.previous;
+    s_baud.status.state = CONSOLE_BAUD_STATE_STABLE;
+    s_baud.status.fallbacks++;
+    s_baud.persist = false;
+    portEXIT_CRITICAL(&s_baud_lock);
+
+    set_hw_baud(s_baud.status.current);
+    ESP_LOGW(TAG, "No input at %" PRIu32 " baud, fell back to %" PRIu32, failed, s_baud.status.current);
+}
+
+static void start_confirm(uint32_t baud, uint32_t confirm_ms)
+{
+    set_hw_baud(baud);
+
+    portENTER_CRITICAL(&s_baud_lock);
+    s_baud.status.previous = s_baud.status.current;
+    s_baud.status.current = baud;
+    s_baud.status.confirm_ms = confirm_ms;
+    s_baud.status.state = CONSOLE_BAUD_STATE_CONFIRMING;
+    s_baud.status.switches++;
+    portEXIT_CRITICAL(&s_baud_lock);
+
+    if (s_baud.fallback_timer) {
+        esp_timer_stop(s_baud.fallback_timer);
+        esp_timer_start_once(s_baud.fallback_timer, (uint64_t)confirm_ms * 1000ULL);
+    }
+}
+
+esp_err_t console_baud_init(bool uart_driver)
+{
+    if (s_baud.initialized) {
+        return ESP_OK;
+    }
+
+    s_baud.uart_driver = uart_driver;
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = fallback_timer_callback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "console_baud",
+        .skip_unhandled_events = true,
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &s_baud.fallback_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create fallback timer: %s", esp_err_to_name(ret));
+        return ESP_ERR_NO_MEM;
+    }
+    s_baud.initialized = true;
+
+    uint32_t saved = nvs_read_baud();
+    if (saved != 0 && !console_baud_is_supported(saved)) {
+        ESP_LOGW(TAG, "Ignoring unsupported saved baud rate %" PRIu32, saved);
+        saved = 0;
+    }
+    s_baud.status.saved = saved;
+
+    // 保存的波特率也要在启动确认期内得到确认，否则回到默认值，防止对端失联
+    if (saved != 0 && saved != s_baud.status.current) {
+        start_confirm(saved, CONSOLE_BAUD_BOOT_CONFIRM_MS);
+        ESP_LOGI(TAG, "Console UART at saved %" PRIu32 " baud, falls back to %" PRIu32 " without input in %d s",
+                 saved, s_baud.status.previous, CONSOLE_BAUD_BOOT_CONFIRM_MS / 1000);
+    }
+    return ESP_OK;
+}
+
+bool console_baud_is_supported(uint32_t baud)
+{
+    if (baud == CONSOLE_BAUD_DEFAULT) {
+        return true;
+    }
+    for (size_t i = 0; i < sizeof(s_supported_rates) / sizeof(s_supported_rates[0]); i++) {
+        if (s_supported_rates[i] == baud) {
+            return baud >= CONSOLE_BAUD_DEFAULT;
+        }
+    }
+    return false;
+}
+
+size_t console_baud_get_rates(const uint32_t **rates)
+{
+    *rates = s_supported_rates;
+    return sizeof(s_supported_rates) / sizeof(s_supported_rates[0]);
+}
+
+esp_err_t console_baud_request(uint32_t baud, uint32_t confirm_ms, bool persist)
+{
+    if (!console_baud_is_supported(baud)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    portENTER_CRITICAL(&s_baud_lock);
+    if (!s_baud.initialized || s_baud.status.state != CONSOLE_BAUD_STATE_STABLE) {
+        portEXIT_CRITICAL(&s_baud_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_baud.target = baud;
+    s_baud.persist = persist;
+    s_baud.status.confirm_ms = confirm_ms ? confirm_ms : CONSOLE_BAUD_CONFIRM_MS;
+    s_baud.status.state = CONSOLE_BAUD_STATE_PENDING;
+    portEXIT_CRITICAL(&s_baud_lock);
+    return ESP_OK;
+}
+
+void console_baud_apply_pending(void)
+{
+    if (s_baud.status.state != CONSOLE_BAUD_STATE_PENDING) {
+        return;
+    }
+
+    // 应答必须以原波特率完整发出
+    wait_tx_done();
+    start_confirm(s_baud.target, s_baud.status.confirm_ms);
+    ESP_LOGD(TAG, "Switched to %" PRIu32 " baud, confirming", s_baud.target);
+}
+
+void console_baud_note_valid_input(void)
+{
+    portENTER_CRITICAL(&s_baud_lock);
+    if (s_baud.status.state != CONSOLE_BAUD_STATE_CONFIRMING) {
+        portEXIT_CRITICAL(&s_baud_lock);
+        return;
+    }
+    s_baud.status.state = CONSOLE_BAUD_STATE_STABLE;
+    s_baud.status.confirms++;
+    bool persist = s_baud.persist;
+    s_baud.persist = false;
+    portEXIT_CRITICAL(&s_baud_lock);
+
+    esp_timer_stop(s_baud.fallback_timer);
+    if (persist && s_baud.status.saved != s_baud.status.current) {
+        nvs_write_baud(s_baud.status.current);
+    }
+}
+
+esp_err_t console_baud_save(void)
+{
+    if (s_baud.status.state != CONSOLE_BAUD_STATE_STABLE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return nvs_write_baud(s_baud.status.current);
+}
+
+esp_err_t console_baud_clear_saved(void)
+{
+    return nvs_write_baud(0);
+}
+
+esp_err_t console_baud_get_status(console_baud_status_t *status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_baud_lock);
+    *status = s_baud.status;
+    portEXIT_CRITICAL(&s_baud_lock);
+    return ESP_OK;
+}
+
+// ==================== 自检 ====================
+
+// 测试数据按偏移生成，接收端无需保存已发送内容
+static inline uint8_t test_pattern(uint32_t offset)
+{
+    return (uint8_t)(offset * 151u + (offset >> 8));
+}
+
+esp_err_t console_baud_self_test(uint32_t baud, console_baud_test_result_t *result)
+{
+    if (result == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!console_baud_is_supported(baud)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+#if CONFIG_IDF_TARGET_LINUX
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    if (!s_baud.uart_driver) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (s_baud.status.state != CONSOLE_BAUD_STATE_STABLE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const uart_port_t port = CONFIG_ESP_CONSOLE_UART_NUM;
+    memset(result, 0, sizeof(*result));
+    result->baud = baud;
+    result->bytes = CONSOLE_BAUD_TEST_BYTES;
+
+    wait_tx_done();
+    uart_set_loop_back(port, true);
+    uart_set_baudrate(port, baud);
+    uart_flush_input(port);
+
+    // 边发边收：TX环形缓冲区满时写入阻塞，期间回环数据进入RX缓冲区
+    uint8_t chunk[64];
+    uint8_t rx[128];
+    uint32_t sent = 0;
+    int64_t start = esp_timer_get_time();
+    while (result->received < result->bytes) {
+        if (sent < result->bytes) {
+            uint32_t n = result->bytes - sent;
+            if (n > sizeof(chunk)) {
+                n = sizeof(chunk);
+            }
+            for (uint32_t i = 0; i < n; i++) {
+                chunk[i] = test_pattern(sent + i);
+            }
+            uart_write_bytes(port, chunk, n);
+            sent += n;
+        }
+
+        TickType_t wait = sent < result->bytes ? 0 : pdMS_TO_TICKS(100);
+        int n = uart_read_bytes(port, rx, sizeof(rx), wait);
+        if (n <= 0) {
+            if (sent >= result->bytes) {
+                break;      // 剩余字节丢失
+            }
+            continue;
+        }
+        for (int i = 0; i < n && result->received < result->bytes; i++) {
+            if (rx[i] != test_pattern(result->received)) {
+                result->errors++;
+            }
+            result->received++;
+        }
+    }
+    result->elapsed_us = (uint32_t)(esp_timer_get_time() - start);
+
+    uart_set_loop_back(port, false);
+    uart_set_baudrate(port, s_baud.status.current);
+    uart_flush_input(port);
+
+    if (result->elapsed_us > 0) {
+        result->bytes_per_sec = (uint32_t)((uint64_t)result->received * 1000000ULL / result->elapsed_us);
+    }
+    return ESP_OK;
+#endif
+}
+
+esp_err_t console_baud_print_status(void)
+{
+    static const char *state_names[] = { "已确认", "等待应答发出", "等待确认" };
+    console_baud_status_t status;
+    console_baud_get_status(&status);
+
+    printf("\n=== 控制台波特率 ===\n");
+    printf("当前波特率: %" PRIu32 " (%s)\n", status.current, state_names[status.state]);
+    if (status.state == CONSOLE_BAUD_STATE_CONFIRMING) {
+        printf("确认期: %" PRIu32 " ms，超时恢复 %" PRIu32 "\n", status.confirm_ms, status.previous);
+    }
+    if (status.saved) {
+        printf("NVS保存: %" PRIu32 "\n", status.saved);
+    } else {
+        printf("NVS保存: 无 (启动使用 %d)\n", CONSOLE_BAUD_DEFAULT);
+    }
+    printf("切换 %" PRIu32 " 次, 确认 %" PRIu32 " 次, 超时恢复 %" PRIu32 " 次\n",
+           status.switches, status.confirms, status.fallbacks);
+    printf("支持:");
+    for (size_t i = 0; i < sizeof(s_supported_rates) / sizeof(s_supported_rates[0]); i++) {
+        if (console_baud_is_supported(s_supported_rates[i])) {
+            printf(" %" PRIu32, s_supported_rates[i]);
+        }
+    }
+    printf("\n====================\n");
+    return ESP_OK;
+}
@@ -0,0 +1,302 @@
+/**
+ * @file console_cmdstats.c
+ * @brief 控制台命令执行统计实现
+ */
+
+#include "console_cmdstats.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "console_dispatch.h"
+
+static const char *TAG = "CONSOLE_CMDSTATS";
+
+typedef struct {
+    SemaphoreHandle_t lock;
+    console_cmdstats_entry_t commands[CONSOLE_DISPATCH_MAX_COMMANDS];
+    console_cmdstats_slow_t slow[CONSOLE_CMDSTATS_SLOW_LOG];
+    uint32_t slow_total;                // 写入日志的总条数，下一条写入 slow[slow_total % N]
+    uint32_t slow_threshold_us;
+} console_cmdstats_ctx_t;
+
+static console_cmdstats_ctx_t s_stats = {
+    .slow_threshold_us = CONSOLE_CMDSTATS_SLOW_DEFAULT_MS * 1000,
+};
+
+static int bucket_of(uint32_t elapsed_us)
+{
+    if (elapsed_us < (1u << CONSOLE_CMDSTATS_BUCKET_SHIFT)) {
+        return 0;
+    }
+    int bucket = (31 - __builtin_clz(elapsed_us)) - (CONSOLE_CMDSTATS_BUCKET_SHIFT - 1);
+    return bucket < CONSOLE_CMDSTATS_BUCKETS ? bucket : CONSOLE_CMDSTATS_BUCKETS - 1;
+}
+
+uint32_t console_cmdstats_bucket_floor_us(int bucket)
+{
+    if (bucket <= 0) {
+        return 0;
+    }
+    if (bucket >= CONSOLE_CMDSTATS_BUCKETS) {
+        bucket = CONSOLE_CMDSTATS_BUCKETS - 1;
+    }
+    return 1u << (bucket + CONSOLE_CMDSTATS_BUCKET_SHIFT - 1);
+}
+
+// 把参数用空格连接，超长时截断
+static void join_args(int argc, char *const *argv, char *buf, size_t size)
+{
+    size_t out = 0;
+    for (int i = 0; i < argc && out + 1 < size; i++) {
+        if (i > 0) {
+            buf[out++] = ' ';
+        }
+        size_t len = strlen(argv[i]);
+        if (len > size - 1 - out) {
+            len = size - 1 - out;
+        }
+        memcpy(buf + out, argv[i], len);
+        out += len;
+    }
+    buf[out] = '\0';
+}
+
+esp_err_t console_cmdstats_init(void)
+{
+    if (s_stats.lock != NULL) {
+        return ESP_OK;
+    }
+    s_stats.lock = xSemaphoreCreateMutex();
+    if (s_stats.lock == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void console_cmdstats_record(int argc, char *const *argv, int result, uint32_t elapsed_us)
+{
+    if (s_stats.lock == NULL || argc <= 0) {
+        return;
+    }
+    int index = console_dispatch_index(argv[0]);
+    if (index < 0) {
+        return;
+    }
+
+    // 命令行在锁外拼接
+    bool slow = elapsed_us >= s_stats.slow_threshold_us;
+    char line[CONSOLE_CMDSTATS_LINE_LEN];
+    if (slow) {
+        join_args(argc, argv, line, sizeof(line));
+    }
+
+    xSemaphoreTake(s_stats.lock, portMAX_DELAY);
+    console_cmdstats_entry_t *entry = &s_stats.commands[index];
+    entry->calls++;
+    if (result != 0) {
+        entry->errors++;
+    }
+    entry->total_us += elapsed_us;
+    entry->last_us = elapsed_us;
+    if (elapsed_us > entry->max_us) {
+        entry->max_us = elapsed_us;
+    }
+    entry->buckets[bucket_of(elapsed_us)]++;
+
+    if (slow) {
+        console_cmdstats_slow_t *record = &s_stats.slow[s_stats.slow_total % CONSOLE_CMDSTATS_SLOW_LOG];
+        s_stats.slow_total++;
+        record->seq = s_stats.slow_total;
+        record->timestamp_ms = (uint64_t)(esp_timer_get_time() / 1000);
+        record->elapsed_us = elapsed_us;
+        record->result = result;
+        memcpy(record->line, line, sizeof(record->line));
+    }
+    xSemaphoreGive(s_stats.lock);
+}
+
+esp_err_t console_cmdstats_get(int index, console_cmdstats_entry_t *entry)
+{
+    if (entry == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const char *name = console_dispatch_get_name(index);
+    if (name == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (s_stats.lock != NULL) {
+        xSemaphoreTake(s_stats.lock, portMAX_DELAY);
+        *entry = s_stats.commands[index];
+        xSemaphoreGive(s_stats.lock);
+    } else {
+        memset(entry, 0, sizeof(*entry));
+    }
+    entry->name = name;
+    return ESP_OK;
+}
+
+uint32_t console_cmdstats_percentile_us(const console_cmdstats_entry_t *entry, uint32_t percent)
+{
+    if (entry == NULL || entry->calls == 0) {
+        return 0;
+    }
+
+    uint64_t target = ((uint64_t)entry->calls * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (int i = 0; i < CONSOLE_CMDSTATS_BUCKETS - 1; i++) {
+        seen += entry->buckets[i];
+        if (seen >= target) {
+            uint32_t upper = console_cmdstats_bucket_floor_us(i + 1);
+            return upper < entry->max_us ? upper : entry->max_us;
+        }
+    }
+    return entry->max_us;
+}
+
+esp_err_t console_cmdstats_get_slow(int age, console_cmdstats_slow_t *entry)
+{
+    if (entry == NULL || age < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_stats.lock == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    xSemaphoreTake(s_stats.lock, portMAX_DELAY);
+    uint32_t held = s_stats.slow_total < CONSOLE_CMDSTATS_SLOW_LOG ? s_stats.slow_total : CONSOLE_CMDSTATS_SLOW_LOG;
+    if ((uint32_t)age < held) {
+        *entry = s_stats.slow[(s_stats.slow_total - 1 - age) % CONSOLE_CMDSTATS_SLOW_LOG];
+        ret = ESP_OK;
+    }
+    xSemaphoreGive(s_stats.lock);
+    return ret;
+}
+
+uint32_t console_cmdstats_get_slow_total(void)
+{
+    return s_stats.slow_total;
+}
+
+esp_err_t console_cmdstats_set_slow_threshold(uint32_t threshold_ms)
+{
+    s_stats.slow_threshold_us = threshold_ms > UINT32_MAX / 1000 ? UINT32_MAX : threshold_ms * 1000;
+    return ESP_OK;
+}
+
+uint32_t console_cmdstats_get_slow_threshold(void)
+{
+    return s_stats.slow_threshold_us / 1000;
+}
+
+esp_err_t console_cmdstats_reset(void)
+{
+    if (s_stats.lock == NULL) {
+        return ESP_OK;
+    }
+    xSemaphoreTake(s_stats.lock, portMAX_DELAY);
+    memset(s_stats.commands, 0, sizeof(s_stats.commands));
+    memset(s_stats.slow, 0, sizeof(s_stats.slow));
+    s_stats.slow_total = 0;
+    xSemaphoreGive(s_stats.lock);
+    return ESP_OK;
+}
+
+// ==================== 打印 ====================
+
+static void print_histogram(const console_cmdstats_entry_t *entry)
+{
+    uint32_t peak = 0;
+    for (int i = 0; i < CONSOLE_CMDSTATS_BUCKETS; i++) {
+        if (entry->buckets[i] > peak) {
+            peak = entry->buckets[i];
+        }
+    }
+
+    for (int i = 0; i < CONSOLE_CMDSTATS_BUCKETS; i++) {
+        if (entry->buckets[i] == 0) {
+            continue;
+        }
+        int bar = (int)((uint64_t)entry->buckets[i] * 30 / peak);
+        if (i == CONSOLE_CMDSTATS_BUCKETS - 1) {
+            printf("  >= %8" PRIu32 " us     ", console_cmdstats_bucket_floor_us(i));
+        } else {
+            printf("  %8" PRIu32 "-%-8" PRIu32 " us", console_cmdstats_bucket_floor_us(i),
+                   console_cmdstats_bucket_floor_us(i + 1));
+        }
+        printf(" %8" PRIu32 " |%.*s\n", entry->buckets[i], bar > 0 ? bar : 1,
+               "##############################");
+    }
+}
+
+esp_err_t console_cmdstats_print(const char *name)
+{
+    console_cmdstats_entry_t entry;
+
+    if (name != NULL) {
+        if (console_cmdstats_get(console_dispatch_index(name), &entry) != ESP_OK) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        printf("\n=== 命令统计: %s ===\n", entry.name);
+        printf("调用 %" PRIu32 " 次，失败 %" PRIu32 " 次\n", entry.calls, entry.errors);
+        if (entry.calls > 0) {
+            printf("平均 %" PRIu32 " us，p50 <= %" PRIu32 " us，p99 <= %" PRIu32 " us，最大 %" PRIu32 " us，最近 %" PRIu32 " us\n",
+                   (uint32_t)(entry.total_us / entry.calls), console_cmdstats_percentile_us(&entry, 50),
+                   console_cmdstats_percentile_us(&entry, 99), entry.max_us, entry.last_us);
+            print_histogram(&entry);
+        }
+        printf("================\n");
+        return ESP_OK;
+    }
+
+    printf("\n=== 命令统计 ===\n");
+    printf("%-12s %8s %6s %10s %10s %10s %10s\n", "命令", "调用", "失败", "平均(us)", "p99(us)", "最大(us)", "总计(ms)");
+    int shown = 0;
+    for (int i = 0; console_cmdstats_get(i, &entry) == ESP_OK; i++) {
+        if (entry.calls == 0) {
+            continue;
+        }
+        printf("%-12s %8" PRIu32 " %6" PRIu32 " %10" PRIu32 " %10" PRIu32 " %10" PRIu32 " %10" PRIu64 "\n",
+               entry.name, entry.calls, entry.errors, (uint32_t)(entry.total_us / entry.calls),
+               console_cmdstats_percentile_us(&entry, 99), entry.max_us, entry.total_us / 1000);
+        shown++;
+    }
+    if (shown == 0) {
+        printf("暂无记录\n");
+    }
+    printf("慢命令: %" PRIu32 " 条 (阈值 %" PRIu32 " ms)，用 cmdstats slow 查看\n",
+           console_cmdstats_get_slow_total(), console_cmdstats_get_slow_threshold());
+    printf("================\n");
+    return ESP_OK;
+}
+
+esp_err_t console_cmdstats_print_slow(void)
+{
+    uint32_t total = console_cmdstats_get_slow_total();
+    printf("\n=== 慢命令 (>= %" PRIu32 " ms，共 %" PRIu32 " 条，保留最近 %d 条) ===\n",
+           console_cmdstats_get_slow_threshold(), total, CONSOLE_CMDSTATS_SLOW_LOG);
+
+    console_cmdstats_slow_t record;
+    int held = 0;
+    while (console_cmdstats_get_slow(held, &record) == ESP_OK) {
+        held++;
+    }
+    for (int age = held - 1; age >= 0; age--) {
+        if (console_cmdstats_get_slow(age, &record) != ESP_OK) {
+            continue;
+        }
+        printf("#%-4" PRIu32 " %10" PRIu64 " ms %8" PRIu32 ".%03" PRIu32 " ms  ret=%-3d %s\n", record.seq,
+               record.timestamp_ms, record.elapsed_us / 1000, record.elapsed_us % 1000, record.result, record.line);
+    }
+    if (held == 0) {
+        printf("暂无记录\n");
+    }
+    printf("================\n");
+    return ESP_OK;
+}
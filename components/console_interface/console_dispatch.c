@@ -0,0 +1,325 @@
+/**
+ * @file console_dispatch.c
+ * @brief 控制台命令分发实现
+ */
+
+#include "console_dispatch.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "esp_log.h"
+
+static const char *TAG = "CONSOLE_DISPATCH";
+
+#define COMMAND_SLOTS   (1 << CONSOLE_DISPATCH_TABLE_BITS)
+
+typedef struct {
+    const char *name;
+    console_dispatch_func_t func;
+} command_entry_t;
+
+typedef struct {
+    command_entry_t commands[CONSOLE_DISPATCH_MAX_COMMANDS];
+    uint32_t hashes[CONSOLE_DISPATCH_MAX_COMMANDS];     // 命令名的FNV-1a哈希
+    int count;
+    uint32_t seed;
+    uint8_t slots[COMMAND_SLOTS];                       // 槽 -> 下标+1，0为空
+} console_dispatch_ctx_t;
+
+static console_dispatch_ctx_t s_dispatch;
+
+// ==================== 哈希 ====================
+
+static uint32_t name_hash(const char *name)
+{
+    uint32_t hash = 2166136261u;
+    while (*name != '\0') {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// 名字哈希与种子混合后取高 bits 位作为槽号
+static uint32_t slot_of(uint32_t hash, uint32_t seed, int bits)
+{
+    uint32_t h = (hash ^ seed) * 0x9E3779B1u;
+    h ^= h >> 15;
+    h *= 0x85EBCA6Bu;
+    return h >> (32 - bits);
+}
+
+// 搜索使所有哈希落在不同槽中的种子，成功时 slots 为对应的索引
+static bool find_seed(const uint32_t *hashes, int count, int bits, uint8_t *slots, uint32_t *seed)
+{
+    size_t size = (size_t)1 << bits;
+    for (uint32_t s = 0; s < CONSOLE_DISPATCH_SEED_TRIES; s++) {
+        memset(slots, 0, size);
+        int i;
+        for (i = 0; i < count; i++) {
+            uint32_t slot = slot_of(hashes[i], s, bits);
+            if (slots[slot] != 0) {
+                break;
+            }
+            slots[slot] = (uint8_t)(i + 1);
+        }
+        if (i == count) {
+            *seed = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ==================== 命令表 ====================
+
+esp_err_t console_dispatch_register(const char *name, console_dispatch_func_t func)
+{
+    if (name == NULL || *name == '\0' || func == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (console_dispatch_find(name) != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_dispatch.count >= CONSOLE_DISPATCH_MAX_COMMANDS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 在临时表中生成索引，失败时保留原表
+    uint8_t slots[COMMAND_SLOTS];
+    uint32_t seed;
+    int count = s_dispatch.count;
+    s_dispatch.hashes[count] = name_hash(name);
+    if (!find_seed(s_dispatch.hashes, count + 1, CONSOLE_DISPATCH_TABLE_BITS, slots, &seed)) {
+        ESP_LOGE(TAG, "No perfect hash seed for '%s' (%d commands)", name, count + 1);
+        return ESP_FAIL;
+    }
+
+    s_dispatch.commands[count].name = name;
+    s_dispatch.commands[count].func = func;
+    memcpy(s_dispatch.slots, slots, sizeof(slots));
+    s_dispatch.seed = seed;
+    s_dispatch.count = count + 1;
+    return ESP_OK;
+}
+
+int console_dispatch_index(const char *name)
+{
+    if (name == NULL || s_dispatch.count == 0) {
+        return -1;
+    }
+
+    uint32_t hash = name_hash(name);
+    uint8_t index = s_dispatch.slots[slot_of(hash, s_dispatch.seed, CONSOLE_DISPATCH_TABLE_BITS)];
+    if (index == 0 || s_dispatch.hashes[index - 1] != hash ||
+        strcmp(s_dispatch.commands[index - 1].name, name) != 0) {
+        return -1;
+    }
+    return index - 1;
+}
+
+console_dispatch_func_t console_dispatch_find(const char *name)
+{
+    int index = console_dispatch_index(name);
+    return index >= 0 ? s_dispatch.commands[index].func : NULL;
+}
+
+int console_dispatch_get_count(void)
+{
+    return s_dispatch.count;
+}
+
+const char *console_dispatch_get_name(int index)
+{
+    if (index < 0 || index >= s_dispatch.count) {
+        return NULL;
+    }
+    return s_dispatch.commands[index].name;
+}
+
+// ==================== 分词与执行 ====================
+
+esp_err_t console_dispatch_tokenize(char *line, char **argv, int max_args, int *argc)
+{
+    // 写指针 dst 不会超过读指针 src，去掉引号和转义符后原地写回
+    char *src = line;
+    char *dst = line;
+    int count = 0;
+    esp_err_t ret = ESP_OK;
+
+    for (;;) {
+        while (*src == ' ' || *src == '\t') {
+            src++;
+        }
+        if (*src == '\0') {
+            break;
+        }
+        if (count >= max_args) {
+            ret = ESP_ERR_INVALID_SIZE;
+            break;
+        }
+
+        argv[count++] = dst;
+        bool quoted = false;
+        while (*src != '\0' && (quoted || (*src != ' ' && *src != '\t'))) {
+            if (*src == '"') {
+                quoted = !quoted;
+                src++;
+                continue;
+            }
+            if (*src == '\\' && src[1] != '\0') {
+                src++;
+            }
+            *dst++ = *src++;
+        }
+
+        bool end = *src == '\0';
+        *dst++ = '\0';
+        if (end) {
+            break;
+        }
+        src++;
+    }
+
+    argv[count] = NULL;
+    *argc = count;
+    return ret;
+}
+
+esp_err_t console_dispatch_run_argv(int argc, char **argv, int *ret)
+{
+    if (argc == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    console_dispatch_func_t func = console_dispatch_find(argv[0]);
+    if (func == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *ret = func(argc, argv);
+    return ESP_OK;
+}
+
+esp_err_t console_dispatch_run_line(char *line, int *ret)
+{
+    char *argv[CONSOLE_DISPATCH_MAX_ARGS + 1];
+    int argc = 0;
+    esp_err_t err = console_dispatch_tokenize(line, argv, CONSOLE_DISPATCH_MAX_ARGS, &argc);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return console_dispatch_run_argv(argc, argv, ret);
+}
+
+// ==================== 子命令 ====================
+
+esp_err_t console_dispatch_subcmd_build(console_subcmd_table_t *table)
+{
+    if (table == NULL || table->count == 0 || table->count > CONSOLE_DISPATCH_MAX_SUBCMDS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (table->built) {
+        return ESP_OK;
+    }
+
+    uint32_t hashes[CONSOLE_DISPATCH_MAX_SUBCMDS];
+    for (int i = 0; i < table->count; i++) {
+        if (table->names[i] == NULL || *table->names[i] == '\0') {
+            return ESP_ERR_INVALID_ARG;
+        }
+        for (int j = 0; j < i; j++) {
+            if (strcmp(table->names[i], table->names[j]) == 0) {
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+        hashes[i] = name_hash(table->names[i]);
+    }
+
+    if (!find_seed(hashes, table->count, CONSOLE_DISPATCH_SUB_BITS, table->slots, &table->seed)) {
+        ESP_LOGE(TAG, "No perfect hash seed for %d subcommands ('%s', ...)", table->count, table->names[0]);
+        return ESP_FAIL;
+    }
+    table->built = true;
+    return ESP_OK;
+}
+
+int console_dispatch_subcmd(const console_subcmd_table_t *table, const char *name)
+{
+    if (table == NULL || !table->built || name == NULL) {
+        return -1;
+    }
+    uint8_t index = table->slots[slot_of(name_hash(name), table->seed, CONSOLE_DISPATCH_SUB_BITS)];
+    if (index == 0 || strcmp(table->names[index - 1], name) != 0) {
+        return -1;
+    }
+    return index - 1;
+}
+
+// ==================== 参数解析 ====================
+
+esp_err_t console_dispatch_arg_u32(const char *arg, uint32_t min, uint32_t max, uint32_t *value)
+{
+    if (arg == NULL || value == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int base = 10;
+    const char *digits = arg;
+    if (arg[0] == '0' && (arg[1] == 'x' || arg[1] == 'X')) {
+        base = 16;
+        digits = arg + 2;
+    }
+    // strtoull 接受前导空白和负号，这里只允许数字
+    if (base == 16 ? !isxdigit((unsigned char)*digits) : !isdigit((unsigned char)*digits)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char *end = NULL;
+    unsigned long long parsed = strtoull(digits, &end, base);
+    if (*end != '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (parsed < min || parsed > max) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    *value = (uint32_t)parsed;
+    return ESP_OK;
+}
+
+esp_err_t console_dispatch_arg_i32(const char *arg, int32_t min, int32_t max, int32_t *value)
+{
+    if (arg == NULL || value == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const char *digits = (arg[0] == '-' || arg[0] == '+') ? arg + 1 : arg;
+    if (!isdigit((unsigned char)*digits)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char *end = NULL;
+    long long parsed = strtoll(arg, &end, 10);
+    if (*end != '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (parsed < min || parsed > max) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    *value = (int32_t)parsed;
+    return ESP_OK;
+}
+
+esp_err_t console_dispatch_arg_bool(const char *arg, bool *value)
+{
+    if (arg == NULL || value == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (strcmp(arg, "on") == 0 || strcmp(arg, "1") == 0 || strcmp(arg, "true") == 0) {
+        *value = true;
+    } else if (strcmp(arg, "off") == 0 || strcmp(arg, "0") == 0 || strcmp(arg, "false") == 0) {
+        *value = false;
+    } else {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
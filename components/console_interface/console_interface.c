@@ -16,36 +16,152 @@
 #include "esp_timer.h"
 #include "linenoise/linenoise.h"
 #include "argtable3/argtable3.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include "board_hal_sim.h"
+#else
+#include "driver/uart.h"
+#include "driver/uart_vfs.h"
+#endif
 
 // 引入设备组件
 #include "device_interface.h"
 #include "hardware_control.h"
 #include "system_monitor.h"
+#include "cpu_usage.h"
+#include "metrics_store.h"
+#include "api_latency.h"
+#include "event_trace.h"
+#include "boot_profile.h"
+#include "bench.h"
+#include "event_bus.h"
+#include "power_manager.h"
+#include "console_rpc.h"
+#include "console_json.h"
+#include "console_output.h"
+#include "console_baud.h"
+#include "console_jobs.h"
+#include "console_script.h"
+#include "console_dispatch.h"
+#include "console_cmdstats.h"
+#include "board_hal.h"
 
 static const char *TAG = "CONSOLE_INTERFACE";
 
+// UART唤醒时触发唤醒的字符丢失，收到输入后保持唤醒，会话中的后续字节不再丢失
+_Static_assert(CONSOLE_INPUT_AWAKE_MS > CONSOLE_RPC_WAKE_IDLE_MS, "host must send a wake preamble before the console may sleep");
+
+// 输入活动：收到输入后 CONSOLE_INPUT_AWAKE_MS 内禁止浅睡眠
+typedef struct {
+    board_hal_pm_lock_t pm_lock;
+    esp_timer_handle_t timer;
+    int64_t last_input_us;
+    bool held;                      // 持有pm_lock，空闲定时器在运行
+} console_input_awake_t;
+
+static console_input_awake_t s_input_awake;
+static portMUX_TYPE s_input_awake_lock = portMUX_INITIALIZER_UNLOCKED;
+
 // 内部状态结构
 typedef struct {
     bool initialized;
     bool running;
+    bool blocking_input;            // stdin阻塞读取（已安装UART驱动）
     TaskHandle_t console_task_handle;
     console_interface_config_t config;
     console_event_callback_t event_callback;
+    int event_subscriber;           // 事件回调在事件总线上的订阅者ID，-1表示未订阅
     uint32_t commands_executed;
     uint64_t start_time_ms;
+    console_output_mode_t output_mode;  // 状态/信息类命令的全局输出格式
+    bool job_submitted;             // 当前命令已提交为后台任务，统计由工作任务记录
 } console_state_t;
 
-static console_state_t s_console_state = {0};
+static console_state_t s_console_state = { .event_subscriber = -1 };
+
+// 子命令表：名字顺序与对应枚举一致，注册命令时生成哈希索引
+typedef enum {
+    ORIN_CMD_ON,
+    ORIN_CMD_OFF,
+    ORIN_CMD_RESET,
+    ORIN_CMD_RECOVERY,
+    ORIN_CMD_STATUS,
+} orin_cmd_t;
+static console_subcmd_table_t s_orin_subcmds = CONSOLE_SUBCMD_TABLE("on", "off", "reset", "recovery", "status");
+
+typedef enum {
+    N305_CMD_TOGGLE,
+    N305_CMD_RESET,
+    N305_CMD_STATUS,
+} n305_cmd_t;
+static console_subcmd_table_t s_n305_subcmds = CONSOLE_SUBCMD_TABLE("toggle", "reset", "status");
+
+typedef enum {
+    TEST_ITEM_FAN,
+    TEST_ITEM_BLED,
+    TEST_ITEM_TLED,
+    TEST_ITEM_GPIO,
+    TEST_ITEM_GPIO_INPUT,
+    TEST_ITEM_ALL,
+    TEST_ITEM_QUICK,
+    TEST_ITEM_STRESS,
+    TEST_ITEM_NVS,
+} test_item_t;
+static console_subcmd_table_t s_test_items = CONSOLE_SUBCMD_TABLE(
+    "fan", "bled", "tled", "gpio", "gpio_input", "all", "quick", "stress", "nvs");
+
+// 直接操作风扇、LED、GPIO的命令，执行前占用 CONSOLE_JOB_RES_PERIPH
+static console_subcmd_table_t s_periph_commands = CONSOLE_SUBCMD_TABLE(
+    "fan", "bled", "tled", "gpio", "usbmux", "load", "profile");
+
+typedef enum {
+    BENCH_ARGS_SET,
+    BENCH_ARGS_GET,
+    BENCH_ARGS_MODE,
+    BENCH_ARGS_NAME,
+} bench_args_cmd_t;
+static console_subcmd_table_t s_bench_args_subcmds = CONSOLE_SUBCMD_TABLE("set", "get", "mode", "name");
 
 // 内部函数声明
 static void console_task(void *pvParameters);
 static uint64_t get_time_ms(void);
+static void register_commands(const esp_console_cmd_t *commands, size_t count);
+static esp_err_t run_command(int argc, char **argv, int *ret);
+static bool hold_resources(uint32_t resources);
 
 // 命令函数声明
 static int cmd_help(int argc, char **argv);
 static int cmd_info(int argc, char **argv);
 static int cmd_status(int argc, char **argv);
 static int cmd_reboot(int argc, char **argv);
+static int cmd_top(int argc, char **argv);
+static int cmd_mem(int argc, char **argv);
+static int cmd_metrics(int argc, char **argv);
+static int cmd_lat(int argc, char **argv);
+static int cmd_trace(int argc, char **argv);
+static int cmd_boot(int argc, char **argv);
+static int cmd_events(int argc, char **argv);
+static int cmd_power(int argc, char **argv);
+static int cmd_bench(int argc, char **argv);
+static int cmd_bench_nop(int argc, char **argv);
+static int cmd_bench_args(int argc, char **argv);
+static esp_err_t bench_dispatch(void *ctx, uint32_t iteration);
+static esp_err_t bench_dispatch_hash(void *ctx, uint32_t iteration);
+static esp_err_t bench_script(void *ctx, uint32_t iteration);
+static esp_err_t bench_script_esp(void *ctx, uint32_t iteration);
+static int cmd_rpc(int argc, char **argv);
+static int cmd_output(int argc, char **argv);
+static int cmd_baud(int argc, char **argv);
+static int cmd_jobs(int argc, char **argv);
+static int cmd_wait(int argc, char **argv);
+static int cmd_cancel(int argc, char **argv);
+static int cmd_macro(int argc, char **argv);
+static int cmd_cmdstats(int argc, char **argv);
+static esp_err_t bench_rpc_dispatch(void *ctx, uint32_t iteration);
+#if CONFIG_IDF_TARGET_LINUX
+static int cmd_sim(int argc, char **argv);
+#endif
 static int cmd_fan(int argc, char **argv);
 static int cmd_bled(int argc, char **argv);
 static int cmd_tled(int argc, char **argv);
@@ -54,24 +170,98 @@ static int cmd_usbmux(int argc, char **argv);
 static int cmd_orin(int argc, char **argv);
 static int cmd_n305(int argc, char **argv);
 static int cmd_test(int argc, char **argv);
+static int run_test_item(int item, int argc, char **argv);
 static int cmd_save(int argc, char **argv);
 static int cmd_load(int argc, char **argv);
 static int cmd_clear(int argc, char **argv);
+static int cmd_autosave(int argc, char **argv);
+static int cmd_profile(int argc, char **argv);
 
 // 触发控制台事件
 static void trigger_console_event(console_event_t event, const char *data)
 {
+    if (event_bus_publish_str(EVENT_BUS_SOURCE_CONSOLE, event, data) == ESP_OK) {
+        return;
+    }
+
+    // 事件总线不可用时直接回调
     if (s_console_state.event_callback) {
         s_console_state.event_callback(event, data);
     }
 }
 
+// 在事件总线分发任务中调用已注册的回调
+static void bus_event_handler(const event_bus_event_t *event, void *ctx)
+{
+    console_event_callback_t callback = s_console_state.event_callback;
+    if (callback) {
+        callback((console_event_t)event->id, event->data_len > 0 ? (const char *)event->data : NULL);
+    }
+}
+
 // 获取时间戳
 static uint64_t get_time_ms(void)
 {
     return esp_timer_get_time() / 1000ULL;
 }
 
+// ==================== 输入活动 ====================
+
+// 最后一次输入后满 CONSOLE_INPUT_AWAKE_MS 时释放PM锁，否则按剩余时间重新定时
+static void input_awake_timer_callback(void *arg)
+{
+    portENTER_CRITICAL(&s_input_awake_lock);
+    int64_t remaining_us = s_input_awake.last_input_us + CONSOLE_INPUT_AWAKE_MS * 1000LL - esp_timer_get_time();
+    if (remaining_us <= 0) {
+        s_input_awake.held = false;
+    }
+    portEXIT_CRITICAL(&s_input_awake_lock);
+
+    if (remaining_us > 0) {
+        esp_timer_start_once(s_input_awake.timer, (uint64_t)remaining_us);
+    } else {
+        board_hal_pm_lock_release(s_input_awake.pm_lock);
+    }
+}
+
+static void input_awake_init(void)
+{
+    const esp_timer_create_args_t timer_args = {
+        .callback = input_awake_timer_callback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "console_in",
+        .skip_unhandled_events = true,
+    };
+    if (board_hal_pm_lock_create(BOARD_HAL_PM_NO_LIGHT_SLEEP, "console_in", &s_input_awake.pm_lock) != ESP_OK ||
+        esp_timer_create(&timer_args, &s_input_awake.timer) != ESP_OK) {
+        ESP_LOGW(TAG, "Input wake hold unavailable, bytes may be lost after light sleep");
+        s_input_awake.timer = NULL;
+    }
+}
+
+// 每收到一个字节调用：更新最后输入时间，空闲后的第一个字节获取PM锁并启动定时器
+static void input_awake_note(void)
+{
+    if (s_input_awake.timer == NULL) {
+        return;
+    }
+
+    bool start = false;
+    portENTER_CRITICAL(&s_input_awake_lock);
+    s_input_awake.last_input_us = esp_timer_get_time();
+    if (!s_input_awake.held) {
+        s_input_awake.held = true;
+        start = true;
+    }
+    portEXIT_CRITICAL(&s_input_awake_lock);
+
+    if (start) {
+        board_hal_pm_lock_acquire(s_input_awake.pm_lock);
+        esp_timer_start_once(s_input_awake.timer, CONSOLE_INPUT_AWAKE_MS * 1000ULL);
+    }
+}
+
 esp_err_t console_interface_init(const console_interface_config_t *config)
 {
     if (s_console_state.initialized) {
@@ -87,11 +277,55 @@ esp_err_t console_interface_init(const console_interface_config_t *config)
     // 复制配置
     memcpy(&s_console_state.config, config, sizeof(console_interface_config_t));
 
-    // 禁用缓冲，提高响应性
+    // 禁用缓冲，其他任务的日志立即输出；控制台任务的命令输出由console_output合并
     setvbuf(stdout, NULL, _IONBF, 0);
     setvbuf(stderr, NULL, _IONBF, 0);
     setvbuf(stdin, NULL, _IONBF, 0);
 
+#if CONFIG_IDF_TARGET_LINUX
+    // 仿真目标：阻塞读stdin会占住整个FreeRTOS仿真调度器，改为非阻塞轮询
+    int stdin_flags = fcntl(STDIN_FILENO, F_GETFL);
+    if (stdin_flags >= 0) {
+        fcntl(STDIN_FILENO, F_SETFL, stdin_flags | O_NONBLOCK);
+    }
+#else
+    // 安装UART驱动，stdin改为中断驱动的阻塞读取，空闲时控制台任务不再轮询，
+    // 芯片可以进入浅睡眠。使用XTAL时钟，动态调频时波特率不变。
+    // 发送环形缓冲区使输出由TX中断搬运，写入时只拷贝不等待FIFO
+    const uart_config_t uart_config = {
+        .baud_rate = CONFIG_ESP_CONSOLE_UART_BAUDRATE,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_XTAL,
+    };
+    esp_err_t uart_ret = uart_driver_install(CONFIG_ESP_CONSOLE_UART_NUM, CONSOLE_BUF_SIZE * 2,
+                                             CONSOLE_OUTPUT_TX_RING_SIZE, 0, NULL, 0);
+    if (uart_ret == ESP_OK) {
+        uart_ret = uart_param_config(CONFIG_ESP_CONSOLE_UART_NUM, &uart_config);
+    }
+    if (uart_ret == ESP_OK) {
+        uart_vfs_dev_use_driver(CONFIG_ESP_CONSOLE_UART_NUM);
+        // 二进制RPC帧中可能出现0x0D，输入不做换行转换，文本shell自行处理CR/LF
+        uart_vfs_dev_port_set_rx_line_endings(CONFIG_ESP_CONSOLE_UART_NUM, ESP_LINE_ENDINGS_LF);
+        s_console_state.blocking_input = true;
+    } else {
+        ESP_LOGW(TAG, "UART driver unavailable, console falls back to polling: %s", esp_err_to_name(uart_ret));
+    }
+#endif
+
+    input_awake_init();
+
+    if (console_output_init(s_console_state.blocking_input) != ESP_OK) {
+        ESP_LOGW(TAG, "Console output buffer unavailable, output stays unbuffered");
+    }
+
+    // 使用NVS中保存的波特率（若有），对端未跟上时自动回到默认波特率
+    if (console_baud_init(s_console_state.blocking_input) != ESP_OK) {
+        ESP_LOGW(TAG, "Baud rate negotiation unavailable, console stays at %d baud", CONSOLE_BAUD_DEFAULT);
+    }
+
     // 初始化ESP控制台
     esp_console_config_t console_config = {
         .max_cmdline_args = config->max_cmdline_args,
@@ -109,6 +343,26 @@ esp_err_t console_interface_init(const console_interface_config_t *config)
     // 注册ESP控制台内置help命令
     esp_console_register_help_command();
 
+    // 控制台事件经事件总线异步投递，回调不阻塞命令执行
+    if (event_bus_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Event bus unavailable, events will be delivered synchronously");
+    }
+
+    // 耗时命令在工作任务中执行，控制台保持可交互
+    if (console_jobs_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Job runner unavailable, long commands will run in the console task");
+    }
+
+    // 每条命令的执行统计与慢命令日志
+    if (console_cmdstats_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Command statistics unavailable");
+    }
+
+    // 批处理与宏，宏从NVS载入
+    if (console_script_init(run_command) != ESP_OK) {
+        ESP_LOGW(TAG, "Command scripts unavailable");
+    }
+
     s_console_state.initialized = true;
     s_console_state.start_time_ms = get_time_ms();
     
@@ -170,6 +424,10 @@ esp_err_t console_interface_stop(void)
 esp_err_t console_interface_register_event_callback(console_event_callback_t callback)
 {
     s_console_state.event_callback = callback;
+    if (callback && s_console_state.event_subscriber < 0) {
+        event_bus_subscribe("console_cb", EVENT_BUS_SOURCE_BIT(EVENT_BUS_SOURCE_CONSOLE), 0,
+                            bus_event_handler, NULL, &s_console_state.event_subscriber);
+    }
     return ESP_OK;
 }
 
@@ -187,24 +445,167 @@ esp_err_t console_interface_register_system_commands(void)
         },
         {
             .command = "info",
-            .help = "显示系统信息",
+            .help = "显示系统信息: info [--json]",
             .func = &cmd_info,
         },
         {
             .command = "status",
-            .help = "显示当前状态",
+            .help = "显示当前状态: status [--json]",
             .func = &cmd_status,
         },
         {
             .command = "reboot",
             .help = "重启系统",
             .func = &cmd_reboot,
-        }
+        },
+        {
+            .command = "top",
+            .help = "CPU占用率: top [history|dump]",
+            .func = &cmd_top,
+        },
+        {
+            .command = "mem",
+            .help = "内存状态: mem [--json] | mem <internal|dma|block|frag> <值>",
+            .func = &cmd_mem,
+        },
+        {
+            .command = "metrics",
+            .help = "指标历史: metrics [1s|1m [n]] | dump <1s|1m> [n] | flash [n]",
+            .func = &cmd_metrics,
+        },
+        {
+            .command = "lat",
+            .help = "API调用延迟: lat [reset|<名称过滤>]",
+            .func = &cmd_lat,
+        },
+        {
+            .command = "trace",
+            .help = "事件跟踪: trace [on|off|clear|dump]",
+            .func = &cmd_trace,
+        },
+        {
+            .command = "boot",
+            .help = "显示启动阶段耗时",
+            .func = &cmd_boot,
+        },
+        {
+            .command = "events",
+            .help = "显示事件总线统计: events [reset]",
+            .func = &cmd_events,
+        },
+        {
+            .command = "power",
+            .help = "电源管理: power [locks|reset|sleep <on|off>]",
+            .func = &cmd_power,
+        },
+        {
+            .command = "bench",
+            .help = "基准测试: bench [list] | bench <名称|all> [iter <n>|time <ms>]",
+            .func = &cmd_bench,
+        },
+        {
+            .command = "rpc",
+            .help = "二进制RPC统计: rpc [reset]",
+            .func = &cmd_rpc,
+        },
+        {
+            .command = "baud",
+            .help = "控制台波特率: baud [<速率> [save]|save|reset|test [速率]]",
+            .func = &cmd_baud,
+        },
+        {
+            .command = "output",
+            .help = "控制台输出: output [text|json|stats|reset|buffer <on|off>]",
+            .func = &cmd_output,
+        },
+        {
+            .command = "jobs",
+            .help = "列出后台任务",
+            .func = &cmd_jobs,
+        },
+        {
+            .command = "wait",
+            .help = "等待后台任务结束: wait <id> [超时ms]",
+            .func = &cmd_wait,
+        },
+        {
+            .command = "cancel",
+            .help = "取消后台任务: cancel <id>",
+            .func = &cmd_cancel,
+        },
+        {
+            .command = "cmdstats",
+            .help = "命令执行统计: cmdstats [<命令>|slow [阈值ms]|reset] [--json]",
+            .func = &cmd_cmdstats,
+        },
+        {
+            .command = "macro",
+            .help = "宏: macro [list|def <名称> \"<命令; 命令>\"|show <名称>|run <名称>|del <名称>]",
+            .func = &cmd_macro,
+        },
+        {
+            // 命令分发基准测试的空命令，不显示在帮助中
+            .command = "bench_nop",
+            .help = NULL,
+            .func = &cmd_bench_nop,
+        },
+        {
+            // 脚本分发基准测试中解析子命令和参数的命令，不显示在帮助中
+            .command = "bench_args",
+            .help = NULL,
+            .func = &cmd_bench_args,
+        },
+#if CONFIG_IDF_TARGET_LINUX
+        {
+            .command = "sim",
+            .help = "仿真外设: sim [edges [n]|clear|input <pin> <0|1>|clock [real|virtual|step|advance <ms>]]",
+            .func = &cmd_sim,
+        },
+#endif
     };
 
-    for (int i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
-        ESP_ERROR_CHECK(esp_console_cmd_register(&commands[i]));
-    }
+    register_commands(commands, sizeof(commands) / sizeof(commands[0]));
+
+    const bench_case_t dispatch_bench = {
+        .name = "cmd_dispatch",
+        .description = "控制台命令解析与分发 (空命令)",
+        .op = bench_dispatch,
+        .default_iterations = 5000,
+    };
+    bench_register(&dispatch_bench);
+
+    ESP_ERROR_CHECK(console_dispatch_subcmd_build(&s_bench_args_subcmds));
+    const bench_case_t dispatch_hash_bench = {
+        .name = "cmd_dispatch_hash",
+        .description = "控制台命令原地分词与哈希查找分发 (空命令)",
+        .op = bench_dispatch_hash,
+        .default_iterations = 5000,
+    };
+    bench_register(&dispatch_hash_bench);
+
+    const bench_case_t script_bench = {
+        .name = "cmd_script",
+        .description = "脚本输入逐行分发，含子命令与参数解析 (ops/s即命令/秒)",
+        .op = bench_script,
+        .default_iterations = 5000,
+    };
+    bench_register(&script_bench);
+
+    const bench_case_t script_esp_bench = {
+        .name = "cmd_script_esp",
+        .description = "同一脚本经 esp_console_run 分发 (对比基线)",
+        .op = bench_script_esp,
+        .default_iterations = 5000,
+    };
+    bench_register(&script_esp_bench);
+
+    const bench_case_t rpc_bench = {
+        .name = "rpc_dispatch",
+        .description = "二进制RPC帧解码、分发与响应编码 (ping)",
+        .op = bench_rpc_dispatch,
+        .default_iterations = 5000,
+    };
+    bench_register(&rpc_bench);
 
     ESP_LOGI(TAG, "System commands registered");
     return ESP_OK;
@@ -244,24 +645,26 @@ esp_err_t console_interface_register_device_commands(void)
         },
         {
             .command = "orin",
-            .help = "Orin电源控制: orin on|off|reset|recovery|status",
+            .help = "Orin电源控制: orin on|off|reset|recovery|status [--fg]",
             .func = &cmd_orin,
         },
         {
             .command = "n305",
-            .help = "N305电源控制: n305 toggle|reset|status",
+            .help = "N305电源控制: n305 toggle|reset|status [--fg]",
             .func = &cmd_n305,
         },
         {
             .command = "test",
-            .help = "硬件测试: test fan|bled|tled|gpio <pin>|gpio_input <pin>|orin|n305|all|quick|stress <ms>",
+            .help = "硬件测试 (后台任务): test fan|bled|tled|gpio <pin>|gpio_input <pin>|orin|n305|all|quick|stress <ms>|nvs [n] [--fg]",
             .func = &cmd_test,
         }
     };
 
-    for (int i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
-        ESP_ERROR_CHECK(esp_console_cmd_register(&commands[i]));
-    }
+    ESP_ERROR_CHECK(console_dispatch_subcmd_build(&s_orin_subcmds));
+    ESP_ERROR_CHECK(console_dispatch_subcmd_build(&s_n305_subcmds));
+    ESP_ERROR_CHECK(console_dispatch_subcmd_build(&s_test_items));
+    ESP_ERROR_CHECK(console_dispatch_subcmd_build(&s_periph_commands));
+    register_commands(commands, sizeof(commands) / sizeof(commands[0]));
 
     ESP_LOGI(TAG, "Device commands registered");
     return ESP_OK;
@@ -288,14 +691,68 @@ esp_err_t console_interface_register_config_commands(void)
             .command = "clear",
             .help = "清除NVS中的配置",
             .func = &cmd_clear,
+        },
+        {
+            .command = "autosave",
+            .help = "自动保存配置: autosave [on|off|flush|<静默期ms>]",
+            .func = &cmd_autosave,
+        },
+        {
+            .command = "profile",
+            .help = "配置档案: profile [list|save|apply|delete] [名称] [渐变ms]",
+            .func = &cmd_profile,
         }
     };
 
-    for (int i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+    ESP_ERROR_CHECK(console_dispatch_subcmd_build(&s_periph_commands));
+    register_commands(commands, sizeof(commands) / sizeof(commands[0]));
+
+    ESP_LOGI(TAG, "Config commands registered");
+    return ESP_OK;
+}
+
+// 命令同时注册到esp_console（保留其帮助与分发基准的对比基线）和哈希分发表
+static void register_commands(const esp_console_cmd_t *commands, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
         ESP_ERROR_CHECK(esp_console_cmd_register(&commands[i]));
+        ESP_ERROR_CHECK(console_dispatch_register(commands[i].command, commands[i].func));
     }
+}
 
-    ESP_LOGI(TAG, "Config commands registered");
+// 执行已分词的命令并记录执行统计（控制台、批处理与宏共用）
+static esp_err_t run_command(int argc, char **argv, int *ret)
+{
+    if (argc == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    console_dispatch_func_t func = console_dispatch_find(argv[0]);
+    if (func == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // 处理函数会移除 --json/--fg 等参数，统计记录调用前的参数
+    char *args[CONSOLE_DISPATCH_MAX_ARGS + 1];
+    int n = argc < CONSOLE_DISPATCH_MAX_ARGS ? argc : CONSOLE_DISPATCH_MAX_ARGS;
+    memcpy(args, argv, n * sizeof(char *));
+    args[n] = NULL;
+
+    // 后台任务正在操作外设时，外设命令等待其结束后再执行
+    uint32_t resources = console_dispatch_subcmd(&s_periph_commands, argv[0]) >= 0 ? CONSOLE_JOB_RES_PERIPH : 0;
+    if (!hold_resources(resources)) {
+        *ret = 1;
+        return ESP_OK;
+    }
+
+    s_console_state.job_submitted = false;
+    int64_t start_us = esp_timer_get_time();
+    *ret = func(argc, argv);
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    console_jobs_release(resources);
+    if (!s_console_state.job_submitted) {
+        console_cmdstats_record(n, args, *ret, elapsed_us);
+    }
+    s_console_state.job_submitted = false;
     return ESP_OK;
 }
 
@@ -305,8 +762,28 @@ esp_err_t console_interface_execute_command(const char *command)
         return ESP_ERR_INVALID_ARG;
     }
 
-    int ret;
-    esp_err_t err = esp_console_run(command, &ret);
+    int ret = 0;
+    esp_err_t err;
+    EVENT_TRACE_BEGIN(EVENT_TRACE_CONSOLE_CMD, 0, event_trace_pack_str(command));
+    if (console_script_is_batch(command)) {
+        err = console_script_run_line(command, &ret);
+    } else {
+        // 复制到栈上的行缓冲区后原地分词，不分配堆内存
+        char line[CONSOLE_BUF_SIZE];
+        char *argv[CONSOLE_DISPATCH_MAX_ARGS + 1];
+        int argc = 0;
+        size_t len = strlen(command);
+        if (len >= sizeof(line)) {
+            err = ESP_ERR_INVALID_SIZE;
+        } else {
+            memcpy(line, command, len + 1);
+            err = console_dispatch_tokenize(line, argv, CONSOLE_DISPATCH_MAX_ARGS, &argc);
+            if (err == ESP_OK) {
+                err = run_command(argc, argv, &ret);
+            }
+        }
+    }
+    EVENT_TRACE_END(EVENT_TRACE_CONSOLE_CMD, err == ESP_OK ? ret : err, event_trace_pack_str(command));
     
     if (err == ESP_OK) {
         s_console_state.commands_executed++;
@@ -364,20 +841,174 @@ esp_err_t console_interface_get_stats(uint32_t *commands_executed, uint64_t *upt
     return ESP_OK;
 }
 
+esp_err_t console_interface_set_output_mode(console_output_mode_t mode)
+{
+    if (mode != CONSOLE_OUTPUT_TEXT && mode != CONSOLE_OUTPUT_JSON) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_console_state.output_mode = mode;
+    return ESP_OK;
+}
+
+console_output_mode_t console_interface_get_output_mode(void)
+{
+    return s_console_state.output_mode;
+}
+
 // ========== 命令实现函数 ==========
 
+// 从参数中移除 --json/-j，返回本次命令是否输出JSON（参数或全局输出模式）
+static bool take_json_flag(int *argc, char **argv)
+{
+    bool json = s_console_state.output_mode == CONSOLE_OUTPUT_JSON;
+    int out = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 || strcmp(argv[i], "-j") == 0) {
+            json = true;
+        } else {
+            argv[out++] = argv[i];
+        }
+    }
+    *argc = out;
+    return json;
+}
+
+// 从参数中移除 --fg，返回是否要求在控制台任务中直接执行
+static bool take_fg_flag(int *argc, char **argv)
+{
+    bool fg = false;
+    int out = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--fg") == 0) {
+            fg = true;
+        } else {
+            argv[out++] = argv[i];
+        }
+    }
+    *argc = out;
+    return fg;
+}
+
+// 把耗时命令提交为后台任务。返回-1表示应在当前任务直接执行（已在工作任务中、
+// 在批处理/宏中需要返回值，或任务执行器不可用），否则返回命令结果
+static int submit_job(int argc, char **argv, console_job_func_t func, uint32_t resources,
+                      console_job_cancel_t cancel)
+{
+    if (console_jobs_in_worker() || console_script_running()) {
+        return -1;
+    }
+
+    uint32_t id = 0;
+    esp_err_t ret = console_jobs_submit(func, argc, argv, resources, cancel, &id);
+    if (ret == ESP_ERR_INVALID_STATE) {
+        return -1;
+    }
+    if (ret != ESP_OK) {
+        printf("提交后台任务失败: %s\n", esp_err_to_name(ret));
+        if (ret == ESP_ERR_NO_MEM) {
+            printf("任务表已满 (%d)，等待任务结束或使用 --fg\n", CONSOLE_JOBS_MAX);
+        }
+        return 1;
+    }
+    printf("[job %" PRIu32 "] 已提交，用 jobs 查看，wait %" PRIu32 " 等待结果\n", id, id);
+    s_console_state.job_submitted = true;
+    return 0;
+}
+
+// 在当前任务中占用资源，被后台任务占用时提示并等待
+static bool hold_resources(uint32_t resources)
+{
+    esp_err_t ret = console_jobs_acquire(resources, 0);
+    if (ret == ESP_ERR_TIMEOUT) {
+        printf("外设正被后台任务使用，等待其结束...\n");
+        fflush(stdout);
+        ret = console_jobs_acquire(resources, CONSOLE_JOBS_ACQUIRE_TIMEOUT_MS);
+    }
+    if (ret != ESP_OK) {
+        printf("等待外设超时，用 jobs 查看或 cancel 取消后台任务\n");
+        return false;
+    }
+    return true;
+}
+
+// 开始一条JSON输出，顶层对象带命令名
+static void json_begin_command(console_json_t *json, char *buf, size_t size, const char *command)
+{
+    console_json_init_stdout(json, buf, size);
+    console_json_begin_object(json, NULL);
+    console_json_string(json, "cmd", command);
+}
+
+// 命令失败时的JSON输出
+static int json_print_error(const char *command, esp_err_t err)
+{
+    char buf[CONSOLE_JSON_BUF_SIZE];
+    console_json_t json;
+    json_begin_command(&json, buf, sizeof(buf), command);
+    console_json_string(&json, "error", esp_err_to_name(err));
+    console_json_end_object(&json);
+    console_json_finish(&json);
+    return 1;
+}
+
 static int cmd_help(int argc, char **argv)
 {
     printf("\n=== ESP32S3 组件化控制台可用命令 ===\n");
     printf("系统命令:\n");
     printf("  help          - 显示此帮助信息\n");
-    printf("  info          - 显示系统信息\n");
-    printf("  status        - 显示当前状态\n");
+    printf("  info [--json] - 显示系统信息\n");
+    printf("  status [--json] - 显示当前状态\n");
     printf("  reboot        - 重启系统\n");
+    printf("  top           - 显示各任务/各核心CPU占用率\n");
+    printf("  top history   - 显示CPU占用率历史\n");
+    printf("  top dump      - 以十六进制导出CPU占用率二进制数据\n");
+    printf("  mem [--json]  - 显示各内存区域(内部/DMA/PSRAM)状态\n");
+    printf("  mem <internal|dma|block> <bytes> - 设置内存告警阈值(0禁用)\n");
+    printf("  mem frag <0-100> - 设置碎片率告警阈值(0禁用)\n");
+    printf("  metrics       - 显示指标存储概况与最新值\n");
+    printf("  metrics <1s|1m> [n] - 显示最近n条1秒/1分钟指标\n");
+    printf("  metrics dump <1s|1m> [n] - 以十六进制导出指标二进制数据\n");
+    printf("  metrics flash [n] - 以十六进制导出Flash中保存的1分钟记录\n");
+    printf("  lat [过滤]    - 显示硬件/NVS接口调用延迟分位数\n");
+    printf("  lat reset     - 清零调用延迟统计\n");
+    printf("  trace         - 显示事件跟踪缓冲区状态\n");
+    printf("  trace <on|off|clear> - 开始/暂停/清空事件跟踪\n");
+    printf("  trace dump    - 以十六进制导出跟踪事件 (tools/trace_decode.py解码)\n");
+    printf("  boot          - 显示启动阶段耗时分布\n");
+    printf("  events [reset] - 显示/清零事件总线队列深度、丢弃与分发延迟\n");
+    printf("  power         - 显示动态调频、浅睡眠时间占比与超睡时间\n");
+    printf("  power locks   - 显示当前PM锁\n");
+    printf("  power reset   - 清零睡眠统计\n");
+    printf("  power sleep <on|off> - 允许/禁止自动浅睡眠\n");
+    printf("  bench [list]  - 列出基准测试用例\n");
+    printf("  bench <名称|all> [iter <n>|time <ms>] - 运行基准测试，输出ops/s、延迟分位数和周期/次\n");
+    printf("  rpc [reset]   - 显示/清零二进制RPC统计 (tools/bmc_rpc.py)\n");
+    printf("  output [text|json] - 切换info/status/mem的输出格式 (json为单行紧凑JSON)\n");
+    printf("  output stats|reset - 显示/清零输出统计 (字节数、驱动写入次数、最近命令耗时)\n");
+    printf("  output buffer <on|off> - 启用/禁用命令输出缓冲 (对比吞吐)\n");
+    printf("  baud          - 显示控制台波特率、NVS保存值与协商统计\n");
+    printf("  baud <速率> [save] - 切换波特率 (最高2000000)，需在新波特率下发送命令确认，否则自动恢复\n");
+    printf("  baud save|reset - 保存当前波特率到NVS / 清除保存并恢复默认\n");
+    printf("  baud test [速率] - UART内部回环吞吐自检 (默认测试全部速率)\n");
+#if CONFIG_IDF_TARGET_LINUX
+    printf("  sim           - 显示仿真外设状态 (GPIO/PWM/灯带帧/PM锁)\n");
+    printf("  sim edges [n] - 显示最近n条GPIO跳变\n");
+    printf("  sim clear     - 清空GPIO跳变日志\n");
+    printf("  sim input <pin> <0|1> - 驱动输入引脚电平\n");
+    printf("  sim clock [real|virtual|step] - 显示/切换时钟模式 (虚拟时钟空闲时直接跳到下一唤醒时刻)\n");
+    printf("  sim clock advance <ms> - STEP模式下推进虚拟时间\n");
+#endif
     printf("\n配置管理:\n");
     printf("  save          - 保存当前配置到NVS\n");
     printf("  load          - 从NVS加载配置\n");
     printf("  clear         - 清除NVS中的配置\n");
+    printf("  autosave      - 显示自动保存统计\n");
+    printf("  autosave <on|off|flush> - 启用/禁用/立即保存\n");
+    printf("  autosave <ms> - 设置自动保存静默期\n");
+    printf("  profile [list] - 列出配置档案\n");
+    printf("  profile save <名称> - 把当前风扇/LED设置保存为档案\n");
+    printf("  profile apply <名称> [渐变ms] - 切换到档案\n");
+    printf("  profile delete <名称> - 删除档案\n");
     printf("\n风扇控制:\n");
     printf("  fan <0-100>   - 设置风扇速度 (0-100%%)\n");
     printf("  fan off       - 关闭风扇\n");
@@ -420,7 +1051,26 @@ static int cmd_help(int argc, char **argv)
     printf("  test n305            - 测试N305电源控制功能\n");
     printf("  test all             - 测试所有硬件\n");
     printf("  test quick           - 快速测试\n");
-    printf("  test stress <ms>     - 压力测试\n");
+    printf("  test stress <ms>     - 压力测试 (全部基准测试按时长平分运行)\n");
+    printf("\n后台任务:\n");
+    printf("  test ...、orin reset|recovery、n305 toggle|reset 作为后台任务执行，立即返回任务号\n");
+    printf("  <命令> --fg          - 在控制台中直接执行，完成后才返回\n");
+    printf("  jobs                 - 列出后台任务 (状态、排队/运行时间、结果)\n");
+    printf("  wait <id> [超时ms]   - 等待任务结束并显示结果\n");
+    printf("  cancel <id>          - 取消排队中的任务或中止压力测试\n");
+    printf("\n命令统计:\n");
+    printf("  cmdstats             - 每条命令的调用/失败次数、平均/p99/最大耗时\n");
+    printf("  cmdstats <命令>      - 单条命令的统计与耗时直方图\n");
+    printf("  cmdstats slow [ms]   - 查看慢命令日志或设置阈值\n");
+    printf("  cmdstats reset       - 清零统计\n");
+    printf("\n批处理与宏:\n");
+    printf("  a ; b                - 依次执行\n");
+    printf("  a && b               - a 成功(返回0)时执行 b\n");
+    printf("  a || b               - a 失败时执行 b\n");
+    printf("  macro def <名称> \"<批处理>\" - 定义宏并保存到NVS\n");
+    printf("  macro [list]         - 列出宏及执行次数、耗时\n");
+    printf("  macro show|run|del <名称> - 查看、执行、删除宏\n");
+    printf("  批处理和宏中的耗时命令直接执行，返回值用于条件判断\n");
     printf("\n注意：\n");
     printf("  • 使用 TAB 键自动补全，上下箭头浏览历史\n");
     printf("  • GPIO输入操作使用 'input' 参数以避免状态干扰\n");
@@ -430,8 +1080,40 @@ static int cmd_help(int argc, char **argv)
     return 0;
 }
 
+static int cmd_info_json(void)
+{
+    device_status_t status;
+    esp_err_t ret = device_get_full_status(&status);
+    if (ret != ESP_OK) {
+        return json_print_error("info", ret);
+    }
+
+    char buf[CONSOLE_JSON_BUF_SIZE];
+    console_json_t json;
+    json_begin_command(&json, buf, sizeof(buf), "info");
+    console_json_device_status(&json, "device", &status);
+    console_json_monitor_stats(&json, "monitor");
+
+    uint32_t commands_executed;
+    uint64_t uptime_ms;
+    if (console_interface_get_stats(&commands_executed, &uptime_ms) == ESP_OK) {
+        console_json_begin_object(&json, "console");
+        console_json_uint(&json, "commands_executed", commands_executed);
+        console_json_uint(&json, "uptime_ms", uptime_ms);
+        console_json_end_object(&json);
+    }
+
+    console_json_end_object(&json);
+    console_json_finish(&json);
+    return 0;
+}
+
 static int cmd_info(int argc, char **argv)
 {
+    if (take_json_flag(&argc, argv)) {
+        return cmd_info_json();
+    }
+
     device_print_full_status();
     
     // 显示控制台统计
@@ -449,13 +1131,28 @@ static int cmd_info(int argc, char **argv)
 
 static int cmd_status(int argc, char **argv)
 {
+    bool json_output = take_json_flag(&argc, argv);
     device_status_t status;
     esp_err_t ret = device_get_full_status(&status);
     if (ret != ESP_OK) {
+        if (json_output) {
+            return json_print_error("status", ret);
+        }
         printf("获取设备状态失败: %s\n", esp_err_to_name(ret));
         return 1;
     }
 
+    if (json_output) {
+        char buf[CONSOLE_JSON_BUF_SIZE];
+        console_json_t json;
+        json_begin_command(&json, buf, sizeof(buf), "status");
+        console_json_device_status(&json, "device", &status);
+        console_json_cmdstats(&json, "cmdstats");
+        console_json_end_object(&json);
+        console_json_finish(&json);
+        return 0;
+    }
+
     printf("\n=== 当前状态 ===\n");
     if (status.hardware_available) {
         printf("风扇速度: %d%%\n", status.hardware.fan_speed);
@@ -477,59 +1174,900 @@ static int cmd_reboot(int argc, char **argv)
     return 0;
 }
 
-static int cmd_fan(int argc, char **argv)
+static int cmd_top(int argc, char **argv)
 {
-    if (argc < 2) {
-        printf("用法: fan <0-100> | on | off\n");
-        return 1;
-    }
-    
-    esp_err_t ret = ESP_OK;
-    if (strcmp(argv[1], "off") == 0) {
-        ret = fan_stop();
+    if (argc >= 2 && strcmp(argv[1], "history") == 0) {
+        cpu_usage_print_history();
+        return 0;
     }
-    else if (strcmp(argv[1], "on") == 0) {
-        ret = fan_start();
-    }
-    else {
-        int speed = atoi(argv[1]);
-        if (speed >= 0 && speed <= 100) {
-            ret = fan_set_speed(speed);
-        } else {
-            printf("风扇速度必须在0-100之间\n");
+
+    if (argc >= 2 && strcmp(argv[1], "dump") == 0) {
+        size_t size = cpu_usage_get_dump_size();
+        uint8_t *buffer = malloc(size);
+        if (buffer == NULL) {
+            printf("内存不足\n");
+            return 1;
+        }
+
+        size_t len = 0;
+        esp_err_t ret = cpu_usage_dump_binary(buffer, size, &len);
+        if (ret != ESP_OK) {
+            printf("导出失败: %s\n", esp_err_to_name(ret));
+            free(buffer);
             return 1;
         }
+
+        // 每行32字节十六进制，便于主机端解析
+        printf("CPUDUMP BEGIN %u\n", (unsigned)len);
+        for (size_t i = 0; i < len; i += 32) {
+            for (size_t j = i; j < len && j < i + 32; j++) {
+                printf("%02x", buffer[j]);
+            }
+            printf("\n");
+        }
+        printf("CPUDUMP END\n");
+        free(buffer);
+        return 0;
     }
-    
+
+    if (argc >= 2) {
+        printf("用法: top [history|dump]\n");
+        return 1;
+    }
+
+    cpu_usage_sample_t *sample = malloc(sizeof(cpu_usage_sample_t));
+    if (sample == NULL) {
+        printf("内存不足\n");
+        return 1;
+    }
+
+    // 不推进采样基准，历史记录仍由监控任务按固定周期写入
+    esp_err_t ret = cpu_usage_peek(sample);
     if (ret != ESP_OK) {
-        printf("风扇控制失败: %s\n", esp_err_to_name(ret));
+        printf("CPU占用率采样失败: %s\n", esp_err_to_name(ret));
+        free(sample);
         return 1;
     }
+
+    cpu_usage_print_sample(sample);
+    free(sample);
     return 0;
 }
 
-static int cmd_bled(int argc, char **argv)
+static int cmd_mem(int argc, char **argv)
 {
-    if (argc < 2) {
-        printf("用法: bled <r> <g> <b> | bright <0-100> | off | rainbow\n");
-        return 1;
+    bool json_output = take_json_flag(&argc, argv);
+    if (argc == 1 && json_output) {
+        system_memory_snapshot_t snapshot;
+        esp_err_t ret = system_get_memory_snapshot(&snapshot);
+        if (ret != ESP_OK) {
+            return json_print_error("mem", ret);
+        }
+
+        char buf[CONSOLE_JSON_BUF_SIZE];
+        console_json_t json;
+        json_begin_command(&json, buf, sizeof(buf), "mem");
+        console_json_memory_snapshot(&json, "memory", &snapshot);
+        console_json_uint(&json, "alarms", system_check_memory_alarms(&snapshot));
+        console_json_monitor_stats(&json, "monitor");
+        console_json_end_object(&json);
+        console_json_finish(&json);
+        return 0;
     }
-    
-    esp_err_t ret = ESP_OK;
-    if (strcmp(argv[1], "off") == 0) {
-        ret = board_led_turn_off();
+
+    if (argc == 1) {
+        system_print_memory_status();
+        return 0;
     }
-    else if (strcmp(argv[1], "bright") == 0) {
-        if (argc < 3) {
-            printf("用法: bled bright <0-100>\n");
+
+    if (argc != 3) {
+        printf("用法: mem [--json] | mem <internal|dma|block|frag> <值>\n");
+        return 1;
+    }
+
+    system_memory_thresholds_t thresholds;
+    system_monitor_get_memory_thresholds(&thresholds);
+
+    uint32_t value = (uint32_t)strtoul(argv[2], NULL, 10);
+    if (strcmp(argv[1], "internal") == 0) {
+        thresholds.internal_free_bytes = value;
+    } else if (strcmp(argv[1], "dma") == 0) {
+        thresholds.dma_free_bytes = value;
+    } else if (strcmp(argv[1], "block") == 0) {
+        thresholds.largest_block_bytes = value;
+    } else if (strcmp(argv[1], "frag") == 0) {
+        if (value > 100) {
+            printf("碎片率阈值必须在0-100之间\n");
             return 1;
         }
-        int brightness = atoi(argv[2]);
-        if (brightness >= 0 && brightness <= 100) {
-            ret = board_led_set_brightness(brightness);
-        } else {
-            printf("亮度必须在0-100之间\n");
-            return 1;
+        thresholds.fragmentation_percent = (uint8_t)value;
+    } else {
+        printf("未知阈值类型: %s\n", argv[1]);
+        return 1;
+    }
+
+    esp_err_t ret = system_monitor_set_memory_thresholds(&thresholds);
+    if (ret != ESP_OK) {
+        printf("设置内存阈值失败: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+
+    printf("内存告警阈值已更新: %s = %" PRIu32 "\n", argv[1], value);
+    return 0;
+}
+
+static void metrics_hex_writer(const uint8_t *data, size_t len, void *ctx)
+{
+    (void)ctx;
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", data[i]);
+    }
+    printf("\n");
+}
+
+static bool parse_metrics_tier(const char *arg, metrics_tier_t *tier)
+{
+    if (strcmp(arg, "1s") == 0) {
+        *tier = METRICS_TIER_1S;
+        return true;
+    }
+    if (strcmp(arg, "1m") == 0) {
+        *tier = METRICS_TIER_1M;
+        return true;
+    }
+    return false;
+}
+
+static int cmd_metrics(int argc, char **argv)
+{
+    if (!metrics_store_is_initialized()) {
+        printf("指标存储未初始化\n");
+        return 1;
+    }
+
+    if (argc == 1) {
+        metrics_store_print_summary();
+        return 0;
+    }
+
+    metrics_tier_t tier;
+    if (parse_metrics_tier(argv[1], &tier)) {
+        uint32_t count = argc >= 3 ? (uint32_t)strtoul(argv[2], NULL, 10) : 10;
+        metrics_store_print(tier, count);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "dump") == 0 && argc >= 3 && parse_metrics_tier(argv[2], &tier)) {
+        uint32_t count = argc >= 4 ? (uint32_t)strtoul(argv[3], NULL, 10) : 0;
+        // 第一行为头部，之后每行一个时间桶
+        printf("METRICS BEGIN %s\n", argv[2]);
+        metrics_store_export(tier, count, metrics_hex_writer, NULL);
+        printf("METRICS END\n");
+        return 0;
+    }
+
+    if (strcmp(argv[1], "flash") == 0) {
+        if (!metrics_store_flash_available()) {
+            printf("Flash溢出未启用 (分区表中无 '%s' 分区)\n", METRICS_STORE_PARTITION_LABEL);
+            return 1;
+        }
+        uint32_t count = argc >= 3 ? (uint32_t)strtoul(argv[2], NULL, 10) : 0;
+        printf("METRICS FLASH BEGIN\n");
+        esp_err_t ret = metrics_store_flash_export(count, metrics_hex_writer, NULL);
+        printf("METRICS FLASH END\n");
+        if (ret != ESP_OK) {
+            printf("导出失败: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        return 0;
+    }
+
+    printf("用法: metrics [1s|1m [n]] | dump <1s|1m> [n] | flash [n]\n");
+    return 1;
+}
+
+static int cmd_lat(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "reset") == 0) {
+        api_latency_reset();
+        printf("调用延迟统计已清零\n");
+        return 0;
+    }
+
+    api_latency_print(argc >= 2 ? argv[1] : NULL);
+    return 0;
+}
+
+static void trace_line_writer(const char *line, void *ctx)
+{
+    (void)ctx;
+    printf("%s\n", line);
+}
+
+static int cmd_trace(int argc, char **argv)
+{
+    if (argc == 1) {
+        event_trace_stats_t stats;
+        event_trace_get_stats(&stats);
+        printf("\n=== 事件跟踪 ===\n");
+        printf("状态: %s\n", stats.enabled ? "记录中" : "已暂停");
+        for (int core = 0; core < EVENT_TRACE_MAX_CORES; core++) {
+            printf("核心%d: 写入 %" PRIu32 " 条, 覆盖 %" PRIu32 " 条 (缓冲区 %d 条)\n",
+                   core, stats.written[core], stats.dropped[core], EVENT_TRACE_RING_LEN);
+        }
+        printf("================\n");
+        return 0;
+    }
+
+    if (strcmp(argv[1], "on") == 0) {
+        event_trace_enable(true);
+        printf("事件跟踪已开始\n");
+    } else if (strcmp(argv[1], "off") == 0) {
+        event_trace_enable(false);
+        printf("事件跟踪已暂停\n");
+    } else if (strcmp(argv[1], "clear") == 0) {
+        event_trace_clear();
+        printf("事件跟踪缓冲区已清空\n");
+    } else if (strcmp(argv[1], "dump") == 0) {
+        event_trace_dump(trace_line_writer, NULL);
+    } else {
+        printf("用法: trace [on|off|clear|dump]\n");
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_boot(int argc, char **argv)
+{
+    boot_profile_print();
+    return 0;
+}
+
+static int cmd_events(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "reset") == 0) {
+        event_bus_reset_stats();
+        printf("事件总线统计已清零\n");
+        return 0;
+    }
+
+    event_bus_print_stats();
+    return 0;
+}
+
+static int cmd_power(int argc, char **argv)
+{
+    if (argc < 2) {
+        power_manager_print_stats();
+        return 0;
+    }
+
+    if (strcmp(argv[1], "locks") == 0) {
+        if (power_manager_print_locks() != ESP_OK) {
+            printf("电源管理未启用 (CONFIG_PM_ENABLE)\n");
+            return 1;
+        }
+        return 0;
+    }
+
+    if (strcmp(argv[1], "reset") == 0) {
+        power_manager_reset_stats();
+        printf("睡眠统计已清零\n");
+        return 0;
+    }
+
+    if (strcmp(argv[1], "sleep") == 0 && argc >= 3 &&
+        (strcmp(argv[2], "on") == 0 || strcmp(argv[2], "off") == 0)) {
+        bool enable = strcmp(argv[2], "on") == 0;
+        esp_err_t ret = power_manager_set_light_sleep(enable);
+        if (ret != ESP_OK) {
+            printf("设置失败: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        printf("自动浅睡眠已%s\n", enable ? "启用" : "禁用");
+        return 0;
+    }
+
+    printf("用法: power [locks|reset|sleep <on|off>]\n");
+    return 1;
+}
+
+static int cmd_bench(int argc, char **argv)
+{
+    if (argc < 2 || strcmp(argv[1], "list") == 0) {
+        bench_print_list();
+        return 0;
+    }
+
+    bench_params_t params = BENCH_DEFAULT_PARAMS();
+    if (argc >= 4 && strcmp(argv[2], "iter") == 0) {
+        params.iterations = (uint32_t)strtoul(argv[3], NULL, 10);
+    } else if (argc >= 4 && strcmp(argv[2], "time") == 0) {
+        params.duration_ms = (uint32_t)strtoul(argv[3], NULL, 10);
+        if (params.duration_ms == 0 || params.duration_ms > BENCH_MAX_DURATION_MS) {
+            printf("时长范围: 1-%d ms\n", BENCH_MAX_DURATION_MS);
+            return 1;
+        }
+    } else if (argc != 2) {
+        printf("用法: bench [list] | bench <名称|all> [iter <n>|time <ms>]\n");
+        return 1;
+    }
+
+    esp_err_t ret = bench_run_print(argv[1], &params);
+    if (ret != ESP_OK) {
+        printf("基准测试失败: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_bench_nop(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    return 0;
+}
+
+static esp_err_t bench_dispatch(void *ctx, uint32_t iteration)
+{
+    (void)ctx;
+    (void)iteration;
+    // 带参数以包含命令行拆分的开销
+    int ret = 0;
+    return esp_console_run("bench_nop 1 2", &ret);
+}
+
+static int cmd_bench_args(int argc, char **argv)
+{
+    // 只解析不输出，解析结果体现在返回值中
+    if (argc < 3) {
+        return 1;
+    }
+
+    uint32_t value;
+    bool enable;
+    switch (console_dispatch_subcmd(&s_bench_args_subcmds, argv[1])) {
+        case BENCH_ARGS_SET:
+        case BENCH_ARGS_GET:
+            return console_dispatch_arg_u32(argv[2], 0, UINT32_MAX, &value) == ESP_OK ? 0 : 1;
+        case BENCH_ARGS_MODE:
+            return console_dispatch_arg_bool(argv[2], &enable) == ESP_OK ? 0 : 1;
+        case BENCH_ARGS_NAME:
+            return argv[2][0] != '\0' ? 0 : 1;
+        default:
+            return 1;
+    }
+}
+
+static esp_err_t bench_dispatch_hash(void *ctx, uint32_t iteration)
+{
+    (void)ctx;
+    (void)iteration;
+    // 与 cmd_dispatch 相同的命令行，每次重新复制到可写缓冲区
+    char line[] = "bench_nop 1 2";
+    int ret = 0;
+    return console_dispatch_run_line(line, &ret);
+}
+
+// 模拟脚本输入：空命令、子命令、数值/开关参数和带引号的参数
+static const char *const s_bench_script[] = {
+    "bench_nop",
+    "bench_args set 42",
+    "bench_args mode on",
+    "bench_nop 1 2 --fg",
+    "bench_args name \"two words\"",
+    "bench_args get 0x10",
+    "bench_args mode off",
+    "bench_args set 100000",
+};
+
+#define BENCH_SCRIPT_LINES (sizeof(s_bench_script) / sizeof(s_bench_script[0]))
+
+static esp_err_t bench_script(void *ctx, uint32_t iteration)
+{
+    (void)ctx;
+    // 与控制台执行路径相同：复制到栈上的行缓冲区后原地分词
+    const char *src = s_bench_script[iteration % BENCH_SCRIPT_LINES];
+    char line[CONSOLE_BUF_SIZE];
+    memcpy(line, src, strlen(src) + 1);
+    int ret = 0;
+    esp_err_t err = console_dispatch_run_line(line, &ret);
+    return err == ESP_OK && ret == 0 ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t bench_script_esp(void *ctx, uint32_t iteration)
+{
+    (void)ctx;
+    int ret = 0;
+    esp_err_t err = esp_console_run(s_bench_script[iteration % BENCH_SCRIPT_LINES], &ret);
+    return err == ESP_OK && ret == 0 ? ESP_OK : ESP_FAIL;
+}
+
+static int cmd_rpc(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "reset") == 0) {
+        console_rpc_reset_stats();
+        printf("RPC统计已清零\n");
+        return 0;
+    }
+    console_rpc_print_stats();
+    return 0;
+}
+
+static int cmd_output(int argc, char **argv)
+{
+    if (argc == 1) {
+        printf("输出格式: %s\n", s_console_state.output_mode == CONSOLE_OUTPUT_JSON ? "json" : "text");
+        return 0;
+    }
+
+    if (strcmp(argv[1], "stats") == 0) {
+        console_output_print_stats();
+        return 0;
+    }
+
+    if (strcmp(argv[1], "reset") == 0) {
+        console_output_reset_stats();
+        printf("输出统计已清零\n");
+        return 0;
+    }
+
+    if (strcmp(argv[1], "buffer") == 0) {
+        if (argc != 3 || (strcmp(argv[2], "on") != 0 && strcmp(argv[2], "off") != 0)) {
+            printf("用法: output buffer <on|off>\n");
+            return 1;
+        }
+        console_output_set_buffered(strcmp(argv[2], "on") == 0);
+        printf("命令输出缓冲已%s\n", strcmp(argv[2], "on") == 0 ? "启用" : "禁用");
+        return 0;
+    }
+
+    if (strcmp(argv[1], "json") == 0) {
+        console_interface_set_output_mode(CONSOLE_OUTPUT_JSON);
+    } else if (strcmp(argv[1], "text") == 0) {
+        console_interface_set_output_mode(CONSOLE_OUTPUT_TEXT);
+    } else {
+        printf("用法: output [text|json|stats|reset|buffer <on|off>]\n");
+        return 1;
+    }
+
+    printf("输出格式已切换为 %s\n", argv[1]);
+    return 0;
+}
+
+static int cmd_baud(int argc, char **argv)
+{
+    if (argc == 1) {
+        console_baud_print_status();
+        return 0;
+    }
+
+    if (strcmp(argv[1], "test") == 0) {
+        const uint32_t *rates;
+        size_t count = console_baud_get_rates(&rates);
+        uint32_t single;
+        if (argc >= 3) {
+            single = (uint32_t)strtoul(argv[2], NULL, 10);
+            if (!console_baud_is_supported(single)) {
+                printf("不支持的波特率: %s\n", argv[2]);
+                return 1;
+            }
+            rates = &single;
+            count = 1;
+        }
+
+        printf("UART回环自检，每个速率 %d bytes，期间TX引脚输出测试数据\n", CONSOLE_BAUD_TEST_BYTES);
+        printf("%10s %10s %8s %12s %10s\n", "波特率", "收到", "错误", "吞吐(B/s)", "效率");
+        int failures = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!console_baud_is_supported(rates[i])) {
+                continue;
+            }
+            // 自检期间不能有输出进入回环
+            console_output_flush();
+            console_baud_test_result_t result;
+            esp_err_t ret = console_baud_self_test(rates[i], &result);
+            if (ret != ESP_OK) {
+                printf("%10" PRIu32 " 自检失败: %s\n", rates[i], esp_err_to_name(ret));
+                failures++;
+                continue;
+            }
+            // 效率: 实测吞吐与线路速率 (8N1每字节10位) 之比
+            uint32_t line_rate = result.baud / 10;
+            printf("%10" PRIu32 " %10" PRIu32 " %8" PRIu32 " %12" PRIu32 " %9" PRIu32 "%%\n",
+                   result.baud, result.received, result.errors, result.bytes_per_sec,
+                   line_rate ? result.bytes_per_sec * 100 / line_rate : 0);
+            if (result.errors > 0 || result.received < result.bytes) {
+                failures++;
+            }
+        }
+        return failures ? 1 : 0;
+    }
+
+    if (strcmp(argv[1], "save") == 0) {
+        esp_err_t ret = console_baud_save();
+        if (ret != ESP_OK) {
+            printf("保存波特率失败: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        printf("波特率已保存，下次启动生效\n");
+        return 0;
+    }
+
+    uint32_t baud;
+    bool persist = argc >= 3 && strcmp(argv[2], "save") == 0;
+    if (strcmp(argv[1], "reset") == 0) {
+        esp_err_t ret = console_baud_clear_saved();
+        if (ret != ESP_OK) {
+            printf("清除保存的波特率失败: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        printf("已清除保存的波特率\n");
+        baud = CONSOLE_BAUD_DEFAULT;
+        persist = false;
+        console_baud_status_t status;
+        console_baud_get_status(&status);
+        if (status.current == baud) {
+            return 0;
+        }
+    } else {
+        baud = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    esp_err_t ret = console_baud_request(baud, 0, persist);
+    if (ret == ESP_ERR_NOT_SUPPORTED) {
+        printf("不支持的波特率: %s\n", argv[1]);
+        return 1;
+    } else if (ret != ESP_OK) {
+        printf("切换波特率失败: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+
+    printf("即将切换到 %" PRIu32 " baud%s\n", baud, persist ? "，确认后保存" : "");
+    printf("请在 %d 秒内以新波特率输入任意命令确认，否则自动恢复\n", CONSOLE_BAUD_CONFIRM_MS / 1000);
+    return 0;
+}
+
+static bool parse_job_id(const char *arg, uint32_t *id)
+{
+    char *end = NULL;
+    unsigned long value = strtoul(arg, &end, 10);
+    if (end == arg || *end != '\0' || value == 0 || value > UINT32_MAX) {
+        printf("无效的任务号: %s\n", arg);
+        return false;
+    }
+    *id = (uint32_t)value;
+    return true;
+}
+
+static int cmd_jobs(int argc, char **argv)
+{
+    return console_jobs_print() == ESP_OK ? 0 : 1;
+}
+
+static int cmd_wait(int argc, char **argv)
+{
+    uint32_t id;
+    if (argc < 2) {
+        printf("用法: wait <id> [超时ms]\n");
+        return 1;
+    }
+    if (!parse_job_id(argv[1], &id)) {
+        return 1;
+    }
+    uint32_t timeout_ms = argc >= 3 ? (uint32_t)strtoul(argv[2], NULL, 10) : 0;
+
+    // 等待前写出已有输出，任务的进度输出不会被缓冲区挡住
+    console_output_flush();
+    console_job_info_t info;
+    esp_err_t ret = console_jobs_wait(id, timeout_ms, &info);
+    if (ret == ESP_ERR_NOT_FOUND) {
+        printf("任务不存在: %" PRIu32 "\n", id);
+        return 1;
+    } else if (ret == ESP_ERR_TIMEOUT) {
+        printf("等待任务 %" PRIu32 " 超时 (%" PRIu32 " ms)\n", id, timeout_ms);
+        return 1;
+    } else if (ret != ESP_OK) {
+        printf("等待失败: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+
+    printf("任务 %" PRIu32 ": %s，结果 %d，排队 %" PRIu32 " ms，运行 %" PRIu32 " ms\n", id,
+           console_jobs_state_name(info.state), info.result, info.queued_ms, info.run_ms);
+    return info.state == CONSOLE_JOB_DONE ? 0 : 1;
+}
+
+static int cmd_cancel(int argc, char **argv)
+{
+    uint32_t id;
+    if (argc < 2) {
+        printf("用法: cancel <id>\n");
+        return 1;
+    }
+    if (!parse_job_id(argv[1], &id)) {
+        return 1;
+    }
+
+    esp_err_t ret = console_jobs_cancel(id);
+    switch (ret) {
+        case ESP_OK:
+            printf("已取消任务 %" PRIu32 "\n", id);
+            return 0;
+        case ESP_ERR_NOT_FOUND:
+            printf("任务不存在: %" PRIu32 "\n", id);
+            break;
+        case ESP_ERR_INVALID_STATE:
+            printf("任务 %" PRIu32 " 已结束\n", id);
+            break;
+        case ESP_ERR_NOT_SUPPORTED:
+            printf("任务 %" PRIu32 " 正在运行且不可中断 (电源时序/硬件测试)\n", id);
+            break;
+        default:
+            printf("取消失败: %s\n", esp_err_to_name(ret));
+            break;
+    }
+    return 1;
+}
+
+static int cmd_cmdstats(int argc, char **argv)
+{
+    bool json_output = take_json_flag(&argc, argv);
+    if (json_output) {
+        if (argc >= 2 && strcmp(argv[1], "reset") == 0) {
+            console_cmdstats_reset();
+        }
+        char buf[CONSOLE_JSON_BUF_SIZE];
+        console_json_t json;
+        json_begin_command(&json, buf, sizeof(buf), "cmdstats");
+        console_json_cmdstats(&json, "cmdstats");
+        console_json_end_object(&json);
+        console_json_finish(&json);
+        return 0;
+    }
+
+    if (argc < 2) {
+        return console_cmdstats_print(NULL) == ESP_OK ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "reset") == 0) {
+        console_cmdstats_reset();
+        printf("命令统计与慢命令日志已清零\n");
+        return 0;
+    }
+
+    if (strcmp(argv[1], "slow") == 0) {
+        if (argc >= 3) {
+            uint32_t threshold_ms;
+            if (console_dispatch_arg_u32(argv[2], 0, 3600000, &threshold_ms) != ESP_OK) {
+                printf("阈值范围: 0-3600000 ms\n");
+                return 1;
+            }
+            console_cmdstats_set_slow_threshold(threshold_ms);
+            printf("慢命令阈值: %" PRIu32 " ms\n", threshold_ms);
+            return 0;
+        }
+        return console_cmdstats_print_slow() == ESP_OK ? 0 : 1;
+    }
+
+    if (console_cmdstats_print(argv[1]) == ESP_ERR_NOT_FOUND) {
+        printf("命令不存在: %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_macro(int argc, char **argv)
+{
+    if (argc < 2 || strcmp(argv[1], "list") == 0) {
+        return console_script_macro_print_list() == ESP_OK ? 0 : 1;
+    }
+    if (argc < 3) {
+        printf("用法: macro [list|def <名称> \"<批处理>\"|show <名称>|run <名称>|del <名称>]\n");
+        return 1;
+    }
+
+    const char *name = argv[2];
+    esp_err_t ret;
+    if (strcmp(argv[1], "def") == 0) {
+        if (argc != 4) {
+            printf("用法: macro def <名称> \"<命令; 命令>\" (批处理需用引号括起)\n");
+            return 1;
+        }
+        ret = console_script_macro_define(name, argv[3]);
+        switch (ret) {
+            case ESP_OK: {
+                console_script_macro_info_t info;
+                console_script_macro_get_info(name, &info);
+                printf("宏 %s 已保存: %d 条命令，%d 字节\n", name, info.steps, info.code_len);
+                return 0;
+            }
+            case ESP_ERR_INVALID_ARG:
+                printf("宏名须为1-%d个字母、数字或下划线，批处理不能为空、引号须闭合\n",
+                       CONSOLE_SCRIPT_NAME_MAX_LEN);
+                break;
+            case ESP_ERR_INVALID_SIZE:
+                printf("宏过长: 最多 %d 条命令、每条 %d 个参数、共 %d 字节\n",
+                       CONSOLE_SCRIPT_MAX_STEPS, CONSOLE_SCRIPT_MAX_ARGS, CONSOLE_SCRIPT_MAX_CODE);
+                break;
+            case ESP_ERR_NO_MEM:
+                printf("宏数量已达上限 (%d)\n", CONSOLE_SCRIPT_MAX_MACROS);
+                break;
+            default:
+                printf("保存宏失败: %s\n", esp_err_to_name(ret));
+                break;
+        }
+        return 1;
+    }
+
+    if (strcmp(argv[1], "show") == 0) {
+        ret = console_script_macro_print(name);
+    } else if (strcmp(argv[1], "del") == 0) {
+        ret = console_script_macro_delete(name);
+        if (ret == ESP_OK) {
+            printf("宏 %s 已删除\n", name);
+        }
+    } else if (strcmp(argv[1], "run") == 0) {
+        console_script_result_t result;
+        ret = console_script_macro_run(name, &result);
+        if (ret == ESP_OK) {
+            printf("宏 %s: 执行 %d/%d 条 (跳过 %d)，结果 %d，耗时 %" PRIu32 ".%03" PRIu32 " ms\n",
+                   name, result.executed, result.steps, result.skipped, result.status,
+                   result.elapsed_us / 1000, result.elapsed_us % 1000);
+            return result.status;
+        }
+    } else {
+        printf("未知子命令: %s\n", argv[1]);
+        return 1;
+    }
+
+    if (ret == ESP_ERR_NOT_FOUND) {
+        printf("宏不存在: %s\n", name);
+    } else if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        printf("操作失败: %s\n", esp_err_to_name(ret));
+    }
+    return ret == ESP_OK ? 0 : 1;
+}
+
+static esp_err_t bench_rpc_dispatch(void *ctx, uint32_t iteration)
+{
+    (void)ctx;
+    // seq随迭代变化，避免命中重发缓存
+    uint8_t frame[CONSOLE_RPC_REQ_HEADER_LEN + 4 + CONSOLE_RPC_CRC_LEN] = {
+        (uint8_t)iteration, CONSOLE_RPC_MSG_PING, 'b', 'e', 'n', 'c'
+    };
+    uint16_t crc = console_rpc_crc16(0xFFFF, frame, sizeof(frame) - CONSOLE_RPC_CRC_LEN);
+    frame[sizeof(frame) - 2] = (uint8_t)(crc & 0xFF);
+    frame[sizeof(frame) - 1] = (uint8_t)(crc >> 8);
+
+    uint8_t encoded[sizeof(frame) + 2];
+    size_t len = console_rpc_cobs_encode(frame, sizeof(frame), encoded);
+    uint8_t out[CONSOLE_RPC_WIRE_BUF_SIZE];
+    return console_rpc_process(encoded, len, out, sizeof(out)) > 0 ? ESP_OK : ESP_FAIL;
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+static int cmd_sim(int argc, char **argv)
+{
+    if (argc < 2) {
+        board_hal_sim_print_state();
+        return 0;
+    }
+
+    if (strcmp(argv[1], "edges") == 0) {
+        uint32_t count = argc >= 3 ? (uint32_t)strtoul(argv[2], NULL, 10) : 32;
+        board_hal_sim_print_edges(count);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "clear") == 0) {
+        board_hal_sim_clear_edges();
+        printf("GPIO跳变日志已清空\n");
+        return 0;
+    }
+
+    if (strcmp(argv[1], "input") == 0 && argc >= 4) {
+        int pin = atoi(argv[2]);
+        int level = atoi(argv[3]);
+        if (board_hal_sim_set_input(pin, level) != ESP_OK) {
+            printf("无效的GPIO: %d\n", pin);
+            return 1;
+        }
+        printf("GPIO%d 外部输入: %d\n", pin, level ? 1 : 0);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "clock") == 0) {
+        if (argc >= 4 && strcmp(argv[2], "advance") == 0) {
+            uint32_t ms = (uint32_t)strtoul(argv[3], NULL, 10);
+            if (board_hal_sim_clock_advance((uint64_t)ms * 1000) != ESP_OK) {
+                printf("只能在step模式下推进时间\n");
+                return 1;
+            }
+        } else if (argc >= 3) {
+            board_hal_sim_clock_mode_t mode;
+            if (strcmp(argv[2], "real") == 0) {
+                mode = BOARD_HAL_SIM_CLOCK_REAL;
+            } else if (strcmp(argv[2], "virtual") == 0) {
+                mode = BOARD_HAL_SIM_CLOCK_VIRTUAL;
+            } else if (strcmp(argv[2], "step") == 0) {
+                mode = BOARD_HAL_SIM_CLOCK_STEP;
+            } else {
+                printf("用法: sim clock [real|virtual|step|advance <ms>]\n");
+                return 1;
+            }
+            esp_err_t ret = board_hal_sim_clock_set_mode(mode);
+            if (ret != ESP_OK) {
+                printf("切换时钟模式失败: %s\n", esp_err_to_name(ret));
+                return 1;
+            }
+        }
+
+        board_hal_sim_clock_stats_t stats;
+        board_hal_sim_clock_get_stats(&stats);
+        printf("时钟: %s, t=%lld ms, 虚拟跳过 %lld ms, 跳变 %" PRIu32 " 次, 唤醒 %" PRIu32 " 次, 等待中 %d\n",
+               board_hal_sim_clock_mode_name(stats.mode), (long long)(stats.now_us / 1000),
+               (long long)(stats.virtual_us / 1000), stats.jumps, stats.wakeups, stats.sleepers);
+        return 0;
+    }
+
+    printf("用法: sim [edges [n]|clear|input <pin> <0|1>|clock [real|virtual|step|advance <ms>]]\n");
+    return 1;
+}
+#endif
+
+static int cmd_fan(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("用法: fan <0-100> | on | off\n");
+        return 1;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    if (strcmp(argv[1], "off") == 0) {
+        ret = fan_stop();
+    }
+    else if (strcmp(argv[1], "on") == 0) {
+        ret = fan_start();
+    }
+    else {
+        int speed = atoi(argv[1]);
+        if (speed >= 0 && speed <= 100) {
+            ret = fan_set_speed(speed);
+        } else {
+            printf("风扇速度必须在0-100之间\n");
+            return 1;
+        }
+    }
+    
+    if (ret != ESP_OK) {
+        printf("风扇控制失败: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_bled(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("用法: bled <r> <g> <b> | bright <0-100> | off | rainbow\n");
+        return 1;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    if (strcmp(argv[1], "off") == 0) {
+        ret = board_led_turn_off();
+    }
+    else if (strcmp(argv[1], "bright") == 0) {
+        if (argc < 3) {
+            printf("用法: bled bright <0-100>\n");
+            return 1;
+        }
+        int brightness = atoi(argv[2]);
+        if (brightness >= 0 && brightness <= 100) {
+            ret = board_led_set_brightness(brightness);
+        } else {
+            printf("亮度必须在0-100之间\n");
+            return 1;
         }
     }
     else if (strcmp(argv[1], "rainbow") == 0) {
@@ -709,8 +2247,9 @@ static int cmd_usbmux(int argc, char **argv)
 
 static int cmd_orin(int argc, char **argv)
 {
+    bool fg = take_fg_flag(&argc, argv);
     if (argc < 2) {
-        printf("用法: orin on|off|reset|recovery|status\n");
+        printf("用法: orin on|off|reset|recovery|status [--fg]\n");
         return 1;
     }
     
@@ -720,51 +2259,62 @@ static int cmd_orin(int argc, char **argv)
         printf("请检查设备接口初始化状态\n");
         return 1;
     }
+
+    int sub = console_dispatch_subcmd(&s_orin_subcmds, argv[1]);
+
+    // 复位与恢复模式的电源时序耗时数秒，作为后台任务执行
+    if (!fg && (sub == ORIN_CMD_RESET || sub == ORIN_CMD_RECOVERY)) {
+        int job = submit_job(argc, argv, cmd_orin, CONSOLE_JOB_RES_ORIN, NULL);
+        if (job >= 0) {
+            return job;
+        }
+    }
     
     esp_err_t ret = ESP_OK;
+    power_state_t state;
     
-    if (strcmp(argv[1], "on") == 0) {
-        ret = orin_power_on();
-        if (ret == ESP_OK) {
-            printf("Orin设备已开机\n");
-        }
-    }
-    else if (strcmp(argv[1], "off") == 0) {
-        ret = orin_power_off();
-        if (ret == ESP_OK) {
-            printf("Orin设备已关机\n");
-        }
-    }
-    else if (strcmp(argv[1], "reset") == 0) {
-        printf("正在重启Orin设备...\n");
-        ret = orin_reset();
-        if (ret == ESP_OK) {
-            printf("Orin设备重启完成\n");
-        }
-    }
-    else if (strcmp(argv[1], "recovery") == 0) {
-        printf("正在进入Orin恢复模式...\n");
-        ret = orin_enter_recovery_mode();
-        if (ret == ESP_OK) {
-            printf("Orin设备已进入恢复模式\n");
-            printf("USB-C接口已自动切换到AGX\n");
-        }
-    }
-    else if (strcmp(argv[1], "status") == 0) {
-        power_state_t state;
-        ret = orin_get_power_state(&state);
-        if (ret == ESP_OK) {
-            printf("Orin电源状态: %s\n", power_state_get_name(state));
-        }
-    }
-    else {
-        printf("用法: orin on|off|reset|recovery|status\n");
-        printf("  on       - 开机Orin设备\n");
-        printf("  off      - 关机Orin设备\n");
-        printf("  reset    - 重启Orin设备\n");
-        printf("  recovery - 进入恢复模式并切换USB到AGX\n");
-        printf("  status   - 显示Orin电源状态\n");
-        return 1;
+    switch (sub) {
+        case ORIN_CMD_ON:
+            ret = orin_power_on();
+            if (ret == ESP_OK) {
+                printf("Orin设备已开机\n");
+            }
+            break;
+        case ORIN_CMD_OFF:
+            ret = orin_power_off();
+            if (ret == ESP_OK) {
+                printf("Orin设备已关机\n");
+            }
+            break;
+        case ORIN_CMD_RESET:
+            printf("正在重启Orin设备...\n");
+            ret = orin_reset();
+            if (ret == ESP_OK) {
+                printf("Orin设备重启完成\n");
+            }
+            break;
+        case ORIN_CMD_RECOVERY:
+            printf("正在进入Orin恢复模式...\n");
+            ret = orin_enter_recovery_mode();
+            if (ret == ESP_OK) {
+                printf("Orin设备已进入恢复模式\n");
+                printf("USB-C接口已自动切换到AGX\n");
+            }
+            break;
+        case ORIN_CMD_STATUS:
+            ret = orin_get_power_state(&state);
+            if (ret == ESP_OK) {
+                printf("Orin电源状态: %s\n", power_state_get_name(state));
+            }
+            break;
+        default:
+            printf("用法: orin on|off|reset|recovery|status\n");
+            printf("  on       - 开机Orin设备\n");
+            printf("  off      - 关机Orin设备\n");
+            printf("  reset    - 重启Orin设备\n");
+            printf("  recovery - 进入恢复模式并切换USB到AGX\n");
+            printf("  status   - 显示Orin电源状态\n");
+            return 1;
     }
     
     if (ret != ESP_OK) {
@@ -776,8 +2326,9 @@ static int cmd_orin(int argc, char **argv)
 
 static int cmd_n305(int argc, char **argv)
 {
+    bool fg = take_fg_flag(&argc, argv);
     if (argc < 2) {
-        printf("用法: n305 toggle|reset|status\n");
+        printf("用法: n305 toggle|reset|status [--fg]\n");
         return 1;
     }
     
@@ -787,41 +2338,49 @@ static int cmd_n305(int argc, char **argv)
         printf("请检查设备接口初始化状态\n");
         return 1;
     }
+
+    int sub = console_dispatch_subcmd(&s_n305_subcmds, argv[1]);
+    if (!fg && (sub == N305_CMD_TOGGLE || sub == N305_CMD_RESET)) {
+        int job = submit_job(argc, argv, cmd_n305, CONSOLE_JOB_RES_N305, NULL);
+        if (job >= 0) {
+            return job;
+        }
+    }
     
     esp_err_t ret = ESP_OK;
+    power_state_t state;
     
-    if (strcmp(argv[1], "toggle") == 0) {
-        printf("正在切换N305电源状态...\n");
-        ret = n305_power_toggle();
-        if (ret == ESP_OK) {
-            power_state_t state;
-            if (n305_get_power_state(&state) == ESP_OK) {
-                printf("N305电源已切换到: %s\n", power_state_get_name(state));
-            } else {
-                printf("N305电源状态已切换\n");
+    switch (sub) {
+        case N305_CMD_TOGGLE:
+            printf("正在切换N305电源状态...\n");
+            ret = n305_power_toggle();
+            if (ret == ESP_OK) {
+                if (n305_get_power_state(&state) == ESP_OK) {
+                    printf("N305电源已切换到: %s\n", power_state_get_name(state));
+                } else {
+                    printf("N305电源状态已切换\n");
+                }
             }
-        }
-    }
-    else if (strcmp(argv[1], "reset") == 0) {
-        printf("正在重启N305设备...\n");
-        ret = n305_reset();
-        if (ret == ESP_OK) {
-            printf("N305设备重启完成\n");
-        }
-    }
-    else if (strcmp(argv[1], "status") == 0) {
-        power_state_t state;
-        ret = n305_get_power_state(&state);
-        if (ret == ESP_OK) {
-            printf("N305电源状态: %s\n", power_state_get_name(state));
-        }
-    }
-    else {
-        printf("用法: n305 toggle|reset|status\n");
-        printf("  toggle - 切换N305开机/关机状态\n");
-        printf("  reset  - 重启N305设备\n");
-        printf("  status - 显示N305电源状态\n");
-        return 1;
+            break;
+        case N305_CMD_RESET:
+            printf("正在重启N305设备...\n");
+            ret = n305_reset();
+            if (ret == ESP_OK) {
+                printf("N305设备重启完成\n");
+            }
+            break;
+        case N305_CMD_STATUS:
+            ret = n305_get_power_state(&state);
+            if (ret == ESP_OK) {
+                printf("N305电源状态: %s\n", power_state_get_name(state));
+            }
+            break;
+        default:
+            printf("用法: n305 toggle|reset|status\n");
+            printf("  toggle - 切换N305开机/关机状态\n");
+            printf("  reset  - 重启N305设备\n");
+            printf("  status - 显示N305电源状态\n");
+            return 1;
     }
     
     if (ret != ESP_OK) {
@@ -831,70 +2390,144 @@ static int cmd_n305(int argc, char **argv)
     return 0;
 }
 
+// 测试项占用的资源，0表示不作为后台任务（未知测试项或缺少参数，直接打印用法）
+static uint32_t test_job_resources(int item, int argc)
+{
+    switch (item) {
+        case TEST_ITEM_FAN:
+        case TEST_ITEM_BLED:
+        case TEST_ITEM_TLED:
+            return CONSOLE_JOB_RES_PERIPH;
+        case TEST_ITEM_GPIO:
+        case TEST_ITEM_GPIO_INPUT:
+            return argc >= 3 ? CONSOLE_JOB_RES_PERIPH : 0;
+        case TEST_ITEM_ALL:
+        case TEST_ITEM_QUICK:
+            return CONSOLE_JOB_RES_ALL;
+        case TEST_ITEM_STRESS:
+            // 基准测试用例会操作LED和GPIO
+            return argc >= 3 ? (CONSOLE_JOB_RES_BENCH | CONSOLE_JOB_RES_PERIPH) : 0;
+        case TEST_ITEM_NVS:
+            return CONSOLE_JOB_RES_BENCH;
+        default:
+            return 0;
+    }
+}
+
+// 解析测试命令的数值参数，无效时打印提示
+static bool parse_test_arg(const char *arg, uint32_t min, uint32_t max, uint32_t *value)
+{
+    esp_err_t ret = console_dispatch_arg_u32(arg, min, max, value);
+    if (ret == ESP_ERR_INVALID_SIZE) {
+        printf("参数超出范围 (%" PRIu32 "-%" PRIu32 "): %s\n", min, max, arg);
+    } else if (ret != ESP_OK) {
+        printf("无效的数值: %s\n", arg);
+    }
+    return ret == ESP_OK;
+}
+
 static int cmd_test(int argc, char **argv)
 {
+    bool fg = take_fg_flag(&argc, argv);
     if (argc < 2) {
-        printf("用法: test fan|bled|tled|gpio <pin>|gpio_input <pin>|orin|n305|all|quick|stress <ms>\n");
+        printf("用法: test fan|bled|tled|gpio <pin>|gpio_input <pin>|orin|n305|all|quick|stress <ms>|nvs [n] [--fg]\n");
         return 1;
     }
-    
-    esp_err_t ret = ESP_OK;
-    
-    if (strcmp(argv[1], "fan") == 0) {
-        ret = hardware_test_fan();
-    }
-    else if (strcmp(argv[1], "bled") == 0) {
-        ret = hardware_test_board_led();
-    }
-    else if (strcmp(argv[1], "tled") == 0) {
-        ret = hardware_test_touch_led();
-    }
-    else if (strcmp(argv[1], "gpio") == 0) {
-        if (argc < 3) {
-            printf("用法: test gpio <pin>\n");
-            return 1;
-        }
-        int pin = atoi(argv[2]);
-        printf("开始安全GPIO输出测试 (无状态验证以避免干扰)...\n");
-        ret = hardware_test_gpio(pin);
-    }
-    else if (strcmp(argv[1], "gpio_input") == 0) {
-        if (argc < 3) {
-            printf("用法: test gpio_input <pin>\n");
-            return 1;
+
+    int item = console_dispatch_subcmd(&s_test_items, argv[1]);
+    uint32_t resources = test_job_resources(item, argc);
+    if (!fg && resources != 0) {
+        // 压力测试由基准测试框架运行，可以中途中止；其余测试不可中断
+        int job = submit_job(argc, argv, cmd_test, resources,
+                             item == TEST_ITEM_STRESS ? bench_abort : NULL);
+        if (job >= 0) {
+            return job;
         }
-        int pin = atoi(argv[2]);
-        printf("开始GPIO输入模式测试...\n");
-        ret = hardware_test_gpio_input(pin);
-    }
-    else if (strcmp(argv[1], "all") == 0) {
-        ret = device_run_full_test();
     }
-    else if (strcmp(argv[1], "quick") == 0) {
-        ret = device_run_quick_test();
+
+    // 在控制台直接执行（--fg 或批处理中）时同样等待后台任务释放资源
+    if (!hold_resources(resources)) {
+        return 1;
     }
-    else if (strcmp(argv[1], "stress") == 0) {
-        if (argc < 3) {
-            printf("用法: test stress <ms>\n");
+    int result = run_test_item(item, argc, argv);
+    console_jobs_release(resources);
+    return result;
+}
+
+static int run_test_item(int item, int argc, char **argv)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t value = 0;
+    
+    switch (item) {
+        case TEST_ITEM_FAN:
+            ret = hardware_test_fan();
+            break;
+        case TEST_ITEM_BLED:
+            ret = hardware_test_board_led();
+            break;
+        case TEST_ITEM_TLED:
+            ret = hardware_test_touch_led();
+            break;
+        case TEST_ITEM_GPIO:
+            if (argc < 3) {
+                printf("用法: test gpio <pin>\n");
+                return 1;
+            }
+            if (!parse_test_arg(argv[2], 0, UINT8_MAX, &value)) {
+                return 1;
+            }
+            printf("开始安全GPIO输出测试 (无状态验证以避免干扰)...\n");
+            ret = hardware_test_gpio((uint8_t)value);
+            break;
+        case TEST_ITEM_GPIO_INPUT:
+            if (argc < 3) {
+                printf("用法: test gpio_input <pin>\n");
+                return 1;
+            }
+            if (!parse_test_arg(argv[2], 0, UINT8_MAX, &value)) {
+                return 1;
+            }
+            printf("开始GPIO输入模式测试...\n");
+            ret = hardware_test_gpio_input((uint8_t)value);
+            break;
+        case TEST_ITEM_ALL:
+            ret = device_run_full_test();
+            break;
+        case TEST_ITEM_QUICK:
+            ret = device_run_quick_test();
+            break;
+        case TEST_ITEM_STRESS:
+            if (argc < 3) {
+                printf("用法: test stress <ms>\n");
+                return 1;
+            }
+            if (!parse_test_arg(argv[2], 1, UINT32_MAX, &value)) {
+                return 1;
+            }
+            ret = device_run_stress_test(value);
+            break;
+        case TEST_ITEM_NVS:
+            if (argc >= 3 && !parse_test_arg(argv[2], 0, UINT32_MAX, &value)) {
+                return 1;
+            }
+            ret = device_config_benchmark(value);
+            break;
+        default:
+            printf("未知测试项: %s\n", argv[1]);
+            printf("可用测试:\n");
+            printf("  fan          - 风扇测试\n");
+            printf("  bled         - 板载LED测试\n");
+            printf("  tled         - 触摸LED测试\n");
+            printf("  gpio <pin>   - GPIO安全输出测试\n");
+            printf("  gpio_input <pin> - GPIO输入测试\n");
+            printf("  orin         - Orin电源控制测试\n");
+            printf("  n305         - N305电源控制测试\n");
+            printf("  all          - 完整测试\n");
+            printf("  quick        - 快速测试\n");
+            printf("  stress <ms>  - 压力测试 (全部基准测试)\n");
+            printf("  nvs [n]      - NVS配置存储方案对比\n");
             return 1;
-        }
-        uint32_t duration = atoi(argv[2]);
-        ret = device_run_stress_test(duration);
-    }
-    else {
-        printf("未知测试项: %s\n", argv[1]);
-        printf("可用测试:\n");
-        printf("  fan          - 风扇测试\n");
-        printf("  bled         - 板载LED测试\n");
-        printf("  tled         - 触摸LED测试\n");
-        printf("  gpio <pin>   - GPIO安全输出测试\n");
-        printf("  gpio_input <pin> - GPIO输入测试\n");
-        printf("  orin         - Orin电源控制测试\n");
-        printf("  n305         - N305电源控制测试\n");
-        printf("  all          - 完整测试\n");
-        printf("  quick        - 快速测试\n");
-        printf("  stress <ms>  - 压力测试\n");
-        return 1;
     }
     
     if (ret != ESP_OK) {
@@ -920,6 +2553,10 @@ static int cmd_save(int argc, char **argv)
 static int cmd_load(int argc, char **argv)
 {
     esp_err_t ret = device_load_config();
+    if (ret == ESP_ERR_NOT_FOUND) {
+        printf("NVS中没有保存的配置\n");
+        return 1;
+    }
     if (ret != ESP_OK) {
         printf("加载配置失败: %s\n", esp_err_to_name(ret));
         return 1;
@@ -939,29 +2576,182 @@ static int cmd_clear(int argc, char **argv)
     return 0;
 }
 
+static int cmd_autosave(int argc, char **argv)
+{
+    if (argc < 2) {
+        device_autosave_print_stats();
+        return 0;
+    }
+
+    esp_err_t ret;
+    if (strcmp(argv[1], "on") == 0 || strcmp(argv[1], "off") == 0) {
+        bool enable = strcmp(argv[1], "on") == 0;
+        ret = device_autosave_enable(enable);
+        if (ret != ESP_OK) {
+            printf("设置自动保存失败: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        printf("自动保存已%s\n", enable ? "启用" : "禁用");
+        return 0;
+    }
+
+    if (strcmp(argv[1], "flush") == 0) {
+        ret = device_autosave_flush();
+        if (ret != ESP_OK) {
+            printf("保存失败: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        printf("待保存的变化已处理\n");
+        return 0;
+    }
+
+    char *end;
+    unsigned long quiet_ms = strtoul(argv[1], &end, 10);
+    if (*end != '\0' || device_autosave_set_quiet_period(quiet_ms) != ESP_OK) {
+        printf("用法: autosave [on|off|flush|<静默期ms>]\n");
+        printf("静默期范围: %d-%d ms\n", DEVICE_AUTOSAVE_MIN_QUIET_MS, DEVICE_AUTOSAVE_MAX_DELAY_MS);
+        return 1;
+    }
+    printf("自动保存静默期设置为 %lu ms\n", quiet_ms);
+    return 0;
+}
+
+static int cmd_profile(int argc, char **argv)
+{
+    if (argc < 2 || strcmp(argv[1], "list") == 0) {
+        device_profile_print_list();
+        return 0;
+    }
+
+    if (argc < 3) {
+        printf("用法: profile [list|save <名称>|apply <名称> [渐变ms]|delete <名称>]\n");
+        return 1;
+    }
+
+    const char *name = argv[2];
+    esp_err_t ret;
+
+    if (strcmp(argv[1], "save") == 0) {
+        ret = device_profile_save(name);
+        if (ret == ESP_ERR_INVALID_ARG) {
+            printf("档案名须为1-%d个字符\n", DEVICE_PROFILE_NAME_MAX_LEN);
+            return 1;
+        }
+        if (ret == ESP_ERR_NO_MEM) {
+            printf("档案数已达上限 (%d)\n", DEVICE_PROFILE_MAX_COUNT);
+            return 1;
+        }
+        if (ret != ESP_OK) {
+            printf("保存档案失败: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        printf("当前设置已保存为档案 '%s'\n", name);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "apply") == 0) {
+        uint32_t fade_ms = argc >= 4 ? (uint32_t)strtoul(argv[3], NULL, 10) : 0;
+        device_profile_switch_result_t result;
+        ret = device_profile_apply(name, fade_ms, &result);
+        if (ret == ESP_ERR_NOT_FOUND) {
+            printf("档案 '%s' 不存在\n", name);
+            return 1;
+        }
+        if (ret == ESP_ERR_INVALID_ARG) {
+            printf("渐变时间不能超过 %d ms\n", DEVICE_PROFILE_MAX_FADE_MS);
+            return 1;
+        }
+        if (ret != ESP_OK) {
+            printf("切换档案失败: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        printf("已切换到档案 '%s': 首次提交 %" PRIu32 " us, 总耗时 %" PRIu32 " us (%" PRIu32 " 步)\n",
+               name, result.first_commit_us, result.total_us, result.steps);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "delete") == 0) {
+        ret = device_profile_delete(name);
+        if (ret == ESP_ERR_NOT_FOUND) {
+            printf("档案 '%s' 不存在\n", name);
+            return 1;
+        }
+        if (ret != ESP_OK) {
+            printf("删除档案失败: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        printf("档案 '%s' 已删除\n", name);
+        return 0;
+    }
+
+    printf("用法: profile [list|save <名称>|apply <名称> [渐变ms]|delete <名称>]\n");
+    return 1;
+}
+
 // 控制台任务实现
 static void console_task(void *pvParameters)
 {
     char input_buffer[CONSOLE_BUF_SIZE];
     int input_index = 0;
+    int last_c = EOF;
+
+    // 二进制RPC帧接收状态：收到0x00后进入帧，再次收到0x00时处理
+    static uint8_t rpc_rx[CONSOLE_RPC_MAX_ENCODED];
+    static uint8_t rpc_tx[CONSOLE_RPC_WIRE_BUF_SIZE];
+    bool rpc_in_frame = false;
+    size_t rpc_len = 0;
     
+#if !FAST_BOOT_ENABLED
     // 等待系统完全初始化
     vTaskDelay(pdMS_TO_TICKS(2000));
+#endif
     
+    // 本任务的输出改经console_output缓冲
+    console_output_attach();
+
     // 显示启动横幅
     console_interface_show_banner();
     console_interface_print_prompt();
+    boot_profile_complete("console_ready");
     
     while (s_console_state.running) {
         int c = getchar();
+        if (c != EOF) {
+            input_awake_note();
+        }
         
-        if (c == '\n' || c == '\r') {
+        if (rpc_in_frame && c != EOF) {
+            if (c != CONSOLE_RPC_DELIMITER) {
+                if (rpc_len < sizeof(rpc_rx)) {
+                    rpc_rx[rpc_len++] = (uint8_t)c;
+                } else {
+                    // 超长帧：丢弃并回到文本模式
+                    console_rpc_note_framing_error();
+                    rpc_in_frame = false;
+                }
+            } else if (rpc_len > 0) {
+                size_t n = console_rpc_process(rpc_rx, rpc_len, rpc_tx, sizeof(rpc_tx));
+                if (n > 0) {
+                    console_baud_note_valid_input();
+                    console_output_write_raw(rpc_tx, n);
+                    console_baud_apply_pending();
+                }
+                rpc_in_frame = false;
+            }
+            // 连续的0x00视为同一个帧起始分隔符
+        } else if (c == CONSOLE_RPC_DELIMITER) {
+            rpc_in_frame = true;
+            rpc_len = 0;
+        } else if (c == '\n' && last_c == '\r') {
+            // CRLF只算一次回车
+        } else if (c == '\n' || c == '\r') {
             // 处理输入
             input_buffer[input_index] = '\0';
             printf("\n");
             
             if (input_index > 0) {
-                // 执行命令
+                // 执行命令，输出合并后整块写出
+                console_output_begin_command(input_buffer);
                 esp_err_t err = console_interface_execute_command(input_buffer);
                 if (err == ESP_ERR_NOT_FOUND) {
                     printf("未知命令: '%s'\n", input_buffer);
@@ -971,6 +2761,12 @@ static void console_task(void *pvParameters)
                 } else if (err != ESP_OK) {
                     printf("命令执行错误: %s\n", esp_err_to_name(err));
                 }
+                console_output_end_command();
+                // 波特率切换在命令输出发完后进行；新波特率下命令执行成功即确认
+                if (err == ESP_OK) {
+                    console_baud_note_valid_input();
+                }
+                console_baud_apply_pending();
             }
             
             // 重置输入缓冲区
@@ -980,18 +2776,25 @@ static void console_task(void *pvParameters)
             // 退格处理
             if (input_index > 0) {
                 input_index--;
-                printf("\b \b");
-                fflush(stdout);
+                console_output_echo("\b \b", 3);
             }
         } else if (c >= 32 && c < 127 && input_index < CONSOLE_BUF_SIZE - 1) {
             // 可打印字符
             input_buffer[input_index++] = c;
-            printf("%c", c);
-            fflush(stdout);
+            // 回显快速路径，不经过stdio
+            char echo = (char)c;
+            console_output_echo(&echo, 1);
         }
         
-        // 短暂延迟，让其他任务有机会运行
-        vTaskDelay(pdMS_TO_TICKS(10));
+        if (c != EOF) {
+            last_c = c;
+        }
+
+        // 未安装UART驱动时getchar不阻塞，没有输入时短暂延迟后再轮询
+        if (!s_console_state.blocking_input && c == EOF) {
+            clearerr(stdin);
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
     }
     
     // 任务结束
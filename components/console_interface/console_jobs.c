@@ -0,0 +1,481 @@
+/**
+ * @file console_jobs.c
+ * @brief 控制台后台任务实现
+ */
+
+#include "console_jobs.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "console_cmdstats.h"
+
+static const char *TAG = "CONSOLE_JOBS";
+
+_Static_assert(CONSOLE_JOBS_MAX < 24, "job done bits must fit in an event group");
+
+#define RESOURCES_RELEASED_BIT  ((EventBits_t)1 << CONSOLE_JOBS_MAX)   // 有资源被释放
+
+// ==================== 内部状态 ====================
+
+typedef struct {
+    console_job_info_t info;        // info.id 为0表示空闲
+    console_job_func_t func;
+    console_job_cancel_t cancel;
+    uint32_t resources;
+    int argc;
+    char *argv[CONSOLE_JOBS_MAX_ARGS + 1];
+    char args[CONSOLE_JOBS_CMD_LEN];    // 以'\0'分隔的参数副本
+    int64_t submit_us;
+    int64_t start_us;
+    int64_t end_us;
+} job_slot_t;
+
+typedef struct {
+    bool initialized;
+    SemaphoreHandle_t lock;
+    EventGroupHandle_t done_bits;   // 第i位：第i个槽位的任务已结束；另有 RESOURCES_RELEASED_BIT
+    TaskHandle_t workers[CONSOLE_JOBS_WORKERS];
+    job_slot_t slots[CONSOLE_JOBS_MAX];
+    uint32_t next_id;
+    uint32_t busy_resources;        // 运行中任务和控制台直接执行的命令占用的资源
+} console_jobs_ctx_t;
+
+static console_jobs_ctx_t s_jobs = { .next_id = 1 };
+
+// ==================== 内部函数 ====================
+
+static bool is_finished(console_job_state_t state)
+{
+    return state == CONSOLE_JOB_DONE || state == CONSOLE_JOB_FAILED || state == CONSOLE_JOB_CANCELLED;
+}
+
+static EventBits_t slot_bit(const job_slot_t *job)
+{
+    return (EventBits_t)1 << (job - s_jobs.slots);
+}
+
+static job_slot_t *find_slot_locked(uint32_t id)
+{
+    for (int i = 0; i < CONSOLE_JOBS_MAX; i++) {
+        if (id != 0 && s_jobs.slots[i].info.id == id) {
+            return &s_jobs.slots[i];
+        }
+    }
+    return NULL;
+}
+
+static void fill_info_locked(const job_slot_t *job, console_job_info_t *info)
+{
+    int64_t now = esp_timer_get_time();
+    *info = job->info;
+    int64_t started = job->start_us;
+    if (started == 0) {
+        // 尚未运行，或排队中被取消
+        started = job->info.state == CONSOLE_JOB_QUEUED ? now : job->end_us;
+    }
+    info->queued_ms = (uint32_t)((started - job->submit_us) / 1000);
+    if (job->start_us != 0) {
+        int64_t ended = is_finished(job->info.state) ? job->end_us : now;
+        info->run_ms = (uint32_t)((ended - job->start_us) / 1000);
+    }
+}
+
+static void notify_workers(void)
+{
+    for (int i = 0; i < CONSOLE_JOBS_WORKERS; i++) {
+        if (s_jobs.workers[i] != NULL) {
+            xTaskNotifyGive(s_jobs.workers[i]);
+        }
+    }
+}
+
+// 按提交顺序选择下一个可运行的任务；排在前面但资源冲突的任务也为自己保留资源，
+// 后提交的任务不会插队
+static job_slot_t *take_next_job(void)
+{
+    job_slot_t *next = NULL;
+    xSemaphoreTake(s_jobs.lock, portMAX_DELAY);
+    uint32_t blocked = s_jobs.busy_resources;
+    uint32_t after_id = 0;
+    for (;;) {
+        job_slot_t *oldest = NULL;
+        for (int i = 0; i < CONSOLE_JOBS_MAX; i++) {
+            job_slot_t *job = &s_jobs.slots[i];
+            if (job->info.id > after_id && job->info.state == CONSOLE_JOB_QUEUED &&
+                (oldest == NULL || job->info.id < oldest->info.id)) {
+                oldest = job;
+            }
+        }
+        if (oldest == NULL) {
+            break;
+        }
+        if ((oldest->resources & blocked) == 0) {
+            next = oldest;
+            break;
+        }
+        blocked |= oldest->resources;
+        after_id = oldest->info.id;
+    }
+    if (next != NULL) {
+        next->info.state = CONSOLE_JOB_RUNNING;
+        next->start_us = esp_timer_get_time();
+        s_jobs.busy_resources |= next->resources;
+    }
+    xSemaphoreGive(s_jobs.lock);
+    return next;
+}
+
+static void finish_job(job_slot_t *job, int result)
+{
+    xSemaphoreTake(s_jobs.lock, portMAX_DELAY);
+    job->end_us = esp_timer_get_time();
+    job->info.result = result;
+    if (job->info.cancel_requested) {
+        job->info.state = CONSOLE_JOB_CANCELLED;
+    } else {
+        job->info.state = result == 0 ? CONSOLE_JOB_DONE : CONSOLE_JOB_FAILED;
+    }
+    s_jobs.busy_resources &= ~job->resources;
+    uint32_t id = job->info.id;
+    console_job_state_t state = job->info.state;
+    uint32_t run_ms = (uint32_t)((job->end_us - job->start_us) / 1000);
+    xSemaphoreGive(s_jobs.lock);
+
+    printf("[job %" PRIu32 "] %s (%" PRIu32 ".%" PRIu32 " s)\n", id, console_jobs_state_name(state),
+           run_ms / 1000, (run_ms % 1000) / 100);
+    xEventGroupSetBits(s_jobs.done_bits, slot_bit(job) | RESOURCES_RELEASED_BIT);
+    // 释放的资源可能使排队的任务可以运行
+    notify_workers();
+}
+
+static void worker_task(void *pvParameters)
+{
+    for (;;) {
+        job_slot_t *job = take_next_job();
+        if (job == NULL) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        printf("[job %" PRIu32 "] 开始: %s\n", job->info.id, job->info.command);
+        // 处理函数会移除 --fg 等参数，统计记录调用前的参数
+        char *args[CONSOLE_JOBS_MAX_ARGS + 1];
+        memcpy(args, job->argv, sizeof(args));
+        int64_t start_us = esp_timer_get_time();
+        int result = job->func(job->argc, job->argv);
+        console_cmdstats_record(job->argc, args, result, (uint32_t)(esp_timer_get_time() - start_us));
+        finish_job(job, result);
+    }
+}
+
+// ==================== 接口实现 ====================
+
+esp_err_t console_jobs_init(void)
+{
+    if (s_jobs.initialized) {
+        return ESP_OK;
+    }
+
+    s_jobs.lock = xSemaphoreCreateMutex();
+    s_jobs.done_bits = xEventGroupCreate();
+    if (s_jobs.lock == NULL || s_jobs.done_bits == NULL) {
+        ESP_LOGE(TAG, "Failed to create job table locks");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < CONSOLE_JOBS_WORKERS; i++) {
+        char name[configMAX_TASK_NAME_LEN];
+        snprintf(name, sizeof(name), "console_job%d", i);
+        if (xTaskCreate(worker_task, name, CONSOLE_JOBS_WORKER_STACK, NULL,
+                        CONSOLE_JOBS_WORKER_PRIORITY, &s_jobs.workers[i]) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create job worker %d", i);
+            // 已创建的工作任务继续可用
+            if (i == 0) {
+                return ESP_ERR_NO_MEM;
+            }
+            break;
+        }
+    }
+
+    s_jobs.initialized = true;
+    ESP_LOGI(TAG, "Job runner started with %d workers", CONSOLE_JOBS_WORKERS);
+    return ESP_OK;
+}
+
+bool console_jobs_in_worker(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < CONSOLE_JOBS_WORKERS; i++) {
+        if (s_jobs.workers[i] != NULL && s_jobs.workers[i] == self) {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t console_jobs_submit(console_job_func_t func, int argc, char **argv, uint32_t resources,
+                              console_job_cancel_t cancel, uint32_t *id)
+{
+    if (func == NULL || argc <= 0 || argv == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_jobs.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (argc > CONSOLE_JOBS_MAX_ARGS) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    size_t total = 0;
+    for (int i = 0; i < argc; i++) {
+        total += strlen(argv[i]) + 1;
+    }
+    if (total > CONSOLE_JOBS_CMD_LEN) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    xSemaphoreTake(s_jobs.lock, portMAX_DELAY);
+    // 优先使用空闲槽位，否则回收最早结束的任务
+    job_slot_t *slot = NULL;
+    for (int i = 0; i < CONSOLE_JOBS_MAX && slot == NULL; i++) {
+        if (s_jobs.slots[i].info.id == 0) {
+            slot = &s_jobs.slots[i];
+        }
+    }
+    if (slot == NULL) {
+        for (int i = 0; i < CONSOLE_JOBS_MAX; i++) {
+            job_slot_t *job = &s_jobs.slots[i];
+            if (is_finished(job->info.state) && (slot == NULL || job->info.id < slot->info.id)) {
+                slot = job;
+            }
+        }
+    }
+    if (slot == NULL) {
+        xSemaphoreGive(s_jobs.lock);
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(slot, 0, sizeof(*slot));
+    xEventGroupClearBits(s_jobs.done_bits, slot_bit(slot));
+    char *p = slot->args;
+    for (int i = 0; i < argc; i++) {
+        size_t len = strlen(argv[i]);
+        memcpy(p, argv[i], len + 1);
+        slot->argv[i] = p;
+        p += len + 1;
+    }
+    // 显示用的命令行：参数之间的'\0'换成空格
+    memcpy(slot->info.command, slot->args, total);
+    for (size_t i = 0; i + 1 < total; i++) {
+        if (slot->info.command[i] == '\0') {
+            slot->info.command[i] = ' ';
+        }
+    }
+    slot->argc = argc;
+    slot->func = func;
+    slot->cancel = cancel;
+    slot->resources = resources;
+    slot->submit_us = esp_timer_get_time();
+    slot->info.id = s_jobs.next_id++;
+    slot->info.state = CONSOLE_JOB_QUEUED;
+    if (s_jobs.next_id == 0) {
+        s_jobs.next_id = 1;
+    }
+    if (id != NULL) {
+        *id = slot->info.id;
+    }
+    xSemaphoreGive(s_jobs.lock);
+
+    notify_workers();
+    return ESP_OK;
+}
+
+esp_err_t console_jobs_acquire(uint32_t resources, uint32_t timeout_ms)
+{
+    if (resources == 0 || !s_jobs.initialized || console_jobs_in_worker()) {
+        return ESP_OK;
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    TickType_t limit = pdMS_TO_TICKS(timeout_ms);
+    for (;;) {
+        xSemaphoreTake(s_jobs.lock, portMAX_DELAY);
+        if ((s_jobs.busy_resources & resources) == 0) {
+            s_jobs.busy_resources |= resources;
+            xSemaphoreGive(s_jobs.lock);
+            return ESP_OK;
+        }
+        // 在锁内清除，之后的释放一定会重新置位
+        xEventGroupClearBits(s_jobs.done_bits, RESOURCES_RELEASED_BIT);
+        xSemaphoreGive(s_jobs.lock);
+
+        TickType_t waited = xTaskGetTickCount() - start;
+        if (waited >= limit) {
+            return ESP_ERR_TIMEOUT;
+        }
+        xEventGroupWaitBits(s_jobs.done_bits, RESOURCES_RELEASED_BIT, pdFALSE, pdTRUE, limit - waited);
+    }
+}
+
+void console_jobs_release(uint32_t resources)
+{
+    if (resources == 0 || !s_jobs.initialized || console_jobs_in_worker()) {
+        return;
+    }
+
+    xSemaphoreTake(s_jobs.lock, portMAX_DELAY);
+    s_jobs.busy_resources &= ~resources;
+    xSemaphoreGive(s_jobs.lock);
+    xEventGroupSetBits(s_jobs.done_bits, RESOURCES_RELEASED_BIT);
+    notify_workers();
+}
+
+esp_err_t console_jobs_cancel(uint32_t id)
+{
+    xSemaphoreTake(s_jobs.lock, portMAX_DELAY);
+    job_slot_t *job = find_slot_locked(id);
+    if (job == NULL) {
+        xSemaphoreGive(s_jobs.lock);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (is_finished(job->info.state)) {
+        xSemaphoreGive(s_jobs.lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (job->info.state == CONSOLE_JOB_QUEUED) {
+        job->info.state = CONSOLE_JOB_CANCELLED;
+        job->end_us = esp_timer_get_time();
+        xSemaphoreGive(s_jobs.lock);
+        xEventGroupSetBits(s_jobs.done_bits, slot_bit(job));
+        // 该任务保留的资源不再阻塞后面的任务
+        notify_workers();
+        return ESP_OK;
+    }
+    console_job_cancel_t cancel = job->cancel;
+    xSemaphoreGive(s_jobs.lock);
+
+    if (cancel == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    esp_err_t ret = cancel();
+    if (ret == ESP_OK) {
+        xSemaphoreTake(s_jobs.lock, portMAX_DELAY);
+        if (job->info.id == id && job->info.state == CONSOLE_JOB_RUNNING) {
+            job->info.cancel_requested = true;
+        }
+        xSemaphoreGive(s_jobs.lock);
+    }
+    return ret;
+}
+
+esp_err_t console_jobs_wait(uint32_t id, uint32_t timeout_ms, console_job_info_t *info)
+{
+    if (console_jobs_in_worker()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_jobs.lock, portMAX_DELAY);
+    job_slot_t *job = find_slot_locked(id);
+    xSemaphoreGive(s_jobs.lock);
+    if (job == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    TickType_t ticks = timeout_ms == 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    EventBits_t bit = slot_bit(job);
+    if ((xEventGroupWaitBits(s_jobs.done_bits, bit, pdFALSE, pdTRUE, ticks) & bit) == 0) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if (info != NULL && console_jobs_get(id, info) != ESP_OK) {
+        // 等待期间槽位已被新任务回收
+        memset(info, 0, sizeof(*info));
+        info->id = id;
+        info->state = CONSOLE_JOB_DONE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t console_jobs_get(uint32_t id, console_job_info_t *info)
+{
+    if (info == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_jobs.initialized) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    xSemaphoreTake(s_jobs.lock, portMAX_DELAY);
+    job_slot_t *job = find_slot_locked(id);
+    if (job != NULL) {
+        fill_info_locked(job, info);
+    }
+    xSemaphoreGive(s_jobs.lock);
+    return job != NULL ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+const char *console_jobs_state_name(console_job_state_t state)
+{
+    switch (state) {
+        case CONSOLE_JOB_QUEUED:
+            return "QUEUED";
+        case CONSOLE_JOB_RUNNING:
+            return "RUNNING";
+        case CONSOLE_JOB_DONE:
+            return "DONE";
+        case CONSOLE_JOB_FAILED:
+            return "FAILED";
+        case CONSOLE_JOB_CANCELLED:
+            return "CANCELLED";
+        default:
+            return "INVALID";
+    }
+}
+
+esp_err_t console_jobs_print(void)
+{
+    console_job_info_t jobs[CONSOLE_JOBS_MAX];
+    int count = 0;
+
+    if (s_jobs.initialized) {
+        xSemaphoreTake(s_jobs.lock, portMAX_DELAY);
+        for (int i = 0; i < CONSOLE_JOBS_MAX; i++) {
+            if (s_jobs.slots[i].info.id != 0) {
+                fill_info_locked(&s_jobs.slots[i], &jobs[count++]);
+            }
+        }
+        xSemaphoreGive(s_jobs.lock);
+    }
+
+    // 按任务号排序
+    for (int i = 1; i < count; i++) {
+        console_job_info_t tmp = jobs[i];
+        int j = i - 1;
+        while (j >= 0 && jobs[j].id > tmp.id) {
+            jobs[j + 1] = jobs[j];
+            j--;
+        }
+        jobs[j + 1] = tmp;
+    }
+
+    printf("\n=== 后台任务 ===\n");
+    printf("%-4s %-10s %9s %9s %4s  %s\n", "ID", "状态", "排队(ms)", "运行(ms)", "结果", "命令");
+    for (int i = 0; i < count; i++) {
+        const console_job_info_t *job = &jobs[i];
+        char result[8] = "-";
+        if (job->state == CONSOLE_JOB_DONE || job->state == CONSOLE_JOB_FAILED) {
+            snprintf(result, sizeof(result), "%d", job->result);
+        }
+        printf("%-4" PRIu32 " %-10s %9" PRIu32 " %9" PRIu32 " %4s  %s%s\n", job->id,
+               console_jobs_state_name(job->state), job->queued_ms, job->run_ms, result, job->command,
+               job->cancel_requested && job->state == CONSOLE_JOB_RUNNING ? " (取消中)" : "");
+    }
+    if (count == 0) {
+        printf("暂无任务\n");
+    }
+    printf("================\n");
+    return ESP_OK;
+}
@@ -0,0 +1,385 @@
+/**
+ * @file console_json.c
+ * @brief 控制台JSON输出实现
+ */
+
+#include "console_json.h"
+#include <stdio.h>
+#include <string.h>
+#include "console_cmdstats.h"
+
+// ==================== 写入器 ====================
+
+static void json_flush(console_json_t *json)
+{
+    if (json->len > 0) {
+        json->flush(json->buf, json->len, json->ctx);
+        json->len = 0;
+    }
+}
+
+static void json_put(console_json_t *json, char c)
+{
+    if (json->len >= json->size) {
+        json_flush(json);
+    }
+    json->buf[json->len++] = c;
+}
+
+static void json_write(console_json_t *json, const char *data, size_t len)
+{
+    while (len > 0) {
+        if (json->len >= json->size) {
+            json_flush(json);
+        }
+        size_t chunk = json->size - json->len;
+        if (chunk > len) {
+            chunk = len;
+        }
+        memcpy(json->buf + json->len, data, chunk);
+        json->len += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+static void json_write_escaped(console_json_t *json, const char *str)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    json_put(json, '"');
+    for (const char *p = str; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\') {
+            json_put(json, '\\');
+            json_put(json, (char)c);
+        } else if (c == '\n') {
+            json_write(json, "\\n", 2);
+        } else if (c < 0x20) {
+            char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0F] };
+            json_write(json, esc, sizeof(esc));
+        } else {
+            // UTF-8多字节序列原样输出
+            json_put(json, (char)c);
+        }
+    }
+    json_put(json, '"');
+}
+
+// 写入元素前的逗号与键名
+static void json_prefix(console_json_t *json, const char *key)
+{
+    if (json->depth > 0) {
+        uint32_t bit = 1UL << (json->depth - 1);
+        if (json->has_items & bit) {
+            json_put(json, ',');
+        }
+        json->has_items |= bit;
+    }
+    if (key) {
+        json_write_escaped(json, key);
+        json_put(json, ':');
+    }
+}
+
+static void json_open(console_json_t *json, const char *key, char bracket)
+{
+    json_prefix(json, key);
+    json_put(json, bracket);
+    if (json->depth >= CONSOLE_JSON_MAX_DEPTH) {
+        json->error = true;
+        return;
+    }
+    json->depth++;
+    json->has_items &= ~(1UL << (json->depth - 1));
+}
+
+static void json_close(console_json_t *json, char bracket)
+{
+    if (json->depth == 0) {
+        json->error = true;
+        return;
+    }
+    json->depth--;
+    json_put(json, bracket);
+}
+
+static void stdout_flush(const char *data, size_t len, void *ctx)
+{
+    fwrite(data, 1, len, stdout);
+}
+
+void console_json_init(console_json_t *json, char *buf, size_t size, console_json_flush_t flush, void *ctx)
+{
+    memset(json, 0, sizeof(*json));
+    json->buf = buf;
+    json->size = size;
+    json->flush = flush;
+    json->ctx = ctx;
+}
+
+void console_json_init_stdout(console_json_t *json, char *buf, size_t size)
+{
+    console_json_init(json, buf, size, stdout_flush, NULL);
+}
+
+void console_json_begin_object(console_json_t *json, const char *key)
+{
+    json_open(json, key, '{');
+}
+
+void console_json_end_object(console_json_t *json)
+{
+    json_close(json, '}');
+}
+
+void console_json_begin_array(console_json_t *json, const char *key)
+{
+    json_open(json, key, '[');
+}
+
+void console_json_end_array(console_json_t *json)
+{
+    json_close(json, ']');
+}
+
+void console_json_string(console_json_t *json, const char *key, const char *value)
+{
+    json_prefix(json, key);
+    if (value) {
+        json_write_escaped(json, value);
+    } else {
+        json_write(json, "null", 4);
+    }
+}
+
+void console_json_uint(console_json_t *json, const char *key, uint64_t value)
+{
+    // 从低位向前填充，避免格式化开销
+    char digits[20];
+    size_t pos = sizeof(digits);
+    do {
+        digits[--pos] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    json_prefix(json, key);
+    json_write(json, digits + pos, sizeof(digits) - pos);
+}
+
+void console_json_int(console_json_t *json, const char *key, int64_t value)
+{
+    if (value >= 0) {
+        console_json_uint(json, key, (uint64_t)value);
+        return;
+    }
+
+    char digits[20];
+    size_t pos = sizeof(digits);
+    uint64_t magnitude = 0 - (uint64_t)value;
+    do {
+        digits[--pos] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    json_prefix(json, key);
+    json_put(json, '-');
+    json_write(json, digits + pos, sizeof(digits) - pos);
+}
+
+void console_json_bool(console_json_t *json, const char *key, bool value)
+{
+    json_prefix(json, key);
+    if (value) {
+        json_write(json, "true", 4);
+    } else {
+        json_write(json, "false", 5);
+    }
+}
+
+void console_json_null(console_json_t *json, const char *key)
+{
+    json_prefix(json, key);
+    json_write(json, "null", 4);
+}
+
+esp_err_t console_json_finish(console_json_t *json)
+{
+    json_put(json, '\n');
+    json_flush(json);
+    return (json->error || json->depth != 0) ? ESP_ERR_INVALID_STATE : ESP_OK;
+}
+
+// ==================== 状态结构序列化 ====================
+
+static void json_led_color(console_json_t *json, const char *key, const led_color_t *color)
+{
+    console_json_begin_object(json, key);
+    console_json_uint(json, "red", color->red);
+    console_json_uint(json, "green", color->green);
+    console_json_uint(json, "blue", color->blue);
+    console_json_end_object(json);
+}
+
+void console_json_hardware_status(console_json_t *json, const char *key, const hardware_status_t *status)
+{
+    console_json_begin_object(json, key);
+    console_json_bool(json, "initialized", status->initialized);
+    console_json_uint(json, "fan_speed", status->fan_speed);
+    json_led_color(json, "board_led_color", &status->board_led_color);
+    console_json_uint(json, "board_led_brightness", status->board_led_brightness);
+    json_led_color(json, "touch_led_color", &status->touch_led_color);
+    console_json_uint(json, "touch_led_brightness", status->touch_led_brightness);
+    console_json_string(json, "usb_mux_target", usb_mux_get_target_name(status->usb_mux_target));
+    console_json_string(json, "orin_power_state", power_state_get_name(status->orin_power_state));
+    console_json_string(json, "n305_power_state", power_state_get_name(status->n305_power_state));
+    console_json_end_object(json);
+}
+
+void console_json_system_info(console_json_t *json, const char *key, const system_info_t *info)
+{
+    console_json_begin_object(json, key);
+    console_json_string(json, "chip_model", info->chip_model);
+    console_json_uint(json, "cores", info->cores);
+    console_json_uint(json, "cpu_freq_mhz", info->cpu_freq_mhz);
+    console_json_uint(json, "flash_size_mb", info->flash_size_mb);
+    console_json_uint(json, "free_heap", info->free_heap);
+    console_json_uint(json, "min_free_heap", info->min_free_heap);
+    console_json_uint(json, "uptime_ms", info->uptime_ms);
+    console_json_end_object(json);
+}
+
+void console_json_device_status(console_json_t *json, const char *key, const device_status_t *status)
+{
+    console_json_begin_object(json, key);
+    console_json_uint(json, "interface_version", status->interface_version);
+    if (status->hardware_available) {
+        console_json_hardware_status(json, "hardware", &status->hardware);
+    } else {
+        console_json_null(json, "hardware");
+    }
+    if (status->monitor_available) {
+        console_json_system_info(json, "system", &status->system);
+    } else {
+        console_json_null(json, "system");
+    }
+    console_json_end_object(json);
+}
+
+void console_json_memory_snapshot(console_json_t *json, const char *key, const system_memory_snapshot_t *snapshot)
+{
+    console_json_begin_object(json, key);
+    console_json_uint(json, "total_free_bytes", snapshot->total_free_bytes);
+    for (int i = 0; i < SYSTEM_HEAP_REGION_MAX; i++) {
+        const system_heap_region_info_t *region = &snapshot->regions[i];
+        console_json_begin_object(json, system_heap_region_get_name((system_heap_region_t)i));
+        console_json_uint(json, "total_bytes", region->total_bytes);
+        console_json_uint(json, "free_bytes", region->free_bytes);
+        console_json_uint(json, "min_free_bytes", region->min_free_bytes);
+        console_json_uint(json, "largest_free_block", region->largest_free_block);
+        console_json_uint(json, "free_blocks", region->free_blocks);
+        console_json_uint(json, "usage_percent", region->usage_percent);
+        console_json_uint(json, "fragmentation_percent", region->fragmentation_percent);
+        console_json_end_object(json);
+    }
+    console_json_end_object(json);
+}
+
+void console_json_monitor_stats(console_json_t *json, const char *key)
+{
+    uint32_t monitor_count = 0;
+    uint32_t warning_count = 0;
+    system_memory_thresholds_t thresholds = {0};
+    system_monitor_alarm_stats_t alarm_stats = {0};
+
+    if (system_monitor_get_stats(&monitor_count, &warning_count) != ESP_OK) {
+        console_json_null(json, key);
+        return;
+    }
+    system_monitor_get_memory_thresholds(&thresholds);
+    system_monitor_get_alarm_stats(&alarm_stats);
+
+    console_json_begin_object(json, key);
+    console_json_bool(json, "running", system_monitor_is_running());
+    console_json_uint(json, "monitor_count", monitor_count);
+    console_json_uint(json, "warning_count", warning_count);
+
+    console_json_begin_object(json, "thresholds");
+    console_json_uint(json, "internal_free_bytes", thresholds.internal_free_bytes);
+    console_json_uint(json, "dma_free_bytes", thresholds.dma_free_bytes);
+    console_json_uint(json, "largest_block_bytes", thresholds.largest_block_bytes);
+    console_json_uint(json, "fragmentation_percent", thresholds.fragmentation_percent);
+    console_json_end_object(json);
+
+    console_json_begin_object(json, "alarms");
+    console_json_uint(json, "wakeups", alarm_stats.wakeups);
+    console_json_uint(json, "periodic_wakeups", alarm_stats.periodic_wakeups);
+    console_json_uint(json, "event_wakeups", alarm_stats.event_wakeups);
+    console_json_uint(json, "alloc_failures", alarm_stats.alloc_failures);
+    console_json_uint(json, "watermark_hits", alarm_stats.watermark_hits);
+    console_json_uint(json, "last_failed_size", alarm_stats.last_failed_size);
+    console_json_uint(json, "last_failed_caps", alarm_stats.last_failed_caps);
+    console_json_uint(json, "latency_last_us", alarm_stats.latency_last_us);
+    console_json_uint(json, "latency_max_us", alarm_stats.latency_max_us);
+    console_json_uint(json, "latency_avg_us", alarm_stats.latency_avg_us);
+    console_json_end_object(json);
+
+    console_json_end_object(json);
+}
+
+void console_json_cmdstats(console_json_t *json, const char *key)
+{
+    console_json_begin_object(json, key);
+    console_json_uint(json, "slow_threshold_ms", console_cmdstats_get_slow_threshold());
+    console_json_uint(json, "slow_total", console_cmdstats_get_slow_total());
+    console_json_uint(json, "bucket_shift", CONSOLE_CMDSTATS_BUCKET_SHIFT);
+
+    // 只输出执行过的命令
+    console_cmdstats_entry_t entry;
+    console_json_begin_array(json, "commands");
+    for (int i = 0; console_cmdstats_get(i, &entry) == ESP_OK; i++) {
+        if (entry.calls == 0) {
+            continue;
+        }
+        console_json_begin_object(json, NULL);
+        console_json_string(json, "name", entry.name);
+        console_json_uint(json, "calls", entry.calls);
+        console_json_uint(json, "errors", entry.errors);
+        console_json_uint(json, "total_us", entry.total_us);
+        console_json_uint(json, "mean_us", entry.total_us / entry.calls);
+        console_json_uint(json, "max_us", entry.max_us);
+        console_json_uint(json, "last_us", entry.last_us);
+        console_json_uint(json, "p50_us", console_cmdstats_percentile_us(&entry, 50));
+        console_json_uint(json, "p99_us", console_cmdstats_percentile_us(&entry, 99));
+        console_json_begin_array(json, "hist");
+        for (int b = 0; b < CONSOLE_CMDSTATS_BUCKETS; b++) {
+            console_json_uint(json, NULL, entry.buckets[b]);
+        }
+        console_json_end_array(json);
+        console_json_end_object(json);
+    }
+    console_json_end_array(json);
+
+    // 慢命令从最早到最新
+    console_cmdstats_slow_t record;
+    int held = 0;
+    while (console_cmdstats_get_slow(held, &record) == ESP_OK) {
+        held++;
+    }
+    console_json_begin_array(json, "slow");
+    for (int age = held - 1; age >= 0; age--) {
+        if (console_cmdstats_get_slow(age, &record) != ESP_OK) {
+            continue;
+        }
+        console_json_begin_object(json, NULL);
+        console_json_uint(json, "seq", record.seq);
+        console_json_uint(json, "timestamp_ms", record.timestamp_ms);
+        console_json_uint(json, "elapsed_us", record.elapsed_us);
+        console_json_int(json, "result", record.result);
+        console_json_string(json, "cmd", record.line);
+        console_json_end_object(json);
+    }
+    console_json_end_array(json);
+
+    console_json_end_object(json);
+}
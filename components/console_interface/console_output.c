@@ -0,0 +1,386 @@
+/**
+ * @file console_output.c
+ * @brief 控制台输出缓冲实现
+ */
+
+#define _GNU_SOURCE     // fopencookie
+#include "console_output.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "board_hal.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <unistd.h>
+#else
+#include "driver/uart.h"
+#endif
+
+static const char *TAG = "CONSOLE_OUT";
+
+// ==================== 内部状态 ====================
+
+typedef struct {
+    bool initialized;
+    bool uart_driver;               // 直接写入UART驱动，LF在写入缓冲区时转换为CRLF
+    bool buffered;
+    bool in_command;
+    FILE *stream;                   // 替换控制台任务stdout的流
+    FILE *raw_stdout;               // 替换前的stdout，未安装UART驱动时经它写出
+    SemaphoreHandle_t lock;
+    esp_timer_handle_t flush_timer;
+    board_hal_pm_lock_t pm_lock;    // 命令输出发送完成前禁止浅睡眠
+    char buf[CONSOLE_OUTPUT_BUF_SIZE];
+    size_t len;
+    int64_t command_start_us;
+    console_output_command_stats_t current;
+    console_output_stats_t stats;
+} console_output_state_t;
+
+static console_output_state_t s_out = { .buffered = true };
+
+// ==================== 写出 ====================
+
+// 把数据交给驱动，调用者持有锁
+static void sink_write(const char *data, size_t len)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    while (len > 0) {
+        ssize_t n = write(STDOUT_FILENO, data, len);
+        if (n <= 0) {
+            break;
+        }
+        data += n;
+        len -= n;
+    }
+#else
+    if (s_out.uart_driver) {
+        // 拷贝到发送环形缓冲区后返回，由TX中断搬运到FIFO
+        uart_write_bytes(CONFIG_ESP_CONSOLE_UART_NUM, data, len);
+    } else {
+        FILE *out = s_out.raw_stdout ? s_out.raw_stdout : stdout;
+        fwrite(data, 1, len, out);
+        fflush(out);
+    }
+#endif
+}
+
+static void flush_locked(void)
+{
+    if (s_out.len == 0) {
+        return;
+    }
+
+    int64_t start = esp_timer_get_time();
+    sink_write(s_out.buf, s_out.len);
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+    s_out.len = 0;
+
+    s_out.stats.uart_writes++;
+    s_out.stats.write_us += elapsed;
+    if (s_out.in_command) {
+        s_out.current.uart_writes++;
+        s_out.current.write_us += elapsed;
+    }
+}
+
+// 追加到缓冲区，需要时转换换行，满了就写出
+static void append_locked(const char *data, size_t len)
+{
+    while (len > 0) {
+        size_t space = sizeof(s_out.buf) - s_out.len;
+        if (space < 2) {
+            flush_locked();
+            s_out.stats.full_flushes++;
+            continue;
+        }
+
+        size_t chunk = len < space - 1 ? len : space - 1;
+        const char *nl = s_out.uart_driver ? memchr(data, '\n', chunk) : NULL;
+        if (nl) {
+            chunk = nl - data;
+        }
+        memcpy(s_out.buf + s_out.len, data, chunk);
+        s_out.len += chunk;
+        data += chunk;
+        len -= chunk;
+
+        if (nl) {
+            s_out.buf[s_out.len++] = '\r';
+            s_out.buf[s_out.len++] = '\n';
+            data++;
+            len--;
+        }
+    }
+}
+
+static ssize_t stream_write(void *cookie, const char *data, size_t len)
+{
+    xSemaphoreTake(s_out.lock, portMAX_DELAY);
+    s_out.stats.bytes += len;
+    s_out.stats.stdio_writes++;
+    if (s_out.in_command) {
+        s_out.current.bytes += len;
+        s_out.current.stdio_writes++;
+    }
+
+    append_locked(data, len);
+    // 命令之外（提示符、其他任务的日志）以及禁用缓冲时直写
+    if (!s_out.in_command || !s_out.buffered) {
+        flush_locked();
+    }
+    xSemaphoreGive(s_out.lock);
+    return (ssize_t)len;
+}
+
+// 命令执行期间定时写出，命令在等待中时已输出的内容也能及时显示
+static void flush_timer_callback(void *arg)
+{
+    // 控制台任务正在写出时跳过，不阻塞定时器任务
+    if (xSemaphoreTake(s_out.lock, 0) != pdTRUE) {
+        return;
+    }
+
+    bool ready = s_out.len > 0;
+#if !CONFIG_IDF_TARGET_LINUX
+    if (ready && s_out.uart_driver) {
+        size_t free_size = 0;
+        ready = uart_get_tx_buffer_free_size(CONFIG_ESP_CONSOLE_UART_NUM, &free_size) == ESP_OK &&
+                free_size >= s_out.len;
+    }
+#endif
+    if (ready) {
+        flush_locked();
+        s_out.stats.timer_flushes++;
+    }
+    xSemaphoreGive(s_out.lock);
+}
+
+// ==================== 公共接口 ====================
+
+esp_err_t console_output_init(bool uart_driver)
+{
+    if (s_out.initialized) {
+        return ESP_OK;
+    }
+
+    s_out.uart_driver = uart_driver;
+    s_out.stats.uart_driver = uart_driver;
+
+    s_out.lock = xSemaphoreCreateMutex();
+    if (s_out.lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 流本身不缓冲，每次printf整体调用一次stream_write，由本模块决定何时写出
+    cookie_io_functions_t io = {
+        .write = stream_write,
+    };
+    s_out.stream = fopencookie(NULL, "w", io);
+    if (s_out.stream == NULL) {
+        vSemaphoreDelete(s_out.lock);
+        s_out.lock = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    setvbuf(s_out.stream, NULL, _IONBF, 0);
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = flush_timer_callback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "console_out",
+        .skip_unhandled_events = true,
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &s_out.flush_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Flush timer unavailable, output is written at command end: %s", esp_err_to_name(ret));
+        s_out.flush_timer = NULL;
+    }
+
+    if (board_hal_pm_lock_create(BOARD_HAL_PM_NO_LIGHT_SLEEP, "console_out", &s_out.pm_lock) != ESP_OK) {
+        s_out.pm_lock = NULL;
+    }
+
+    s_out.initialized = true;
+    ESP_LOGI(TAG, "Console output buffer: %d bytes, %s", CONSOLE_OUTPUT_BUF_SIZE,
+             uart_driver ? "UART driver TX ring" : "stdout");
+    return ESP_OK;
+}
+
+void console_output_attach(void)
+{
+    if (!s_out.initialized || stdout == s_out.stream) {
+        return;
+    }
+    fflush(stdout);
+    s_out.raw_stdout = stdout;
+    stdout = s_out.stream;
+}
+
+void console_output_begin_command(const char *command)
+{
+    if (!s_out.initialized) {
+        return;
+    }
+
+    board_hal_pm_lock_acquire(s_out.pm_lock);
+
+    xSemaphoreTake(s_out.lock, portMAX_DELAY);
+    flush_locked();
+    memset(&s_out.current, 0, sizeof(s_out.current));
+    size_t n = strcspn(command, " ");
+    if (n >= sizeof(s_out.current.command)) {
+        n = sizeof(s_out.current.command) - 1;
+    }
+    memcpy(s_out.current.command, command, n);
+    s_out.in_command = true;
+    s_out.command_start_us = esp_timer_get_time();
+    xSemaphoreGive(s_out.lock);
+
+    if (s_out.buffered && s_out.flush_timer) {
+        esp_timer_start_periodic(s_out.flush_timer, CONSOLE_OUTPUT_FLUSH_INTERVAL_MS * 1000ULL);
+    }
+}
+
+void console_output_end_command(void)
+{
+    if (!s_out.initialized || !s_out.in_command) {
+        return;
+    }
+
+    if (s_out.flush_timer) {
+        esp_timer_stop(s_out.flush_timer);
+    }
+
+    xSemaphoreTake(s_out.lock, portMAX_DELAY);
+    flush_locked();
+    s_out.current.exec_us = (uint32_t)(esp_timer_get_time() - s_out.command_start_us);
+    s_out.in_command = false;
+    xSemaphoreGive(s_out.lock);
+
+    // 等发送环形缓冲区排空再回到提示符并允许浅睡眠
+    int64_t drain_start = esp_timer_get_time();
+#if !CONFIG_IDF_TARGET_LINUX
+    if (s_out.uart_driver) {
+        uart_wait_tx_done(CONFIG_ESP_CONSOLE_UART_NUM, pdMS_TO_TICKS(CONSOLE_OUTPUT_DRAIN_TIMEOUT_MS));
+    }
+#endif
+    s_out.current.drain_us = (uint32_t)(esp_timer_get_time() - drain_start);
+
+    board_hal_pm_lock_release(s_out.pm_lock);
+
+    s_out.stats.commands++;
+    s_out.stats.last = s_out.current;
+}
+
+void console_output_flush(void)
+{
+    if (!s_out.initialized) {
+        fflush(stdout);
+        return;
+    }
+
+    xSemaphoreTake(s_out.lock, portMAX_DELAY);
+    flush_locked();
+    xSemaphoreGive(s_out.lock);
+}
+
+void console_output_echo(const char *data, size_t len)
+{
+    if (!s_out.initialized) {
+        fwrite(data, 1, len, stdout);
+        fflush(stdout);
+        return;
+    }
+
+    xSemaphoreTake(s_out.lock, portMAX_DELAY);
+    flush_locked();
+    sink_write(data, len);
+    s_out.stats.echo_bytes += len;
+    xSemaphoreGive(s_out.lock);
+}
+
+void console_output_write_raw(const void *data, size_t len)
+{
+    if (!s_out.initialized) {
+        fwrite(data, 1, len, stdout);
+        fflush(stdout);
+        return;
+    }
+
+    xSemaphoreTake(s_out.lock, portMAX_DELAY);
+    flush_locked();
+    sink_write((const char *)data, len);
+    xSemaphoreGive(s_out.lock);
+}
+
+void console_output_set_buffered(bool enable)
+{
+    s_out.buffered = enable;
+}
+
+esp_err_t console_output_get_stats(console_output_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_out.lock) {
+        xSemaphoreTake(s_out.lock, portMAX_DELAY);
+    }
+    *stats = s_out.stats;
+    stats->buffered = s_out.buffered;
+    if (s_out.lock) {
+        xSemaphoreGive(s_out.lock);
+    }
+    return ESP_OK;
+}
+
+void console_output_reset_stats(void)
+{
+    if (s_out.lock) {
+        xSemaphoreTake(s_out.lock, portMAX_DELAY);
+    }
+    memset(&s_out.stats, 0, sizeof(s_out.stats));
+    s_out.stats.uart_driver = s_out.uart_driver;
+    if (s_out.lock) {
+        xSemaphoreGive(s_out.lock);
+    }
+}
+
+esp_err_t console_output_print_stats(void)
+{
+    console_output_stats_t stats;
+    console_output_get_stats(&stats);
+
+    printf("\n=== 控制台输出统计 ===\n");
+    printf("命令输出缓冲: %s (%d bytes, 超时 %d ms)\n", stats.buffered ? "启用" : "禁用",
+           CONSOLE_OUTPUT_BUF_SIZE, CONSOLE_OUTPUT_FLUSH_INTERVAL_MS);
+    printf("写出目标: %s\n", stats.uart_driver ? "UART驱动发送环形缓冲区" : "stdout");
+    printf("命令数: %" PRIu32 "\n", stats.commands);
+    printf("输出字节: %" PRIu64 ", stdio写入 %" PRIu32 " 次, 驱动写入 %" PRIu32 " 次 (缓冲区满 %" PRIu32
+           ", 超时 %" PRIu32 ")\n", stats.bytes, stats.stdio_writes, stats.uart_writes,
+           stats.full_flushes, stats.timer_flushes);
+    if (stats.uart_writes > 0) {
+        printf("平均每次驱动写入: %" PRIu64 " bytes, %" PRIu64 " us\n",
+               stats.bytes / stats.uart_writes, stats.write_us / stats.uart_writes);
+    }
+    printf("回显字节: %" PRIu32 "\n", stats.echo_bytes);
+
+    const console_output_command_stats_t *last = &stats.last;
+    if (stats.commands > 0) {
+        printf("最近命令 '%s': %" PRIu32 " bytes, stdio写入 %" PRIu32 " 次, 驱动写入 %" PRIu32 " 次\n",
+               last->command, last->bytes, last->stdio_writes, last->uart_writes);
+        printf("  执行 %" PRIu32 " us (其中写入驱动 %" PRIu32 " us), 等待发送完成 %" PRIu32 " us\n",
+               last->exec_us, last->write_us, last->drain_us);
+        if (last->exec_us > 0) {
+            printf("  命令侧吞吐: %" PRIu64 " bytes/s\n", (uint64_t)last->bytes * 1000000ULL / last->exec_us);
+        }
+    }
+    printf("======================\n");
+    return ESP_OK;
+}
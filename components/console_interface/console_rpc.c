@@ -0,0 +1,991 @@
+/**
+ * @file console_rpc.c
+ * @brief 控制台二进制RPC的解码、分发与响应编码
+ */
+
+#include "console_rpc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "device_interface.h"
+#include "hardware_control.h"
+#include "system_monitor.h"
+#include "event_trace.h"
+#include "console_baud.h"
+#include "console_jobs.h"
+
+static const char *TAG = "CONSOLE_RPC";
+
+#define RPC_JOB_MAX_REQ     8       // 后台任务请求负载上限，以十六进制保存在任务命令行中
+
+#define RES_ORIN            CONSOLE_JOB_RES_ORIN
+#define RES_N305            CONSOLE_JOB_RES_N305
+#define RES_PERIPH          CONSOLE_JOB_RES_PERIPH
+#define RES_BENCH           CONSOLE_JOB_RES_BENCH
+#define RES_ALL             CONSOLE_JOB_RES_ALL
+
+// ==================== 类型定义 ====================
+
+/**
+ * @brief 消息处理函数
+ *
+ * @param req 请求负载
+ * @param req_len 请求负载长度
+ * @param resp 响应负载缓冲区 (CONSOLE_RPC_MAX_PAYLOAD 字节)
+ * @param resp_len 响应负载长度，调用前为0
+ * @return 写入响应status字段的错误码，非ESP_OK时丢弃响应负载
+ */
+typedef esp_err_t (*rpc_handler_t)(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len);
+
+/**
+ * @brief 分发表项，按消息号索引
+ */
+typedef struct {
+    const char *name;
+    rpc_handler_t handler;
+    uint8_t req_len;            // 固定请求负载长度
+    bool var_len;               // true: 请求负载长度不固定，由处理函数检查
+    uint32_t resources;         // 执行期间占用的资源 (console_job_resource_t)，0表示不占用
+} rpc_entry_t;
+
+// ==================== 静态变量 ====================
+
+static console_rpc_stats_t s_stats;
+static uint32_t s_msg_count[CONSOLE_RPC_MSG_MAX];
+
+// 上一帧请求与响应，用于主机重发时直接重发响应
+static bool s_last_valid = false;
+static uint8_t s_last_seq;
+static uint8_t s_last_msg;
+static uint16_t s_last_crc;
+static uint8_t s_last_resp[CONSOLE_RPC_WIRE_BUF_SIZE];
+static size_t s_last_resp_len;
+
+// ==================== 负载转换 ====================
+
+static led_color_t color_from_rpc(console_rpc_color_t c)
+{
+    return (led_color_t){ c.red, c.green, c.blue };
+}
+
+static console_rpc_color_t color_to_rpc(led_color_t c)
+{
+    return (console_rpc_color_t){ c.red, c.green, c.blue };
+}
+
+static hardware_settings_t settings_from_rpc(const console_rpc_settings_t *s)
+{
+    return (hardware_settings_t){
+        .fan_speed = s->fan_speed,
+        .board_led_color = color_from_rpc(s->board_led_color),
+        .board_led_brightness = s->board_led_brightness,
+        .touch_led_color = color_from_rpc(s->touch_led_color),
+        .touch_led_brightness = s->touch_led_brightness,
+    };
+}
+
+static console_rpc_settings_t settings_to_rpc(const hardware_settings_t *s)
+{
+    return (console_rpc_settings_t){
+        .fan_speed = s->fan_speed,
+        .board_led_color = color_to_rpc(s->board_led_color),
+        .board_led_brightness = s->board_led_brightness,
+        .touch_led_color = color_to_rpc(s->touch_led_color),
+        .touch_led_brightness = s->touch_led_brightness,
+    };
+}
+
+static void hw_status_to_rpc(const hardware_status_t *status, console_rpc_hw_status_t *out)
+{
+    hardware_settings_t settings = {
+        .fan_speed = status->fan_speed,
+        .board_led_color = status->board_led_color,
+        .board_led_brightness = status->board_led_brightness,
+        .touch_led_color = status->touch_led_color,
+        .touch_led_brightness = status->touch_led_brightness,
+    };
+    out->initialized = status->initialized;
+    out->settings = settings_to_rpc(&settings);
+    out->usb_mux_target = (uint8_t)status->usb_mux_target;
+    out->orin_power_state = (uint8_t)status->orin_power_state;
+    out->n305_power_state = (uint8_t)status->n305_power_state;
+}
+
+// 档案名字段不保证以'\0'结尾，复制到本地并截断
+static void copy_name(char *dst, const uint8_t *src)
+{
+    memcpy(dst, src, CONSOLE_RPC_NAME_LEN);
+    dst[CONSOLE_RPC_NAME_LEN - 1] = '\0';
+}
+
+static uint32_t read_u32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+#define RESP_PUT(resp, resp_len, value) do { \
+    memcpy((resp), &(value), sizeof(value)); \
+    *(resp_len) = sizeof(value); \
+} while (0)
+
+static bool submit_job(uint8_t msg, const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len,
+                       esp_err_t *status);
+
+// ==================== 协议 ====================
+
+static esp_err_t rpc_ping(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    memcpy(resp, req, req_len);
+    *resp_len = req_len;
+    return ESP_OK;
+}
+
+static esp_err_t rpc_get_version(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    console_rpc_version_t version = {
+        .proto_version = CONSOLE_RPC_PROTO_VERSION,
+        .max_payload = CONSOLE_RPC_MAX_PAYLOAD,
+        .interface_version = device_get_interface_version(),
+    };
+    device_get_version_string(version.version, sizeof(version.version));
+    RESP_PUT(resp, resp_len, version);
+    return ESP_OK;
+}
+
+static esp_err_t rpc_get_rpc_stats(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    RESP_PUT(resp, resp_len, s_stats);
+    return ESP_OK;
+}
+
+static esp_err_t rpc_job_get(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    console_job_info_t info;
+    esp_err_t ret = console_jobs_get(read_u32(req), &info);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    console_rpc_job_t out = {
+        .id = info.id,
+        .state = (uint8_t)info.state,
+        .result = info.result,
+        .queued_ms = info.queued_ms,
+        .run_ms = info.run_ms,
+    };
+    RESP_PUT(resp, resp_len, out);
+    return ESP_OK;
+}
+
+static esp_err_t rpc_baud_set(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    console_rpc_baud_set_t set;
+    memcpy(&set, req, sizeof(set));
+    return console_baud_request(set.baud, set.confirm_ms, set.persist != 0);
+}
+
+static esp_err_t rpc_baud_get(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    console_baud_status_t status;
+    console_baud_get_status(&status);
+    console_rpc_baud_status_t out = {
+        .current = status.current,
+        .previous = status.previous,
+        .saved = status.saved,
+        .state = (uint8_t)status.state,
+        .switches = status.switches,
+        .confirms = status.confirms,
+        .fallbacks = status.fallbacks,
+    };
+    RESP_PUT(resp, resp_len, out);
+    return ESP_OK;
+}
+
+// ==================== 风扇与LED ====================
+
+static esp_err_t rpc_fan_set_speed(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return fan_set_speed(req[0]);
+}
+
+static esp_err_t rpc_fan_get_speed(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    resp[0] = fan_get_speed();
+    *resp_len = 1;
+    return ESP_OK;
+}
+
+static esp_err_t rpc_fan_start(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return fan_start();
+}
+
+static esp_err_t rpc_fan_stop(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return fan_stop();
+}
+
+static esp_err_t rpc_board_led_set_color(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    console_rpc_color_t color;
+    memcpy(&color, req, sizeof(color));
+    return board_led_set_color(color_from_rpc(color));
+}
+
+static esp_err_t rpc_board_led_set_brightness(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return board_led_set_brightness(req[0]);
+}
+
+static esp_err_t rpc_board_led_set_effect(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return board_led_set_effect((led_effect_t)req[0]);
+}
+
+static esp_err_t rpc_board_led_off(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return board_led_turn_off();
+}
+
+static esp_err_t rpc_board_led_get_brightness(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    resp[0] = board_led_get_brightness();
+    *resp_len = 1;
+    return ESP_OK;
+}
+
+static esp_err_t rpc_board_led_get_color(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    console_rpc_color_t out = color_to_rpc(board_led_get_color());
+    RESP_PUT(resp, resp_len, out);
+    return ESP_OK;
+}
+
+static esp_err_t rpc_touch_led_set_color(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    console_rpc_color_t color;
+    memcpy(&color, req, sizeof(color));
+    return touch_led_set_color(color_from_rpc(color));
+}
+
+static esp_err_t rpc_touch_led_set_brightness(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return touch_led_set_brightness(req[0]);
+}
+
+static esp_err_t rpc_touch_led_off(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return touch_led_turn_off();
+}
+
+static esp_err_t rpc_touch_led_get_brightness(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    resp[0] = touch_led_get_brightness();
+    *resp_len = 1;
+    return ESP_OK;
+}
+
+static esp_err_t rpc_touch_led_get_color(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    console_rpc_color_t out = color_to_rpc(touch_led_get_color());
+    RESP_PUT(resp, resp_len, out);
+    return ESP_OK;
+}
+
+// ==================== GPIO与USB MUX ====================
+
+static esp_err_t rpc_gpio_set_output(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return gpio_set_output(req[0], req[1] ? GPIO_STATE_HIGH : GPIO_STATE_LOW);
+}
+
+static esp_err_t rpc_gpio_read_input(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    gpio_state_t state;
+    esp_err_t ret = gpio_read_input(req[0], &state);
+    resp[0] = (uint8_t)state;
+    *resp_len = 1;
+    return ret;
+}
+
+static esp_err_t rpc_gpio_read_input_mode(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    gpio_state_t state;
+    esp_err_t ret = gpio_read_input_mode(req[0], &state);
+    resp[0] = (uint8_t)state;
+    *resp_len = 1;
+    return ret;
+}
+
+static esp_err_t rpc_gpio_toggle(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return gpio_toggle_output(req[0]);
+}
+
+static esp_err_t rpc_usb_mux_set(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return usb_mux_set_target((usb_mux_target_t)req[0]);
+}
+
+static esp_err_t rpc_usb_mux_get(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    usb_mux_target_t target;
+    esp_err_t ret = usb_mux_get_target(&target);
+    resp[0] = (uint8_t)target;
+    *resp_len = 1;
+    return ret;
+}
+
+// ==================== 电源控制 ====================
+
+static esp_err_t rpc_orin_power_on(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return orin_power_on();
+}
+
+static esp_err_t rpc_orin_power_off(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return orin_power_off();
+}
+
+static esp_err_t rpc_orin_reset(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return orin_reset();
+}
+
+static esp_err_t rpc_orin_recovery(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    esp_err_t status;
+    if (submit_job(CONSOLE_RPC_MSG_ORIN_RECOVERY, req, req_len, resp, resp_len, &status)) {
+        return status;
+    }
+    return orin_enter_recovery_mode();
+}
+
+static esp_err_t rpc_n305_power_toggle(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return n305_power_toggle();
+}
+
+static esp_err_t rpc_n305_reset(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return n305_reset();
+}
+
+static esp_err_t rpc_orin_get_power_state(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    power_state_t state;
+    esp_err_t ret = orin_get_power_state(&state);
+    resp[0] = (uint8_t)state;
+    *resp_len = 1;
+    return ret;
+}
+
+static esp_err_t rpc_n305_get_power_state(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    power_state_t state;
+    esp_err_t ret = n305_get_power_state(&state);
+    resp[0] = (uint8_t)state;
+    *resp_len = 1;
+    return ret;
+}
+
+// ==================== 硬件状态、设置、事务与自检 ====================
+
+static esp_err_t rpc_hw_test(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    console_rpc_hw_test_t test;
+    memcpy(&test, req, sizeof(test));
+
+    esp_err_t status;
+    if (test.test == CONSOLE_RPC_HW_TEST_ALL &&
+        submit_job(CONSOLE_RPC_MSG_HW_TEST, req, req_len, resp, resp_len, &status)) {
+        return status;
+    }
+
+    switch (test.test) {
+        case CONSOLE_RPC_HW_TEST_FAN:               return hardware_test_fan();
+        case CONSOLE_RPC_HW_TEST_BOARD_LED:         return hardware_test_board_led();
+        case CONSOLE_RPC_HW_TEST_TOUCH_LED:         return hardware_test_touch_led();
+        case CONSOLE_RPC_HW_TEST_GPIO:              return hardware_test_gpio(test.pin);
+        case CONSOLE_RPC_HW_TEST_GPIO_INPUT:        return hardware_test_gpio_input(test.pin);
+        case CONSOLE_RPC_HW_TEST_ALL:               return hardware_test_all();
+        case CONSOLE_RPC_HW_TEST_ORIN_POWER:        return hardware_test_orin_power();
+        case CONSOLE_RPC_HW_TEST_N305_POWER:        return hardware_test_n305_power();
+        case CONSOLE_RPC_HW_TEST_ORIN_RECOVERY_GPIO: return hardware_test_orin_recovery_gpio();
+        default:                                    return ESP_ERR_INVALID_ARG;
+    }
+}
+
+static esp_err_t rpc_hw_get_status(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    hardware_status_t status;
+    esp_err_t ret = hardware_get_status(&status);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    console_rpc_hw_status_t out;
+    hw_status_to_rpc(&status, &out);
+    RESP_PUT(resp, resp_len, out);
+    return ESP_OK;
+}
+
+static esp_err_t rpc_hw_get_settings(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    hardware_settings_t settings;
+    esp_err_t ret = hardware_get_settings(&settings);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    console_rpc_settings_t out = settings_to_rpc(&settings);
+    RESP_PUT(resp, resp_len, out);
+    return ESP_OK;
+}
+
+static esp_err_t rpc_hw_apply_settings(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    console_rpc_settings_t in;
+    memcpy(&in, req, sizeof(in));
+    hardware_settings_t settings = settings_from_rpc(&in);
+    return hardware_apply_settings(&settings);
+}
+
+static esp_err_t rpc_hw_txn_commit(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    console_rpc_hw_txn_t in;
+    memcpy(&in, req, sizeof(in));
+
+    // 按字段调用hw_txn_set_*()，参数检查与控制台/本地调用完全一致
+    hw_txn_t txn;
+    hw_txn_begin(&txn);
+    if (in.fields & HW_TXN_FAN) {
+        hw_txn_set_fan(&txn, in.settings.fan_speed);
+    }
+    if (in.fields & HW_TXN_BOARD_COLOR) {
+        hw_txn_set_board_led(&txn, color_from_rpc(in.settings.board_led_color));
+    }
+    if (in.fields & HW_TXN_BOARD_BRIGHTNESS) {
+        hw_txn_set_board_brightness(&txn, in.settings.board_led_brightness);
+    }
+    if (in.fields & HW_TXN_TOUCH_COLOR) {
+        hw_txn_set_touch_led(&txn, color_from_rpc(in.settings.touch_led_color));
+    }
+    if (in.fields & HW_TXN_TOUCH_BRIGHTNESS) {
+        hw_txn_set_touch_brightness(&txn, in.settings.touch_led_brightness);
+    }
+    if (in.fields & HW_TXN_USB_MUX) {
+        hw_txn_set_usb_mux(&txn, (usb_mux_target_t)in.usb_mux_target);
+    }
+    if (in.fields & HW_TXN_GPIO) {
+        for (uint8_t pin = 0; pin < 64; pin++) {
+            if (in.gpio_high_mask & (1ULL << pin)) {
+                hw_txn_set_gpio(&txn, pin, GPIO_STATE_HIGH);
+            } else if (in.gpio_low_mask & (1ULL << pin)) {
+                hw_txn_set_gpio(&txn, pin, GPIO_STATE_LOW);
+            }
+        }
+    }
+    return hw_txn_commit(&txn);
+}
+
+// ==================== 设备接口 ====================
+
+static esp_err_t rpc_dev_quick_setup(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    console_rpc_quick_setup_t in;
+    memcpy(&in, req, sizeof(in));
+    return device_quick_setup(in.fan_speed, color_from_rpc(in.board_led_color), color_from_rpc(in.touch_led_color));
+}
+
+static esp_err_t rpc_dev_shutdown_all(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return device_shutdown_all();
+}
+
+static esp_err_t rpc_dev_reset_default(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return device_reset_to_default();
+}
+
+static esp_err_t rpc_dev_sleep(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return device_enter_sleep_mode();
+}
+
+static esp_err_t rpc_dev_wake(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return device_wake_up();
+}
+
+static esp_err_t rpc_dev_get_status(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    device_status_t status;
+    esp_err_t ret = device_get_full_status(&status);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    console_rpc_dev_status_t out = {
+        .interface_version = status.interface_version,
+        .hardware_available = status.hardware_available,
+        .monitor_available = status.monitor_available,
+        .cpu_freq_mhz = status.system.cpu_freq_mhz,
+        .free_heap = status.system.free_heap,
+        .min_free_heap = status.system.min_free_heap,
+        .uptime_ms = status.system.uptime_ms,
+    };
+    hw_status_to_rpc(&status.hardware, &out.hardware);
+    RESP_PUT(resp, resp_len, out);
+    return ESP_OK;
+}
+
+static esp_err_t rpc_dev_run_test(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    console_rpc_dev_test_t test;
+    memcpy(&test, req, sizeof(test));
+
+    esp_err_t status;
+    if (test.test == CONSOLE_RPC_DEV_TEST_STRESS &&
+        submit_job(CONSOLE_RPC_MSG_DEV_RUN_TEST, req, req_len, resp, resp_len, &status)) {
+        return status;
+    }
+
+    switch (test.test) {
+        case CONSOLE_RPC_DEV_TEST_FULL:     return device_run_full_test();
+        case CONSOLE_RPC_DEV_TEST_QUICK:    return device_run_quick_test();
+        case CONSOLE_RPC_DEV_TEST_STRESS:   return device_run_stress_test(test.duration_ms);
+        default:                            return ESP_ERR_INVALID_ARG;
+    }
+}
+
+static esp_err_t rpc_dev_save_config(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return device_save_config();
+}
+
+static esp_err_t rpc_dev_load_config(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return device_load_config();
+}
+
+static esp_err_t rpc_dev_clear_config(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return device_clear_config();
+}
+
+static esp_err_t rpc_dev_config_benchmark(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return device_config_benchmark(read_u32(req));
+}
+
+// ==================== 配置档案 ====================
+
+static esp_err_t rpc_profile_save(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    char name[CONSOLE_RPC_NAME_LEN];
+    copy_name(name, req);
+    return device_profile_save(name);
+}
+
+static esp_err_t rpc_profile_delete(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    char name[CONSOLE_RPC_NAME_LEN];
+    copy_name(name, req);
+    return device_profile_delete(name);
+}
+
+static esp_err_t rpc_profile_apply(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    char name[CONSOLE_RPC_NAME_LEN];
+    copy_name(name, req);
+    uint32_t fade_ms = read_u32(req + offsetof(console_rpc_profile_apply_t, fade_ms));
+
+    device_profile_switch_result_t result = {0};
+    esp_err_t ret = device_profile_apply(name, fade_ms, &result);
+    console_rpc_profile_result_t out = {
+        .first_commit_us = result.first_commit_us,
+        .total_us = result.total_us,
+        .steps = result.steps,
+    };
+    RESP_PUT(resp, resp_len, out);
+    return ret;
+}
+
+static esp_err_t rpc_profile_get_count(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    uint32_t count = device_profile_get_count();
+    RESP_PUT(resp, resp_len, count);
+    return ESP_OK;
+}
+
+static esp_err_t rpc_profile_get(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    device_profile_t profile;
+    esp_err_t ret = device_profile_get(read_u32(req), &profile);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    console_rpc_profile_t out = { .settings = settings_to_rpc(&profile.settings) };
+    strncpy(out.name, profile.name, sizeof(out.name) - 1);
+    RESP_PUT(resp, resp_len, out);
+    return ESP_OK;
+}
+
+// ==================== 自动保存 ====================
+
+static esp_err_t rpc_autosave_enable(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return device_autosave_enable(req[0] != 0);
+}
+
+static esp_err_t rpc_autosave_set_quiet(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return device_autosave_set_quiet_period(read_u32(req));
+}
+
+static esp_err_t rpc_autosave_flush(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    return device_autosave_flush();
+}
+
+static esp_err_t rpc_autosave_get_stats(const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len)
+{
+    device_autosave_stats_t stats;
+    esp_err_t ret = device_autosave_get_stats(&stats);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    console_rpc_autosave_stats_t out = {
+        .enabled = stats.enabled,
+        .pending = stats.pending,
+        .quiet_ms = stats.quiet_ms,
+        .change_events = stats.change_events,
+        .commits = stats.commits,
+        .unchanged_skips = stats.unchanged_skips,
+        .writes_avoided = stats.writes_avoided,
+        .failures = stats.failures,
+        .bytes_written = stats.bytes_written,
+        .last_commit_us = stats.last_commit_us,
+    };
+    RESP_PUT(resp, resp_len, out);
+    return ESP_OK;
+}
+
+// ==================== 分发表 ====================
+
+// 名称取处理函数名去掉 "rpc_" 前缀；res 为执行期间占用的资源，与控制台命令一致
+#define RPC_FIXED(id, fn, len, res) [id] = { .name = #fn + 4, .handler = fn, .req_len = (len), .resources = (res) }
+#define RPC_VAR(id, fn, res)        [id] = { .name = #fn + 4, .handler = fn, .var_len = true, .resources = (res) }
+
+static const rpc_entry_t s_handlers[CONSOLE_RPC_MSG_MAX] = {
+    RPC_VAR(CONSOLE_RPC_MSG_PING, rpc_ping, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_GET_VERSION, rpc_get_version, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_GET_RPC_STATS, rpc_get_rpc_stats, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_BAUD_SET, rpc_baud_set, sizeof(console_rpc_baud_set_t), 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_BAUD_GET, rpc_baud_get, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_JOB_GET, rpc_job_get, 4, 0),
+
+    RPC_FIXED(CONSOLE_RPC_MSG_FAN_SET_SPEED, rpc_fan_set_speed, 1, RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_FAN_GET_SPEED, rpc_fan_get_speed, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_FAN_START, rpc_fan_start, 0, RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_FAN_STOP, rpc_fan_stop, 0, RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_BOARD_LED_SET_COLOR, rpc_board_led_set_color, sizeof(console_rpc_color_t), RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_BOARD_LED_SET_BRIGHTNESS, rpc_board_led_set_brightness, 1, RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_BOARD_LED_SET_EFFECT, rpc_board_led_set_effect, 1, RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_BOARD_LED_OFF, rpc_board_led_off, 0, RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_BOARD_LED_GET_BRIGHTNESS, rpc_board_led_get_brightness, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_TOUCH_LED_SET_COLOR, rpc_touch_led_set_color, sizeof(console_rpc_color_t), RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_TOUCH_LED_SET_BRIGHTNESS, rpc_touch_led_set_brightness, 1, RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_TOUCH_LED_OFF, rpc_touch_led_off, 0, RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_TOUCH_LED_GET_BRIGHTNESS, rpc_touch_led_get_brightness, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_BOARD_LED_GET_COLOR, rpc_board_led_get_color, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_TOUCH_LED_GET_COLOR, rpc_touch_led_get_color, 0, 0),
+
+    RPC_FIXED(CONSOLE_RPC_MSG_GPIO_SET_OUTPUT, rpc_gpio_set_output, sizeof(console_rpc_gpio_t), RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_GPIO_READ_INPUT, rpc_gpio_read_input, 1, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_GPIO_READ_INPUT_MODE, rpc_gpio_read_input_mode, 1, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_GPIO_TOGGLE, rpc_gpio_toggle, 1, RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_USB_MUX_SET, rpc_usb_mux_set, 1, RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_USB_MUX_GET, rpc_usb_mux_get, 0, 0),
+
+    RPC_FIXED(CONSOLE_RPC_MSG_ORIN_POWER_ON, rpc_orin_power_on, 0, RES_ORIN),
+    RPC_FIXED(CONSOLE_RPC_MSG_ORIN_POWER_OFF, rpc_orin_power_off, 0, RES_ORIN),
+    RPC_FIXED(CONSOLE_RPC_MSG_ORIN_RESET, rpc_orin_reset, 0, RES_ORIN),
+    RPC_FIXED(CONSOLE_RPC_MSG_ORIN_RECOVERY, rpc_orin_recovery, 0, RES_ORIN),
+    RPC_FIXED(CONSOLE_RPC_MSG_N305_POWER_TOGGLE, rpc_n305_power_toggle, 0, RES_N305),
+    RPC_FIXED(CONSOLE_RPC_MSG_N305_RESET, rpc_n305_reset, 0, RES_N305),
+    RPC_FIXED(CONSOLE_RPC_MSG_ORIN_GET_POWER_STATE, rpc_orin_get_power_state, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_N305_GET_POWER_STATE, rpc_n305_get_power_state, 0, 0),
+
+    RPC_FIXED(CONSOLE_RPC_MSG_HW_TEST, rpc_hw_test, sizeof(console_rpc_hw_test_t), RES_ALL),
+    RPC_FIXED(CONSOLE_RPC_MSG_HW_GET_STATUS, rpc_hw_get_status, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_HW_GET_SETTINGS, rpc_hw_get_settings, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_HW_APPLY_SETTINGS, rpc_hw_apply_settings, sizeof(console_rpc_settings_t), RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_HW_TXN_COMMIT, rpc_hw_txn_commit, sizeof(console_rpc_hw_txn_t), RES_PERIPH),
+
+    RPC_FIXED(CONSOLE_RPC_MSG_DEV_QUICK_SETUP, rpc_dev_quick_setup, sizeof(console_rpc_quick_setup_t), RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_DEV_SHUTDOWN_ALL, rpc_dev_shutdown_all, 0, RES_ALL),
+    RPC_FIXED(CONSOLE_RPC_MSG_DEV_RESET_DEFAULT, rpc_dev_reset_default, 0, RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_DEV_SLEEP, rpc_dev_sleep, 0, RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_DEV_WAKE, rpc_dev_wake, 0, RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_DEV_GET_STATUS, rpc_dev_get_status, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_DEV_RUN_TEST, rpc_dev_run_test, sizeof(console_rpc_dev_test_t), RES_ALL),
+    RPC_FIXED(CONSOLE_RPC_MSG_DEV_SAVE_CONFIG, rpc_dev_save_config, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_DEV_LOAD_CONFIG, rpc_dev_load_config, 0, RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_DEV_CLEAR_CONFIG, rpc_dev_clear_config, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_DEV_CONFIG_BENCHMARK, rpc_dev_config_benchmark, 4, RES_BENCH),
+
+    RPC_FIXED(CONSOLE_RPC_MSG_PROFILE_SAVE, rpc_profile_save, CONSOLE_RPC_NAME_LEN, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_PROFILE_DELETE, rpc_profile_delete, CONSOLE_RPC_NAME_LEN, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_PROFILE_APPLY, rpc_profile_apply, sizeof(console_rpc_profile_apply_t), RES_PERIPH),
+    RPC_FIXED(CONSOLE_RPC_MSG_PROFILE_GET_COUNT, rpc_profile_get_count, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_PROFILE_GET, rpc_profile_get, 4, 0),
+
+    RPC_FIXED(CONSOLE_RPC_MSG_AUTOSAVE_ENABLE, rpc_autosave_enable, 1, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_AUTOSAVE_SET_QUIET, rpc_autosave_set_quiet, 4, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_AUTOSAVE_FLUSH, rpc_autosave_flush, 0, 0),
+    RPC_FIXED(CONSOLE_RPC_MSG_AUTOSAVE_GET_STATS, rpc_autosave_get_stats, 0, 0),
+};
+
+_Static_assert(sizeof(console_rpc_version_t) <= CONSOLE_RPC_MAX_PAYLOAD, "version payload too large");
+_Static_assert(sizeof(console_rpc_stats_t) <= CONSOLE_RPC_MAX_PAYLOAD, "stats payload too large");
+_Static_assert(sizeof(console_rpc_dev_status_t) <= CONSOLE_RPC_MAX_PAYLOAD, "status payload too large");
+_Static_assert(sizeof(console_rpc_autosave_stats_t) <= CONSOLE_RPC_MAX_PAYLOAD, "autosave payload too large");
+_Static_assert(sizeof(console_rpc_baud_status_t) <= CONSOLE_RPC_MAX_PAYLOAD, "baud payload too large");
+_Static_assert(sizeof(console_rpc_job_t) <= CONSOLE_RPC_MAX_PAYLOAD, "job payload too large");
+_Static_assert(CONSOLE_RPC_STATUS_BUSY == ESP_ERR_TIMEOUT, "busy status must match console_jobs_acquire()");
+
+// ==================== 后台任务 ====================
+
+// 在工作任务中重新调用处理函数，命令行为 "rpc <消息名> [十六进制负载]"，返回值即处理函数的错误码
+static int rpc_job(int argc, char **argv)
+{
+    if (argc < 2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t req[RPC_JOB_MAX_REQ];
+    size_t req_len = 0;
+    const char *hex = argc >= 3 ? argv[2] : "";
+    while (hex[0] != '\0' && hex[1] != '\0' && req_len < sizeof(req)) {
+        char byte[3] = { hex[0], hex[1], '\0' };
+        req[req_len++] = (uint8_t)strtoul(byte, NULL, 16);
+        hex += 2;
+    }
+
+    for (int msg = 0; msg < CONSOLE_RPC_MSG_MAX; msg++) {
+        if (s_handlers[msg].name == NULL || strcmp(s_handlers[msg].name, argv[1]) != 0) {
+            continue;
+        }
+        uint8_t resp[CONSOLE_RPC_MAX_PAYLOAD];
+        size_t resp_len = 0;
+        esp_err_t ret = s_handlers[msg].handler(req, req_len, resp, &resp_len);
+        if (ret != ESP_OK) {
+            printf("RPC %s 失败: %s\n", argv[1], esp_err_to_name(ret));
+        }
+        return ret;
+    }
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+// 把长耗时消息提交为后台任务，响应带任务号。返回false表示应直接执行（已在工作任务中
+// 重新调用，或任务执行器不可用），否则 status 为响应的错误码
+static bool submit_job(uint8_t msg, const uint8_t *req, size_t req_len, uint8_t *resp, size_t *resp_len,
+                       esp_err_t *status)
+{
+    if (console_jobs_in_worker()) {
+        return false;
+    }
+    if (req_len > RPC_JOB_MAX_REQ) {
+        *status = ESP_ERR_INVALID_SIZE;
+        return true;
+    }
+
+    char hex[2 * RPC_JOB_MAX_REQ + 1] = "";
+    for (size_t i = 0; i < req_len; i++) {
+        snprintf(&hex[2 * i], 3, "%02x", req[i]);
+    }
+    char *argv[] = { "rpc", (char *)s_handlers[msg].name, hex };
+
+    uint32_t id = 0;
+    esp_err_t ret = console_jobs_submit(rpc_job, req_len > 0 ? 3 : 2, argv, s_handlers[msg].resources, NULL, &id);
+    if (ret == ESP_ERR_INVALID_STATE) {
+        return false;
+    }
+    if (ret == ESP_OK) {
+        console_rpc_job_ref_t out = { .job_id = id };
+        RESP_PUT(resp, resp_len, out);
+        s_stats.jobs++;
+    }
+    *status = ret;
+    return true;
+}
+
+// ==================== 帧处理 ====================
+
+static size_t encode_response(const uint8_t *frame, size_t len, uint8_t *out, size_t out_size)
+{
+    if (out_size < CONSOLE_RPC_WIRE_BUF_SIZE) {
+        return 0;
+    }
+    size_t n = 0;
+    out[n++] = CONSOLE_RPC_DELIMITER;
+    n += console_rpc_cobs_encode(frame, len, out + n);
+    out[n++] = CONSOLE_RPC_DELIMITER;
+    return n;
+}
+
+size_t console_rpc_process(const uint8_t *encoded, size_t len, uint8_t *out, size_t out_size)
+{
+    int64_t start_us = esp_timer_get_time();
+    uint8_t frame[CONSOLE_RPC_MAX_FRAME];
+
+    size_t frame_len = console_rpc_cobs_decode(encoded, len, frame, sizeof(frame));
+    if (frame_len < CONSOLE_RPC_REQ_HEADER_LEN + CONSOLE_RPC_CRC_LEN ||
+        frame_len > CONSOLE_RPC_REQ_HEADER_LEN + CONSOLE_RPC_MAX_PAYLOAD + CONSOLE_RPC_CRC_LEN) {
+        s_stats.framing_errors++;
+        return 0;
+    }
+
+    size_t body_len = frame_len - CONSOLE_RPC_CRC_LEN;
+    uint16_t crc = (uint16_t)(frame[body_len] | (frame[body_len + 1] << 8));
+    if (console_rpc_crc16(0xFFFF, frame, body_len) != crc) {
+        // CRC错误时seq不可信，不响应，由主机超时重发
+        s_stats.crc_errors++;
+        return 0;
+    }
+
+    uint8_t seq = frame[0];
+    uint8_t msg = frame[1];
+    s_stats.frames_rx++;
+
+    // 重发的请求不再执行，直接重发缓存的响应
+    if (s_last_valid && seq == s_last_seq && msg == s_last_msg && crc == s_last_crc &&
+        out_size >= s_last_resp_len) {
+        s_stats.retransmits++;
+        s_stats.frames_tx++;
+        memcpy(out, s_last_resp, s_last_resp_len);
+        return s_last_resp_len;
+    }
+
+    const uint8_t *req = frame + CONSOLE_RPC_REQ_HEADER_LEN;
+    size_t req_len = body_len - CONSOLE_RPC_REQ_HEADER_LEN;
+
+    uint8_t resp[CONSOLE_RPC_MAX_FRAME];
+    uint8_t *payload = resp + CONSOLE_RPC_RESP_HEADER_LEN;
+    size_t payload_len = 0;
+    esp_err_t status;
+
+    const rpc_entry_t *entry = msg < CONSOLE_RPC_MSG_MAX ? &s_handlers[msg] : NULL;
+    if (entry == NULL || entry->handler == NULL) {
+        s_stats.unknown_msgs++;
+        status = ESP_ERR_NOT_SUPPORTED;
+    } else if (!entry->var_len && req_len != entry->req_len) {
+        s_stats.bad_length++;
+        status = ESP_ERR_INVALID_SIZE;
+    } else {
+        s_msg_count[msg]++;
+        // 与控制台命令占用同一组资源；被后台任务占用时不在控制台任务中等待，直接返回忙
+        if (console_jobs_acquire(entry->resources, 0) != ESP_OK) {
+            s_stats.busy++;
+            status = CONSOLE_RPC_STATUS_BUSY;
+        } else {
+            EVENT_TRACE_BEGIN(EVENT_TRACE_CONSOLE_RPC, msg, seq);
+            status = entry->handler(req, req_len, payload, &payload_len);
+            EVENT_TRACE_END(EVENT_TRACE_CONSOLE_RPC, (uint16_t)status, seq);
+            console_jobs_release(entry->resources);
+        }
+    }
+    if (status != ESP_OK) {
+        // 失败时只返回错误码
+        payload_len = 0;
+    }
+
+    resp[0] = seq;
+    resp[1] = msg | CONSOLE_RPC_RESPONSE_FLAG;
+    int32_t status_le = status;
+    memcpy(resp + 2, &status_le, sizeof(status_le));
+    size_t resp_len = CONSOLE_RPC_RESP_HEADER_LEN + payload_len;
+    uint16_t resp_crc = console_rpc_crc16(0xFFFF, resp, resp_len);
+    resp[resp_len++] = (uint8_t)(resp_crc & 0xFF);
+    resp[resp_len++] = (uint8_t)(resp_crc >> 8);
+
+    size_t n = encode_response(resp, resp_len, out, out_size);
+    if (n > 0) {
+        s_stats.frames_tx++;
+        memcpy(s_last_resp, out, n);
+        s_last_resp_len = n;
+        s_last_seq = seq;
+        s_last_msg = msg;
+        s_last_crc = crc;
+        s_last_valid = true;
+    }
+
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    s_stats.dispatch_last_us = elapsed_us;
+    if (elapsed_us > s_stats.dispatch_max_us) {
+        s_stats.dispatch_max_us = elapsed_us;
+    }
+    return n;
+}
+
+void console_rpc_note_framing_error(void)
+{
+    s_stats.framing_errors++;
+}
+
+// ==================== 统计 ====================
+
+esp_err_t console_rpc_get_stats(console_rpc_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(stats, &s_stats, sizeof(*stats));
+    return ESP_OK;
+}
+
+void console_rpc_reset_stats(void)
+{
+    memset(&s_stats, 0, sizeof(s_stats));
+    memset(s_msg_count, 0, sizeof(s_msg_count));
+    ESP_LOGI(TAG, "RPC stats reset");
+}
+
+const char *console_rpc_msg_name(uint8_t msg)
+{
+    if (msg >= CONSOLE_RPC_MSG_MAX || s_handlers[msg].name == NULL) {
+        return "unknown";
+    }
+    return s_handlers[msg].name;
+}
+
+esp_err_t console_rpc_print_stats(void)
+{
+    printf("\n=== 二进制RPC统计 ===\n");
+    printf("协议版本: %d, 最大负载: %d bytes\n", CONSOLE_RPC_PROTO_VERSION, CONSOLE_RPC_MAX_PAYLOAD);
+    printf("收到请求: %" PRIu32 ", 发送响应: %" PRIu32 ", 重发: %" PRIu32 "\n",
+           s_stats.frames_rx, s_stats.frames_tx, s_stats.retransmits);
+    printf("CRC错误: %" PRIu32 ", 帧错误: %" PRIu32 ", 未知消息: %" PRIu32 ", 长度错误: %" PRIu32 "\n",
+           s_stats.crc_errors, s_stats.framing_errors, s_stats.unknown_msgs, s_stats.bad_length);
+    printf("处理耗时: 最近 %" PRIu32 " us, 最长 %" PRIu32 " us (含处理函数)\n",
+           s_stats.dispatch_last_us, s_stats.dispatch_max_us);
+    printf("资源忙: %" PRIu32 ", 提交后台任务: %" PRIu32 "\n", s_stats.busy, s_stats.jobs);
+
+    bool any = false;
+    for (int i = 0; i < CONSOLE_RPC_MSG_MAX; i++) {
+        if (s_msg_count[i] == 0) {
+            continue;
+        }
+        if (!any) {
+            printf("按消息:\n");
+            any = true;
+        }
+        printf("  0x%02x %-24s %" PRIu32 "\n", i, console_rpc_msg_name(i), s_msg_count[i]);
+    }
+    printf("====================\n");
+    return ESP_OK;
+}
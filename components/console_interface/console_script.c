@@ -0,0 +1,756 @@
+/**
+ * @file console_script.c
+ * @brief 控制台命令批处理与宏实现
+ */
+
+#include "console_script.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_crc.h"
+#include "nvs.h"
+
+static const char *TAG = "CONSOLE_SCRIPT";
+
+static const char *NVS_NAMESPACE = "console_macros";
+
+#define MACRO_BLOB_MAGIC        0x434D      // "MC"
+#define MACRO_BLOB_VERSION      1
+
+/**
+ * @brief NVS中宏记录的头部，后接 code_len 字节的编译结果
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t magic;             // MACRO_BLOB_MAGIC
+    uint8_t version;            // 令牌格式版本
+    uint8_t steps;              // 命令数
+    uint16_t code_len;          // 令牌长度
+    uint16_t crc16;             // 令牌CRC16
+} macro_blob_header_t;
+
+typedef struct {
+    bool used;
+    console_script_macro_info_t info;
+    console_script_program_t program;
+} macro_slot_t;
+
+typedef struct {
+    console_script_exec_t exec;
+    SemaphoreHandle_t lock;         // 保护宏表
+    int depth;                      // 当前嵌套深度
+    macro_slot_t macros[CONSOLE_SCRIPT_MAX_MACROS];
+} console_script_ctx_t;
+
+static console_script_ctx_t s_script;
+
+// ==================== 编译 ====================
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+// 引号外的分隔符长度：`;` 为1，`&&`/`||` 为2，不是分隔符返回0
+static int separator_len(const char *p, console_script_op_t *op)
+{
+    if (p[0] == ';') {
+        *op = CONSOLE_SCRIPT_OP_SEQ;
+        return 1;
+    }
+    if (p[0] == '&' && p[1] == '&') {
+        *op = CONSOLE_SCRIPT_OP_AND;
+        return 2;
+    }
+    if (p[0] == '|' && p[1] == '|') {
+        *op = CONSOLE_SCRIPT_OP_OR;
+        return 2;
+    }
+    return 0;
+}
+
+bool console_script_is_batch(const char *line)
+{
+    bool quoted = false;
+    console_script_op_t op;
+    for (const char *p = line; *p != '\0'; p++) {
+        if (*p == '\\' && p[1] != '\0') {
+            p++;
+        } else if (*p == '"') {
+            quoted = !quoted;
+        } else if (!quoted && separator_len(p, &op) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static esp_err_t emit(console_script_program_t *program, uint8_t byte)
+{
+    if (program->len >= CONSOLE_SCRIPT_MAX_CODE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    program->code[program->len++] = byte;
+    return ESP_OK;
+}
+
+// 读取一个参数写入程序，p 指向参数的第一个字符
+static esp_err_t compile_token(const char **text, console_script_program_t *program)
+{
+    const char *p = *text;
+    bool quoted = false;
+    console_script_op_t op;
+    esp_err_t ret = ESP_OK;
+
+    while (*p != '\0' && ret == ESP_OK) {
+        if (!quoted && (is_space(*p) || separator_len(p, &op) > 0)) {
+            break;
+        }
+        if (*p == '"') {
+            quoted = !quoted;
+            p++;
+            continue;
+        }
+        if (*p == '\\' && p[1] != '\0') {
+            p++;
+        }
+        ret = emit(program, (uint8_t)*p++);
+    }
+    if (ret == ESP_OK && quoted) {
+        ret = ESP_ERR_INVALID_ARG;
+    }
+    if (ret == ESP_OK) {
+        ret = emit(program, '\0');
+    }
+    *text = p;
+    return ret;
+}
+
+esp_err_t console_script_compile(const char *text, console_script_program_t *program)
+{
+    if (text == NULL || program == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(program, 0, sizeof(*program));
+    const char *p = text;
+    console_script_op_t op = CONSOLE_SCRIPT_OP_SEQ;
+
+    for (;;) {
+        // 先占两个字节的命令头，读完参数后回填
+        uint16_t step_start = program->len;
+        if (program->len + 2 > CONSOLE_SCRIPT_MAX_CODE) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        program->len += 2;
+
+        uint8_t argc = 0;
+        for (;;) {
+            while (is_space(*p)) {
+                p++;
+            }
+            console_script_op_t next;
+            if (*p == '\0' || separator_len(p, &next) > 0) {
+                break;
+            }
+            if (argc >= CONSOLE_SCRIPT_MAX_ARGS) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            esp_err_t ret = compile_token(&p, program);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+            argc++;
+        }
+
+        console_script_op_t next_op = CONSOLE_SCRIPT_OP_SEQ;
+        int sep = *p != '\0' ? separator_len(p, &next_op) : 0;
+        p += sep;
+
+        if (argc == 0) {
+            // 空命令只允许出现在 `;` 之间或末尾，`&&`/`||` 两侧必须有命令
+            if (op != CONSOLE_SCRIPT_OP_SEQ || next_op != CONSOLE_SCRIPT_OP_SEQ) {
+                return ESP_ERR_INVALID_ARG;
+            }
+            program->len = step_start;
+        } else {
+            if (program->steps >= CONSOLE_SCRIPT_MAX_STEPS) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            program->code[step_start] = (uint8_t)op;
+            program->code[step_start + 1] = argc;
+            program->steps++;
+        }
+
+        if (sep == 0) {
+            break;
+        }
+        op = next_op;
+    }
+
+    return program->steps > 0 ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+// 检查从NVS读出的程序结构完整，执行时不再做边界检查
+static bool validate_program(const console_script_program_t *program)
+{
+    uint16_t pos = 0;
+    for (uint8_t i = 0; i < program->steps; i++) {
+        if (pos + 2 > program->len) {
+            return false;
+        }
+        uint8_t op = program->code[pos++];
+        uint8_t argc = program->code[pos++];
+        if (op > CONSOLE_SCRIPT_OP_OR || argc == 0 || argc > CONSOLE_SCRIPT_MAX_ARGS) {
+            return false;
+        }
+        for (uint8_t a = 0; a < argc; a++) {
+            const void *end = memchr(&program->code[pos], '\0', program->len - pos);
+            if (end == NULL) {
+                return false;
+            }
+            pos = (uint16_t)((const uint8_t *)end - program->code) + 1;
+        }
+    }
+    return pos == program->len && program->steps <= CONSOLE_SCRIPT_MAX_STEPS;
+}
+
+static bool needs_quotes(const char *arg)
+{
+    if (*arg == '\0') {
+        return true;
+    }
+    for (const char *p = arg; *p != '\0'; p++) {
+        if (is_space(*p) || strchr(";&|\"\\", *p) != NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t console_script_decompile(const console_script_program_t *program, char *buf, size_t size)
+{
+    static const char *const op_text[] = { " ; ", " && ", " || " };
+    size_t out = 0;
+    bool truncated = false;
+
+#define PUT(c) do { if (out + 1 < size) { buf[out++] = (c); } else { truncated = true; } } while (0)
+
+    if (program == NULL || buf == NULL || size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint16_t pos = 0;
+    for (uint8_t i = 0; i < program->steps; i++) {
+        uint8_t op = program->code[pos++];
+        uint8_t argc = program->code[pos++];
+        if (i > 0) {
+            for (const char *s = op_text[op]; *s != '\0'; s++) {
+                PUT(*s);
+            }
+        }
+        for (uint8_t a = 0; a < argc; a++) {
+            const char *arg = (const char *)&program->code[pos];
+            pos += strlen(arg) + 1;
+            if (a > 0) {
+                PUT(' ');
+            }
+            bool quote = needs_quotes(arg);
+            if (quote) {
+                PUT('"');
+            }
+            for (const char *s = arg; *s != '\0'; s++) {
+                if (*s == '"' || *s == '\\') {
+                    PUT('\\');
+                }
+                PUT(*s);
+            }
+            if (quote) {
+                PUT('"');
+            }
+        }
+    }
+    buf[out] = '\0';
+
+#undef PUT
+
+    return truncated ? ESP_ERR_INVALID_SIZE : ESP_OK;
+}
+
+// ==================== 执行 ====================
+
+// 在程序的私有副本上执行：命令可以修改参数，也可以在执行中重新定义或删除宏
+static esp_err_t run_program(console_script_program_t *program, console_script_result_t *result)
+{
+    if (s_script.depth >= CONSOLE_SCRIPT_MAX_DEPTH) {
+        printf("宏嵌套过深 (最多 %d 层)\n", CONSOLE_SCRIPT_MAX_DEPTH);
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_script.depth++;
+
+    console_script_result_t res = { .steps = program->steps };
+    int64_t start_us = esp_timer_get_time();
+    char *argv[CONSOLE_SCRIPT_MAX_ARGS + 1];
+    uint16_t pos = 0;
+    int status = 0;
+
+    for (uint8_t i = 0; i < program->steps; i++) {
+        console_script_op_t op = (console_script_op_t)program->code[pos++];
+        uint8_t argc = program->code[pos++];
+        for (uint8_t a = 0; a < argc; a++) {
+            argv[a] = (char *)&program->code[pos];
+            pos += strlen(argv[a]) + 1;
+        }
+        argv[argc] = NULL;
+
+        bool run = op == CONSOLE_SCRIPT_OP_SEQ ||
+                   (op == CONSOLE_SCRIPT_OP_AND && status == 0) ||
+                   (op == CONSOLE_SCRIPT_OP_OR && status != 0);
+        if (!run) {
+            res.skipped++;
+            continue;
+        }
+
+        int ret = 0;
+        esp_err_t err = s_script.exec(argc, argv, &ret);
+        if (err == ESP_ERR_NOT_FOUND) {
+            printf("未知命令: '%s'\n", argv[0]);
+            ret = 1;
+        } else if (err != ESP_OK) {
+            printf("命令执行错误: %s\n", esp_err_to_name(err));
+            ret = 1;
+        }
+        status = ret;
+        res.executed++;
+    }
+
+    res.status = status;
+    res.elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    s_script.depth--;
+    if (result != NULL) {
+        *result = res;
+    }
+    return ESP_OK;
+}
+
+esp_err_t console_script_run(const console_script_program_t *program, console_script_result_t *result)
+{
+    if (program == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_script.exec == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    console_script_program_t *copy = malloc(sizeof(*copy));
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, program, sizeof(*copy));
+    esp_err_t ret = run_program(copy, result);
+    free(copy);
+    return ret;
+}
+
+esp_err_t console_script_run_line(const char *line, int *ret)
+{
+    if (line == NULL || ret == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_script.exec == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    console_script_program_t *program = malloc(sizeof(*program));
+    if (program == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    *ret = 1;
+    esp_err_t err = console_script_compile(line, program);
+    if (err == ESP_ERR_INVALID_SIZE) {
+        printf("批处理过长: 最多 %d 条命令、每条 %d 个参数、共 %d 字节\n",
+               CONSOLE_SCRIPT_MAX_STEPS, CONSOLE_SCRIPT_MAX_ARGS, CONSOLE_SCRIPT_MAX_CODE);
+        err = ESP_OK;
+    } else if (err != ESP_OK) {
+        printf("批处理语法错误: 引号未闭合，或 && / || 两侧缺少命令\n");
+        err = ESP_OK;
+    } else {
+        console_script_result_t result;
+        err = run_program(program, &result);
+        if (err == ESP_OK) {
+            *ret = result.status;
+        }
+    }
+
+    free(program);
+    return err;
+}
+
+bool console_script_running(void)
+{
+    return s_script.depth > 0;
+}
+
+// ==================== 宏 ====================
+
+static bool is_valid_macro_name(const char *name)
+{
+    if (name == NULL) {
+        return false;
+    }
+    size_t len = strlen(name);
+    if (len == 0 || len > CONSOLE_SCRIPT_NAME_MAX_LEN) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (!isalnum((unsigned char)name[i]) && name[i] != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+static macro_slot_t *find_macro_locked(const char *name)
+{
+    for (int i = 0; i < CONSOLE_SCRIPT_MAX_MACROS; i++) {
+        if (s_script.macros[i].used && strcmp(s_script.macros[i].info.name, name) == 0) {
+            return &s_script.macros[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t write_macro_blob(const char *name, const console_script_program_t *program)
+{
+    uint8_t blob[sizeof(macro_blob_header_t) + CONSOLE_SCRIPT_MAX_CODE];
+    macro_blob_header_t header = {
+        .magic = MACRO_BLOB_MAGIC,
+        .version = MACRO_BLOB_VERSION,
+        .steps = program->steps,
+        .code_len = program->len,
+        .crc16 = esp_rom_crc16_le(0, program->code, program->len),
+    };
+    memcpy(blob, &header, sizeof(header));
+    memcpy(blob + sizeof(header), program->code, program->len);
+
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ret = nvs_set_blob(nvs_handle, name, blob, sizeof(header) + program->len);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save macro '%s': %s", name, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+static esp_err_t read_macro_blob(nvs_handle_t nvs_handle, const char *key, console_script_program_t *program)
+{
+    uint8_t blob[sizeof(macro_blob_header_t) + CONSOLE_SCRIPT_MAX_CODE];
+    size_t length = sizeof(blob);
+    esp_err_t ret = nvs_get_blob(nvs_handle, key, blob, &length);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    macro_blob_header_t header;
+    if (length < sizeof(header)) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    memcpy(&header, blob, sizeof(header));
+    if (header.magic != MACRO_BLOB_MAGIC || header.version != MACRO_BLOB_VERSION ||
+        sizeof(header) + header.code_len != length) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (esp_rom_crc16_le(0, blob + sizeof(header), header.code_len) != header.crc16) {
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    memset(program, 0, sizeof(*program));
+    program->steps = header.steps;
+    program->len = header.code_len;
+    memcpy(program->code, blob + sizeof(header), header.code_len);
+    return validate_program(program) ? ESP_OK : ESP_ERR_INVALID_VERSION;
+}
+
+static void load_macros(void)
+{
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;  // 尚未定义过宏
+    }
+
+    int count = 0;
+    nvs_iterator_t it = NULL;
+    esp_err_t ret = nvs_entry_find(NVS_DEFAULT_PART_NAME, NVS_NAMESPACE, NVS_TYPE_BLOB, &it);
+    while (ret == ESP_OK && count < CONSOLE_SCRIPT_MAX_MACROS) {
+        nvs_entry_info_t info;
+        nvs_entry_info(it, &info);
+
+        macro_slot_t *slot = &s_script.macros[count];
+        if (is_valid_macro_name(info.key) && read_macro_blob(nvs_handle, info.key, &slot->program) == ESP_OK) {
+            memset(&slot->info, 0, sizeof(slot->info));
+            snprintf(slot->info.name, sizeof(slot->info.name), "%s", info.key);
+            slot->info.steps = slot->program.steps;
+            slot->info.code_len = slot->program.len;
+            slot->used = true;
+            count++;
+        } else {
+            ESP_LOGW(TAG, "Skipping invalid macro '%s'", info.key);
+        }
+        ret = nvs_entry_next(&it);
+    }
+    nvs_release_iterator(it);
+    nvs_close(nvs_handle);
+
+    ESP_LOGI(TAG, "Loaded %d macros", count);
+}
+
+esp_err_t console_script_init(console_script_exec_t exec)
+{
+    if (exec == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_script.lock == NULL) {
+        s_script.lock = xSemaphoreCreateMutex();
+        if (s_script.lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        load_macros();
+    }
+    s_script.exec = exec;
+    return ESP_OK;
+}
+
+esp_err_t console_script_macro_define(const char *name, const char *body)
+{
+    if (!is_valid_macro_name(name) || body == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_script.lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    console_script_program_t *program = malloc(sizeof(*program));
+    if (program == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = console_script_compile(body, program);
+    if (ret != ESP_OK) {
+        free(program);
+        return ret;
+    }
+
+    xSemaphoreTake(s_script.lock, portMAX_DELAY);
+    macro_slot_t *slot = find_macro_locked(name);
+    bool replace = slot != NULL;
+    for (int i = 0; i < CONSOLE_SCRIPT_MAX_MACROS && slot == NULL; i++) {
+        if (!s_script.macros[i].used) {
+            slot = &s_script.macros[i];
+        }
+    }
+    if (slot == NULL) {
+        ret = ESP_ERR_NO_MEM;
+    } else {
+        ret = write_macro_blob(name, program);
+    }
+    if (ret == ESP_OK) {
+        // 重新定义时统计清零
+        memset(&slot->info, 0, sizeof(slot->info));
+        snprintf(slot->info.name, sizeof(slot->info.name), "%s", name);
+        slot->info.steps = program->steps;
+        slot->info.code_len = program->len;
+        slot->program = *program;
+        slot->used = true;
+    }
+    xSemaphoreGive(s_script.lock);
+
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Macro '%s' %s (%d steps, %d bytes)", name, replace ? "replaced" : "defined",
+                 program->steps, program->len);
+    }
+    free(program);
+    return ret;
+}
+
+esp_err_t console_script_macro_delete(const char *name)
+{
+    if (name == NULL || s_script.lock == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    xSemaphoreTake(s_script.lock, portMAX_DELAY);
+    macro_slot_t *slot = find_macro_locked(name);
+    esp_err_t ret = slot != NULL ? ESP_OK : ESP_ERR_NOT_FOUND;
+    if (ret == ESP_OK) {
+        nvs_handle_t nvs_handle;
+        ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+        if (ret == ESP_OK) {
+            ret = nvs_erase_key(nvs_handle, name);
+            if (ret == ESP_ERR_NVS_NOT_FOUND) {
+                ret = ESP_OK;
+            }
+            if (ret == ESP_OK) {
+                ret = nvs_commit(nvs_handle);
+            }
+            nvs_close(nvs_handle);
+        }
+        if (ret == ESP_OK) {
+            slot->used = false;
+        } else {
+            ESP_LOGE(TAG, "Failed to delete macro '%s': %s", name, esp_err_to_name(ret));
+        }
+    }
+    xSemaphoreGive(s_script.lock);
+    return ret;
+}
+
+esp_err_t console_script_macro_run(const char *name, console_script_result_t *result)
+{
+    if (name == NULL || s_script.lock == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    console_script_program_t *copy = malloc(sizeof(*copy));
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreTake(s_script.lock, portMAX_DELAY);
+    macro_slot_t *slot = find_macro_locked(name);
+    if (slot != NULL) {
+        *copy = slot->program;
+    }
+    xSemaphoreGive(s_script.lock);
+    if (slot == NULL) {
+        free(copy);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    console_script_result_t res;
+    esp_err_t ret = run_program(copy, &res);
+    free(copy);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 执行期间宏可能被删除或重新定义，按名字重新查找
+    xSemaphoreTake(s_script.lock, portMAX_DELAY);
+    slot = find_macro_locked(name);
+    if (slot != NULL) {
+        slot->info.runs++;
+        if (res.status != 0) {
+            slot->info.failures++;
+        }
+        slot->info.last_us = res.elapsed_us;
+        slot->info.total_us += res.elapsed_us;
+        if (res.elapsed_us > slot->info.max_us) {
+            slot->info.max_us = res.elapsed_us;
+        }
+    }
+    xSemaphoreGive(s_script.lock);
+
+    if (result != NULL) {
+        *result = res;
+    }
+    return ESP_OK;
+}
+
+esp_err_t console_script_macro_get_info(const char *name, console_script_macro_info_t *info)
+{
+    if (name == NULL || info == NULL || s_script.lock == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    xSemaphoreTake(s_script.lock, portMAX_DELAY);
+    macro_slot_t *slot = find_macro_locked(name);
+    if (slot != NULL) {
+        *info = slot->info;
+    }
+    xSemaphoreGive(s_script.lock);
+    return slot != NULL ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t console_script_macro_print(const char *name)
+{
+    if (name == NULL || s_script.lock == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    console_script_program_t *program = malloc(sizeof(*program));
+    char *text = malloc(CONSOLE_SCRIPT_MAX_CODE * 2);
+    if (program == NULL || text == NULL) {
+        free(program);
+        free(text);
+        return ESP_ERR_NO_MEM;
+    }
+
+    console_script_macro_info_t info;
+    xSemaphoreTake(s_script.lock, portMAX_DELAY);
+    macro_slot_t *slot = find_macro_locked(name);
+    if (slot != NULL) {
+        *program = slot->program;
+        info = slot->info;
+    }
+    xSemaphoreGive(s_script.lock);
+
+    if (slot != NULL) {
+        console_script_decompile(program, text, CONSOLE_SCRIPT_MAX_CODE * 2);
+        printf("%s: %s\n", info.name, text);
+        printf("  %d 条命令，%d 字节，执行 %" PRIu32 " 次 (失败 %" PRIu32 ")", info.steps, info.code_len,
+               info.runs, info.failures);
+        if (info.runs > 0) {
+            printf("，平均 %" PRIu32 " us，最长 %" PRIu32 " us，最近 %" PRIu32 " us",
+                   (uint32_t)(info.total_us / info.runs), info.max_us, info.last_us);
+        }
+        printf("\n");
+    }
+
+    free(program);
+    free(text);
+    return slot != NULL ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t console_script_macro_print_list(void)
+{
+    console_script_macro_info_t list[CONSOLE_SCRIPT_MAX_MACROS];
+    int count = 0;
+
+    if (s_script.lock != NULL) {
+        xSemaphoreTake(s_script.lock, portMAX_DELAY);
+        for (int i = 0; i < CONSOLE_SCRIPT_MAX_MACROS; i++) {
+            if (s_script.macros[i].used) {
+                list[count++] = s_script.macros[i].info;
+            }
+        }
+        xSemaphoreGive(s_script.lock);
+    }
+
+    printf("\n=== 宏 (%d/%d) ===\n", count, CONSOLE_SCRIPT_MAX_MACROS);
+    printf("%-16s %4s %5s %6s %4s %10s %10s %10s\n",
+           "名称", "命令", "字节", "次数", "失败", "平均(us)", "最长(us)", "最近(us)");
+    for (int i = 0; i < count; i++) {
+        const console_script_macro_info_t *info = &list[i];
+        printf("%-16s %4d %5d %6" PRIu32 " %4" PRIu32 " %10" PRIu32 " %10" PRIu32 " %10" PRIu32 "\n",
+               info->name, info->steps, info->code_len, info->runs, info->failures,
+               info->runs > 0 ? (uint32_t)(info->total_us / info->runs) : 0, info->max_us, info->last_us);
+    }
+    if (count == 0) {
+        printf("暂无宏\n");
+    }
+    printf("================\n");
+    return ESP_OK;
+}
@@ -0,0 +1,181 @@
+/**
+ * @file console_baud.h
+ * @brief 控制台UART波特率协商
+ *
+ * 切换流程（文本命令 `baud <速率>` 与RPC消息 CONSOLE_RPC_MSG_BAUD_SET 相同）：
+ *   1. 请求在当前波特率下得到应答（命令输出或RPC响应）
+ *   2. 应答发送完成后控制台切换到新波特率，进入确认期
+ *   3. 确认期内在新波特率下收到一条执行成功的命令或一个CRC正确的RPC帧即确认；
+ *      超时未收到则认为对端没有跟上，自动恢复原波特率
+ *   4. 请求保存时，确认后把新波特率写入NVS，下次启动直接使用
+ *
+ * 启动时使用NVS中保存的波特率同样处于确认期（CONSOLE_BAUD_BOOT_CONFIRM_MS），
+ * 期间没有收到有效输入则回到默认波特率，NVS中的记录保留。
+ */
+
+#ifndef CONSOLE_BAUD_H
+#define CONSOLE_BAUD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef CONFIG_ESP_CONSOLE_UART_BAUDRATE
+#define CONSOLE_BAUD_DEFAULT            CONFIG_ESP_CONSOLE_UART_BAUDRATE
+#else
+#define CONSOLE_BAUD_DEFAULT            115200
+#endif
+#define CONSOLE_BAUD_MAX                2000000 /*!< 支持的最高波特率 */
+#define CONSOLE_BAUD_CONFIRM_MS         5000    /*!< 默认确认期 (ms) */
+#define CONSOLE_BAUD_BOOT_CONFIRM_MS    60000   /*!< 启动时使用保存的波特率的确认期 (ms) */
+#define CONSOLE_BAUD_TEST_BYTES         4096    /*!< 自检每个波特率发送的字节数 */
+
+/**
+ * @brief 协商状态
+ */
+typedef enum {
+    CONSOLE_BAUD_STATE_STABLE = 0,      /*!< 已确认 */
+    CONSOLE_BAUD_STATE_PENDING,         /*!< 已接受切换请求，等待应答发送完成 */
+    CONSOLE_BAUD_STATE_CONFIRMING,      /*!< 已切换，等待对端在新波特率下确认 */
+} console_baud_state_t;
+
+/**
+ * @brief 波特率状态与统计
+ */
+typedef struct {
+    uint32_t current;               /*!< 当前波特率 */
+    uint32_t previous;              /*!< 确认失败时恢复的波特率 */
+    uint32_t saved;                 /*!< NVS中保存的波特率，0表示未保存 */
+    console_baud_state_t state;     /*!< 协商状态 */
+    uint32_t confirm_ms;            /*!< 当前确认期 (ms) */
+    uint32_t switches;              /*!< 切换次数 */
+    uint32_t confirms;              /*!< 确认成功次数 */
+    uint32_t fallbacks;             /*!< 超时恢复次数 */
+} console_baud_status_t;
+
+/**
+ * @brief 自检结果
+ */
+typedef struct {
+    uint32_t baud;                  /*!< 波特率 */
+    uint32_t bytes;                 /*!< 发送字节数 */
+    uint32_t received;              /*!< 回环收到的字节数 */
+    uint32_t errors;                /*!< 内容不一致的字节数 */
+    uint32_t elapsed_us;            /*!< 发送到全部收回的耗时 (us) */
+    uint32_t bytes_per_sec;         /*!< 实测吞吐 (bytes/s) */
+} console_baud_test_result_t;
+
+/**
+ * @brief 初始化：读取NVS中保存的波特率并切换（进入启动确认期）
+ *
+ * @param uart_driver 控制台UART驱动是否已安装，未安装时只记录状态不切换硬件
+ * @return
+ *     - ESP_OK: 初始化成功
+ *     - ESP_ERR_NO_MEM: 创建定时器失败
+ */
+esp_err_t console_baud_init(bool uart_driver);
+
+/**
+ * @brief 检查波特率是否支持（CONSOLE_BAUD_DEFAULT ~ CONSOLE_BAUD_MAX 的标准速率）
+ *
+ * @param baud 波特率
+ * @return 是否支持
+ */
+bool console_baud_is_supported(uint32_t baud);
+
+/**
+ * @brief 获取候选波特率列表（升序，含低于默认值而不支持的速率，用 console_baud_is_supported 过滤）
+ *
+ * @param rates 输出列表指针
+ * @return 列表长度
+ */
+size_t console_baud_get_rates(const uint32_t **rates);
+
+/**
+ * @brief 请求切换波特率，实际切换在 console_baud_apply_pending() 中进行
+ *
+ * @param baud 目标波特率
+ * @param confirm_ms 确认期 (ms)，0使用 CONSOLE_BAUD_CONFIRM_MS
+ * @param persist 确认后是否保存到NVS
+ * @return
+ *     - ESP_OK: 已接受
+ *     - ESP_ERR_NOT_SUPPORTED: 不支持的波特率
+ *     - ESP_ERR_INVALID_STATE: 上一次切换尚未确认
+ */
+esp_err_t console_baud_request(uint32_t baud, uint32_t confirm_ms, bool persist);
+
+/**
+ * @brief 执行挂起的切换：等待应答发送完成后切换波特率并开始确认期
+ *
+ * 由控制台任务在命令输出或RPC响应写出后调用。
+ */
+void console_baud_apply_pending(void);
+
+/**
+ * @brief 记录一次有效输入（执行成功的命令或CRC正确的RPC帧），确认期内即确认
+ */
+void console_baud_note_valid_input(void);
+
+/**
+ * @brief 把当前波特率保存到NVS
+ *
+ * @return
+ *     - ESP_OK: 保存成功
+ *     - ESP_ERR_INVALID_STATE: 当前波特率尚未确认
+ *     - 其他: NVS错误
+ */
+esp_err_t console_baud_save(void);
+
+/**
+ * @brief 清除NVS中保存的波特率，下次启动使用默认波特率
+ *
+ * @return
+ *     - ESP_OK: 清除成功
+ *     - 其他: NVS错误
+ */
+esp_err_t console_baud_clear_saved(void);
+
+/**
+ * @brief 获取波特率状态
+ *
+ * @param status 存储状态的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t console_baud_get_status(console_baud_status_t *status);
+
+/**
+ * @brief 吞吐自检：UART内部回环下以指定波特率收发 CONSOLE_BAUD_TEST_BYTES 字节
+ *
+ * 自检期间控制台暂时不可用，结束后恢复原波特率。TX引脚上会出现测试数据。
+ *
+ * @param baud 波特率
+ * @param result 存储结果的指针
+ * @return
+ *     - ESP_OK: 自检完成（结果中可能有错误字节）
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NOT_SUPPORTED: 不支持的波特率或未安装UART驱动（仿真目标）
+ *     - ESP_ERR_INVALID_STATE: 正在协商
+ */
+esp_err_t console_baud_self_test(uint32_t baud, console_baud_test_result_t *result);
+
+/**
+ * @brief 打印波特率状态
+ *
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t console_baud_print_status(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONSOLE_BAUD_H */
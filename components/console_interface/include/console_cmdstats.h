@@ -0,0 +1,167 @@
+/**
+ * @file console_cmdstats.h
+ * @brief 控制台命令执行统计与慢命令日志
+ *
+ * 每条经控制台、批处理或宏执行的命令记录一次：调用次数、失败次数（返回非0）、
+ * 累计/最大/最近耗时和log2耗时直方图，按命令在分发表中的下标存放（见 console_dispatch.h）。
+ * 提交为后台任务的命令由工作任务在执行完成后记录，提交本身不计入。
+ *
+ * 耗时达到阈值的命令写入固定大小的环形日志（开机后时间、耗时、返回值和命令行），
+ * 日志满后覆盖最早的记录。
+ */
+
+#ifndef CONSOLE_CMDSTATS_H
+#define CONSOLE_CMDSTATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONSOLE_CMDSTATS_BUCKETS        20      /*!< 直方图桶数：桶0为 <64 us，桶i覆盖 [2^(i+5), 2^(i+6)) us，最后一桶不设上限 */
+#define CONSOLE_CMDSTATS_BUCKET_SHIFT   6       /*!< 桶0的上界 (1 << shift us) */
+#define CONSOLE_CMDSTATS_SLOW_LOG       16      /*!< 慢命令日志条数 */
+#define CONSOLE_CMDSTATS_LINE_LEN       48      /*!< 慢命令日志中保存的命令行长度 */
+#define CONSOLE_CMDSTATS_SLOW_DEFAULT_MS 100    /*!< 默认慢命令阈值 (ms) */
+
+/**
+ * @brief 单条命令的统计
+ */
+typedef struct {
+    const char *name;               /*!< 命令名 */
+    uint32_t calls;                 /*!< 调用次数 */
+    uint32_t errors;                /*!< 返回非0的次数 */
+    uint64_t total_us;              /*!< 累计耗时 (us) */
+    uint32_t max_us;                /*!< 最大耗时 (us) */
+    uint32_t last_us;               /*!< 最近一次耗时 (us) */
+    uint32_t buckets[CONSOLE_CMDSTATS_BUCKETS]; /*!< 耗时直方图 */
+} console_cmdstats_entry_t;
+
+/**
+ * @brief 慢命令日志记录
+ */
+typedef struct {
+    uint32_t seq;                   /*!< 序号，从1开始递增 */
+    uint64_t timestamp_ms;          /*!< 命令结束时的开机后时间 (ms) */
+    uint32_t elapsed_us;            /*!< 耗时 (us) */
+    int result;                     /*!< 命令返回值 */
+    char line[CONSOLE_CMDSTATS_LINE_LEN]; /*!< 命令行（过长时截断） */
+} console_cmdstats_slow_t;
+
+/**
+ * @brief 初始化
+ *
+ * @return
+ *     - ESP_OK: 初始化成功
+ *     - ESP_ERR_NO_MEM: 创建互斥锁失败
+ */
+esp_err_t console_cmdstats_init(void);
+
+/**
+ * @brief 记录一次命令执行，可在任意任务中调用
+ *
+ * @param argc 参数个数
+ * @param argv 调用处理函数前的参数（处理函数可能重排argv），argv[0]为命令名
+ * @param result 命令返回值
+ * @param elapsed_us 耗时 (us)
+ */
+void console_cmdstats_record(int argc, char *const *argv, int result, uint32_t elapsed_us);
+
+/**
+ * @brief 按分发表下标获取命令统计
+ *
+ * @param index 命令下标，0 ~ console_dispatch_get_count()-1
+ * @param entry 存储统计的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NOT_FOUND: 下标无效
+ */
+esp_err_t console_cmdstats_get(int index, console_cmdstats_entry_t *entry);
+
+/**
+ * @brief 由直方图估算百分位耗时（所在桶的上界）
+ *
+ * @param entry 命令统计
+ * @param percent 百分位 (1-100)
+ * @return 耗时上界 (us)，没有记录时为0；落在最后一桶时返回最大耗时
+ */
+uint32_t console_cmdstats_percentile_us(const console_cmdstats_entry_t *entry, uint32_t percent);
+
+/**
+ * @brief 直方图桶的下界
+ *
+ * @param bucket 桶序号
+ * @return 下界 (us)
+ */
+uint32_t console_cmdstats_bucket_floor_us(int bucket);
+
+/**
+ * @brief 获取慢命令日志记录
+ *
+ * @param age 0为最新的记录，依次向前
+ * @param entry 存储记录的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NOT_FOUND: 没有这么多记录
+ */
+esp_err_t console_cmdstats_get_slow(int age, console_cmdstats_slow_t *entry);
+
+/**
+ * @brief 获取慢命令总数（含已被覆盖的记录）
+ *
+ * @return 慢命令总数
+ */
+uint32_t console_cmdstats_get_slow_total(void);
+
+/**
+ * @brief 设置慢命令阈值
+ *
+ * @param threshold_ms 阈值 (ms)，0表示记录全部命令
+ * @return
+ *     - ESP_OK: 设置成功
+ */
+esp_err_t console_cmdstats_set_slow_threshold(uint32_t threshold_ms);
+
+/**
+ * @brief 获取慢命令阈值
+ *
+ * @return 阈值 (ms)
+ */
+uint32_t console_cmdstats_get_slow_threshold(void);
+
+/**
+ * @brief 清零全部统计和慢命令日志
+ *
+ * @return
+ *     - ESP_OK: 清零成功
+ */
+esp_err_t console_cmdstats_reset(void);
+
+/**
+ * @brief 打印命令统计表，或一条命令的统计与直方图
+ *
+ * @param name 命令名，传入NULL打印全部执行过的命令
+ * @return
+ *     - ESP_OK: 打印成功
+ *     - ESP_ERR_NOT_FOUND: 命令不存在
+ */
+esp_err_t console_cmdstats_print(const char *name);
+
+/**
+ * @brief 打印慢命令日志（从最早到最新）
+ *
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t console_cmdstats_print_slow(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONSOLE_CMDSTATS_H */
@@ -0,0 +1,205 @@
+/**
+ * @file console_dispatch.h
+ * @brief 控制台命令分发：完美哈希查找、原地分词与类型化参数解析
+ *
+ * 命令名和子命令名在注册时计算一次32位FNV-1a哈希，再搜索一个种子，使所有名字经
+ * 种子混合后落在哈希表的不同槽中（完美哈希）。查找时对输入名计算一次哈希、
+ * 取一个槽、做一次字符串比较，与已注册命令的数量无关。
+ *
+ * 命令行在调用者提供的缓冲区中原地分词，argv 指向缓冲区内部，参数解析不分配堆内存。
+ *
+ * 命令表在控制台任务启动前注册完成，之后只读，可在任意任务中查找。
+ */
+
+#ifndef CONSOLE_DISPATCH_H
+#define CONSOLE_DISPATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONSOLE_DISPATCH_MAX_COMMANDS   48      /*!< 最多注册的命令数 */
+#define CONSOLE_DISPATCH_TABLE_BITS     8       /*!< 命令哈希表槽数 (1 << bits) */
+#define CONSOLE_DISPATCH_MAX_ARGS       32      /*!< 每行最多参数个数 */
+#define CONSOLE_DISPATCH_SUB_BITS       6       /*!< 子命令哈希表槽数 (1 << bits) */
+#define CONSOLE_DISPATCH_MAX_SUBCMDS    16      /*!< 每个子命令表最多名字数 */
+#define CONSOLE_DISPATCH_SEED_TRIES     20000   /*!< 搜索完美哈希种子的最大次数 */
+
+/**
+ * @brief 命令处理函数，与 esp_console_cmd_func_t 相同
+ */
+typedef int (*console_dispatch_func_t)(int argc, char **argv);
+
+/**
+ * @brief 子命令表，用 CONSOLE_SUBCMD_TABLE() 定义，console_dispatch_subcmd_build() 生成索引
+ */
+typedef struct {
+    const char *const *names;       /*!< 子命令名，下标即查找结果 */
+    uint8_t count;                  /*!< 名字个数 */
+    bool built;                     /*!< 索引已生成 */
+    uint32_t seed;                  /*!< 完美哈希种子 */
+    uint8_t slots[1 << CONSOLE_DISPATCH_SUB_BITS]; /*!< 槽 -> 下标+1，0为空 */
+} console_subcmd_table_t;
+
+/**
+ * @brief 定义子命令表，如 `static console_subcmd_table_t s_subcmds = CONSOLE_SUBCMD_TABLE("on", "off");`
+ */
+#define CONSOLE_SUBCMD_TABLE(...) { \
+    .names = (const char *const[]){ __VA_ARGS__ }, \
+    .count = sizeof((const char *const[]){ __VA_ARGS__ }) / sizeof(const char *), \
+}
+
+/**
+ * @brief 注册命令并重新生成命令哈希表
+ *
+ * @param name 命令名（静态字符串）
+ * @param func 处理函数
+ * @return
+ *     - ESP_OK: 注册成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 同名命令已注册
+ *     - ESP_ERR_NO_MEM: 命令表已满
+ *     - ESP_FAIL: 找不到完美哈希种子（命令未注册）
+ */
+esp_err_t console_dispatch_register(const char *name, console_dispatch_func_t func);
+
+/**
+ * @brief 按名字查找命令
+ *
+ * @param name 命令名
+ * @return 处理函数，不存在时返回NULL
+ */
+console_dispatch_func_t console_dispatch_find(const char *name);
+
+/**
+ * @brief 获取命令在命令表中的下标（按注册顺序，注册后不变）
+ *
+ * @param name 命令名
+ * @return 下标，不存在时返回-1
+ */
+int console_dispatch_index(const char *name);
+
+/**
+ * @brief 获取已注册的命令数
+ *
+ * @return 命令数
+ */
+int console_dispatch_get_count(void);
+
+/**
+ * @brief 按下标获取命令名
+ *
+ * @param index 下标
+ * @return 命令名，下标无效时返回NULL
+ */
+const char *console_dispatch_get_name(int index);
+
+/**
+ * @brief 原地分词：空白分隔，双引号括起的参数可含空白，`\` 转义下一个字符
+ *
+ * 分隔符和引号在缓冲区中被覆盖，argv 指向缓冲区内部。
+ *
+ * @param line 命令行，被修改
+ * @param argv 输出参数数组，至少 max_args + 1 项，末尾置NULL
+ * @param max_args 最多参数个数
+ * @param argc 输出参数个数
+ * @return
+ *     - ESP_OK: 成功
+ *     - ESP_ERR_INVALID_SIZE: 参数个数超过 max_args
+ */
+esp_err_t console_dispatch_tokenize(char *line, char **argv, int max_args, int *argc);
+
+/**
+ * @brief 执行已分词的命令
+ *
+ * @param argc 参数个数
+ * @param argv 参数，argv[0]为命令名
+ * @param ret 输出命令返回值
+ * @return
+ *     - ESP_OK: 命令已执行
+ *     - ESP_ERR_INVALID_ARG: 空命令
+ *     - ESP_ERR_NOT_FOUND: 命令不存在
+ */
+esp_err_t console_dispatch_run_argv(int argc, char **argv, int *ret);
+
+/**
+ * @brief 原地分词并执行一行命令
+ *
+ * @param line 命令行，被修改
+ * @param ret 输出命令返回值
+ * @return
+ *     - ESP_OK: 命令已执行
+ *     - ESP_ERR_INVALID_ARG: 空命令
+ *     - ESP_ERR_INVALID_SIZE: 参数过多
+ *     - ESP_ERR_NOT_FOUND: 命令不存在
+ */
+esp_err_t console_dispatch_run_line(char *line, int *ret);
+
+/**
+ * @brief 生成子命令表的完美哈希索引，在使用前（注册命令时）调用一次
+ *
+ * @param table 子命令表
+ * @return
+ *     - ESP_OK: 成功
+ *     - ESP_ERR_INVALID_ARG: 名字为空、重复或过多
+ *     - ESP_FAIL: 找不到完美哈希种子
+ */
+esp_err_t console_dispatch_subcmd_build(console_subcmd_table_t *table);
+
+/**
+ * @brief 查找子命令
+ *
+ * @param table 已生成索引的子命令表
+ * @param name 子命令名，可为NULL
+ * @return 子命令在表中的下标，不存在或表未生成索引时返回-1
+ */
+int console_dispatch_subcmd(const console_subcmd_table_t *table, const char *name);
+
+/**
+ * @brief 解析无符号整数参数（十进制，或0x开头的十六进制）
+ *
+ * @param arg 参数
+ * @param min 最小值
+ * @param max 最大值
+ * @param value 输出值
+ * @return
+ *     - ESP_OK: 成功
+ *     - ESP_ERR_INVALID_ARG: 不是数字
+ *     - ESP_ERR_INVALID_SIZE: 超出范围
+ */
+esp_err_t console_dispatch_arg_u32(const char *arg, uint32_t min, uint32_t max, uint32_t *value);
+
+/**
+ * @brief 解析有符号整数参数
+ *
+ * @param arg 参数
+ * @param min 最小值
+ * @param max 最大值
+ * @param value 输出值
+ * @return
+ *     - ESP_OK: 成功
+ *     - ESP_ERR_INVALID_ARG: 不是数字
+ *     - ESP_ERR_INVALID_SIZE: 超出范围
+ */
+esp_err_t console_dispatch_arg_i32(const char *arg, int32_t min, int32_t max, int32_t *value);
+
+/**
+ * @brief 解析开关参数：on/off、1/0、true/false
+ *
+ * @param arg 参数
+ * @param value 输出值
+ * @return
+ *     - ESP_OK: 成功
+ *     - ESP_ERR_INVALID_ARG: 无法识别
+ */
+esp_err_t console_dispatch_arg_bool(const char *arg, bool *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONSOLE_DISPATCH_H */
@@ -20,6 +20,7 @@ extern "C" {
 #define CONSOLE_BUF_SIZE 256
 #define CONSOLE_MAX_CMDLINE_ARGS 32
 #define CONSOLE_HISTORY_LEN 100
+#define CONSOLE_INPUT_AWAKE_MS 5000     ///< Light sleep is blocked for this long after console input (ms)
 
 /**
  * @brief Console interface configuration structure
@@ -43,6 +44,14 @@ typedef enum {
     CONSOLE_EVENT_SHUTDOWN         ///< Console is shutting down
 } console_event_t;
 
+/**
+ * @brief Output format of status/info commands
+ */
+typedef enum {
+    CONSOLE_OUTPUT_TEXT = 0,       ///< Human readable text (default)
+    CONSOLE_OUTPUT_JSON,           ///< One line of compact JSON per command
+} console_output_mode_t;
+
 /**
  * @brief Console event callback function type
  */
@@ -87,6 +96,9 @@ esp_err_t console_interface_stop(void);
 /**
  * @brief Register a console event callback
  * 
+ * The callback runs on the event bus dispatch task, not on the console task.
+ * Command strings longer than EVENT_BUS_DATA_SIZE - 1 bytes are truncated.
+ * 
  * @param callback Callback function to register
  * @return esp_err_t ESP_OK on success, error code otherwise
  */
@@ -161,6 +173,23 @@ bool console_interface_is_ready(void);
  */
 esp_err_t console_interface_get_stats(uint32_t *commands_executed, uint64_t *uptime_ms);
 
+/**
+ * @brief Set the global output format of status/info commands
+ *
+ * Individual commands also accept a --json flag regardless of this setting.
+ *
+ * @param mode Output format
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_ARG for an unknown mode
+ */
+esp_err_t console_interface_set_output_mode(console_output_mode_t mode);
+
+/**
+ * @brief Get the global output format of status/info commands
+ *
+ * @return Current output format
+ */
+console_output_mode_t console_interface_get_output_mode(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,196 @@
+/**
+ * @file console_jobs.h
+ * @brief 控制台后台任务：耗时命令交给工作任务池执行，交互shell保持可用
+ *
+ * 耗时命令（`test`、`orin reset|recovery`、`n305 toggle|reset`）在控制台任务中调用
+ * console_jobs_submit() 复制命令行后立即返回任务号，工作任务以同样的参数再次调用
+ * 命令处理函数，此时 console_jobs_in_worker() 为真，处理函数直接执行。
+ *
+ * 命令执行期间的输出由工作任务直接写出；开始与结束时打印一行
+ * `[job N] ...`。同一时间占用相同资源（如Orin电源时序）的任务按提交顺序串行执行。
+ * 控制台直接执行的外设命令通过 console_jobs_acquire() 占用同一组资源，后台任务
+ * 占用外设时等待其结束。
+ */
+
+#ifndef CONSOLE_JOBS_H
+#define CONSOLE_JOBS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONSOLE_JOBS_MAX                8       /*!< 任务表大小（含已结束的任务） */
+#define CONSOLE_JOBS_WORKERS            2       /*!< 工作任务数 */
+#define CONSOLE_JOBS_WORKER_STACK       4096    /*!< 工作任务栈大小 (bytes) */
+#define CONSOLE_JOBS_WORKER_PRIORITY    4       /*!< 工作任务优先级，低于控制台任务 */
+#define CONSOLE_JOBS_CMD_LEN            64      /*!< 保存的命令行长度 */
+#define CONSOLE_JOBS_MAX_ARGS           8       /*!< 命令参数个数上限 */
+#define CONSOLE_JOBS_ACQUIRE_TIMEOUT_MS 30000   /*!< 控制台直接执行的命令等待资源的最长时间 (ms) */
+
+/**
+ * @brief 任务占用的资源，占用相同资源的任务不会同时运行
+ */
+typedef enum {
+    CONSOLE_JOB_RES_ORIN = 1 << 0,          /*!< Orin电源/恢复引脚 */
+    CONSOLE_JOB_RES_N305 = 1 << 1,          /*!< N305电源/复位引脚 */
+    CONSOLE_JOB_RES_PERIPH = 1 << 2,        /*!< 风扇、LED、GPIO */
+    CONSOLE_JOB_RES_BENCH = 1 << 3,         /*!< 基准测试与NVS对比测试 */
+    CONSOLE_JOB_RES_ALL = 0x0F,             /*!< 全部资源 */
+} console_job_resource_t;
+
+/**
+ * @brief 任务状态
+ */
+typedef enum {
+    CONSOLE_JOB_QUEUED = 0,         /*!< 等待工作任务 */
+    CONSOLE_JOB_RUNNING,            /*!< 正在执行 */
+    CONSOLE_JOB_DONE,               /*!< 执行成功 */
+    CONSOLE_JOB_FAILED,             /*!< 命令返回非0 */
+    CONSOLE_JOB_CANCELLED,          /*!< 已取消 */
+} console_job_state_t;
+
+/**
+ * @brief 命令处理函数，与 esp_console_cmd_func_t 相同
+ */
+typedef int (*console_job_func_t)(int argc, char **argv);
+
+/**
+ * @brief 取消正在运行的任务，在调用 cancel 的任务中执行，只请求中止不等待
+ */
+typedef esp_err_t (*console_job_cancel_t)(void);
+
+/**
+ * @brief 任务信息
+ */
+typedef struct {
+    uint32_t id;                    /*!< 任务号，从1开始递增 */
+    console_job_state_t state;      /*!< 状态 */
+    char command[CONSOLE_JOBS_CMD_LEN]; /*!< 命令行 */
+    int result;                     /*!< 命令返回值，结束后有效 */
+    bool cancel_requested;          /*!< 运行中已请求取消 */
+    uint32_t queued_ms;             /*!< 排队时间 (ms) */
+    uint32_t run_ms;                /*!< 运行时间 (ms)，运行中为已运行时间 */
+} console_job_info_t;
+
+/**
+ * @brief 初始化任务表并创建工作任务
+ *
+ * @return
+ *     - ESP_OK: 初始化成功
+ *     - ESP_ERR_NO_MEM: 创建工作任务或同步对象失败
+ */
+esp_err_t console_jobs_init(void);
+
+/**
+ * @brief 当前任务是否为工作任务（命令处理函数据此决定直接执行还是提交）
+ *
+ * @return 是否在工作任务中
+ */
+bool console_jobs_in_worker(void);
+
+/**
+ * @brief 提交后台任务
+ *
+ * 任务表满时回收最早结束的任务；全部未结束时返回 ESP_ERR_NO_MEM。
+ *
+ * @param func 命令处理函数，在工作任务中以复制的参数调用
+ * @param argc 参数个数
+ * @param argv 参数
+ * @param resources 占用的资源 (console_job_resource_t 的组合)
+ * @param cancel 运行中取消的方法，NULL表示运行后不可取消
+ * @param id 输出任务号，可为NULL
+ * @return
+ *     - ESP_OK: 已提交
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_SIZE: 命令行过长或参数过多
+ *     - ESP_ERR_NO_MEM: 任务表已满
+ *     - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t console_jobs_submit(console_job_func_t func, int argc, char **argv, uint32_t resources,
+                              console_job_cancel_t cancel, uint32_t *id);
+
+/**
+ * @brief 在当前任务中占用资源，直到 console_jobs_release()
+ *
+ * 控制台直接执行的外设命令（如 `fan`、`bled`）在运行前调用，资源被后台任务占用时
+ * 等待其结束；占用期间需要相同资源的后台任务不会开始运行。在工作任务中调用时
+ * 直接返回（任务已占用提交时声明的资源）。
+ *
+ * @param resources 资源 (console_job_resource_t 的组合)，0时直接返回
+ * @param timeout_ms 最长等待时间 (ms)，0表示不等待
+ * @return
+ *     - ESP_OK: 已占用（或无需占用）
+ *     - ESP_ERR_TIMEOUT: 资源仍被占用
+ */
+esp_err_t console_jobs_acquire(uint32_t resources, uint32_t timeout_ms);
+
+/**
+ * @brief 释放 console_jobs_acquire() 占用的资源，唤醒等待这些资源的任务
+ *
+ * @param resources 资源，与占用时相同
+ */
+void console_jobs_release(uint32_t resources);
+
+/**
+ * @brief 取消任务：排队中的直接取消，运行中的调用其取消方法
+ *
+ * @param id 任务号
+ * @return
+ *     - ESP_OK: 已取消或已请求取消
+ *     - ESP_ERR_NOT_FOUND: 任务不存在
+ *     - ESP_ERR_INVALID_STATE: 任务已结束
+ *     - ESP_ERR_NOT_SUPPORTED: 任务正在运行且不可中断（如电源时序）
+ */
+esp_err_t console_jobs_cancel(uint32_t id);
+
+/**
+ * @brief 等待任务结束
+ *
+ * @param id 任务号
+ * @param timeout_ms 超时 (ms)，0表示一直等待
+ * @param info 输出结束时的任务信息，可为NULL
+ * @return
+ *     - ESP_OK: 任务已结束
+ *     - ESP_ERR_NOT_FOUND: 任务不存在
+ *     - ESP_ERR_TIMEOUT: 超时
+ *     - ESP_ERR_INVALID_STATE: 在工作任务中等待（可能死锁）
+ */
+esp_err_t console_jobs_wait(uint32_t id, uint32_t timeout_ms, console_job_info_t *info);
+
+/**
+ * @brief 获取任务信息
+ *
+ * @param id 任务号
+ * @param info 存储信息的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NOT_FOUND: 任务不存在
+ */
+esp_err_t console_jobs_get(uint32_t id, console_job_info_t *info);
+
+/**
+ * @brief 获取状态名称
+ *
+ * @param state 状态
+ * @return 名称字符串
+ */
+const char *console_jobs_state_name(console_job_state_t state);
+
+/**
+ * @brief 打印任务列表
+ *
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t console_jobs_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONSOLE_JOBS_H */
@@ -0,0 +1,187 @@
+/**
+ * @file console_json.h
+ * @brief 控制台JSON输出：流式写入器与状态结构序列化
+ *
+ * 写入器把JSON逐段写入调用者提供的固定缓冲区，缓冲区满时交给输出函数
+ * （默认写stdout）后继续，不分配堆内存，输出长度不受缓冲区大小限制。
+ * 输出为单行紧凑JSON，键名与结构体字段名一致，便于主机端脚本逐行解析。
+ *
+ * 用法:
+ * @code
+ * char buf[CONSOLE_JSON_BUF_SIZE];
+ * console_json_t json;
+ * console_json_init_stdout(&json, buf, sizeof(buf));
+ * console_json_begin_object(&json, NULL);
+ * console_json_string(&json, "cmd", "status");
+ * console_json_device_status(&json, "device", &status);
+ * console_json_end_object(&json);
+ * console_json_finish(&json);
+ * @endcode
+ */
+
+#ifndef CONSOLE_JSON_H
+#define CONSOLE_JSON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "device_interface.h"
+#include "system_monitor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONSOLE_JSON_BUF_SIZE   128     /*!< 建议的写入缓冲区大小 (bytes) */
+#define CONSOLE_JSON_MAX_DEPTH  16      /*!< 最大嵌套层数 */
+
+/**
+ * @brief 输出函数类型，缓冲区满或结束时调用
+ *
+ * @param data 数据
+ * @param len 长度
+ * @param ctx 用户上下文
+ */
+typedef void (*console_json_flush_t)(const char *data, size_t len, void *ctx);
+
+/**
+ * @brief 流式JSON写入器，字段只应通过 console_json_* 接口访问
+ */
+typedef struct {
+    char *buf;                      /*!< 写入缓冲区 */
+    size_t size;                    /*!< 缓冲区大小 */
+    size_t len;                     /*!< 缓冲区中未输出的字节数 */
+    console_json_flush_t flush;     /*!< 输出函数 */
+    void *ctx;                      /*!< 输出函数上下文 */
+    uint32_t has_items;             /*!< 每层一位：该层已有元素，下一个元素前需要逗号 */
+    uint8_t depth;                  /*!< 当前嵌套层数 */
+    bool error;                     /*!< 嵌套超限或括号不匹配 */
+} console_json_t;
+
+// ==================== 写入器 ====================
+
+/**
+ * @brief 初始化写入器
+ *
+ * @param json 写入器
+ * @param buf 写入缓冲区，至少1字节
+ * @param size 缓冲区大小
+ * @param flush 输出函数
+ * @param ctx 输出函数上下文
+ */
+void console_json_init(console_json_t *json, char *buf, size_t size, console_json_flush_t flush, void *ctx);
+
+/**
+ * @brief 初始化输出到stdout的写入器
+ *
+ * @param json 写入器
+ * @param buf 写入缓冲区
+ * @param size 缓冲区大小
+ */
+void console_json_init_stdout(console_json_t *json, char *buf, size_t size);
+
+/**
+ * @brief 开始对象
+ *
+ * @param json 写入器
+ * @param key 键名，位于数组中或作为顶层值时为NULL
+ */
+void console_json_begin_object(console_json_t *json, const char *key);
+
+/**
+ * @brief 结束对象
+ *
+ * @param json 写入器
+ */
+void console_json_end_object(console_json_t *json);
+
+/**
+ * @brief 开始数组
+ *
+ * @param json 写入器
+ * @param key 键名，位于数组中时为NULL
+ */
+void console_json_begin_array(console_json_t *json, const char *key);
+
+/**
+ * @brief 结束数组
+ *
+ * @param json 写入器
+ */
+void console_json_end_array(console_json_t *json);
+
+/**
+ * @brief 写入字符串值，按JSON规则转义，NULL写为null
+ */
+void console_json_string(console_json_t *json, const char *key, const char *value);
+
+/**
+ * @brief 写入无符号整数值
+ */
+void console_json_uint(console_json_t *json, const char *key, uint64_t value);
+
+/**
+ * @brief 写入有符号整数值
+ */
+void console_json_int(console_json_t *json, const char *key, int64_t value);
+
+/**
+ * @brief 写入布尔值
+ */
+void console_json_bool(console_json_t *json, const char *key, bool value);
+
+/**
+ * @brief 写入null
+ */
+void console_json_null(console_json_t *json, const char *key);
+
+/**
+ * @brief 结束输出：写入换行并输出缓冲区剩余内容
+ *
+ * @param json 写入器
+ * @return
+ *     - ESP_OK: 输出完整
+ *     - ESP_ERR_INVALID_STATE: 嵌套超限或对象/数组未闭合，输出不是合法JSON
+ */
+esp_err_t console_json_finish(console_json_t *json);
+
+// ==================== 状态结构序列化 ====================
+
+/**
+ * @brief 写入硬件状态对象
+ */
+void console_json_hardware_status(console_json_t *json, const char *key, const hardware_status_t *status);
+
+/**
+ * @brief 写入系统信息对象
+ */
+void console_json_system_info(console_json_t *json, const char *key, const system_info_t *info);
+
+/**
+ * @brief 写入设备完整状态对象，不可用的部分写为null
+ */
+void console_json_device_status(console_json_t *json, const char *key, const device_status_t *status);
+
+/**
+ * @brief 写入内存快照对象（各区域统计）
+ */
+void console_json_memory_snapshot(console_json_t *json, const char *key, const system_memory_snapshot_t *snapshot);
+
+/**
+ * @brief 写入系统监控统计对象（监控/警告次数、告警阈值与事件驱动告警统计）
+ */
+void console_json_monitor_stats(console_json_t *json, const char *key);
+
+/**
+ * @brief 写入命令执行统计对象（执行过的命令的计数、耗时与直方图，以及慢命令日志）
+ *
+ * hist 第0项为 <2^bucket_shift us，第i项覆盖 [2^(i+bucket_shift-1), 2^(i+bucket_shift)) us，最后一项不设上限。
+ */
+void console_json_cmdstats(console_json_t *json, const char *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONSOLE_JSON_H */
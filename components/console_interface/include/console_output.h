@@ -0,0 +1,146 @@
+/**
+ * @file console_output.h
+ * @brief 控制台输出缓冲：按命令合并输出，整块写入UART驱动的发送环形缓冲区
+ *
+ * 控制台任务的stdout替换为本模块的流。命令执行期间 printf 的内容先写入行缓冲区
+ * （芯片目标在写入时把LF转换为CRLF），缓冲区满、命令结束或等待超过
+ * CONSOLE_OUTPUT_FLUSH_INTERVAL_MS 时一次性交给UART驱动，由TX中断从环形缓冲区
+ * 搬运到FIFO，不再逐字符经过VFS。命令之外（提示符、其他任务的日志）直写。
+ *
+ * 交互输入的回显走 console_output_echo() 快速路径，直接写入驱动，不经过stdio。
+ */
+
+#ifndef CONSOLE_OUTPUT_H
+#define CONSOLE_OUTPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONSOLE_OUTPUT_BUF_SIZE             1024    /*!< 命令输出行缓冲区大小 (bytes) */
+#define CONSOLE_OUTPUT_TX_RING_SIZE         2048    /*!< UART驱动发送环形缓冲区大小 (bytes) */
+#define CONSOLE_OUTPUT_FLUSH_INTERVAL_MS    50      /*!< 命令执行期间缓冲内容的最长停留时间 (ms) */
+#define CONSOLE_OUTPUT_DRAIN_TIMEOUT_MS     2000    /*!< 命令结束后等待发送完成的最长时间 (ms) */
+#define CONSOLE_OUTPUT_NAME_LEN             16      /*!< 统计中记录的命令名长度 */
+
+/**
+ * @brief 单条命令的输出统计
+ */
+typedef struct {
+    char command[CONSOLE_OUTPUT_NAME_LEN];  /*!< 命令名 */
+    uint32_t bytes;                 /*!< 输出字节数（换行转换前） */
+    uint32_t stdio_writes;          /*!< stdio写入次数（约等于printf次数） */
+    uint32_t uart_writes;           /*!< 写入UART驱动的次数 */
+    uint32_t exec_us;               /*!< 命令执行耗时 (us)，不含等待发送完成 */
+    uint32_t write_us;              /*!< 其中写入UART驱动的耗时 (us) */
+    uint32_t drain_us;              /*!< 命令结束后等待发送完成的耗时 (us) */
+} console_output_command_stats_t;
+
+/**
+ * @brief 输出统计
+ */
+typedef struct {
+    bool buffered;                  /*!< 命令输出是否缓冲 */
+    bool uart_driver;               /*!< 是否直接写入UART驱动（否则经原stdout） */
+    uint32_t commands;              /*!< 统计的命令数 */
+    uint64_t bytes;                 /*!< 经stdio输出的总字节数 */
+    uint32_t stdio_writes;          /*!< stdio写入次数 */
+    uint32_t uart_writes;           /*!< 写入UART驱动的次数 */
+    uint32_t full_flushes;          /*!< 缓冲区满触发的写入次数 */
+    uint32_t timer_flushes;         /*!< 超时触发的写入次数 */
+    uint64_t write_us;              /*!< 写入UART驱动的累计耗时 (us) */
+    uint32_t echo_bytes;            /*!< 回显快速路径字节数 */
+    console_output_command_stats_t last;    /*!< 最近一条命令 */
+} console_output_stats_t;
+
+/**
+ * @brief 初始化输出模块
+ *
+ * @param uart_driver 控制台UART驱动是否已安装（带发送环形缓冲区）；
+ *                    否则输出经原stdout写出
+ * @return
+ *     - ESP_OK: 初始化成功
+ *     - ESP_ERR_NO_MEM: 创建流、互斥锁或定时器失败
+ */
+esp_err_t console_output_init(bool uart_driver);
+
+/**
+ * @brief 把当前任务的stdout切换到缓冲输出流，在控制台任务开始时调用
+ *
+ * 芯片目标的stdout按任务区分，只影响控制台任务；Linux目标为全局。
+ */
+void console_output_attach(void);
+
+/**
+ * @brief 开始一条命令：之后的输出进入缓冲区
+ *
+ * @param command 命令行，统计中记录第一个单词
+ */
+void console_output_begin_command(const char *command);
+
+/**
+ * @brief 结束一条命令：写出剩余内容并等待发送完成
+ */
+void console_output_end_command(void);
+
+/**
+ * @brief 立即写出缓冲区中的内容
+ */
+void console_output_flush(void);
+
+/**
+ * @brief 回显快速路径：先写出缓冲内容，再直接写入驱动
+ *
+ * @param data 数据，不做换行转换
+ * @param len 长度
+ */
+void console_output_echo(const char *data, size_t len);
+
+/**
+ * @brief 不经stdio写入原始字节（二进制RPC响应），不做换行转换
+ *
+ * @param data 数据
+ * @param len 长度
+ */
+void console_output_write_raw(const void *data, size_t len);
+
+/**
+ * @brief 启用/禁用命令输出缓冲，禁用时每次stdio写入立即写出（用于对比）
+ *
+ * @param enable 是否启用
+ */
+void console_output_set_buffered(bool enable);
+
+/**
+ * @brief 获取输出统计
+ *
+ * @param stats 存储统计的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t console_output_get_stats(console_output_stats_t *stats);
+
+/**
+ * @brief 清零输出统计
+ */
+void console_output_reset_stats(void);
+
+/**
+ * @brief 打印输出统计
+ *
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t console_output_print_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONSOLE_OUTPUT_H */
@@ -0,0 +1,81 @@
+/**
+ * @file console_rpc.h
+ * @brief 控制台二进制RPC：与文本shell复用控制台串口的机器控制接口
+ *
+ * 编排脚本通过带CRC和序号的二进制帧直接调用 device_interface.h 与
+ * hardware_control.h 的公开接口，不再解析面向人的文本输出。帧格式与消息号见
+ * console_rpc_proto.h，主机端库见 tools/bmc_rpc.py 和 tools/bmc_rpc_host.c。
+ *
+ * 控制台任务收到0x00时开始收集帧，再次收到0x00时调用 console_rpc_process()
+ * 解码、分发并把响应写回串口；处理函数按消息号查表，在控制台任务上下文中执行，
+ * 执行期间按表中声明占用 console_jobs 的资源，资源忙时返回 CONSOLE_RPC_STATUS_BUSY。
+ * 全部自检、压力测试和Orin恢复模式提交给控制台后台任务执行，不阻塞控制台任务。
+ * 打印类接口（*_print_*）、初始化和回调注册不经RPC提供。
+ */
+
+#ifndef CONSOLE_RPC_H
+#define CONSOLE_RPC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "console_rpc_proto.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONSOLE_RPC_WIRE_BUF_SIZE   (CONSOLE_RPC_MAX_ENCODED + 2)   /*!< 一帧编码后加两个分隔符的长度 */
+
+/**
+ * @brief 处理一个收到的帧并生成响应
+ *
+ * @param encoded COBS编码的帧，不含分隔符
+ * @param len 编码长度
+ * @param out 响应输出缓冲区，至少 CONSOLE_RPC_WIRE_BUF_SIZE 字节
+ * @param out_size 输出缓冲区大小
+ * @return 需要写回串口的字节数（含前后分隔符），帧无效时返回0（不响应）
+ */
+size_t console_rpc_process(const uint8_t *encoded, size_t len, uint8_t *out, size_t out_size);
+
+/**
+ * @brief 记录一次帧接收错误（帧超长等在解码前发现的错误）
+ */
+void console_rpc_note_framing_error(void);
+
+/**
+ * @brief 获取RPC统计
+ *
+ * @param stats 存储统计的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t console_rpc_get_stats(console_rpc_stats_t *stats);
+
+/**
+ * @brief 清零RPC统计
+ */
+void console_rpc_reset_stats(void);
+
+/**
+ * @brief 打印RPC统计
+ *
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t console_rpc_print_stats(void);
+
+/**
+ * @brief 获取消息名称
+ *
+ * @param msg 消息号
+ * @return 名称字符串，未知消息返回 "unknown"
+ */
+const char *console_rpc_msg_name(uint8_t msg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONSOLE_RPC_H */
@@ -0,0 +1,464 @@
+/**
+ * @file console_rpc_proto.h
+ * @brief 控制台二进制RPC协议：帧格式、消息号与负载定义
+ *
+ * 本文件只依赖C标准头文件，固件和主机端库 (tools/bmc_rpc_host.c) 共用。
+ *
+ * 帧格式（COBS编码前，多字节字段均为小端）：
+ *   请求: seq(1) | msg(1)        | 负载 | crc16(2)
+ *   响应: seq(1) | msg|0x80(1)   | status(int32, esp_err_t) | 负载 | crc16(2)
+ * crc16为CRC-16/CCITT-FALSE（多项式0x1021，初值0xFFFF），覆盖crc之前的所有字节。
+ * 线上每帧COBS编码后前后各加一个0x00分隔符。文本命令和控制台输出不含0x00，
+ * 因此二进制帧与文本shell复用同一个控制台串口：0x00之间的字节是帧，其余是文本。
+ *
+ * 响应原样返回请求的seq。主机超时重发同一请求（seq、消息号和CRC都相同）时，
+ * 固件直接重发缓存的上一帧响应，不会重复执行；处理函数执行期间收到的重发留在
+ * 串口缓冲区中，执行完成后同样命中缓存。电源时序、自检、渐变等消息的执行时间
+ * 远超普通消息，主机应按 console_rpc_timeout_ms() 为每条消息设置超时，
+ * 否则重试用尽后放弃，调用者再以新seq重发就会重复执行。
+ *
+ * 操作外设或电源时序的消息执行期间占用与控制台后台任务相同的资源（见 console_jobs.h），
+ * 资源正被后台任务占用时不等待，立即返回 CONSOLE_RPC_STATUS_BUSY，主机稍后以新seq重试。
+ * 全部自检 (HW_TEST ALL)、压力测试 (DEV_RUN_TEST STRESS) 和Orin恢复模式提交为后台任务，
+ * 响应只带任务号 (console_rpc_job_ref_t)，结果用 CONSOLE_RPC_MSG_JOB_GET 查询。
+ *
+ * 固件空闲时可能处于浅睡眠，由UART RX边沿唤醒，触发唤醒的字节丢失。主机在
+ * 链路空闲超过 CONSOLE_RPC_WAKE_IDLE_MS 后，先发送 CONSOLE_RPC_WAKE_PREAMBLE_LEN
+ * 个0x00并等待 CONSOLE_RPC_WAKE_DELAY_MS 再发送请求；连续的0x00只是帧起始分隔符，
+ * 固件未睡眠时也不受影响。固件收到输入后保持唤醒的时间长于 CONSOLE_RPC_WAKE_IDLE_MS。
+ */
+
+#ifndef CONSOLE_RPC_PROTO_H
+#define CONSOLE_RPC_PROTO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== 协议参数 ====================
+
+#define CONSOLE_RPC_PROTO_VERSION   2       /*!< 协议版本 */
+#define CONSOLE_RPC_MAX_PAYLOAD     128     /*!< 负载最大长度 (bytes) */
+#define CONSOLE_RPC_REQ_HEADER_LEN  2       /*!< 请求头长度: seq + msg */
+#define CONSOLE_RPC_RESP_HEADER_LEN 6       /*!< 响应头长度: seq + msg + status */
+#define CONSOLE_RPC_CRC_LEN         2       /*!< CRC长度 */
+#define CONSOLE_RPC_MAX_FRAME       (CONSOLE_RPC_RESP_HEADER_LEN + CONSOLE_RPC_MAX_PAYLOAD + CONSOLE_RPC_CRC_LEN)
+#define CONSOLE_RPC_MAX_ENCODED     (CONSOLE_RPC_MAX_FRAME + CONSOLE_RPC_MAX_FRAME / 254 + 1)
+#define CONSOLE_RPC_DELIMITER       0x00    /*!< 帧分隔符 */
+#define CONSOLE_RPC_RESPONSE_FLAG   0x80    /*!< 响应消息号标志 */
+#define CONSOLE_RPC_NAME_LEN        16      /*!< 档案名字段长度，含结尾'\0' */
+#define CONSOLE_RPC_TIMEOUT_MS      1000    /*!< 普通消息的响应超时 (ms) */
+#define CONSOLE_RPC_SLOW_TIMEOUT_MS 10000   /*!< 电源时序、NVS写入等消息的响应超时 (ms) */
+#define CONSOLE_RPC_TEST_TIMEOUT_MS 60000   /*!< 硬件自检、配置基准测试的响应超时 (ms) */
+#define CONSOLE_RPC_STATUS_BUSY     0x107   /*!< 资源被后台任务占用 (ESP_ERR_TIMEOUT)，稍后重试 */
+#define CONSOLE_RPC_WAKE_IDLE_MS    1000    /*!< 链路空闲超过此时间后发送唤醒前导 (ms) */
+#define CONSOLE_RPC_WAKE_PREAMBLE_LEN 4     /*!< 唤醒前导的0x00个数，每个产生两个RX边沿 */
+#define CONSOLE_RPC_WAKE_DELAY_MS   5       /*!< 唤醒前导之后等待固件退出浅睡眠的时间 (ms) */
+
+// ==================== 消息号 ====================
+
+/**
+ * @brief 消息号，注释中为请求负载 -> 响应负载
+ */
+typedef enum {
+    // 协议 0x00
+    CONSOLE_RPC_MSG_PING = 0x00,                /*!< 任意字节 -> 原样返回 */
+    CONSOLE_RPC_MSG_GET_VERSION = 0x01,         /*!< - -> console_rpc_version_t */
+    CONSOLE_RPC_MSG_GET_RPC_STATS = 0x02,       /*!< - -> console_rpc_stats_t */
+    CONSOLE_RPC_MSG_BAUD_SET = 0x03,            /*!< console_rpc_baud_set_t -> -，响应以原波特率发出后切换 */
+    CONSOLE_RPC_MSG_BAUD_GET = 0x04,            /*!< - -> console_rpc_baud_status_t，确认期内收到即确认 */
+    CONSOLE_RPC_MSG_JOB_GET = 0x05,             /*!< u32 任务号 -> console_rpc_job_t */
+
+    // 风扇与LED 0x10
+    CONSOLE_RPC_MSG_FAN_SET_SPEED = 0x10,       /*!< u8 速度 -> - */
+    CONSOLE_RPC_MSG_FAN_GET_SPEED = 0x11,       /*!< - -> u8 速度 */
+    CONSOLE_RPC_MSG_FAN_START = 0x12,           /*!< - -> - */
+    CONSOLE_RPC_MSG_FAN_STOP = 0x13,            /*!< - -> - */
+    CONSOLE_RPC_MSG_BOARD_LED_SET_COLOR = 0x14, /*!< console_rpc_color_t -> - */
+    CONSOLE_RPC_MSG_BOARD_LED_SET_BRIGHTNESS = 0x15, /*!< u8 亮度 -> - */
+    CONSOLE_RPC_MSG_BOARD_LED_SET_EFFECT = 0x16, /*!< u8 效果 -> - */
+    CONSOLE_RPC_MSG_BOARD_LED_OFF = 0x17,       /*!< - -> - */
+    CONSOLE_RPC_MSG_BOARD_LED_GET_BRIGHTNESS = 0x18, /*!< - -> u8 亮度 */
+    CONSOLE_RPC_MSG_TOUCH_LED_SET_COLOR = 0x19, /*!< console_rpc_color_t -> - */
+    CONSOLE_RPC_MSG_TOUCH_LED_SET_BRIGHTNESS = 0x1A, /*!< u8 亮度 -> - */
+    CONSOLE_RPC_MSG_TOUCH_LED_OFF = 0x1B,       /*!< - -> - */
+    CONSOLE_RPC_MSG_TOUCH_LED_GET_BRIGHTNESS = 0x1C, /*!< - -> u8 亮度 */
+    CONSOLE_RPC_MSG_BOARD_LED_GET_COLOR = 0x1D, /*!< - -> console_rpc_color_t */
+    CONSOLE_RPC_MSG_TOUCH_LED_GET_COLOR = 0x1E, /*!< - -> console_rpc_color_t */
+
+    // GPIO与USB MUX 0x20
+    CONSOLE_RPC_MSG_GPIO_SET_OUTPUT = 0x20,     /*!< console_rpc_gpio_t -> - */
+    CONSOLE_RPC_MSG_GPIO_READ_INPUT = 0x21,     /*!< u8 引脚 -> u8 电平 */
+    CONSOLE_RPC_MSG_GPIO_READ_INPUT_MODE = 0x22, /*!< u8 引脚 -> u8 电平 */
+    CONSOLE_RPC_MSG_GPIO_TOGGLE = 0x23,         /*!< u8 引脚 -> - */
+    CONSOLE_RPC_MSG_USB_MUX_SET = 0x24,         /*!< u8 目标 -> - */
+    CONSOLE_RPC_MSG_USB_MUX_GET = 0x25,         /*!< - -> u8 目标 */
+
+    // 电源控制 0x30
+    CONSOLE_RPC_MSG_ORIN_POWER_ON = 0x30,       /*!< - -> - */
+    CONSOLE_RPC_MSG_ORIN_POWER_OFF = 0x31,      /*!< - -> - */
+    CONSOLE_RPC_MSG_ORIN_RESET = 0x32,          /*!< - -> - */
+    CONSOLE_RPC_MSG_ORIN_RECOVERY = 0x33,       /*!< - -> console_rpc_job_ref_t (后台任务) */
+    CONSOLE_RPC_MSG_N305_POWER_TOGGLE = 0x34,   /*!< - -> - */
+    CONSOLE_RPC_MSG_N305_RESET = 0x35,          /*!< - -> - */
+    CONSOLE_RPC_MSG_ORIN_GET_POWER_STATE = 0x36, /*!< - -> u8 电源状态 */
+    CONSOLE_RPC_MSG_N305_GET_POWER_STATE = 0x37, /*!< - -> u8 电源状态 */
+
+    // 硬件状态、设置、事务与自检 0x40
+    CONSOLE_RPC_MSG_HW_TEST = 0x40,             /*!< console_rpc_hw_test_t -> -，ALL 为后台任务，返回 console_rpc_job_ref_t */
+    CONSOLE_RPC_MSG_HW_GET_STATUS = 0x41,       /*!< - -> console_rpc_hw_status_t */
+    CONSOLE_RPC_MSG_HW_GET_SETTINGS = 0x42,     /*!< - -> console_rpc_settings_t */
+    CONSOLE_RPC_MSG_HW_APPLY_SETTINGS = 0x43,   /*!< console_rpc_settings_t -> - */
+    CONSOLE_RPC_MSG_HW_TXN_COMMIT = 0x44,       /*!< console_rpc_hw_txn_t -> - */
+
+    // 设备接口 0x50
+    CONSOLE_RPC_MSG_DEV_QUICK_SETUP = 0x50,     /*!< console_rpc_quick_setup_t -> - */
+    CONSOLE_RPC_MSG_DEV_SHUTDOWN_ALL = 0x51,    /*!< - -> - */
+    CONSOLE_RPC_MSG_DEV_RESET_DEFAULT = 0x52,   /*!< - -> - */
+    CONSOLE_RPC_MSG_DEV_SLEEP = 0x53,           /*!< - -> - */
+    CONSOLE_RPC_MSG_DEV_WAKE = 0x54,            /*!< - -> - */
+    CONSOLE_RPC_MSG_DEV_GET_STATUS = 0x55,      /*!< - -> console_rpc_dev_status_t */
+    CONSOLE_RPC_MSG_DEV_RUN_TEST = 0x56,        /*!< console_rpc_dev_test_t -> -，STRESS 为后台任务，返回 console_rpc_job_ref_t */
+    CONSOLE_RPC_MSG_DEV_SAVE_CONFIG = 0x57,     /*!< - -> - */
+    CONSOLE_RPC_MSG_DEV_LOAD_CONFIG = 0x58,     /*!< - -> - */
+    CONSOLE_RPC_MSG_DEV_CLEAR_CONFIG = 0x59,    /*!< - -> - */
+    CONSOLE_RPC_MSG_DEV_CONFIG_BENCHMARK = 0x5A, /*!< u32 次数 -> - */
+
+    // 配置档案 0x60
+    CONSOLE_RPC_MSG_PROFILE_SAVE = 0x60,        /*!< char[16] 名称 -> - */
+    CONSOLE_RPC_MSG_PROFILE_DELETE = 0x61,      /*!< char[16] 名称 -> - */
+    CONSOLE_RPC_MSG_PROFILE_APPLY = 0x62,       /*!< console_rpc_profile_apply_t -> console_rpc_profile_result_t */
+    CONSOLE_RPC_MSG_PROFILE_GET_COUNT = 0x63,   /*!< - -> u32 档案数 */
+    CONSOLE_RPC_MSG_PROFILE_GET = 0x64,         /*!< u32 序号 -> console_rpc_profile_t */
+
+    // 自动保存 0x70
+    CONSOLE_RPC_MSG_AUTOSAVE_ENABLE = 0x70,     /*!< u8 启用 -> - */
+    CONSOLE_RPC_MSG_AUTOSAVE_SET_QUIET = 0x71,  /*!< u32 静默期 (ms) -> - */
+    CONSOLE_RPC_MSG_AUTOSAVE_FLUSH = 0x72,      /*!< - -> - */
+    CONSOLE_RPC_MSG_AUTOSAVE_GET_STATS = 0x73,  /*!< - -> console_rpc_autosave_stats_t */
+
+    CONSOLE_RPC_MSG_MAX = 0x80
+} console_rpc_msg_t;
+
+/**
+ * @brief CONSOLE_RPC_MSG_HW_TEST 的测试项
+ */
+typedef enum {
+    CONSOLE_RPC_HW_TEST_FAN = 0,            /*!< hardware_test_fan */
+    CONSOLE_RPC_HW_TEST_BOARD_LED,          /*!< hardware_test_board_led */
+    CONSOLE_RPC_HW_TEST_TOUCH_LED,          /*!< hardware_test_touch_led */
+    CONSOLE_RPC_HW_TEST_GPIO,               /*!< hardware_test_gpio(pin) */
+    CONSOLE_RPC_HW_TEST_GPIO_INPUT,         /*!< hardware_test_gpio_input(pin) */
+    CONSOLE_RPC_HW_TEST_ALL,                /*!< hardware_test_all */
+    CONSOLE_RPC_HW_TEST_ORIN_POWER,         /*!< hardware_test_orin_power */
+    CONSOLE_RPC_HW_TEST_N305_POWER,         /*!< hardware_test_n305_power */
+    CONSOLE_RPC_HW_TEST_ORIN_RECOVERY_GPIO, /*!< hardware_test_orin_recovery_gpio */
+} console_rpc_hw_test_id_t;
+
+/**
+ * @brief CONSOLE_RPC_MSG_DEV_RUN_TEST 的测试项
+ */
+typedef enum {
+    CONSOLE_RPC_DEV_TEST_FULL = 0,          /*!< device_run_full_test */
+    CONSOLE_RPC_DEV_TEST_QUICK,             /*!< device_run_quick_test */
+    CONSOLE_RPC_DEV_TEST_STRESS,            /*!< device_run_stress_test(duration_ms) */
+} console_rpc_dev_test_id_t;
+
+// ==================== 负载 ====================
+
+#pragma pack(push, 1)
+
+typedef struct {
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+} console_rpc_color_t;
+
+typedef struct {
+    uint16_t proto_version;         /*!< CONSOLE_RPC_PROTO_VERSION */
+    uint16_t max_payload;           /*!< CONSOLE_RPC_MAX_PAYLOAD */
+    uint32_t interface_version;     /*!< device_get_interface_version() */
+    char version[32];               /*!< device_get_version_string() */
+} console_rpc_version_t;
+
+typedef struct {
+    uint32_t frames_rx;             /*!< 收到的有效请求帧 */
+    uint32_t frames_tx;             /*!< 发送的响应帧 */
+    uint32_t retransmits;           /*!< 重复请求时重发缓存响应的次数 */
+    uint32_t crc_errors;            /*!< CRC错误帧 */
+    uint32_t framing_errors;        /*!< COBS解码失败或超长的帧 */
+    uint32_t unknown_msgs;          /*!< 未知消息号 */
+    uint32_t bad_length;            /*!< 负载长度错误 */
+    uint32_t dispatch_last_us;      /*!< 最近一次解码到响应编码完成的耗时 (us) */
+    uint32_t dispatch_max_us;       /*!< 最长耗时 (us)，含处理函数本身 */
+    uint32_t busy;                  /*!< 资源被占用而返回 CONSOLE_RPC_STATUS_BUSY 的请求 */
+    uint32_t jobs;                  /*!< 提交为后台任务的请求 */
+} console_rpc_stats_t;
+
+typedef struct {
+    uint32_t job_id;                /*!< 后台任务号 */
+} console_rpc_job_ref_t;
+
+typedef struct {
+    uint32_t id;                    /*!< 任务号 */
+    uint8_t state;                  /*!< 0排队 1运行 2成功 3失败 4取消 (console_job_state_t) */
+    int32_t result;                 /*!< 处理函数返回的 esp_err_t，结束后有效 */
+    uint32_t queued_ms;             /*!< 排队时间 (ms) */
+    uint32_t run_ms;                /*!< 运行时间 (ms)，运行中为已运行时间 */
+} console_rpc_job_t;
+
+typedef struct {
+    uint32_t baud;                  /*!< 目标波特率 */
+    uint16_t confirm_ms;            /*!< 确认期 (ms)，0为默认值 */
+    uint8_t persist;                /*!< 非0: 确认后保存到NVS */
+} console_rpc_baud_set_t;
+
+typedef struct {
+    uint32_t current;               /*!< 当前波特率 */
+    uint32_t previous;              /*!< 确认失败时恢复的波特率 */
+    uint32_t saved;                 /*!< NVS中保存的波特率，0表示未保存 */
+    uint8_t state;                  /*!< console_baud_state_t */
+    uint32_t switches;              /*!< 切换次数 */
+    uint32_t confirms;              /*!< 确认成功次数 */
+    uint32_t fallbacks;             /*!< 超时恢复次数 */
+} console_rpc_baud_status_t;
+
+typedef struct {
+    uint8_t pin;
+    uint8_t level;
+} console_rpc_gpio_t;
+
+typedef struct {
+    uint8_t fan_speed;
+    console_rpc_color_t board_led_color;
+    uint8_t board_led_brightness;
+    console_rpc_color_t touch_led_color;
+    uint8_t touch_led_brightness;
+} console_rpc_settings_t;
+
+typedef struct {
+    uint8_t initialized;
+    console_rpc_settings_t settings;
+    uint8_t usb_mux_target;
+    uint8_t orin_power_state;
+    uint8_t n305_power_state;
+} console_rpc_hw_status_t;
+
+typedef struct {
+    uint8_t test;                   /*!< console_rpc_hw_test_id_t */
+    uint8_t pin;                    /*!< GPIO测试项的引脚 */
+} console_rpc_hw_test_t;
+
+typedef struct {
+    uint32_t fields;                /*!< hw_txn_field_t 位图 */
+    console_rpc_settings_t settings;
+    uint8_t usb_mux_target;
+    uint64_t gpio_high_mask;
+    uint64_t gpio_low_mask;
+} console_rpc_hw_txn_t;
+
+typedef struct {
+    uint8_t fan_speed;
+    console_rpc_color_t board_led_color;
+    console_rpc_color_t touch_led_color;
+} console_rpc_quick_setup_t;
+
+typedef struct {
+    uint32_t interface_version;
+    uint8_t hardware_available;
+    uint8_t monitor_available;
+    console_rpc_hw_status_t hardware;
+    uint32_t cpu_freq_mhz;
+    uint32_t free_heap;
+    uint32_t min_free_heap;
+    uint64_t uptime_ms;
+} console_rpc_dev_status_t;
+
+typedef struct {
+    uint8_t test;                   /*!< console_rpc_dev_test_id_t */
+    uint32_t duration_ms;           /*!< 压力测试时长 (ms) */
+} console_rpc_dev_test_t;
+
+typedef struct {
+    char name[CONSOLE_RPC_NAME_LEN];
+    uint32_t fade_ms;
+} console_rpc_profile_apply_t;
+
+typedef struct {
+    uint32_t first_commit_us;
+    uint32_t total_us;
+    uint32_t steps;
+} console_rpc_profile_result_t;
+
+typedef struct {
+    char name[CONSOLE_RPC_NAME_LEN];
+    console_rpc_settings_t settings;
+} console_rpc_profile_t;
+
+typedef struct {
+    uint8_t enabled;
+    uint8_t pending;
+    uint32_t quiet_ms;
+    uint32_t change_events;
+    uint32_t commits;
+    uint32_t unchanged_skips;
+    uint32_t writes_avoided;
+    uint32_t failures;
+    uint32_t bytes_written;
+    int64_t last_commit_us;
+} console_rpc_autosave_stats_t;
+
+#pragma pack(pop)
+
+// ==================== 编解码 ====================
+
+/**
+ * @brief CRC-16/CCITT-FALSE
+ *
+ * @param crc 初值，首次调用传0xFFFF
+ * @param data 数据
+ * @param len 长度
+ * @return CRC
+ */
+static inline uint16_t console_rpc_crc16(uint16_t crc, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief COBS编码，输出不含0x00，不含分隔符
+ *
+ * @param src 原始数据
+ * @param len 原始长度
+ * @param dst 输出缓冲区，至少 len + len / 254 + 1 字节
+ * @return 编码后长度
+ */
+static inline size_t console_rpc_cobs_encode(const uint8_t *src, size_t len, uint8_t *dst)
+{
+    size_t code_idx = 0;
+    size_t out = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (src[i] == 0) {
+            dst[code_idx] = code;
+            code_idx = out++;
+            code = 1;
+        } else {
+            dst[out++] = src[i];
+            if (++code == 0xFF) {
+                dst[code_idx] = code;
+                code_idx = out++;
+                code = 1;
+            }
+        }
+    }
+    dst[code_idx] = code;
+    return out;
+}
+
+/**
+ * @brief COBS解码
+ *
+ * @param src 编码数据（不含分隔符）
+ * @param len 编码长度
+ * @param dst 输出缓冲区
+ * @param dst_size 输出缓冲区大小
+ * @return 解码后长度，数据无效或缓冲区不足时返回0
+ */
+static inline size_t console_rpc_cobs_decode(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_size)
+{
+    size_t in = 0;
+    size_t out = 0;
+
+    while (in < len) {
+        uint8_t code = src[in++];
+        if (code == 0 || in + code - 1 > len) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            if (src[in] == 0 || out >= dst_size) {
+                return 0;
+            }
+            dst[out++] = src[in++];
+        }
+        if (code != 0xFF && in < len) {
+            if (out >= dst_size) {
+                return 0;
+            }
+            dst[out++] = 0;
+        }
+    }
+    return out;
+}
+
+// ==================== 超时 ====================
+
+/**
+ * @brief 消息的响应超时：处理函数的最长执行时间加余量
+ *
+ * 压力测试按请求的时长、档案渐变按渐变时间加上 CONSOLE_RPC_SLOW_TIMEOUT_MS。
+ *
+ * @param msg 消息号
+ * @param req 请求负载，可为NULL
+ * @param req_len 请求负载长度
+ * @return 超时 (ms)
+ */
+static inline uint32_t console_rpc_timeout_ms(uint8_t msg, const uint8_t *req, size_t req_len)
+{
+    uint32_t value = 0;
+
+    switch (msg) {
+        case CONSOLE_RPC_MSG_HW_TEST:
+        case CONSOLE_RPC_MSG_DEV_CONFIG_BENCHMARK:
+            return CONSOLE_RPC_TEST_TIMEOUT_MS;
+        case CONSOLE_RPC_MSG_DEV_RUN_TEST:
+            if (req != NULL && req_len == sizeof(console_rpc_dev_test_t) && req[0] == CONSOLE_RPC_DEV_TEST_STRESS) {
+                memcpy(&value, req + offsetof(console_rpc_dev_test_t, duration_ms), sizeof(value));
+                break;
+            }
+            return CONSOLE_RPC_TEST_TIMEOUT_MS;
+        case CONSOLE_RPC_MSG_PROFILE_APPLY:
+            if (req != NULL && req_len == sizeof(console_rpc_profile_apply_t)) {
+                memcpy(&value, req + offsetof(console_rpc_profile_apply_t, fade_ms), sizeof(value));
+            }
+            break;
+        case CONSOLE_RPC_MSG_ORIN_POWER_ON:
+        case CONSOLE_RPC_MSG_ORIN_POWER_OFF:
+        case CONSOLE_RPC_MSG_ORIN_RESET:
+        case CONSOLE_RPC_MSG_ORIN_RECOVERY:
+        case CONSOLE_RPC_MSG_N305_POWER_TOGGLE:
+        case CONSOLE_RPC_MSG_N305_RESET:
+        case CONSOLE_RPC_MSG_DEV_SHUTDOWN_ALL:
+        case CONSOLE_RPC_MSG_DEV_RESET_DEFAULT:
+        case CONSOLE_RPC_MSG_DEV_SLEEP:
+        case CONSOLE_RPC_MSG_DEV_WAKE:
+        case CONSOLE_RPC_MSG_DEV_SAVE_CONFIG:
+        case CONSOLE_RPC_MSG_DEV_LOAD_CONFIG:
+        case CONSOLE_RPC_MSG_DEV_CLEAR_CONFIG:
+        case CONSOLE_RPC_MSG_PROFILE_SAVE:
+        case CONSOLE_RPC_MSG_PROFILE_DELETE:
+        case CONSOLE_RPC_MSG_AUTOSAVE_FLUSH:
+            return CONSOLE_RPC_SLOW_TIMEOUT_MS;
+        default:
+            return CONSOLE_RPC_TIMEOUT_MS;
+    }
+    return value < UINT32_MAX - CONSOLE_RPC_SLOW_TIMEOUT_MS ? value + CONSOLE_RPC_SLOW_TIMEOUT_MS : UINT32_MAX;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONSOLE_RPC_PROTO_H */
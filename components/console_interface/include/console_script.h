@@ -0,0 +1,238 @@
+/**
+ * @file console_script.h
+ * @brief 控制台命令批处理与宏
+ *
+ * 一行中可以用分隔符连接多条命令，按命令返回值决定是否继续：
+ *   - `a ; b`   依次执行
+ *   - `a && b`  a 返回0时才执行 b
+ *   - `a || b`  a 返回非0时才执行 b
+ * 跳过的命令不改变当前结果，`a && b || c` 在 a 或 b 失败时执行 c。
+ * 参数中含空格或分隔符时用双引号括起，`\` 转义下一个字符。
+ *
+ * 批处理先编译为紧凑的令牌形式（每条命令：操作符、参数个数、以'\0'结尾的参数），
+ * 执行时直接从中取出argv，不再逐字符分词。宏是带名字的已编译批处理，保存在NVS中，
+ * 启动时载入内存；执行宏时记录每个宏的耗时统计。
+ *
+ * 脚本中的命令在控制台任务中依次执行，通常作为后台任务的命令（见 console_jobs.h）
+ * 在脚本中直接执行，返回值可用于条件判断。
+ */
+
+#ifndef CONSOLE_SCRIPT_H
+#define CONSOLE_SCRIPT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONSOLE_SCRIPT_MAX_CODE     192     /*!< 编译后程序的最大长度 (bytes) */
+#define CONSOLE_SCRIPT_MAX_STEPS    16      /*!< 每个程序的最大命令数 */
+#define CONSOLE_SCRIPT_MAX_ARGS     16      /*!< 每条命令的最大参数个数 */
+#define CONSOLE_SCRIPT_MAX_DEPTH    3       /*!< 宏嵌套调用的最大深度 */
+#define CONSOLE_SCRIPT_MAX_MACROS   16      /*!< 宏的最大数量 */
+#define CONSOLE_SCRIPT_NAME_MAX_LEN 15      /*!< 宏名最大长度（NVS键名限制） */
+
+/**
+ * @brief 命令之间的连接方式
+ */
+typedef enum {
+    CONSOLE_SCRIPT_OP_SEQ = 0,      /*!< `;` 总是执行 */
+    CONSOLE_SCRIPT_OP_AND,          /*!< `&&` 上一结果为0时执行 */
+    CONSOLE_SCRIPT_OP_OR,           /*!< `||` 上一结果非0时执行 */
+} console_script_op_t;
+
+/**
+ * @brief 编译后的程序
+ *
+ * code 中依次存放每条命令：u8 操作符、u8 参数个数、参数个数个以'\0'结尾的字符串。
+ */
+typedef struct {
+    uint16_t len;                   /*!< code 已用长度 */
+    uint8_t steps;                  /*!< 命令数 */
+    uint8_t code[CONSOLE_SCRIPT_MAX_CODE]; /*!< 令牌 */
+} console_script_program_t;
+
+/**
+ * @brief 一次执行的结果
+ */
+typedef struct {
+    uint8_t steps;                  /*!< 命令数 */
+    uint8_t executed;               /*!< 执行的命令数 */
+    uint8_t skipped;                /*!< 因条件跳过的命令数 */
+    int status;                     /*!< 最后执行的命令的返回值，未知命令记为1 */
+    uint32_t elapsed_us;            /*!< 耗时 (us) */
+} console_script_result_t;
+
+/**
+ * @brief 宏信息与统计
+ */
+typedef struct {
+    char name[CONSOLE_SCRIPT_NAME_MAX_LEN + 1]; /*!< 宏名 */
+    uint8_t steps;                  /*!< 命令数 */
+    uint16_t code_len;              /*!< 编译后长度 (bytes) */
+    uint32_t runs;                  /*!< 执行次数 */
+    uint32_t failures;              /*!< 结果非0的次数 */
+    uint32_t last_us;               /*!< 最近一次耗时 (us) */
+    uint32_t max_us;                /*!< 最长耗时 (us) */
+    uint64_t total_us;              /*!< 累计耗时 (us) */
+} console_script_macro_info_t;
+
+/**
+ * @brief 执行一条已分词的命令
+ *
+ * @param argc 参数个数
+ * @param argv 参数，argv[0]为命令名
+ * @param ret 输出命令返回值
+ * @return
+ *     - ESP_OK: 命令已执行
+ *     - ESP_ERR_NOT_FOUND: 命令不存在
+ */
+typedef esp_err_t (*console_script_exec_t)(int argc, char **argv, int *ret);
+
+/**
+ * @brief 初始化：设置命令执行函数并从NVS载入宏
+ *
+ * @param exec 命令执行函数
+ * @return
+ *     - ESP_OK: 初始化成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NO_MEM: 创建互斥锁失败
+ */
+esp_err_t console_script_init(console_script_exec_t exec);
+
+/**
+ * @brief 判断一行是否包含批处理分隔符（引号外的 `;`、`&&`、`||`）
+ *
+ * @param line 命令行
+ * @return 是否为批处理
+ */
+bool console_script_is_batch(const char *line);
+
+/**
+ * @brief 编译批处理
+ *
+ * @param text 源文本
+ * @param program 输出程序
+ * @return
+ *     - ESP_OK: 编译成功
+ *     - ESP_ERR_INVALID_ARG: 语法错误（引号未闭合、操作符两侧缺少命令）或为空
+ *     - ESP_ERR_INVALID_SIZE: 超出长度、命令数或参数个数限制
+ */
+esp_err_t console_script_compile(const char *text, console_script_program_t *program);
+
+/**
+ * @brief 执行已编译的程序
+ *
+ * @param program 程序
+ * @param result 输出执行结果，可为NULL
+ * @return
+ *     - ESP_OK: 执行完成（命令失败记录在结果中）
+ *     - ESP_ERR_INVALID_STATE: 未初始化或嵌套过深
+ *     - ESP_ERR_NO_MEM: 内存不足
+ */
+esp_err_t console_script_run(const console_script_program_t *program, console_script_result_t *result);
+
+/**
+ * @brief 编译并执行一行批处理，语法错误时打印提示
+ *
+ * @param line 命令行
+ * @param ret 输出最后执行的命令的返回值，语法错误时为1
+ * @return
+ *     - ESP_OK: 已执行或已提示语法错误
+ *     - 其他: console_script_run 的错误
+ */
+esp_err_t console_script_run_line(const char *line, int *ret);
+
+/**
+ * @brief 当前是否在执行脚本（供命令判断是否应同步执行）
+ *
+ * @return 是否在执行脚本
+ */
+bool console_script_running(void);
+
+/**
+ * @brief 定义（或替换）宏并保存到NVS
+ *
+ * @param name 宏名，1~CONSOLE_SCRIPT_NAME_MAX_LEN 个字母、数字或下划线
+ * @param body 批处理文本
+ * @return
+ *     - ESP_OK: 定义成功
+ *     - ESP_ERR_INVALID_ARG: 宏名无效或语法错误
+ *     - ESP_ERR_INVALID_SIZE: 超出限制
+ *     - ESP_ERR_NO_MEM: 宏数量已达上限
+ *     - 其他: NVS错误
+ */
+esp_err_t console_script_macro_define(const char *name, const char *body);
+
+/**
+ * @brief 删除宏
+ *
+ * @param name 宏名
+ * @return
+ *     - ESP_OK: 删除成功
+ *     - ESP_ERR_NOT_FOUND: 宏不存在
+ *     - 其他: NVS错误
+ */
+esp_err_t console_script_macro_delete(const char *name);
+
+/**
+ * @brief 执行宏并更新其统计
+ *
+ * @param name 宏名
+ * @param result 输出执行结果，可为NULL
+ * @return
+ *     - ESP_OK: 执行完成
+ *     - ESP_ERR_NOT_FOUND: 宏不存在
+ *     - 其他: console_script_run 的错误
+ */
+esp_err_t console_script_macro_run(const char *name, console_script_result_t *result);
+
+/**
+ * @brief 获取宏信息
+ *
+ * @param name 宏名
+ * @param info 存储信息的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_NOT_FOUND: 宏不存在
+ */
+esp_err_t console_script_macro_get_info(const char *name, console_script_macro_info_t *info);
+
+/**
+ * @brief 把程序还原为文本（参数必要时加引号）
+ *
+ * @param program 程序
+ * @param buf 输出缓冲区
+ * @param size 缓冲区大小
+ * @return
+ *     - ESP_OK: 成功
+ *     - ESP_ERR_INVALID_SIZE: 缓冲区不足，输出被截断
+ */
+esp_err_t console_script_decompile(const console_script_program_t *program, char *buf, size_t size);
+
+/**
+ * @brief 打印宏及其内容
+ *
+ * @param name 宏名
+ * @return
+ *     - ESP_OK: 打印成功
+ *     - ESP_ERR_NOT_FOUND: 宏不存在
+ */
+esp_err_t console_script_macro_print(const char *name);
+
+/**
+ * @brief 打印宏列表与执行统计
+ *
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t console_script_macro_print_list(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONSOLE_SCRIPT_H */
@@ -8,26 +8,132 @@
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 #include "nvs_flash.h"
 #include "nvs.h"
+#include "esp_timer.h"
+#include "esp_rom_crc.h"
+#include "metrics_store.h"
+#include "api_latency.h"
+#include "boot_profile.h"
+#include "event_bus.h"
+#include "bench.h"
+#include "board_hal_time.h"
 
 static const char *TAG = "DEVICE_INTERFACE";
 static const char *NVS_NAMESPACE = "device_config";
+static const char *NVS_BENCH_NAMESPACE = "cfg_bench";
+static const char *NVS_PROFILE_NAMESPACE = "dev_profiles";
+
+#define CONFIG_BLOB_KEY             "hw_config"     // 配置记录键名
+#define CONFIG_BLOB_MAGIC           0x4643          // "CF"
+#define CONFIG_BLOB_VERSION         1               // 当前配置格式版本
+#define CONFIG_BLOB_MAX_SIZE        128             // 可接受的最大记录 (兼容更高版本追加的字段)
+#define CONFIG_BENCH_DEFAULT_ITERATIONS 20
+
+/**
+ * @brief 配置记录负载，版本1
+ *
+ * 新版本只能在末尾追加字段；旧固件读取新记录时忽略多出的部分，
+ * 新固件读取旧记录时缺少的字段使用默认值。
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t fan_speed;
+    uint8_t board_led_r;
+    uint8_t board_led_g;
+    uint8_t board_led_b;
+    uint8_t board_brightness;
+    uint8_t touch_led_r;
+    uint8_t touch_led_g;
+    uint8_t touch_led_b;
+    uint8_t touch_brightness;
+} config_payload_t;
+
+/**
+ * @brief 配置记录头
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t magic;             // CONFIG_BLOB_MAGIC
+    uint8_t version;            // 写入时的格式版本
+    uint8_t payload_len;        // 负载长度
+    uint16_t crc16;             // 负载CRC16
+} config_blob_header_t;
+
+typedef struct __attribute__((packed)) {
+    config_blob_header_t header;
+    config_payload_t payload;
+} config_blob_t;
+
+#define AUTOSAVE_TASK_STACK         3072
+#define AUTOSAVE_TASK_PRIORITY      2
+#define NVS_ENTRY_SIZE              32              // NVS条目大小
+#define NVS_ENTRIES_PER_PAGE        126             // 每个4KB页面的条目数
+// 写一次记录消耗的条目: 数据头 + 数据 + 索引
+#define CONFIG_BLOB_NVS_ENTRIES     (2 + (sizeof(config_blob_t) + NVS_ENTRY_SIZE - 1) / NVS_ENTRY_SIZE)
 
 // ==================== 静态变量 ====================
 
 static bool s_initialized = false;
 static device_interface_config_t s_config = {0};
 static device_event_cb_t s_event_callback = NULL;
+static int s_event_subscriber = -1;                 // 事件回调在事件总线上的订阅者ID
 static device_status_t s_last_status = {0};
 
+static SemaphoreHandle_t s_config_mutex = NULL;     // 串行化NVS配置读写和已保存镜像
+static hardware_settings_t s_persisted;             // 最近一次保存或加载的设置
+static bool s_persisted_valid = false;
+static TaskHandle_t s_autosave_task_handle = NULL;
+static SemaphoreHandle_t s_autosave_exited = NULL;  // 自动保存任务退出时释放
+static volatile bool s_autosave_exit = false;       // 请求自动保存任务退出
+static device_autosave_stats_t s_autosave = {0};
+static hardware_settings_t s_autosave_target;       // 最近一次用户设置，受 s_autosave_lock 保护
+static bool s_autosave_target_valid = false;
+static portMUX_TYPE s_autosave_lock = portMUX_INITIALIZER_UNLOCKED;
+static device_profile_t s_profiles[DEVICE_PROFILE_MAX_COUNT];  // 档案内存索引，受 s_config_mutex 保护
+static uint32_t s_profile_count = 0;
+static nvs_handle_t s_bench_nvs = 0;                // NVS基准测试使用的句柄 (cfg_bench命名空间)
+
 // ==================== 静态函数声明 ====================
 
 static void internal_memory_warning_callback(uint32_t free_heap, uint32_t threshold);
-static esp_err_t save_hardware_config_to_nvs(void);
+static void internal_memory_alarm_callback(uint32_t alarms, const system_memory_snapshot_t *snapshot);
+static esp_err_t save_hardware_config_to_nvs(const hardware_settings_t *settings);
 static esp_err_t load_hardware_config_from_nvs(void);
-static void trigger_event(device_event_t event, void *data);
+static esp_err_t read_hardware_config_from_nvs(hardware_settings_t *settings);
+static void set_default_settings(hardware_settings_t *settings);
+static esp_err_t write_config_blob(nvs_handle_t nvs_handle, const char *key, const hardware_settings_t *settings);
+static esp_err_t read_config_blob(nvs_handle_t nvs_handle, const char *key, hardware_settings_t *settings);
+static esp_err_t write_legacy_keys(nvs_handle_t nvs_handle, const hardware_settings_t *settings);
+static esp_err_t read_legacy_keys(nvs_handle_t nvs_handle, hardware_settings_t *settings);
+static esp_err_t migrate_legacy_config(const hardware_settings_t *settings);
+static esp_err_t repair_corrupt_config(const hardware_settings_t *settings);
+static void early_restore_hardware_config(void);
+static void set_persisted_settings(const hardware_settings_t *settings);
+static bool settings_equal(const hardware_settings_t *a, const hardware_settings_t *b);
+static void lock_config(void);
+static void unlock_config(void);
+static esp_err_t autosave_start(void);
+static void autosave_stop(void);
+static void autosave_settings_changed(void);
+static esp_err_t autosave_commit(void);
+static void autosave_task(void *pvParameters);
+static void load_profile_index(void);
+static int find_profile(const char *name);
+static bool is_valid_profile_name(const char *name);
+static uint8_t lerp_u8(uint8_t from, uint8_t to, uint32_t step, uint32_t steps);
+static void interpolate_settings(const hardware_settings_t *from, const hardware_settings_t *to,
+                                 uint32_t step, uint32_t steps, hardware_settings_t *out);
+static void trigger_event(device_event_t event, const void *data, size_t len);
+static void bus_event_handler(const event_bus_event_t *event, void *ctx);
+static void register_benchmarks(void);
+static esp_err_t bench_nvs_open(void *ctx);
+static esp_err_t bench_nvs_close(void *ctx);
+static esp_err_t bench_nvs_save(void *ctx, uint32_t iteration);
+static esp_err_t bench_nvs_load(void *ctx, uint32_t iteration);
+static bool metrics_fan_speed_source(uint32_t *value);
+static bool metrics_orin_power_source(uint32_t *value);
+static bool metrics_n305_power_source(uint32_t *value);
 
 // ==================== 初始化接口实现 ====================
 
@@ -52,6 +158,20 @@ esp_err_t device_interface_init(const device_interface_config_t *config)
 
     // 设置内存警告回调为内部回调
     s_config.monitor_config.warning_cb = internal_memory_warning_callback;
+    s_config.monitor_config.alarm_cb = internal_memory_alarm_callback;
+
+    // 事件经总线异步投递；总线不可用时退回在触发任务中直接回调
+    if (event_bus_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Event bus unavailable, events will be delivered synchronously");
+    }
+
+    if (s_config_mutex == NULL) {
+        s_config_mutex = xSemaphoreCreateMutex();
+        if (s_config_mutex == NULL) {
+            ESP_LOGE(TAG, "Failed to create config mutex");
+            return ESP_ERR_NO_MEM;
+        }
+    }
 
     esp_err_t ret = ESP_OK;
 
@@ -63,6 +183,24 @@ esp_err_t device_interface_init(const device_interface_config_t *config)
             s_config.enable_hardware_control = false;
         } else {
             ESP_LOGI(TAG, "Hardware control initialized");
+
+            // 风扇与电源状态作为时间序列指标数据源
+            metrics_store_register_source(METRICS_FAN_SPEED, metrics_fan_speed_source);
+            metrics_store_register_source(METRICS_ORIN_POWER, metrics_orin_power_source);
+            metrics_store_register_source(METRICS_N305_POWER, metrics_n305_power_source);
+
+            // 外设就绪后立即恢复保存的风扇与LED设置，先于系统监控和控制台
+            if (s_config.enable_early_restore) {
+                early_restore_hardware_config();
+            }
+            load_profile_index();
+
+            // 恢复完成后再开始监视设置变化
+            s_autosave.quiet_ms = s_config.autosave_quiet_ms >= DEVICE_AUTOSAVE_MIN_QUIET_MS ?
+                                  s_config.autosave_quiet_ms : DEVICE_AUTOSAVE_DEFAULT_QUIET_MS;
+            if (s_config.enable_autosave && autosave_start() != ESP_OK) {
+                ESP_LOGW(TAG, "Autosave disabled");
+            }
         }
     }
 
@@ -77,10 +215,28 @@ esp_err_t device_interface_init(const device_interface_config_t *config)
         }
     }
 
+    // 动态调频与自动浅睡眠，风扇、LED和电源脉冲由硬件控制组件按需持有PM锁
+    if (s_config.enable_power_management) {
+        ret = power_manager_init(&s_config.power_config);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Power management unavailable: %s", esp_err_to_name(ret));
+            s_config.enable_power_management = false;
+        } else if (s_config.enable_hardware_control) {
+            // 被控设备电源状态变化时唤醒芯片
+#if ORIN_POWER_GOOD_PIN >= 0
+            power_manager_add_gpio_wakeup(ORIN_POWER_GOOD_PIN);
+#endif
+#if N305_POWER_GOOD_PIN >= 0
+            power_manager_add_gpio_wakeup(N305_POWER_GOOD_PIN);
+#endif
+        }
+    }
+
+    register_benchmarks();
     s_initialized = true;
     
     // 触发初始化完成事件
-    trigger_event(DEVICE_EVENT_INIT_COMPLETE, NULL);
+    trigger_event(DEVICE_EVENT_INIT_COMPLETE, NULL, 0);
     
     ESP_LOGI(TAG, "Device interface initialized successfully");
     ESP_LOGI(TAG, "Hardware control: %s, System monitor: %s", 
@@ -99,6 +255,10 @@ esp_err_t device_interface_deinit(void)
 
     ESP_LOGI(TAG, "Deinitializing device interface");
 
+    if (s_config.enable_power_management) {
+        power_manager_deinit();
+    }
+
     // 反初始化系统监控组件
     if (s_config.enable_system_monitor) {
         system_monitor_deinit();
@@ -106,9 +266,19 @@ esp_err_t device_interface_deinit(void)
 
     // 反初始化硬件控制组件
     if (s_config.enable_hardware_control) {
+        autosave_commit();  // 保存静默期内尚未写入的变化
+        autosave_stop();
+        metrics_store_register_source(METRICS_FAN_SPEED, NULL);
+        metrics_store_register_source(METRICS_ORIN_POWER, NULL);
+        metrics_store_register_source(METRICS_N305_POWER, NULL);
         hardware_control_deinit();
     }
 
+    if (s_event_subscriber >= 0) {
+        event_bus_unsubscribe(s_event_subscriber);
+        s_event_subscriber = -1;
+    }
+
     s_initialized = false;
     s_event_callback = NULL;
     
@@ -129,6 +299,10 @@ esp_err_t device_interface_register_event_callback(device_event_cb_t callback)
     }
 
     s_event_callback = callback;
+    if (s_event_subscriber < 0) {
+        event_bus_subscribe("device_cb", EVENT_BUS_SOURCE_BIT(EVENT_BUS_SOURCE_DEVICE), 0,
+                            bus_event_handler, NULL, &s_event_subscriber);
+    }
     ESP_LOGI(TAG, "Event callback registered");
     return ESP_OK;
 }
@@ -149,24 +323,15 @@ esp_err_t device_quick_setup(uint8_t fan_speed, led_color_t board_led_color, led
     esp_err_t ret = ESP_OK;
 
     if (s_config.enable_hardware_control) {
-        // 设置风扇速度
-        ret = fan_set_speed(fan_speed);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to set fan speed");
-            return ret;
-        }
-
-        // 设置板载LED
-        ret = board_led_set_color(board_led_color);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to set board LED color");
-            return ret;
-        }
-
-        // 设置触摸LED
-        ret = touch_led_set_color(touch_led_color);
+        // 风扇与两条LED一次提交
+        hw_txn_t txn;
+        hw_txn_begin(&txn);
+        hw_txn_set_fan(&txn, fan_speed);
+        hw_txn_set_board_led(&txn, board_led_color);
+        hw_txn_set_touch_led(&txn, touch_led_color);
+        ret = hw_txn_commit(&txn);
         if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to set touch LED color");
+            ESP_LOGE(TAG, "Failed to apply quick setup: %s", esp_err_to_name(ret));
             return ret;
         }
     }
@@ -185,9 +350,14 @@ esp_err_t device_shutdown_all(void)
     ESP_LOGI(TAG, "Shutting down all devices");
 
     if (s_config.enable_hardware_control) {
-        fan_stop();
-        board_led_turn_off();
-        touch_led_turn_off();
+        // 关机状态不写入自动保存，下次启动仍恢复用户设置
+        hw_txn_t txn;
+        hw_txn_begin(&txn);
+        hw_txn_set_transient(&txn);
+        hw_txn_set_fan(&txn, 0);
+        hw_txn_set_board_led(&txn, LED_COLOR_OFF);
+        hw_txn_set_touch_led(&txn, LED_COLOR_OFF);
+        hw_txn_commit(&txn);
     }
 
     ESP_LOGI(TAG, "All devices shut down");
@@ -203,8 +373,22 @@ esp_err_t device_reset_to_default(void)
 
     ESP_LOGI(TAG, "Resetting devices to default state");
 
-    // 默认状态：风扇关闭，LED关闭
-    return device_quick_setup(0, LED_COLOR_OFF, LED_COLOR_OFF);
+    if (!s_config.enable_hardware_control) {
+        return ESP_OK;
+    }
+
+    // 默认状态：风扇关闭，LED关闭；与关机相同，不写入自动保存
+    hw_txn_t txn;
+    hw_txn_begin(&txn);
+    hw_txn_set_transient(&txn);
+    hw_txn_set_fan(&txn, 0);
+    hw_txn_set_board_led(&txn, LED_COLOR_OFF);
+    hw_txn_set_touch_led(&txn, LED_COLOR_OFF);
+    esp_err_t ret = hw_txn_commit(&txn);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to reset devices: %s", esp_err_to_name(ret));
+    }
+    return ret;
 }
 
 esp_err_t device_enter_sleep_mode(void)
@@ -227,7 +411,9 @@ esp_err_t device_enter_sleep_mode(void)
         system_monitor_stop();
     }
 
-    ESP_LOGI(TAG, "Sleep mode activated");
+    // 风扇关闭后不再持有PM锁，空闲时芯片自动进入浅睡眠，由控制台输入或定时器唤醒
+    ESP_LOGI(TAG, "Sleep mode activated (light sleep %s)",
+             power_manager_is_enabled() ? "when idle" : "unavailable");
     return ESP_OK;
 }
 
@@ -247,11 +433,16 @@ esp_err_t device_wake_up(void)
 
     // 恢复之前的设备状态
     if (s_config.enable_hardware_control && s_last_status.hardware_available) {
-        fan_set_speed(s_last_status.hardware.fan_speed);
-        board_led_set_color(s_last_status.hardware.board_led_color);
-        board_led_set_brightness(s_last_status.hardware.board_led_brightness);
-        touch_led_set_color(s_last_status.hardware.touch_led_color);
-        touch_led_set_brightness(s_last_status.hardware.touch_led_brightness);
+        // 颜色与亮度一起提交，每条灯带只刷新一次
+        const hardware_status_t *hw = &s_last_status.hardware;
+        hw_txn_t txn;
+        hw_txn_begin(&txn);
+        hw_txn_set_fan(&txn, hw->fan_speed);
+        hw_txn_set_board_led(&txn, hw->board_led_color);
+        hw_txn_set_board_brightness(&txn, hw->board_led_brightness);
+        hw_txn_set_touch_led(&txn, hw->touch_led_color);
+        hw_txn_set_touch_brightness(&txn, hw->touch_led_brightness);
+        hw_txn_commit(&txn);
     }
 
     ESP_LOGI(TAG, "Wake up completed");
@@ -431,7 +622,7 @@ esp_err_t device_run_quick_test(void)
             ESP_LOGE(TAG, "Quick hardware test failed");
             return ret;
         }
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        board_hal_time_delay_ms(1000);
         
         ret = device_reset_to_default();
         if (ret != ESP_OK) {
@@ -451,39 +642,20 @@ esp_err_t device_run_stress_test(uint32_t duration_ms)
         return ESP_ERR_INVALID_STATE;
     }
 
-    ESP_LOGI(TAG, "Starting stress test for %" PRIu32 " ms", duration_ms);
-
-    uint32_t start_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    uint32_t cycle_count = 0;
-
-    while ((xTaskGetTickCount() * portTICK_PERIOD_MS - start_time) < duration_ms) {
-        cycle_count++;
-        
-        if (s_config.enable_hardware_control) {
-            // 循环测试不同的设置
-            uint8_t fan_speed = (cycle_count * 25) % 101;
-            led_color_t color = {
-                .red = (cycle_count * 50) % 256,
-                .green = (cycle_count * 75) % 256,
-                .blue = (cycle_count * 100) % 256
-            };
-            
-            esp_err_t ret = device_quick_setup(fan_speed, color, color);
-            if (ret != ESP_OK) {
-                ESP_LOGE(TAG, "Stress test failed at cycle %" PRIu32, cycle_count);
-                return ret;
-            }
-        }
-        
-        vTaskDelay(pdMS_TO_TICKS(100));
+    // 有副作用的用例（USB MUX切换、NVS提交）不参与压力测试
+    uint32_t count = bench_get_all_count();
+    if (count == 0 || duration_ms < count) {
+        ESP_LOGE(TAG, "Stress test needs at least 1 ms per benchmark (%" PRIu32 " registered)", count);
+        return ESP_ERR_INVALID_ARG;
     }
 
-    // 恢复默认状态
-    device_reset_to_default();
+    // 总时长平均分给每个基准测试，按固定时长运行
+    bench_params_t params = BENCH_DEFAULT_PARAMS();
+    params.duration_ms = duration_ms / count;
 
-    ESP_LOGI(TAG, "Stress test completed: %" PRIu32 " cycles in %" PRIu32 " ms", 
-             cycle_count, duration_ms);
-    return ESP_OK;
+    ESP_LOGI(TAG, "Starting stress test: %" PRIu32 " benchmarks, %" PRIu32 " ms each",
+             count, params.duration_ms);
+    return bench_run_print("all", &params);
 }
 
 // ==================== 配置管理接口实现 ====================
@@ -496,7 +668,21 @@ esp_err_t device_save_config(void)
     }
 
     ESP_LOGI(TAG, "Saving device configuration to NVS");
-    return save_hardware_config_to_nvs();
+    if (!s_config.enable_hardware_control) {
+        ESP_LOGW(TAG, "Hardware control disabled, skipping config save");
+        return ESP_OK;
+    }
+
+    hardware_settings_t settings;
+    esp_err_t ret = hardware_get_settings(&settings);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    lock_config();
+    ret = save_hardware_config_to_nvs(&settings);
+    unlock_config();
+    return ret;
 }
 
 esp_err_t device_load_config(void)
@@ -507,17 +693,24 @@ esp_err_t device_load_config(void)
     }
 
     ESP_LOGI(TAG, "Loading device configuration from NVS");
-    return load_hardware_config_from_nvs();
+    lock_config();
+    esp_err_t ret = load_hardware_config_from_nvs();
+    unlock_config();
+    return ret;
 }
 
 esp_err_t device_clear_config(void)
 {
+    API_LATENCY_FUNCTION();
+
     ESP_LOGI(TAG, "Clearing device configuration from NVS");
 
+    lock_config();
     nvs_handle_t nvs_handle;
     esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        unlock_config();
         return ret;
     }
 
@@ -527,14 +720,378 @@ esp_err_t device_clear_config(void)
     } else {
         ret = nvs_commit(nvs_handle);
         if (ret == ESP_OK) {
+            s_persisted_valid = false;
             ESP_LOGI(TAG, "Device configuration cleared from NVS");
         }
     }
 
     nvs_close(nvs_handle);
+    unlock_config();
+    return ret;
+}
+
+esp_err_t device_config_benchmark(uint32_t iterations)
+{
+    if (iterations == 0) {
+        iterations = CONFIG_BENCH_DEFAULT_ITERATIONS;
+    }
+
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_BENCH_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    hardware_settings_t settings;
+    set_default_settings(&settings);
+
+    const char *names[] = { "9个独立键", "单条记录" };
+    int64_t save_us[2] = {0};
+    int64_t load_us[2] = {0};
+    int32_t entries[2] = {0};
+
+    for (int scheme = 0; scheme < 2 && ret == ESP_OK; scheme++) {
+        nvs_erase_all(nvs_handle);
+        nvs_commit(nvs_handle);
+
+        nvs_stats_t before, after;
+        nvs_get_stats(NULL, &before);
+
+        for (uint32_t i = 0; i < iterations && ret == ESP_OK; i++) {
+            settings.fan_speed = i % 101;
+            settings.board_led_color.red = (uint8_t)i;
+
+            int64_t start = esp_timer_get_time();
+            ret = scheme == 0 ? write_legacy_keys(nvs_handle, &settings)
+                              : write_config_blob(nvs_handle, CONFIG_BLOB_KEY, &settings);
+            if (ret == ESP_OK) {
+                ret = nvs_commit(nvs_handle);
+            }
+            save_us[scheme] += esp_timer_get_time() - start;
+
+            hardware_settings_t loaded;
+            set_default_settings(&loaded);
+            start = esp_timer_get_time();
+            if (ret == ESP_OK) {
+                ret = scheme == 0 ? read_legacy_keys(nvs_handle, &loaded)
+                                  : read_config_blob(nvs_handle, CONFIG_BLOB_KEY, &loaded);
+            }
+            load_us[scheme] += esp_timer_get_time() - start;
+        }
+
+        nvs_get_stats(NULL, &after);
+        entries[scheme] = (int32_t)before.free_entries - (int32_t)after.free_entries;
+    }
+
+    nvs_erase_all(nvs_handle);
+    nvs_commit(nvs_handle);
+    nvs_close(nvs_handle);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Config benchmark failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    printf("\n=== NVS配置存储对比 (%" PRIu32 " 次) ===\n", iterations);
+    printf("%-12s %14s %14s %16s\n", "方案", "保存(us/次)", "读取(us/次)", "写入条目(/次)");
+    for (int scheme = 0; scheme < 2; scheme++) {
+        printf("%-12s %14" PRId64 " %14" PRId64 " %16.1f\n", names[scheme],
+               save_us[scheme] / iterations, load_us[scheme] / iterations,
+               (double)entries[scheme] / iterations);
+    }
+    printf("写入条目为NVS可用条目的减少量，页面回收时可能偏低\n");
+    printf("================\n");
+    return ESP_OK;
+}
+
+// ==================== 配置档案接口实现 ====================
+
+esp_err_t device_profile_save(const char *name)
+{
+    API_LATENCY_FUNCTION();
+
+    if (!is_valid_profile_name(name)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_initialized || !s_config.enable_hardware_control) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    hardware_settings_t settings;
+    esp_err_t ret = hardware_get_settings(&settings);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    lock_config();
+    int index = find_profile(name);
+    if (index < 0 && s_profile_count >= DEVICE_PROFILE_MAX_COUNT) {
+        unlock_config();
+        ESP_LOGW(TAG, "Profile limit reached (%d)", DEVICE_PROFILE_MAX_COUNT);
+        return ESP_ERR_NO_MEM;
+    }
+
+    nvs_handle_t nvs_handle;
+    ret = nvs_open(NVS_PROFILE_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret == ESP_OK) {
+        ret = write_config_blob(nvs_handle, name, &settings);
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+
+    if (ret == ESP_OK) {
+        if (index < 0) {
+            index = s_profile_count++;
+            snprintf(s_profiles[index].name, sizeof(s_profiles[index].name), "%s", name);
+        }
+        s_profiles[index].settings = settings;
+        ESP_LOGI(TAG, "Profile '%s' saved", name);
+    } else {
+        ESP_LOGE(TAG, "Failed to save profile '%s': %s", name, esp_err_to_name(ret));
+    }
+    unlock_config();
+    return ret;
+}
+
+esp_err_t device_profile_delete(const char *name)
+{
+    API_LATENCY_FUNCTION();
+
+    if (!is_valid_profile_name(name)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_initialized || !s_config.enable_hardware_control) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    lock_config();
+    int index = find_profile(name);
+    if (index < 0) {
+        unlock_config();
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_PROFILE_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret == ESP_OK) {
+        ret = nvs_erase_key(nvs_handle, name);
+        if (ret == ESP_OK || ret == ESP_ERR_NVS_NOT_FOUND) {
+            ret = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+
+    if (ret == ESP_OK) {
+        s_profile_count--;
+        memmove(&s_profiles[index], &s_profiles[index + 1],
+                (s_profile_count - index) * sizeof(s_profiles[0]));
+        ESP_LOGI(TAG, "Profile '%s' deleted", name);
+    } else {
+        ESP_LOGE(TAG, "Failed to delete profile '%s': %s", name, esp_err_to_name(ret));
+    }
+    unlock_config();
     return ret;
 }
 
+esp_err_t device_profile_apply(const char *name, uint32_t fade_ms, device_profile_switch_result_t *result)
+{
+    int64_t start_us = esp_timer_get_time();
+
+    if (!is_valid_profile_name(name) || fade_ms > DEVICE_PROFILE_MAX_FADE_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_initialized || !s_config.enable_hardware_control) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    hardware_settings_t target;
+    lock_config();
+    int index = find_profile(name);
+    if (index >= 0) {
+        target = s_profiles[index].settings;
+    }
+    unlock_config();
+    if (index < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    hardware_settings_t from;
+    esp_err_t ret = hardware_get_settings(&from);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    uint32_t steps = fade_ms / DEVICE_PROFILE_FADE_STEP_MS;
+    if (steps == 0) {
+        steps = 1;
+    }
+
+    int64_t first_commit_us = 0;
+    TickType_t last_wake = board_hal_time_get_ticks();
+    for (uint32_t step = 1; step <= steps && ret == ESP_OK; step++) {
+        if (step > 1) {
+            board_hal_time_delay_until(&last_wake, pdMS_TO_TICKS(DEVICE_PROFILE_FADE_STEP_MS));
+        }
+
+        // 中间步骤是临时状态，不触发自动保存；只有最后一步作为设置变化提交
+        hardware_settings_t settings;
+        interpolate_settings(&from, &target, step, steps, &settings);
+        hw_txn_t txn;
+        hw_txn_begin(&txn);
+        hw_txn_set_settings(&txn, &settings);
+        if (step < steps) {
+            hw_txn_set_transient(&txn);
+        }
+        ret = hw_txn_commit(&txn);
+        if (step == 1) {
+            first_commit_us = esp_timer_get_time() - start_us;
+        }
+    }
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to apply profile '%s': %s", name, esp_err_to_name(ret));
+        return ret;
+    }
+
+    uint32_t total_us = (uint32_t)(esp_timer_get_time() - start_us);
+    if (result != NULL) {
+        result->first_commit_us = (uint32_t)first_commit_us;
+        result->total_us = total_us;
+        result->steps = steps;
+    }
+
+    ESP_LOGI(TAG, "Profile '%s' applied (%" PRIu32 " steps, %" PRIu32 " us)", name, steps, total_us);
+    return ESP_OK;
+}
+
+uint32_t device_profile_get_count(void)
+{
+    return s_profile_count;
+}
+
+esp_err_t device_profile_get(uint32_t index, device_profile_t *profile)
+{
+    if (profile == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    lock_config();
+    if (index >= s_profile_count) {
+        unlock_config();
+        return ESP_ERR_NOT_FOUND;
+    }
+    *profile = s_profiles[index];
+    unlock_config();
+    return ESP_OK;
+}
+
+esp_err_t device_profile_print_list(void)
+{
+    printf("\n=== 配置档案 (%" PRIu32 "/%d) ===\n", s_profile_count, DEVICE_PROFILE_MAX_COUNT);
+    if (s_profile_count == 0) {
+        printf("暂无档案\n");
+        printf("================\n");
+        return ESP_OK;
+    }
+
+    printf("%-16s %6s %18s %18s\n", "名称", "风扇", "板载LED(亮度)", "触摸LED(亮度)");
+    for (uint32_t i = 0; i < s_profile_count; i++) {
+        device_profile_t profile;
+        if (device_profile_get(i, &profile) != ESP_OK) {
+            break;
+        }
+
+        const hardware_settings_t *s = &profile.settings;
+        printf("%-16s %5d%% %3d,%3d,%3d (%3d%%) %3d,%3d,%3d (%3d%%)\n", profile.name, s->fan_speed,
+               s->board_led_color.red, s->board_led_color.green, s->board_led_color.blue,
+               s->board_led_brightness,
+               s->touch_led_color.red, s->touch_led_color.green, s->touch_led_color.blue,
+               s->touch_led_brightness);
+    }
+    printf("================\n");
+    return ESP_OK;
+}
+
+// ==================== 自动保存接口实现 ====================
+
+esp_err_t device_autosave_enable(bool enable)
+{
+    if (!s_initialized || !s_config.enable_hardware_control) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (enable) {
+        return autosave_start();
+    }
+
+    autosave_stop();
+    return ESP_OK;
+}
+
+esp_err_t device_autosave_set_quiet_period(uint32_t quiet_ms)
+{
+    if (quiet_ms < DEVICE_AUTOSAVE_MIN_QUIET_MS || quiet_ms > DEVICE_AUTOSAVE_MAX_DELAY_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_autosave.quiet_ms = quiet_ms;
+    ESP_LOGI(TAG, "Autosave quiet period set to %" PRIu32 " ms", quiet_ms);
+    return ESP_OK;
+}
+
+esp_err_t device_autosave_flush(void)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return autosave_commit();
+}
+
+esp_err_t device_autosave_get_stats(device_autosave_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_autosave_lock);
+    *stats = s_autosave;
+    portEXIT_CRITICAL(&s_autosave_lock);
+
+    // 只计实际改变了设置的通知，与每次变化都保存相比少写的次数
+    uint32_t effective = stats->change_events - stats->noop_events;
+    stats->writes_avoided = effective > stats->commits ? effective - stats->commits : 0;
+    stats->entries_avoided = stats->writes_avoided * CONFIG_BLOB_NVS_ENTRIES;
+    return ESP_OK;
+}
+
+esp_err_t device_autosave_print_stats(void)
+{
+    device_autosave_stats_t stats;
+    device_autosave_get_stats(&stats);
+
+    printf("\n=== 自动保存 ===\n");
+    printf("状态: %s, 静默期 %" PRIu32 " ms, 最长推迟 %d ms\n",
+           stats.enabled ? "启用" : "禁用", stats.quiet_ms, DEVICE_AUTOSAVE_MAX_DELAY_MS);
+    printf("待保存变化: %s\n", stats.pending ? "有" : "无");
+    printf("设置变化: %" PRIu32 " 次 (其中未改变设置 %" PRIu32 " 次)\n", stats.change_events, stats.noop_events);
+    printf("写入NVS: %" PRIu32 " 次 (失败 %" PRIu32 ")\n", stats.commits, stats.failures);
+    printf("内容未变跳过: %" PRIu32 " 次\n", stats.unchanged_skips);
+    printf("少写: %" PRIu32 " 次, 约 %" PRIu32 " 个NVS条目\n", stats.writes_avoided, stats.entries_avoided);
+    printf("已写入: %" PRIu32 " 字节, 约 %" PRIu32 " 个NVS条目, 约 %.2f 次页面擦除 (%d条/页)\n",
+           stats.bytes_written, stats.entries_written,
+           (double)stats.entries_written / NVS_ENTRIES_PER_PAGE, NVS_ENTRIES_PER_PAGE);
+    if (stats.last_commit_us > 0) {
+        printf("最近保存: %" PRId64 " 秒前\n", (esp_timer_get_time() - stats.last_commit_us) / 1000000);
+    } else {
+        printf("最近保存: 无\n");
+    }
+    printf("================\n");
+    return ESP_OK;
+}
+
 // ==================== 静态函数实现 ====================
 
 static void internal_memory_warning_callback(uint32_t free_heap, uint32_t threshold)
@@ -543,15 +1100,57 @@ static void internal_memory_warning_callback(uint32_t free_heap, uint32_t thresh
              free_heap, threshold);
     
     // 触发内存警告事件
-    trigger_event(DEVICE_EVENT_MEMORY_WARNING, &free_heap);
+    trigger_event(DEVICE_EVENT_MEMORY_WARNING, &free_heap, sizeof(free_heap));
 }
 
-static esp_err_t save_hardware_config_to_nvs(void)
+static void internal_memory_alarm_callback(uint32_t alarms, const system_memory_snapshot_t *snapshot)
 {
-    if (!s_config.enable_hardware_control) {
-        ESP_LOGW(TAG, "Hardware control disabled, skipping config save");
-        return ESP_OK;
+    const system_heap_region_info_t *dma = &snapshot->regions[SYSTEM_HEAP_DMA];
+    const system_heap_region_info_t *internal = &snapshot->regions[SYSTEM_HEAP_INTERNAL];
+
+    ESP_LOGW(TAG, "Memory alarm 0x%02" PRIx32 " - internal: %" PRIu32 " bytes, dma: %" PRIu32 " bytes (largest %" PRIu32 ", frag %d%%)",
+             alarms, internal->free_bytes, dma->free_bytes, dma->largest_free_block, dma->fragmentation_percent);
+
+    // 事件数据保持为可用字节数；DMA不足时上报DMA可用量（影响RMT LED刷新）
+    uint32_t free_bytes = snapshot->total_free_bytes;
+    if (alarms & (SYSTEM_MEMORY_ALARM_DMA_FREE | SYSTEM_MEMORY_ALARM_LARGEST_BLOCK)) {
+        free_bytes = dma->free_bytes;
+    } else if (alarms & SYSTEM_MEMORY_ALARM_INTERNAL_FREE) {
+        free_bytes = internal->free_bytes;
+    }
+
+    trigger_event(DEVICE_EVENT_MEMORY_WARNING, &free_bytes, sizeof(free_bytes));
+}
+
+static bool metrics_fan_speed_source(uint32_t *value)
+{
+    *value = fan_get_speed();
+    return true;
+}
+
+static bool metrics_orin_power_source(uint32_t *value)
+{
+    power_state_t state;
+    if (orin_get_power_state(&state) != ESP_OK || state == POWER_STATE_UNKNOWN) {
+        return false;
+    }
+    *value = (state == POWER_STATE_ON) ? 1 : 0;
+    return true;
+}
+
+static bool metrics_n305_power_source(uint32_t *value)
+{
+    power_state_t state;
+    if (n305_get_power_state(&state) != ESP_OK || state == POWER_STATE_UNKNOWN) {
+        return false;
     }
+    *value = (state == POWER_STATE_ON) ? 1 : 0;
+    return true;
+}
+
+static esp_err_t save_hardware_config_to_nvs(const hardware_settings_t *settings)
+{
+    API_LATENCY_FUNCTION();
 
     nvs_handle_t nvs_handle;
     esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
@@ -560,103 +1159,656 @@ static esp_err_t save_hardware_config_to_nvs(void)
         return ret;
     }
 
-    // 获取当前硬件状态
-    hardware_status_t status;
-    ret = hardware_get_status(&status);
+    // 整条记录一次写入，掉电时要么是旧记录要么是新记录
+    ret = write_config_blob(nvs_handle, CONFIG_BLOB_KEY, settings);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs_handle);
+    }
+
+    if (ret == ESP_OK) {
+        set_persisted_settings(settings);
+        ESP_LOGI(TAG, "Hardware configuration saved to NVS");
+    } else {
+        ESP_LOGE(TAG, "Failed to save configuration: %s", esp_err_to_name(ret));
+    }
+
+    nvs_close(nvs_handle);
+    return ret;
+}
+
+static esp_err_t load_hardware_config_from_nvs(void)
+{
+    API_LATENCY_FUNCTION();
+
+    if (!s_config.enable_hardware_control) {
+        ESP_LOGW(TAG, "Hardware control disabled, skipping config load");
+        return ESP_OK;
+    }
+
+    hardware_settings_t settings;
+    esp_err_t ret = read_hardware_config_from_nvs(&settings);
+    if (ret == ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(TAG, "No saved hardware configuration in NVS");
+        return ret;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read configuration from NVS: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // 应用配置
+    ret = hardware_apply_settings(&settings);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to apply configuration: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    set_persisted_settings(&settings);
+    ESP_LOGI(TAG, "Hardware configuration loaded from NVS");
+    return ESP_OK;
+}
+
+static esp_err_t read_hardware_config_from_nvs(hardware_settings_t *settings)
+{
+    set_default_settings(settings);
+
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_ERR_NOT_FOUND;
+    }
     if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = read_config_blob(nvs_handle, CONFIG_BLOB_KEY, settings);
+    if (ret == ESP_ERR_NOT_FOUND) {
+        // 旧固件按键分别保存，读取后迁移为单条记录
+        ret = read_legacy_keys(nvs_handle, settings);
         nvs_close(nvs_handle);
+        if (ret == ESP_OK) {
+            migrate_legacy_config(settings);
+        }
+        return ret;
+    }
+
+    nvs_close(nvs_handle);
+    if (ret == ESP_ERR_INVALID_CRC || ret == ESP_ERR_INVALID_VERSION) {
+        // 损坏的记录按默认配置处理并用默认值覆盖，调用者照常应用，下次启动不再报错
+        ESP_LOGW(TAG, "Saved configuration is corrupted (%s), using defaults", esp_err_to_name(ret));
+        set_default_settings(settings);
+        repair_corrupt_config(settings);
+        return ESP_OK;
+    }
+    return ret;
+}
+
+static void early_restore_hardware_config(void)
+{
+    hardware_settings_t settings;
+    esp_err_t ret = read_hardware_config_from_nvs(&settings);
+    boot_profile_mark("config_read");
+
+    if (ret == ESP_ERR_NOT_FOUND) {
+        ESP_LOGI(TAG, "No saved hardware configuration, keeping defaults");
+        return;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Early restore skipped, NVS read failed: %s", esp_err_to_name(ret));
+        return;
+    }
+
+    ret = hardware_apply_settings(&settings);
+    boot_profile_mark("config_restore");
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Early restore failed: %s", esp_err_to_name(ret));
+        return;
+    }
+
+    set_persisted_settings(&settings);
+
+    ESP_LOGI(TAG, "Hardware configuration restored at boot (fan %d%%)", settings.fan_speed);
+}
+
+static void set_persisted_settings(const hardware_settings_t *settings)
+{
+    s_persisted = *settings;
+    s_persisted_valid = true;
+}
+
+static bool settings_equal(const hardware_settings_t *a, const hardware_settings_t *b)
+{
+    return a->fan_speed == b->fan_speed &&
+           a->board_led_color.red == b->board_led_color.red &&
+           a->board_led_color.green == b->board_led_color.green &&
+           a->board_led_color.blue == b->board_led_color.blue &&
+           a->board_led_brightness == b->board_led_brightness &&
+           a->touch_led_color.red == b->touch_led_color.red &&
+           a->touch_led_color.green == b->touch_led_color.green &&
+           a->touch_led_color.blue == b->touch_led_color.blue &&
+           a->touch_led_brightness == b->touch_led_brightness;
+}
+
+static void lock_config(void)
+{
+    if (s_config_mutex != NULL) {
+        xSemaphoreTake(s_config_mutex, portMAX_DELAY);
+    }
+}
+
+static void unlock_config(void)
+{
+    if (s_config_mutex != NULL) {
+        xSemaphoreGive(s_config_mutex);
+    }
+}
+
+static esp_err_t autosave_start(void)
+{
+    if (s_autosave_task_handle == NULL) {
+        if (s_autosave_exited == NULL) {
+            s_autosave_exited = xSemaphoreCreateBinary();
+            if (s_autosave_exited == NULL) {
+                ESP_LOGE(TAG, "Failed to create autosave semaphore");
+                return ESP_ERR_NO_MEM;
+            }
+        }
+
+        s_autosave_exit = false;
+        if (xTaskCreate(autosave_task, "cfg_autosave", AUTOSAVE_TASK_STACK, NULL,
+                        AUTOSAVE_TASK_PRIORITY, &s_autosave_task_handle) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create autosave task");
+            s_autosave_task_handle = NULL;
+            return ESP_FAIL;
+        }
+    }
+
+    s_autosave.enabled = true;
+    hardware_register_settings_change_callback(autosave_settings_changed);
+    ESP_LOGI(TAG, "Autosave enabled (quiet period %" PRIu32 " ms)", s_autosave.quiet_ms);
+    return ESP_OK;
+}
+
+static void autosave_stop(void)
+{
+    hardware_register_settings_change_callback(NULL);
+
+    portENTER_CRITICAL(&s_autosave_lock);
+    s_autosave.enabled = false;
+    s_autosave.pending = false;
+    s_autosave_target_valid = false;
+    portEXIT_CRITICAL(&s_autosave_lock);
+
+    // 任务可能正在写入NVS，通知其退出并等待，等待期间不能持有配置互斥锁
+    if (s_autosave_task_handle != NULL) {
+        s_autosave_exit = true;
+        xTaskNotifyGive(s_autosave_task_handle);
+        xSemaphoreTake(s_autosave_exited, portMAX_DELAY);
+        s_autosave_task_handle = NULL;
+    }
+
+    ESP_LOGI(TAG, "Autosave disabled");
+}
+
+static void autosave_settings_changed(void)
+{
+    TaskHandle_t task = s_autosave_task_handle;
+    if (!s_autosave.enabled || task == NULL) {
+        return;
+    }
+
+    // 记录通知时的设置，静默期结束时保存它而不是届时的硬件状态
+    hardware_settings_t current;
+    if (hardware_get_settings(&current) != ESP_OK) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_autosave_lock);
+    s_autosave.change_events++;
+    bool changed = !s_autosave_target_valid || !settings_equal(&current, &s_autosave_target);
+    if (changed) {
+        s_autosave_target = current;
+        s_autosave_target_valid = true;
+        s_autosave.pending = true;
+    } else {
+        s_autosave.noop_events++;
+    }
+    portEXIT_CRITICAL(&s_autosave_lock);
+
+    if (changed) {
+        xTaskNotifyGive(task);
+    }
+}
+
+static esp_err_t autosave_commit(void)
+{
+    lock_config();
+
+    portENTER_CRITICAL(&s_autosave_lock);
+    bool pending = s_autosave.pending && s_autosave.enabled;
+    hardware_settings_t target = s_autosave_target;
+    s_autosave.pending = false;
+    portEXIT_CRITICAL(&s_autosave_lock);
+
+    if (!pending) {
+        unlock_config();
+        return ESP_OK;
+    }
+
+    esp_err_t ret = ESP_OK;
+    if (s_persisted_valid && settings_equal(&target, &s_persisted)) {
+        // 改了又改回来，或加载后未修改
+        s_autosave.unchanged_skips++;
+        ESP_LOGD(TAG, "Autosave skipped, settings unchanged");
+    } else {
+        ret = save_hardware_config_to_nvs(&target);
+        if (ret == ESP_OK) {
+            s_autosave.commits++;
+            s_autosave.bytes_written += sizeof(config_blob_t);
+            s_autosave.entries_written += CONFIG_BLOB_NVS_ENTRIES;
+            s_autosave.last_commit_us = esp_timer_get_time();
+        }
+    }
+
+    if (ret != ESP_OK) {
+        s_autosave.failures++;
+        ESP_LOGW(TAG, "Autosave failed: %s", esp_err_to_name(ret));
+    }
+
+    unlock_config();
+    return ret;
+}
+
+static void autosave_task(void *pvParameters)
+{
+    while (!s_autosave_exit) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (s_autosave_exit) {
+            break;
+        }
+        TickType_t first_change = xTaskGetTickCount();
+
+        // 静默期内有新变化则重新计时，持续变化时最多推迟 DEVICE_AUTOSAVE_MAX_DELAY_MS
+        while (!s_autosave_exit && ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(s_autosave.quiet_ms)) > 0) {
+            if (xTaskGetTickCount() - first_change >= pdMS_TO_TICKS(DEVICE_AUTOSAVE_MAX_DELAY_MS)) {
+                break;
+            }
+        }
+
+        if (!s_autosave_exit) {
+            autosave_commit();
+        }
+    }
+
+    xSemaphoreGive(s_autosave_exited);
+    vTaskDelete(NULL);
+}
+
+static void load_profile_index(void)
+{
+    s_profile_count = 0;
+
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_PROFILE_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;  // 尚未保存过档案
+    }
+
+    nvs_iterator_t it = NULL;
+    esp_err_t ret = nvs_entry_find(NVS_DEFAULT_PART_NAME, NVS_PROFILE_NAMESPACE, NVS_TYPE_BLOB, &it);
+    while (ret == ESP_OK && s_profile_count < DEVICE_PROFILE_MAX_COUNT) {
+        nvs_entry_info_t info;
+        nvs_entry_info(it, &info);
+
+        device_profile_t *profile = &s_profiles[s_profile_count];
+        set_default_settings(&profile->settings);
+        if (is_valid_profile_name(info.key) &&
+            read_config_blob(nvs_handle, info.key, &profile->settings) == ESP_OK) {
+            snprintf(profile->name, sizeof(profile->name), "%s", info.key);
+            s_profile_count++;
+        } else {
+            ESP_LOGW(TAG, "Skipping invalid profile '%s'", info.key);
+        }
+        ret = nvs_entry_next(&it);
+    }
+    nvs_release_iterator(it);
+    nvs_close(nvs_handle);
+
+    ESP_LOGI(TAG, "Loaded %" PRIu32 " configuration profiles", s_profile_count);
+}
+
+static int find_profile(const char *name)
+{
+    for (uint32_t i = 0; i < s_profile_count; i++) {
+        if (strcmp(s_profiles[i].name, name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static bool is_valid_profile_name(const char *name)
+{
+    if (name == NULL) {
+        return false;
+    }
+    size_t len = strlen(name);
+    return len > 0 && len <= DEVICE_PROFILE_NAME_MAX_LEN;
+}
+
+static uint8_t lerp_u8(uint8_t from, uint8_t to, uint32_t step, uint32_t steps)
+{
+    return (uint8_t)((int32_t)from + ((int32_t)to - (int32_t)from) * (int32_t)step / (int32_t)steps);
+}
+
+static void interpolate_settings(const hardware_settings_t *from, const hardware_settings_t *to,
+                                 uint32_t step, uint32_t steps, hardware_settings_t *out)
+{
+    out->fan_speed = lerp_u8(from->fan_speed, to->fan_speed, step, steps);
+    out->board_led_color.red = lerp_u8(from->board_led_color.red, to->board_led_color.red, step, steps);
+    out->board_led_color.green = lerp_u8(from->board_led_color.green, to->board_led_color.green, step, steps);
+    out->board_led_color.blue = lerp_u8(from->board_led_color.blue, to->board_led_color.blue, step, steps);
+    out->board_led_brightness = lerp_u8(from->board_led_brightness, to->board_led_brightness, step, steps);
+    out->touch_led_color.red = lerp_u8(from->touch_led_color.red, to->touch_led_color.red, step, steps);
+    out->touch_led_color.green = lerp_u8(from->touch_led_color.green, to->touch_led_color.green, step, steps);
+    out->touch_led_color.blue = lerp_u8(from->touch_led_color.blue, to->touch_led_color.blue, step, steps);
+    out->touch_led_brightness = lerp_u8(from->touch_led_brightness, to->touch_led_brightness, step, steps);
+}
+
+static void set_default_settings(hardware_settings_t *settings)
+{
+    settings->fan_speed = 0;
+    settings->board_led_color = (led_color_t){0};
+    settings->touch_led_color = (led_color_t){0};
+    settings->board_led_brightness = DEFAULT_LED_BRIGHTNESS;
+    settings->touch_led_brightness = DEFAULT_LED_BRIGHTNESS;
+}
+
+static esp_err_t write_config_blob(nvs_handle_t nvs_handle, const char *key, const hardware_settings_t *settings)
+{
+    config_blob_t blob = {
+        .header = {
+            .magic = CONFIG_BLOB_MAGIC,
+            .version = CONFIG_BLOB_VERSION,
+            .payload_len = sizeof(config_payload_t),
+        },
+        .payload = {
+            .fan_speed = settings->fan_speed,
+            .board_led_r = settings->board_led_color.red,
+            .board_led_g = settings->board_led_color.green,
+            .board_led_b = settings->board_led_color.blue,
+            .board_brightness = settings->board_led_brightness,
+            .touch_led_r = settings->touch_led_color.red,
+            .touch_led_g = settings->touch_led_color.green,
+            .touch_led_b = settings->touch_led_color.blue,
+            .touch_brightness = settings->touch_led_brightness,
+        },
+    };
+    blob.header.crc16 = esp_rom_crc16_le(0, (const uint8_t *)&blob.payload, sizeof(blob.payload));
+
+    return nvs_set_blob(nvs_handle, key, &blob, sizeof(blob));
+}
+
+static esp_err_t read_config_blob(nvs_handle_t nvs_handle, const char *key, hardware_settings_t *settings)
+{
+    uint8_t buffer[CONFIG_BLOB_MAX_SIZE];
+    size_t length = sizeof(buffer);
+
+    esp_err_t ret = nvs_get_blob(nvs_handle, key, buffer, &length);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (ret == ESP_ERR_NVS_INVALID_LENGTH) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (ret != ESP_OK) {
         return ret;
     }
 
-    // 保存配置
-    ret = nvs_set_u8(nvs_handle, "fan_speed", status.fan_speed);
+    config_blob_header_t header;
+    if (length < sizeof(header)) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    memcpy(&header, buffer, sizeof(header));
+
+    if (header.magic != CONFIG_BLOB_MAGIC || header.version == 0 ||
+        sizeof(header) + header.payload_len > length) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    const uint8_t *payload_bytes = buffer + sizeof(header);
+    if (esp_rom_crc16_le(0, payload_bytes, header.payload_len) != header.crc16) {
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    if (header.version > CONFIG_BLOB_VERSION) {
+        ESP_LOGI(TAG, "Configuration written by newer format v%d, reading known fields", header.version);
+    }
+
+    // 只复制双方都认识的部分，缺少的字段保持默认值
+    config_payload_t payload = {
+        .fan_speed = settings->fan_speed,
+        .board_brightness = settings->board_led_brightness,
+        .touch_brightness = settings->touch_led_brightness,
+    };
+    size_t known = header.payload_len < sizeof(payload) ? header.payload_len : sizeof(payload);
+    memcpy(&payload, payload_bytes, known);
+
+    settings->fan_speed = payload.fan_speed;
+    settings->board_led_color = (led_color_t){payload.board_led_r, payload.board_led_g, payload.board_led_b};
+    settings->board_led_brightness = payload.board_brightness;
+    settings->touch_led_color = (led_color_t){payload.touch_led_r, payload.touch_led_g, payload.touch_led_b};
+    settings->touch_led_brightness = payload.touch_brightness;
+    return ESP_OK;
+}
+
+static esp_err_t write_legacy_keys(nvs_handle_t nvs_handle, const hardware_settings_t *settings)
+{
+    esp_err_t ret = nvs_set_u8(nvs_handle, "fan_speed", settings->fan_speed);
     if (ret == ESP_OK) {
-        ret = nvs_set_u8(nvs_handle, "board_led_r", status.board_led_color.red);
+        ret = nvs_set_u8(nvs_handle, "board_led_r", settings->board_led_color.red);
     }
     if (ret == ESP_OK) {
-        ret = nvs_set_u8(nvs_handle, "board_led_g", status.board_led_color.green);
+        ret = nvs_set_u8(nvs_handle, "board_led_g", settings->board_led_color.green);
     }
     if (ret == ESP_OK) {
-        ret = nvs_set_u8(nvs_handle, "board_led_b", status.board_led_color.blue);
+        ret = nvs_set_u8(nvs_handle, "board_led_b", settings->board_led_color.blue);
     }
     if (ret == ESP_OK) {
-        ret = nvs_set_u8(nvs_handle, "board_bright", status.board_led_brightness);
+        ret = nvs_set_u8(nvs_handle, "board_bright", settings->board_led_brightness);
     }
     if (ret == ESP_OK) {
-        ret = nvs_set_u8(nvs_handle, "touch_led_r", status.touch_led_color.red);
+        ret = nvs_set_u8(nvs_handle, "touch_led_r", settings->touch_led_color.red);
     }
     if (ret == ESP_OK) {
-        ret = nvs_set_u8(nvs_handle, "touch_led_g", status.touch_led_color.green);
+        ret = nvs_set_u8(nvs_handle, "touch_led_g", settings->touch_led_color.green);
     }
     if (ret == ESP_OK) {
-        ret = nvs_set_u8(nvs_handle, "touch_led_b", status.touch_led_color.blue);
+        ret = nvs_set_u8(nvs_handle, "touch_led_b", settings->touch_led_color.blue);
     }
     if (ret == ESP_OK) {
-        ret = nvs_set_u8(nvs_handle, "touch_bright", status.touch_led_brightness);
+        ret = nvs_set_u8(nvs_handle, "touch_bright", settings->touch_led_brightness);
     }
+    return ret;
+}
 
-    if (ret == ESP_OK) {
-        ret = nvs_commit(nvs_handle);
+static esp_err_t read_legacy_keys(nvs_handle_t nvs_handle, hardware_settings_t *settings)
+{
+    struct {
+        const char *key;
+        uint8_t *value;
+    } keys[] = {
+        { "fan_speed",    &settings->fan_speed },
+        { "board_led_r",  &settings->board_led_color.red },
+        { "board_led_g",  &settings->board_led_color.green },
+        { "board_led_b",  &settings->board_led_color.blue },
+        { "board_bright", &settings->board_led_brightness },
+        { "touch_led_r",  &settings->touch_led_color.red },
+        { "touch_led_g",  &settings->touch_led_color.green },
+        { "touch_led_b",  &settings->touch_led_color.blue },
+        { "touch_bright", &settings->touch_led_brightness },
+    };
+
+    int found = 0;
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        esp_err_t ret = nvs_get_u8(nvs_handle, keys[i].key, keys[i].value);
         if (ret == ESP_OK) {
-            ESP_LOGI(TAG, "Hardware configuration saved to NVS");
+            found++;
+        } else if (ret != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGE(TAG, "Failed to read legacy key %s: %s", keys[i].key, esp_err_to_name(ret));
+            return ret;
         }
     }
 
+    return found > 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+static esp_err_t migrate_legacy_config(const hardware_settings_t *settings)
+{
+    static const char *legacy_keys[] = {
+        "fan_speed", "board_led_r", "board_led_g", "board_led_b", "board_bright",
+        "touch_led_r", "touch_led_g", "touch_led_b", "touch_bright",
+    };
+
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save configuration: %s", esp_err_to_name(ret));
+        ESP_LOGW(TAG, "Legacy config migration skipped: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // 先写入新记录，成功后才删除旧键；中途掉电时新记录已有效，残留的旧键不再被读取
+    ret = write_config_blob(nvs_handle, CONFIG_BLOB_KEY, settings);
+    if (ret == ESP_OK) {
+        for (size_t i = 0; i < sizeof(legacy_keys) / sizeof(legacy_keys[0]); i++) {
+            nvs_erase_key(nvs_handle, legacy_keys[i]);
+        }
+        ret = nvs_commit(nvs_handle);
+    }
+
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Legacy configuration keys migrated to versioned record");
+    } else {
+        ESP_LOGW(TAG, "Legacy config migration failed: %s", esp_err_to_name(ret));
     }
 
     nvs_close(nvs_handle);
     return ret;
 }
 
-static esp_err_t load_hardware_config_from_nvs(void)
+static esp_err_t repair_corrupt_config(const hardware_settings_t *settings)
 {
-    if (!s_config.enable_hardware_control) {
-        ESP_LOGW(TAG, "Hardware control disabled, skipping config load");
-        return ESP_OK;
-    }
-
     nvs_handle_t nvs_handle;
-    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        ESP_LOGW(TAG, "Corrupted config not rewritten: %s", esp_err_to_name(ret));
         return ret;
     }
 
-    uint8_t fan_speed = 0;
-    led_color_t board_color = {0};
-    led_color_t touch_color = {0};
-    uint8_t board_brightness = 50;
-    uint8_t touch_brightness = 50;
+    ret = write_config_blob(nvs_handle, CONFIG_BLOB_KEY, settings);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs_handle);
+    }
 
-    // 加载配置
-    nvs_get_u8(nvs_handle, "fan_speed", &fan_speed);
-    nvs_get_u8(nvs_handle, "board_led_r", &board_color.red);
-    nvs_get_u8(nvs_handle, "board_led_g", &board_color.green);
-    nvs_get_u8(nvs_handle, "board_led_b", &board_color.blue);
-    nvs_get_u8(nvs_handle, "board_bright", &board_brightness);
-    nvs_get_u8(nvs_handle, "touch_led_r", &touch_color.red);
-    nvs_get_u8(nvs_handle, "touch_led_g", &touch_color.green);
-    nvs_get_u8(nvs_handle, "touch_led_b", &touch_color.blue);
-    nvs_get_u8(nvs_handle, "touch_bright", &touch_brightness);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Corrupted configuration record replaced with defaults");
+    } else {
+        ESP_LOGW(TAG, "Corrupted config not rewritten: %s", esp_err_to_name(ret));
+    }
 
     nvs_close(nvs_handle);
+    return ret;
+}
 
-    // 应用配置
-    fan_set_speed(fan_speed);
-    board_led_set_brightness(board_brightness);
-    board_led_set_color(board_color);
-    touch_led_set_brightness(touch_brightness);
-    touch_led_set_color(touch_color);
+static void trigger_event(device_event_t event, const void *data, size_t len)
+{
+    if (event_bus_publish(EVENT_BUS_SOURCE_DEVICE, event, data, len) == ESP_OK) {
+        return;
+    }
 
-    ESP_LOGI(TAG, "Hardware configuration loaded from NVS");
-    return ESP_OK;
+    if (s_event_callback != NULL) {
+        s_event_callback(event, (void *)data);
+    }
 }
 
-static void trigger_event(device_event_t event, void *data)
+static void bus_event_handler(const event_bus_event_t *event, void *ctx)
 {
-    if (s_event_callback != NULL) {
-        s_event_callback(event, data);
+    device_event_cb_t callback = s_event_callback;
+    if (callback != NULL) {
+        callback((device_event_t)event->id, event->data_len > 0 ? (void *)event->data : NULL);
+    }
+}
+
+// ==================== 基准测试用例 ====================
+
+static void register_benchmarks(void)
+{
+    const bench_case_t cases[] = {
+        // 每次操作都提交一次，反复运行会磨损闪存
+        { .name = "nvs_save", .description = "配置记录写入并提交NVS", .op = bench_nvs_save,
+          .setup = bench_nvs_open, .teardown = bench_nvs_close, .default_iterations = 100,
+          .side_effects = true },
+        { .name = "nvs_load", .description = "配置记录从NVS读取并校验", .op = bench_nvs_load,
+          .setup = bench_nvs_open, .teardown = bench_nvs_close, .default_iterations = 1000 },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        // 重复初始化时同名用例已存在，忽略
+        bench_register(&cases[i]);
+    }
+}
+
+static esp_err_t bench_nvs_open(void *ctx)
+{
+    (void)ctx;
+    // 与 device_config_benchmark 共用独立命名空间，不影响已保存的配置
+    esp_err_t ret = nvs_open(NVS_BENCH_NAMESPACE, NVS_READWRITE, &s_bench_nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 读取测试需要已有记录
+    hardware_settings_t settings;
+    set_default_settings(&settings);
+    ret = write_config_blob(s_bench_nvs, CONFIG_BLOB_KEY, &settings);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(s_bench_nvs);
     }
+    if (ret != ESP_OK) {
+        nvs_close(s_bench_nvs);
+    }
+    return ret;
+}
+
+static esp_err_t bench_nvs_close(void *ctx)
+{
+    (void)ctx;
+    nvs_erase_all(s_bench_nvs);
+    esp_err_t ret = nvs_commit(s_bench_nvs);
+    nvs_close(s_bench_nvs);
+    return ret;
+}
+
+static esp_err_t bench_nvs_save(void *ctx, uint32_t iteration)
+{
+    (void)ctx;
+    // 每次改变内容，相同数据会被NVS跳过写入
+    hardware_settings_t settings;
+    set_default_settings(&settings);
+    settings.fan_speed = iteration % 101;
+    settings.board_led_color.red = (uint8_t)iteration;
+
+    esp_err_t ret = write_config_blob(s_bench_nvs, CONFIG_BLOB_KEY, &settings);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(s_bench_nvs);
+    }
+    return ret;
+}
+
+static esp_err_t bench_nvs_load(void *ctx, uint32_t iteration)
+{
+    (void)ctx;
+    (void)iteration;
+    hardware_settings_t settings;
+    set_default_settings(&settings);
+    return read_config_blob(s_bench_nvs, CONFIG_BLOB_KEY, &settings);
 }
@@ -13,6 +13,7 @@
 #include "esp_err.h"
 #include "hardware_control.h"
 #include "system_monitor.h"
+#include "power_manager.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,6 +25,19 @@ extern "C" {
 #define DEVICE_INTERFACE_VERSION_MINOR 0
 #define DEVICE_INTERFACE_VERSION_PATCH 0
 
+// ==================== 自动保存配置 ====================
+
+#define DEVICE_AUTOSAVE_DEFAULT_QUIET_MS    3000    /*!< 默认静默期 (ms) */
+#define DEVICE_AUTOSAVE_MIN_QUIET_MS        100     /*!< 最短静默期 (ms) */
+#define DEVICE_AUTOSAVE_MAX_DELAY_MS        30000   /*!< 持续变化时最长推迟保存的时间 (ms) */
+
+// ==================== 配置档案配置 ====================
+
+#define DEVICE_PROFILE_MAX_COUNT            8       /*!< 最多保存的档案数 */
+#define DEVICE_PROFILE_NAME_MAX_LEN         15      /*!< 档案名最大长度 (NVS键名限制) */
+#define DEVICE_PROFILE_FADE_STEP_MS         20      /*!< 渐变时每步间隔 (ms) */
+#define DEVICE_PROFILE_MAX_FADE_MS          10000   /*!< 最长渐变时间 (ms) */
+
 // ==================== 类型定义 ====================
 
 /**
@@ -32,6 +46,11 @@ extern "C" {
 typedef struct {
     bool enable_hardware_control;       /*!< 是否启用硬件控制 */
     bool enable_system_monitor;         /*!< 是否启用系统监控 */
+    bool enable_early_restore;          /*!< 初始化时是否立即恢复NVS中保存的硬件设置 */
+    bool enable_autosave;               /*!< 硬件设置变化后是否自动保存到NVS */
+    uint32_t autosave_quiet_ms;         /*!< 自动保存静默期 (ms)，最后一次变化后经过该时间才写入 */
+    bool enable_power_management;       /*!< 是否启用动态调频与自动浅睡眠 */
+    power_manager_config_t power_config;    /*!< 电源管理配置 */
     system_monitor_config_t monitor_config; /*!< 系统监控配置 */
 } device_interface_config_t;
 
@@ -46,6 +65,42 @@ typedef struct {
     uint32_t interface_version;     /*!< 接口版本 */
 } device_status_t;
 
+/**
+ * @brief 自动保存统计
+ */
+typedef struct {
+    bool enabled;                   /*!< 是否启用自动保存 */
+    bool pending;                   /*!< 是否有尚未处理的变化 */
+    uint32_t quiet_ms;              /*!< 当前静默期 (ms) */
+    uint32_t change_events;         /*!< 收到的设置变化次数 */
+    uint32_t noop_events;           /*!< 其中与上次通知的设置相同的次数 */
+    uint32_t commits;               /*!< 自动保存实际写入NVS的次数 */
+    uint32_t unchanged_skips;       /*!< 静默期结束时与已保存内容相同而跳过写入的次数 */
+    uint32_t writes_avoided;        /*!< 相比每次实际变化都保存少写的次数 */
+    uint32_t failures;              /*!< 写入失败次数 */
+    uint32_t bytes_written;         /*!< 写入的配置记录字节数 */
+    uint32_t entries_written;       /*!< 估算写入的NVS条目数 (32字节/条) */
+    uint32_t entries_avoided;       /*!< 估算少写的NVS条目数 */
+    int64_t last_commit_us;         /*!< 最近一次自动保存时间 (us)，0表示尚未保存 */
+} device_autosave_stats_t;
+
+/**
+ * @brief 配置档案
+ */
+typedef struct {
+    char name[DEVICE_PROFILE_NAME_MAX_LEN + 1]; /*!< 档案名 */
+    hardware_settings_t settings;               /*!< 风扇与LED设置 */
+} device_profile_t;
+
+/**
+ * @brief 档案切换结果
+ */
+typedef struct {
+    uint32_t first_commit_us;       /*!< 从调用到第一次硬件提交完成的时间 (us) */
+    uint32_t total_us;              /*!< 从调用到目标状态完全生效的时间 (us)，含渐变 */
+    uint32_t steps;                 /*!< 硬件提交次数，不渐变时为1 */
+} device_profile_switch_result_t;
+
 /**
  * @brief 设备事件类型
  */
@@ -70,11 +125,19 @@ typedef void (*device_event_cb_t)(device_event_t event, void *data);
 #define DEVICE_INTERFACE_DEFAULT_CONFIG() { \
     .enable_hardware_control = true, \
     .enable_system_monitor = true, \
+    .enable_early_restore = true, \
+    .enable_autosave = true, \
+    .autosave_quiet_ms = DEVICE_AUTOSAVE_DEFAULT_QUIET_MS, \
+    .enable_power_management = true, \
+    .power_config = POWER_MANAGER_DEFAULT_CONFIG(), \
     .monitor_config = { \
         .monitor_interval_ms = SYSTEM_MONITOR_DEFAULT_INTERVAL_MS, \
         .memory_warning_threshold = SYSTEM_MONITOR_DEFAULT_MEMORY_THRESHOLD, \
         .enable_auto_monitoring = true, \
-        .warning_cb = NULL \
+        .warning_cb = NULL, \
+        .thresholds = SYSTEM_MONITOR_DEFAULT_THRESHOLDS(), \
+        .alarm_cb = NULL, \
+        .enable_periodic_check = true \
     } \
 }
 
@@ -109,6 +172,8 @@ bool device_interface_is_initialized(void);
 /**
  * @brief 注册设备事件回调函数
  * 
+ * 回调在事件总线的分发任务中执行，data 指向事件负载的副本，仅在回调期间有效
+ * 
  * @param callback 回调函数指针
  * @return
  *     - ESP_OK: 注册成功
@@ -133,6 +198,8 @@ esp_err_t device_quick_setup(uint8_t fan_speed, led_color_t board_led_color, led
 /**
  * @brief 关闭所有设备
  * 
+ * 关闭状态不触发自动保存，已保存的设置保持不变
+ * 
  * @return
  *     - ESP_OK: 关闭成功
  *     - ESP_FAIL: 关闭失败
@@ -142,6 +209,8 @@ esp_err_t device_shutdown_all(void);
 /**
  * @brief 重置所有设备到默认状态
  * 
+ * 与 device_shutdown_all() 相同，不触发自动保存
+ * 
  * @return
  *     - ESP_OK: 重置成功
  *     - ESP_FAIL: 重置失败
@@ -151,6 +220,9 @@ esp_err_t device_reset_to_default(void);
 /**
  * @brief 设备睡眠模式（关闭非必要设备）
  * 
+ * 关闭风扇和LED并停止系统监控。启用电源管理时，风扇PM锁随之释放，
+ * 空闲期间芯片自动进入浅睡眠，由控制台UART输入、GPIO或定时器唤醒
+ * 
  * @return
  *     - ESP_OK: 进入睡眠模式成功
  *     - ESP_FAIL: 进入睡眠模式失败
@@ -229,10 +301,14 @@ esp_err_t device_run_quick_test(void);
 /**
  * @brief 运行设备压力测试
  * 
- * @param duration_ms 测试持续时间 (ms)
+ * 按固定时长依次运行全部已注册的基准测试（见 bench.h），总时长平均分给每个用例，
+ * 打印吞吐量与延迟结果
+ * 
+ * @param duration_ms 测试总时长 (ms)
  * @return
  *     - ESP_OK: 压力测试通过
- *     - ESP_FAIL: 压力测试失败
+ *     - ESP_ERR_INVALID_ARG: 时长不足每个用例1ms
+ *     - ESP_FAIL: 有用例运行失败
  */
 esp_err_t device_run_stress_test(uint32_t duration_ms);
 
@@ -265,6 +341,155 @@ esp_err_t device_load_config(void);
  */
 esp_err_t device_clear_config(void);
 
+/**
+ * @brief 对比旧的按键保存与单条版本化记录的NVS读写耗时和写入条目数
+ * 
+ * 在独立的NVS命名空间中进行，不影响已保存的配置
+ * 
+ * @param iterations 每种方案的保存/读取次数，0使用默认值
+ * @return
+ *     - ESP_OK: 测试完成
+ *     - 其他: NVS操作失败
+ */
+esp_err_t device_config_benchmark(uint32_t iterations);
+
+// ==================== 配置档案接口 ====================
+
+/*
+ * 命名档案（如 quiet、burn-in、recovery）以与启动配置相同的带CRC记录格式
+ * 保存在独立的NVS命名空间中，初始化时全部读入内存索引，切换档案不读NVS。
+ * 每次切换（或渐变的每一步）通过 hardware_apply_settings() 一次性提交风扇与两条LED。
+ */
+
+/**
+ * @brief 把当前风扇与LED设置保存为命名档案，同名档案被覆盖
+ * 
+ * @param name 档案名，1-15个字符
+ * @return
+ *     - ESP_OK: 保存成功
+ *     - ESP_ERR_INVALID_ARG: 档案名无效
+ *     - ESP_ERR_INVALID_STATE: 设备接口未初始化或硬件控制不可用
+ *     - ESP_ERR_NO_MEM: 档案数已达上限
+ *     - 其他: NVS写入失败
+ */
+esp_err_t device_profile_save(const char *name);
+
+/**
+ * @brief 删除命名档案
+ * 
+ * @param name 档案名
+ * @return
+ *     - ESP_OK: 删除成功
+ *     - ESP_ERR_INVALID_ARG: 档案名无效
+ *     - ESP_ERR_INVALID_STATE: 设备接口未初始化或硬件控制不可用
+ *     - ESP_ERR_NOT_FOUND: 档案不存在
+ *     - 其他: NVS操作失败
+ */
+esp_err_t device_profile_delete(const char *name);
+
+/**
+ * @brief 切换到命名档案
+ * 
+ * fade_ms 为0时一次提交；否则每 DEVICE_PROFILE_FADE_STEP_MS 提交一次线性插值的
+ * 中间状态，LED颜色与亮度渐变、风扇速度斜坡变化，调用在渐变完成后返回。
+ * 中间状态作为临时事务提交，只有最终状态触发设置变化回调（自动保存）。
+ * 
+ * @param name 档案名
+ * @param fade_ms 渐变时间 (ms)，不超过 DEVICE_PROFILE_MAX_FADE_MS
+ * @param result 存储切换耗时的指针，可为NULL
+ * @return
+ *     - ESP_OK: 切换成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 设备接口未初始化或硬件控制不可用
+ *     - ESP_ERR_NOT_FOUND: 档案不存在
+ */
+esp_err_t device_profile_apply(const char *name, uint32_t fade_ms, device_profile_switch_result_t *result);
+
+/**
+ * @brief 获取档案数
+ * 
+ * @return 档案数
+ */
+uint32_t device_profile_get_count(void);
+
+/**
+ * @brief 按序号获取档案
+ * 
+ * @param index 档案序号
+ * @param profile 存储档案的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NOT_FOUND: 没有该档案
+ */
+esp_err_t device_profile_get(uint32_t index, device_profile_t *profile);
+
+/**
+ * @brief 打印档案列表
+ * 
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t device_profile_print_list(void);
+
+// ==================== 自动保存接口 ====================
+
+/*
+ * 风扇/LED设置变化后不立即写入NVS，而是等待静默期内不再有新变化后再保存一次，
+ * 脚本连续发出的大量设置命令只产生一次写入。保存前与最近一次保存/加载的内容比较，
+ * 相同则不写入。持续变化时最多推迟 DEVICE_AUTOSAVE_MAX_DELAY_MS 保存一次。
+ */
+
+/**
+ * @brief 启用或禁用自动保存
+ * 
+ * 禁用时丢弃尚未保存的变化
+ * 
+ * @param enable true启用, false禁用
+ * @return
+ *     - ESP_OK: 设置成功
+ *     - ESP_ERR_INVALID_STATE: 设备接口未初始化或硬件控制不可用
+ */
+esp_err_t device_autosave_enable(bool enable);
+
+/**
+ * @brief 设置自动保存静默期
+ * 
+ * @param quiet_ms 静默期 (ms)，范围 DEVICE_AUTOSAVE_MIN_QUIET_MS ~ DEVICE_AUTOSAVE_MAX_DELAY_MS
+ * @return
+ *     - ESP_OK: 设置成功
+ *     - ESP_ERR_INVALID_ARG: 超出范围
+ */
+esp_err_t device_autosave_set_quiet_period(uint32_t quiet_ms);
+
+/**
+ * @brief 立即保存尚未保存的变化，不等待静默期
+ * 
+ * @return
+ *     - ESP_OK: 保存成功或没有需要保存的变化
+ *     - ESP_ERR_INVALID_STATE: 设备接口未初始化
+ *     - 其他: NVS写入失败
+ */
+esp_err_t device_autosave_flush(void);
+
+/**
+ * @brief 获取自动保存统计
+ * 
+ * @param stats 存储统计的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t device_autosave_get_stats(device_autosave_stats_t *stats);
+
+/**
+ * @brief 打印自动保存统计和估算的闪存磨损
+ * 
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t device_autosave_print_stats(void);
+
 // ==================== 便捷宏定义 ====================
 
 /**
@@ -0,0 +1,384 @@
+/**
+ * @file event_bus.c
+ * @brief ESP32S3 异步事件总线实现
+ */
+
+#include "event_bus.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "EVENT_BUS";
+
+#define DISPATCH_TASK_STACK     3072
+#define DISPATCH_TASK_PRIORITY  2
+
+/**
+ * @brief 订阅者
+ */
+typedef struct {
+    bool active;
+    char name[EVENT_BUS_NAME_LEN];
+    uint32_t source_mask;
+    uint32_t queue_len;
+    QueueHandle_t queue;
+    event_bus_handler_t handler;
+    void *ctx;
+
+    // 发布者在持有互斥锁时更新
+    uint32_t max_depth;
+    uint32_t dropped;
+
+    // 仅分发任务更新
+    uint32_t delivered;
+    uint64_t latency_sum_us;
+    uint32_t max_latency_us;
+    uint32_t max_handler_us;
+} subscriber_t;
+
+// ==================== 静态变量 ====================
+
+static bool s_initialized = false;
+static SemaphoreHandle_t s_mutex = NULL;        // 保护订阅者表，处理函数执行期间不持有
+static TaskHandle_t s_dispatch_task_handle = NULL;
+static subscriber_t s_subscribers[EVENT_BUS_MAX_SUBSCRIBERS];
+static uint32_t s_published = 0;
+static uint32_t s_unrouted = 0;
+static uint32_t s_dropped = 0;
+
+// ==================== 静态函数声明 ====================
+
+static void dispatch_task(void *pvParameters);
+static bool dispatch_one(int index);
+
+// ==================== 初始化接口实现 ====================
+
+esp_err_t event_bus_init(void)
+{
+    if (s_initialized) {
+        return ESP_OK;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (s_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(dispatch_task, "event_bus", DISPATCH_TASK_STACK, NULL,
+                    DISPATCH_TASK_PRIORITY, &s_dispatch_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create dispatch task");
+        vSemaphoreDelete(s_mutex);
+        s_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_initialized = true;
+    ESP_LOGI(TAG, "Event bus initialized");
+    return ESP_OK;
+}
+
+// ==================== 订阅接口实现 ====================
+
+esp_err_t event_bus_subscribe(const char *name, uint32_t source_mask, uint32_t queue_len,
+                              event_bus_handler_t handler, void *ctx, int *subscriber_id)
+{
+    if (handler == NULL || source_mask == 0 || queue_len > EVENT_BUS_MAX_QUEUE_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (queue_len == 0) {
+        queue_len = EVENT_BUS_DEFAULT_QUEUE_LEN;
+    }
+
+    QueueHandle_t queue = xQueueCreate(queue_len, sizeof(event_bus_event_t));
+    if (queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create queue for '%s'", name ? name : "?");
+        return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int index = -1;
+    for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
+        if (!s_subscribers[i].active) {
+            index = i;
+            break;
+        }
+    }
+
+    if (index < 0) {
+        xSemaphoreGive(s_mutex);
+        vQueueDelete(queue);
+        ESP_LOGE(TAG, "Subscriber table full");
+        return ESP_ERR_NO_MEM;
+    }
+
+    subscriber_t *sub = &s_subscribers[index];
+    memset(sub, 0, sizeof(*sub));
+    snprintf(sub->name, sizeof(sub->name), "%s", name ? name : "anonymous");
+    sub->source_mask = source_mask;
+    sub->queue_len = queue_len;
+    sub->queue = queue;
+    sub->handler = handler;
+    sub->ctx = ctx;
+    sub->active = true;
+    xSemaphoreGive(s_mutex);
+
+    if (subscriber_id != NULL) {
+        *subscriber_id = index;
+    }
+
+    ESP_LOGI(TAG, "Subscriber '%s' added (mask 0x%08" PRIx32 ", queue %" PRIu32 ")",
+             sub->name, source_mask, queue_len);
+    return ESP_OK;
+}
+
+esp_err_t event_bus_unsubscribe(int subscriber_id)
+{
+    if (!s_initialized || subscriber_id < 0 || subscriber_id >= EVENT_BUS_MAX_SUBSCRIBERS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    subscriber_t *sub = &s_subscribers[subscriber_id];
+    if (!sub->active) {
+        xSemaphoreGive(s_mutex);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sub->active = false;
+    vQueueDelete(sub->queue);
+    sub->queue = NULL;
+    xSemaphoreGive(s_mutex);
+
+    ESP_LOGI(TAG, "Subscriber '%s' removed", sub->name);
+    return ESP_OK;
+}
+
+// ==================== 发布接口实现 ====================
+
+esp_err_t event_bus_publish(uint16_t source, uint16_t id, const void *data, size_t len)
+{
+    // 持有互斥锁，不能在ISR中发布（见 event_bus.h 的限制说明）
+    configASSERT(!xPortInIsrContext());
+
+    if (source >= EVENT_BUS_SOURCE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    event_bus_event_t event = {
+        .timestamp_us = esp_timer_get_time(),
+        .source = source,
+        .id = id,
+        .data_len = 0,
+    };
+    if (data != NULL && len > 0) {
+        event.data_len = len < EVENT_BUS_DATA_SIZE ? len : EVENT_BUS_DATA_SIZE;
+        memcpy(event.data, data, event.data_len);
+    }
+
+    // 只做非阻塞入队，持锁时间与处理函数无关
+    bool routed = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_published++;
+    for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
+        subscriber_t *sub = &s_subscribers[i];
+        if (!sub->active || (sub->source_mask & EVENT_BUS_SOURCE_BIT(source)) == 0) {
+            continue;
+        }
+
+        routed = true;
+        if (xQueueSend(sub->queue, &event, 0) != pdTRUE) {
+            sub->dropped++;
+            s_dropped++;
+            continue;
+        }
+
+        uint32_t depth = uxQueueMessagesWaiting(sub->queue);
+        if (depth > sub->max_depth) {
+            sub->max_depth = depth;
+        }
+    }
+    if (!routed) {
+        s_unrouted++;
+    }
+    xSemaphoreGive(s_mutex);
+
+    if (routed) {
+        xTaskNotifyGive(s_dispatch_task_handle);
+    }
+    return ESP_OK;
+}
+
+esp_err_t event_bus_publish_str(uint16_t source, uint16_t id, const char *str)
+{
+    if (str == NULL) {
+        return event_bus_publish(source, id, NULL, 0);
+    }
+
+    char buffer[EVENT_BUS_DATA_SIZE];
+    snprintf(buffer, sizeof(buffer), "%s", str);
+    return event_bus_publish(source, id, buffer, strlen(buffer) + 1);
+}
+
+// ==================== 统计接口实现 ====================
+
+esp_err_t event_bus_get_stats(event_bus_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    stats->published = s_published;
+    stats->unrouted = s_unrouted;
+    stats->dropped = s_dropped;
+    stats->subscribers = 0;
+    for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
+        if (s_subscribers[i].active) {
+            stats->subscribers++;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t event_bus_get_subscriber_stats(int subscriber_id, event_bus_subscriber_stats_t *stats)
+{
+    if (stats == NULL || subscriber_id < 0 || subscriber_id >= EVENT_BUS_MAX_SUBSCRIBERS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_initialized) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    const subscriber_t *sub = &s_subscribers[subscriber_id];
+    if (!sub->active) {
+        xSemaphoreGive(s_mutex);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    memcpy(stats->name, sub->name, sizeof(stats->name));
+    stats->source_mask = sub->source_mask;
+    stats->queue_len = sub->queue_len;
+    stats->queue_depth = uxQueueMessagesWaiting(sub->queue);
+    stats->max_depth = sub->max_depth;
+    stats->delivered = sub->delivered;
+    stats->dropped = sub->dropped;
+    stats->avg_latency_us = sub->delivered > 0 ? (uint32_t)(sub->latency_sum_us / sub->delivered) : 0;
+    stats->max_latency_us = sub->max_latency_us;
+    stats->max_handler_us = sub->max_handler_us;
+    xSemaphoreGive(s_mutex);
+    return ESP_OK;
+}
+
+void event_bus_reset_stats(void)
+{
+    if (!s_initialized) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_published = 0;
+    s_unrouted = 0;
+    s_dropped = 0;
+    for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
+        subscriber_t *sub = &s_subscribers[i];
+        sub->max_depth = 0;
+        sub->dropped = 0;
+        sub->delivered = 0;
+        sub->latency_sum_us = 0;
+        sub->max_latency_us = 0;
+        sub->max_handler_us = 0;
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+esp_err_t event_bus_print_stats(void)
+{
+    event_bus_stats_t stats;
+    event_bus_get_stats(&stats);
+
+    printf("\n=== 事件总线 ===\n");
+    printf("已发布: %" PRIu32 ", 无订阅者: %" PRIu32 ", 丢弃: %" PRIu32 ", 订阅者: %" PRIu32 "/%d\n",
+           stats.published, stats.unrouted, stats.dropped, stats.subscribers, EVENT_BUS_MAX_SUBSCRIBERS);
+
+    if (stats.subscribers > 0) {
+        printf("%-16s %9s %6s %8s %6s %12s %12s %12s\n", "订阅者", "队列", "峰值", "已处理", "丢弃",
+               "平均延迟us", "最大延迟us", "最长处理us");
+        for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
+            event_bus_subscriber_stats_t sub;
+            if (event_bus_get_subscriber_stats(i, &sub) != ESP_OK) {
+                continue;
+            }
+            printf("%-16s %4" PRIu32 "/%-4" PRIu32 " %6" PRIu32 " %8" PRIu32 " %6" PRIu32
+                   " %12" PRIu32 " %12" PRIu32 " %12" PRIu32 "\n",
+                   sub.name, sub.queue_depth, sub.queue_len, sub.max_depth, sub.delivered,
+                   sub.dropped, sub.avg_latency_us, sub.max_latency_us, sub.max_handler_us);
+        }
+    }
+    printf("================\n");
+    return ESP_OK;
+}
+
+// ==================== 静态函数实现 ====================
+
+static void dispatch_task(void *pvParameters)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // 轮询各订阅者，每轮每个订阅者最多处理一条，直到全部队列为空
+        bool pending;
+        do {
+            pending = false;
+            for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
+                pending |= dispatch_one(i);
+            }
+        } while (pending);
+    }
+}
+
+static bool dispatch_one(int index)
+{
+    subscriber_t *sub = &s_subscribers[index];
+    event_bus_event_t event;
+    event_bus_handler_t handler;
+    void *ctx;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (!sub->active || xQueueReceive(sub->queue, &event, 0) != pdTRUE) {
+        xSemaphoreGive(s_mutex);
+        return false;
+    }
+    handler = sub->handler;
+    ctx = sub->ctx;
+    xSemaphoreGive(s_mutex);
+
+    int64_t start_us = esp_timer_get_time();
+    handler(&event, ctx);
+    int64_t end_us = esp_timer_get_time();
+
+    uint32_t latency_us = (uint32_t)(start_us - event.timestamp_us);
+    uint32_t handler_us = (uint32_t)(end_us - start_us);
+    sub->delivered++;
+    sub->latency_sum_us += latency_us;
+    if (latency_us > sub->max_latency_us) {
+        sub->max_latency_us = latency_us;
+    }
+    if (handler_us > sub->max_handler_us) {
+        sub->max_handler_us = handler_us;
+    }
+    return true;
+}
@@ -0,0 +1,208 @@
+/**
+ * @file event_bus.h
+ * @brief ESP32S3 异步事件总线
+ *
+ * 发布者把事件连同时间戳和最多 EVENT_BUS_DATA_SIZE 字节的负载复制到每个订阅者
+ * 自己的有界队列后立即返回，由一个分发任务轮流从各队列取出事件调用处理函数。
+ * 处理函数再慢也不会阻塞发布者；某个订阅者的队列满时只丢弃发给它的事件并计数。
+ *
+ * 分发任务按订阅者轮询，每轮每个订阅者最多处理一条事件，
+ * 一个慢处理函数只推迟其他订阅者的投递，不会导致它们丢事件。
+ *
+ * 限制：
+ *   - 只有一个分发任务，全部处理函数在其中依次执行。某个处理函数执行期间其他订阅者
+ *     的事件只能排队（队头阻塞），分发延迟上限是其他订阅者处理函数执行时间之和。
+ *     处理函数应快速返回，耗时工作转交给自己的任务。
+ *   - 发布时持有保护订阅者表的互斥锁，只能在任务上下文调用；不能在ISR、临界区或
+ *     堆分配钩子/分配失败回调中调用（configASSERT 检查ISR上下文）。这些场景应
+ *     先通知自己的任务，再由任务发布。
+ */
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== 配置 ====================
+
+#define EVENT_BUS_MAX_SUBSCRIBERS       8       /*!< 最大订阅者数 */
+#define EVENT_BUS_DATA_SIZE             32      /*!< 事件负载最大字节数，超出部分截断 */
+#define EVENT_BUS_DEFAULT_QUEUE_LEN     8       /*!< 默认每个订阅者的队列长度 */
+#define EVENT_BUS_MAX_QUEUE_LEN         64      /*!< 每个订阅者的最大队列长度 */
+#define EVENT_BUS_NAME_LEN              16      /*!< 订阅者名称长度 (含结束符) */
+
+// ==================== 类型定义 ====================
+
+/**
+ * @brief 事件来源
+ */
+typedef enum {
+    EVENT_BUS_SOURCE_DEVICE = 0,    /*!< 设备接口 (device_event_t) */
+    EVENT_BUS_SOURCE_CONSOLE,       /*!< 控制台 (console_event_t) */
+    EVENT_BUS_SOURCE_USER = 16,     /*!< 应用自定义来源起始值 */
+    EVENT_BUS_SOURCE_MAX = 32
+} event_bus_source_t;
+
+#define EVENT_BUS_SOURCE_BIT(source)    (1UL << (source))   /*!< 来源掩码位 */
+#define EVENT_BUS_ALL_SOURCES           0xFFFFFFFFUL        /*!< 订阅全部来源 */
+
+/**
+ * @brief 事件
+ */
+typedef struct {
+    int64_t timestamp_us;               /*!< 发布时间 (esp_timer, us) */
+    uint16_t source;                    /*!< 事件来源 (event_bus_source_t) */
+    uint16_t id;                        /*!< 来源内的事件ID */
+    uint8_t data[EVENT_BUS_DATA_SIZE] __attribute__((aligned(4)));  /*!< 负载副本，4字节对齐可直接按整数读取 */
+    uint8_t data_len;                   /*!< 负载长度 */
+} event_bus_event_t;
+
+/**
+ * @brief 事件处理函数，在分发任务中执行
+ *
+ * @param event 事件，仅在调用期间有效
+ * @param ctx 订阅时传入的用户上下文
+ */
+typedef void (*event_bus_handler_t)(const event_bus_event_t *event, void *ctx);
+
+/**
+ * @brief 订阅者统计
+ */
+typedef struct {
+    char name[EVENT_BUS_NAME_LEN];  /*!< 订阅者名称 */
+    uint32_t source_mask;           /*!< 订阅的来源掩码 */
+    uint32_t queue_len;             /*!< 队列长度 */
+    uint32_t queue_depth;           /*!< 当前排队的事件数 */
+    uint32_t max_depth;             /*!< 队列深度峰值 */
+    uint32_t delivered;             /*!< 已处理的事件数 */
+    uint32_t dropped;               /*!< 队列满丢弃的事件数 */
+    uint32_t avg_latency_us;        /*!< 平均分发延迟：发布到处理函数开始 (us) */
+    uint32_t max_latency_us;        /*!< 最大分发延迟 (us) */
+    uint32_t max_handler_us;        /*!< 处理函数最长执行时间 (us) */
+} event_bus_subscriber_stats_t;
+
+/**
+ * @brief 总线统计
+ */
+typedef struct {
+    uint32_t published;             /*!< 发布的事件数 */
+    uint32_t unrouted;              /*!< 没有订阅者的事件数 */
+    uint32_t dropped;               /*!< 全部订阅者丢弃的事件数 */
+    uint32_t subscribers;           /*!< 当前订阅者数 */
+} event_bus_stats_t;
+
+// ==================== 接口 ====================
+
+/**
+ * @brief 初始化事件总线并启动分发任务，重复调用直接返回
+ *
+ * @return
+ *     - ESP_OK: 初始化成功
+ *     - ESP_ERR_NO_MEM: 内存不足
+ */
+esp_err_t event_bus_init(void);
+
+/**
+ * @brief 订阅事件
+ *
+ * @param name 订阅者名称，用于统计显示
+ * @param source_mask 订阅的来源掩码 (EVENT_BUS_SOURCE_BIT组合)
+ * @param queue_len 队列长度，0使用默认值
+ * @param handler 处理函数
+ * @param ctx 用户上下文
+ * @param subscriber_id 存储订阅者ID的指针，可为NULL
+ * @return
+ *     - ESP_OK: 订阅成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 总线未初始化
+ *     - ESP_ERR_NO_MEM: 订阅者已满或内存不足
+ */
+esp_err_t event_bus_subscribe(const char *name, uint32_t source_mask, uint32_t queue_len,
+                              event_bus_handler_t handler, void *ctx, int *subscriber_id);
+
+/**
+ * @brief 取消订阅，丢弃尚未处理的事件
+ *
+ * 分发任务正在执行该订阅者的处理函数时，该次调用仍会完成
+ *
+ * @param subscriber_id 订阅者ID
+ * @return
+ *     - ESP_OK: 取消成功
+ *     - ESP_ERR_INVALID_ARG: ID无效
+ */
+esp_err_t event_bus_unsubscribe(int subscriber_id);
+
+/**
+ * @brief 发布事件（仅任务上下文，不等待订阅者处理）
+ *
+ * 入队不等待；但需要获取订阅者表的互斥锁，订阅/取消订阅/读取统计期间会短暂等待。
+ * 在ISR中调用会触发断言。
+ *
+ * @param source 事件来源
+ * @param id 事件ID
+ * @param data 负载，可为NULL
+ * @param len 负载长度，超过 EVENT_BUS_DATA_SIZE 时截断
+ * @return
+ *     - ESP_OK: 发布成功（包括被部分订阅者丢弃的情况）
+ *     - ESP_ERR_INVALID_ARG: 来源无效
+ *     - ESP_ERR_INVALID_STATE: 总线未初始化
+ */
+esp_err_t event_bus_publish(uint16_t source, uint16_t id, const void *data, size_t len);
+
+/**
+ * @brief 发布带字符串负载的事件，过长时截断并保证以'\0'结尾
+ *
+ * @param source 事件来源
+ * @param id 事件ID
+ * @param str 字符串，可为NULL
+ * @return 同 event_bus_publish()
+ */
+esp_err_t event_bus_publish_str(uint16_t source, uint16_t id, const char *str);
+
+/**
+ * @brief 获取总线统计
+ *
+ * @param stats 存储统计的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t event_bus_get_stats(event_bus_stats_t *stats);
+
+/**
+ * @brief 获取订阅者统计
+ *
+ * @param subscriber_id 订阅者ID (0 ~ EVENT_BUS_MAX_SUBSCRIBERS-1)
+ * @param stats 存储统计的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NOT_FOUND: 该ID没有订阅者
+ */
+esp_err_t event_bus_get_subscriber_stats(int subscriber_id, event_bus_subscriber_stats_t *stats);
+
+/**
+ * @brief 清零全部统计
+ */
+void event_bus_reset_stats(void);
+
+/**
+ * @brief 打印总线与各订阅者统计
+ *
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t event_bus_print_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_BUS_H */
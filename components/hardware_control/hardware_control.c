@@ -8,19 +8,38 @@
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "driver/gpio.h"
-#include "driver/ledc.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
-#include "led_strip.h"
+#include "esp_rom_sys.h"
+#include "board_hal.h"
+#include "board_hal_time.h"
+#include "api_latency.h"
+#include "event_trace.h"
+#include "boot_profile.h"
+#include "bench.h"
 
 static const char *TAG = "HARDWARE_CONTROL";
 
+#define GPIO40_VERIFY_POLL_COUNT    100     ///< 快速启动时GPIO40回读轮询次数
+#define GPIO40_VERIFY_POLL_US       10      ///< 快速启动时GPIO40回读轮询间隔(微秒)
+#define BENCH_GPIO_PIN              BENCH_SPARE_GPIO  ///< GPIO翻转基准测试使用的引脚，未连接任何外设
+
 // ==================== 静态变量 ====================
 
 static bool s_initialized = false;
 static hardware_status_t s_hardware_status = {0};
-static led_strip_handle_t s_board_led_strip = NULL;
-static led_strip_handle_t s_touch_led_strip = NULL;
+static board_hal_led_strip_t s_board_led_strip = NULL;
+static board_hal_led_strip_t s_touch_led_strip = NULL;
+static hardware_settings_change_cb_t s_settings_change_cb = NULL;
+static SemaphoreHandle_t s_hw_lock = NULL;      ///< 串行化外设操作，递归锁（设置接口之间会互相调用）
+
+// PM锁：仅在需要全速或不能睡眠的期间持有，未启用电源管理时为NULL
+static board_hal_pm_lock_t s_led_pm_lock = NULL;     ///< LED刷新期间保持最高CPU频率
+static board_hal_pm_lock_t s_pulse_pm_lock = NULL;   ///< 电源脉冲期间禁止浅睡眠
+static board_hal_pm_lock_t s_fan_pm_lock = NULL;     ///< 风扇PWM运行期间禁止浅睡眠
+static bool s_fan_pm_lock_held = false;
+static usb_mux_target_t s_bench_mux_target = USB_MUX_ESP32S3;   ///< 基准测试前的USB MUX目标
+static volatile uint8_t s_bench_sink;                           ///< HSV基准测试的结果，防止转换被优化掉
 
 // ==================== 静态函数声明 ====================
 
@@ -29,8 +48,27 @@ static esp_err_t init_ws2812(void);
 static esp_err_t init_usb_mux_gpio(void);
 static esp_err_t init_power_control_gpio(void);
 static esp_err_t disable_jtag_for_gpio40(void);
-static esp_err_t apply_led_color(led_strip_handle_t strip, led_color_t color, uint8_t brightness, uint8_t num_leds);
+static esp_err_t apply_led_color(board_hal_led_strip_t strip, led_color_t color, uint8_t brightness, uint8_t num_leds);
 static void hsv_to_rgb(int hue, int saturation, int value, uint8_t *r, uint8_t *g, uint8_t *b);
+static void notify_settings_changed(void);
+static esp_err_t txn_apply_locked(const hw_txn_t *txn);
+static esp_err_t recovery_sequence_locked(void);
+static void hw_lock(void);
+static void hw_unlock(void);
+static void init_power_management(void);
+static void update_fan_pm_lock(uint8_t speed);
+static void register_benchmarks(void);
+static esp_err_t bench_gpio_setup(void *ctx);
+static esp_err_t bench_gpio_teardown(void *ctx);
+static esp_err_t bench_save_usb_mux(void *ctx);
+static esp_err_t bench_restore_usb_mux(void *ctx);
+static esp_err_t bench_lock_board_led(void *ctx);
+static esp_err_t bench_restore_board_led(void *ctx);
+static esp_err_t bench_gpio_toggle(void *ctx, uint32_t iteration);
+static esp_err_t bench_usb_mux_switch(void *ctx, uint32_t iteration);
+static esp_err_t bench_led_fill(void *ctx, uint32_t iteration);
+static esp_err_t bench_led_refresh(void *ctx, uint32_t iteration);
+static esp_err_t bench_hsv(void *ctx, uint32_t iteration);
 
 // ==================== 初始化接口实现 ====================
 
@@ -43,6 +81,15 @@ esp_err_t hardware_control_init(void)
 
     ESP_LOGI(TAG, "Initializing hardware control component");
 
+    // 控制台、后台任务、RPC和档案渐变可能在不同任务中同时操作外设
+    if (s_hw_lock == NULL) {
+        s_hw_lock = xSemaphoreCreateRecursiveMutex();
+        if (s_hw_lock == NULL) {
+            ESP_LOGE(TAG, "Failed to create hardware lock");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
     // 初始化状态结构体
     memset(&s_hardware_status, 0, sizeof(hardware_status_t));
     s_hardware_status.board_led_brightness = DEFAULT_LED_BRIGHTNESS;
@@ -57,6 +104,7 @@ esp_err_t hardware_control_init(void)
         ESP_LOGE(TAG, "Failed to initialize fan PWM: %s", esp_err_to_name(ret));
         return ret;
     }
+    boot_profile_mark("hw_fan_pwm");
 
     // 初始化WS2812
     ret = init_ws2812();
@@ -64,6 +112,7 @@ esp_err_t hardware_control_init(void)
         ESP_LOGE(TAG, "Failed to initialize WS2812: %s", esp_err_to_name(ret));
         return ret;
     }
+    boot_profile_mark("hw_ws2812");
 
     // 初始化USB MUX GPIO
     ret = init_usb_mux_gpio();
@@ -71,6 +120,7 @@ esp_err_t hardware_control_init(void)
         ESP_LOGE(TAG, "Failed to initialize USB MUX GPIO: %s", esp_err_to_name(ret));
         return ret;
     }
+    boot_profile_mark("hw_usb_mux");
 
     // 初始化电源控制GPIO
     ret = init_power_control_gpio();
@@ -78,6 +128,10 @@ esp_err_t hardware_control_init(void)
         ESP_LOGE(TAG, "Failed to initialize power control GPIO: %s", esp_err_to_name(ret));
         return ret;
     }
+    boot_profile_mark("hw_power_gpio");
+
+    init_power_management();
+    register_benchmarks();
 
     s_initialized = true;
     s_hardware_status.initialized = true;
@@ -102,11 +156,11 @@ esp_err_t hardware_control_deinit(void)
 
     // 释放LED strip资源
     if (s_board_led_strip) {
-        led_strip_del(s_board_led_strip);
+        board_hal_led_strip_del(s_board_led_strip);
         s_board_led_strip = NULL;
     }
     if (s_touch_led_strip) {
-        led_strip_del(s_touch_led_strip);
+        board_hal_led_strip_del(s_touch_led_strip);
         s_touch_led_strip = NULL;
     }
 
@@ -126,6 +180,7 @@ bool hardware_control_is_initialized(void)
 
 esp_err_t fan_set_speed(uint8_t speed)
 {
+    API_LATENCY_FUNCTION();
     if (!s_initialized) {
         ESP_LOGE(TAG, "Hardware control not initialized");
         return ESP_ERR_INVALID_STATE;
@@ -136,13 +191,17 @@ esp_err_t fan_set_speed(uint8_t speed)
         return ESP_ERR_INVALID_ARG;
     }
 
+    hw_lock();
     s_hardware_status.fan_speed = speed;
+    EVENT_TRACE(EVENT_TRACE_FAN_SET, speed, 0);
     uint32_t duty = (speed * 255) / 100;
     
-    ESP_ERROR_CHECK(ledc_set_duty(FAN_PWM_MODE, FAN_PWM_CHANNEL, duty));
-    ESP_ERROR_CHECK(ledc_update_duty(FAN_PWM_MODE, FAN_PWM_CHANNEL));
+    ESP_ERROR_CHECK(board_hal_pwm_set_duty(FAN_PWM_CHANNEL, duty));
+    update_fan_pm_lock(speed);
+    hw_unlock();
     
     ESP_LOGI(TAG, "Fan speed set to %d%% (PWM: %" PRIu32 "/255)", speed, duty);
+    notify_settings_changed();
     return ESP_OK;
 }
 
@@ -153,11 +212,13 @@ uint8_t fan_get_speed(void)
 
 esp_err_t fan_start(void)
 {
+    API_LATENCY_FUNCTION();
     return fan_set_speed(DEFAULT_FAN_SPEED_ON);
 }
 
 esp_err_t fan_stop(void)
 {
+    API_LATENCY_FUNCTION();
     return fan_set_speed(0);
 }
 
@@ -165,27 +226,32 @@ esp_err_t fan_stop(void)
 
 esp_err_t board_led_set_color(led_color_t color)
 {
+    API_LATENCY_FUNCTION();
     if (!s_initialized) {
         ESP_LOGE(TAG, "Hardware control not initialized");
         return ESP_ERR_INVALID_STATE;
     }
 
+    hw_lock();
     s_hardware_status.board_led_color = color;
     
     esp_err_t ret = apply_led_color(s_board_led_strip, color, 
                                    s_hardware_status.board_led_brightness, 
                                    BOARD_WS2812_NUM);
+    hw_unlock();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set board LED color: %s", esp_err_to_name(ret));
         return ret;
     }
 
     ESP_LOGI(TAG, "Board LED color set to R:%d G:%d B:%d", color.red, color.green, color.blue);
+    notify_settings_changed();
     return ESP_OK;
 }
 
 esp_err_t board_led_set_brightness(uint8_t brightness)
 {
+    API_LATENCY_FUNCTION();
     if (!s_initialized) {
         ESP_LOGE(TAG, "Hardware control not initialized");
         return ESP_ERR_INVALID_STATE;
@@ -196,22 +262,26 @@ esp_err_t board_led_set_brightness(uint8_t brightness)
         return ESP_ERR_INVALID_ARG;
     }
 
+    hw_lock();
     s_hardware_status.board_led_brightness = brightness;
     
     // 重新应用当前颜色以更新亮度
     esp_err_t ret = apply_led_color(s_board_led_strip, s_hardware_status.board_led_color, 
                                    brightness, BOARD_WS2812_NUM);
+    hw_unlock();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set board LED brightness: %s", esp_err_to_name(ret));
         return ret;
     }
 
     ESP_LOGI(TAG, "Board LED brightness set to %d%%", brightness);
+    notify_settings_changed();
     return ESP_OK;
 }
 
 esp_err_t board_led_set_effect(led_effect_t effect)
 {
+    API_LATENCY_FUNCTION();
     if (!s_initialized) {
         ESP_LOGE(TAG, "Hardware control not initialized");
         return ESP_ERR_INVALID_STATE;
@@ -219,6 +289,7 @@ esp_err_t board_led_set_effect(led_effect_t effect)
 
     switch (effect) {
         case LED_EFFECT_RAINBOW:
+            hw_lock();
             for (int i = 0; i < BOARD_WS2812_NUM; i++) {
                 int hue = (i * 360) / BOARD_WS2812_NUM;
                 uint8_t r, g, b;
@@ -228,9 +299,15 @@ esp_err_t board_led_set_effect(led_effect_t effect)
                 uint8_t final_g = (g * s_hardware_status.board_led_brightness) / 100;
                 uint8_t final_b = (b * s_hardware_status.board_led_brightness) / 100;
                 
-                ESP_ERROR_CHECK(led_strip_set_pixel(s_board_led_strip, i, final_r, final_g, final_b));
+                ESP_ERROR_CHECK(board_hal_led_strip_set_pixel(s_board_led_strip, i, final_r, final_g, final_b));
             }
-            ESP_ERROR_CHECK(led_strip_refresh(s_board_led_strip));
+            board_hal_pm_lock_acquire(s_led_pm_lock);
+            EVENT_TRACE_BEGIN(EVENT_TRACE_LED_REFRESH, 0, BOARD_WS2812_NUM);
+            esp_err_t ret = board_hal_led_strip_refresh(s_board_led_strip);
+            EVENT_TRACE_END(EVENT_TRACE_LED_REFRESH, 0, BOARD_WS2812_NUM);
+            board_hal_pm_lock_release(s_led_pm_lock);
+            hw_unlock();
+            ESP_ERROR_CHECK(ret);
             ESP_LOGI(TAG, "Board LED rainbow effect applied");
             break;
             
@@ -247,6 +324,7 @@ esp_err_t board_led_set_effect(led_effect_t effect)
 
 esp_err_t board_led_turn_off(void)
 {
+    API_LATENCY_FUNCTION();
     led_color_t off_color = {0, 0, 0};
     return board_led_set_color(off_color);
 }
@@ -265,27 +343,32 @@ uint8_t board_led_get_brightness(void)
 
 esp_err_t touch_led_set_color(led_color_t color)
 {
+    API_LATENCY_FUNCTION();
     if (!s_initialized) {
         ESP_LOGE(TAG, "Hardware control not initialized");
         return ESP_ERR_INVALID_STATE;
     }
 
+    hw_lock();
     s_hardware_status.touch_led_color = color;
     
     esp_err_t ret = apply_led_color(s_touch_led_strip, color, 
                                    s_hardware_status.touch_led_brightness, 
                                    TOUCH_WS2812_NUM);
+    hw_unlock();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set touch LED color: %s", esp_err_to_name(ret));
         return ret;
     }
 
     ESP_LOGI(TAG, "Touch LED color set to R:%d G:%d B:%d", color.red, color.green, color.blue);
+    notify_settings_changed();
     return ESP_OK;
 }
 
 esp_err_t touch_led_set_brightness(uint8_t brightness)
 {
+    API_LATENCY_FUNCTION();
     if (!s_initialized) {
         ESP_LOGE(TAG, "Hardware control not initialized");
         return ESP_ERR_INVALID_STATE;
@@ -296,22 +379,26 @@ esp_err_t touch_led_set_brightness(uint8_t brightness)
         return ESP_ERR_INVALID_ARG;
     }
 
+    hw_lock();
     s_hardware_status.touch_led_brightness = brightness;
     
     // 重新应用当前颜色以更新亮度
     esp_err_t ret = apply_led_color(s_touch_led_strip, s_hardware_status.touch_led_color, 
                                    brightness, TOUCH_WS2812_NUM);
+    hw_unlock();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set touch LED brightness: %s", esp_err_to_name(ret));
         return ret;
     }
 
     ESP_LOGI(TAG, "Touch LED brightness set to %d%%", brightness);
+    notify_settings_changed();
     return ESP_OK;
 }
 
 esp_err_t touch_led_turn_off(void)
 {
+    API_LATENCY_FUNCTION();
     led_color_t off_color = {0, 0, 0};
     return touch_led_set_color(off_color);
 }
@@ -330,13 +417,17 @@ uint8_t touch_led_get_brightness(void)
 
 esp_err_t gpio_set_output(uint8_t pin, gpio_state_t state)
 {
-    esp_err_t ret = gpio_set_direction(pin, GPIO_MODE_OUTPUT);
+    API_LATENCY_FUNCTION();
+    hw_lock();
+    esp_err_t ret = board_hal_gpio_set_direction(pin, BOARD_HAL_GPIO_MODE_OUTPUT);
     if (ret != ESP_OK) {
+        hw_unlock();
         ESP_LOGE(TAG, "Failed to set GPIO%d as output: %s", pin, esp_err_to_name(ret));
         return ret;
     }
 
-    ret = gpio_set_level(pin, state);
+    ret = board_hal_gpio_set_level(pin, state);
+    hw_unlock();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set GPIO%d level: %s", pin, esp_err_to_name(ret));
         return ret;
@@ -348,6 +439,7 @@ esp_err_t gpio_set_output(uint8_t pin, gpio_state_t state)
 
 esp_err_t gpio_read_input(uint8_t pin, gpio_state_t *state)
 {
+    API_LATENCY_FUNCTION();
     if (state == NULL) {
         ESP_LOGE(TAG, "State pointer is NULL");
         return ESP_ERR_INVALID_ARG;
@@ -359,8 +451,8 @@ esp_err_t gpio_read_input(uint8_t pin, gpio_state_t *state)
     ESP_LOGW(TAG, "gpio_read_input() on GPIO%d - may interfere with output state!", pin);
     
     // 直接读取GPIO电平，不改变方向
-    // gpio_get_level() 可以在输出模式下读取实际的输出电平
-    int level = gpio_get_level(pin);
+    // board_hal_gpio_get_level() 可以在输出模式下读取实际的输出电平
+    int level = board_hal_gpio_get_level(pin);
     *state = (level == 0) ? GPIO_STATE_LOW : GPIO_STATE_HIGH;
 
     ESP_LOGI(TAG, "GPIO%d current level: %s", pin, *state ? "HIGH" : "LOW");
@@ -369,19 +461,23 @@ esp_err_t gpio_read_input(uint8_t pin, gpio_state_t *state)
 
 esp_err_t gpio_read_input_mode(uint8_t pin, gpio_state_t *state)
 {
+    API_LATENCY_FUNCTION();
     if (state == NULL) {
         ESP_LOGE(TAG, "State pointer is NULL");
         return ESP_ERR_INVALID_ARG;
     }
 
     // 这个函数专门用于将GPIO设置为输入模式并读取
-    esp_err_t ret = gpio_set_direction(pin, GPIO_MODE_INPUT);
+    hw_lock();
+    esp_err_t ret = board_hal_gpio_set_direction(pin, BOARD_HAL_GPIO_MODE_INPUT);
     if (ret != ESP_OK) {
+        hw_unlock();
         ESP_LOGE(TAG, "Failed to set GPIO%d as input: %s", pin, esp_err_to_name(ret));
         return ret;
     }
 
-    int level = gpio_get_level(pin);
+    int level = board_hal_gpio_get_level(pin);
+    hw_unlock();
     *state = (level == 0) ? GPIO_STATE_LOW : GPIO_STATE_HIGH;
 
     ESP_LOGI(TAG, "GPIO%d input state: %s", pin, *state ? "HIGH" : "LOW");
@@ -390,6 +486,7 @@ esp_err_t gpio_read_input_mode(uint8_t pin, gpio_state_t *state)
 
 esp_err_t gpio_toggle_output(uint8_t pin)
 {
+    API_LATENCY_FUNCTION();
     // 对于输出引脚的切换，我们不应该读取当前状态，因为这可能干扰GPIO
     // 相反，我们维护一个简单的状态管理或要求调用者指定目标状态
     ESP_LOGW(TAG, "gpio_toggle_output() is deprecated - use gpio_set_output() with explicit state instead");
@@ -404,6 +501,7 @@ esp_err_t gpio_toggle_output(uint8_t pin)
 
 esp_err_t usb_mux_set_target(usb_mux_target_t target)
 {
+    API_LATENCY_FUNCTION();
     if (!s_initialized) {
         ESP_LOGE(TAG, "Hardware control not initialized");
         return ESP_ERR_INVALID_STATE;
@@ -431,9 +529,13 @@ esp_err_t usb_mux_set_target(usb_mux_target_t target)
             return ESP_ERR_INVALID_ARG;
     }
 
+    // 两个引脚与状态一起更新，其他任务不会看到中间状态
+    hw_lock();
+
     // 设置MUX1引脚
     ret = gpio_set_output(ESP32_MUX1_SEL, mux1_state);
     if (ret != ESP_OK) {
+        hw_unlock();
         ESP_LOGE(TAG, "Failed to set MUX1 GPIO: %s", esp_err_to_name(ret));
         return ret;
     }
@@ -441,12 +543,15 @@ esp_err_t usb_mux_set_target(usb_mux_target_t target)
     // 设置MUX2引脚
     ret = gpio_set_output(ESP32_MUX2_SEL, mux2_state);
     if (ret != ESP_OK) {
+        hw_unlock();
         ESP_LOGE(TAG, "Failed to set MUX2 GPIO: %s", esp_err_to_name(ret));
         return ret;
     }
 
     // 更新状态
     s_hardware_status.usb_mux_target = target;
+    EVENT_TRACE(EVENT_TRACE_USB_MUX, target, 0);
+    hw_unlock();
     
     ESP_LOGI(TAG, "USB MUX switched to %s (MUX1=%d, MUX2=%d)", 
              usb_mux_get_target_name(target), mux1_state, mux2_state);
@@ -487,6 +592,7 @@ const char *usb_mux_get_target_name(usb_mux_target_t target)
 
 esp_err_t orin_power_on(void)
 {
+    API_LATENCY_FUNCTION();
     if (!s_initialized) {
         ESP_LOGE(TAG, "Hardware control not initialized");
         return ESP_ERR_INVALID_STATE;
@@ -505,6 +611,7 @@ esp_err_t orin_power_on(void)
 
 esp_err_t orin_power_off(void)
 {
+    API_LATENCY_FUNCTION();
     if (!s_initialized) {
         ESP_LOGE(TAG, "Hardware control not initialized");
         return ESP_ERR_INVALID_STATE;
@@ -523,6 +630,7 @@ esp_err_t orin_power_off(void)
 
 esp_err_t orin_reset(void)
 {
+    API_LATENCY_FUNCTION();
     if (!s_initialized) {
         ESP_LOGE(TAG, "Hardware control not initialized");
         return ESP_ERR_INVALID_STATE;
@@ -537,11 +645,17 @@ esp_err_t orin_reset(void)
         return ret;
     }
 
+    // 脉冲期间禁止浅睡眠，保证脉宽准确
+    board_hal_pm_lock_acquire(s_pulse_pm_lock);
+    EVENT_TRACE_BEGIN(EVENT_TRACE_POWER_PULSE, ORIN_RESET_PIN, ORIN_RESET_PULSE_MS);
+
     // 保持1000ms
-    vTaskDelay(pdMS_TO_TICKS(ORIN_RESET_PULSE_MS));
+    board_hal_time_delay_ms(ORIN_RESET_PULSE_MS);
 
     // 拉低重启引脚
     ret = gpio_set_output(ORIN_RESET_PIN, GPIO_STATE_LOW);
+    board_hal_pm_lock_release(s_pulse_pm_lock);
+    EVENT_TRACE_END(EVENT_TRACE_POWER_PULSE, ORIN_RESET_PIN, ORIN_RESET_PULSE_MS);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set Orin reset pin low: %s", esp_err_to_name(ret));
         return ret;
@@ -553,66 +667,30 @@ esp_err_t orin_reset(void)
 
 esp_err_t orin_enter_recovery_mode(void)
 {
+    API_LATENCY_FUNCTION();
     if (!s_initialized) {
         ESP_LOGE(TAG, "Hardware control not initialized");
         return ESP_ERR_INVALID_STATE;
     }
 
     ESP_LOGI(TAG, "Entering Orin recovery mode");
-    
-    // 步骤1: 将GPIO40拉高并保持1000ms
-    ESP_LOGI(TAG, "Step 1: Setting GPIO%d (recovery pin) HIGH", ORIN_RECOVERY_PIN);
-    // esp_err_t ret = gpio_set_direction(ORIN_RECOVERY_PIN, GPIO_MODE_OUTPUT);
-    // if (ret != ESP_OK) {
-    //     ESP_LOGE(TAG, "Failed to configure GPIO%d as output: %s", ORIN_RECOVERY_PIN, esp_err_to_name(ret));
-    //     return ret;
-    // }
-    
-    esp_err_t ret = gpio_set_level(ORIN_RECOVERY_PIN, GPIO_STATE_HIGH);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set GPIO%d level HIGH: %s", ORIN_RECOVERY_PIN, esp_err_to_name(ret));
-        return ret;
-    }
-    
-    // 注意：不进行状态验证，避免干扰GPIO状态
-    ESP_LOGI(TAG, "GPIO%d set to HIGH, holding for 1000ms...", ORIN_RECOVERY_PIN);
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    EVENT_TRACE_BEGIN(EVENT_TRACE_RECOVERY, 0, 0);
 
-    // 步骤2: 重启Orin并等待1000ms
-    ESP_LOGI(TAG, "Step 2: Executing Orin reset");
-    ret = orin_reset();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to reset Orin during recovery mode entry");
-        return ret;
-    }
-    ESP_LOGI(TAG, "Orin reset completed, waiting 1000ms");
-    vTaskDelay(pdMS_TO_TICKS(1000));
-
-    // 步骤3: 将GPIO40拉低
-    ESP_LOGI(TAG, "Step 3: Setting GPIO%d (recovery pin) LOW", ORIN_RECOVERY_PIN);
-    ret = gpio_set_level(ORIN_RECOVERY_PIN, 0);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set GPIO%d level LOW: %s", ORIN_RECOVERY_PIN, esp_err_to_name(ret));
-        return ret;
-    }
-    
-    // 注意：不进行状态验证，避免干扰GPIO状态
-    ESP_LOGI(TAG, "GPIO%d set to LOW", ORIN_RECOVERY_PIN);
+    // 整个引脚序列持有外设锁，保持期间其他任务不能改写GPIO40、复位引脚或USB MUX
+    hw_lock();
+    esp_err_t ret = recovery_sequence_locked();
+    hw_unlock();
 
-    // 步骤4: 切换USB MUX到AGX
-    ESP_LOGI(TAG, "Step 4: Switching USB MUX to AGX");
-    ret = usb_mux_set_target(USB_MUX_AGX);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to switch USB MUX to AGX during recovery mode");
-        return ret;
+    EVENT_TRACE_END(EVENT_TRACE_RECOVERY, 0, ret);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Orin recovery mode entry completed successfully");
     }
-
-    ESP_LOGI(TAG, "Orin recovery mode entry completed successfully");
-    return ESP_OK;
+    return ret;
 }
 
 esp_err_t n305_power_toggle(void)
 {
+    API_LATENCY_FUNCTION();
     if (!s_initialized) {
         ESP_LOGE(TAG, "Hardware control not initialized");
         return ESP_ERR_INVALID_STATE;
@@ -627,15 +705,21 @@ esp_err_t n305_power_toggle(void)
         return ret;
     }
 
+    // 脉冲期间禁止浅睡眠，保证脉宽准确
+    board_hal_pm_lock_acquire(s_pulse_pm_lock);
+    EVENT_TRACE_BEGIN(EVENT_TRACE_POWER_PULSE, N305_POWER_BTN_PIN, N305_POWER_PULSE_MS);
+
     // 保持300ms
-    vTaskDelay(pdMS_TO_TICKS(N305_POWER_PULSE_MS));
+    board_hal_time_delay_ms(N305_POWER_PULSE_MS);
 
     // 拉低电源按钮引脚
     ret = gpio_set_output(N305_POWER_BTN_PIN, GPIO_STATE_LOW);
+    board_hal_pm_lock_release(s_pulse_pm_lock);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set N305 power button low: %s", esp_err_to_name(ret));
         return ret;
     }
+    EVENT_TRACE_END(EVENT_TRACE_POWER_PULSE, N305_POWER_BTN_PIN, N305_POWER_PULSE_MS);
 
     // 切换电源状态
     if (s_hardware_status.n305_power_state == POWER_STATE_ON) {
@@ -651,6 +735,7 @@ esp_err_t n305_power_toggle(void)
 
 esp_err_t n305_reset(void)
 {
+    API_LATENCY_FUNCTION();
     if (!s_initialized) {
         ESP_LOGE(TAG, "Hardware control not initialized");
         return ESP_ERR_INVALID_STATE;
@@ -665,15 +750,21 @@ esp_err_t n305_reset(void)
         return ret;
     }
 
+    // 脉冲期间禁止浅睡眠，保证脉宽准确
+    board_hal_pm_lock_acquire(s_pulse_pm_lock);
+    EVENT_TRACE_BEGIN(EVENT_TRACE_POWER_PULSE, N305_RESET_PIN, N305_RESET_PULSE_MS);
+
     // 保持300ms
-    vTaskDelay(pdMS_TO_TICKS(N305_RESET_PULSE_MS));
+    board_hal_time_delay_ms(N305_RESET_PULSE_MS);
 
     // 拉低重启引脚
     ret = gpio_set_output(N305_RESET_PIN, GPIO_STATE_LOW);
+    board_hal_pm_lock_release(s_pulse_pm_lock);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set N305 reset pin low: %s", esp_err_to_name(ret));
         return ret;
     }
+    EVENT_TRACE_END(EVENT_TRACE_POWER_PULSE, N305_RESET_PIN, N305_RESET_PULSE_MS);
 
     ESP_LOGI(TAG, "N305 reset completed");
     return ESP_OK;
@@ -743,7 +834,7 @@ esp_err_t hardware_test_fan(void)
             ESP_LOGE(TAG, "Fan test failed at speed %d%%", speed);
             return ESP_FAIL;
         }
-        vTaskDelay(pdMS_TO_TICKS(2000));
+        board_hal_time_delay_ms(2000);
     }
     
     fan_stop();
@@ -775,7 +866,7 @@ esp_err_t hardware_test_board_led(void)
             ESP_LOGE(TAG, "Board LED test failed");
             return ESP_FAIL;
         }
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        board_hal_time_delay_ms(1000);
     }
     
     board_led_turn_off();
@@ -807,7 +898,7 @@ esp_err_t hardware_test_touch_led(void)
             ESP_LOGE(TAG, "Touch LED test failed");
             return ESP_FAIL;
         }
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        board_hal_time_delay_ms(1000);
     }
     
     touch_led_turn_off();
@@ -827,7 +918,7 @@ esp_err_t hardware_test_gpio(uint8_t pin)
         return ESP_FAIL;
     }
     ESP_LOGI(TAG, "GPIO%d set to HIGH, waiting 1000ms", pin);
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    board_hal_time_delay_ms(1000);
     
     ESP_LOGI(TAG, "Testing GPIO%d output mode - LOW", pin);
     ret = gpio_set_output(pin, GPIO_STATE_LOW);
@@ -836,7 +927,7 @@ esp_err_t hardware_test_gpio(uint8_t pin)
         return ESP_FAIL;
     }
     ESP_LOGI(TAG, "GPIO%d set to LOW, waiting 1000ms", pin);
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    board_hal_time_delay_ms(1000);
     
     ESP_LOGI(TAG, "GPIO%d safe output test completed successfully", pin);
     ESP_LOGW(TAG, "Note: No state verification performed to avoid GPIO interference");
@@ -893,7 +984,7 @@ esp_err_t hardware_test_orin_power(void)
         ESP_LOGE(TAG, "Orin power on test failed");
         return ESP_FAIL;
     }
-    vTaskDelay(pdMS_TO_TICKS(2000));
+    board_hal_time_delay_ms(2000);
     
     // 测试关机
     ESP_LOGI(TAG, "Testing Orin power off");
@@ -902,7 +993,7 @@ esp_err_t hardware_test_orin_power(void)
         ESP_LOGE(TAG, "Orin power off test failed");
         return ESP_FAIL;
     }
-    vTaskDelay(pdMS_TO_TICKS(2000));
+    board_hal_time_delay_ms(2000);
     
     ESP_LOGI(TAG, "Orin power control test completed successfully");
     return ESP_OK;
@@ -924,7 +1015,7 @@ esp_err_t hardware_test_n305_power(void)
         ESP_LOGE(TAG, "N305 power toggle test failed");
         return ESP_FAIL;
     }
-    vTaskDelay(pdMS_TO_TICKS(3000));
+    board_hal_time_delay_ms(3000);
     
     // 再次切换
     ESP_LOGI(TAG, "Testing N305 power toggle again");
@@ -933,7 +1024,7 @@ esp_err_t hardware_test_n305_power(void)
         ESP_LOGE(TAG, "N305 power toggle test failed");
         return ESP_FAIL;
     }
-    vTaskDelay(pdMS_TO_TICKS(3000));
+    board_hal_time_delay_ms(3000);
     
     ESP_LOGI(TAG, "N305 power control test completed successfully");
     return ESP_OK;
@@ -965,24 +1056,23 @@ esp_err_t hardware_test_orin_recovery_gpio(void)
     } else {
         // 步骤2: 重置GPIO配置
         ESP_LOGI(TAG, "Resetting GPIO%d configuration", ORIN_RECOVERY_PIN);
-        esp_err_t ret = gpio_reset_pin(ORIN_RECOVERY_PIN);
+        esp_err_t ret = board_hal_gpio_reset_pin(ORIN_RECOVERY_PIN);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "Failed to reset GPIO%d: %s", ORIN_RECOVERY_PIN, esp_err_to_name(ret));
             return ESP_FAIL;
         }
-        vTaskDelay(pdMS_TO_TICKS(100)); // 给硬件一点时间
+        board_hal_time_delay_ms(100); // 给硬件一点时间
     }
     
     // 步骤3: 配置为输出模式（带详细配置）
     ESP_LOGI(TAG, "Configuring GPIO%d as output with detailed settings", ORIN_RECOVERY_PIN);
-    gpio_config_t io_conf = {
-        .intr_type = GPIO_INTR_DISABLE,
-        .mode = GPIO_MODE_OUTPUT,
+    board_hal_gpio_config_t io_conf = {
+        .mode = BOARD_HAL_GPIO_MODE_OUTPUT,
         .pin_bit_mask = (1ULL << ORIN_RECOVERY_PIN),
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .pull_up_en = GPIO_PULLUP_DISABLE
+        .pull_down_en = false,
+        .pull_up_en = false
     };
-    esp_err_t ret = gpio_config(&io_conf);
+    esp_err_t ret = board_hal_gpio_config(&io_conf);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure GPIO%d: %s", ORIN_RECOVERY_PIN, esp_err_to_name(ret));
         return ESP_FAIL;
@@ -991,27 +1081,27 @@ esp_err_t hardware_test_orin_recovery_gpio(void)
     
     // 步骤4: 测试LOW状态
     ESP_LOGI(TAG, "Testing LOW state on GPIO%d", ORIN_RECOVERY_PIN);
-    ret = gpio_set_level(ORIN_RECOVERY_PIN, 0);
+    ret = board_hal_gpio_set_level(ORIN_RECOVERY_PIN, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set GPIO%d LOW: %s", ORIN_RECOVERY_PIN, esp_err_to_name(ret));
         return ESP_FAIL;
     }
-    vTaskDelay(pdMS_TO_TICKS(100));
+    board_hal_time_delay_ms(100);
     
-    int level = gpio_get_level(ORIN_RECOVERY_PIN);
+    int level = board_hal_gpio_get_level(ORIN_RECOVERY_PIN);
     ESP_LOGI(TAG, "GPIO%d LOW test - Expected: 0, Got: %d %s", 
              ORIN_RECOVERY_PIN, level, (level == 0) ? "[PASS]" : "[FAIL]");
     
     // 步骤5: 测试HIGH状态
     ESP_LOGI(TAG, "Testing HIGH state on GPIO%d", ORIN_RECOVERY_PIN);
-    ret = gpio_set_level(ORIN_RECOVERY_PIN, 1);
+    ret = board_hal_gpio_set_level(ORIN_RECOVERY_PIN, 1);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set GPIO%d HIGH: %s", ORIN_RECOVERY_PIN, esp_err_to_name(ret));
         return ESP_FAIL;
     }
-    vTaskDelay(pdMS_TO_TICKS(100));
+    board_hal_time_delay_ms(100);
     
-    level = gpio_get_level(ORIN_RECOVERY_PIN);
+    level = board_hal_gpio_get_level(ORIN_RECOVERY_PIN);
     ESP_LOGI(TAG, "GPIO%d HIGH test - Expected: 1, Got: %d %s", 
              ORIN_RECOVERY_PIN, level, (level == 1) ? "[PASS]" : "[FAIL]");
     
@@ -1024,10 +1114,10 @@ esp_err_t hardware_test_orin_recovery_gpio(void)
         
         // 尝试使能内部上拉
         ESP_LOGI(TAG, "Attempting to enable internal pull-up on GPIO%d", ORIN_RECOVERY_PIN);
-        gpio_pullup_en(ORIN_RECOVERY_PIN);
-        vTaskDelay(pdMS_TO_TICKS(100));
+        board_hal_gpio_pullup_en(ORIN_RECOVERY_PIN);
+        board_hal_time_delay_ms(100);
         
-        level = gpio_get_level(ORIN_RECOVERY_PIN);
+        level = board_hal_gpio_get_level(ORIN_RECOVERY_PIN);
         ESP_LOGI(TAG, "GPIO%d with pull-up - Got: %d %s", 
                  ORIN_RECOVERY_PIN, level, (level == 1) ? "[PASS]" : "[STILL FAIL]");
         
@@ -1041,8 +1131,8 @@ esp_err_t hardware_test_orin_recovery_gpio(void)
     // 步骤6: 测试持续时间
     ESP_LOGI(TAG, "Testing 1000ms HIGH duration on GPIO%d", ORIN_RECOVERY_PIN);
     for (int i = 0; i < 10; i++) {
-        vTaskDelay(pdMS_TO_TICKS(100));
-        level = gpio_get_level(ORIN_RECOVERY_PIN);
+        board_hal_time_delay_ms(100);
+        level = board_hal_gpio_get_level(ORIN_RECOVERY_PIN);
         if (level != 1) {
             ESP_LOGE(TAG, "GPIO%d lost HIGH state after %dms! Got: %d", ORIN_RECOVERY_PIN, (i+1)*100, level);
             return ESP_FAIL;
@@ -1052,14 +1142,14 @@ esp_err_t hardware_test_orin_recovery_gpio(void)
     
     // 步骤7: 恢复LOW状态
     ESP_LOGI(TAG, "Setting GPIO%d back to LOW", ORIN_RECOVERY_PIN);
-    ret = gpio_set_level(ORIN_RECOVERY_PIN, 0);
+    ret = board_hal_gpio_set_level(ORIN_RECOVERY_PIN, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set GPIO%d LOW: %s", ORIN_RECOVERY_PIN, esp_err_to_name(ret));
         return ESP_FAIL;
     }
-    vTaskDelay(pdMS_TO_TICKS(100));
+    board_hal_time_delay_ms(100);
     
-    level = gpio_get_level(ORIN_RECOVERY_PIN);
+    level = board_hal_gpio_get_level(ORIN_RECOVERY_PIN);
     ESP_LOGI(TAG, "Final GPIO%d LOW test - Expected: 0, Got: %d %s", 
              ORIN_RECOVERY_PIN, level, (level == 0) ? "[PASS]" : "[FAIL]");
     
@@ -1081,7 +1171,9 @@ esp_err_t hardware_get_status(hardware_status_t *status)
         return ESP_ERR_INVALID_STATE;
     }
 
+    hw_lock();
     *status = s_hardware_status;
+    hw_unlock();
     return ESP_OK;
 }
 
@@ -1113,31 +1205,159 @@ esp_err_t hardware_print_status(void)
     return ESP_OK;
 }
 
-// ==================== 静态函数实现 ====================
+// ==================== 批量设置接口实现 ====================
 
-static esp_err_t init_fan_pwm(void)
+esp_err_t hardware_apply_settings(const hardware_settings_t *settings)
 {
-    ledc_timer_config_t ledc_timer = {
-        .duty_resolution = FAN_PWM_RESOLUTION,
-        .freq_hz = FAN_PWM_FREQUENCY,
-        .speed_mode = FAN_PWM_MODE,
-        .timer_num = FAN_PWM_TIMER,
-        .clk_cfg = LEDC_AUTO_CLK,
-    };
-    esp_err_t ret = ledc_timer_config(&ledc_timer);
+    API_LATENCY_FUNCTION();
+    if (settings == NULL) {
+        ESP_LOGE(TAG, "Settings pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    hw_txn_t txn;
+    hw_txn_begin(&txn);
+    hw_txn_set_settings(&txn, settings);
+    return hw_txn_commit(&txn);
+}
+
+esp_err_t hardware_get_settings(hardware_settings_t *settings)
+{
+    if (settings == NULL) {
+        ESP_LOGE(TAG, "Settings pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_initialized) {
+        ESP_LOGE(TAG, "Hardware control not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    hw_lock();
+    settings->fan_speed = s_hardware_status.fan_speed;
+    settings->board_led_color = s_hardware_status.board_led_color;
+    settings->board_led_brightness = s_hardware_status.board_led_brightness;
+    settings->touch_led_color = s_hardware_status.touch_led_color;
+    settings->touch_led_brightness = s_hardware_status.touch_led_brightness;
+    hw_unlock();
+    return ESP_OK;
+}
+
+esp_err_t hardware_register_settings_change_callback(hardware_settings_change_cb_t callback)
+{
+    s_settings_change_cb = callback;
+    return ESP_OK;
+}
+
+// ==================== 事务接口实现 ====================
+
+void hw_txn_begin(hw_txn_t *txn)
+{
+    memset(txn, 0, sizeof(*txn));
+}
+
+void hw_txn_set_fan(hw_txn_t *txn, uint8_t speed)
+{
+    txn->settings.fan_speed = speed;
+    txn->fields |= HW_TXN_FAN;
+}
+
+void hw_txn_set_board_led(hw_txn_t *txn, led_color_t color)
+{
+    txn->settings.board_led_color = color;
+    txn->fields |= HW_TXN_BOARD_COLOR;
+}
+
+void hw_txn_set_board_brightness(hw_txn_t *txn, uint8_t brightness)
+{
+    txn->settings.board_led_brightness = brightness;
+    txn->fields |= HW_TXN_BOARD_BRIGHTNESS;
+}
+
+void hw_txn_set_touch_led(hw_txn_t *txn, led_color_t color)
+{
+    txn->settings.touch_led_color = color;
+    txn->fields |= HW_TXN_TOUCH_COLOR;
+}
+
+void hw_txn_set_touch_brightness(hw_txn_t *txn, uint8_t brightness)
+{
+    txn->settings.touch_led_brightness = brightness;
+    txn->fields |= HW_TXN_TOUCH_BRIGHTNESS;
+}
+
+void hw_txn_set_settings(hw_txn_t *txn, const hardware_settings_t *settings)
+{
+    txn->settings = *settings;
+    txn->fields |= HW_TXN_FAN | HW_TXN_BOARD_COLOR | HW_TXN_BOARD_BRIGHTNESS |
+                   HW_TXN_TOUCH_COLOR | HW_TXN_TOUCH_BRIGHTNESS;
+}
+
+void hw_txn_set_usb_mux(hw_txn_t *txn, usb_mux_target_t target)
+{
+    txn->usb_mux_target = target;
+    txn->fields |= HW_TXN_USB_MUX;
+}
+
+void hw_txn_set_gpio(hw_txn_t *txn, uint8_t pin, gpio_state_t state)
+{
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(pin)) {
+        txn->invalid = true;
+        return;
+    }
+
+    uint64_t bit = 1ULL << pin;
+    if (state == GPIO_STATE_HIGH) {
+        txn->gpio_high_mask |= bit;
+        txn->gpio_low_mask &= ~bit;
+    } else {
+        txn->gpio_low_mask |= bit;
+        txn->gpio_high_mask &= ~bit;
+    }
+    txn->fields |= HW_TXN_GPIO;
+}
+
+void hw_txn_set_transient(hw_txn_t *txn)
+{
+    txn->transient = true;
+}
+
+esp_err_t hw_txn_commit(hw_txn_t *txn)
+{
+    API_LATENCY_FUNCTION();
+    if (!s_initialized) {
+        ESP_LOGE(TAG, "Hardware control not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (txn == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    hw_lock();
+    esp_err_t ret = txn_apply_locked(txn);
+    hw_unlock();
     if (ret != ESP_OK) {
         return ret;
     }
 
-    ledc_channel_config_t ledc_channel = {
-        .channel = FAN_PWM_CHANNEL,
-        .duty = 0,
-        .gpio_num = FAN_PWM_PIN,
-        .speed_mode = FAN_PWM_MODE,
-        .timer_sel = FAN_PWM_TIMER,
-        .intr_type = LEDC_INTR_DISABLE
-    };
-    ret = ledc_channel_config(&ledc_channel);
+    uint32_t fields = txn->fields;
+    ESP_LOGD(TAG, "Hardware transaction committed (fields 0x%02" PRIx32 ", fan %d%%)",
+             fields, s_hardware_status.fan_speed);
+
+    // 回调在释放外设锁后调用
+    if (!txn->transient && (fields & (HW_TXN_FAN | HW_TXN_BOARD_COLOR | HW_TXN_BOARD_BRIGHTNESS |
+                                      HW_TXN_TOUCH_COLOR | HW_TXN_TOUCH_BRIGHTNESS))) {
+        notify_settings_changed();
+    }
+    return ESP_OK;
+}
+
+// ==================== 静态函数实现 ====================
+
+static esp_err_t init_fan_pwm(void)
+{
+    esp_err_t ret = board_hal_pwm_init(FAN_PWM_CHANNEL, FAN_PWM_PIN, FAN_PWM_FREQUENCY, FAN_PWM_RESOLUTION);
     if (ret != ESP_OK) {
         return ret;
     }
@@ -1148,45 +1368,21 @@ static esp_err_t init_fan_pwm(void)
 
 static esp_err_t init_ws2812(void)
 {
-    // Board LED strip configuration
-    led_strip_config_t board_strip_config = {
-        .strip_gpio_num = BOARD_WS2812_PIN,
-        .max_leds = BOARD_WS2812_NUM,
-    };
-    
-    led_strip_rmt_config_t board_rmt_config = {
-        .clk_src = RMT_CLK_SRC_DEFAULT,
-        .resolution_hz = LED_RMT_CLK_FREQ,
-        .flags.with_dma = false,
-    };
-    
-    esp_err_t ret = led_strip_new_rmt_device(&board_strip_config, &board_rmt_config, &s_board_led_strip);
+    esp_err_t ret = board_hal_led_strip_new(BOARD_WS2812_PIN, BOARD_WS2812_NUM, &s_board_led_strip);
     if (ret != ESP_OK) {
         return ret;
     }
 
-    // Touch LED strip configuration
-    led_strip_config_t touch_strip_config = {
-        .strip_gpio_num = TOUCH_WS2812_PIN,
-        .max_leds = TOUCH_WS2812_NUM,
-    };
-    
-    led_strip_rmt_config_t touch_rmt_config = {
-        .clk_src = RMT_CLK_SRC_DEFAULT,
-        .resolution_hz = LED_RMT_CLK_FREQ,
-        .flags.with_dma = false,
-    };
-    
-    ret = led_strip_new_rmt_device(&touch_strip_config, &touch_rmt_config, &s_touch_led_strip);
+    ret = board_hal_led_strip_new(TOUCH_WS2812_PIN, TOUCH_WS2812_NUM, &s_touch_led_strip);
     if (ret != ESP_OK) {
-        led_strip_del(s_board_led_strip);
+        board_hal_led_strip_del(s_board_led_strip);
         s_board_led_strip = NULL;
         return ret;
     }
 
     // Clear both LED strips
-    ESP_ERROR_CHECK(led_strip_clear(s_board_led_strip));
-    ESP_ERROR_CHECK(led_strip_clear(s_touch_led_strip));
+    ESP_ERROR_CHECK(board_hal_led_strip_clear(s_board_led_strip));
+    ESP_ERROR_CHECK(board_hal_led_strip_clear(s_touch_led_strip));
     
     ESP_LOGI(TAG, "WS2812 initialized - Board: GPIO%d (%d LEDs), Touch: GPIO%d (%d LEDs)", 
              BOARD_WS2812_PIN, BOARD_WS2812_NUM, TOUCH_WS2812_PIN, TOUCH_WS2812_NUM);
@@ -1196,7 +1392,7 @@ static esp_err_t init_ws2812(void)
 static esp_err_t init_usb_mux_gpio(void)
 {
     // 配置MUX1 GPIO
-    esp_err_t ret = gpio_set_direction(ESP32_MUX1_SEL, GPIO_MODE_OUTPUT);
+    esp_err_t ret = board_hal_gpio_set_direction(ESP32_MUX1_SEL, BOARD_HAL_GPIO_MODE_OUTPUT);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure MUX1 GPIO%d as output: %s", 
                  ESP32_MUX1_SEL, esp_err_to_name(ret));
@@ -1204,7 +1400,7 @@ static esp_err_t init_usb_mux_gpio(void)
     }
 
     // 配置MUX2 GPIO
-    ret = gpio_set_direction(ESP32_MUX2_SEL, GPIO_MODE_OUTPUT);
+    ret = board_hal_gpio_set_direction(ESP32_MUX2_SEL, BOARD_HAL_GPIO_MODE_OUTPUT);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure MUX2 GPIO%d as output: %s", 
                  ESP32_MUX2_SEL, esp_err_to_name(ret));
@@ -1212,13 +1408,13 @@ static esp_err_t init_usb_mux_gpio(void)
     }
 
     // 设置默认状态 - 连接到ESP32S3 (mux1=0, mux2=0)
-    ret = gpio_set_level(ESP32_MUX1_SEL, 0);
+    ret = board_hal_gpio_set_level(ESP32_MUX1_SEL, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set MUX1 initial level: %s", esp_err_to_name(ret));
         return ret;
     }
     
-    ret = gpio_set_level(ESP32_MUX2_SEL, 0);
+    ret = board_hal_gpio_set_level(ESP32_MUX2_SEL, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set MUX2 initial level: %s", esp_err_to_name(ret));
         return ret;
@@ -1246,14 +1442,14 @@ static esp_err_t init_power_control_gpio(void)
     }
 
     // 配置Orin电源控制引脚
-    ret = gpio_set_direction(ORIN_POWER_PIN, GPIO_MODE_OUTPUT);
+    ret = board_hal_gpio_set_direction(ORIN_POWER_PIN, BOARD_HAL_GPIO_MODE_OUTPUT);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure Orin power GPIO%d as output: %s", 
                  ORIN_POWER_PIN, esp_err_to_name(ret));
         return ret;
     }
 
-    ret = gpio_set_direction(ORIN_RESET_PIN, GPIO_MODE_OUTPUT);
+    ret = board_hal_gpio_set_direction(ORIN_RESET_PIN, BOARD_HAL_GPIO_MODE_OUTPUT);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure Orin reset GPIO%d as output: %s", 
                  ORIN_RESET_PIN, esp_err_to_name(ret));
@@ -1261,14 +1457,13 @@ static esp_err_t init_power_control_gpio(void)
     }
 
     // 特别配置GPIO40，确保完全作为普通GPIO使用
-    gpio_config_t io_conf = {
-        .intr_type = GPIO_INTR_DISABLE,
-        .mode = GPIO_MODE_OUTPUT,
+    board_hal_gpio_config_t io_conf = {
+        .mode = BOARD_HAL_GPIO_MODE_OUTPUT,
         .pin_bit_mask = (1ULL << ORIN_RECOVERY_PIN),
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .pull_up_en = GPIO_PULLUP_DISABLE
+        .pull_down_en = false,
+        .pull_up_en = false
     };
-    ret = gpio_config(&io_conf);
+    ret = board_hal_gpio_config(&io_conf);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure Orin recovery GPIO%d as output: %s", 
                  ORIN_RECOVERY_PIN, esp_err_to_name(ret));
@@ -1276,14 +1471,14 @@ static esp_err_t init_power_control_gpio(void)
     }
 
     // 配置N305电源控制引脚
-    ret = gpio_set_direction(N305_POWER_BTN_PIN, GPIO_MODE_OUTPUT);
+    ret = board_hal_gpio_set_direction(N305_POWER_BTN_PIN, BOARD_HAL_GPIO_MODE_OUTPUT);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure N305 power button GPIO%d as output: %s", 
                  N305_POWER_BTN_PIN, esp_err_to_name(ret));
         return ret;
     }
 
-    ret = gpio_set_direction(N305_RESET_PIN, GPIO_MODE_OUTPUT);
+    ret = board_hal_gpio_set_direction(N305_RESET_PIN, BOARD_HAL_GPIO_MODE_OUTPUT);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure N305 reset GPIO%d as output: %s", 
                  N305_RESET_PIN, esp_err_to_name(ret));
@@ -1292,40 +1487,62 @@ static esp_err_t init_power_control_gpio(void)
 
     // 设置初始状态
     // Orin默认开机状态 (GPIO3 = LOW)
-    ret = gpio_set_level(ORIN_POWER_PIN, 0);
+    ret = board_hal_gpio_set_level(ORIN_POWER_PIN, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set Orin power pin initial level: %s", esp_err_to_name(ret));
         return ret;
     }
 
     // Orin重启引脚默认为低
-    ret = gpio_set_level(ORIN_RESET_PIN, 0);
+    ret = board_hal_gpio_set_level(ORIN_RESET_PIN, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set Orin reset pin initial level: %s", esp_err_to_name(ret));
         return ret;
     }
 
     // Orin恢复模式引脚默认为低
-    ret = gpio_set_level(ORIN_RECOVERY_PIN, 0);
+    ret = board_hal_gpio_set_level(ORIN_RECOVERY_PIN, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set Orin recovery pin initial level: %s", esp_err_to_name(ret));
         return ret;
     }
 
     // N305电源按钮默认为低
-    ret = gpio_set_level(N305_POWER_BTN_PIN, 0);
+    ret = board_hal_gpio_set_level(N305_POWER_BTN_PIN, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set N305 power button initial level: %s", esp_err_to_name(ret));
         return ret;
     }
 
     // N305重启引脚默认为低
-    ret = gpio_set_level(N305_RESET_PIN, 0);
+    ret = board_hal_gpio_set_level(N305_RESET_PIN, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set N305 reset pin initial level: %s", esp_err_to_name(ret));
         return ret;
     }
 
+    // 电源正常检测引脚（如已连接）配置为输入
+    uint64_t power_good_mask = 0;
+#if ORIN_POWER_GOOD_PIN >= 0
+    power_good_mask |= 1ULL << ORIN_POWER_GOOD_PIN;
+#endif
+#if N305_POWER_GOOD_PIN >= 0
+    power_good_mask |= 1ULL << N305_POWER_GOOD_PIN;
+#endif
+    if (power_good_mask != 0) {
+        board_hal_gpio_config_t pg_conf = {
+            .mode = BOARD_HAL_GPIO_MODE_INPUT,
+            .pin_bit_mask = power_good_mask,
+            .pull_down_en = false,
+            .pull_up_en = false
+        };
+        ret = board_hal_gpio_config(&pg_conf);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to configure power good inputs: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+
     // 更新状态（默认Orin开机状态）
     s_hardware_status.orin_power_state = POWER_STATE_ON;
     s_hardware_status.n305_power_state = POWER_STATE_UNKNOWN;
@@ -1339,7 +1556,7 @@ static esp_err_t init_power_control_gpio(void)
     return ESP_OK;
 }
 
-static esp_err_t apply_led_color(led_strip_handle_t strip, led_color_t color, uint8_t brightness, uint8_t num_leds)
+static esp_err_t apply_led_color(board_hal_led_strip_t strip, led_color_t color, uint8_t brightness, uint8_t num_leds)
 {
     if (strip == NULL) {
         ESP_LOGE(TAG, "LED strip handle is NULL");
@@ -1351,14 +1568,19 @@ static esp_err_t apply_led_color(led_strip_handle_t strip, led_color_t color, ui
     uint8_t final_b = (color.blue * brightness) / 100;
     
     for (int i = 0; i < num_leds; i++) {
-        esp_err_t ret = led_strip_set_pixel(strip, i, final_r, final_g, final_b);
+        esp_err_t ret = board_hal_led_strip_set_pixel(strip, i, final_r, final_g, final_b);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "Failed to set LED pixel %d: %s", i, esp_err_to_name(ret));
             return ret;
         }
     }
     
-    esp_err_t ret = led_strip_refresh(strip);
+    // RMT发送期间保持全速，刷新结束后允许降频
+    board_hal_pm_lock_acquire(s_led_pm_lock);
+    EVENT_TRACE_BEGIN(EVENT_TRACE_LED_REFRESH, strip == s_board_led_strip ? 0 : 1, num_leds);
+    esp_err_t ret = board_hal_led_strip_refresh(strip);
+    EVENT_TRACE_END(EVENT_TRACE_LED_REFRESH, strip == s_board_led_strip ? 0 : 1, num_leds);
+    board_hal_pm_lock_release(s_led_pm_lock);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to refresh LED strip: %s", esp_err_to_name(ret));
         return ret;
@@ -1367,6 +1589,231 @@ static esp_err_t apply_led_color(led_strip_handle_t strip, led_color_t color, ui
     return ESP_OK;
 }
 
+// Orin恢复模式引脚序列，调用者持有外设锁；任何出口都释放脉冲PM锁并结束脉冲跟踪
+static esp_err_t recovery_sequence_locked(void)
+{
+    // 步骤1: 将GPIO40拉高并保持1000ms
+    ESP_LOGI(TAG, "Step 1: Setting GPIO%d (recovery pin) HIGH", ORIN_RECOVERY_PIN);
+    // esp_err_t ret = board_hal_gpio_set_direction(ORIN_RECOVERY_PIN, BOARD_HAL_GPIO_MODE_OUTPUT);
+    // if (ret != ESP_OK) {
+    //     ESP_LOGE(TAG, "Failed to configure GPIO%d as output: %s", ORIN_RECOVERY_PIN, esp_err_to_name(ret));
+    //     return ret;
+    // }
+    
+    esp_err_t ret = board_hal_gpio_set_level(ORIN_RECOVERY_PIN, GPIO_STATE_HIGH);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set GPIO%d level HIGH: %s", ORIN_RECOVERY_PIN, esp_err_to_name(ret));
+        return ret;
+    }
+    board_hal_pm_lock_acquire(s_pulse_pm_lock);
+    EVENT_TRACE_BEGIN(EVENT_TRACE_POWER_PULSE, ORIN_RECOVERY_PIN, 0);
+    
+    // 注意：不进行状态验证，避免干扰GPIO状态
+    ESP_LOGI(TAG, "GPIO%d set to HIGH, holding for 1000ms...", ORIN_RECOVERY_PIN);
+    board_hal_time_delay_ms(1000);
+
+    // 步骤2: 重启Orin并等待1000ms
+    ESP_LOGI(TAG, "Step 2: Executing Orin reset");
+    ret = orin_reset();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to reset Orin during recovery mode entry");
+        board_hal_pm_lock_release(s_pulse_pm_lock);
+        EVENT_TRACE_END(EVENT_TRACE_POWER_PULSE, ORIN_RECOVERY_PIN, ret);
+        return ret;
+    }
+    ESP_LOGI(TAG, "Orin reset completed, waiting 1000ms");
+    board_hal_time_delay_ms(1000);
+
+    // 步骤3: 将GPIO40拉低
+    ESP_LOGI(TAG, "Step 3: Setting GPIO%d (recovery pin) LOW", ORIN_RECOVERY_PIN);
+    ret = board_hal_gpio_set_level(ORIN_RECOVERY_PIN, 0);
+    board_hal_pm_lock_release(s_pulse_pm_lock);
+    EVENT_TRACE_END(EVENT_TRACE_POWER_PULSE, ORIN_RECOVERY_PIN, ret);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set GPIO%d level LOW: %s", ORIN_RECOVERY_PIN, esp_err_to_name(ret));
+        return ret;
+    }
+    
+    // 注意：不进行状态验证，避免干扰GPIO状态
+    ESP_LOGI(TAG, "GPIO%d set to LOW", ORIN_RECOVERY_PIN);
+
+    // 步骤4: 切换USB MUX到AGX
+    ESP_LOGI(TAG, "Step 4: Switching USB MUX to AGX");
+    ret = usb_mux_set_target(USB_MUX_AGX);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to switch USB MUX to AGX during recovery mode");
+        return ret;
+    }
+
+    return ESP_OK;
+}
+
+// 校验并应用事务，调用者持有外设锁
+static esp_err_t txn_apply_locked(const hw_txn_t *txn)
+{
+    // 未设置的字段沿用当前状态
+    uint32_t fields = txn->fields;
+    hardware_settings_t target = {
+        .fan_speed = (fields & HW_TXN_FAN) ? txn->settings.fan_speed : s_hardware_status.fan_speed,
+        .board_led_color = (fields & HW_TXN_BOARD_COLOR) ?
+                           txn->settings.board_led_color : s_hardware_status.board_led_color,
+        .board_led_brightness = (fields & HW_TXN_BOARD_BRIGHTNESS) ?
+                                txn->settings.board_led_brightness : s_hardware_status.board_led_brightness,
+        .touch_led_color = (fields & HW_TXN_TOUCH_COLOR) ?
+                           txn->settings.touch_led_color : s_hardware_status.touch_led_color,
+        .touch_led_brightness = (fields & HW_TXN_TOUCH_BRIGHTNESS) ?
+                                txn->settings.touch_led_brightness : s_hardware_status.touch_led_brightness,
+    };
+
+    // 先校验全部字段，避免只应用了一部分
+    uint64_t high_mask = txn->gpio_high_mask;
+    uint64_t low_mask = txn->gpio_low_mask;
+    const uint64_t mux_mask = (1ULL << ESP32_MUX1_SEL) | (1ULL << ESP32_MUX2_SEL);
+    bool mux_valid = txn->usb_mux_target == USB_MUX_ESP32S3 || txn->usb_mux_target == USB_MUX_AGX ||
+                     txn->usb_mux_target == USB_MUX_N305;
+
+    if (txn->invalid || target.fan_speed > 100 || target.board_led_brightness > 100 ||
+        target.touch_led_brightness > 100 || ((fields & HW_TXN_USB_MUX) &&
+        (!mux_valid || ((high_mask | low_mask) & mux_mask) != 0))) {
+        ESP_LOGE(TAG, "Invalid hardware transaction (fields 0x%02" PRIx32 ", fan %d%%, brightness %d%%/%d%%)",
+                 fields, target.fan_speed, target.board_led_brightness, target.touch_led_brightness);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+
+    // 风扇优先，尽早恢复散热
+    if (fields & HW_TXN_FAN) {
+        uint32_t duty = (target.fan_speed * 255) / 100;
+        ret = board_hal_pwm_set_duty(FAN_PWM_CHANNEL, duty);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to set fan duty: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        s_hardware_status.fan_speed = target.fan_speed;
+        update_fan_pm_lock(target.fan_speed);
+        EVENT_TRACE(EVENT_TRACE_FAN_SET, target.fan_speed, 0);
+    }
+
+    // USB MUX并入GPIO电平，MUX引脚在初始化时已配置为输出
+    if (fields & HW_TXN_USB_MUX) {
+        if (txn->usb_mux_target == USB_MUX_ESP32S3) {      // mux1=0, mux2=0
+            low_mask |= mux_mask;
+        } else if (txn->usb_mux_target == USB_MUX_AGX) {   // mux1=1, mux2=0
+            high_mask |= 1ULL << ESP32_MUX1_SEL;
+            low_mask |= 1ULL << ESP32_MUX2_SEL;
+        } else {                                            // mux1=1, mux2=1
+            high_mask |= mux_mask;
+        }
+    }
+
+    if (high_mask | low_mask) {
+        // 普通GPIO与 gpio_set_output() 一致，先配置为输出
+        uint64_t user_mask = txn->gpio_high_mask | txn->gpio_low_mask;
+        for (uint8_t pin = 0; user_mask != 0; pin++, user_mask >>= 1) {
+            if ((user_mask & 1) && (ret = board_hal_gpio_set_direction(pin, BOARD_HAL_GPIO_MODE_OUTPUT)) != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to set GPIO%d as output: %s", pin, esp_err_to_name(ret));
+                return ret;
+            }
+        }
+
+        // 每组GPIO各写一次置位/清零寄存器，同组引脚同时变化
+        board_hal_gpio_write_mask(high_mask, low_mask);
+
+        if (fields & HW_TXN_USB_MUX) {
+            s_hardware_status.usb_mux_target = txn->usb_mux_target;
+            EVENT_TRACE(EVENT_TRACE_USB_MUX, txn->usb_mux_target, 0);
+        }
+    }
+
+    // 颜色和亮度都变化时每条灯带也只刷新一次
+    if (fields & (HW_TXN_BOARD_COLOR | HW_TXN_BOARD_BRIGHTNESS)) {
+        s_hardware_status.board_led_color = target.board_led_color;
+        s_hardware_status.board_led_brightness = target.board_led_brightness;
+        ret = apply_led_color(s_board_led_strip, target.board_led_color,
+                              target.board_led_brightness, BOARD_WS2812_NUM);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to apply board LED settings: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+
+    if (fields & (HW_TXN_TOUCH_COLOR | HW_TXN_TOUCH_BRIGHTNESS)) {
+        s_hardware_status.touch_led_color = target.touch_led_color;
+        s_hardware_status.touch_led_brightness = target.touch_led_brightness;
+        ret = apply_led_color(s_touch_led_strip, target.touch_led_color,
+                              target.touch_led_brightness, TOUCH_WS2812_NUM);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to apply touch LED settings: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+
+    return ESP_OK;
+}
+
+static void notify_settings_changed(void)
+{
+    hardware_settings_change_cb_t callback = s_settings_change_cb;
+    if (callback != NULL) {
+        callback();
+    }
+}
+
+static void hw_lock(void)
+{
+    if (s_hw_lock != NULL) {
+        xSemaphoreTakeRecursive(s_hw_lock, portMAX_DELAY);
+    }
+}
+
+static void hw_unlock(void)
+{
+    if (s_hw_lock != NULL) {
+        xSemaphoreGiveRecursive(s_hw_lock);
+    }
+}
+
+static void init_power_management(void)
+{
+    // 控制输出在浅睡眠期间保持正常模式配置，避免睡眠时电平被切换
+    const int hold_pins[] = {
+        ESP32_MUX1_SEL, ESP32_MUX2_SEL, ORIN_POWER_PIN, ORIN_RESET_PIN,
+        ORIN_RECOVERY_PIN, N305_POWER_BTN_PIN, N305_RESET_PIN,
+    };
+    for (size_t i = 0; i < sizeof(hold_pins) / sizeof(hold_pins[0]); i++) {
+        board_hal_gpio_keep_in_sleep(hold_pins[i]);
+    }
+
+    // 未启用CONFIG_PM_ENABLE时创建失败，句柄保持NULL，加锁操作直接跳过
+    esp_err_t ret = board_hal_pm_lock_create(BOARD_HAL_PM_CPU_FREQ_MAX, "hw_led", &s_led_pm_lock);
+    if (ret == ESP_OK) {
+        ret = board_hal_pm_lock_create(BOARD_HAL_PM_NO_LIGHT_SLEEP, "hw_pulse", &s_pulse_pm_lock);
+    }
+    if (ret == ESP_OK) {
+        ret = board_hal_pm_lock_create(BOARD_HAL_PM_NO_LIGHT_SLEEP, "hw_fan", &s_fan_pm_lock);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGI(TAG, "PM locks unavailable: %s", esp_err_to_name(ret));
+    }
+}
+
+static void update_fan_pm_lock(uint8_t speed)
+{
+    // LEDC时钟在浅睡眠中停止，风扇运转时必须保持唤醒
+    bool need_lock = speed > 0;
+    if (need_lock == s_fan_pm_lock_held) {
+        return;
+    }
+
+    if (need_lock) {
+        board_hal_pm_lock_acquire(s_fan_pm_lock);
+    } else {
+        board_hal_pm_lock_release(s_fan_pm_lock);
+    }
+    s_fan_pm_lock_held = need_lock;
+}
+
 static void hsv_to_rgb(int hue, int saturation, int value, uint8_t *r, uint8_t *g, uint8_t *b)
 {
     int c = (value * saturation) / 100;
@@ -1410,32 +1857,43 @@ static esp_err_t disable_jtag_for_gpio40(void)
     ESP_LOGI(TAG, "Disabling JTAG functionality for GPIO40");
     
     // 步骤1: 重置GPIO40，清除所有之前的配置包括JTAG功能
-    esp_err_t ret = gpio_reset_pin(40);
+    esp_err_t ret = board_hal_gpio_reset_pin(40);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to reset GPIO40: %s", esp_err_to_name(ret));
         return ret;
     }
     
+#if !FAST_BOOT_ENABLED
     // 步骤2: 等待硬件稳定
-    vTaskDelay(pdMS_TO_TICKS(50));
+    board_hal_time_delay_ms(50);
+#endif
     
     // 步骤3: 显式地设置GPIO40为输出模式，覆盖JTAG功能
-    ret = gpio_set_direction(40, GPIO_MODE_OUTPUT);
+    ret = board_hal_gpio_set_direction(40, BOARD_HAL_GPIO_MODE_OUTPUT);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set GPIO40 direction: %s", esp_err_to_name(ret));
         return ret;
     }
     
     // 步骤4: 设置默认电平为低
-    ret = gpio_set_level(40, 0);
+    ret = board_hal_gpio_set_level(40, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set GPIO40 level: %s", esp_err_to_name(ret));
         return ret;
     }
     
     // 步骤5: 验证GPIO40可以正常工作
-    vTaskDelay(pdMS_TO_TICKS(10));
-    int level = gpio_get_level(40);
+#if FAST_BOOT_ENABLED
+    // GPIO矩阵配置为同步寄存器写入，轮询回读电平代替固定延时
+    int level = board_hal_gpio_get_level(40);
+    for (int i = 0; i < GPIO40_VERIFY_POLL_COUNT && level != 0; i++) {
+        esp_rom_delay_us(GPIO40_VERIFY_POLL_US);
+        level = board_hal_gpio_get_level(40);
+    }
+#else
+    board_hal_time_delay_ms(10);
+    int level = board_hal_gpio_get_level(40);
+#endif
     if (level != 0) {
         ESP_LOGW(TAG, "GPIO40 level verification failed - expected 0, got %d", level);
         ESP_LOGW(TAG, "This may indicate JTAG is still active or hardware conflict");
@@ -1447,3 +1905,129 @@ static esp_err_t disable_jtag_for_gpio40(void)
     ESP_LOGI(TAG, "Note: USB Serial JTAG is disabled in sdkconfig (CONFIG_USJ_ENABLE_USB_SERIAL_JTAG=n)");
     return ESP_OK;
 }
+
+// ==================== 基准测试用例 ====================
+
+static void register_benchmarks(void)
+{
+    const bench_case_t cases[] = {
+        { .name = "gpio_toggle", .description = "GPIO电平翻转 (未连接的备用引脚)", .op = bench_gpio_toggle,
+          .setup = bench_gpio_setup, .teardown = bench_gpio_teardown, .default_iterations = 10000 },
+        // 运行期间USB设备在ESP32S3与AGX之间反复断开重连
+        { .name = "usb_mux", .description = "USB MUX在ESP32S3与AGX之间切换", .op = bench_usb_mux_switch,
+          .setup = bench_save_usb_mux, .teardown = bench_restore_usb_mux, .default_iterations = 1000,
+          .side_effects = true },
+        { .name = "led_fill", .description = "板载LED缓冲区填充 (不刷新)", .op = bench_led_fill,
+          .setup = bench_lock_board_led, .teardown = bench_restore_board_led, .default_iterations = 2000 },
+        { .name = "led_refresh", .description = "板载LED RMT刷新", .op = bench_led_refresh,
+          .setup = bench_lock_board_led, .teardown = bench_restore_board_led, .default_iterations = 200 },
+        { .name = "hsv", .description = "HSV到RGB转换", .op = bench_hsv, .default_iterations = 10000 },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        // 重复初始化时同名用例已存在，忽略
+        bench_register(&cases[i]);
+    }
+}
+
+static esp_err_t bench_gpio_setup(void *ctx)
+{
+    (void)ctx;
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return board_hal_gpio_set_direction(BENCH_GPIO_PIN, BOARD_HAL_GPIO_MODE_OUTPUT);
+}
+
+static esp_err_t bench_gpio_teardown(void *ctx)
+{
+    (void)ctx;
+    return board_hal_gpio_reset_pin(BENCH_GPIO_PIN);
+}
+
+static esp_err_t bench_save_usb_mux(void *ctx)
+{
+    (void)ctx;
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // 运行期间持有外设锁，其他任务的外设操作等待用例结束，teardown中释放
+    hw_lock();
+    s_bench_mux_target = s_hardware_status.usb_mux_target;
+    return ESP_OK;
+}
+
+static esp_err_t bench_restore_usb_mux(void *ctx)
+{
+    (void)ctx;
+    esp_err_t ret = usb_mux_set_target(s_bench_mux_target);
+    hw_unlock();
+    return ret;
+}
+
+static esp_err_t bench_lock_board_led(void *ctx)
+{
+    (void)ctx;
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    hw_lock();
+    return ESP_OK;
+}
+
+static esp_err_t bench_restore_board_led(void *ctx)
+{
+    (void)ctx;
+    esp_err_t ret = apply_led_color(s_board_led_strip, s_hardware_status.board_led_color,
+                                    s_hardware_status.board_led_brightness, BOARD_WS2812_NUM);
+    hw_unlock();
+    return ret;
+}
+
+static esp_err_t bench_gpio_toggle(void *ctx, uint32_t iteration)
+{
+    (void)ctx;
+    return board_hal_gpio_set_level(BENCH_GPIO_PIN, iteration & 1);
+}
+
+static esp_err_t bench_usb_mux_switch(void *ctx, uint32_t iteration)
+{
+    (void)ctx;
+    return usb_mux_set_target((iteration & 1) ? USB_MUX_AGX : USB_MUX_ESP32S3);
+}
+
+static esp_err_t bench_led_fill(void *ctx, uint32_t iteration)
+{
+    (void)ctx;
+    if (s_board_led_strip == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint8_t level = (uint8_t)(iteration & 0x0F);
+    for (int i = 0; i < BOARD_WS2812_NUM; i++) {
+        esp_err_t ret = board_hal_led_strip_set_pixel(s_board_led_strip, i, level, level, level);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t bench_led_refresh(void *ctx, uint32_t iteration)
+{
+    (void)ctx;
+    (void)iteration;
+    if (s_board_led_strip == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return board_hal_led_strip_refresh(s_board_led_strip);
+}
+
+static esp_err_t bench_hsv(void *ctx, uint32_t iteration)
+{
+    (void)ctx;
+    uint8_t r, g, b;
+    hsv_to_rgb(iteration % 360, 100, 100, &r, &g, &b);
+    s_bench_sink = r ^ g ^ b;
+    return ESP_OK;
+}
@@ -11,8 +11,6 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
-#include "led_strip.h"
-#include "driver/ledc.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,10 +18,8 @@ extern "C" {
 
 // 风扇控制配置
 #define FAN_PWM_PIN         41      // 风扇PWM控制引脚
-#define FAN_PWM_TIMER       LEDC_TIMER_0
-#define FAN_PWM_MODE        LEDC_LOW_SPEED_MODE
-#define FAN_PWM_CHANNEL     LEDC_CHANNEL_0
-#define FAN_PWM_RESOLUTION  LEDC_TIMER_8_BIT
+#define FAN_PWM_CHANNEL     0       // PWM通道（同号定时器）
+#define FAN_PWM_RESOLUTION  8       // 占空比分辨率(位)
 #define FAN_PWM_FREQUENCY   25000   // 25kHz PWM频率
 
 // WS2812 LED配置
@@ -43,6 +39,9 @@ extern "C" {
 #define ESP32_MUX1_SEL      8       // USB MUX1选择引脚 (GPIO8)
 #define ESP32_MUX2_SEL      48      // USB MUX2选择引脚 (GPIO48)
 
+// 未连接的备用引脚，仅供GPIO翻转基准测试使用，改板时须保持悬空
+#define BENCH_SPARE_GPIO    21      // 基准测试备用引脚 (GPIO21)
+
 // Orin电源控制引脚
 #define ORIN_POWER_PIN      3       // Orin关机引脚 (GPIO3)
 #define ORIN_RESET_PIN      1       // Orin重启引脚 (GPIO1)
@@ -52,6 +51,10 @@ extern "C" {
 #define N305_POWER_BTN_PIN  46      // N305电源按钮引脚 (GPIO46)
 #define N305_RESET_PIN      2       // N305重启引脚 (GPIO2)
 
+// 电源正常(Power Good)检测引脚，-1表示未连接；连接后配置为输入并作为浅睡眠唤醒源
+#define ORIN_POWER_GOOD_PIN -1      // Orin电源正常输入引脚
+#define N305_POWER_GOOD_PIN -1      // N305电源正常输入引脚
+
 // 电源控制时序配置
 #define ORIN_RESET_PULSE_MS     1000    // Orin重启脉冲持续时间(毫秒)
 #define N305_POWER_PULSE_MS     300     // N305电源按钮脉冲持续时间(毫秒)
@@ -117,6 +120,52 @@ typedef struct {
     power_state_t n305_power_state;     ///< N305电源状态
 } hardware_status_t;
 
+/**
+ * @brief 可保存/恢复的硬件设置
+ */
+typedef struct {
+    uint8_t fan_speed;                  ///< 风扇速度 (0-100%)
+    led_color_t board_led_color;        ///< 板载LED颜色
+    uint8_t board_led_brightness;       ///< 板载LED亮度 (0-100%)
+    led_color_t touch_led_color;        ///< 触摸LED颜色
+    uint8_t touch_led_brightness;       ///< 触摸LED亮度 (0-100%)
+} hardware_settings_t;
+
+/**
+ * @brief 硬件事务字段标志
+ */
+typedef enum {
+    HW_TXN_FAN              = (1 << 0),     ///< 风扇速度
+    HW_TXN_BOARD_COLOR      = (1 << 1),     ///< 板载LED颜色
+    HW_TXN_BOARD_BRIGHTNESS = (1 << 2),     ///< 板载LED亮度
+    HW_TXN_TOUCH_COLOR      = (1 << 3),     ///< 触摸LED颜色
+    HW_TXN_TOUCH_BRIGHTNESS = (1 << 4),     ///< 触摸LED亮度
+    HW_TXN_USB_MUX          = (1 << 5),     ///< USB MUX目标
+    HW_TXN_GPIO             = (1 << 6),     ///< GPIO输出电平
+} hw_txn_field_t;
+
+/**
+ * @brief 硬件事务
+ * 
+ * 由 hw_txn_begin() 初始化，hw_txn_set_*() 只记录变更，hw_txn_commit() 统一应用
+ */
+typedef struct {
+    uint32_t fields;                    ///< 已设置的字段 (hw_txn_field_t)
+    hardware_settings_t settings;       ///< 风扇与LED目标值
+    usb_mux_target_t usb_mux_target;    ///< USB MUX目标
+    uint64_t gpio_high_mask;            ///< 置高的GPIO
+    uint64_t gpio_low_mask;             ///< 置低的GPIO
+    bool invalid;                       ///< 记录过无效参数
+    bool transient;                     ///< 临时状态，提交后不触发设置变化回调
+} hw_txn_t;
+
+/**
+ * @brief 硬件设置变化回调函数类型
+ * 
+ * 在调用设置接口的任务上下文中执行，应尽快返回
+ */
+typedef void (*hardware_settings_change_cb_t)(void);
+
 // ==================== 初始化接口 ====================
 
 /**
@@ -584,6 +633,144 @@ esp_err_t hardware_get_status(hardware_status_t *status);
  */
 esp_err_t hardware_print_status(void);
 
+// ==================== 批量设置接口 ====================
+
+/**
+ * @brief 一次性应用风扇与LED设置
+ * 
+ * 风扇占空比只更新一次，每条LED灯带只刷新一次，
+ * 用于启动恢复等需要同时设置多项状态的场景
+ * 
+ * @param settings 硬件设置
+ * @return
+ *     - ESP_OK: 应用成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 硬件未初始化
+ */
+esp_err_t hardware_apply_settings(const hardware_settings_t *settings);
+
+/**
+ * @brief 获取当前硬件设置
+ * 
+ * @param settings 存储设置的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 硬件未初始化
+ */
+esp_err_t hardware_get_settings(hardware_settings_t *settings);
+
+/**
+ * @brief 注册硬件设置变化回调
+ * 
+ * 风扇速度、LED颜色或亮度设置成功后调用，LED特效和临时事务 (hw_txn_set_transient) 不触发
+ * 
+ * @param callback 回调函数指针，NULL取消注册
+ * @return
+ *     - ESP_OK: 注册成功
+ */
+esp_err_t hardware_register_settings_change_callback(hardware_settings_change_cb_t callback);
+
+// ==================== 事务接口 ====================
+
+/**
+ * @brief 开始一个硬件事务
+ * 
+ * @param txn 事务
+ */
+void hw_txn_begin(hw_txn_t *txn);
+
+/**
+ * @brief 在事务中设置风扇速度
+ * 
+ * @param txn 事务
+ * @param speed 风扇速度 (0-100%)
+ */
+void hw_txn_set_fan(hw_txn_t *txn, uint8_t speed);
+
+/**
+ * @brief 在事务中设置板载LED颜色
+ * 
+ * @param txn 事务
+ * @param color LED颜色
+ */
+void hw_txn_set_board_led(hw_txn_t *txn, led_color_t color);
+
+/**
+ * @brief 在事务中设置板载LED亮度
+ * 
+ * @param txn 事务
+ * @param brightness 亮度 (0-100%)
+ */
+void hw_txn_set_board_brightness(hw_txn_t *txn, uint8_t brightness);
+
+/**
+ * @brief 在事务中设置触摸LED颜色
+ * 
+ * @param txn 事务
+ * @param color LED颜色
+ */
+void hw_txn_set_touch_led(hw_txn_t *txn, led_color_t color);
+
+/**
+ * @brief 在事务中设置触摸LED亮度
+ * 
+ * @param txn 事务
+ * @param brightness 亮度 (0-100%)
+ */
+void hw_txn_set_touch_brightness(hw_txn_t *txn, uint8_t brightness);
+
+/**
+ * @brief 在事务中设置风扇与全部LED
+ * 
+ * @param txn 事务
+ * @param settings 硬件设置
+ */
+void hw_txn_set_settings(hw_txn_t *txn, const hardware_settings_t *settings);
+
+/**
+ * @brief 在事务中设置USB MUX目标
+ * 
+ * @param txn 事务
+ * @param target 目标设备
+ */
+void hw_txn_set_usb_mux(hw_txn_t *txn, usb_mux_target_t target);
+
+/**
+ * @brief 在事务中设置GPIO输出电平
+ * 
+ * @param txn 事务
+ * @param pin GPIO引脚号
+ * @param state 输出电平
+ */
+void hw_txn_set_gpio(hw_txn_t *txn, uint8_t pin, gpio_state_t state);
+
+/**
+ * @brief 将事务标记为临时状态
+ * 
+ * 关机、睡眠、渐变中间步骤等不应被保存的状态使用，提交后不触发设置变化回调，
+ * 自动保存仍保留此前用户设置的值
+ * 
+ * @param txn 事务
+ */
+void hw_txn_set_transient(hw_txn_t *txn);
+
+/**
+ * @brief 提交事务
+ * 
+ * 先校验全部字段，有任何无效参数时不改动硬件。之后依次：风扇占空比更新一次；
+ * USB MUX与GPIO电平合并后每组GPIO各写一次置位/清零寄存器；每条LED灯带最多刷新一次。
+ * 外设操作失败时返回错误，此前已应用的部分保持生效。
+ * 
+ * @param txn 事务
+ * @return
+ *     - ESP_OK: 提交成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 硬件未初始化
+ *     - 其他: 外设操作失败
+ */
+esp_err_t hw_txn_commit(hw_txn_t *txn);
+
 #ifdef __cplusplus
 }
 #endif
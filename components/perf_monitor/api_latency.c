@@ -0,0 +1,211 @@
+/**
+ * @file api_latency.c
+ * @brief ESP32S3 API调用延迟直方图实现
+ */
+
+#include "api_latency.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "board_hal.h"
+
+static const char *TAG = "API_LATENCY";
+
+// ==================== 静态变量 ====================
+
+static api_latency_site_t *s_sites = NULL;     // 注册链表头，仅通过原子操作修改
+
+// ==================== 静态函数声明 ====================
+
+static void register_site(api_latency_site_t *site);
+static uint32_t percentile_us(const uint32_t *buckets, uint32_t count, uint32_t percent);
+
+// ==================== 记录接口实现 ====================
+
+api_latency_scope_t api_latency_scope_begin(api_latency_site_t *site)
+{
+    api_latency_scope_t scope = {
+        .site = site,
+        .core = board_hal_cpu_get_core_id(),
+        .start_us = esp_timer_get_time(),
+    };
+    return scope;
+}
+
+void api_latency_scope_end(api_latency_scope_t *scope)
+{
+    int64_t elapsed_us = esp_timer_get_time() - scope->start_us;
+    int core = board_hal_cpu_get_core_id();
+
+    // esp_timer 两核共用，迁移后的样本仍然有效，只计数供参考
+    if (core != scope->core) {
+        if (!scope->site->registered) {
+            register_site(scope->site);
+        }
+        __atomic_fetch_add(&scope->site->migrated, 1, __ATOMIC_RELAXED);
+    }
+
+    api_latency_record(scope->site, core, elapsed_us > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed_us);
+}
+
+void api_latency_record(api_latency_site_t *site, int core, uint32_t elapsed_us)
+{
+    if (site == NULL || core < 0 || core >= API_LATENCY_MAX_CORES) {
+        return;
+    }
+
+    if (!site->registered) {
+        register_site(site);
+    }
+
+    api_latency_core_stats_t *stats = &site->core[core];
+    int bucket = 31 - __builtin_clz(elapsed_us | 1);
+
+    // 每个核心只写自己的计数，原子加法防止同核任务抢占时丢失更新
+    __atomic_fetch_add(&stats->buckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->count, 1, __ATOMIC_RELAXED);
+
+    // 64位累加拆成两个32位原子操作，由发生回绕的一方负责进位
+    uint32_t prev_lo = __atomic_fetch_add(&stats->total_us_lo, elapsed_us, __ATOMIC_RELAXED);
+    if (prev_lo + elapsed_us < prev_lo) {
+        __atomic_fetch_add(&stats->total_us_hi, 1, __ATOMIC_RELAXED);
+    }
+
+    uint32_t prev_max = __atomic_load_n(&stats->max_us, __ATOMIC_RELAXED);
+    while (elapsed_us > prev_max &&
+           !__atomic_compare_exchange_n(&stats->max_us, &prev_max, elapsed_us, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+// ==================== 查询接口实现 ====================
+
+const api_latency_site_t *api_latency_first(void)
+{
+    return __atomic_load_n(&s_sites, __ATOMIC_ACQUIRE);
+}
+
+esp_err_t api_latency_get_summary(const api_latency_site_t *site, api_latency_summary_t *summary)
+{
+    if (site == NULL || summary == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(summary, 0, sizeof(*summary));
+    summary->name = site->name;
+    summary->migrated = site->migrated;
+
+    uint32_t buckets[API_LATENCY_BUCKETS] = {0};
+    uint64_t total_us = 0;
+    uint32_t max_us = 0;
+
+    for (int core = 0; core < API_LATENCY_MAX_CORES; core++) {
+        const api_latency_core_stats_t *stats = &site->core[core];
+        summary->core_count[core] = stats->count;
+        summary->count += stats->count;
+        total_us += ((uint64_t)stats->total_us_hi << 32) | stats->total_us_lo;
+        if (stats->max_us > max_us) {
+            max_us = stats->max_us;
+        }
+        for (int b = 0; b < API_LATENCY_BUCKETS; b++) {
+            buckets[b] += stats->buckets[b];
+        }
+    }
+
+    if (summary->count == 0) {
+        return ESP_OK;
+    }
+
+    summary->avg_us = (uint32_t)(total_us / summary->count);
+    summary->p50_us = percentile_us(buckets, summary->count, 50);
+    summary->p90_us = percentile_us(buckets, summary->count, 90);
+    summary->p99_us = percentile_us(buckets, summary->count, 99);
+    summary->max_us = max_us;
+
+    // 分桶上界可能超过实际最大值
+    if (summary->p50_us > summary->max_us) summary->p50_us = summary->max_us;
+    if (summary->p90_us > summary->max_us) summary->p90_us = summary->max_us;
+    if (summary->p99_us > summary->max_us) summary->p99_us = summary->max_us;
+
+    return ESP_OK;
+}
+
+esp_err_t api_latency_print(const char *filter)
+{
+    printf("\n=== API调用延迟 (us, 分位数为log2分桶上界) ===\n");
+    printf("%-28s %8s %8s %8s %8s %8s %8s %7s %7s\n",
+           "API", "次数", "平均", "p50", "p90", "p99", "最大", "核0", "核1");
+
+    int shown = 0;
+    for (const api_latency_site_t *site = api_latency_first(); site != NULL; site = site->next) {
+        if (filter != NULL && strstr(site->name, filter) == NULL) {
+            continue;
+        }
+
+        api_latency_summary_t summary;
+        api_latency_get_summary(site, &summary);
+        if (summary.count == 0) {
+            continue;
+        }
+
+        printf("%-28s %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %7" PRIu32 " %7" PRIu32,
+               summary.name, summary.count, summary.avg_us, summary.p50_us, summary.p90_us,
+               summary.p99_us, summary.max_us, summary.core_count[0], summary.core_count[1]);
+        if (summary.migrated > 0) {
+            printf("  (迁移 %" PRIu32 ")", summary.migrated);
+        }
+        printf("\n");
+        shown++;
+    }
+
+    if (shown == 0) {
+        printf("暂无数据\n");
+    }
+    printf("================\n");
+    return ESP_OK;
+}
+
+esp_err_t api_latency_reset(void)
+{
+    for (api_latency_site_t *site = __atomic_load_n(&s_sites, __ATOMIC_ACQUIRE); site != NULL; site = site->next) {
+        __atomic_store_n(&site->migrated, 0, __ATOMIC_RELAXED);
+        for (int core = 0; core < API_LATENCY_MAX_CORES; core++) {
+            // 清零与并发记录之间允许少量误差
+            memset(&site->core[core], 0, sizeof(site->core[core]));
+        }
+    }
+
+    ESP_LOGI(TAG, "API latency statistics reset");
+    return ESP_OK;
+}
+
+// ==================== 静态函数实现 ====================
+
+static void register_site(api_latency_site_t *site)
+{
+    // 只有第一个把registered置1的调用者负责入链
+    if (__atomic_exchange_n(&site->registered, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    api_latency_site_t *head = __atomic_load_n(&s_sites, __ATOMIC_ACQUIRE);
+    do {
+        site->next = head;
+    } while (!__atomic_compare_exchange_n(&s_sites, &head, site, true, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+}
+
+static uint32_t percentile_us(const uint32_t *buckets, uint32_t count, uint32_t percent)
+{
+    uint64_t target = ((uint64_t)count * percent + 99) / 100;
+    uint64_t seen = 0;
+
+    for (int b = 0; b < API_LATENCY_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= target) {
+            return b >= 31 ? UINT32_MAX : ((1UL << (b + 1)) - 1);
+        }
+    }
+    return UINT32_MAX;
+}
@@ -0,0 +1,514 @@
+/**
+ * @file bench.c
+ * @brief ESP32S3 吞吐量基准测试框架实现
+ */
+
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_app_desc.h"
+#include "board_hal.h"
+
+static const char *TAG = "BENCH";
+
+#define BENCH_CALIBRATE_ROUNDS      64      // 计时开销标定次数
+#define BENCH_TIME_CHECK_MASK       0x0F    // 每16次操作读取一次时间
+
+/**
+ * @brief 一次运行的上下文，在运行任务与调用者之间传递
+ */
+typedef struct {
+    const bench_case_t *bench;
+    bench_params_t params;
+    bench_result_t *result;
+    uint32_t *samples;
+    TaskHandle_t caller;
+} bench_run_t;
+
+// ==================== 静态变量 ====================
+
+static bench_case_t s_cases[BENCH_MAX_CASES];
+static uint32_t s_case_count = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_running = false;
+static bool s_in_print = false;
+static volatile bool s_abort = false;
+static board_hal_pm_lock_t s_freq_lock = NULL;
+static board_hal_pm_lock_t s_sleep_lock = NULL;
+static bool s_pm_locks_created = false;
+
+// ==================== 静态函数声明 ====================
+
+static const bench_case_t *find_case(const char *name);
+static void bench_task(void *arg);
+static void run_case(bench_run_t *run);
+static uint32_t calibrate_overhead(void);
+static esp_err_t empty_op(void *ctx, uint32_t iteration);
+static uint32_t next_random(uint32_t *state);
+static int compare_u32(const void *a, const void *b);
+static uint32_t cycles_to_ns(uint64_t cycles, uint32_t cpu_mhz);
+static void create_pm_locks(void);
+static void print_result_row(const bench_result_t *result);
+static void print_result_line(const bench_result_t *result);
+
+// ==================== 注册接口实现 ====================
+
+esp_err_t bench_register(const bench_case_t *bench)
+{
+    if (bench == NULL || bench->name == NULL || bench->op == NULL || strchr(bench->name, ' ') != NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&s_lock);
+    if (find_case(bench->name) != NULL) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else if (s_case_count >= BENCH_MAX_CASES) {
+        ret = ESP_ERR_NO_MEM;
+    } else {
+        s_cases[s_case_count++] = *bench;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (ret == ESP_ERR_NO_MEM) {
+        ESP_LOGW(TAG, "Benchmark table full, '%s' not registered", bench->name);
+    }
+    return ret;
+}
+
+uint32_t bench_get_count(void)
+{
+    return s_case_count;
+}
+
+uint32_t bench_get_all_count(void)
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < s_case_count; i++) {
+        if (!s_cases[i].side_effects) {
+            count++;
+        }
+    }
+    return count;
+}
+
+const bench_case_t *bench_get(uint32_t index)
+{
+    if (index >= s_case_count) {
+        return NULL;
+    }
+    return &s_cases[index];
+}
+
+// ==================== 运行接口实现 ====================
+
+esp_err_t bench_run(const char *name, const bench_params_t *params, bench_result_t *result)
+{
+    if (name == NULL || result == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bench_params_t run_params = BENCH_DEFAULT_PARAMS();
+    if (params != NULL) {
+        run_params = *params;
+    }
+    if (run_params.duration_ms > BENCH_MAX_DURATION_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const bench_case_t *bench = find_case(name);
+    if (bench == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (run_params.iterations == 0) {
+        run_params.iterations = bench->default_iterations > 0 ? bench->default_iterations : BENCH_DEFAULT_ITERATIONS;
+    }
+
+    bool busy;
+    portENTER_CRITICAL(&s_lock);
+    busy = s_running;
+    s_running = true;
+    if (!busy && !s_in_print) {
+        s_abort = false;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    if (busy) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_OK;
+    bench_run_t run = {
+        .bench = bench,
+        .params = run_params,
+        .result = result,
+        .samples = malloc(BENCH_MAX_SAMPLES * sizeof(uint32_t)),
+        .caller = xTaskGetCurrentTaskHandle(),
+    };
+    if (run.samples == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto done;
+    }
+
+    create_pm_locks();
+    board_hal_pm_lock_acquire(s_freq_lock);
+    board_hal_pm_lock_acquire(s_sleep_lock);
+
+    // 日志输出会主导被测操作的耗时，运行期间只保留警告和错误
+    esp_log_level_t log_level = esp_log_level_get("*");
+    if (log_level > ESP_LOG_WARN) {
+        esp_log_level_set("*", ESP_LOG_WARN);
+    }
+
+    // 固定在当前核心的独立任务中运行，周期计数不会因核心迁移失效
+    TaskHandle_t task = NULL;
+    if (xTaskCreatePinnedToCore(bench_task, "bench", BENCH_TASK_STACK_SIZE, &run,
+                                uxTaskPriorityGet(NULL), &task, xPortGetCoreID()) == pdPASS) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    } else {
+        ret = ESP_ERR_NO_MEM;
+    }
+
+    esp_log_level_set("*", log_level);
+    board_hal_pm_lock_release(s_sleep_lock);
+    board_hal_pm_lock_release(s_freq_lock);
+
+done:
+    free(run.samples);
+    portENTER_CRITICAL(&s_lock);
+    s_running = false;
+    portEXIT_CRITICAL(&s_lock);
+    return ret;
+}
+
+esp_err_t bench_run_print(const char *name, const bench_params_t *params)
+{
+    bool run_all = name == NULL || strcmp(name, "all") == 0;
+    if (!run_all && find_case(name) == NULL) {
+        printf("未知的基准测试: %s\n", name);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint32_t count = run_all ? s_case_count : 1;
+    bench_result_t *results = calloc(count > 0 ? count : 1, sizeof(bench_result_t));
+    if (results == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_in_print = true;
+    s_abort = false;
+    portEXIT_CRITICAL(&s_lock);
+
+    esp_err_t ret = ESP_OK;
+    uint32_t done = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (s_abort) {
+            break;
+        }
+        // 有副作用的用例（切换USB路由、写闪存等）只在按名称指定时运行
+        if (run_all && s_cases[i].side_effects) {
+            continue;
+        }
+        const char *case_name = run_all ? s_cases[i].name : name;
+        printf("运行 %s ...\n", case_name);
+        esp_err_t err = bench_run(case_name, params, &results[done]);
+        if (err != ESP_OK) {
+            printf("运行 %s 失败: %s\n", case_name, esp_err_to_name(err));
+            ret = err;
+            continue;
+        }
+        if (results[done].status != ESP_OK) {
+            ret = ESP_FAIL;
+        }
+        done++;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_in_print = false;
+    portEXIT_CRITICAL(&s_lock);
+    if (s_abort) {
+        printf("基准测试已中止\n");
+        ret = ESP_ERR_NOT_FINISHED;
+    }
+
+    printf("\n=== 基准测试结果 (延迟单位 ns) ===\n");
+    printf("%-16s %4s %8s %10s %9s %9s %9s %9s %9s\n",
+           "名称", "模式", "次数", "ops/s", "平均", "p50", "p99", "最大", "周期/次");
+    for (uint32_t i = 0; i < done; i++) {
+        print_result_row(&results[i]);
+    }
+    if (done == 0) {
+        printf("暂无数据\n");
+    }
+    printf("================\n");
+
+    // 机器可读输出，供 tools/bench_compare.py 比较不同固件构建
+    const esp_app_desc_t *app = esp_app_get_description();
+    char elf_sha[17] = "unknown";
+    esp_app_get_elf_sha256(elf_sha, sizeof(elf_sha));
+    printf("BENCH BEGIN %d %s %s %s %" PRIu32 "\n", BENCH_OUTPUT_VERSION, app->version, elf_sha,
+           app->idf_ver, done > 0 ? results[0].cpu_freq_mhz : board_hal_cpu_get_mhz());
+    for (uint32_t i = 0; i < done; i++) {
+        print_result_line(&results[i]);
+    }
+    printf("BENCH END\n");
+
+    free(results);
+    return ret;
+}
+
+esp_err_t bench_abort(void)
+{
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&s_lock);
+    if (s_running || s_in_print) {
+        s_abort = true;
+    } else {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return ret;
+}
+
+esp_err_t bench_print_list(void)
+{
+    printf("\n=== 基准测试用例 ===\n");
+    printf("%-16s %8s  %s\n", "名称", "默认次数", "说明");
+    for (uint32_t i = 0; i < s_case_count; i++) {
+        const bench_case_t *bench = &s_cases[i];
+        printf("%-16s %8" PRIu32 " %c%s\n", bench->name,
+               bench->default_iterations > 0 ? bench->default_iterations : (uint32_t)BENCH_DEFAULT_ITERATIONS,
+               bench->side_effects ? '*' : ' ', bench->description != NULL ? bench->description : "");
+    }
+    if (s_case_count == 0) {
+        printf("暂无用例\n");
+    } else if (bench_get_all_count() < s_case_count) {
+        printf("* 有副作用，不参与 all 和压力测试，须按名称运行\n");
+    }
+    printf("================\n");
+    return ESP_OK;
+}
+
+// ==================== 静态函数实现 ====================
+
+static const bench_case_t *find_case(const char *name)
+{
+    for (uint32_t i = 0; i < s_case_count; i++) {
+        if (strcmp(s_cases[i].name, name) == 0) {
+            return &s_cases[i];
+        }
+    }
+    return NULL;
+}
+
+static void bench_task(void *arg)
+{
+    bench_run_t *run = (bench_run_t *)arg;
+    run_case(run);
+    xTaskNotifyGive(run->caller);
+    vTaskDelete(NULL);
+}
+
+static void run_case(bench_run_t *run)
+{
+    const bench_case_t *bench = run->bench;
+    const bench_params_t *params = &run->params;
+    bench_result_t *result = run->result;
+
+    memset(result, 0, sizeof(*result));
+    result->name = bench->name;
+    result->timed = params->duration_ms > 0;
+    result->cpu_freq_mhz = board_hal_cpu_get_mhz();
+    result->overhead_cycles = calibrate_overhead();
+
+    if (bench->setup != NULL) {
+        result->status = bench->setup(bench->ctx);
+        if (result->status != ESP_OK) {
+            ESP_LOGW(TAG, "Benchmark '%s' setup failed: %s", bench->name, esp_err_to_name(result->status));
+            return;
+        }
+    }
+
+    uint32_t iteration = 0;
+    for (; iteration < params->warmup && result->status == ESP_OK; iteration++) {
+        result->status = bench->op(bench->ctx, iteration);
+    }
+
+    uint64_t total_cycles = 0;
+    uint32_t min_cycles = UINT32_MAX;
+    uint32_t max_cycles = 0;
+    uint32_t random_state = 0x9E3779B9u;
+    int64_t yielded_us = 0;
+    int64_t start_us = esp_timer_get_time();
+    int64_t now_us = start_us;
+    int64_t deadline_us = start_us + (int64_t)params->duration_ms * 1000;
+    int64_t next_yield_us = start_us + BENCH_YIELD_INTERVAL_MS * 1000;
+
+    while (result->status == ESP_OK) {
+        if (result->timed ? now_us - yielded_us >= deadline_us : result->ops >= params->iterations) {
+            break;
+        }
+
+        uint32_t start = board_hal_cpu_get_cycle_count();
+        esp_err_t err = bench->op(bench->ctx, iteration++);
+        uint32_t cycles = board_hal_cpu_get_cycle_count() - start;
+        if (err != ESP_OK) {
+            result->status = err;
+            break;
+        }
+
+        cycles = cycles > result->overhead_cycles ? cycles - result->overhead_cycles : 0;
+        total_cycles += cycles;
+        if (cycles < min_cycles) {
+            min_cycles = cycles;
+        }
+        if (cycles > max_cycles) {
+            max_cycles = cycles;
+        }
+
+        // 水塘抽样：样本缓冲区满后每个操作以相同概率留在样本中
+        if (result->ops < BENCH_MAX_SAMPLES) {
+            run->samples[result->ops] = cycles;
+        } else {
+            uint32_t slot = next_random(&random_state) % (result->ops + 1);
+            if (slot < BENCH_MAX_SAMPLES) {
+                run->samples[slot] = cycles;
+            }
+        }
+        result->ops++;
+
+        if ((result->ops & BENCH_TIME_CHECK_MASK) == 0 || result->timed) {
+            now_us = esp_timer_get_time();
+            if (now_us >= next_yield_us) {
+                if (s_abort) {
+                    result->status = ESP_ERR_NOT_FINISHED;
+                    break;
+                }
+                vTaskDelay(1);
+                int64_t resumed_us = esp_timer_get_time();
+                yielded_us += resumed_us - now_us;
+                now_us = resumed_us;
+                next_yield_us = now_us + BENCH_YIELD_INTERVAL_MS * 1000;
+            }
+        }
+    }
+    now_us = esp_timer_get_time();
+
+    if (bench->teardown != NULL) {
+        esp_err_t err = bench->teardown(bench->ctx);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Benchmark '%s' teardown failed: %s", bench->name, esp_err_to_name(err));
+        }
+    }
+
+    result->elapsed_us = (uint64_t)(now_us - start_us - yielded_us);
+    if (result->ops == 0) {
+        return;
+    }
+
+    result->samples = result->ops < BENCH_MAX_SAMPLES ? result->ops : BENCH_MAX_SAMPLES;
+    qsort(run->samples, result->samples, sizeof(uint32_t), compare_u32);
+
+    uint32_t cpu_mhz = result->cpu_freq_mhz;
+    if (result->elapsed_us > 0) {
+        result->ops_per_sec = (uint32_t)((uint64_t)result->ops * 1000000ULL / result->elapsed_us);
+    }
+    result->cycles_per_op = (uint32_t)(total_cycles / result->ops);
+    result->mean_ns = cycles_to_ns(total_cycles / result->ops, cpu_mhz);
+    result->p50_ns = cycles_to_ns(run->samples[(result->samples - 1) * 50 / 100], cpu_mhz);
+    result->p99_ns = cycles_to_ns(run->samples[(result->samples - 1) * 99 / 100], cpu_mhz);
+    result->min_ns = cycles_to_ns(min_cycles, cpu_mhz);
+    result->max_ns = cycles_to_ns(max_cycles, cpu_mhz);
+}
+
+static uint32_t calibrate_overhead(void)
+{
+    // 通过函数指针调用空操作，得到计时与间接调用本身的最小开销
+    bench_op_fn_t volatile op = empty_op;
+    uint32_t overhead = UINT32_MAX;
+    for (uint32_t i = 0; i < BENCH_CALIBRATE_ROUNDS; i++) {
+        uint32_t start = board_hal_cpu_get_cycle_count();
+        op(NULL, i);
+        uint32_t cycles = board_hal_cpu_get_cycle_count() - start;
+        if (cycles < overhead) {
+            overhead = cycles;
+        }
+    }
+    return overhead;
+}
+
+static esp_err_t __attribute__((noinline)) empty_op(void *ctx, uint32_t iteration)
+{
+    (void)ctx;
+    (void)iteration;
+    return ESP_OK;
+}
+
+static uint32_t next_random(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t cycles_to_ns(uint64_t cycles, uint32_t cpu_mhz)
+{
+    if (cpu_mhz == 0) {
+        return 0;
+    }
+    uint64_t ns = cycles * 1000ULL / cpu_mhz;
+    return ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns;
+}
+
+static void create_pm_locks(void)
+{
+    if (s_pm_locks_created) {
+        return;
+    }
+    s_pm_locks_created = true;
+
+    // 未启用CONFIG_PM_ENABLE时创建失败，句柄保持NULL，频率本就固定
+    esp_err_t ret = board_hal_pm_lock_create(BOARD_HAL_PM_CPU_FREQ_MAX, "bench_freq", &s_freq_lock);
+    if (ret == ESP_OK) {
+        ret = board_hal_pm_lock_create(BOARD_HAL_PM_NO_LIGHT_SLEEP, "bench_sleep", &s_sleep_lock);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGI(TAG, "PM locks unavailable: %s", esp_err_to_name(ret));
+    }
+}
+
+static void print_result_row(const bench_result_t *result)
+{
+    printf("%-16s %4s %8" PRIu32 " %10" PRIu32 " %9" PRIu32 " %9" PRIu32 " %9" PRIu32 " %9" PRIu32 " %9" PRIu32,
+           result->name, result->timed ? "时长" : "次数", result->ops, result->ops_per_sec,
+           result->mean_ns, result->p50_ns, result->p99_ns, result->max_ns, result->cycles_per_op);
+    if (result->status != ESP_OK) {
+        printf("  (中止: %s)", esp_err_to_name(result->status));
+    }
+    printf("\n");
+}
+
+static void print_result_line(const bench_result_t *result)
+{
+    printf("BENCH RESULT %s %s %s %" PRIu32 " %" PRIu64 " %" PRIu32 " %" PRIu32 " %" PRIu32
+           " %" PRIu32 " %" PRIu32 " %" PRIu32 " %" PRIu32 "\n",
+           result->name, result->timed ? "time" : "iter", esp_err_to_name(result->status),
+           result->ops, result->elapsed_us, result->ops_per_sec, result->mean_ns, result->p50_ns,
+           result->p99_ns, result->max_ns, result->cycles_per_op, result->cpu_freq_mhz);
+}
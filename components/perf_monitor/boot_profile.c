@@ -0,0 +1,140 @@
+/**
+ * @file boot_profile.c
+ * @brief ESP32S3 启动阶段计时实现
+ */
+
+#include "boot_profile.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "event_trace.h"
+
+static const char *TAG = "BOOT_PROFILE";
+
+#define BOOT_PROFILE_BAR_WIDTH      30
+
+// ==================== 静态变量 ====================
+
+static boot_profile_phase_t s_phases[BOOT_PROFILE_MAX_PHASES];
+static uint32_t s_phase_count = 0;
+static int64_t s_total_us = 0;
+static bool s_complete = false;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// ==================== 静态函数声明 ====================
+
+static bool record_phase(const char *name, bool complete);
+
+// ==================== 接口实现 ====================
+
+void boot_profile_mark(const char *name)
+{
+    record_phase(name, false);
+}
+
+void boot_profile_complete(const char *name)
+{
+    if (record_phase(name, true)) {
+        ESP_LOGI(TAG, "Boot completed in %" PRId64 " ms", s_total_us / 1000);
+    }
+}
+
+bool boot_profile_is_complete(void)
+{
+    return s_complete;
+}
+
+int64_t boot_profile_get_total_us(void)
+{
+    return s_complete ? s_total_us : 0;
+}
+
+uint32_t boot_profile_get_count(void)
+{
+    return s_phase_count;
+}
+
+esp_err_t boot_profile_get_phase(uint32_t index, boot_profile_phase_t *phase)
+{
+    if (phase == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (index >= s_phase_count) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    *phase = s_phases[index];
+    portEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+esp_err_t boot_profile_print(void)
+{
+    printf("\n=== 启动阶段耗时 (自应用启动，不含ROM/引导程序) ===\n");
+    printf("快速启动: %s\n", FAST_BOOT_ENABLED ? "启用" : "禁用");
+
+    if (s_phase_count == 0) {
+        printf("暂无数据\n");
+        printf("================\n");
+        return ESP_OK;
+    }
+
+    int64_t total_us = s_complete ? s_total_us : s_phases[s_phase_count - 1].end_us;
+
+    printf("%-20s %10s %10s %6s\n", "阶段", "结束(ms)", "耗时(ms)", "占比");
+    for (uint32_t i = 0; i < s_phase_count; i++) {
+        boot_profile_phase_t phase;
+        boot_profile_get_phase(i, &phase);
+
+        uint32_t percent = total_us > 0 ? (uint32_t)((int64_t)phase.duration_us * 100 / total_us) : 0;
+        char bar[BOOT_PROFILE_BAR_WIDTH + 1];
+        uint32_t bar_len = percent * BOOT_PROFILE_BAR_WIDTH / 100;
+        memset(bar, '#', bar_len);
+        bar[bar_len] = '\0';
+
+        printf("%-20s %6" PRId64 ".%03" PRId64 " %6" PRIu32 ".%03" PRIu32 " %5" PRIu32 "%% %s\n",
+               phase.name, phase.end_us / 1000, phase.end_us % 1000,
+               phase.duration_us / 1000, phase.duration_us % 1000, percent, bar);
+    }
+
+    if (s_complete) {
+        printf("总计: %" PRId64 ".%03" PRId64 " ms\n", total_us / 1000, total_us % 1000);
+    } else {
+        printf("启动尚未完成\n");
+    }
+    printf("================\n");
+    return ESP_OK;
+}
+
+// ==================== 静态函数实现 ====================
+
+static bool record_phase(const char *name, bool complete)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t index;
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_complete || s_phase_count >= BOOT_PROFILE_MAX_PHASES) {
+        portEXIT_CRITICAL(&s_lock);
+        return false;
+    }
+
+    index = s_phase_count++;
+    int64_t prev_us = index > 0 ? s_phases[index - 1].end_us : 0;
+    s_phases[index].name = name;
+    s_phases[index].end_us = now;
+    s_phases[index].duration_us = (uint32_t)(now - prev_us);
+
+    if (complete) {
+        s_total_us = now;
+        s_complete = true;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    EVENT_TRACE(EVENT_TRACE_BOOT_PHASE, index, (uint32_t)now);
+    return true;
+}
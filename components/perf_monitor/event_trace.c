@@ -0,0 +1,224 @@
+/**
+ * @file event_trace.c
+ * @brief ESP32S3 二进制事件跟踪缓冲区实现
+ */
+
+#include "event_trace.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "board_hal.h"
+
+static const char *TAG = "EVENT_TRACE";
+
+#define EVENT_TRACE_RING_MASK       (EVENT_TRACE_RING_LEN - 1)
+#define EVENT_TRACE_RECORDS_PER_LINE 8
+
+// 写入路径只调用强制内联的 board_hal CPU接口和 esp_timer_get_time，后者仅在
+// CONFIG_ESP_TIMER_IN_IRAM 时位于IRAM；否则写入路径留在flash，cache关闭期间不可调用
+#if CONFIG_IDF_TARGET_LINUX || CONFIG_ESP_TIMER_IN_IRAM
+#define EVENT_TRACE_IRAM_ATTR       IRAM_ATTR
+#else
+#define EVENT_TRACE_IRAM_ATTR
+#endif
+
+_Static_assert((EVENT_TRACE_RING_LEN & EVENT_TRACE_RING_MASK) == 0, "EVENT_TRACE_RING_LEN must be a power of two");
+_Static_assert(sizeof(event_trace_record_t) == 12, "event_trace_record_t must be packed to 12 bytes");
+
+/**
+ * @brief 事件码名称
+ */
+typedef struct {
+    uint16_t code;
+    const char *name;
+} event_trace_name_t;
+
+// ==================== 静态变量 ====================
+
+static event_trace_record_t s_ring[EVENT_TRACE_MAX_CORES][EVENT_TRACE_RING_LEN];
+static uint32_t s_head[EVENT_TRACE_MAX_CORES];              // 单调递增的写入计数
+static int64_t s_last_sync_us[EVENT_TRACE_MAX_CORES];
+static bool s_synced[EVENT_TRACE_MAX_CORES];
+static bool s_enabled = true;                               // 只通过原子操作访问
+static uint32_t s_writers = 0;                              // 正在写入的任务/中断数
+
+static const event_trace_name_t s_names[] = {
+    { EVENT_TRACE_SYNC,          "sync" },
+    { EVENT_TRACE_POWER_PULSE,   "power_pulse" },
+    { EVENT_TRACE_RECOVERY,      "orin_recovery" },
+    { EVENT_TRACE_USB_MUX,       "usb_mux" },
+    { EVENT_TRACE_LED_REFRESH,   "led_refresh" },
+    { EVENT_TRACE_FAN_SET,       "fan_set" },
+    { EVENT_TRACE_CONSOLE_CMD,   "console_cmd" },
+    { EVENT_TRACE_CONSOLE_RPC,   "console_rpc" },
+    { EVENT_TRACE_MONITOR_CYCLE, "monitor_cycle" },
+    { EVENT_TRACE_BOOT_PHASE,    "boot_phase" },
+};
+
+// ==================== 静态函数声明 ====================
+
+static void write_record(int core, uint32_t time_us, uint16_t id, uint16_t arg0, uint32_t arg1);
+static bool pause_writers(void);
+
+// ==================== 记录接口实现 ====================
+
+void EVENT_TRACE_IRAM_ATTR event_trace_emit(uint16_t id, uint16_t arg0, uint32_t arg1)
+{
+    // 先登记为写入者再检查开关，与 pause_writers() 的先关开关再等待写入者配对
+    __atomic_fetch_add(&s_writers, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&s_enabled, __ATOMIC_SEQ_CST)) {
+        __atomic_fetch_sub(&s_writers, 1, __ATOMIC_RELEASE);
+        return;
+    }
+
+    // 任务可能在读取核心号后迁移，槽位由原子加法预留，写入另一核心的缓冲区也不会冲突
+    int core = board_hal_cpu_get_core_id();
+    int64_t now_us = esp_timer_get_time();
+
+    // 距上次同步过久时先写入同步事件，记录时间高32位；同核中断与任务同时判断时最多多写一条
+    if (core >= 0 && core < EVENT_TRACE_MAX_CORES) {
+        if (!s_synced[core] || now_us - s_last_sync_us[core] >= EVENT_TRACE_SYNC_INTERVAL_MS * 1000LL) {
+            s_synced[core] = true;
+            s_last_sync_us[core] = now_us;
+            write_record(core, (uint32_t)now_us, EVENT_TRACE_SYNC, (uint16_t)board_hal_cpu_get_mhz(),
+                         (uint32_t)((uint64_t)now_us >> 32));
+        }
+        write_record(core, (uint32_t)now_us, id, arg0, arg1);
+    }
+
+    __atomic_fetch_sub(&s_writers, 1, __ATOMIC_RELEASE);
+}
+
+void event_trace_enable(bool enable)
+{
+    __atomic_store_n(&s_enabled, enable, __ATOMIC_SEQ_CST);
+    ESP_LOGI(TAG, "Event trace %s", enable ? "enabled" : "disabled");
+}
+
+esp_err_t event_trace_clear(void)
+{
+    bool was_enabled = pause_writers();
+
+    memset(s_ring, 0, sizeof(s_ring));
+    for (int core = 0; core < EVENT_TRACE_MAX_CORES; core++) {
+        __atomic_store_n(&s_head[core], 0, __ATOMIC_RELAXED);
+        s_synced[core] = false;
+    }
+
+    __atomic_store_n(&s_enabled, was_enabled, __ATOMIC_SEQ_CST);
+    ESP_LOGI(TAG, "Event trace cleared");
+    return ESP_OK;
+}
+
+// ==================== 查询接口实现 ====================
+
+esp_err_t event_trace_get_stats(event_trace_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    stats->enabled = __atomic_load_n(&s_enabled, __ATOMIC_RELAXED);
+    for (int core = 0; core < EVENT_TRACE_MAX_CORES; core++) {
+        uint32_t head = __atomic_load_n(&s_head[core], __ATOMIC_RELAXED);
+        stats->written[core] = head;
+        stats->dropped[core] = head > EVENT_TRACE_RING_LEN ? head - EVENT_TRACE_RING_LEN : 0;
+    }
+    return ESP_OK;
+}
+
+const char *event_trace_get_name(uint16_t code)
+{
+    code &= EVENT_TRACE_CODE_MASK;
+    for (size_t i = 0; i < sizeof(s_names) / sizeof(s_names[0]); i++) {
+        if (s_names[i].code == code) {
+            return s_names[i].name;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t event_trace_dump(event_trace_write_cb_t write_cb, void *ctx)
+{
+    if (write_cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool was_enabled = pause_writers();
+
+    char line[EVENT_TRACE_RECORDS_PER_LINE * sizeof(event_trace_record_t) * 2 + 1];
+
+    snprintf(line, sizeof(line), "TRACE BEGIN %d %d %" PRIu32, EVENT_TRACE_DUMP_VERSION,
+             EVENT_TRACE_MAX_CORES, board_hal_cpu_get_mhz());
+    write_cb(line, ctx);
+
+    for (size_t i = 0; i < sizeof(s_names) / sizeof(s_names[0]); i++) {
+        snprintf(line, sizeof(line), "TRACE NAME %04x %s", s_names[i].code, s_names[i].name);
+        write_cb(line, ctx);
+    }
+
+    for (int core = 0; core < EVENT_TRACE_MAX_CORES; core++) {
+        uint32_t head = __atomic_load_n(&s_head[core], __ATOMIC_RELAXED);
+        uint32_t count = head < EVENT_TRACE_RING_LEN ? head : EVENT_TRACE_RING_LEN;
+        uint32_t start = head - count;
+
+        snprintf(line, sizeof(line), "TRACE CORE %d %" PRIu32 " %" PRIu32, core, count, start);
+        write_cb(line, ctx);
+
+        size_t pos = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            const uint8_t *bytes = (const uint8_t *)&s_ring[core][(start + i) & EVENT_TRACE_RING_MASK];
+            for (size_t b = 0; b < sizeof(event_trace_record_t); b++) {
+                pos += snprintf(&line[pos], sizeof(line) - pos, "%02x", bytes[b]);
+            }
+            if ((i + 1) % EVENT_TRACE_RECORDS_PER_LINE == 0 || i + 1 == count) {
+                write_cb(line, ctx);
+                pos = 0;
+            }
+        }
+    }
+
+    write_cb("TRACE END", ctx);
+
+    __atomic_store_n(&s_enabled, was_enabled, __ATOMIC_SEQ_CST);
+    return ESP_OK;
+}
+
+uint32_t event_trace_pack_str(const char *str)
+{
+    uint32_t packed = 0;
+    for (int i = 0; i < 4 && str != NULL && str[i] != '\0'; i++) {
+        packed |= (uint32_t)(uint8_t)str[i] << (i * 8);
+    }
+    return packed;
+}
+
+// ==================== 静态函数实现 ====================
+
+static bool pause_writers(void)
+{
+    bool was_enabled = __atomic_exchange_n(&s_enabled, false, __ATOMIC_SEQ_CST);
+
+    // 之后开始的写入都会看到开关已关闭；等待已经开始的写入（可能是被本任务抢占的低优先级任务）完成
+    while (__atomic_load_n(&s_writers, __ATOMIC_ACQUIRE) != 0) {
+        vTaskDelay(1);
+    }
+    return was_enabled;
+}
+
+static void EVENT_TRACE_IRAM_ATTR write_record(int core, uint32_t time_us, uint16_t id, uint16_t arg0, uint32_t arg1)
+{
+    // 原子预留槽位，同核任务抢占、中断或跨核写入都不会写到同一槽位
+    uint32_t index = __atomic_fetch_add(&s_head[core], 1, __ATOMIC_RELAXED);
+    event_trace_record_t *record = &s_ring[core][index & EVENT_TRACE_RING_MASK];
+
+    record->time_us = time_us;
+    record->id = id;
+    record->arg0 = arg0;
+    record->arg1 = arg1;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file api_latency.h
+ * @brief ESP32S3 API调用延迟直方图
+ *
+ * 在函数入口放置 API_LATENCY_FUNCTION() 即可统计该函数每次调用的耗时（us），
+ * 按log2分桶记录到固定大小的直方图中。每个统计点静态分配，首次调用时无锁地
+ * 加入全局链表；计数按核心分开，使用原子加法，不需要互斥锁。
+ *
+ * 计时使用 esp_timer_get_time()：两个核心共用同一时基且不随动态调频变化，
+ * 调用期间任务迁移到另一核心的样本照常记录（计入结束时所在核心）。
+ *
+ * 编译时将 API_LATENCY_ENABLED 定义为0（例如在项目CMakeLists.txt中
+ * idf_build_set_property(COMPILE_DEFINITIONS "API_LATENCY_ENABLED=0" APPEND)）
+ * 可完全移除插桩代码。
+ */
+
+#ifndef API_LATENCY_H
+#define API_LATENCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== 配置 ====================
+
+#ifndef API_LATENCY_ENABLED
+#define API_LATENCY_ENABLED         1       /*!< 是否启用延迟插桩 */
+#endif
+
+#define API_LATENCY_MAX_CORES       2       /*!< 支持的最大核心数 */
+#define API_LATENCY_BUCKETS         32      /*!< log2分桶数，桶0覆盖 [0, 2) us，桶i覆盖 [2^i, 2^(i+1)) us */
+
+// ==================== 类型定义 ====================
+
+/**
+ * @brief 单个核心上的统计计数
+ */
+typedef struct {
+    uint32_t count;                             /*!< 调用次数 */
+    uint32_t max_us;                            /*!< 最大耗时 (us) */
+    uint32_t total_us_lo;                       /*!< 总耗时低32位 (us) */
+    uint32_t total_us_hi;                       /*!< 总耗时高32位 (us) */
+    uint32_t buckets[API_LATENCY_BUCKETS];      /*!< log2直方图 */
+} api_latency_core_stats_t;
+
+/**
+ * @brief 一个统计点（通常对应一个API函数）
+ */
+typedef struct api_latency_site {
+    const char *name;                                   /*!< 统计点名称 */
+    struct api_latency_site *next;                      /*!< 注册链表 */
+    uint32_t registered;                                /*!< 是否已注册 */
+    uint32_t migrated;                                  /*!< 调用期间发生核心迁移的次数（样本照常记录） */
+    api_latency_core_stats_t core[API_LATENCY_MAX_CORES]; /*!< 按核心统计 */
+} api_latency_site_t;
+
+/**
+ * @brief 一次计时范围
+ */
+typedef struct {
+    api_latency_site_t *site;   /*!< 所属统计点 */
+    int64_t start_us;           /*!< 开始时间 (us) */
+    int core;                   /*!< 开始时所在核心 */
+} api_latency_scope_t;
+
+/**
+ * @brief 汇总后的统计结果
+ */
+typedef struct {
+    const char *name;           /*!< 统计点名称 */
+    uint32_t count;             /*!< 调用次数（全部核心） */
+    uint32_t core_count[API_LATENCY_MAX_CORES]; /*!< 各核心调用次数 */
+    uint32_t migrated;          /*!< 调用期间发生核心迁移的次数 */
+    uint32_t avg_us;            /*!< 平均耗时 (us) */
+    uint32_t p50_us;            /*!< 50分位耗时上界 (us) */
+    uint32_t p90_us;            /*!< 90分位耗时上界 (us) */
+    uint32_t p99_us;            /*!< 99分位耗时上界 (us) */
+    uint32_t max_us;            /*!< 最大耗时 (us) */
+} api_latency_summary_t;
+
+// ==================== 接口 ====================
+
+/**
+ * @brief 记录一次调用耗时（由插桩宏调用）
+ *
+ * @param site 统计点
+ * @param core 所在核心
+ * @param elapsed_us 耗时 (us)
+ */
+void api_latency_record(api_latency_site_t *site, int core, uint32_t elapsed_us);
+
+/**
+ * @brief 计时范围结束时的清理函数（由插桩宏通过cleanup属性调用）
+ *
+ * @param scope 计时范围
+ */
+void api_latency_scope_end(api_latency_scope_t *scope);
+
+/**
+ * @brief 开始一个计时范围（由插桩宏调用）
+ *
+ * @param site 统计点
+ * @return 计时范围
+ */
+api_latency_scope_t api_latency_scope_begin(api_latency_site_t *site);
+
+/**
+ * @brief 获取统计点汇总
+ *
+ * @param site 统计点
+ * @param summary 存储汇总结果的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t api_latency_get_summary(const api_latency_site_t *site, api_latency_summary_t *summary);
+
+/**
+ * @brief 获取第一个已注册的统计点，用于遍历
+ *
+ * @return 统计点，没有时返回NULL
+ */
+const api_latency_site_t *api_latency_first(void);
+
+/**
+ * @brief 打印全部统计点的百分位耗时
+ *
+ * @param filter 名称过滤（子串匹配），传入NULL打印全部
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t api_latency_print(const char *filter);
+
+/**
+ * @brief 清零全部统计点
+ *
+ * @return
+ *     - ESP_OK: 清零成功
+ */
+esp_err_t api_latency_reset(void);
+
+// ==================== 插桩宏 ====================
+
+#if API_LATENCY_ENABLED
+
+#define API_LATENCY_CONCAT_(a, b)   a##b
+#define API_LATENCY_CONCAT(a, b)    API_LATENCY_CONCAT_(a, b)
+
+/**
+ * @brief 统计从此处到当前作用域结束的耗时
+ *
+ * @param site_name 统计点名称（字符串常量）
+ */
+#define API_LATENCY_SCOPE(site_name) \
+    static api_latency_site_t API_LATENCY_CONCAT(s_api_latency_site_, __LINE__) = { .name = (site_name) }; \
+    api_latency_scope_t API_LATENCY_CONCAT(api_latency_scope_, __LINE__) \
+        __attribute__((cleanup(api_latency_scope_end), unused)) = \
+        api_latency_scope_begin(&API_LATENCY_CONCAT(s_api_latency_site_, __LINE__))
+
+/**
+ * @brief 以当前函数名为统计点名称，统计整个函数的耗时
+ */
+#define API_LATENCY_FUNCTION()      API_LATENCY_SCOPE(__func__)
+
+#else
+
+#define API_LATENCY_SCOPE(site_name)    do { } while (0)
+#define API_LATENCY_FUNCTION()          do { } while (0)
+
+#endif /* API_LATENCY_ENABLED */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* API_LATENCY_H */
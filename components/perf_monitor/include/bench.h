@@ -0,0 +1,202 @@
+/**
+ * @file bench.h
+ * @brief ESP32S3 吞吐量基准测试框架
+ *
+ * 各组件在初始化时注册基准测试用例（一次操作对应一次回调），控制台通过
+ * `bench <name>` 按固定次数或固定时长运行。每个用例在单独的固定核心任务中
+ * 运行，期间持有最高频率和禁止浅睡眠的PM锁并把日志级别降到WARN，
+ * 保证每次运行的条件一致。
+ *
+ * 每次操作用CPU周期计数器计时并扣除空操作的计时开销，统计平均、p50、p99、
+ * 最大延迟和每次操作的CPU周期；百分位数来自固定大小的水塘抽样缓冲区。
+ * ops/s 按实际经过时间计算（不含让出CPU的时间），包含框架循环开销。
+ *
+ * 结果同时以表格和以 "BENCH " 开头的机器可读行输出，首行记录固件版本和
+ * ELF SHA256，可用 tools/bench_compare.py 比较两次固件构建的结果。
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== 配置 ====================
+
+#define BENCH_MAX_CASES             16      /*!< 最多注册的用例数 */
+#define BENCH_MAX_SAMPLES           2048    /*!< 百分位统计的水塘抽样大小 */
+#define BENCH_DEFAULT_ITERATIONS    1000    /*!< 默认运行次数 */
+#define BENCH_DEFAULT_WARMUP        10      /*!< 默认预热次数（不计入统计） */
+#define BENCH_MAX_DURATION_MS       60000   /*!< 固定时长模式的最大时长 (ms) */
+#define BENCH_YIELD_INTERVAL_MS     100     /*!< 运行期间让出CPU的间隔 (ms)，避免饿死空闲任务 */
+#define BENCH_TASK_STACK_SIZE       6144    /*!< 运行任务栈大小 */
+#define BENCH_OUTPUT_VERSION        1       /*!< 机器可读输出格式版本 */
+
+// ==================== 类型定义 ====================
+
+/**
+ * @brief 被测操作
+ *
+ * @param ctx 注册时传入的上下文
+ * @param iteration 本次运行中的操作序号（从0开始，包含预热）
+ * @return ESP_OK 继续运行，其他值中止本用例并记录到结果
+ */
+typedef esp_err_t (*bench_op_fn_t)(void *ctx, uint32_t iteration);
+
+/**
+ * @brief 运行前准备/运行后恢复
+ *
+ * @param ctx 注册时传入的上下文
+ * @return ESP_OK 成功，准备失败时不运行用例
+ */
+typedef esp_err_t (*bench_hook_fn_t)(void *ctx);
+
+/**
+ * @brief 基准测试用例
+ */
+typedef struct {
+    const char *name;               /*!< 名称（静态字符串），不含空格 */
+    const char *description;        /*!< 说明 */
+    bench_op_fn_t op;               /*!< 被测操作 */
+    bench_hook_fn_t setup;          /*!< 运行前准备，可为NULL */
+    bench_hook_fn_t teardown;       /*!< 运行后恢复，可为NULL，准备成功后总会调用 */
+    void *ctx;                      /*!< 回调上下文 */
+    uint32_t default_iterations;    /*!< 默认运行次数，0使用 BENCH_DEFAULT_ITERATIONS */
+    bool side_effects;              /*!< 改变外部可见的外设状态或写闪存，不参与 "all" 和压力测试，只能按名称运行 */
+} bench_case_t;
+
+/**
+ * @brief 运行参数
+ */
+typedef struct {
+    uint32_t iterations;            /*!< 固定次数，0使用用例默认次数 */
+    uint32_t duration_ms;           /*!< 固定时长 (ms)，非0时按时长运行并忽略次数 */
+    uint32_t warmup;                /*!< 预热次数 */
+} bench_params_t;
+
+#define BENCH_DEFAULT_PARAMS() { \
+    .iterations = 0, \
+    .duration_ms = 0, \
+    .warmup = BENCH_DEFAULT_WARMUP \
+}
+
+/**
+ * @brief 运行结果
+ */
+typedef struct {
+    const char *name;               /*!< 用例名称 */
+    bool timed;                     /*!< true: 固定时长, false: 固定次数 */
+    esp_err_t status;               /*!< ESP_OK或中止运行的错误，被 bench_abort() 中止时为 ESP_ERR_NOT_FINISHED */
+    uint32_t ops;                   /*!< 完成的操作数 */
+    uint32_t samples;               /*!< 百分位统计的样本数 */
+    uint64_t elapsed_us;            /*!< 运行时长 (us)，不含让出CPU的时间 */
+    uint32_t ops_per_sec;           /*!< 吞吐量 (次/秒) */
+    uint32_t mean_ns;               /*!< 平均延迟 (ns) */
+    uint32_t p50_ns;                /*!< 50分位延迟 (ns) */
+    uint32_t p99_ns;                /*!< 99分位延迟 (ns) */
+    uint32_t min_ns;                /*!< 最小延迟 (ns) */
+    uint32_t max_ns;                /*!< 最大延迟 (ns) */
+    uint32_t cycles_per_op;         /*!< 平均每次操作的CPU周期 */
+    uint32_t overhead_cycles;       /*!< 已扣除的计时开销 (CPU周期) */
+    uint32_t cpu_freq_mhz;          /*!< 运行时CPU频率 (MHz) */
+} bench_result_t;
+
+// ==================== 接口 ====================
+
+/**
+ * @brief 注册基准测试用例，可在任何组件初始化时调用
+ *
+ * 用例结构体被复制，name 和 description 须为静态字符串。
+ *
+ * @param bench 用例
+ * @return
+ *     - ESP_OK: 注册成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 同名用例已注册
+ *     - ESP_ERR_NO_MEM: 用例表已满
+ */
+esp_err_t bench_register(const bench_case_t *bench);
+
+/**
+ * @brief 获取已注册的用例数
+ *
+ * @return 用例数
+ */
+uint32_t bench_get_count(void);
+
+/**
+ * @brief 获取运行 "all" 时包含的用例数（不含有副作用的用例）
+ *
+ * @return 用例数
+ */
+uint32_t bench_get_all_count(void);
+
+/**
+ * @brief 按序号获取用例
+ *
+ * @param index 序号
+ * @return 用例，序号无效时返回NULL
+ */
+const bench_case_t *bench_get(uint32_t index);
+
+/**
+ * @brief 运行一个用例
+ *
+ * 阻塞直到运行结束。用例自身的错误记录在 result->status 中，函数仍返回ESP_OK。
+ *
+ * @param name 用例名称
+ * @param params 运行参数，传入NULL使用默认参数
+ * @param result 存储结果的指针
+ * @return
+ *     - ESP_OK: 运行完成
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NOT_FOUND: 用例不存在
+ *     - ESP_ERR_INVALID_STATE: 已有用例在运行
+ *     - ESP_ERR_NO_MEM: 内存不足
+ */
+esp_err_t bench_run(const char *name, const bench_params_t *params, bench_result_t *result);
+
+/**
+ * @brief 运行一个或全部用例，打印结果表格和机器可读结果
+ *
+ * @param name 用例名称，传入NULL或"all"运行全部没有副作用的用例
+ * @param params 运行参数，传入NULL使用默认参数
+ * @return
+ *     - ESP_OK: 全部用例运行成功
+ *     - ESP_ERR_NOT_FOUND: 用例不存在
+ *     - ESP_FAIL: 有用例运行失败
+ *     - ESP_ERR_NOT_FINISHED: 被 bench_abort() 中止
+ *     - 其他: bench_run 的错误
+ */
+esp_err_t bench_run_print(const char *name, const bench_params_t *params);
+
+/**
+ * @brief 请求中止正在运行的用例，可在其他任务中调用
+ *
+ * 运行中的用例在下一次让出CPU时结束（结果状态为 ESP_ERR_NOT_FINISHED），
+ * bench_run_print() 不再运行剩余用例。
+ *
+ * @return
+ *     - ESP_OK: 已请求中止
+ *     - ESP_ERR_INVALID_STATE: 没有正在运行的用例
+ */
+esp_err_t bench_abort(void);
+
+/**
+ * @brief 打印已注册的用例
+ *
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t bench_print_list(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_H */
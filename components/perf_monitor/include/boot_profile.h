@@ -0,0 +1,107 @@
+/**
+ * @file boot_profile.h
+ * @brief ESP32S3 启动阶段计时
+ *
+ * 启动过程中在各阶段结束处调用 boot_profile_mark() 记录时间戳（esp_timer，
+ * 从应用启动开始计时，不含ROM与二级引导程序时间），控制台就绪后调用
+ * boot_profile_complete() 结束记录。`boot` 命令打印各阶段耗时分布。
+ *
+ * FAST_BOOT_ENABLED 为1时，启动流程用就绪信号代替固定延时，并跳过
+ * 启动时的完整状态打印；定义为0恢复原有的延时启动流程。
+ */
+
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== 配置 ====================
+
+#ifndef FAST_BOOT_ENABLED
+#define FAST_BOOT_ENABLED           1       /*!< 是否启用快速启动 */
+#endif
+
+#define BOOT_PROFILE_MAX_PHASES     24      /*!< 最多记录的阶段数 */
+
+// ==================== 类型定义 ====================
+
+/**
+ * @brief 启动阶段记录
+ */
+typedef struct {
+    const char *name;           /*!< 阶段名（字符串常量） */
+    int64_t end_us;             /*!< 阶段结束时间 (us，自应用启动) */
+    uint32_t duration_us;       /*!< 阶段耗时 (us) */
+} boot_profile_phase_t;
+
+// ==================== 接口 ====================
+
+/**
+ * @brief 记录一个启动阶段的结束时间
+ *
+ * 阶段耗时为距上一次记录的时间，第一个阶段从应用启动算起。
+ * boot_profile_complete() 之后的调用被忽略。
+ *
+ * @param name 阶段名，必须是字符串常量
+ */
+void boot_profile_mark(const char *name);
+
+/**
+ * @brief 记录最后一个阶段并结束启动计时
+ *
+ * @param name 阶段名，必须是字符串常量
+ */
+void boot_profile_complete(const char *name);
+
+/**
+ * @brief 检查启动是否已完成
+ *
+ * @return true: 已完成, false: 仍在启动
+ */
+bool boot_profile_is_complete(void);
+
+/**
+ * @brief 获取启动总耗时
+ *
+ * @return 从应用启动到 boot_profile_complete() 的时间 (us)，未完成时返回0
+ */
+int64_t boot_profile_get_total_us(void);
+
+/**
+ * @brief 获取已记录的阶段数
+ *
+ * @return 阶段数
+ */
+uint32_t boot_profile_get_count(void);
+
+/**
+ * @brief 获取某个启动阶段
+ *
+ * @param index 阶段序号
+ * @param phase 存储阶段信息的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NOT_FOUND: 没有该阶段
+ */
+esp_err_t boot_profile_get_phase(uint32_t index, boot_profile_phase_t *phase);
+
+/**
+ * @brief 打印启动阶段耗时分布
+ *
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t boot_profile_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOOT_PROFILE_H */
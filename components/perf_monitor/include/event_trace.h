@@ -0,0 +1,207 @@
+/**
+ * @file event_trace.h
+ * @brief ESP32S3 二进制事件跟踪缓冲区
+ *
+ * 每个核心一个固定大小的环形缓冲区，每条事件12字节：esp_timer时间戳（us）、16位事件ID
+ * 和最多48位负载。写入只做一次原子加法和一次结构体写入，不加锁、不格式化，
+ * 对被测时序的影响在微秒以下，可在任务和中断中调用。缓冲区满后覆盖最旧事件。
+ *
+ * esp_timer 两核共用且不随动态调频变化，记录中只保存低32位（约71分钟回绕），
+ * 因此每个核心在距上次同步超过 EVENT_TRACE_SYNC_INTERVAL_MS 后的第一条事件之前
+ * 插入一条SYNC事件，记录时间的高32位，主机端解码器据此还原完整时间。
+ *
+ * 导出和清空前关闭记录，并等待已经开始的写入全部完成后才读取缓冲区。
+ *
+ * 通过控制台 `trace dump` 以十六进制导出，用 tools/trace_decode.py 转换为
+ * Chrome trace JSON（chrome://tracing 或 Perfetto 打开）。
+ *
+ * 编译时将 EVENT_TRACE_ENABLED 定义为0可完全移除跟踪点。
+ */
+
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== 配置 ====================
+
+#ifndef EVENT_TRACE_ENABLED
+#define EVENT_TRACE_ENABLED         1       /*!< 是否启用事件跟踪 */
+#endif
+
+#ifndef EVENT_TRACE_RING_LEN
+#define EVENT_TRACE_RING_LEN        512     /*!< 每个核心的事件数，必须为2的幂 */
+#endif
+
+#define EVENT_TRACE_MAX_CORES       2       /*!< 支持的最大核心数 */
+#define EVENT_TRACE_SYNC_INTERVAL_MS 1000   /*!< 同步事件最小间隔 (ms) */
+#define EVENT_TRACE_DUMP_VERSION    2       /*!< 导出格式版本（1: CPU周期时间戳） */
+
+// ==================== 事件ID ====================
+
+/*
+ * 16位事件ID: 高2位为阶段（瞬时/开始/结束），低14位为事件码。
+ * 开始与结束事件使用同一事件码，解码器据此配对生成时间段。
+ */
+#define EVENT_TRACE_PHASE_INSTANT   0x0000  /*!< 瞬时事件 */
+#define EVENT_TRACE_PHASE_BEGIN     0x4000  /*!< 时间段开始 */
+#define EVENT_TRACE_PHASE_END       0x8000  /*!< 时间段结束 */
+#define EVENT_TRACE_PHASE_MASK      0xC000  /*!< 阶段掩码 */
+#define EVENT_TRACE_CODE_MASK       0x3FFF  /*!< 事件码掩码 */
+
+/**
+ * @brief 事件码
+ */
+typedef enum {
+    EVENT_TRACE_SYNC = 0x0000,          /*!< 时间同步: arg0=CPU MHz, arg1=esp_timer时间高32位 */
+
+    // 硬件控制 0x0100
+    EVENT_TRACE_POWER_PULSE = 0x0100,   /*!< 电源/复位脉冲: arg0=GPIO, arg1=脉宽 (ms) */
+    EVENT_TRACE_RECOVERY,               /*!< Orin进入恢复模式: arg1=结果 */
+    EVENT_TRACE_USB_MUX,                /*!< USB MUX切换: arg0=目标 */
+    EVENT_TRACE_LED_REFRESH,            /*!< LED刷新: arg0=灯带 (0板载 1触摸), arg1=LED数 */
+    EVENT_TRACE_FAN_SET,                /*!< 风扇设置: arg0=速度 */
+
+    // 控制台 0x0200
+    EVENT_TRACE_CONSOLE_CMD = 0x0200,   /*!< 命令执行: arg0=返回码, arg1=命令名前4字节 */
+    EVENT_TRACE_CONSOLE_RPC,            /*!< 二进制RPC请求: 开始arg0=消息号, 结束arg0=返回码, arg1=seq */
+
+    // 系统监控 0x0300
+    EVENT_TRACE_MONITOR_CYCLE = 0x0300, /*!< 监控周期: 开始arg0=唤醒原因, 结束arg1=可用堆 */
+
+    // 启动 0x0400
+    EVENT_TRACE_BOOT_PHASE = 0x0400,    /*!< 启动阶段结束: arg0=阶段序号, arg1=esp_timer时间低32位 (us) */
+
+    EVENT_TRACE_USER = 0x1000,          /*!< 应用自定义事件起始值 */
+} event_trace_code_t;
+
+// ==================== 类型定义 ====================
+
+/**
+ * @brief 单条事件记录 (12字节，小端导出)
+ */
+typedef struct {
+    uint32_t time_us;           /*!< esp_timer时间低32位 (us) */
+    uint16_t id;                /*!< 事件ID (阶段 | 事件码) */
+    uint16_t arg0;              /*!< 16位负载 */
+    uint32_t arg1;              /*!< 32位负载 */
+} event_trace_record_t;
+
+/**
+ * @brief 跟踪统计
+ */
+typedef struct {
+    bool enabled;                               /*!< 是否正在记录 */
+    uint32_t written[EVENT_TRACE_MAX_CORES];    /*!< 各核心写入的事件总数 */
+    uint32_t dropped[EVENT_TRACE_MAX_CORES];    /*!< 各核心被覆盖的事件数 */
+} event_trace_stats_t;
+
+/**
+ * @brief 导出数据写出回调
+ *
+ * @param line 一行文本（不含换行）
+ * @param ctx 用户上下文
+ */
+typedef void (*event_trace_write_cb_t)(const char *line, void *ctx);
+
+// ==================== 接口 ====================
+
+/**
+ * @brief 记录一条事件（由跟踪宏调用，可在任务和中断中调用）
+ *
+ * 启用 CONFIG_ESP_TIMER_IN_IRAM（默认）时整个写入路径位于IRAM，cache关闭期间也可调用。
+ *
+ * @param id 事件ID
+ * @param arg0 16位负载
+ * @param arg1 32位负载
+ */
+void event_trace_emit(uint16_t id, uint16_t arg0, uint32_t arg1);
+
+/**
+ * @brief 开始或暂停记录
+ *
+ * @param enable true开始, false暂停
+ */
+void event_trace_enable(bool enable);
+
+/**
+ * @brief 清空全部缓冲区
+ *
+ * @return
+ *     - ESP_OK: 清空成功
+ */
+esp_err_t event_trace_clear(void);
+
+/**
+ * @brief 获取跟踪统计
+ *
+ * @param stats 存储统计的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t event_trace_get_stats(event_trace_stats_t *stats);
+
+/**
+ * @brief 获取事件码名称
+ *
+ * @param code 事件码
+ * @return 名称，未知事件码返回NULL
+ */
+const char *event_trace_get_name(uint16_t code);
+
+/**
+ * @brief 导出全部缓冲区（导出期间暂停记录）
+ *
+ * 逐行输出:
+ *   TRACE BEGIN <version> <cores> <cpu_mhz>
+ *   TRACE NAME <code hex> <name>           事件码名称表
+ *   TRACE CORE <core> <count> <dropped>    之后count/8行十六进制记录，按时间从旧到新
+ *   TRACE END
+ *
+ * @param write_cb 写出回调
+ * @param ctx 用户上下文
+ * @return
+ *     - ESP_OK: 导出成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t event_trace_dump(event_trace_write_cb_t write_cb, void *ctx);
+
+/**
+ * @brief 把字符串前4字节打包为32位负载（小端）
+ *
+ * @param str 字符串
+ * @return 负载值
+ */
+uint32_t event_trace_pack_str(const char *str);
+
+// ==================== 跟踪宏 ====================
+
+#if EVENT_TRACE_ENABLED
+
+#define EVENT_TRACE(code, arg0, arg1) \
+    event_trace_emit((uint16_t)(EVENT_TRACE_PHASE_INSTANT | (code)), (uint16_t)(arg0), (uint32_t)(arg1))
+#define EVENT_TRACE_BEGIN(code, arg0, arg1) \
+    event_trace_emit((uint16_t)(EVENT_TRACE_PHASE_BEGIN | (code)), (uint16_t)(arg0), (uint32_t)(arg1))
+#define EVENT_TRACE_END(code, arg0, arg1) \
+    event_trace_emit((uint16_t)(EVENT_TRACE_PHASE_END | (code)), (uint16_t)(arg0), (uint32_t)(arg1))
+
+#else
+
+#define EVENT_TRACE(code, arg0, arg1)           do { } while (0)
+#define EVENT_TRACE_BEGIN(code, arg0, arg1)     do { } while (0)
+#define EVENT_TRACE_END(code, arg0, arg1)       do { } while (0)
+
+#endif /* EVENT_TRACE_ENABLED */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_TRACE_H */
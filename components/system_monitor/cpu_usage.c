@@ -0,0 +1,489 @@
+/**
+ * @file cpu_usage.c
+ * @brief ESP32S3 CPU占用率采样实现
+ */
+
+#include "cpu_usage.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "CPU_USAGE";
+
+#if !CONFIG_FREERTOS_USE_TRACE_FACILITY || !CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+#error "cpu_usage requires CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS"
+#endif
+
+// ==================== 类型定义 ====================
+
+typedef struct {
+    UBaseType_t task_number;
+    configRUN_TIME_COUNTER_TYPE runtime;
+} task_runtime_t;
+
+// ==================== 静态变量 ====================
+
+static bool s_initialized = false;
+static SemaphoreHandle_t s_mutex = NULL;
+
+static TaskStatus_t *s_status_buf = NULL;
+static UBaseType_t s_status_capacity = 0;
+
+static task_runtime_t s_prev[CPU_USAGE_TRACK_MAX];
+static uint32_t s_prev_count = 0;
+static configRUN_TIME_COUNTER_TYPE s_prev_total = 0;
+static int64_t s_prev_time_us = 0;      // 基准建立时间
+static esp_timer_handle_t s_refresh_timer = NULL;
+
+static cpu_usage_sample_t s_history[CPU_USAGE_HISTORY_LEN];
+static uint32_t s_history_head = 0;     // 下一个写入位置
+static uint32_t s_history_count = 0;
+
+// ==================== 静态函数声明 ====================
+
+static esp_err_t take_snapshot(UBaseType_t *count, configRUN_TIME_COUNTER_TYPE *total);
+static void store_baseline(UBaseType_t count, configRUN_TIME_COUNTER_TYPE total);
+static configRUN_TIME_COUNTER_TYPE find_prev_runtime(UBaseType_t task_number, bool *found);
+static void insert_top_task(cpu_usage_sample_t *sample, const cpu_task_usage_t *entry);
+static uint16_t usage_from_delta(uint64_t delta, uint64_t total_delta);
+static esp_err_t measure(cpu_usage_sample_t *slot, UBaseType_t *count, configRUN_TIME_COUNTER_TYPE *total);
+static void refresh_timer_callback(void *arg);
+
+// ==================== 接口实现 ====================
+
+esp_err_t cpu_usage_init(void)
+{
+    if (s_initialized) {
+        return ESP_OK;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (s_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(s_history, 0, sizeof(s_history));
+    s_history_head = 0;
+    s_history_count = 0;
+
+    UBaseType_t count;
+    configRUN_TIME_COUNTER_TYPE total;
+    esp_err_t ret = take_snapshot(&count, &total);
+    if (ret != ESP_OK) {
+        vSemaphoreDelete(s_mutex);
+        s_mutex = NULL;
+        return ret;
+    }
+    store_baseline(count, total);
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = refresh_timer_callback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "cpu_usage",
+    };
+    ret = esp_timer_create(&timer_args, &s_refresh_timer);
+    if (ret == ESP_OK) {
+        ret = esp_timer_start_periodic(s_refresh_timer, (uint64_t)CPU_USAGE_REFRESH_MS * 1000);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start refresh timer: %s", esp_err_to_name(ret));
+        if (s_refresh_timer != NULL) {
+            esp_timer_delete(s_refresh_timer);
+            s_refresh_timer = NULL;
+        }
+        vSemaphoreDelete(s_mutex);
+        s_mutex = NULL;
+        return ret;
+    }
+
+    s_initialized = true;
+    ESP_LOGI(TAG, "CPU usage sampler initialized (%d tasks tracked)", (int)count);
+    return ESP_OK;
+}
+
+esp_err_t cpu_usage_deinit(void)
+{
+    if (!s_initialized) {
+        return ESP_OK;
+    }
+
+    esp_timer_stop(s_refresh_timer);
+    esp_timer_delete(s_refresh_timer);
+    s_refresh_timer = NULL;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    free(s_status_buf);
+    s_status_buf = NULL;
+    s_status_capacity = 0;
+    s_prev_count = 0;
+    s_initialized = false;
+    xSemaphoreGive(s_mutex);
+
+    vSemaphoreDelete(s_mutex);
+    s_mutex = NULL;
+    return ESP_OK;
+}
+
+esp_err_t cpu_usage_sample(cpu_usage_sample_t *sample)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    UBaseType_t count;
+    configRUN_TIME_COUNTER_TYPE total;
+    cpu_usage_sample_t *slot = &s_history[s_history_head];
+    esp_err_t ret = measure(slot, &count, &total);
+    if (ret != ESP_OK) {
+        xSemaphoreGive(s_mutex);
+        return ret;
+    }
+
+    store_baseline(count, total);
+
+    s_history_head = (s_history_head + 1) % CPU_USAGE_HISTORY_LEN;
+    if (s_history_count < CPU_USAGE_HISTORY_LEN) {
+        s_history_count++;
+    }
+
+    if (sample != NULL) {
+        *sample = *slot;
+    }
+
+    xSemaphoreGive(s_mutex);
+    return ESP_OK;
+}
+
+esp_err_t cpu_usage_peek(cpu_usage_sample_t *sample)
+{
+    if (sample == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 只读基准快照，不推进基准也不写入环形缓冲区，周期采样不受影响
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    UBaseType_t count;
+    configRUN_TIME_COUNTER_TYPE total;
+    esp_err_t ret = measure(sample, &count, &total);
+    xSemaphoreGive(s_mutex);
+    return ret;
+}
+
+esp_err_t cpu_usage_get_sample(uint32_t index, cpu_usage_sample_t *sample)
+{
+    if (sample == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (index >= s_history_count) {
+        xSemaphoreGive(s_mutex);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint32_t pos = (s_history_head + CPU_USAGE_HISTORY_LEN - 1 - index) % CPU_USAGE_HISTORY_LEN;
+    *sample = s_history[pos];
+    xSemaphoreGive(s_mutex);
+    return ESP_OK;
+}
+
+uint32_t cpu_usage_get_sample_count(void)
+{
+    return s_history_count;
+}
+
+esp_err_t cpu_usage_print_sample(const cpu_usage_sample_t *sample)
+{
+    if (sample == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    printf("\n=== CPU占用率 (周期 %" PRIu32 " ms, 任务数 %d) ===\n",
+           sample->interval_us / 1000, sample->total_tasks);
+    for (int core = 0; core < sample->core_count; core++) {
+        printf("CPU%d: %3d.%02d%%  ", core,
+               sample->core_usage_x100[core] / 100, sample->core_usage_x100[core] % 100);
+    }
+    printf("\n\n%-16s %4s %4s %4s %8s %8s\n", "任务", "编号", "核心", "优先级", "CPU%", "栈剩余");
+    for (int i = 0; i < sample->task_count; i++) {
+        const cpu_task_usage_t *task = &sample->tasks[i];
+        char core[4];
+        if (task->core_id == CPU_USAGE_CORE_ANY) {
+            strcpy(core, "*");
+        } else {
+            snprintf(core, sizeof(core), "%d", task->core_id);
+        }
+        printf("%-16s %4d %4s %4d %5d.%02d %8d\n", task->name, task->task_number, core,
+               task->priority, task->usage_x100 / 100, task->usage_x100 % 100, task->stack_free);
+    }
+    if (sample->total_tasks > sample->task_count) {
+        printf("... 另有 %d 个任务未显示\n", sample->total_tasks - sample->task_count);
+    }
+    printf("================\n");
+    return ESP_OK;
+}
+
+esp_err_t cpu_usage_print_history(void)
+{
+    printf("\n=== CPU占用率历史 (%" PRIu32 " 个样本) ===\n", s_history_count);
+    printf("%-12s %-8s", "时间(ms)", "周期(ms)");
+    for (int core = 0; core < portNUM_PROCESSORS && core < CPU_USAGE_MAX_CORES; core++) {
+        printf("   CPU%d%%", core);
+    }
+    printf("  最忙任务\n");
+
+    for (int32_t i = (int32_t)s_history_count - 1; i >= 0; i--) {
+        cpu_usage_sample_t sample;
+        if (cpu_usage_get_sample(i, &sample) != ESP_OK) {
+            continue;
+        }
+        printf("%-12" PRIu64 " %-8" PRIu32, sample.timestamp_ms, sample.interval_us / 1000);
+        for (int core = 0; core < sample.core_count; core++) {
+            printf(" %3d.%02d", sample.core_usage_x100[core] / 100, sample.core_usage_x100[core] % 100);
+        }
+        // 跳过IDLE任务，显示最忙的业务任务
+        for (int t = 0; t < sample.task_count; t++) {
+            if (strncmp(sample.tasks[t].name, "IDLE", 4) != 0) {
+                printf("  %s (%d.%02d%%)", sample.tasks[t].name,
+                       sample.tasks[t].usage_x100 / 100, sample.tasks[t].usage_x100 % 100);
+                break;
+            }
+        }
+        printf("\n");
+    }
+    printf("================\n");
+    return ESP_OK;
+}
+
+size_t cpu_usage_get_dump_size(void)
+{
+    const size_t header = 8;
+    const size_t per_sample = 4 + 4 + 2 * CPU_USAGE_MAX_CORES + 2;
+    const size_t per_task = CPU_USAGE_TASK_NAME_LEN + 2 + 2 + 2 + 1 + 1;
+    return header + CPU_USAGE_HISTORY_LEN * (per_sample + CPU_USAGE_MAX_TASKS * per_task);
+}
+
+esp_err_t cpu_usage_dump_binary(uint8_t *buffer, size_t buffer_size, size_t *out_len)
+{
+    if (buffer == NULL || out_len == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    size_t pos = 0;
+#define PUT_U8(v)  do { if (pos + 1 > buffer_size) goto overflow; buffer[pos++] = (uint8_t)(v); } while (0)
+#define PUT_U16(v) do { PUT_U8((v) & 0xFF); PUT_U8(((v) >> 8) & 0xFF); } while (0)
+#define PUT_U32(v) do { PUT_U16((v) & 0xFFFF); PUT_U16(((v) >> 16) & 0xFFFF); } while (0)
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    uint8_t cores = portNUM_PROCESSORS > CPU_USAGE_MAX_CORES ? CPU_USAGE_MAX_CORES : portNUM_PROCESSORS;
+    PUT_U32(CPU_USAGE_DUMP_MAGIC);
+    PUT_U8(CPU_USAGE_DUMP_VERSION);
+    PUT_U8(cores);
+    PUT_U8(s_history_count);
+    PUT_U8(CPU_USAGE_TASK_NAME_LEN);
+
+    for (uint32_t n = 0; n < s_history_count; n++) {
+        // 从最旧的样本开始
+        uint32_t idx = (s_history_head + CPU_USAGE_HISTORY_LEN - s_history_count + n) % CPU_USAGE_HISTORY_LEN;
+        const cpu_usage_sample_t *sample = &s_history[idx];
+
+        PUT_U32((uint32_t)sample->timestamp_ms);
+        PUT_U32(sample->interval_us);
+        for (int core = 0; core < cores; core++) {
+            PUT_U16(sample->core_usage_x100[core]);
+        }
+        PUT_U8(sample->total_tasks);
+        PUT_U8(sample->task_count);
+
+        for (int t = 0; t < sample->task_count; t++) {
+            const cpu_task_usage_t *task = &sample->tasks[t];
+            if (pos + CPU_USAGE_TASK_NAME_LEN > buffer_size) {
+                goto overflow;
+            }
+            memcpy(&buffer[pos], task->name, CPU_USAGE_TASK_NAME_LEN);
+            pos += CPU_USAGE_TASK_NAME_LEN;
+            PUT_U16(task->task_number);
+            PUT_U16(task->usage_x100);
+            PUT_U16(task->stack_free);
+            PUT_U8(task->core_id);
+            PUT_U8(task->priority);
+        }
+    }
+
+    xSemaphoreGive(s_mutex);
+    *out_len = pos;
+    return ESP_OK;
+
+overflow:
+    xSemaphoreGive(s_mutex);
+    *out_len = 0;
+    return ESP_ERR_INVALID_SIZE;
+
+#undef PUT_U8
+#undef PUT_U16
+#undef PUT_U32
+}
+
+// ==================== 静态函数实现 ====================
+
+// 取当前快照，计算自上次基准以来的占用率写入 slot，调用者持有互斥锁
+static esp_err_t measure(cpu_usage_sample_t *slot, UBaseType_t *count, configRUN_TIME_COUNTER_TYPE *total)
+{
+    esp_err_t ret = take_snapshot(count, total);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 计数器为32位时依赖无符号减法处理回绕
+    configRUN_TIME_COUNTER_TYPE total_delta = *total - s_prev_total;
+    if (total_delta == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(slot, 0, sizeof(*slot));
+    slot->timestamp_ms = esp_timer_get_time() / 1000;
+    slot->interval_us = (uint32_t)total_delta;
+    slot->core_count = portNUM_PROCESSORS > CPU_USAGE_MAX_CORES ? CPU_USAGE_MAX_CORES : portNUM_PROCESSORS;
+    slot->total_tasks = *count > UINT8_MAX ? UINT8_MAX : (uint8_t)*count;
+
+    uint64_t idle_delta[CPU_USAGE_MAX_CORES] = {0};
+    TaskHandle_t idle_handle[CPU_USAGE_MAX_CORES] = {0};
+    for (int core = 0; core < slot->core_count; core++) {
+        idle_handle[core] = xTaskGetIdleTaskHandleForCore(core);
+    }
+
+    for (UBaseType_t i = 0; i < *count; i++) {
+        const TaskStatus_t *task = &s_status_buf[i];
+        bool found;
+        configRUN_TIME_COUNTER_TYPE prev = find_prev_runtime(task->xTaskNumber, &found);
+        // 新建任务的计数器从创建时开始累计
+        uint64_t delta = found ? (configRUN_TIME_COUNTER_TYPE)(task->ulRunTimeCounter - prev)
+                               : task->ulRunTimeCounter;
+
+        for (int core = 0; core < slot->core_count; core++) {
+            if (task->xHandle == idle_handle[core]) {
+                idle_delta[core] = delta;
+            }
+        }
+
+        cpu_task_usage_t entry = {0};
+        strncpy(entry.name, task->pcTaskName, CPU_USAGE_TASK_NAME_LEN - 1);
+        entry.task_number = (uint16_t)task->xTaskNumber;
+        entry.usage_x100 = usage_from_delta(delta, total_delta);
+        entry.stack_free = (uint16_t)(task->usStackHighWaterMark > UINT16_MAX ?
+                                      UINT16_MAX : task->usStackHighWaterMark);
+        entry.core_id = (task->xCoreID >= 0 && task->xCoreID < CPU_USAGE_MAX_CORES) ?
+                        (uint8_t)task->xCoreID : CPU_USAGE_CORE_ANY;
+        entry.priority = (uint8_t)task->uxCurrentPriority;
+        insert_top_task(slot, &entry);
+    }
+
+    for (int core = 0; core < slot->core_count; core++) {
+        uint16_t idle = usage_from_delta(idle_delta[core], total_delta);
+        slot->core_usage_x100[core] = 10000 - idle;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t take_snapshot(UBaseType_t *count, configRUN_TIME_COUNTER_TYPE *total)
+{
+    // 预留余量以容纳采样期间新建的任务
+    UBaseType_t needed = uxTaskGetNumberOfTasks() + 4;
+    if (needed > s_status_capacity) {
+        TaskStatus_t *buf = realloc(s_status_buf, needed * sizeof(TaskStatus_t));
+        if (buf == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate task status buffer (%d tasks)", (int)needed);
+            return ESP_ERR_NO_MEM;
+        }
+        s_status_buf = buf;
+        s_status_capacity = needed;
+    }
+
+    *count = uxTaskGetSystemState(s_status_buf, s_status_capacity, total);
+    if (*count == 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
+}
+
+static void store_baseline(UBaseType_t count, configRUN_TIME_COUNTER_TYPE total)
+{
+    s_prev_count = 0;
+    for (UBaseType_t i = 0; i < count && s_prev_count < CPU_USAGE_TRACK_MAX; i++) {
+        s_prev[s_prev_count].task_number = s_status_buf[i].xTaskNumber;
+        s_prev[s_prev_count].runtime = s_status_buf[i].ulRunTimeCounter;
+        s_prev_count++;
+    }
+    s_prev_total = total;
+    s_prev_time_us = esp_timer_get_time();
+}
+
+// 周期检查关闭时监控任务不采样，基准过旧时补采一个样本，避免差值跨越计数器回绕
+static void refresh_timer_callback(void *arg)
+{
+    (void)arg;
+    if (s_initialized && esp_timer_get_time() - s_prev_time_us >= (int64_t)CPU_USAGE_REFRESH_MS * 1000) {
+        cpu_usage_sample(NULL);
+    }
+}
+
+static configRUN_TIME_COUNTER_TYPE find_prev_runtime(UBaseType_t task_number, bool *found)
+{
+    for (uint32_t i = 0; i < s_prev_count; i++) {
+        if (s_prev[i].task_number == task_number) {
+            *found = true;
+            return s_prev[i].runtime;
+        }
+    }
+    *found = false;
+    return 0;
+}
+
+static void insert_top_task(cpu_usage_sample_t *sample, const cpu_task_usage_t *entry)
+{
+    int pos = sample->task_count;
+    if (pos == CPU_USAGE_MAX_TASKS) {
+        if (entry->usage_x100 <= sample->tasks[pos - 1].usage_x100) {
+            return;
+        }
+        pos--;
+    } else {
+        sample->task_count++;
+    }
+
+    // 插入排序，保持降序
+    while (pos > 0 && sample->tasks[pos - 1].usage_x100 < entry->usage_x100) {
+        sample->tasks[pos] = sample->tasks[pos - 1];
+        pos--;
+    }
+    sample->tasks[pos] = *entry;
+}
+
+static uint16_t usage_from_delta(uint64_t delta, uint64_t total_delta)
+{
+    uint64_t usage = (delta * 10000) / total_delta;
+    return usage > 10000 ? 10000 : (uint16_t)usage;
+}
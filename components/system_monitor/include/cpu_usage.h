@@ -0,0 +1,176 @@
+/**
+ * @file cpu_usage.h
+ * @brief ESP32S3 CPU占用率采样接口
+ *
+ * 基于FreeRTOS运行时间计数器(uxTaskGetSystemState)计算每个采样周期内
+ * 各任务及各核心的CPU占用率，并保存在固定大小的环形缓冲区中
+ *
+ * 运行时间计数器为32位esp_timer微秒，约71.6分钟回绕一次。监控任务关闭周期检查
+ * （仅事件驱动）时不会调用 cpu_usage_sample，由采样器自己的定时器保证基准
+ * 最长保持 2 * CPU_USAGE_REFRESH_MS，差值不会跨越回绕
+ */
+
+#ifndef CPU_USAGE_H
+#define CPU_USAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== 配置 ====================
+
+#define CPU_USAGE_MAX_CORES         2       /*!< 支持的最大核心数 */
+#define CPU_USAGE_MAX_TASKS         16      /*!< 每个样本保存的任务数(按占用率排序) */
+#define CPU_USAGE_HISTORY_LEN       8       /*!< 环形缓冲区样本数 */
+#define CPU_USAGE_TASK_NAME_LEN     16      /*!< 任务名长度(含结束符) */
+#define CPU_USAGE_TRACK_MAX         40      /*!< 最多跟踪的任务数 */
+#define CPU_USAGE_REFRESH_MS        (10 * 60 * 1000) /*!< 基准超过该时间未更新时由定时器补采一个样本 (ms) */
+
+#define CPU_USAGE_DUMP_MAGIC        0x53555043  /*!< 二进制导出魔数 "CPUS" */
+#define CPU_USAGE_DUMP_VERSION      1           /*!< 二进制导出格式版本 */
+
+#define CPU_USAGE_CORE_ANY          0xFF    /*!< 任务未绑定核心 */
+
+// ==================== 类型定义 ====================
+
+/**
+ * @brief 单个任务在一个采样周期内的占用率
+ */
+typedef struct {
+    char name[CPU_USAGE_TASK_NAME_LEN]; /*!< 任务名 */
+    uint16_t task_number;               /*!< FreeRTOS任务编号 */
+    uint16_t usage_x100;                /*!< 占用率 (单核百分比 x100) */
+    uint16_t stack_free;                /*!< 栈剩余高水位 (bytes) */
+    uint8_t core_id;                    /*!< 绑定核心, CPU_USAGE_CORE_ANY表示未绑定 */
+    uint8_t priority;                   /*!< 当前优先级 */
+} cpu_task_usage_t;
+
+/**
+ * @brief 一个采样周期的CPU占用率样本
+ */
+typedef struct {
+    uint64_t timestamp_ms;                          /*!< 采样时间 (ms) */
+    uint32_t interval_us;                           /*!< 采样周期长度 (us) */
+    uint16_t core_usage_x100[CPU_USAGE_MAX_CORES];  /*!< 各核心占用率 (百分比 x100) */
+    uint8_t core_count;                             /*!< 核心数 */
+    uint8_t task_count;                             /*!< tasks中有效条目数 */
+    uint8_t total_tasks;                            /*!< 采样时系统任务总数 */
+    cpu_task_usage_t tasks[CPU_USAGE_MAX_TASKS];    /*!< 任务占用率(降序) */
+} cpu_usage_sample_t;
+
+// ==================== 接口 ====================
+
+/**
+ * @brief 初始化CPU占用率采样器，建立首个基准快照并启动基准刷新定时器
+ *
+ * @return
+ *     - ESP_OK: 初始化成功
+ *     - ESP_ERR_NO_MEM: 内存不足
+ */
+esp_err_t cpu_usage_init(void);
+
+/**
+ * @brief 反初始化CPU占用率采样器
+ *
+ * @return
+ *     - ESP_OK: 反初始化成功
+ */
+esp_err_t cpu_usage_deinit(void);
+
+/**
+ * @brief 采集一个样本（自上次采样以来的占用率）并写入环形缓冲区
+ *
+ * @param sample 可选，输出本次样本，传入NULL则只写入缓冲区
+ * @return
+ *     - ESP_OK: 采样成功
+ *     - ESP_ERR_INVALID_STATE: 采样器未初始化或采样间隔为0
+ *     - ESP_ERR_NO_MEM: 内存不足
+ */
+esp_err_t cpu_usage_sample(cpu_usage_sample_t *sample);
+
+/**
+ * @brief 计算自上次采样以来的占用率，不写入环形缓冲区，也不影响下一次采样
+ *
+ * @param sample 存储样本的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 采样器未初始化或距上次采样时间为0
+ *     - ESP_ERR_NO_MEM: 内存不足
+ */
+esp_err_t cpu_usage_peek(cpu_usage_sample_t *sample);
+
+/**
+ * @brief 获取历史样本
+ *
+ * @param index 0表示最新样本，1表示上一个，依此类推
+ * @param sample 存储样本的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NOT_FOUND: 没有该样本
+ */
+esp_err_t cpu_usage_get_sample(uint32_t index, cpu_usage_sample_t *sample);
+
+/**
+ * @brief 获取环形缓冲区中的样本数量
+ *
+ * @return 样本数量
+ */
+uint32_t cpu_usage_get_sample_count(void);
+
+/**
+ * @brief 以top风格打印样本
+ *
+ * @param sample 要打印的样本
+ * @return
+ *     - ESP_OK: 打印成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t cpu_usage_print_sample(const cpu_usage_sample_t *sample);
+
+/**
+ * @brief 打印各核心占用率历史
+ *
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t cpu_usage_print_history(void);
+
+/**
+ * @brief 将环形缓冲区导出为紧凑二进制格式（小端）
+ *
+ * 格式: 头部 {u32 magic, u8 version, u8 cores, u8 samples, u8 name_len}
+ *       每个样本 {u32 timestamp_ms, u32 interval_us, u16 core_usage[cores],
+ *                 u8 total_tasks, u8 task_count,
+ *                 task_count * {char name[name_len], u16 task_number,
+ *                               u16 usage_x100, u16 stack_free, u8 core_id, u8 priority}}
+ * 样本按时间从旧到新排列
+ *
+ * @param buffer 输出缓冲区
+ * @param buffer_size 缓冲区大小
+ * @param out_len 实际写入长度
+ * @return
+ *     - ESP_OK: 导出成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_SIZE: 缓冲区不足
+ */
+esp_err_t cpu_usage_dump_binary(uint8_t *buffer, size_t buffer_size, size_t *out_len);
+
+/**
+ * @brief 获取二进制导出所需的最大缓冲区大小
+ *
+ * @return 字节数
+ */
+size_t cpu_usage_get_dump_size(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CPU_USAGE_H */
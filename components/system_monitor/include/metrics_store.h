@@ -0,0 +1,272 @@
+/**
+ * @file metrics_store.h
+ * @brief ESP32S3 多分辨率时间序列指标存储接口
+ *
+ * 每秒采集一次堆内存、CPU占用率以及外部注册的数据源（风扇速度、电源状态等），
+ * 以固定大小的环形缓冲区按两级分辨率保存 min/max/avg 聚合值：
+ *   - 1秒分辨率，内存中保存5分钟
+ *   - 1分钟分辨率，内存中只保留最近1小时作为暂存，每条同时写入分区表中的 "metrics"
+ *     数据分区（partitions.csv，128 KiB 约2000条，33小时以上），重启后仍可导出
+ * 每次插入为常数时间。
+ *
+ * 内存中的两级环形缓冲区共 (300 + 60) x 52 = 18720 字节（约18 KiB），有PSRAM时分配在
+ * PSRAM，否则占用内部RAM（当前配置未启用PSRAM）。没有 "metrics" 分区时1分钟数据只有
+ * 内存中的1小时。
+ *
+ * 采样定时器不会把芯片从自动浅睡眠中唤醒：睡眠期间错过的采样直接跳过，唤醒后的
+ * 第一次采样覆盖整个睡眠时段，1分钟分辨率按经过时间而非采样次数滚动。
+ */
+
+#ifndef METRICS_STORE_H
+#define METRICS_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== 配置 ====================
+
+#ifndef METRICS_STORE_TIER0_LEN
+#define METRICS_STORE_TIER0_LEN         300     /*!< 1秒分辨率样本数 (5分钟) */
+#endif
+
+#ifndef METRICS_STORE_TIER1_LEN
+#define METRICS_STORE_TIER1_LEN         60      /*!< 1分钟分辨率内存暂存样本数 (1小时)，更早的记录在Flash中 */
+#endif
+
+#define METRICS_STORE_TIER1_SECONDS     60      /*!< 1分钟分辨率包含的1秒样本数 */
+#define METRICS_STORE_PARTITION_LABEL   "metrics"   /*!< 溢出写入的数据分区名 */
+
+#define METRICS_STORE_DUMP_MAGIC        0x5352544D  /*!< 二进制导出魔数 "MTRS" */
+#define METRICS_STORE_FLASH_MAGIC       0x4652544D  /*!< Flash记录魔数 "MTRF" */
+#define METRICS_STORE_DUMP_VERSION      1           /*!< 二进制导出格式版本 */
+#define METRICS_STORE_FLASH_RECORD_SIZE 64          /*!< Flash记录大小 (bytes) */
+
+// ==================== 类型定义 ====================
+
+/**
+ * @brief 指标ID
+ */
+typedef enum {
+    METRICS_HEAP_FREE = 0,      /*!< 全部可用堆内存 */
+    METRICS_INTERNAL_FREE,      /*!< 内部RAM可用 */
+    METRICS_DMA_FREE,           /*!< DMA RAM可用 */
+    METRICS_CPU0_LOAD,          /*!< 核心0占用率 (百分比 x100) */
+    METRICS_CPU1_LOAD,          /*!< 核心1占用率 (百分比 x100) */
+    METRICS_FAN_SPEED,          /*!< 风扇速度 (0-100%) */
+    METRICS_ORIN_POWER,         /*!< Orin电源状态 (0关 1开) */
+    METRICS_N305_POWER,         /*!< N305电源状态 (0关 1开) */
+    METRICS_COUNT
+} metrics_id_t;
+
+/**
+ * @brief 分辨率层级
+ */
+typedef enum {
+    METRICS_TIER_1S = 0,        /*!< 1秒分辨率 */
+    METRICS_TIER_1M,            /*!< 1分钟分辨率 */
+    METRICS_TIER_MAX
+} metrics_tier_t;
+
+/**
+ * @brief 指标描述
+ *
+ * 存储值为16位无符号数，实际值 = 存储值 << shift（超出范围时饱和）
+ */
+typedef struct {
+    const char *name;           /*!< 指标名 */
+    const char *unit;           /*!< 单位 */
+    uint8_t shift;              /*!< 存储缩放位数 */
+} metrics_info_t;
+
+/**
+ * @brief 一个时间桶内各指标的聚合值（存储单位）
+ */
+typedef struct {
+    uint32_t timestamp_s;               /*!< 桶起始时间 (系统运行秒数) */
+    uint16_t min[METRICS_COUNT];        /*!< 最小值 */
+    uint16_t max[METRICS_COUNT];        /*!< 最大值 */
+    uint16_t avg[METRICS_COUNT];        /*!< 平均值 */
+} metrics_bucket_t;
+
+/**
+ * @brief 数据源回调，每秒在采样定时器中调用一次
+ *
+ * @param value 输出当前值（实际单位）
+ * @return true: 值有效, false: 本次无数据
+ */
+typedef bool (*metrics_source_cb_t)(uint32_t *value);
+
+/**
+ * @brief 导出数据写出回调
+ *
+ * @param data 数据
+ * @param len 长度
+ * @param ctx 用户上下文
+ */
+typedef void (*metrics_write_cb_t)(const uint8_t *data, size_t len, void *ctx);
+
+// ==================== 接口 ====================
+
+/**
+ * @brief 初始化指标存储并启动1秒采样定时器
+ *
+ * 环形缓冲区优先分配在PSRAM，不可用时分配在内部RAM（约18 KiB）
+ *
+ * @return
+ *     - ESP_OK: 初始化成功
+ *     - ESP_ERR_NO_MEM: 内存不足
+ *     - 其他: 定时器创建失败
+ */
+esp_err_t metrics_store_init(void);
+
+/**
+ * @brief 停止采样并释放指标存储
+ *
+ * 等待Flash写入任务写完队列中的记录并退出后才返回。
+ *
+ * @return
+ *     - ESP_OK: 反初始化成功
+ */
+esp_err_t metrics_store_deinit(void);
+
+/**
+ * @brief 检查指标存储是否已初始化
+ *
+ * @return true: 已初始化, false: 未初始化
+ */
+bool metrics_store_is_initialized(void);
+
+/**
+ * @brief 注册指标数据源，可在初始化前调用
+ *
+ * @param id 指标ID
+ * @param source 数据源回调，传入NULL取消注册
+ * @return
+ *     - ESP_OK: 注册成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t metrics_store_register_source(metrics_id_t id, metrics_source_cb_t source);
+
+/**
+ * @brief 向当前1秒桶中记录一个额外样本（常数时间）
+ *
+ * @param id 指标ID
+ * @param value 实际值
+ * @return
+ *     - ESP_OK: 记录成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t metrics_store_record(metrics_id_t id, uint32_t value);
+
+/**
+ * @brief 获取指标描述
+ *
+ * @param id 指标ID
+ * @return 指标描述，ID无效时返回NULL
+ */
+const metrics_info_t *metrics_store_get_info(metrics_id_t id);
+
+/**
+ * @brief 将存储值换算为实际值
+ *
+ * @param id 指标ID
+ * @param stored 存储值
+ * @return 实际值
+ */
+uint32_t metrics_store_to_value(metrics_id_t id, uint16_t stored);
+
+/**
+ * @brief 获取某一层级中的样本数量
+ *
+ * @param tier 分辨率层级
+ * @return 样本数量
+ */
+uint32_t metrics_store_get_count(metrics_tier_t tier);
+
+/**
+ * @brief 获取某一层级中的样本
+ *
+ * @param tier 分辨率层级
+ * @param index 0表示最新样本，1表示上一个，依此类推
+ * @param bucket 存储样本的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NOT_FOUND: 没有该样本
+ */
+esp_err_t metrics_store_get_bucket(metrics_tier_t tier, uint32_t index, metrics_bucket_t *bucket);
+
+/**
+ * @brief 以表格打印最近的样本（每个指标的 min/avg/max）
+ *
+ * @param tier 分辨率层级
+ * @param count 打印的样本数
+ * @return
+ *     - ESP_OK: 打印成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t metrics_store_print(metrics_tier_t tier, uint32_t count);
+
+/**
+ * @brief 打印指标存储概况（最新值、容量、Flash溢出状态）
+ *
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t metrics_store_print_summary(void);
+
+/**
+ * @brief 以紧凑二进制格式（小端）流式导出某一层级
+ *
+ * 格式: 头部 {u32 magic, u8 version, u8 metrics, u8 tier, u8 reserved,
+ *              u16 interval_s, u16 count, u8 shift[metrics]}
+ *       每个样本 {u32 timestamp_s, u16 min[metrics], u16 max[metrics], u16 avg[metrics]}
+ * 样本按时间从旧到新排列
+ *
+ * @param tier 分辨率层级
+ * @param count 导出的最近样本数，0表示全部
+ * @param write_cb 写出回调
+ * @param ctx 用户上下文
+ * @return
+ *     - ESP_OK: 导出成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t metrics_store_export(metrics_tier_t tier, uint32_t count, metrics_write_cb_t write_cb, void *ctx);
+
+/**
+ * @brief 检查Flash溢出是否可用
+ *
+ * @return true: 已找到 "metrics" 分区, false: 未启用
+ */
+bool metrics_store_flash_available(void);
+
+/**
+ * @brief 按时间从旧到新导出Flash中保存的1分钟记录（原始64字节记录）
+ *
+ * 记录格式: {u32 magic, u32 seq, u32 timestamp_s, u16 samples, u16 crc16,
+ *            u16 min[metrics], u16 max[metrics], u16 avg[metrics]}
+ * crc16 按 crc 字段为0计算，覆盖整条记录（含 seq 和 timestamp_s）；timestamp_s 为写入时的
+ * 系统运行秒数，跨重启以 seq 排序
+ *
+ * @param count 导出的最近记录数，0表示全部
+ * @param write_cb 写出回调
+ * @param ctx 用户上下文
+ * @return
+ *     - ESP_OK: 导出成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NOT_SUPPORTED: 未启用Flash溢出
+ */
+esp_err_t metrics_store_flash_export(uint32_t count, metrics_write_cb_t write_cb, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* METRICS_STORE_H */
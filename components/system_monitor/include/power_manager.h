@@ -0,0 +1,197 @@
+/**
+ * @file power_manager.h
+ * @brief ESP32S3 动态调频与自动浅睡眠管理接口
+ *
+ * 基于 esp_pm 配置动态调频(DFS)和空闲时自动浅睡眠：没有任务持有PM锁时
+ * CPU降到最低频率，所有任务阻塞时芯片进入浅睡眠，由定时器、控制台UART接收
+ * 或注册的GPIO电平变化唤醒。需要全速或不能睡眠的组件自行持有PM锁。
+ *
+ * 通过浅睡眠进入/退出回调统计睡眠次数、睡眠时间占比、唤醒原因，以及定时
+ * 唤醒的超睡时间（退出回调中实际睡眠时长减去计划睡眠时长，即RTC定时器误差与
+ * 进出睡眠的固定开销）。超睡时间不包含退出回调之后到被唤醒任务恢复运行的时间，
+ * 不能当作唤醒到响应的延迟。
+ *
+ * UART唤醒在RX边沿数达到阈值后发生，触发唤醒的字符丢失；控制台收到输入后
+ * 在一段时间内禁止浅睡眠（见 console_interface.h），主机在空闲后先发送唤醒前导。
+ *
+ * 需要 CONFIG_PM_ENABLE、CONFIG_FREERTOS_USE_TICKLESS_IDLE 和
+ * CONFIG_PM_LIGHT_SLEEP_CALLBACKS，未启用时初始化返回 ESP_ERR_NOT_SUPPORTED。
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== 配置 ====================
+
+#define POWER_MANAGER_DEFAULT_MAX_FREQ_MHZ  240     /*!< 默认最高CPU频率 (MHz) */
+#define POWER_MANAGER_DEFAULT_MIN_FREQ_MHZ  80      /*!< 默认最低CPU频率 (MHz)，不低于80时APB保持80MHz */
+#define POWER_MANAGER_DEFAULT_UART_WAKEUP_THRESHOLD 3   /*!< 默认UART唤醒所需的RX边沿数 */
+#define POWER_MANAGER_MAX_GPIO_WAKEUPS      4       /*!< 最多注册的GPIO唤醒源 */
+
+#ifdef CONFIG_ESP_CONSOLE_UART_NUM
+#define POWER_MANAGER_DEFAULT_UART_WAKEUP   CONFIG_ESP_CONSOLE_UART_NUM /*!< 默认由控制台UART唤醒 */
+#else
+#define POWER_MANAGER_DEFAULT_UART_WAKEUP   -1      /*!< 控制台不在UART上，不使用UART唤醒 */
+#endif
+
+/**
+ * @brief 唤醒原因
+ */
+typedef enum {
+    POWER_WAKEUP_TIMER = 0,     /*!< 定时器（任务超时、esp_timer） */
+    POWER_WAKEUP_UART,          /*!< 控制台UART接收 */
+    POWER_WAKEUP_GPIO,          /*!< GPIO电平变化 */
+    POWER_WAKEUP_OTHER,         /*!< 其他 */
+    POWER_WAKEUP_MAX
+} power_wakeup_source_t;
+
+/**
+ * @brief 电源管理配置
+ */
+typedef struct {
+    uint32_t max_freq_mhz;          /*!< 最高CPU频率 (MHz) */
+    uint32_t min_freq_mhz;          /*!< 空闲时最低CPU频率 (MHz) */
+    bool enable_light_sleep;        /*!< 是否在空闲时自动进入浅睡眠 */
+    int uart_wakeup_num;            /*!< 作为唤醒源的UART端口，-1表示不使用 */
+    uint8_t uart_wakeup_threshold;  /*!< UART唤醒所需的RX边沿数，唤醒字符会丢失 */
+} power_manager_config_t;
+
+#define POWER_MANAGER_DEFAULT_CONFIG() { \
+    .max_freq_mhz = POWER_MANAGER_DEFAULT_MAX_FREQ_MHZ, \
+    .min_freq_mhz = POWER_MANAGER_DEFAULT_MIN_FREQ_MHZ, \
+    .enable_light_sleep = true, \
+    .uart_wakeup_num = POWER_MANAGER_DEFAULT_UART_WAKEUP, \
+    .uart_wakeup_threshold = POWER_MANAGER_DEFAULT_UART_WAKEUP_THRESHOLD \
+}
+
+/**
+ * @brief 睡眠统计
+ */
+typedef struct {
+    bool enabled;                   /*!< 电源管理是否已启用 */
+    bool light_sleep;               /*!< 是否允许自动浅睡眠 */
+    uint32_t max_freq_mhz;          /*!< 最高CPU频率 (MHz) */
+    uint32_t min_freq_mhz;          /*!< 最低CPU频率 (MHz) */
+    uint32_t cpu_freq_mhz;          /*!< 当前CPU频率 (MHz) */
+    uint64_t elapsed_us;            /*!< 统计时长 (us) */
+    uint64_t sleep_us;              /*!< 累计浅睡眠时间 (us) */
+    uint32_t sleep_count;           /*!< 浅睡眠次数 */
+    uint32_t sleep_last_us;         /*!< 最近一次睡眠时长 (us) */
+    uint32_t sleep_max_us;          /*!< 最长一次睡眠时长 (us) */
+    uint32_t wakeups[POWER_WAKEUP_MAX]; /*!< 各唤醒原因次数 */
+    int32_t oversleep_last_us;      /*!< 最近一次定时唤醒的超睡时间 (us) */
+    int32_t oversleep_avg_us;       /*!< 平均超睡时间 (us) */
+    int32_t oversleep_max_us;       /*!< 最大超睡时间 (us) */
+    uint8_t sleep_percent;          /*!< 睡眠时间占比 (0-100%) */
+    uint8_t gpio_wakeup_count;      /*!< 已注册的GPIO唤醒源数 */
+} power_stats_t;
+
+// ==================== 接口 ====================
+
+/**
+ * @brief 初始化电源管理：配置动态调频、浅睡眠和UART唤醒，注册睡眠统计回调
+ *
+ * @param config 配置，传入NULL使用默认配置
+ * @return
+ *     - ESP_OK: 初始化成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_NOT_SUPPORTED: 未启用CONFIG_PM_ENABLE或频率不受支持
+ */
+esp_err_t power_manager_init(const power_manager_config_t *config);
+
+/**
+ * @brief 反初始化电源管理，恢复固定最高频率并禁止浅睡眠
+ *
+ * @return
+ *     - ESP_OK: 反初始化成功
+ */
+esp_err_t power_manager_deinit(void);
+
+/**
+ * @brief 获取电源管理是否已启用
+ *
+ * @return true: 已启用, false: 未启用
+ */
+bool power_manager_is_enabled(void);
+
+/**
+ * @brief 允许或禁止自动浅睡眠（动态调频保持）
+ *
+ * @param enable true允许, false禁止
+ * @return
+ *     - ESP_OK: 设置成功
+ *     - ESP_ERR_INVALID_STATE: 电源管理未启用
+ */
+esp_err_t power_manager_set_light_sleep(bool enable);
+
+/**
+ * @brief 注册GPIO电平变化唤醒源（如电源正常信号）
+ *
+ * 引脚须已配置为输入。每次进入睡眠前按当前电平设置相反的唤醒电平，
+ * 因此任一方向的变化都会唤醒芯片。
+ *
+ * @param pin GPIO编号
+ * @return
+ *     - ESP_OK: 注册成功
+ *     - ESP_ERR_INVALID_ARG: 引脚无效
+ *     - ESP_ERR_NO_MEM: 唤醒源已满
+ */
+esp_err_t power_manager_add_gpio_wakeup(int pin);
+
+/**
+ * @brief 获取睡眠统计
+ *
+ * @param stats 存储统计的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t power_manager_get_stats(power_stats_t *stats);
+
+/**
+ * @brief 重置睡眠统计
+ *
+ * @return
+ *     - ESP_OK: 重置成功
+ */
+esp_err_t power_manager_reset_stats(void);
+
+/**
+ * @brief 打印睡眠统计
+ *
+ * @return
+ *     - ESP_OK: 打印成功
+ */
+esp_err_t power_manager_print_stats(void);
+
+/**
+ * @brief 打印当前全部PM锁及其持有次数
+ *
+ * @return
+ *     - ESP_OK: 打印成功
+ *     - ESP_ERR_NOT_SUPPORTED: 未启用CONFIG_PM_ENABLE
+ */
+esp_err_t power_manager_print_locks(void);
+
+/**
+ * @brief 获取唤醒原因名称
+ *
+ * @param source 唤醒原因
+ * @return 名称字符串
+ */
+const char *power_wakeup_source_get_name(power_wakeup_source_t source);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POWER_MANAGER_H */
@@ -31,6 +31,60 @@ typedef struct {
     uint64_t uptime_ms;         /*!< 系统运行时间 (ms) */
 } system_info_t;
 
+/**
+ * @brief 堆内存区域（按内存能力划分）
+ */
+typedef enum {
+    SYSTEM_HEAP_INTERNAL = 0,   /*!< 内部RAM (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) */
+    SYSTEM_HEAP_DMA,            /*!< DMA可用RAM (MALLOC_CAP_DMA) */
+    SYSTEM_HEAP_SPIRAM,         /*!< 外部PSRAM (MALLOC_CAP_SPIRAM)，未启用时总量为0 */
+    SYSTEM_HEAP_REGION_MAX
+} system_heap_region_t;
+
+/**
+ * @brief 单个堆内存区域的统计信息
+ */
+typedef struct {
+    uint32_t total_bytes;           /*!< 总大小 (bytes) */
+    uint32_t free_bytes;            /*!< 当前可用 (bytes) */
+    uint32_t min_free_bytes;        /*!< 历史最小可用 (bytes) */
+    uint32_t largest_free_block;    /*!< 最大连续空闲块 (bytes) */
+    uint32_t free_blocks;           /*!< 空闲块数量 */
+    uint8_t usage_percent;          /*!< 使用率 (0-100%) */
+    uint8_t fragmentation_percent;  /*!< 碎片率 (0-100%)，100 - 最大空闲块/可用内存 */
+} system_heap_region_info_t;
+
+/**
+ * @brief 全部堆内存区域的快照
+ */
+typedef struct {
+    system_heap_region_info_t regions[SYSTEM_HEAP_REGION_MAX]; /*!< 各区域统计 */
+    uint32_t total_free_bytes;      /*!< 全部可用堆内存 (bytes) */
+} system_memory_snapshot_t;
+
+/**
+ * @brief 内存告警标志位
+ */
+typedef enum {
+    SYSTEM_MEMORY_ALARM_NONE          = 0,
+    SYSTEM_MEMORY_ALARM_TOTAL_FREE    = (1 << 0),  /*!< 全部可用堆内存低于阈值 */
+    SYSTEM_MEMORY_ALARM_INTERNAL_FREE = (1 << 1),  /*!< 内部RAM可用低于阈值 */
+    SYSTEM_MEMORY_ALARM_DMA_FREE      = (1 << 2),  /*!< DMA可用RAM低于阈值 */
+    SYSTEM_MEMORY_ALARM_LARGEST_BLOCK = (1 << 3),  /*!< 内部或DMA最大空闲块低于阈值 */
+    SYSTEM_MEMORY_ALARM_FRAGMENTATION = (1 << 4),  /*!< 内部或DMA碎片率高于阈值 */
+    SYSTEM_MEMORY_ALARM_ALLOC_FAILED  = (1 << 5),  /*!< 自上次检查以来发生过内存分配失败 */
+} system_memory_alarm_t;
+
+/**
+ * @brief 内存告警阈值，字段为0表示禁用该项检查
+ */
+typedef struct {
+    uint32_t internal_free_bytes;   /*!< 内部RAM可用阈值 (bytes) */
+    uint32_t dma_free_bytes;        /*!< DMA可用RAM阈值 (bytes) */
+    uint32_t largest_block_bytes;   /*!< 最大空闲块阈值 (bytes) */
+    uint8_t fragmentation_percent;  /*!< 碎片率阈值 (1-100%) */
+} system_memory_thresholds_t;
+
 /**
  * @brief 内存监控回调函数类型
  * 
@@ -39,6 +93,14 @@ typedef struct {
  */
 typedef void (*memory_warning_cb_t)(uint32_t free_heap, uint32_t threshold);
 
+/**
+ * @brief 内存告警回调函数类型
+ * 
+ * @param alarms 触发的告警标志位 (system_memory_alarm_t 组合)
+ * @param snapshot 触发告警时的内存快照
+ */
+typedef void (*memory_alarm_cb_t)(uint32_t alarms, const system_memory_snapshot_t *snapshot);
+
 /**
  * @brief 系统监控配置
  */
@@ -46,13 +108,43 @@ typedef struct {
     uint32_t monitor_interval_ms;      /*!< 监控间隔 (ms) */
     uint32_t memory_warning_threshold; /*!< 内存警告阈值 (bytes) */
     bool enable_auto_monitoring;       /*!< 是否启用自动监控 */
-    memory_warning_cb_t warning_cb;    /*!< 内存警告回调函数 */
+    memory_warning_cb_t warning_cb;    /*!< 内存警告回调函数（仅全部可用内存告警，alarm_cb为NULL时使用） */
+    system_memory_thresholds_t thresholds; /*!< 按内存能力划分的告警阈值 */
+    memory_alarm_cb_t alarm_cb;        /*!< 内存告警回调函数，设置后接收所有告警 */
+    bool enable_periodic_check;        /*!< 是否按监控间隔周期唤醒（CPU采样等）；内存告警由分配事件驱动，不依赖此项 */
 } system_monitor_config_t;
 
+/**
+ * @brief 事件驱动内存告警统计
+ */
+typedef struct {
+    uint32_t wakeups;               /*!< 监控任务总唤醒次数 */
+    uint32_t periodic_wakeups;      /*!< 定时唤醒次数 */
+    uint32_t event_wakeups;         /*!< 事件(通知)唤醒次数 */
+    uint32_t alloc_failures;        /*!< 内存分配失败次数 */
+    uint32_t watermark_hits;        /*!< 分配路径检测到低于水位线的次数 */
+    uint32_t last_failed_size;      /*!< 最近一次分配失败的大小 (bytes) */
+    uint32_t last_failed_caps;      /*!< 最近一次分配失败的内存能力 */
+    uint32_t latency_last_us;       /*!< 最近一次检测延迟 (us) */
+    uint32_t latency_max_us;        /*!< 最大检测延迟 (us) */
+    uint32_t latency_avg_us;        /*!< 平均检测延迟 (us) */
+} system_monitor_alarm_stats_t;
+
 // ==================== 默认配置 ====================
 
 #define SYSTEM_MONITOR_DEFAULT_INTERVAL_MS      30000   /*!< 默认监控间隔 30秒 */
 #define SYSTEM_MONITOR_DEFAULT_MEMORY_THRESHOLD 10240   /*!< 默认内存警告阈值 10KB */
+#define SYSTEM_MONITOR_DEFAULT_INTERNAL_THRESHOLD 8192  /*!< 默认内部RAM告警阈值 8KB */
+#define SYSTEM_MONITOR_DEFAULT_DMA_THRESHOLD    8192    /*!< 默认DMA RAM告警阈值 8KB */
+#define SYSTEM_MONITOR_DEFAULT_BLOCK_THRESHOLD  4096    /*!< 默认最大空闲块告警阈值 4KB */
+#define SYSTEM_MONITOR_DEFAULT_FRAG_THRESHOLD   85      /*!< 默认碎片率告警阈值 85% */
+
+#define SYSTEM_MONITOR_DEFAULT_THRESHOLDS() { \
+    .internal_free_bytes = SYSTEM_MONITOR_DEFAULT_INTERNAL_THRESHOLD, \
+    .dma_free_bytes = SYSTEM_MONITOR_DEFAULT_DMA_THRESHOLD, \
+    .largest_block_bytes = SYSTEM_MONITOR_DEFAULT_BLOCK_THRESHOLD, \
+    .fragmentation_percent = SYSTEM_MONITOR_DEFAULT_FRAG_THRESHOLD \
+}
 
 // ==================== 初始化接口 ====================
 
@@ -132,6 +224,8 @@ uint32_t system_get_min_free_heap(void);
 /**
  * @brief 获取堆内存使用率
  * 
+ * 基于 heap_caps_get_total_size(MALLOC_CAP_DEFAULT) 计算
+ * 
  * @return 内存使用率 (0-100%)
  */
 uint8_t system_get_heap_usage_percent(void);
@@ -144,6 +238,64 @@ uint8_t system_get_heap_usage_percent(void);
  */
 bool system_is_memory_low(uint32_t threshold);
 
+/**
+ * @brief 获取单个堆内存区域的统计信息
+ * 
+ * @param region 堆内存区域
+ * @param info 存储统计信息的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t system_get_heap_region_info(system_heap_region_t region, system_heap_region_info_t *info);
+
+/**
+ * @brief 获取全部堆内存区域的快照
+ * 
+ * @param snapshot 存储快照的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t system_get_memory_snapshot(system_memory_snapshot_t *snapshot);
+
+/**
+ * @brief 获取堆内存区域名称
+ * 
+ * @param region 堆内存区域
+ * @return 区域名称字符串
+ */
+const char *system_heap_region_get_name(system_heap_region_t region);
+
+/**
+ * @brief 按当前阈值评估内存告警
+ * 
+ * @param snapshot 内存快照，传入NULL则内部重新采集
+ * @return 触发的告警标志位 (system_memory_alarm_t 组合)，0表示无告警
+ */
+uint32_t system_check_memory_alarms(const system_memory_snapshot_t *snapshot);
+
+/**
+ * @brief 设置按内存能力划分的告警阈值
+ * 
+ * @param thresholds 新的阈值
+ * @return
+ *     - ESP_OK: 设置成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 监控未初始化
+ */
+esp_err_t system_monitor_set_memory_thresholds(const system_memory_thresholds_t *thresholds);
+
+/**
+ * @brief 获取按内存能力划分的告警阈值
+ * 
+ * @param thresholds 存储阈值的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t system_monitor_get_memory_thresholds(system_memory_thresholds_t *thresholds);
+
 /**
  * @brief 打印内存状态
  * 
@@ -252,7 +404,7 @@ void system_safe_restart(uint32_t delay_ms);
 /**
  * @brief 获取监控统计信息
  * 
- * @param monitor_count 监控次数指针
+ * @param monitor_count 监控次数指针，只统计定时检查，事件唤醒见 system_monitor_get_alarm_stats()
  * @param warning_count 警告次数指针
  * @return
  *     - ESP_OK: 获取成功
@@ -276,6 +428,18 @@ esp_err_t system_monitor_reset_stats(void);
  */
 esp_err_t system_monitor_print_stats(void);
 
+/**
+ * @brief 获取事件驱动内存告警统计
+ * 
+ * 检测延迟为分配失败回调/水位线钩子触发到监控任务处理之间的时间
+ * 
+ * @param stats 存储统计信息的指针
+ * @return
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t system_monitor_get_alarm_stats(system_monitor_alarm_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
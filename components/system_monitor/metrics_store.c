@@ -0,0 +1,836 @@
+/**
+ * @file metrics_store.c
+ * @brief ESP32S3 多分辨率时间序列指标存储实现
+ */
+
+#include "metrics_store.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+static const char *TAG = "METRICS_STORE";
+
+#define SAMPLE_PERIOD_US        1000000     // 1秒采样周期
+#define SPILL_QUEUE_LEN         4
+#define SPILL_TASK_STACK        3072
+#define SPILL_TASK_PRIORITY     2
+#define FLASH_SCAN_CHUNK        8           // 初始化扫描时每次读取的记录数
+#define SPILL_STOP_MAGIC        0           // 队列中的停止请求，写完之前的记录后退出
+
+// ==================== 类型定义 ====================
+
+typedef struct {
+    uint16_t min;
+    uint16_t max;
+    uint32_t sum;
+    uint16_t n;
+} metric_accum_t;
+
+typedef struct {
+    metrics_bucket_t *buf;
+    uint32_t len;
+    uint32_t head;      // 下一个写入位置
+    uint32_t count;
+    uint16_t interval_s;
+} metrics_ring_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t timestamp_s;
+    uint16_t samples;
+    uint16_t crc;
+    uint16_t values[3 * METRICS_COUNT];  // min[], max[], avg[]
+} flash_record_t;
+
+_Static_assert(sizeof(flash_record_t) == METRICS_STORE_FLASH_RECORD_SIZE,
+               "flash record layout must match METRICS_STORE_FLASH_RECORD_SIZE");
+
+// ==================== 静态变量 ====================
+
+static const metrics_info_t s_info[METRICS_COUNT] = {
+    [METRICS_HEAP_FREE]     = { "heap_free",     "bytes", 7 },
+    [METRICS_INTERNAL_FREE] = { "internal_free", "bytes", 3 },
+    [METRICS_DMA_FREE]      = { "dma_free",      "bytes", 3 },
+    [METRICS_CPU0_LOAD]     = { "cpu0",          "%x100", 0 },
+    [METRICS_CPU1_LOAD]     = { "cpu1",          "%x100", 0 },
+    [METRICS_FAN_SPEED]     = { "fan",           "%",     0 },
+    [METRICS_ORIN_POWER]    = { "orin_power",    "on",    0 },
+    [METRICS_N305_POWER]    = { "n305_power",    "on",    0 },
+};
+
+static bool s_initialized = false;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_sample_timer = NULL;
+static metrics_source_cb_t s_sources[METRICS_COUNT] = {0};
+
+static metrics_ring_t s_rings[METRICS_TIER_MAX];
+static bool s_rings_in_psram = false;
+
+static metric_accum_t s_cur[METRICS_COUNT];         // 当前1秒桶
+static uint32_t s_cur_start_s = 0;
+static metric_accum_t s_minute[METRICS_COUNT];      // 当前1分钟桶（由1秒桶折叠）
+static uint32_t s_minute_start_s = 0;
+static uint16_t s_minute_samples = 0;
+
+// CPU占用率基准
+static configRUN_TIME_COUNTER_TYPE s_prev_idle[portNUM_PROCESSORS];
+static int64_t s_prev_sample_us = 0;
+
+// Flash溢出
+static const esp_partition_t *s_partition = NULL;
+static QueueHandle_t s_spill_queue = NULL;
+static TaskHandle_t s_spill_task_handle = NULL;
+static SemaphoreHandle_t s_spill_exited = NULL;    // 写入任务退出时释放
+static uint32_t s_flash_slots = 0;
+static uint32_t s_flash_next = 0;
+static uint32_t s_flash_seq = 0;
+static uint32_t s_flash_written = 0;
+static uint32_t s_flash_errors = 0;
+
+// ==================== 静态函数声明 ====================
+
+static void sample_timer_callback(void *arg);
+static void sample_builtin(uint32_t *values, bool *valid);
+static uint16_t encode_value(metrics_id_t id, uint32_t value);
+static void accum_reset(metric_accum_t *acc);
+static void accum_add(metric_accum_t *acc, uint16_t min, uint16_t max, uint16_t avg);
+static void accum_to_bucket(const metric_accum_t *acc, int m, metrics_bucket_t *bucket);
+static void ring_push(metrics_ring_t *ring, const metrics_bucket_t *bucket);
+static esp_err_t ring_get(const metrics_ring_t *ring, uint32_t index, metrics_bucket_t *bucket);
+static esp_err_t alloc_ring(metrics_ring_t *ring, uint32_t len, uint16_t interval_s);
+static void free_rings(void);
+static void flash_init(void);
+static void spill_task(void *pvParameters);
+static bool flash_record_valid(const flash_record_t *record);
+static uint16_t flash_record_crc(const flash_record_t *record);
+static void put_u16(uint8_t *p, uint16_t v);
+static void put_u32(uint8_t *p, uint32_t v);
+static size_t serialize_bucket(const metrics_bucket_t *bucket, uint8_t *out);
+
+// ==================== 初始化接口实现 ====================
+
+esp_err_t metrics_store_init(void)
+{
+    if (s_initialized) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = alloc_ring(&s_rings[METRICS_TIER_1S], METRICS_STORE_TIER0_LEN, 1);
+    if (ret == ESP_OK) {
+        ret = alloc_ring(&s_rings[METRICS_TIER_1M], METRICS_STORE_TIER1_LEN, METRICS_STORE_TIER1_SECONDS);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to allocate metrics buffers");
+        free_rings();
+        return ret;
+    }
+
+    uint32_t now_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    for (int i = 0; i < METRICS_COUNT; i++) {
+        accum_reset(&s_cur[i]);
+        accum_reset(&s_minute[i]);
+    }
+    s_cur_start_s = now_s;
+    s_minute_start_s = now_s;
+    s_minute_samples = 0;
+
+    s_prev_sample_us = esp_timer_get_time();
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        s_prev_idle[core] = ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core));
+    }
+
+    // skip_unhandled_events: 定时器不作为浅睡眠唤醒源，睡眠期间错过的采样在唤醒后只补一次
+    const esp_timer_create_args_t timer_args = {
+        .callback = sample_timer_callback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "metrics",
+        .skip_unhandled_events = true,
+    };
+    ret = esp_timer_create(&timer_args, &s_sample_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create sample timer: %s", esp_err_to_name(ret));
+        free_rings();
+        return ret;
+    }
+
+    flash_init();
+
+    s_initialized = true;
+
+    ret = esp_timer_start_periodic(s_sample_timer, SAMPLE_PERIOD_US);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start sample timer: %s", esp_err_to_name(ret));
+        metrics_store_deinit();
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Metrics store initialized - %d x 1s, %d x 1m in %s (%u bytes), flash spill: %s",
+             METRICS_STORE_TIER0_LEN, METRICS_STORE_TIER1_LEN, s_rings_in_psram ? "PSRAM" : "internal RAM",
+             (unsigned)((METRICS_STORE_TIER0_LEN + METRICS_STORE_TIER1_LEN) * sizeof(metrics_bucket_t)),
+             s_partition != NULL ? "enabled" : "disabled");
+    return ESP_OK;
+}
+
+esp_err_t metrics_store_deinit(void)
+{
+    if (!s_initialized) {
+        return ESP_OK;
+    }
+
+    if (s_sample_timer != NULL) {
+        esp_timer_stop(s_sample_timer);
+        esp_timer_delete(s_sample_timer);
+        s_sample_timer = NULL;
+    }
+
+    // 正在执行的采样回调看到未初始化后不再入队
+    portENTER_CRITICAL(&s_lock);
+    s_initialized = false;
+    portEXIT_CRITICAL(&s_lock);
+
+    // 停止请求排在未写完的记录之后，写入任务处理完后自行退出，避免在擦写Flash中途被删除
+    if (s_spill_task_handle != NULL) {
+        const flash_record_t stop = { .magic = SPILL_STOP_MAGIC };
+        xQueueSend(s_spill_queue, &stop, portMAX_DELAY);
+        xSemaphoreTake(s_spill_exited, portMAX_DELAY);
+        s_spill_task_handle = NULL;
+    }
+    if (s_spill_exited != NULL) {
+        vSemaphoreDelete(s_spill_exited);
+        s_spill_exited = NULL;
+    }
+    if (s_spill_queue != NULL) {
+        vQueueDelete(s_spill_queue);
+        s_spill_queue = NULL;
+    }
+    s_partition = NULL;
+
+    free_rings();
+    ESP_LOGI(TAG, "Metrics store deinitialized");
+    return ESP_OK;
+}
+
+bool metrics_store_is_initialized(void)
+{
+    return s_initialized;
+}
+
+// ==================== 数据接口实现 ====================
+
+esp_err_t metrics_store_register_source(metrics_id_t id, metrics_source_cb_t source)
+{
+    if (id >= METRICS_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_sources[id] = source;
+    portEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+esp_err_t metrics_store_record(metrics_id_t id, uint32_t value)
+{
+    if (id >= METRICS_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint16_t stored = encode_value(id, value);
+    portENTER_CRITICAL_SAFE(&s_lock);
+    accum_add(&s_cur[id], stored, stored, stored);
+    portEXIT_CRITICAL_SAFE(&s_lock);
+    return ESP_OK;
+}
+
+const metrics_info_t *metrics_store_get_info(metrics_id_t id)
+{
+    if (id >= METRICS_COUNT) {
+        return NULL;
+    }
+    return &s_info[id];
+}
+
+uint32_t metrics_store_to_value(metrics_id_t id, uint16_t stored)
+{
+    if (id >= METRICS_COUNT) {
+        return 0;
+    }
+    return (uint32_t)stored << s_info[id].shift;
+}
+
+uint32_t metrics_store_get_count(metrics_tier_t tier)
+{
+    if (!s_initialized || tier >= METRICS_TIER_MAX) {
+        return 0;
+    }
+    return s_rings[tier].count;
+}
+
+esp_err_t metrics_store_get_bucket(metrics_tier_t tier, uint32_t index, metrics_bucket_t *bucket)
+{
+    if (tier >= METRICS_TIER_MAX || bucket == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_initialized) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    esp_err_t ret = ring_get(&s_rings[tier], index, bucket);
+    portEXIT_CRITICAL(&s_lock);
+    return ret;
+}
+
+// ==================== 输出接口实现 ====================
+
+esp_err_t metrics_store_print(metrics_tier_t tier, uint32_t count)
+{
+    if (tier >= METRICS_TIER_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t available = metrics_store_get_count(tier);
+    if (count == 0 || count > available) {
+        count = available;
+    }
+
+    printf("\n=== 指标历史 (%s分辨率, 平均值, 最近%" PRIu32 "条) ===\n",
+           tier == METRICS_TIER_1S ? "1秒" : "1分钟", count);
+    if (count == 0) {
+        printf("暂无数据\n");
+        printf("================\n");
+        return ESP_OK;
+    }
+
+    printf("%8s %9s %9s %9s %6s %6s %4s %4s %4s\n",
+           "时间(s)", "heap", "internal", "dma", "cpu0%", "cpu1%", "fan", "orin", "n305");
+
+    uint16_t lo[METRICS_COUNT];
+    uint16_t hi[METRICS_COUNT];
+    memset(lo, 0xFF, sizeof(lo));
+    memset(hi, 0, sizeof(hi));
+
+    metrics_bucket_t bucket;
+    for (uint32_t i = count; i-- > 0;) {
+        if (metrics_store_get_bucket(tier, i, &bucket) != ESP_OK) {
+            continue;
+        }
+        for (int m = 0; m < METRICS_COUNT; m++) {
+            if (bucket.min[m] < lo[m]) lo[m] = bucket.min[m];
+            if (bucket.max[m] > hi[m]) hi[m] = bucket.max[m];
+        }
+        printf("%8" PRIu32 " %9" PRIu32 " %9" PRIu32 " %9" PRIu32 " %3d.%02d %3d.%02d %4d %4d %4d\n",
+               bucket.timestamp_s,
+               metrics_store_to_value(METRICS_HEAP_FREE, bucket.avg[METRICS_HEAP_FREE]),
+               metrics_store_to_value(METRICS_INTERNAL_FREE, bucket.avg[METRICS_INTERNAL_FREE]),
+               metrics_store_to_value(METRICS_DMA_FREE, bucket.avg[METRICS_DMA_FREE]),
+               bucket.avg[METRICS_CPU0_LOAD] / 100, bucket.avg[METRICS_CPU0_LOAD] % 100,
+               bucket.avg[METRICS_CPU1_LOAD] / 100, bucket.avg[METRICS_CPU1_LOAD] % 100,
+               bucket.avg[METRICS_FAN_SPEED], bucket.avg[METRICS_ORIN_POWER], bucket.avg[METRICS_N305_POWER]);
+    }
+
+    printf("\n区间范围 (最小 / 最大):\n");
+    for (int m = 0; m < METRICS_COUNT; m++) {
+        printf("  %-14s %9" PRIu32 " / %-9" PRIu32 " %s\n", s_info[m].name,
+               metrics_store_to_value((metrics_id_t)m, lo[m]),
+               metrics_store_to_value((metrics_id_t)m, hi[m]), s_info[m].unit);
+    }
+    printf("================\n");
+    return ESP_OK;
+}
+
+esp_err_t metrics_store_print_summary(void)
+{
+    printf("\n=== 指标存储 ===\n");
+    if (!s_initialized) {
+        printf("状态: 未初始化\n");
+        printf("================\n");
+        return ESP_OK;
+    }
+
+    printf("1秒分辨率: %" PRIu32 "/%d 条\n", metrics_store_get_count(METRICS_TIER_1S), METRICS_STORE_TIER0_LEN);
+    printf("1分钟分辨率: %" PRIu32 "/%d 条\n", metrics_store_get_count(METRICS_TIER_1M), METRICS_STORE_TIER1_LEN);
+    printf("占用内存: %u bytes (%s)\n",
+           (unsigned)((METRICS_STORE_TIER0_LEN + METRICS_STORE_TIER1_LEN) * sizeof(metrics_bucket_t)),
+           s_rings_in_psram ? "PSRAM" : "内部RAM");
+    if (s_partition != NULL) {
+        printf("Flash溢出: 分区 '%s' %" PRIu32 " 条容量, 已写入 %" PRIu32 " 条, 序号 %" PRIu32 ", 错误 %" PRIu32 "\n",
+               s_partition->label, s_flash_slots, s_flash_written, s_flash_seq, s_flash_errors);
+    } else {
+        printf("Flash溢出: 未启用 (无 '%s' 分区)\n", METRICS_STORE_PARTITION_LABEL);
+    }
+
+    metrics_bucket_t bucket;
+    if (metrics_store_get_bucket(METRICS_TIER_1S, 0, &bucket) == ESP_OK) {
+        printf("\n最新值 (t=%" PRIu32 "s):\n", bucket.timestamp_s);
+        for (int m = 0; m < METRICS_COUNT; m++) {
+            printf("  %-14s %9" PRIu32 " %s%s\n", s_info[m].name,
+                   metrics_store_to_value((metrics_id_t)m, bucket.avg[m]), s_info[m].unit,
+                   (m >= METRICS_FAN_SPEED && s_sources[m] == NULL) ? " (无数据源)" : "");
+        }
+    }
+    printf("================\n");
+    return ESP_OK;
+}
+
+esp_err_t metrics_store_export(metrics_tier_t tier, uint32_t count, metrics_write_cb_t write_cb, void *ctx)
+{
+    if (tier >= METRICS_TIER_MAX || write_cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t available = metrics_store_get_count(tier);
+    if (count == 0 || count > available) {
+        count = available;
+    }
+
+    uint8_t header[12 + METRICS_COUNT];
+    put_u32(&header[0], METRICS_STORE_DUMP_MAGIC);
+    header[4] = METRICS_STORE_DUMP_VERSION;
+    header[5] = METRICS_COUNT;
+    header[6] = (uint8_t)tier;
+    header[7] = 0;
+    put_u16(&header[8], tier == METRICS_TIER_1S ? 1 : METRICS_STORE_TIER1_SECONDS);
+    put_u16(&header[10], (uint16_t)count);
+    for (int m = 0; m < METRICS_COUNT; m++) {
+        header[12 + m] = s_info[m].shift;
+    }
+    write_cb(header, sizeof(header), ctx);
+
+    uint8_t record[4 + 3 * 2 * METRICS_COUNT];
+    metrics_bucket_t bucket;
+    for (uint32_t i = count; i-- > 0;) {
+        if (metrics_store_get_bucket(tier, i, &bucket) != ESP_OK) {
+            memset(&bucket, 0, sizeof(bucket));
+        }
+        size_t len = serialize_bucket(&bucket, record);
+        write_cb(record, len, ctx);
+    }
+
+    return ESP_OK;
+}
+
+bool metrics_store_flash_available(void)
+{
+    return s_partition != NULL;
+}
+
+esp_err_t metrics_store_flash_export(uint32_t count, metrics_write_cb_t write_cb, void *ctx)
+{
+    if (write_cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_partition == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (count == 0 || count > s_flash_slots) {
+        count = s_flash_slots;
+    }
+
+    // 从最新记录向前找出需要导出的起点
+    uint32_t next = s_flash_next;
+    uint32_t start = next;
+    uint32_t found = 0;
+    flash_record_t record;
+    for (uint32_t n = 0; n < s_flash_slots && found < count; n++) {
+        uint32_t slot = (next + s_flash_slots - 1 - n) % s_flash_slots;
+        if (esp_partition_read(s_partition, slot * sizeof(record), &record, sizeof(record)) != ESP_OK) {
+            continue;
+        }
+        if (flash_record_valid(&record)) {
+            start = slot;
+            found++;
+        }
+    }
+
+    for (uint32_t n = 0, emitted = 0; n < s_flash_slots && emitted < found; n++) {
+        uint32_t slot = (start + n) % s_flash_slots;
+        if (esp_partition_read(s_partition, slot * sizeof(record), &record, sizeof(record)) != ESP_OK) {
+            continue;
+        }
+        if (flash_record_valid(&record)) {
+            write_cb((const uint8_t *)&record, sizeof(record), ctx);
+            emitted++;
+        }
+    }
+
+    return ESP_OK;
+}
+
+// ==================== 静态函数实现 ====================
+
+static void sample_timer_callback(void *arg)
+{
+    uint32_t values[METRICS_COUNT] = {0};
+    bool valid[METRICS_COUNT] = {0};
+
+    // 采集在锁外进行，数据源回调可能访问其他组件
+    sample_builtin(values, valid);
+    for (int m = 0; m < METRICS_COUNT; m++) {
+        metrics_source_cb_t source = s_sources[m];
+        if (source != NULL) {
+            valid[m] = source(&values[m]);
+        }
+    }
+
+    uint32_t now_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    metrics_bucket_t bucket;
+    bool spill = false;
+    uint16_t minute_samples = 0;
+
+    portENTER_CRITICAL(&s_lock);
+    if (!s_initialized) {
+        portEXIT_CRITICAL(&s_lock);
+        return;
+    }
+
+    for (int m = 0; m < METRICS_COUNT; m++) {
+        if (valid[m]) {
+            uint16_t stored = encode_value((metrics_id_t)m, values[m]);
+            accum_add(&s_cur[m], stored, stored, stored);
+        }
+    }
+
+    // 完成1秒桶
+    for (int m = 0; m < METRICS_COUNT; m++) {
+        accum_to_bucket(&s_cur[m], m, &bucket);
+        if (s_cur[m].n > 0) {
+            accum_add(&s_minute[m], bucket.min[m], bucket.max[m], bucket.avg[m]);
+        }
+        accum_reset(&s_cur[m]);
+    }
+    bucket.timestamp_s = s_cur_start_s;
+    ring_push(&s_rings[METRICS_TIER_1S], &bucket);
+    s_cur_start_s = now_s;
+
+    // 折叠进1分钟桶，按经过时间滚动：浅睡眠期间没有采样，采样次数会少于60
+    s_minute_samples++;
+    if (now_s - s_minute_start_s >= METRICS_STORE_TIER1_SECONDS) {
+        for (int m = 0; m < METRICS_COUNT; m++) {
+            accum_to_bucket(&s_minute[m], m, &bucket);
+            accum_reset(&s_minute[m]);
+        }
+        bucket.timestamp_s = s_minute_start_s;
+        ring_push(&s_rings[METRICS_TIER_1M], &bucket);
+        minute_samples = s_minute_samples;
+        s_minute_start_s = now_s;
+        s_minute_samples = 0;
+        spill = (s_spill_queue != NULL);
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (spill) {
+        // seq 由写入任务分配，CRC在写入前计算
+        flash_record_t record = {
+            .magic = METRICS_STORE_FLASH_MAGIC,
+            .timestamp_s = bucket.timestamp_s,
+            .samples = minute_samples,
+        };
+        memcpy(&record.values[0], bucket.min, sizeof(bucket.min));
+        memcpy(&record.values[METRICS_COUNT], bucket.max, sizeof(bucket.max));
+        memcpy(&record.values[2 * METRICS_COUNT], bucket.avg, sizeof(bucket.avg));
+        if (xQueueSend(s_spill_queue, &record, 0) != pdTRUE) {
+            s_flash_errors++;
+        }
+    }
+}
+
+static void sample_builtin(uint32_t *values, bool *valid)
+{
+    values[METRICS_HEAP_FREE] = esp_get_free_heap_size();
+    values[METRICS_INTERNAL_FREE] = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    values[METRICS_DMA_FREE] = heap_caps_get_free_size(MALLOC_CAP_DMA);
+    valid[METRICS_HEAP_FREE] = true;
+    valid[METRICS_INTERNAL_FREE] = true;
+    valid[METRICS_DMA_FREE] = true;
+
+    // 运行时间计数器基于esp_timer(us)，核心占用率 = 1 - 空闲任务运行时间 / 经过时间
+    int64_t now_us = esp_timer_get_time();
+    uint64_t elapsed_us = (uint64_t)(now_us - s_prev_sample_us);
+    s_prev_sample_us = now_us;
+
+    for (int core = 0; core < portNUM_PROCESSORS && core < 2; core++) {
+        configRUN_TIME_COUNTER_TYPE idle = ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core));
+        configRUN_TIME_COUNTER_TYPE idle_delta = idle - s_prev_idle[core];
+        s_prev_idle[core] = idle;
+
+        if (elapsed_us == 0) {
+            continue;
+        }
+        uint64_t idle_x100 = ((uint64_t)idle_delta * 10000) / elapsed_us;
+        values[METRICS_CPU0_LOAD + core] = idle_x100 >= 10000 ? 0 : (uint32_t)(10000 - idle_x100);
+        valid[METRICS_CPU0_LOAD + core] = true;
+    }
+}
+
+static uint16_t encode_value(metrics_id_t id, uint32_t value)
+{
+    uint32_t scaled = value >> s_info[id].shift;
+    return scaled > UINT16_MAX ? UINT16_MAX : (uint16_t)scaled;
+}
+
+static void accum_reset(metric_accum_t *acc)
+{
+    acc->min = UINT16_MAX;
+    acc->max = 0;
+    acc->sum = 0;
+    acc->n = 0;
+}
+
+static void accum_add(metric_accum_t *acc, uint16_t min, uint16_t max, uint16_t avg)
+{
+    if (min < acc->min) {
+        acc->min = min;
+    }
+    if (max > acc->max) {
+        acc->max = max;
+    }
+    acc->sum += avg;
+    acc->n++;
+}
+
+static void accum_to_bucket(const metric_accum_t *acc, int m, metrics_bucket_t *bucket)
+{
+    if (acc->n == 0) {
+        bucket->min[m] = 0;
+        bucket->max[m] = 0;
+        bucket->avg[m] = 0;
+    } else {
+        bucket->min[m] = acc->min;
+        bucket->max[m] = acc->max;
+        bucket->avg[m] = (uint16_t)(acc->sum / acc->n);
+    }
+}
+
+static void ring_push(metrics_ring_t *ring, const metrics_bucket_t *bucket)
+{
+    ring->buf[ring->head] = *bucket;
+    ring->head = (ring->head + 1) % ring->len;
+    if (ring->count < ring->len) {
+        ring->count++;
+    }
+}
+
+static esp_err_t ring_get(const metrics_ring_t *ring, uint32_t index, metrics_bucket_t *bucket)
+{
+    if (ring->buf == NULL || index >= ring->count) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint32_t pos = (ring->head + ring->len - 1 - index) % ring->len;
+    *bucket = ring->buf[pos];
+    return ESP_OK;
+}
+
+static esp_err_t alloc_ring(metrics_ring_t *ring, uint32_t len, uint16_t interval_s)
+{
+    memset(ring, 0, sizeof(*ring));
+
+    // 优先使用PSRAM，保留内部RAM给DMA/RMT
+    ring->buf = heap_caps_calloc(len, sizeof(metrics_bucket_t), MALLOC_CAP_SPIRAM);
+    if (ring->buf != NULL) {
+        s_rings_in_psram = true;
+    } else {
+        ring->buf = heap_caps_calloc(len, sizeof(metrics_bucket_t), MALLOC_CAP_8BIT);
+        s_rings_in_psram = false;
+    }
+
+    if (ring->buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    ring->len = len;
+    ring->interval_s = interval_s;
+    return ESP_OK;
+}
+
+static void free_rings(void)
+{
+    for (int t = 0; t < METRICS_TIER_MAX; t++) {
+        heap_caps_free(s_rings[t].buf);
+        memset(&s_rings[t], 0, sizeof(s_rings[t]));
+    }
+}
+
+static void flash_init(void)
+{
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                                METRICS_STORE_PARTITION_LABEL);
+    if (partition == NULL) {
+        ESP_LOGW(TAG, "No '%s' partition, 1m history limited to %d records in RAM",
+                 METRICS_STORE_PARTITION_LABEL, METRICS_STORE_TIER1_LEN);
+        return;
+    }
+
+    if (partition->erase_size == 0 || partition->size < partition->erase_size * 2 ||
+        partition->erase_size % sizeof(flash_record_t) != 0) {
+        ESP_LOGW(TAG, "Partition '%s' too small, flash spill disabled", partition->label);
+        return;
+    }
+
+    s_flash_slots = partition->size / sizeof(flash_record_t);
+    s_flash_next = 0;
+    s_flash_seq = 0;
+    s_flash_written = 0;
+
+    // 找到序号最大的有效记录，从其后继续循环写入
+    flash_record_t chunk[FLASH_SCAN_CHUNK];
+    bool any = false;
+    for (uint32_t slot = 0; slot < s_flash_slots; slot += FLASH_SCAN_CHUNK) {
+        uint32_t n = s_flash_slots - slot < FLASH_SCAN_CHUNK ? s_flash_slots - slot : FLASH_SCAN_CHUNK;
+        if (esp_partition_read(partition, slot * sizeof(flash_record_t), chunk, n * sizeof(flash_record_t)) != ESP_OK) {
+            continue;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            if (!flash_record_valid(&chunk[i])) {
+                continue;
+            }
+            if (!any || (int32_t)(chunk[i].seq - s_flash_seq) >= 0) {
+                s_flash_seq = chunk[i].seq + 1;
+                s_flash_next = (slot + i + 1) % s_flash_slots;
+                any = true;
+            }
+        }
+    }
+
+    s_spill_queue = xQueueCreate(SPILL_QUEUE_LEN, sizeof(flash_record_t));
+    s_spill_exited = xSemaphoreCreateBinary();
+    if (s_spill_queue == NULL || s_spill_exited == NULL) {
+        ESP_LOGW(TAG, "Failed to create spill queue, flash spill disabled");
+        goto fail;
+    }
+
+    if (xTaskCreate(spill_task, "metrics_spill", SPILL_TASK_STACK, NULL, SPILL_TASK_PRIORITY,
+                    &s_spill_task_handle) != pdPASS) {
+        ESP_LOGW(TAG, "Failed to create spill task, flash spill disabled");
+        s_spill_task_handle = NULL;
+        goto fail;
+    }
+
+    s_partition = partition;
+    ESP_LOGI(TAG, "Flash spill to '%s' - %" PRIu32 " records, resuming at slot %" PRIu32 " seq %" PRIu32,
+             partition->label, s_flash_slots, s_flash_next, s_flash_seq);
+    return;
+
+fail:
+    if (s_spill_exited != NULL) {
+        vSemaphoreDelete(s_spill_exited);
+        s_spill_exited = NULL;
+    }
+    if (s_spill_queue != NULL) {
+        vQueueDelete(s_spill_queue);
+        s_spill_queue = NULL;
+    }
+}
+
+static void spill_task(void *pvParameters)
+{
+    flash_record_t record;
+
+    while (1) {
+        if (xQueueReceive(s_spill_queue, &record, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (record.magic == SPILL_STOP_MAGIC) {
+            break;
+        }
+
+        const esp_partition_t *partition = s_partition;
+        if (partition == NULL) {
+            continue;
+        }
+
+        size_t offset = s_flash_next * sizeof(flash_record_t);
+
+        // 进入新扇区时先擦除，最旧的一个扇区的记录随之丢弃
+        if (offset % partition->erase_size == 0) {
+            esp_err_t ret = esp_partition_erase_range(partition, offset, partition->erase_size);
+            if (ret != ESP_OK) {
+                ESP_LOGW(TAG, "Failed to erase metrics sector: %s", esp_err_to_name(ret));
+                s_flash_errors++;
+                continue;
+            }
+        }
+
+        record.seq = s_flash_seq;
+        record.crc = flash_record_crc(&record);
+        esp_err_t ret = esp_partition_write(partition, offset, &record, sizeof(record));
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to write metrics record: %s", esp_err_to_name(ret));
+            s_flash_errors++;
+            continue;
+        }
+
+        s_flash_seq++;
+        s_flash_written++;
+        s_flash_next = (s_flash_next + 1) % s_flash_slots;
+    }
+
+    xSemaphoreGive(s_spill_exited);
+    vTaskDelete(NULL);
+}
+
+static bool flash_record_valid(const flash_record_t *record)
+{
+    if (record->magic != METRICS_STORE_FLASH_MAGIC) {
+        return false;
+    }
+    return record->crc == flash_record_crc(record);
+}
+
+static uint16_t flash_record_crc(const flash_record_t *record)
+{
+    flash_record_t copy = *record;
+    copy.crc = 0;
+    return esp_rom_crc16_le(0, (const uint8_t *)&copy, sizeof(copy));
+}
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+    p[2] = (uint8_t)((v >> 16) & 0xFF);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static size_t serialize_bucket(const metrics_bucket_t *bucket, uint8_t *out)
+{
+    size_t pos = 0;
+    put_u32(&out[pos], bucket->timestamp_s);
+    pos += 4;
+    for (int m = 0; m < METRICS_COUNT; m++, pos += 2) {
+        put_u16(&out[pos], bucket->min[m]);
+    }
+    for (int m = 0; m < METRICS_COUNT; m++, pos += 2) {
+        put_u16(&out[pos], bucket->max[m]);
+    }
+    for (int m = 0; m < METRICS_COUNT; m++, pos += 2) {
+        put_u16(&out[pos], bucket->avg[m]);
+    }
+    return pos;
+}
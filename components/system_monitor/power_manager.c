@@ -0,0 +1,417 @@
+/**
+ * @file power_manager.c
+ * @brief ESP32S3 动态调频与自动浅睡眠管理实现
+ */
+
+#include "power_manager.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_clk_tree.h"
+#include "driver/gpio.h"
+#include "driver/uart.h"
+#include "hal/gpio_ll.h"
+#include "soc/gpio_struct.h"
+
+static const char *TAG = "POWER_MANAGER";
+
+// ==================== 类型定义 ====================
+
+typedef struct {
+    int pin;
+    int armed_level;            // 当前设置的唤醒电平 (与引脚电平相反)
+} gpio_wakeup_t;
+
+// ==================== 静态变量 ====================
+
+static bool s_enabled = false;
+static power_manager_config_t s_config = {0};
+
+static gpio_wakeup_t s_gpio_wakeups[POWER_MANAGER_MAX_GPIO_WAKEUPS];
+static uint8_t s_gpio_wakeup_count = 0;
+static bool s_gpio_wakeup_enabled = false;
+
+// 睡眠统计（在浅睡眠回调中写入，回调运行在关中断的临界区内）
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t s_stats_start_us = 0;
+static int64_t s_planned_sleep_us = 0;
+static uint64_t s_sleep_total_us = 0;
+static uint32_t s_sleep_count = 0;
+static uint32_t s_sleep_last_us = 0;
+static uint32_t s_sleep_max_us = 0;
+static uint32_t s_wakeups[POWER_WAKEUP_MAX];
+static int32_t s_oversleep_last_us = 0;
+static int32_t s_oversleep_max_us = 0;
+static int64_t s_oversleep_total_us = 0;
+static uint32_t s_oversleep_samples = 0;
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+static esp_pm_sleep_cbs_register_config_t s_sleep_cbs = {0};
+#endif
+
+// ==================== 静态函数声明 ====================
+
+static esp_err_t apply_pm_config(bool light_sleep);
+static esp_err_t enter_sleep_cb(int64_t sleep_time_us, void *arg);
+static esp_err_t exit_sleep_cb(int64_t slept_us, void *arg);
+static void rearm_gpio_wakeups(void);
+
+// ==================== 接口实现 ====================
+
+esp_err_t power_manager_init(const power_manager_config_t *config)
+{
+#if !CONFIG_PM_ENABLE
+    ESP_LOGW(TAG, "Power management disabled (CONFIG_PM_ENABLE not set)");
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    if (s_enabled) {
+        ESP_LOGW(TAG, "Power manager already initialized");
+        return ESP_OK;
+    }
+
+    if (config == NULL) {
+        s_config = (power_manager_config_t)POWER_MANAGER_DEFAULT_CONFIG();
+    } else {
+        s_config = *config;
+    }
+
+    if (s_config.min_freq_mhz == 0 || s_config.min_freq_mhz > s_config.max_freq_mhz) {
+        ESP_LOGE(TAG, "Invalid frequency range %" PRIu32 "-%" PRIu32 " MHz",
+                 s_config.min_freq_mhz, s_config.max_freq_mhz);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+#if !CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    if (s_config.enable_light_sleep) {
+        ESP_LOGW(TAG, "Light sleep requires CONFIG_FREERTOS_USE_TICKLESS_IDLE, using DFS only");
+        s_config.enable_light_sleep = false;
+    }
+#endif
+
+    // 唤醒源先于浅睡眠配置，避免首次睡眠时无法由控制台唤醒
+    if (s_config.uart_wakeup_num >= 0) {
+        esp_err_t ret = uart_set_wakeup_threshold(s_config.uart_wakeup_num, s_config.uart_wakeup_threshold);
+        if (ret == ESP_OK) {
+            ret = esp_sleep_enable_uart_wakeup(s_config.uart_wakeup_num);
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to enable UART%d wakeup: %s", s_config.uart_wakeup_num, esp_err_to_name(ret));
+        }
+    }
+
+    power_manager_reset_stats();
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    s_sleep_cbs = (esp_pm_sleep_cbs_register_config_t) {
+        .enter_cb = enter_sleep_cb,
+        .exit_cb = exit_sleep_cb,
+    };
+    esp_err_t cb_ret = esp_pm_light_sleep_register_cbs(&s_sleep_cbs);
+    if (cb_ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to register light sleep callbacks: %s", esp_err_to_name(cb_ret));
+    }
+#else
+    ESP_LOGW(TAG, "Sleep statistics unavailable (CONFIG_PM_LIGHT_SLEEP_CALLBACKS not set)");
+#endif
+
+    esp_err_t ret = apply_pm_config(s_config.enable_light_sleep);
+    if (ret != ESP_OK) {
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+        esp_pm_light_sleep_unregister_cbs(&s_sleep_cbs);
+#endif
+        return ret;
+    }
+
+    s_enabled = true;
+    ESP_LOGI(TAG, "Power management enabled - CPU %" PRIu32 "-%" PRIu32 " MHz, light sleep %s",
+             s_config.min_freq_mhz, s_config.max_freq_mhz, s_config.enable_light_sleep ? "on" : "off");
+    return ESP_OK;
+#endif
+}
+
+esp_err_t power_manager_deinit(void)
+{
+    if (!s_enabled) {
+        return ESP_OK;
+    }
+
+    // 固定最高频率，等同于未启用电源管理
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = s_config.max_freq_mhz,
+        .min_freq_mhz = s_config.max_freq_mhz,
+        .light_sleep_enable = false,
+    };
+    esp_pm_configure(&pm_config);
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    esp_pm_light_sleep_unregister_cbs(&s_sleep_cbs);
+#endif
+
+    s_enabled = false;
+    ESP_LOGI(TAG, "Power management disabled");
+    return ESP_OK;
+}
+
+bool power_manager_is_enabled(void)
+{
+    return s_enabled;
+}
+
+esp_err_t power_manager_set_light_sleep(bool enable)
+{
+    if (!s_enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+#if !CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    if (enable) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+#endif
+
+    esp_err_t ret = apply_pm_config(enable);
+    if (ret == ESP_OK) {
+        s_config.enable_light_sleep = enable;
+        ESP_LOGI(TAG, "Automatic light sleep %s", enable ? "enabled" : "disabled");
+    }
+    return ret;
+}
+
+esp_err_t power_manager_add_gpio_wakeup(int pin)
+{
+    if (!GPIO_IS_VALID_GPIO(pin)) {
+        ESP_LOGE(TAG, "Invalid wakeup GPIO%d", pin);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_gpio_wakeup_count >= POWER_MANAGER_MAX_GPIO_WAKEUPS) {
+        ESP_LOGE(TAG, "No free GPIO wakeup slot for GPIO%d", pin);
+        return ESP_ERR_NO_MEM;
+    }
+
+    int level = gpio_get_level(pin);
+    esp_err_t ret = gpio_wakeup_enable(pin, level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to enable wakeup on GPIO%d: %s", pin, esp_err_to_name(ret));
+        return ret;
+    }
+
+    if (!s_gpio_wakeup_enabled) {
+        ret = esp_sleep_enable_gpio_wakeup();
+        if (ret != ESP_OK) {
+            gpio_wakeup_disable(pin);
+            ESP_LOGE(TAG, "Failed to enable GPIO wakeup: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        s_gpio_wakeup_enabled = true;
+    }
+
+    portENTER_CRITICAL(&s_stats_lock);
+    s_gpio_wakeups[s_gpio_wakeup_count].pin = pin;
+    s_gpio_wakeups[s_gpio_wakeup_count].armed_level = !level;
+    s_gpio_wakeup_count++;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    ESP_LOGI(TAG, "GPIO%d registered as wakeup source (level %d)", pin, level);
+    return ESP_OK;
+}
+
+esp_err_t power_manager_get_stats(power_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(stats, 0, sizeof(power_stats_t));
+    stats->enabled = s_enabled;
+    stats->light_sleep = s_enabled && s_config.enable_light_sleep;
+    stats->max_freq_mhz = s_config.max_freq_mhz;
+    stats->min_freq_mhz = s_config.min_freq_mhz;
+
+    uint32_t cpu_freq = 0;
+    esp_clk_tree_src_get_freq_hz(SOC_MOD_CLK_CPU, ESP_CLK_TREE_SRC_FREQ_PRECISION_CACHED, &cpu_freq);
+    stats->cpu_freq_mhz = cpu_freq / 1000000;
+
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_stats_lock);
+    stats->elapsed_us = (uint64_t)(now - s_stats_start_us);
+    stats->sleep_us = s_sleep_total_us;
+    stats->sleep_count = s_sleep_count;
+    stats->sleep_last_us = s_sleep_last_us;
+    stats->sleep_max_us = s_sleep_max_us;
+    memcpy(stats->wakeups, s_wakeups, sizeof(stats->wakeups));
+    stats->oversleep_last_us = s_oversleep_last_us;
+    stats->oversleep_max_us = s_oversleep_max_us;
+    stats->oversleep_avg_us = s_oversleep_samples > 0 ?
+                              (int32_t)(s_oversleep_total_us / s_oversleep_samples) : 0;
+    stats->gpio_wakeup_count = s_gpio_wakeup_count;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    stats->sleep_percent = stats->elapsed_us > 0 ?
+                           (uint8_t)(stats->sleep_us * 100 / stats->elapsed_us) : 0;
+    return ESP_OK;
+}
+
+esp_err_t power_manager_reset_stats(void)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats_start_us = esp_timer_get_time();
+    s_sleep_total_us = 0;
+    s_sleep_count = 0;
+    s_sleep_last_us = 0;
+    s_sleep_max_us = 0;
+    memset(s_wakeups, 0, sizeof(s_wakeups));
+    s_oversleep_last_us = 0;
+    s_oversleep_max_us = 0;
+    s_oversleep_total_us = 0;
+    s_oversleep_samples = 0;
+    portEXIT_CRITICAL(&s_stats_lock);
+    return ESP_OK;
+}
+
+esp_err_t power_manager_print_stats(void)
+{
+    power_stats_t stats;
+    power_manager_get_stats(&stats);
+
+    printf("\n=== 电源管理 ===\n");
+    if (!stats.enabled) {
+        printf("状态: 未启用 (固定 %" PRIu32 " MHz)\n", stats.cpu_freq_mhz);
+        printf("================\n");
+        return ESP_OK;
+    }
+
+    printf("动态调频: %" PRIu32 "-%" PRIu32 " MHz (当前 %" PRIu32 " MHz)\n",
+           stats.min_freq_mhz, stats.max_freq_mhz, stats.cpu_freq_mhz);
+    printf("自动浅睡眠: %s\n", stats.light_sleep ? "启用" : "禁用");
+    printf("UART唤醒: %s\n", s_config.uart_wakeup_num >= 0 ? "启用" : "禁用");
+    printf("GPIO唤醒源: %d 个\n", stats.gpio_wakeup_count);
+    printf("统计时长: %" PRIu64 " ms\n", stats.elapsed_us / 1000);
+    printf("睡眠时间: %" PRIu64 " ms (%d%%)\n", stats.sleep_us / 1000, stats.sleep_percent);
+    printf("睡眠次数: %" PRIu32 "\n", stats.sleep_count);
+    if (stats.sleep_count > 0) {
+        printf("睡眠时长: 最近 %" PRIu32 " us, 平均 %" PRIu64 " us, 最长 %" PRIu32 " us\n",
+               stats.sleep_last_us, stats.sleep_us / stats.sleep_count, stats.sleep_max_us);
+    }
+    printf("唤醒原因:");
+    for (int i = 0; i < POWER_WAKEUP_MAX; i++) {
+        printf(" %s %" PRIu32, power_wakeup_source_get_name((power_wakeup_source_t)i), stats.wakeups[i]);
+    }
+    printf("\n");
+    printf("定时唤醒超睡: 最近 %" PRId32 " us, 平均 %" PRId32 " us, 最大 %" PRId32 " us\n",
+           stats.oversleep_last_us, stats.oversleep_avg_us, stats.oversleep_max_us);
+    printf("================\n");
+    return ESP_OK;
+}
+
+esp_err_t power_manager_print_locks(void)
+{
+#if CONFIG_PM_ENABLE
+    printf("\n=== PM锁 ===\n");
+    esp_pm_dump_locks(stdout);
+    printf("================\n");
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+const char *power_wakeup_source_get_name(power_wakeup_source_t source)
+{
+    switch (source) {
+        case POWER_WAKEUP_TIMER:
+            return "timer";
+        case POWER_WAKEUP_UART:
+            return "uart";
+        case POWER_WAKEUP_GPIO:
+            return "gpio";
+        case POWER_WAKEUP_OTHER:
+            return "other";
+        default:
+            return "invalid";
+    }
+}
+
+// ==================== 静态函数实现 ====================
+
+static esp_err_t apply_pm_config(bool light_sleep)
+{
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = s_config.max_freq_mhz,
+        .min_freq_mhz = s_config.min_freq_mhz,
+        .light_sleep_enable = light_sleep,
+    };
+    esp_err_t ret = esp_pm_configure(&pm_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure power management: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+static IRAM_ATTR esp_err_t enter_sleep_cb(int64_t sleep_time_us, void *arg)
+{
+    rearm_gpio_wakeups();
+    s_planned_sleep_us = sleep_time_us;
+    return ESP_OK;
+}
+
+static IRAM_ATTR esp_err_t exit_sleep_cb(int64_t slept_us, void *arg)
+{
+    power_wakeup_source_t source;
+    switch (esp_sleep_get_wakeup_cause()) {
+        case ESP_SLEEP_WAKEUP_TIMER:
+            source = POWER_WAKEUP_TIMER;
+            break;
+        case ESP_SLEEP_WAKEUP_UART:
+            source = POWER_WAKEUP_UART;
+            break;
+        case ESP_SLEEP_WAKEUP_GPIO:
+            source = POWER_WAKEUP_GPIO;
+            break;
+        default:
+            source = POWER_WAKEUP_OTHER;
+            break;
+    }
+
+    portENTER_CRITICAL_ISR(&s_stats_lock);
+    s_sleep_count++;
+    s_sleep_total_us += (uint64_t)slept_us;
+    s_sleep_last_us = (uint32_t)slept_us;
+    if (s_sleep_last_us > s_sleep_max_us) {
+        s_sleep_max_us = s_sleep_last_us;
+    }
+    s_wakeups[source]++;
+
+    // 定时唤醒的计划时长已知，超出部分即超睡时间；外部唤醒的时刻不可知，不计入
+    if (source == POWER_WAKEUP_TIMER) {
+        int32_t oversleep_us = (int32_t)(slept_us - s_planned_sleep_us);
+        s_oversleep_last_us = oversleep_us;
+        if (oversleep_us > s_oversleep_max_us) {
+            s_oversleep_max_us = oversleep_us;
+        }
+        s_oversleep_total_us += oversleep_us;
+        s_oversleep_samples++;
+    }
+    portEXIT_CRITICAL_ISR(&s_stats_lock);
+    return ESP_OK;
+}
+
+static IRAM_ATTR void rearm_gpio_wakeups(void)
+{
+    // 按当前电平设置相反的唤醒电平，否则电平保持期间会反复唤醒
+    for (uint8_t i = 0; i < s_gpio_wakeup_count; i++) {
+        gpio_wakeup_t *wakeup = &s_gpio_wakeups[i];
+        int level = gpio_ll_get_level(&GPIO, wakeup->pin);
+        if (level == wakeup->armed_level) {
+            wakeup->armed_level = !level;
+            gpio_ll_set_intr_type(&GPIO, wakeup->pin, level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+        }
+    }
+}
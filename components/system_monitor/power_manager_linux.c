@@ -0,0 +1,100 @@
+/**
+ * @file power_manager_linux.c
+ * @brief 电源管理的Linux仿真实现：主机进程没有调频和浅睡眠，只保留接口
+ */
+
+#include "power_manager.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_timer.h"
+#include "board_hal.h"
+#include "board_hal_sim.h"
+
+// ==================== 静态变量 ====================
+
+static int64_t s_stats_start_us = 0;
+
+// ==================== 接口实现 ====================
+
+esp_err_t power_manager_init(const power_manager_config_t *config)
+{
+    (void)config;
+    s_stats_start_us = esp_timer_get_time();
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t power_manager_deinit(void)
+{
+    return ESP_OK;
+}
+
+bool power_manager_is_enabled(void)
+{
+    return false;
+}
+
+esp_err_t power_manager_set_light_sleep(bool enable)
+{
+    (void)enable;
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t power_manager_add_gpio_wakeup(int pin)
+{
+    (void)pin;
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t power_manager_get_stats(power_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(stats, 0, sizeof(power_stats_t));
+    stats->cpu_freq_mhz = board_hal_cpu_get_mhz();
+    stats->max_freq_mhz = stats->cpu_freq_mhz;
+    stats->min_freq_mhz = stats->cpu_freq_mhz;
+    stats->elapsed_us = (uint64_t)(esp_timer_get_time() - s_stats_start_us);
+    return ESP_OK;
+}
+
+esp_err_t power_manager_reset_stats(void)
+{
+    s_stats_start_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
+esp_err_t power_manager_print_stats(void)
+{
+    printf("\n=== 电源管理 ===\n");
+    printf("状态: 未启用 (仿真目标, 固定 %" PRIu32 " MHz)\n", board_hal_cpu_get_mhz());
+    printf("================\n");
+    return ESP_OK;
+}
+
+esp_err_t power_manager_print_locks(void)
+{
+    printf("\n=== PM锁 (仿真) ===\n");
+    printf("最高频率锁: %" PRIu32 "\n", board_hal_sim_get_pm_lock_count(BOARD_HAL_PM_CPU_FREQ_MAX));
+    printf("禁止浅睡眠锁: %" PRIu32 "\n", board_hal_sim_get_pm_lock_count(BOARD_HAL_PM_NO_LIGHT_SLEEP));
+    printf("================\n");
+    return ESP_OK;
+}
+
+const char *power_wakeup_source_get_name(power_wakeup_source_t source)
+{
+    switch (source) {
+        case POWER_WAKEUP_TIMER:
+            return "timer";
+        case POWER_WAKEUP_UART:
+            return "uart";
+        case POWER_WAKEUP_GPIO:
+            return "gpio";
+        case POWER_WAKEUP_OTHER:
+            return "other";
+        default:
+            return "invalid";
+    }
+}
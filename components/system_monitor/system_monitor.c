@@ -4,6 +4,9 @@
  */
 
 #include "system_monitor.h"
+#include "cpu_usage.h"
+#include "metrics_store.h"
+#include "power_manager.h"
 #include <stdio.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
@@ -11,12 +14,26 @@
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_chip_info.h"
+#include "sdkconfig.h"
+#if !CONFIG_IDF_TARGET_LINUX
 #include "esp_flash.h"
+#endif
 #include "esp_timer.h"
-#include "esp_clk_tree.h"
+#include "esp_heap_caps.h"
+#include "esp_attr.h"
+#ifdef CONFIG_HEAP_USE_HOOKS
+#include "esp_memory_utils.h"
+#endif
+#include "event_trace.h"
+#include "board_hal.h"
+#include "board_hal_time.h"
 
 static const char *TAG = "SYSTEM_MONITOR";
 
+// 监控任务通知位
+#define MONITOR_NOTIFY_ALLOC_FAILED     (1UL << 0)  /*!< 内存分配失败 */
+#define MONITOR_NOTIFY_WATERMARK        (1UL << 1)  /*!< 分配路径水位线触发 */
+
 // ==================== 静态变量 ====================
 
 static bool s_initialized = false;
@@ -26,10 +43,39 @@ static system_monitor_config_t s_config = {0};
 static uint32_t s_monitor_count = 0;
 static uint32_t s_warning_count = 0;
 
+// 事件驱动告警状态（分配路径中访问，保持精简）
+static portMUX_TYPE s_event_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool s_watermark_armed = false;
+static volatile uint32_t s_watermark_internal = 0;
+static volatile uint32_t s_watermark_dma = 0;
+static volatile int32_t s_watermark_budget = 0;    // 距水位线的剩余字节，分配路径扣减、释放路径归还
+static volatile int64_t s_event_post_us = 0;
+static volatile uint32_t s_alloc_fail_count = 0;
+static volatile uint32_t s_watermark_hits = 0;
+static volatile uint32_t s_last_failed_size = 0;
+static volatile uint32_t s_last_failed_caps = 0;
+static bool s_alloc_hook_registered = false;
+
+// 唤醒与检测延迟统计（仅监控任务写入）
+static uint32_t s_wakeup_count = 0;
+static uint32_t s_periodic_wakeups = 0;
+static uint32_t s_event_wakeups = 0;
+static uint32_t s_latency_last_us = 0;
+static uint32_t s_latency_max_us = 0;
+static uint64_t s_latency_total_us = 0;
+static uint32_t s_latency_samples = 0;
+
 // ==================== 静态函数声明 ====================
 
 static void monitor_task(void *pvParameters);
 static void default_memory_warning_callback(uint32_t free_heap, uint32_t threshold);
+static void default_memory_alarm_callback(uint32_t alarms, const system_memory_snapshot_t *snapshot);
+static uint32_t heap_region_caps(system_heap_region_t region);
+static void update_watermarks(void);
+static void arm_watermark(const system_memory_snapshot_t *snapshot);
+static void notify_monitor_task(uint32_t bits);
+static void heap_alloc_failed_hook(size_t size, uint32_t caps, const char *function_name);
+static void reset_alarm_stats(void);
 static esp_err_t get_flash_size(uint32_t *size_mb);
 
 // ==================== 初始化接口实现 ====================
@@ -49,21 +95,52 @@ esp_err_t system_monitor_init(const system_monitor_config_t *config)
         s_config.memory_warning_threshold = SYSTEM_MONITOR_DEFAULT_MEMORY_THRESHOLD;
         s_config.enable_auto_monitoring = true;
         s_config.warning_cb = default_memory_warning_callback;
+        s_config.thresholds = (system_memory_thresholds_t)SYSTEM_MONITOR_DEFAULT_THRESHOLDS();
+        s_config.alarm_cb = NULL;
+        s_config.enable_periodic_check = true;
     } else {
         s_config = *config;
         if (s_config.warning_cb == NULL) {
             s_config.warning_cb = default_memory_warning_callback;
         }
+        if (s_config.thresholds.fragmentation_percent > 100) {
+            s_config.thresholds.fragmentation_percent = 100;
+        }
     }
 
     // 重置统计信息
     s_monitor_count = 0;
     s_warning_count = 0;
+    reset_alarm_stats();
+    update_watermarks();
+
+    // 分配失败回调只能注册一次，反初始化后保留（任务句柄为空时直接返回）
+    if (!s_alloc_hook_registered) {
+        esp_err_t hook_ret = heap_caps_register_failed_alloc_callback(heap_alloc_failed_hook);
+        if (hook_ret == ESP_OK) {
+            s_alloc_hook_registered = true;
+        } else {
+            ESP_LOGW(TAG, "Failed to register alloc failure callback: %s", esp_err_to_name(hook_ret));
+        }
+    }
+
+    // 初始化CPU占用率采样器（失败不影响内存监控）
+    esp_err_t ret = cpu_usage_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "CPU usage sampler unavailable: %s", esp_err_to_name(ret));
+    }
+
+    // 初始化时间序列指标存储（失败不影响内存监控）
+    ret = metrics_store_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Metrics store unavailable: %s", esp_err_to_name(ret));
+    }
 
     s_initialized = true;
     
-    ESP_LOGI(TAG, "System monitor initialized - Interval: %" PRIu32 "ms, Threshold: %" PRIu32 " bytes", 
-             s_config.monitor_interval_ms, s_config.memory_warning_threshold);
+    ESP_LOGI(TAG, "System monitor initialized - Interval: %" PRIu32 "ms%s, Threshold: %" PRIu32 " bytes", 
+             s_config.monitor_interval_ms, s_config.enable_periodic_check ? "" : " (event-driven only)",
+             s_config.memory_warning_threshold);
     
     // 如果启用自动监控，立即启动
     if (s_config.enable_auto_monitoring) {
@@ -87,6 +164,9 @@ esp_err_t system_monitor_deinit(void)
         system_monitor_stop();
     }
 
+    metrics_store_deinit();
+    cpu_usage_deinit();
+
     s_initialized = false;
     
     ESP_LOGI(TAG, "System monitor deinitialized");
@@ -117,9 +197,7 @@ esp_err_t system_get_info(system_info_t *info)
     info->cores = chip_info.cores;
     
     // 获取CPU频率
-    uint32_t cpu_freq;
-    esp_clk_tree_src_get_freq_hz(SOC_MOD_CLK_CPU, ESP_CLK_TREE_SRC_FREQ_PRECISION_CACHED, &cpu_freq);
-    info->cpu_freq_mhz = cpu_freq / 1000000;
+    info->cpu_freq_mhz = board_hal_cpu_get_mhz();
     
     // 获取Flash大小
     uint32_t flash_size;
@@ -131,7 +209,7 @@ esp_err_t system_get_info(system_info_t *info)
     
     info->free_heap = esp_get_free_heap_size();
     info->min_free_heap = esp_get_minimum_free_heap_size();
-    info->uptime_ms = esp_timer_get_time() / 1000;
+    info->uptime_ms = board_hal_time_get_us() / 1000;
     
     return ESP_OK;
 }
@@ -191,18 +269,14 @@ uint32_t system_get_min_free_heap(void)
 
 uint8_t system_get_heap_usage_percent(void)
 {
-    uint32_t free_heap = esp_get_free_heap_size();
-    uint32_t min_free_heap = esp_get_minimum_free_heap_size();
+    uint32_t total_heap = heap_caps_get_total_size(MALLOC_CAP_DEFAULT);
+    uint32_t free_heap = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
     
-    if (min_free_heap == 0) {
+    if (total_heap == 0 || free_heap > total_heap) {
         return 0;
     }
     
-    // 估算总堆大小（这是一个近似值）
-    uint32_t estimated_total_heap = free_heap + (min_free_heap * 2);
-    uint32_t used_heap = estimated_total_heap - free_heap;
-    
-    return (used_heap * 100) / estimated_total_heap;
+    return (uint8_t)(((uint64_t)(total_heap - free_heap) * 100) / total_heap);
 }
 
 bool system_is_memory_low(uint32_t threshold)
@@ -210,17 +284,136 @@ bool system_is_memory_low(uint32_t threshold)
     return esp_get_free_heap_size() < threshold;
 }
 
+const char *system_heap_region_get_name(system_heap_region_t region)
+{
+    switch (region) {
+        case SYSTEM_HEAP_INTERNAL: return "internal";
+        case SYSTEM_HEAP_DMA:      return "dma";
+        case SYSTEM_HEAP_SPIRAM:   return "spiram";
+        default:                   return "unknown";
+    }
+}
+
+esp_err_t system_get_heap_region_info(system_heap_region_t region, system_heap_region_info_t *info)
+{
+    if (info == NULL || region >= SYSTEM_HEAP_REGION_MAX) {
+        ESP_LOGE(TAG, "Invalid heap region parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(info, 0, sizeof(*info));
+
+    uint32_t caps = heap_region_caps(region);
+    if (caps == 0) {
+        // 该区域在当前配置下不存在（例如未启用PSRAM）
+        return ESP_OK;
+    }
+
+    multi_heap_info_t heap_info;
+    heap_caps_get_info(&heap_info, caps);
+
+    info->total_bytes = heap_caps_get_total_size(caps);
+    info->free_bytes = heap_info.total_free_bytes;
+    info->min_free_bytes = heap_info.minimum_free_bytes;
+    info->largest_free_block = heap_info.largest_free_block;
+    info->free_blocks = heap_info.free_blocks;
+
+    if (info->total_bytes > 0 && info->free_bytes <= info->total_bytes) {
+        info->usage_percent = (uint8_t)(((uint64_t)(info->total_bytes - info->free_bytes) * 100) / info->total_bytes);
+    }
+
+    // 碎片率: 可用内存中不能以单个块分配出去的比例
+    if (info->free_bytes > 0 && info->largest_free_block <= info->free_bytes) {
+        info->fragmentation_percent = (uint8_t)(100 - ((uint64_t)info->largest_free_block * 100) / info->free_bytes);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t system_get_memory_snapshot(system_memory_snapshot_t *snapshot)
+{
+    if (snapshot == NULL) {
+        ESP_LOGE(TAG, "Snapshot pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (int i = 0; i < SYSTEM_HEAP_REGION_MAX; i++) {
+        system_get_heap_region_info((system_heap_region_t)i, &snapshot->regions[i]);
+    }
+    snapshot->total_free_bytes = esp_get_free_heap_size();
+
+    return ESP_OK;
+}
+
+uint32_t system_check_memory_alarms(const system_memory_snapshot_t *snapshot)
+{
+    system_memory_snapshot_t local;
+    if (snapshot == NULL) {
+        system_get_memory_snapshot(&local);
+        snapshot = &local;
+    }
+
+    const system_memory_thresholds_t *th = &s_config.thresholds;
+    const system_heap_region_info_t *internal = &snapshot->regions[SYSTEM_HEAP_INTERNAL];
+    const system_heap_region_info_t *dma = &snapshot->regions[SYSTEM_HEAP_DMA];
+    uint32_t alarms = SYSTEM_MEMORY_ALARM_NONE;
+
+    if (s_config.memory_warning_threshold > 0 &&
+        snapshot->total_free_bytes < s_config.memory_warning_threshold) {
+        alarms |= SYSTEM_MEMORY_ALARM_TOTAL_FREE;
+    }
+
+    if (th->internal_free_bytes > 0 && internal->free_bytes < th->internal_free_bytes) {
+        alarms |= SYSTEM_MEMORY_ALARM_INTERNAL_FREE;
+    }
+
+    // RMT/DMA外设依赖DMA可用内存，单独检查
+    if (th->dma_free_bytes > 0 && dma->free_bytes < th->dma_free_bytes) {
+        alarms |= SYSTEM_MEMORY_ALARM_DMA_FREE;
+    }
+
+    if (th->largest_block_bytes > 0 &&
+        (internal->largest_free_block < th->largest_block_bytes ||
+         dma->largest_free_block < th->largest_block_bytes)) {
+        alarms |= SYSTEM_MEMORY_ALARM_LARGEST_BLOCK;
+    }
+
+    if (th->fragmentation_percent > 0 &&
+        (internal->fragmentation_percent >= th->fragmentation_percent ||
+         dma->fragmentation_percent >= th->fragmentation_percent)) {
+        alarms |= SYSTEM_MEMORY_ALARM_FRAGMENTATION;
+    }
+
+    return alarms;
+}
+
 esp_err_t system_print_memory_status(void)
 {
-    uint32_t free_heap = system_get_free_heap();
-    uint32_t min_free_heap = system_get_min_free_heap();
-    uint8_t usage_percent = system_get_heap_usage_percent();
+    system_memory_snapshot_t snapshot;
+    system_get_memory_snapshot(&snapshot);
+    uint32_t alarms = system_check_memory_alarms(&snapshot);
     
     printf("\n=== 内存状态 ===\n");
-    printf("可用堆内存: %" PRIu32 " bytes\n", free_heap);
-    printf("最小可用堆内存: %" PRIu32 " bytes\n", min_free_heap);
-    printf("内存使用率: %d%%\n", usage_percent);
-    printf("内存状态: %s\n", system_is_memory_low(s_config.memory_warning_threshold) ? "不足" : "正常");
+    printf("可用堆内存: %" PRIu32 " bytes\n", snapshot.total_free_bytes);
+    printf("最小可用堆内存: %" PRIu32 " bytes\n", system_get_min_free_heap());
+    printf("内存使用率: %d%%\n", system_get_heap_usage_percent());
+    printf("\n%-9s %9s %9s %9s %9s %5s %5s\n", "区域", "总量", "可用", "最小可用", "最大块", "使用", "碎片");
+    for (int i = 0; i < SYSTEM_HEAP_REGION_MAX; i++) {
+        const system_heap_region_info_t *r = &snapshot.regions[i];
+        if (r->total_bytes == 0) {
+            continue;
+        }
+        printf("%-9s %9" PRIu32 " %9" PRIu32 " %9" PRIu32 " %9" PRIu32 " %4d%% %4d%%\n",
+               system_heap_region_get_name((system_heap_region_t)i),
+               r->total_bytes, r->free_bytes, r->min_free_bytes, r->largest_free_block,
+               r->usage_percent, r->fragmentation_percent);
+    }
+    printf("\n内存状态: %s\n", alarms ? "不足" : "正常");
+    if (alarms & SYSTEM_MEMORY_ALARM_TOTAL_FREE)    printf("  - 可用堆内存低于 %" PRIu32 " bytes\n", s_config.memory_warning_threshold);
+    if (alarms & SYSTEM_MEMORY_ALARM_INTERNAL_FREE) printf("  - 内部RAM低于 %" PRIu32 " bytes\n", s_config.thresholds.internal_free_bytes);
+    if (alarms & SYSTEM_MEMORY_ALARM_DMA_FREE)      printf("  - DMA RAM低于 %" PRIu32 " bytes\n", s_config.thresholds.dma_free_bytes);
+    if (alarms & SYSTEM_MEMORY_ALARM_LARGEST_BLOCK) printf("  - 最大空闲块低于 %" PRIu32 " bytes\n", s_config.thresholds.largest_block_bytes);
+    if (alarms & SYSTEM_MEMORY_ALARM_FRAGMENTATION) printf("  - 碎片率达到 %d%%\n", s_config.thresholds.fragmentation_percent);
     printf("================\n");
     
     return ESP_OK;
@@ -230,7 +423,7 @@ esp_err_t system_print_memory_status(void)
 
 uint64_t system_get_uptime_ms(void)
 {
-    return esp_timer_get_time() / 1000;
+    return board_hal_time_get_us() / 1000;
 }
 
 uint32_t system_get_uptime_seconds(void)
@@ -240,9 +433,7 @@ uint32_t system_get_uptime_seconds(void)
 
 uint32_t system_get_cpu_freq_hz(void)
 {
-    uint32_t cpu_freq;
-    esp_clk_tree_src_get_freq_hz(SOC_MOD_CLK_CPU, ESP_CLK_TREE_SRC_FREQ_PRECISION_CACHED, &cpu_freq);
-    return cpu_freq;
+    return board_hal_cpu_get_mhz() * 1000000;
 }
 
 uint32_t system_get_cpu_freq_mhz(void)
@@ -287,10 +478,12 @@ esp_err_t system_monitor_stop(void)
     ESP_LOGI(TAG, "Stopping system monitor task");
     
     s_monitoring_running = false;
+    s_watermark_armed = false;
     
     if (s_monitor_task_handle != NULL) {
-        vTaskDelete(s_monitor_task_handle);
+        TaskHandle_t handle = s_monitor_task_handle;
         s_monitor_task_handle = NULL;
+        vTaskDelete(handle);
     }
 
     ESP_LOGI(TAG, "System monitor task stopped");
@@ -315,10 +508,42 @@ esp_err_t system_monitor_set_memory_threshold(uint32_t threshold)
     }
 
     s_config.memory_warning_threshold = threshold;
+    update_watermarks();
     ESP_LOGI(TAG, "Memory warning threshold set to %" PRIu32 " bytes", threshold);
     return ESP_OK;
 }
 
+esp_err_t system_monitor_set_memory_thresholds(const system_memory_thresholds_t *thresholds)
+{
+    if (!s_initialized) {
+        ESP_LOGE(TAG, "System monitor not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (thresholds == NULL || thresholds->fragmentation_percent > 100) {
+        ESP_LOGE(TAG, "Invalid memory thresholds");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_config.thresholds = *thresholds;
+    update_watermarks();
+    ESP_LOGI(TAG, "Memory thresholds set - Internal: %" PRIu32 ", DMA: %" PRIu32 ", Block: %" PRIu32 " bytes, Frag: %d%%",
+             thresholds->internal_free_bytes, thresholds->dma_free_bytes,
+             thresholds->largest_block_bytes, thresholds->fragmentation_percent);
+    return ESP_OK;
+}
+
+esp_err_t system_monitor_get_memory_thresholds(system_memory_thresholds_t *thresholds)
+{
+    if (thresholds == NULL) {
+        ESP_LOGE(TAG, "Thresholds pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *thresholds = s_config.thresholds;
+    return ESP_OK;
+}
+
 esp_err_t system_monitor_set_interval(uint32_t interval_ms)
 {
     if (!s_initialized) {
@@ -342,7 +567,7 @@ void system_restart(uint32_t delay_ms)
 {
     if (delay_ms > 0) {
         ESP_LOGI(TAG, "System will restart in %" PRIu32 " ms", delay_ms);
-        vTaskDelay(pdMS_TO_TICKS(delay_ms));
+        board_hal_time_delay_ms(delay_ms);
     }
     
     ESP_LOGI(TAG, "Restarting system...");
@@ -361,7 +586,7 @@ void system_safe_restart(uint32_t delay_ms)
     // 等待其他任务完成清理工作
     if (delay_ms > 0) {
         ESP_LOGI(TAG, "Waiting %" PRIu32 " ms for cleanup...", delay_ms);
-        vTaskDelay(pdMS_TO_TICKS(delay_ms));
+        board_hal_time_delay_ms(delay_ms);
     }
     
     system_restart(0);
@@ -381,10 +606,31 @@ esp_err_t system_monitor_get_stats(uint32_t *monitor_count, uint32_t *warning_co
     return ESP_OK;
 }
 
+esp_err_t system_monitor_get_alarm_stats(system_monitor_alarm_stats_t *stats)
+{
+    if (stats == NULL) {
+        ESP_LOGE(TAG, "Invalid parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    stats->wakeups = s_wakeup_count;
+    stats->periodic_wakeups = s_periodic_wakeups;
+    stats->event_wakeups = s_event_wakeups;
+    stats->alloc_failures = s_alloc_fail_count;
+    stats->watermark_hits = s_watermark_hits;
+    stats->last_failed_size = s_last_failed_size;
+    stats->last_failed_caps = s_last_failed_caps;
+    stats->latency_last_us = s_latency_last_us;
+    stats->latency_max_us = s_latency_max_us;
+    stats->latency_avg_us = s_latency_samples > 0 ? (uint32_t)(s_latency_total_us / s_latency_samples) : 0;
+    return ESP_OK;
+}
+
 esp_err_t system_monitor_reset_stats(void)
 {
     s_monitor_count = 0;
     s_warning_count = 0;
+    reset_alarm_stats();
     ESP_LOGI(TAG, "Monitor statistics reset");
     return ESP_OK;
 }
@@ -392,11 +638,47 @@ esp_err_t system_monitor_reset_stats(void)
 esp_err_t system_monitor_print_stats(void)
 {
     printf("\n=== 监控统计 ===\n");
-    printf("监控次数: %" PRIu32 "\n", s_monitor_count);
+    printf("监控次数: %" PRIu32 " (定时检查)\n", s_monitor_count);
     printf("警告次数: %" PRIu32 "\n", s_warning_count);
     printf("监控状态: %s\n", s_monitoring_running ? "运行中" : "已停止");
     printf("监控间隔: %" PRIu32 " ms\n", s_config.monitor_interval_ms);
     printf("内存阈值: %" PRIu32 " bytes\n", s_config.memory_warning_threshold);
+    printf("内部RAM阈值: %" PRIu32 " bytes\n", s_config.thresholds.internal_free_bytes);
+    printf("DMA RAM阈值: %" PRIu32 " bytes\n", s_config.thresholds.dma_free_bytes);
+    printf("最大块阈值: %" PRIu32 " bytes\n", s_config.thresholds.largest_block_bytes);
+    printf("碎片率阈值: %d%%\n", s_config.thresholds.fragmentation_percent);
+
+    system_monitor_alarm_stats_t alarm_stats;
+    system_monitor_get_alarm_stats(&alarm_stats);
+    printf("周期检查: %s\n", s_config.enable_periodic_check ? "启用" : "禁用(仅事件驱动)");
+    printf("水位线钩子: %s\n",
+#ifdef CONFIG_HEAP_USE_HOOKS
+           !s_monitoring_running ? "未运行" :
+           s_watermark_armed ? "已启用" : "已触发(等待恢复)"
+#else
+           "未启用(CONFIG_HEAP_USE_HOOKS)"
+#endif
+           );
+    printf("唤醒次数: %" PRIu32 " (定时 %" PRIu32 ", 事件 %" PRIu32 ")\n",
+           alarm_stats.wakeups, alarm_stats.periodic_wakeups, alarm_stats.event_wakeups);
+    printf("分配失败次数: %" PRIu32 "\n", alarm_stats.alloc_failures);
+    if (alarm_stats.alloc_failures > 0) {
+        printf("最近分配失败: %" PRIu32 " bytes, caps 0x%08" PRIx32 "\n",
+               alarm_stats.last_failed_size, alarm_stats.last_failed_caps);
+    }
+    printf("水位线触发次数: %" PRIu32 "\n", alarm_stats.watermark_hits);
+    printf("检测延迟: 最近 %" PRIu32 " us, 平均 %" PRIu32 " us, 最大 %" PRIu32 " us\n",
+           alarm_stats.latency_last_us, alarm_stats.latency_avg_us, alarm_stats.latency_max_us);
+
+    power_stats_t power_stats;
+    power_manager_get_stats(&power_stats);
+    if (power_stats.enabled) {
+        printf("浅睡眠: %d%% (%" PRIu32 " 次, 定时唤醒超睡平均 %" PRId32 " us, 最大 %" PRId32 " us)\n",
+               power_stats.sleep_percent, power_stats.sleep_count,
+               power_stats.oversleep_avg_us, power_stats.oversleep_max_us);
+    } else {
+        printf("浅睡眠: 未启用\n");
+    }
     printf("================\n");
     return ESP_OK;
 }
@@ -405,33 +687,106 @@ esp_err_t system_monitor_print_stats(void)
 
 static void monitor_task(void *pvParameters)
 {
-    TickType_t last_wake_time = xTaskGetTickCount();
+    // 周期与超时经过时间源，仿真时可由虚拟时钟压缩
+    TickType_t next_wake_time = board_hal_time_get_ticks() + pdMS_TO_TICKS(s_config.monitor_interval_ms);
     
     ESP_LOGI(TAG, "Monitor task started");
+    system_memory_snapshot_t initial;
+    system_get_memory_snapshot(&initial);
+    arm_watermark(&initial);
     
     while (s_monitoring_running) {
-        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(s_config.monitor_interval_ms));
+        // 周期检查关闭且水位线已武装时无限等待，仅由内存事件唤醒
+        TickType_t wait_ticks = portMAX_DELAY;
+        if (s_config.enable_periodic_check || !s_watermark_armed) {
+            TickType_t now = board_hal_time_get_ticks();
+            wait_ticks = (int32_t)(next_wake_time - now) > 0 ? next_wake_time - now : 0;
+        }
+        
+        uint32_t events = 0;
+        BaseType_t notified = board_hal_time_notify_wait(0, UINT32_MAX, &events, wait_ticks);
         
         if (!s_monitoring_running) {
             break;
         }
         
-        s_monitor_count++;
+        s_wakeup_count++;
+        EVENT_TRACE_BEGIN(EVENT_TRACE_MONITOR_CYCLE, notified == pdTRUE ? events : 0, 0);
+        
+        if (notified == pdTRUE) {
+            s_event_wakeups++;
+            
+            portENTER_CRITICAL(&s_event_lock);
+            int64_t posted_us = s_event_post_us;
+            s_event_post_us = 0;
+            portEXIT_CRITICAL(&s_event_lock);
+            
+            if (posted_us > 0) {
+                uint32_t latency_us = (uint32_t)(esp_timer_get_time() - posted_us);
+                s_latency_last_us = latency_us;
+                if (latency_us > s_latency_max_us) {
+                    s_latency_max_us = latency_us;
+                }
+                s_latency_total_us += latency_us;
+                s_latency_samples++;
+            }
+        } else {
+            // 监控次数只统计定时检查，事件唤醒单独计入 s_event_wakeups
+            s_monitor_count++;
+            s_periodic_wakeups++;
+            next_wake_time += pdMS_TO_TICKS(s_config.monitor_interval_ms);
+            if ((int32_t)(next_wake_time - board_hal_time_get_ticks()) <= 0) {
+                next_wake_time = board_hal_time_get_ticks() + pdMS_TO_TICKS(s_config.monitor_interval_ms);
+            }
+            
+            // 记录本周期的CPU占用率
+            if (s_config.enable_periodic_check) {
+                cpu_usage_sample(NULL);
+            }
+        }
         
-        uint32_t free_heap = system_get_free_heap();
+        system_memory_snapshot_t snapshot;
+        system_get_memory_snapshot(&snapshot);
+        uint32_t free_heap = snapshot.total_free_bytes;
         
-        // 检查内存是否低于阈值
-        if (system_is_memory_low(s_config.memory_warning_threshold)) {
+        // 按各内存能力检查阈值
+        uint32_t alarms = system_check_memory_alarms(&snapshot);
+        if (events & MONITOR_NOTIFY_ALLOC_FAILED) {
+            alarms |= SYSTEM_MEMORY_ALARM_ALLOC_FAILED;
+        }
+        
+        if (alarms != SYSTEM_MEMORY_ALARM_NONE) {
             s_warning_count++;
-            if (s_config.warning_cb != NULL) {
-                s_config.warning_cb(free_heap, s_config.memory_warning_threshold);
+            if (s_config.alarm_cb != NULL) {
+                s_config.alarm_cb(alarms, &snapshot);
+            } else if (alarms & SYSTEM_MEMORY_ALARM_TOTAL_FREE) {
+                if (s_config.warning_cb != NULL) {
+                    s_config.warning_cb(free_heap, s_config.memory_warning_threshold);
+                }
+            } else {
+                default_memory_alarm_callback(alarms, &snapshot);
+            }
+        }
+        
+        // 余量耗尽只是估计值：实际仍在水位线以上时按新余量立即重新武装；
+        // 真正低于水位线时计一次触发，内存恢复后再武装，避免告警风暴
+        if (!s_watermark_armed) {
+            bool below = snapshot.regions[SYSTEM_HEAP_INTERNAL].free_bytes < s_watermark_internal ||
+                         snapshot.regions[SYSTEM_HEAP_DMA].free_bytes < s_watermark_dma;
+            if (below && (events & MONITOR_NOTIFY_WATERMARK)) {
+                s_watermark_hits++;
+            }
+            if (!below) {
+                arm_watermark(&snapshot);
             }
         }
         
         #ifdef CONFIG_LOG_DEFAULT_LEVEL_DEBUG
-        ESP_LOGD(TAG, "Monitor cycle %" PRIu32 " - Free heap: %" PRIu32 " bytes, Uptime: %" PRIu64 " ms", 
-                 s_monitor_count, free_heap, system_get_uptime_ms());
+        ESP_LOGD(TAG, "Monitor cycle %" PRIu32 " (%s) - Free heap: %" PRIu32 " bytes, Uptime: %" PRIu64 " ms", 
+                 s_wakeup_count, notified == pdTRUE ? "event" : "timer", free_heap, system_get_uptime_ms());
         #endif
+        
+        EVENT_TRACE_END(EVENT_TRACE_MONITOR_CYCLE, 0, free_heap);
     }
     
     ESP_LOGI(TAG, "Monitor task ended");
@@ -447,12 +802,182 @@ static void default_memory_warning_callback(uint32_t free_heap, uint32_t thresho
            free_heap, threshold);
 }
 
+static void default_memory_alarm_callback(uint32_t alarms, const system_memory_snapshot_t *snapshot)
+{
+    const system_heap_region_info_t *internal = &snapshot->regions[SYSTEM_HEAP_INTERNAL];
+    const system_heap_region_info_t *dma = &snapshot->regions[SYSTEM_HEAP_DMA];
+
+    ESP_LOGW(TAG, "Memory alarm 0x%02" PRIx32 ": internal %" PRIu32 " (blk %" PRIu32 ", frag %d%%), dma %" PRIu32 " (blk %" PRIu32 ", frag %d%%)",
+             alarms, internal->free_bytes, internal->largest_free_block, internal->fragmentation_percent,
+             dma->free_bytes, dma->largest_free_block, dma->fragmentation_percent);
+    printf("⚠️  内存警告: 内部RAM %" PRIu32 " bytes, DMA RAM %" PRIu32 " bytes, 最大块 %" PRIu32 " bytes\n",
+           internal->free_bytes, dma->free_bytes, dma->largest_free_block);
+    if (alarms & SYSTEM_MEMORY_ALARM_ALLOC_FAILED) {
+        printf("⚠️  内存分配失败: %" PRIu32 " bytes, caps 0x%08" PRIx32 "\n",
+               (uint32_t)s_last_failed_size, (uint32_t)s_last_failed_caps);
+    }
+}
+
+static void update_watermarks(void)
+{
+    // 内部RAM水位线未配置时退回到总内存阈值
+    s_watermark_internal = s_config.thresholds.internal_free_bytes > 0 ?
+                           s_config.thresholds.internal_free_bytes : s_config.memory_warning_threshold;
+    s_watermark_dma = s_config.thresholds.dma_free_bytes;
+
+    // 旧余量按旧水位线计算，解除武装后由监控任务按新水位线重新计算
+    portENTER_CRITICAL(&s_event_lock);
+    bool was_armed = s_watermark_armed;
+    s_watermark_armed = false;
+    portEXIT_CRITICAL(&s_event_lock);
+    if (was_armed) {
+        notify_monitor_task(MONITOR_NOTIFY_WATERMARK);
+    }
+}
+
+// 以当前内存到水位线的最小余量武装分配路径检查，水位线均未配置时不武装
+static void arm_watermark(const system_memory_snapshot_t *snapshot)
+{
+    int64_t budget = INT32_MAX;
+    if (s_watermark_internal > 0) {
+        budget = (int64_t)snapshot->regions[SYSTEM_HEAP_INTERNAL].free_bytes - s_watermark_internal;
+    }
+    if (s_watermark_dma > 0) {
+        int64_t dma = (int64_t)snapshot->regions[SYSTEM_HEAP_DMA].free_bytes - s_watermark_dma;
+        budget = dma < budget ? dma : budget;
+    }
+    if (budget <= 0 || budget == INT32_MAX) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_event_lock);
+    s_watermark_budget = (int32_t)budget;
+    s_watermark_armed = true;
+    portEXIT_CRITICAL(&s_event_lock);
+}
+
+static void reset_alarm_stats(void)
+{
+    s_wakeup_count = 0;
+    s_periodic_wakeups = 0;
+    s_event_wakeups = 0;
+    s_alloc_fail_count = 0;
+    s_watermark_hits = 0;
+    s_last_failed_size = 0;
+    s_last_failed_caps = 0;
+    s_latency_last_us = 0;
+    s_latency_max_us = 0;
+    s_latency_total_us = 0;
+    s_latency_samples = 0;
+}
+
+static void IRAM_ATTR notify_monitor_task(uint32_t bits)
+{
+    TaskHandle_t handle = s_monitor_task_handle;
+    if (handle == NULL) {
+        return;
+    }
+
+    // 只记录第一次未处理事件的时间，用于计算检测延迟
+    portENTER_CRITICAL_SAFE(&s_event_lock);
+    if (s_event_post_us == 0) {
+        s_event_post_us = esp_timer_get_time();
+    }
+    portEXIT_CRITICAL_SAFE(&s_event_lock);
+
+    if (xPortInIsrContext()) {
+        BaseType_t higher_priority_woken = pdFALSE;
+        xTaskNotifyFromISR(handle, bits, eSetBits, &higher_priority_woken);
+        portYIELD_FROM_ISR(higher_priority_woken);
+    } else {
+        xTaskNotify(handle, bits, eSetBits);
+    }
+}
+
+static void IRAM_ATTR heap_alloc_failed_hook(size_t size, uint32_t caps, const char *function_name)
+{
+    (void)function_name;
+    s_alloc_fail_count++;
+    s_last_failed_size = size;
+    s_last_failed_caps = caps;
+    notify_monitor_task(MONITOR_NOTIFY_ALLOC_FAILED);
+}
+
+#ifdef CONFIG_HEAP_USE_HOOKS
+/*
+ * 堆分配/释放钩子。分配路径上不遍历堆：武装时监控任务按当前空闲内存记下到水位线的余量，
+ * 内部RAM中的每次分配扣减、释放归还实际块大小（块头读取，O(1)），余量由正变为非正时
+ * 解除武装并通知一次监控任务，由它读取真实的空闲内存决定是告警还是重新武装
+ */
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    (void)size;
+    (void)caps;
+
+    if (!s_watermark_armed || ptr == NULL || !esp_ptr_internal(ptr)) {
+        return;
+    }
+
+    int32_t used = (int32_t)heap_caps_get_allocated_size(ptr);
+    bool crossed = false;
+    portENTER_CRITICAL_SAFE(&s_event_lock);
+    if (s_watermark_armed) {
+        s_watermark_budget -= used;
+        if (s_watermark_budget <= 0) {
+            s_watermark_armed = false;
+            crossed = true;
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&s_event_lock);
+
+    if (crossed) {
+        notify_monitor_task(MONITOR_NOTIFY_WATERMARK);
+    }
+}
+
+void IRAM_ATTR esp_heap_trace_free_hook(void *ptr)
+{
+    if (!s_watermark_armed || ptr == NULL || !esp_ptr_internal(ptr)) {
+        return;
+    }
+
+    int32_t freed = (int32_t)heap_caps_get_allocated_size(ptr);
+    portENTER_CRITICAL_SAFE(&s_event_lock);
+    if (s_watermark_armed) {
+        s_watermark_budget += freed;
+    }
+    portEXIT_CRITICAL_SAFE(&s_event_lock);
+}
+#endif
+
+static uint32_t heap_region_caps(system_heap_region_t region)
+{
+    switch (region) {
+        case SYSTEM_HEAP_INTERNAL:
+            return MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+        case SYSTEM_HEAP_DMA:
+            return MALLOC_CAP_DMA;
+        case SYSTEM_HEAP_SPIRAM:
+#ifdef CONFIG_SPIRAM
+            return MALLOC_CAP_SPIRAM;
+#else
+            return 0;
+#endif
+        default:
+            return 0;
+    }
+}
+
 static esp_err_t get_flash_size(uint32_t *size_mb)
 {
     if (size_mb == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
     
+#if CONFIG_IDF_TARGET_LINUX
+    // 仿真目标没有SPI Flash芯片
+    return ESP_ERR_NOT_SUPPORTED;
+#else
     uint32_t flash_size;
     esp_err_t ret = esp_flash_get_size(NULL, &flash_size);
     if (ret != ESP_OK) {
@@ -462,4 +987,5 @@ static esp_err_t get_flash_size(uint32_t *size_mb)
     
     *size_mb = flash_size / (1024 * 1024);
     return ESP_OK;
+#endif
 }
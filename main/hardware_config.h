@@ -8,10 +8,8 @@
 
 // 风扇控制配置
 #define FAN_PWM_PIN         41      // 风扇PWM控制引脚
-#define FAN_PWM_TIMER       LEDC_TIMER_0
-#define FAN_PWM_MODE        LEDC_LOW_SPEED_MODE
-#define FAN_PWM_CHANNEL     LEDC_CHANNEL_0
-#define FAN_PWM_RESOLUTION  LEDC_TIMER_8_BIT
+#define FAN_PWM_CHANNEL     0       // PWM通道（同号定时器）
+#define FAN_PWM_RESOLUTION  8       // 占空比分辨率(位)
 #define FAN_PWM_FREQUENCY   25000   // 25kHz PWM频率
 
 // WS2812 LED配置
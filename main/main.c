@@ -16,6 +16,7 @@
 #include "device_interface.h"
 #include "console_interface.h"
 #include "hardware_config.h"
+#include "boot_profile.h"
 
 static const char *TAG = "ESP32S3_MAIN";
 
@@ -27,6 +28,8 @@ static void console_event_handler(console_event_t event, const char *data);
 
 void app_main(void)
 {
+    boot_profile_mark("app_main");
+
     // 设置日志级别
     esp_log_level_set("*", ESP_LOG_WARN);
     
@@ -39,6 +42,7 @@ void app_main(void)
         ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK(ret);
+    boot_profile_mark("nvs_flash");
 
     // 初始化设备接口（包含硬件控制和系统监控）
     device_interface_config_t device_config = DEVICE_INTERFACE_DEFAULT_CONFIG();
@@ -48,6 +52,7 @@ void app_main(void)
     } else {
         ESP_LOGI(TAG, "设备接口初始化成功");
     }
+    boot_profile_mark("device_interface");
 
     // 注册设备事件回调
     device_interface_register_event_callback(device_event_handler);
@@ -60,6 +65,7 @@ void app_main(void)
     } else {
         ESP_LOGI(TAG, "控制台接口初始化成功");
     }
+    boot_profile_mark("console_init");
 
     // 注册控制台事件回调
     console_interface_register_event_callback(console_event_handler);
@@ -68,22 +74,28 @@ void app_main(void)
     console_interface_register_system_commands();
     console_interface_register_device_commands();
     console_interface_register_config_commands();
+    boot_profile_mark("console_commands");
 
+#if !FAST_BOOT_ENABLED
     // 短暂延迟让系统稳定
     vTaskDelay(1000 / portTICK_PERIOD_MS);
 
     // 显示系统信息
     device_print_full_status();
+    boot_profile_mark("status_print");
+#endif
+
+    // 快速启动时初始化均为同步完成，控制台任务启动后立即可用；
+    // 完整状态可通过 status 命令查看
+    printf("系统初始化完成！\n");
 
-    // 启动控制台任务
-    ret = console_interface_start(4096, 5);
+    // 启动控制台任务（命令行在栈上分词，参数副本也在栈上）
+    ret = console_interface_start(6144, 5);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "控制台任务启动失败: %s", esp_err_to_name(ret));
     } else {
         ESP_LOGI(TAG, "控制台任务启动成功");
     }
-
-    printf("系统初始化完成！\n");
     
     // 主任务现在可以自由运行，不会阻塞
     while (true) {
@@ -0,0 +1,19 @@
+/**
+ * @file esp_log.h
+ * @brief 主机测试桩：日志不输出，只检查格式串
+ */
+
+#pragma once
+
+__attribute__((format(printf, 2, 3)))
+static inline void esp_log_stub(const char *tag, const char *format, ...)
+{
+    (void)tag;
+    (void)format;
+}
+
+#define ESP_LOGE(tag, format, ...) esp_log_stub(tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) esp_log_stub(tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) esp_log_stub(tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) esp_log_stub(tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) esp_log_stub(tag, format, ##__VA_ARGS__)
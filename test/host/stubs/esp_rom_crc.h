@@ -0,0 +1,10 @@
+/**
+ * @file esp_rom_crc.h
+ * @brief 主机测试桩：ROM CRC
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+uint16_t esp_rom_crc16_le(uint16_t crc, const uint8_t *buf, uint32_t len);
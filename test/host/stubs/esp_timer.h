@@ -0,0 +1,10 @@
+/**
+ * @file esp_timer.h
+ * @brief 主机测试桩：单调时间
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
@@ -0,0 +1,25 @@
+/**
+ * @file FreeRTOS.h
+ * @brief 主机测试桩：基本类型与临界区（用pthread互斥锁实现）
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <pthread.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFFu)
+#define configTICK_RATE_HZ      1000
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+typedef pthread_mutex_t portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    PTHREAD_MUTEX_INITIALIZER
+#define portENTER_CRITICAL(mux)         pthread_mutex_lock(mux)
+#define portEXIT_CRITICAL(mux)          pthread_mutex_unlock(mux)
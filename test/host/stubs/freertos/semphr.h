@@ -0,0 +1,14 @@
+/**
+ * @file semphr.h
+ * @brief 主机测试桩：互斥锁
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef pthread_mutex_t *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
@@ -0,0 +1,8 @@
+/**
+ * @file task.h
+ * @brief 主机测试桩：被测代码只用到 FreeRTOS.h 中的类型
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
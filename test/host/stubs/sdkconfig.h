@@ -0,0 +1,8 @@
+/**
+ * @file sdkconfig.h
+ * @brief 主机测试桩：按Linux目标编译
+ */
+
+#pragma once
+
+#define CONFIG_IDF_TARGET_LINUX 1
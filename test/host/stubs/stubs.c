@@ -0,0 +1,315 @@
+/**
+ * @file stubs.c
+ * @brief 主机测试桩实现：错误名、时间、CRC、互斥锁和内存中的NVS
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_rom_crc.h"
+#include "freertos/semphr.h"
+#include "nvs.h"
+
+// ==================== 错误名与时间 ====================
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_INVALID_CRC: return "ESP_ERR_INVALID_CRC";
+        case ESP_ERR_INVALID_VERSION: return "ESP_ERR_INVALID_VERSION";
+        case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// 与ROM的 crc16_le 相同：反射多项式0x8408，输入输出取反
+uint16_t esp_rom_crc16_le(uint16_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = (uint16_t)~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0x8408) : (uint16_t)(crc >> 1);
+        }
+    }
+    return (uint16_t)~crc;
+}
+
+// ==================== 互斥锁 ====================
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    pthread_mutex_t *mutex = malloc(sizeof(*mutex));
+    if (mutex != NULL) {
+        pthread_mutex_init(mutex, NULL);
+    }
+    return mutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout)
+{
+    (void)timeout;
+    return pthread_mutex_lock(sem) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    return pthread_mutex_unlock(sem) == 0 ? pdTRUE : pdFALSE;
+}
+
+// ==================== NVS ====================
+
+#define NVS_STUB_NAMESPACES     8
+#define NVS_STUB_ENTRIES        64
+#define NVS_STUB_BLOB_MAX       512
+#define NVS_STUB_READONLY       0x100       // 句柄中的只读标志，低8位为命名空间序号+1
+
+typedef struct {
+    bool used;
+    uint8_t ns;
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    uint8_t data[NVS_STUB_BLOB_MAX];
+    size_t len;
+} nvs_stub_entry_t;
+
+struct nvs_opaque_iterator_t {
+    uint8_t ns;
+    int index;
+};
+
+static char s_namespaces[NVS_STUB_NAMESPACES][NVS_KEY_NAME_MAX_SIZE];
+static nvs_stub_entry_t s_entries[NVS_STUB_ENTRIES];
+
+void nvs_stub_erase_all(void)
+{
+    memset(s_namespaces, 0, sizeof(s_namespaces));
+    memset(s_entries, 0, sizeof(s_entries));
+}
+
+static int find_namespace(const char *name)
+{
+    for (int i = 0; i < NVS_STUB_NAMESPACES; i++) {
+        if (s_namespaces[i][0] != '\0' && strcmp(s_namespaces[i], name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static nvs_stub_entry_t *find_entry(uint8_t ns, const char *key)
+{
+    for (int i = 0; i < NVS_STUB_ENTRIES; i++) {
+        if (s_entries[i].used && s_entries[i].ns == ns && strcmp(s_entries[i].key, key) == 0) {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static bool handle_valid(nvs_handle_t handle)
+{
+    uint32_t ns = handle & 0xFF;
+    return ns >= 1 && ns <= NVS_STUB_NAMESPACES && s_namespaces[ns - 1][0] != '\0';
+}
+
+// 与NVS一致：只读打开不存在的命名空间返回 ESP_ERR_NVS_NOT_FOUND，读写打开时创建
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    if (namespace_name == NULL || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (strlen(namespace_name) >= NVS_KEY_NAME_MAX_SIZE) {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+
+    int ns = find_namespace(namespace_name);
+    if (ns < 0) {
+        if (open_mode == NVS_READONLY) {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+        for (int i = 0; i < NVS_STUB_NAMESPACES && ns < 0; i++) {
+            if (s_namespaces[i][0] == '\0') {
+                strcpy(s_namespaces[i], namespace_name);
+                ns = i;
+            }
+        }
+        if (ns < 0) {
+            return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+        }
+    }
+    *out_handle = (nvs_handle_t)(ns + 1) | (open_mode == NVS_READONLY ? NVS_STUB_READONLY : 0);
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    (void)handle;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return handle_valid(handle) ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    if (!handle_valid(handle)) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (handle & NVS_STUB_READONLY) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    if (key == NULL || strlen(key) >= NVS_KEY_NAME_MAX_SIZE) {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+    if (length > NVS_STUB_BLOB_MAX) {
+        return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    }
+
+    uint8_t ns = (uint8_t)((handle & 0xFF) - 1);
+    nvs_stub_entry_t *entry = find_entry(ns, key);
+    for (int i = 0; i < NVS_STUB_ENTRIES && entry == NULL; i++) {
+        if (!s_entries[i].used) {
+            entry = &s_entries[i];
+        }
+    }
+    if (entry == NULL) {
+        return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    }
+    entry->used = true;
+    entry->ns = ns;
+    strcpy(entry->key, key);
+    memcpy(entry->data, value, length);
+    entry->len = length;
+    return ESP_OK;
+}
+
+// 与NVS一致：out_value 为NULL时只返回长度，缓冲区不足返回 ESP_ERR_NVS_INVALID_LENGTH
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    if (!handle_valid(handle)) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (key == NULL || length == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const nvs_stub_entry_t *entry = find_entry((uint8_t)((handle & 0xFF) - 1), key);
+    if (entry == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value == NULL) {
+        *length = entry->len;
+        return ESP_OK;
+    }
+    if (*length < entry->len) {
+        *length = entry->len;
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out_value, entry->data, entry->len);
+    *length = entry->len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    if (!handle_valid(handle)) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (handle & NVS_STUB_READONLY) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    nvs_stub_entry_t *entry = find_entry((uint8_t)((handle & 0xFF) - 1), key);
+    if (entry == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    memset(entry, 0, sizeof(*entry));
+    return ESP_OK;
+}
+
+// 迭代器停在下一条属于该命名空间的记录上，没有时返回false
+static bool iterator_seek(struct nvs_opaque_iterator_t *it)
+{
+    for (; it->index < NVS_STUB_ENTRIES; it->index++) {
+        if (s_entries[it->index].used && s_entries[it->index].ns == it->ns) {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t nvs_entry_find(const char *part_name, const char *namespace_name, nvs_type_t type,
+                         nvs_iterator_t *output_iterator)
+{
+    (void)part_name;
+    if (output_iterator == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *output_iterator = NULL;
+
+    int ns = namespace_name != NULL ? find_namespace(namespace_name) : -1;
+    if (ns < 0 || (type != NVS_TYPE_BLOB && type != NVS_TYPE_ANY)) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
+    struct nvs_opaque_iterator_t *it = calloc(1, sizeof(*it));
+    if (it == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    it->ns = (uint8_t)ns;
+    if (!iterator_seek(it)) {
+        free(it);
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    *output_iterator = it;
+    return ESP_OK;
+}
+
+// 与NVS一致：到末尾时释放迭代器并置NULL
+esp_err_t nvs_entry_next(nvs_iterator_t *iterator)
+{
+    if (iterator == NULL || *iterator == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    (*iterator)->index++;
+    if (!iterator_seek(*iterator)) {
+        free(*iterator);
+        *iterator = NULL;
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_entry_info(const nvs_iterator_t iterator, nvs_entry_info_t *out_info)
+{
+    if (iterator == NULL || out_info == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const nvs_stub_entry_t *entry = &s_entries[iterator->index];
+    memset(out_info, 0, sizeof(*out_info));
+    strcpy(out_info->namespace_name, s_namespaces[entry->ns]);
+    strcpy(out_info->key, entry->key);
+    out_info->type = NVS_TYPE_BLOB;
+    return ESP_OK;
+}
+
+void nvs_release_iterator(nvs_iterator_t iterator)
+{
+    free(iterator);
+}
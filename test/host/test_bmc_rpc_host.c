@@ -0,0 +1,348 @@
+/**
+ * @file test_bmc_rpc_host.c
+ * @brief 主机端RPC库的往返测试
+ *
+ * bmc_rpc_host 通过 socketpair 与线程中的模拟固件通信。模拟固件按 console_rpc.c 的
+ * 规则处理帧：COBS解码、CRC校验、相同seq/消息号/CRC的重发直接重发缓存的响应，
+ * 并可按脚本丢弃响应、插入控制台文本、迟到响应或CRC错误的帧，统计唤醒前导。
+ */
+
+#define _DEFAULT_SOURCE
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "bmc_rpc_host.h"
+#include "test_util.h"
+
+#define ESP_OK                  0
+#define ESP_ERR_NOT_SUPPORTED   0x106
+
+// ==================== 模拟固件 ====================
+
+typedef struct {
+    int fd;
+    pthread_t thread;
+    atomic_int executions[CONSOLE_RPC_MSG_MAX];     // 每个消息号实际执行的次数
+    atomic_int retransmits;                         // 命中缓存的重发次数
+    atomic_int drop_next;                           // 丢弃下一帧响应（模拟线路丢包）
+    atomic_int noise_next;                          // 下一帧响应前先发迟到响应和CRC错误的帧
+    atomic_int extra_delimiters;                    // 帧起始处多余的0x00（唤醒前导）
+    uint8_t fan_speed;
+    bool last_valid;
+    uint8_t last_seq;
+    uint8_t last_msg;
+    uint16_t last_crc;
+    uint8_t last_wire[CONSOLE_RPC_MAX_ENCODED + 2];
+    size_t last_wire_len;
+} fake_device_t;
+
+static void write_all(int fd, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0) {
+            return;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+}
+
+static size_t encode_frame(uint8_t seq, uint8_t msg, int32_t status, const uint8_t *payload, size_t len,
+                           bool bad_crc, uint8_t *wire)
+{
+    uint8_t frame[CONSOLE_RPC_MAX_FRAME];
+    frame[0] = seq;
+    frame[1] = msg | CONSOLE_RPC_RESPONSE_FLAG;
+    memcpy(frame + 2, &status, sizeof(status));
+    memcpy(frame + CONSOLE_RPC_RESP_HEADER_LEN, payload, len);
+    size_t n = CONSOLE_RPC_RESP_HEADER_LEN + len;
+    uint16_t crc = console_rpc_crc16(0xFFFF, frame, n) ^ (bad_crc ? 0x5A5A : 0);
+    frame[n++] = (uint8_t)(crc & 0xFF);
+    frame[n++] = (uint8_t)(crc >> 8);
+
+    size_t out = 0;
+    wire[out++] = CONSOLE_RPC_DELIMITER;
+    out += console_rpc_cobs_encode(frame, n, wire + out);
+    wire[out++] = CONSOLE_RPC_DELIMITER;
+    return out;
+}
+
+static int32_t execute(fake_device_t *dev, uint8_t msg, const uint8_t *req, size_t req_len,
+                       uint8_t *resp, size_t *resp_len)
+{
+    uint32_t duration_ms;
+
+    switch (msg) {
+        case CONSOLE_RPC_MSG_PING:
+            memcpy(resp, req, req_len);
+            *resp_len = req_len;
+            return ESP_OK;
+        case CONSOLE_RPC_MSG_FAN_SET_SPEED:
+            dev->fan_speed = req[0];
+            return ESP_OK;
+        case CONSOLE_RPC_MSG_FAN_GET_SPEED:
+            resp[0] = dev->fan_speed;
+            *resp_len = 1;
+            return ESP_OK;
+        case CONSOLE_RPC_MSG_DEV_RUN_TEST:
+            memcpy(&duration_ms, req + offsetof(console_rpc_dev_test_t, duration_ms), sizeof(duration_ms));
+            usleep(duration_ms * 1000);
+            return ESP_OK;
+        default:
+            return ESP_ERR_NOT_SUPPORTED;
+    }
+}
+
+static void handle_frame(fake_device_t *dev, const uint8_t *encoded, size_t len)
+{
+    uint8_t frame[CONSOLE_RPC_MAX_FRAME];
+    size_t n = console_rpc_cobs_decode(encoded, len, frame, sizeof(frame));
+    if (n < CONSOLE_RPC_REQ_HEADER_LEN + CONSOLE_RPC_CRC_LEN) {
+        return;
+    }
+    uint16_t crc = (uint16_t)(frame[n - 2] | (frame[n - 1] << 8));
+    if (console_rpc_crc16(0xFFFF, frame, n - CONSOLE_RPC_CRC_LEN) != crc) {
+        return;
+    }
+
+    if (dev->last_valid && frame[0] == dev->last_seq && frame[1] == dev->last_msg && crc == dev->last_crc) {
+        dev->retransmits++;
+    } else {
+        uint8_t msg = frame[1];
+        uint8_t payload[CONSOLE_RPC_MAX_PAYLOAD];
+        size_t payload_len = 0;
+        int32_t status = execute(dev, msg, frame + CONSOLE_RPC_REQ_HEADER_LEN,
+                                 n - CONSOLE_RPC_REQ_HEADER_LEN - CONSOLE_RPC_CRC_LEN, payload, &payload_len);
+        dev->executions[msg]++;
+        dev->last_valid = true;
+        dev->last_seq = frame[0];
+        dev->last_msg = msg;
+        dev->last_crc = crc;
+        dev->last_wire_len = encode_frame(frame[0], msg, status, payload, payload_len, false, dev->last_wire);
+
+        if (atomic_exchange(&dev->noise_next, 0)) {
+            uint8_t wire[CONSOLE_RPC_MAX_ENCODED + 2];
+            size_t wire_len = encode_frame((uint8_t)(frame[0] - 1), msg, status, payload, payload_len, false, wire);
+            write_all(dev->fd, wire, wire_len);
+            wire_len = encode_frame(frame[0], msg, -1, NULL, 0, true, wire);
+            write_all(dev->fd, wire, wire_len);
+        }
+    }
+
+    // 日志文本与帧交错，主机应丢弃
+    static const char log_line[] = "I (1234) CONSOLE_RPC: handled\r\n";
+    write_all(dev->fd, log_line, sizeof(log_line) - 1);
+    if (atomic_exchange(&dev->drop_next, 0)) {
+        return;
+    }
+    write_all(dev->fd, dev->last_wire, dev->last_wire_len);
+}
+
+static void *device_task(void *arg)
+{
+    fake_device_t *dev = arg;
+    uint8_t rx[CONSOLE_RPC_MAX_ENCODED];
+    size_t rx_len = 0;
+    bool in_frame = false;
+    uint8_t c;
+
+    while (read(dev->fd, &c, 1) == 1) {
+        if (c == CONSOLE_RPC_DELIMITER) {
+            if (in_frame && rx_len > 0) {
+                handle_frame(dev, rx, rx_len);
+                in_frame = false;
+            } else {
+                if (in_frame) {
+                    dev->extra_delimiters++;
+                }
+                in_frame = true;
+            }
+            rx_len = 0;
+        } else if (in_frame && rx_len < sizeof(rx)) {
+            rx[rx_len++] = c;
+        }
+    }
+    return NULL;
+}
+
+static fake_device_t s_dev;
+static bmc_rpc_host_t s_host;
+
+static void setup(void)
+{
+    int fds[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    memset(&s_dev, 0, sizeof(s_dev));
+    s_dev.fd = fds[1];
+    pthread_create(&s_dev.thread, NULL, device_task, &s_dev);
+    bmc_rpc_host_attach(&s_host, fds[0]);
+}
+
+static void teardown(void)
+{
+    bmc_rpc_host_close(&s_host);
+    pthread_join(s_dev.thread, NULL);
+    close(s_dev.fd);
+}
+
+static int64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// ==================== 测试 ====================
+
+static void test_timeout_table(void)
+{
+    console_rpc_dev_test_t stress = { .test = CONSOLE_RPC_DEV_TEST_STRESS, .duration_ms = 30000 };
+    console_rpc_dev_test_t full = { .test = CONSOLE_RPC_DEV_TEST_FULL };
+    console_rpc_profile_apply_t apply = { .name = "night", .fade_ms = 2000 };
+
+    CHECK_EQ(console_rpc_timeout_ms(CONSOLE_RPC_MSG_FAN_SET_SPEED, NULL, 0), CONSOLE_RPC_TIMEOUT_MS);
+    CHECK_EQ(console_rpc_timeout_ms(CONSOLE_RPC_MSG_ORIN_RECOVERY, NULL, 0), CONSOLE_RPC_SLOW_TIMEOUT_MS);
+    CHECK_EQ(console_rpc_timeout_ms(CONSOLE_RPC_MSG_HW_TEST, NULL, 0), CONSOLE_RPC_TEST_TIMEOUT_MS);
+    CHECK_EQ(console_rpc_timeout_ms(CONSOLE_RPC_MSG_DEV_RUN_TEST, (const uint8_t *)&stress, sizeof(stress)),
+             30000 + CONSOLE_RPC_SLOW_TIMEOUT_MS);
+    CHECK_EQ(console_rpc_timeout_ms(CONSOLE_RPC_MSG_DEV_RUN_TEST, (const uint8_t *)&full, sizeof(full)),
+             CONSOLE_RPC_TEST_TIMEOUT_MS);
+    CHECK_EQ(console_rpc_timeout_ms(CONSOLE_RPC_MSG_PROFILE_APPLY, (const uint8_t *)&apply, sizeof(apply)),
+             2000 + CONSOLE_RPC_SLOW_TIMEOUT_MS);
+
+    stress.duration_ms = UINT32_MAX;
+    CHECK_EQ(console_rpc_timeout_ms(CONSOLE_RPC_MSG_DEV_RUN_TEST, (const uint8_t *)&stress, sizeof(stress)),
+             UINT32_MAX);
+}
+
+static void test_ping_round_trip(void)
+{
+    setup();
+    uint8_t req[CONSOLE_RPC_MAX_PAYLOAD];
+    for (size_t i = 0; i < sizeof(req); i++) {
+        req[i] = (uint8_t)(i * 7);     // 含0x00、'\r'、'\n'
+    }
+    uint8_t resp[CONSOLE_RPC_MAX_PAYLOAD];
+    size_t resp_len = 0;
+    int32_t status = -1;
+
+    for (int i = 0; i < 50; i++) {
+        CHECK_EQ(bmc_rpc_host_call(&s_host, CONSOLE_RPC_MSG_PING, req, sizeof(req), resp, sizeof(resp),
+                                   &resp_len, &status), 0);
+    }
+    CHECK_EQ(status, ESP_OK);
+    CHECK_EQ(resp_len, sizeof(req));
+    CHECK(memcmp(req, resp, sizeof(req)) == 0);
+    CHECK_EQ(s_dev.executions[CONSOLE_RPC_MSG_PING], 50);
+    CHECK_EQ(s_dev.retransmits, 0);
+    teardown();
+}
+
+static void test_lost_response_not_reexecuted(void)
+{
+    setup();
+    uint8_t speed = 42;
+    int32_t status = -1;
+
+    s_dev.drop_next = 1;
+    CHECK_EQ(bmc_rpc_host_call(&s_host, CONSOLE_RPC_MSG_FAN_SET_SPEED, &speed, 1, NULL, 0, NULL, &status), 0);
+    CHECK_EQ(status, ESP_OK);
+    CHECK_EQ(s_dev.executions[CONSOLE_RPC_MSG_FAN_SET_SPEED], 1);
+    CHECK_EQ(s_dev.retransmits, 1);
+    teardown();
+}
+
+static void test_stale_and_corrupt_responses_skipped(void)
+{
+    setup();
+    uint8_t speed = 0;
+    size_t resp_len = 0;
+    int32_t status = -1;
+
+    s_dev.fan_speed = 77;
+    s_dev.noise_next = 1;
+    CHECK_EQ(bmc_rpc_host_call(&s_host, CONSOLE_RPC_MSG_FAN_GET_SPEED, NULL, 0, &speed, 1, &resp_len, &status), 0);
+    CHECK_EQ(status, ESP_OK);
+    CHECK_EQ(resp_len, 1);
+    CHECK_EQ(speed, 77);
+    CHECK_EQ(s_dev.retransmits, 0);
+    teardown();
+}
+
+static void test_long_call_single_attempt(void)
+{
+    setup();
+    console_rpc_dev_test_t req = { .test = CONSOLE_RPC_DEV_TEST_STRESS, .duration_ms = 1500 };
+    int32_t status = -1;
+
+    // 执行时间超过默认超时，只尝试一次也应收到响应
+    s_host.retries = 1;
+    int64_t start = now_ms();
+    CHECK_EQ(bmc_rpc_host_call(&s_host, CONSOLE_RPC_MSG_DEV_RUN_TEST, &req, sizeof(req), NULL, 0, NULL, &status), 0);
+    CHECK(now_ms() - start >= 1500);
+    CHECK_EQ(status, ESP_OK);
+    CHECK_EQ(s_dev.executions[CONSOLE_RPC_MSG_DEV_RUN_TEST], 1);
+    CHECK_EQ(s_dev.retransmits, 0);
+    teardown();
+}
+
+static void test_wake_preamble_after_idle(void)
+{
+    setup();
+    int32_t status;
+
+    // 首个请求前链路空闲，先发唤醒前导（加上请求自身的起始分隔符）
+    CHECK_EQ(bmc_rpc_host_call(&s_host, CONSOLE_RPC_MSG_PING, NULL, 0, NULL, 0, NULL, &status), 0);
+    CHECK_EQ(s_dev.extra_delimiters, CONSOLE_RPC_WAKE_PREAMBLE_LEN);
+
+    CHECK_EQ(bmc_rpc_host_call(&s_host, CONSOLE_RPC_MSG_PING, NULL, 0, NULL, 0, NULL, &status), 0);
+    CHECK_EQ(s_dev.extra_delimiters, CONSOLE_RPC_WAKE_PREAMBLE_LEN);
+
+    s_host.last_tx_ms -= CONSOLE_RPC_WAKE_IDLE_MS + 1;
+    CHECK_EQ(bmc_rpc_host_call(&s_host, CONSOLE_RPC_MSG_PING, NULL, 0, NULL, 0, NULL, &status), 0);
+    CHECK_EQ(s_dev.extra_delimiters, 2 * CONSOLE_RPC_WAKE_PREAMBLE_LEN);
+    CHECK_EQ(s_dev.executions[CONSOLE_RPC_MSG_PING], 3);
+    teardown();
+}
+
+static void test_error_status(void)
+{
+    setup();
+    int32_t status = 0;
+    size_t resp_len = 99;
+
+    CHECK_EQ(bmc_rpc_host_call(&s_host, 0x7E, NULL, 0, NULL, 0, &resp_len, &status), 0);
+    CHECK_EQ(status, ESP_ERR_NOT_SUPPORTED);
+    CHECK_EQ(resp_len, 0);
+    teardown();
+}
+
+static void test_invalid_args(void)
+{
+    bmc_rpc_host_t host;
+    uint8_t big[CONSOLE_RPC_MAX_PAYLOAD + 1] = {0};
+    int32_t status;
+
+    bmc_rpc_host_attach(&host, -1);
+    CHECK_EQ(bmc_rpc_host_call(&host, CONSOLE_RPC_MSG_PING, big, sizeof(big), NULL, 0, NULL, &status), -1);
+    CHECK_EQ(bmc_rpc_host_call(&host, CONSOLE_RPC_MSG_PING, NULL, 1, NULL, 0, NULL, &status), -1);
+    CHECK_EQ(bmc_rpc_host_call(&host, CONSOLE_RPC_MSG_PING, NULL, 0, NULL, 0, NULL, NULL), -1);
+}
+
+int main(void)
+{
+    RUN_TEST(test_timeout_table);
+    RUN_TEST(test_ping_round_trip);
+    RUN_TEST(test_lost_response_not_reexecuted);
+    RUN_TEST(test_stale_and_corrupt_responses_skipped);
+    RUN_TEST(test_long_call_single_attempt);
+    RUN_TEST(test_wake_preamble_after_idle);
+    RUN_TEST(test_error_status);
+    RUN_TEST(test_invalid_args);
+    return test_summary("test_bmc_rpc_host");
+}
@@ -0,0 +1,277 @@
+/**
+ * @file test_board_hal_sim.c
+ * @brief 板级硬件抽象层仿真后端测试：GPIO电平与跳变日志、PWM、灯带和PM锁
+ *
+ * board_hal_sim_clock.c 依赖FreeRTOS任务，这里不链接它，由本文件提供可控的时间源。
+ */
+
+#include <string.h>
+#include "board_hal.h"
+#include "board_hal_sim.h"
+#include "board_hal_time.h"
+#include "test_util.h"
+
+static int64_t s_now_us;
+
+int64_t board_hal_time_get_us(void)
+{
+    return s_now_us;
+}
+
+esp_err_t board_hal_sim_clock_get_stats(board_hal_sim_clock_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->now_us = s_now_us;
+    return ESP_OK;
+}
+
+const char *board_hal_sim_clock_mode_name(board_hal_sim_clock_mode_t mode)
+{
+    return "test";
+}
+
+static board_hal_sim_edge_t last_edge(void)
+{
+    board_hal_sim_edge_t edge = {0};
+    uint32_t count = board_hal_sim_get_edge_count();
+    CHECK(count > 0);
+    CHECK_EQ(board_hal_sim_get_edge(count - 1, &edge), ESP_OK);
+    return edge;
+}
+
+// ==================== GPIO ====================
+
+static void test_gpio_output(void)
+{
+    board_hal_sim_clear_edges();
+    s_now_us = 1000;
+
+    board_hal_gpio_config_t config = {
+        .pin_bit_mask = (1ULL << 4) | (1ULL << 5),
+        .mode = BOARD_HAL_GPIO_MODE_OUTPUT,
+    };
+    CHECK_EQ(board_hal_gpio_config(&config), ESP_OK);
+    CHECK_EQ(board_hal_sim_get_mode(4), BOARD_HAL_GPIO_MODE_OUTPUT);
+    CHECK_EQ(board_hal_gpio_get_level(4), 0);
+    CHECK_EQ(board_hal_sim_get_edge_count(), 0);
+
+    CHECK_EQ(board_hal_gpio_set_level(4, 1), ESP_OK);
+    CHECK_EQ(board_hal_gpio_get_level(4), 1);
+    board_hal_sim_edge_t edge = last_edge();
+    CHECK_EQ(edge.pin, 4);
+    CHECK_EQ(edge.level, 1);
+    CHECK_EQ(edge.time_us, 1000);
+    CHECK(!edge.external);
+
+    // 电平不变不记录跳变
+    CHECK_EQ(board_hal_gpio_set_level(4, 5), ESP_OK);
+    CHECK_EQ(board_hal_sim_get_edge_count(), 1);
+
+    s_now_us = 2000;
+    board_hal_gpio_write_mask(1ULL << 5, 1ULL << 4);
+    CHECK_EQ(board_hal_gpio_get_level(4), 0);
+    CHECK_EQ(board_hal_gpio_get_level(5), 1);
+    CHECK_EQ(board_hal_sim_get_edge_count(), 3);
+    CHECK_EQ(last_edge().time_us, 2000);
+}
+
+static void test_gpio_input(void)
+{
+    board_hal_sim_clear_edges();
+
+    // 未驱动的输入由上下拉决定
+    board_hal_gpio_config_t config = {
+        .pin_bit_mask = 1ULL << 10,
+        .mode = BOARD_HAL_GPIO_MODE_INPUT,
+    };
+    CHECK_EQ(board_hal_gpio_config(&config), ESP_OK);
+    CHECK_EQ(board_hal_gpio_get_level(10), 0);
+    CHECK_EQ(board_hal_gpio_pullup_en(10), ESP_OK);
+    CHECK_EQ(board_hal_gpio_get_level(10), 1);
+    CHECK_EQ(board_hal_sim_get_edge_count(), 1);
+
+    CHECK_EQ(board_hal_sim_set_input(10, 0), ESP_OK);
+    CHECK_EQ(board_hal_gpio_get_level(10), 0);
+    board_hal_sim_edge_t edge = last_edge();
+    CHECK_EQ(edge.level, 0);
+    CHECK(edge.external);
+
+    // 输出寄存器不影响输入引脚；切换为输出后读回输出寄存器
+    CHECK_EQ(board_hal_gpio_set_level(10, 1), ESP_OK);
+    CHECK_EQ(board_hal_gpio_get_level(10), 0);
+    CHECK_EQ(board_hal_gpio_set_direction(10, BOARD_HAL_GPIO_MODE_OUTPUT), ESP_OK);
+    CHECK_EQ(board_hal_gpio_get_level(10), 1);
+
+    // 复位后为禁用，读为0
+    CHECK_EQ(board_hal_gpio_reset_pin(10), ESP_OK);
+    CHECK_EQ(board_hal_sim_get_mode(10), BOARD_HAL_GPIO_MODE_DISABLE);
+    CHECK_EQ(board_hal_gpio_get_level(10), 0);
+}
+
+static void test_gpio_invalid(void)
+{
+    board_hal_gpio_config_t config = {
+        .pin_bit_mask = 1ULL << BOARD_HAL_GPIO_COUNT,
+        .mode = BOARD_HAL_GPIO_MODE_OUTPUT,
+    };
+    CHECK_EQ(board_hal_gpio_config(&config), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(board_hal_gpio_config(NULL), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(board_hal_gpio_set_level(-1, 1), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(board_hal_gpio_set_level(BOARD_HAL_GPIO_COUNT, 1), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(board_hal_sim_set_input(BOARD_HAL_GPIO_COUNT, 1), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(board_hal_gpio_get_level(BOARD_HAL_GPIO_COUNT), 0);
+    CHECK_EQ(board_hal_sim_get_mode(-1), BOARD_HAL_GPIO_MODE_DISABLE);
+}
+
+static void test_edge_log_wraps(void)
+{
+    board_hal_sim_clear_edges();
+    CHECK_EQ(board_hal_gpio_set_direction(20, BOARD_HAL_GPIO_MODE_OUTPUT), ESP_OK);
+
+    uint32_t total = BOARD_HAL_SIM_EDGE_LOG_LEN + 10;
+    for (uint32_t i = 0; i < total; i++) {
+        s_now_us = 10000 + i;
+        CHECK_EQ(board_hal_gpio_set_level(20, (i + 1) & 1), ESP_OK);
+    }
+    CHECK_EQ(board_hal_sim_get_edge_count(), total);
+
+    // 只保留最近 BOARD_HAL_SIM_EDGE_LOG_LEN 条
+    board_hal_sim_edge_t edge;
+    CHECK_EQ(board_hal_sim_get_edge(9, &edge), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(board_hal_sim_get_edge(10, &edge), ESP_OK);
+    CHECK_EQ(edge.time_us, 10010);
+    CHECK_EQ(board_hal_sim_get_edge(total - 1, &edge), ESP_OK);
+    CHECK_EQ(edge.time_us, 10000 + total - 1);
+    CHECK_EQ(board_hal_sim_get_edge(total, &edge), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(board_hal_sim_get_edge(0, NULL), ESP_ERR_INVALID_ARG);
+
+    board_hal_sim_clear_edges();
+    CHECK_EQ(board_hal_sim_get_edge_count(), 0);
+    CHECK_EQ(board_hal_sim_get_edge(0, &edge), ESP_ERR_NOT_FOUND);
+}
+
+// ==================== PWM ====================
+
+static void test_pwm(void)
+{
+    board_hal_sim_pwm_t pwm;
+
+    CHECK_EQ(board_hal_pwm_set_duty(1, 0), ESP_ERR_INVALID_STATE);
+    CHECK_EQ(board_hal_pwm_init(1, 12, 25000, 8), ESP_OK);
+    CHECK_EQ(board_hal_pwm_set_duty(1, 128), ESP_OK);
+    CHECK_EQ(board_hal_pwm_set_duty(1, 255), ESP_OK);
+    CHECK_EQ(board_hal_pwm_set_duty(1, 256), ESP_ERR_INVALID_ARG);
+
+    CHECK_EQ(board_hal_sim_get_pwm(1, &pwm), ESP_OK);
+    CHECK(pwm.configured);
+    CHECK_EQ(pwm.pin, 12);
+    CHECK_EQ(pwm.freq_hz, 25000);
+    CHECK_EQ(pwm.duty, 255);
+    CHECK_EQ(pwm.updates, 2);
+
+    CHECK_EQ(board_hal_pwm_init(BOARD_HAL_PWM_CHANNELS, 12, 25000, 8), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(board_hal_pwm_init(2, 12, 0, 8), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(board_hal_pwm_init(2, 12, 25000, 21), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(board_hal_pwm_init(2, -1, 25000, 8), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(board_hal_pwm_set_duty(BOARD_HAL_PWM_CHANNELS, 0), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(board_hal_sim_get_pwm(BOARD_HAL_PWM_CHANNELS, &pwm), ESP_ERR_INVALID_ARG);
+}
+
+// ==================== 灯带 ====================
+
+static void test_led_strip(void)
+{
+    board_hal_led_strip_t strip = NULL;
+    board_hal_sim_led_frame_t frame;
+
+    CHECK_EQ(board_hal_sim_get_led_frame(38, &frame), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(board_hal_led_strip_new(38, 3, &strip), ESP_OK);
+    CHECK(strip != NULL);
+
+    // set_pixel 只写缓冲区，refresh 才发送
+    CHECK_EQ(board_hal_led_strip_set_pixel(strip, 1, 10, 20, 30), ESP_OK);
+    CHECK_EQ(board_hal_led_strip_set_pixel(strip, 3, 1, 1, 1), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(board_hal_sim_get_led_frame(38, &frame), ESP_OK);
+    CHECK_EQ(frame.refresh_count, 0);
+    CHECK_EQ(frame.rgb[3], 0);
+
+    s_now_us = 50000;
+    CHECK_EQ(board_hal_led_strip_refresh(strip), ESP_OK);
+    CHECK_EQ(board_hal_sim_get_led_frame(38, &frame), ESP_OK);
+    CHECK_EQ(frame.num_leds, 3);
+    CHECK_EQ(frame.refresh_count, 1);
+    CHECK_EQ(frame.last_refresh_us, 50000);
+    CHECK(memcmp(&frame.rgb[3], (const uint8_t[]){ 10, 20, 30 }, 3) == 0);
+
+    // clear 清空并立即发送
+    CHECK_EQ(board_hal_led_strip_clear(strip), ESP_OK);
+    CHECK_EQ(board_hal_sim_get_led_frame(38, &frame), ESP_OK);
+    CHECK_EQ(frame.refresh_count, 2);
+    CHECK_EQ(frame.rgb[4], 0);
+
+    CHECK_EQ(board_hal_led_strip_del(strip), ESP_OK);
+    CHECK_EQ(board_hal_sim_get_led_frame(38, &frame), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(board_hal_led_strip_refresh(strip), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(board_hal_led_strip_new(38, 0, &strip), ESP_ERR_INVALID_ARG);
+}
+
+static void test_led_strip_slots(void)
+{
+    board_hal_led_strip_t strips[BOARD_HAL_SIM_MAX_LED_STRIPS];
+    board_hal_led_strip_t extra;
+
+    for (int i = 0; i < BOARD_HAL_SIM_MAX_LED_STRIPS; i++) {
+        CHECK_EQ(board_hal_led_strip_new(30 + i, 1, &strips[i]), ESP_OK);
+    }
+    CHECK_EQ(board_hal_led_strip_new(40, 1, &extra), ESP_ERR_NO_MEM);
+    CHECK_EQ(board_hal_led_strip_del(strips[0]), ESP_OK);
+    CHECK_EQ(board_hal_led_strip_new(40, 1, &extra), ESP_OK);
+    CHECK_EQ(board_hal_led_strip_del(extra), ESP_OK);
+    for (int i = 1; i < BOARD_HAL_SIM_MAX_LED_STRIPS; i++) {
+        CHECK_EQ(board_hal_led_strip_del(strips[i]), ESP_OK);
+    }
+}
+
+// ==================== PM锁 ====================
+
+static void test_pm_lock(void)
+{
+    board_hal_pm_lock_t a = NULL;
+    board_hal_pm_lock_t b = NULL;
+
+    CHECK_EQ(board_hal_pm_lock_create(BOARD_HAL_PM_NO_LIGHT_SLEEP, "a", &a), ESP_OK);
+    CHECK_EQ(board_hal_pm_lock_create(BOARD_HAL_PM_NO_LIGHT_SLEEP, "b", &b), ESP_OK);
+    CHECK_EQ(board_hal_pm_lock_create(BOARD_HAL_PM_NO_LIGHT_SLEEP + 1, "x", &b), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(board_hal_pm_lock_create(BOARD_HAL_PM_CPU_FREQ_MAX, "x", NULL), ESP_ERR_INVALID_ARG);
+
+    // 锁可重复获取，计数按类型累加
+    board_hal_pm_lock_acquire(a);
+    board_hal_pm_lock_acquire(a);
+    board_hal_pm_lock_acquire(b);
+    CHECK_EQ(board_hal_sim_get_pm_lock_count(BOARD_HAL_PM_NO_LIGHT_SLEEP), 3);
+    CHECK_EQ(board_hal_sim_get_pm_lock_count(BOARD_HAL_PM_CPU_FREQ_MAX), 0);
+
+    board_hal_pm_lock_release(a);
+    board_hal_pm_lock_release(b);
+    board_hal_pm_lock_release(b);       // 多释放一次不影响其他锁
+    CHECK_EQ(board_hal_sim_get_pm_lock_count(BOARD_HAL_PM_NO_LIGHT_SLEEP), 1);
+    board_hal_pm_lock_release(a);
+    CHECK_EQ(board_hal_sim_get_pm_lock_count(BOARD_HAL_PM_NO_LIGHT_SLEEP), 0);
+
+    board_hal_pm_lock_acquire(NULL);
+    board_hal_pm_lock_release(NULL);
+    CHECK_EQ(board_hal_sim_get_pm_lock_count(BOARD_HAL_PM_NO_LIGHT_SLEEP + 1), 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_gpio_output);
+    RUN_TEST(test_gpio_input);
+    RUN_TEST(test_gpio_invalid);
+    RUN_TEST(test_edge_log_wraps);
+    RUN_TEST(test_pwm);
+    RUN_TEST(test_led_strip);
+    RUN_TEST(test_led_strip_slots);
+    RUN_TEST(test_pm_lock);
+    return test_summary("test_board_hal_sim");
+}
@@ -0,0 +1,264 @@
+/**
+ * @file test_console_dispatch.c
+ * @brief 控制台命令分发测试：分词、完美哈希命令表、子命令和参数解析
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "console_dispatch.h"
+#include "test_util.h"
+
+static int s_last_argc;
+static char *s_last_argv1;
+
+static int cmd_record(int argc, char **argv)
+{
+    s_last_argc = argc;
+    s_last_argv1 = argc > 1 ? argv[1] : NULL;
+    return 7;
+}
+
+static int cmd_other(int argc, char **argv)
+{
+    return 0;
+}
+
+// ==================== 分词 ====================
+
+static void test_tokenize(void)
+{
+    char line[] = "  led  set \"a b\"\tc\\ d \"x\"y\\\"z  ";
+    char *argv[CONSOLE_DISPATCH_MAX_ARGS + 1];
+    int argc = -1;
+
+    CHECK_EQ(console_dispatch_tokenize(line, argv, CONSOLE_DISPATCH_MAX_ARGS, &argc), ESP_OK);
+    CHECK_EQ(argc, 5);
+    CHECK(strcmp(argv[0], "led") == 0);
+    CHECK(strcmp(argv[1], "set") == 0);
+    CHECK(strcmp(argv[2], "a b") == 0);
+    CHECK(strcmp(argv[3], "c d") == 0);
+    CHECK(strcmp(argv[4], "xy\"z") == 0);
+    CHECK(argv[5] == NULL);
+}
+
+static void test_tokenize_edge_cases(void)
+{
+    char *argv[CONSOLE_DISPATCH_MAX_ARGS + 1];
+    int argc = -1;
+
+    char empty[] = " \t ";
+    CHECK_EQ(console_dispatch_tokenize(empty, argv, CONSOLE_DISPATCH_MAX_ARGS, &argc), ESP_OK);
+    CHECK_EQ(argc, 0);
+    CHECK(argv[0] == NULL);
+
+    // 空引号是一个空参数，末尾的 `\` 原样保留
+    char quoted[] = "\"\" x\\";
+    CHECK_EQ(console_dispatch_tokenize(quoted, argv, CONSOLE_DISPATCH_MAX_ARGS, &argc), ESP_OK);
+    CHECK_EQ(argc, 2);
+    CHECK(strcmp(argv[0], "") == 0);
+    CHECK(strcmp(argv[1], "x\\") == 0);
+
+    // 参数过多：返回已分出的 max_args 个，argv 仍以NULL结尾
+    char many[] = "a b c d";
+    CHECK_EQ(console_dispatch_tokenize(many, argv, 2, &argc), ESP_ERR_INVALID_SIZE);
+    CHECK_EQ(argc, 2);
+    CHECK(strcmp(argv[1], "b") == 0);
+    CHECK(argv[2] == NULL);
+}
+
+// ==================== 命令表 ====================
+
+static void test_register_and_find(void)
+{
+    static char names[CONSOLE_DISPATCH_MAX_COMMANDS][12];
+
+    CHECK_EQ(console_dispatch_register(NULL, cmd_other), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_register("", cmd_other), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_register("x", NULL), ESP_ERR_INVALID_ARG);
+    CHECK(console_dispatch_find("led") == NULL);
+    CHECK_EQ(console_dispatch_index("led"), -1);
+
+    CHECK_EQ(console_dispatch_register("led", cmd_record), ESP_OK);
+    CHECK_EQ(console_dispatch_register("led", cmd_other), ESP_ERR_INVALID_STATE);
+
+    // 填满命令表，每次注册都重新搜索种子
+    for (int i = 1; i < CONSOLE_DISPATCH_MAX_COMMANDS; i++) {
+        snprintf(names[i], sizeof(names[i]), "cmd%d", i);
+        CHECK_EQ(console_dispatch_register(names[i], cmd_other), ESP_OK);
+    }
+    CHECK_EQ(console_dispatch_get_count(), CONSOLE_DISPATCH_MAX_COMMANDS);
+    CHECK_EQ(console_dispatch_register("extra", cmd_other), ESP_ERR_NO_MEM);
+
+    // 下标按注册顺序，全部能找到
+    CHECK(console_dispatch_find("led") == cmd_record);
+    CHECK_EQ(console_dispatch_index("led"), 0);
+    for (int i = 1; i < CONSOLE_DISPATCH_MAX_COMMANDS; i++) {
+        CHECK_EQ(console_dispatch_index(names[i]), i);
+        CHECK(strcmp(console_dispatch_get_name(i), names[i]) == 0);
+    }
+    CHECK(console_dispatch_get_name(-1) == NULL);
+    CHECK(console_dispatch_get_name(CONSOLE_DISPATCH_MAX_COMMANDS) == NULL);
+    CHECK(console_dispatch_find("cmd") == NULL);
+    CHECK(console_dispatch_find("cmd480") == NULL);
+    CHECK(console_dispatch_find("LED") == NULL);
+    CHECK(console_dispatch_find(NULL) == NULL);
+}
+
+static void test_run_line(void)
+{
+    // 依赖 test_register_and_find 注册的命令
+    int ret = 0;
+    char line[] = "led \"on now\"";
+    CHECK_EQ(console_dispatch_run_line(line, &ret), ESP_OK);
+    CHECK_EQ(ret, 7);
+    CHECK_EQ(s_last_argc, 2);
+    CHECK(s_last_argv1 != NULL && strcmp(s_last_argv1, "on now") == 0);
+
+    char blank[] = "   ";
+    CHECK_EQ(console_dispatch_run_line(blank, &ret), ESP_ERR_INVALID_ARG);
+    char unknown[] = "nope 1";
+    CHECK_EQ(console_dispatch_run_line(unknown, &ret), ESP_ERR_NOT_FOUND);
+
+    char many[CONSOLE_DISPATCH_MAX_ARGS * 2 + 8];
+    size_t out = 0;
+    out += (size_t)snprintf(many, sizeof(many), "led");
+    for (int i = 0; i < CONSOLE_DISPATCH_MAX_ARGS; i++) {
+        out += (size_t)snprintf(many + out, sizeof(many) - out, " x");
+    }
+    CHECK_EQ(console_dispatch_run_line(many, &ret), ESP_ERR_INVALID_SIZE);
+}
+
+// ==================== 子命令 ====================
+
+static void test_subcmd(void)
+{
+    console_subcmd_table_t table = CONSOLE_SUBCMD_TABLE("on", "off", "status", "blink");
+
+    CHECK_EQ(table.count, 4);
+    CHECK_EQ(console_dispatch_subcmd(&table, "on"), -1);     // 未生成索引
+    CHECK_EQ(console_dispatch_subcmd_build(&table), ESP_OK);
+    CHECK_EQ(console_dispatch_subcmd_build(&table), ESP_OK);
+    CHECK_EQ(console_dispatch_subcmd(&table, "on"), 0);
+    CHECK_EQ(console_dispatch_subcmd(&table, "off"), 1);
+    CHECK_EQ(console_dispatch_subcmd(&table, "status"), 2);
+    CHECK_EQ(console_dispatch_subcmd(&table, "blink"), 3);
+    CHECK_EQ(console_dispatch_subcmd(&table, "of"), -1);
+    CHECK_EQ(console_dispatch_subcmd(&table, ""), -1);
+    CHECK_EQ(console_dispatch_subcmd(&table, NULL), -1);
+    CHECK_EQ(console_dispatch_subcmd(NULL, "on"), -1);
+}
+
+static void test_subcmd_invalid(void)
+{
+    console_subcmd_table_t dup = CONSOLE_SUBCMD_TABLE("a", "b", "a");
+    CHECK_EQ(console_dispatch_subcmd_build(&dup), ESP_ERR_INVALID_ARG);
+    CHECK(!dup.built);
+
+    console_subcmd_table_t empty_name = CONSOLE_SUBCMD_TABLE("a", "");
+    CHECK_EQ(console_dispatch_subcmd_build(&empty_name), ESP_ERR_INVALID_ARG);
+
+    console_subcmd_table_t too_many = CONSOLE_SUBCMD_TABLE("1", "2", "3", "4", "5", "6", "7", "8", "9",
+                                                           "10", "11", "12", "13", "14", "15", "16", "17");
+    CHECK_EQ(console_dispatch_subcmd_build(&too_many), ESP_ERR_INVALID_ARG);
+
+    console_subcmd_table_t full = CONSOLE_SUBCMD_TABLE("1", "2", "3", "4", "5", "6", "7", "8", "9",
+                                                       "10", "11", "12", "13", "14", "15", "16");
+    CHECK_EQ(console_dispatch_subcmd_build(&full), ESP_OK);
+    CHECK_EQ(console_dispatch_subcmd(&full, "16"), 15);
+    CHECK_EQ(console_dispatch_subcmd_build(NULL), ESP_ERR_INVALID_ARG);
+}
+
+// ==================== 参数解析 ====================
+
+static void test_arg_u32(void)
+{
+    uint32_t value = 0;
+
+    CHECK_EQ(console_dispatch_arg_u32("42", 0, 100, &value), ESP_OK);
+    CHECK_EQ(value, 42);
+    CHECK_EQ(console_dispatch_arg_u32("0x1F", 0, 100, &value), ESP_OK);
+    CHECK_EQ(value, 31);
+    CHECK_EQ(console_dispatch_arg_u32("0Xff", 0, 255, &value), ESP_OK);
+    CHECK_EQ(value, 255);
+    CHECK_EQ(console_dispatch_arg_u32("4294967295", 0, UINT32_MAX, &value), ESP_OK);
+    CHECK_EQ(value, UINT32_MAX);
+
+    // 超出范围不修改输出
+    value = 5;
+    CHECK_EQ(console_dispatch_arg_u32("4294967296", 0, UINT32_MAX, &value), ESP_ERR_INVALID_SIZE);
+    CHECK_EQ(console_dispatch_arg_u32("99999999999999999999999", 0, UINT32_MAX, &value), ESP_ERR_INVALID_SIZE);
+    CHECK_EQ(console_dispatch_arg_u32("101", 0, 100, &value), ESP_ERR_INVALID_SIZE);
+    CHECK_EQ(console_dispatch_arg_u32("9", 10, 100, &value), ESP_ERR_INVALID_SIZE);
+    CHECK_EQ(value, 5);
+
+    CHECK_EQ(console_dispatch_arg_u32("", 0, 100, &value), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_arg_u32("0x", 0, 100, &value), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_arg_u32("-1", 0, 100, &value), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_arg_u32("+1", 0, 100, &value), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_arg_u32(" 1", 0, 100, &value), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_arg_u32("12a", 0, 100, &value), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_arg_u32("0x1g", 0, 100, &value), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_arg_u32("0x-1", 0, 100, &value), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_arg_u32(NULL, 0, 100, &value), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_arg_u32("1", 0, 100, NULL), ESP_ERR_INVALID_ARG);
+}
+
+static void test_arg_i32(void)
+{
+    int32_t value = 0;
+
+    CHECK_EQ(console_dispatch_arg_i32("-5", -10, 10, &value), ESP_OK);
+    CHECK_EQ(value, -5);
+    CHECK_EQ(console_dispatch_arg_i32("+7", -10, 10, &value), ESP_OK);
+    CHECK_EQ(value, 7);
+    CHECK_EQ(console_dispatch_arg_i32("-2147483648", INT32_MIN, INT32_MAX, &value), ESP_OK);
+    CHECK_EQ(value, INT32_MIN);
+
+    CHECK_EQ(console_dispatch_arg_i32("2147483648", INT32_MIN, INT32_MAX, &value), ESP_ERR_INVALID_SIZE);
+    CHECK_EQ(console_dispatch_arg_i32("-11", -10, 10, &value), ESP_ERR_INVALID_SIZE);
+    CHECK_EQ(console_dispatch_arg_i32("11", -10, 10, &value), ESP_ERR_INVALID_SIZE);
+
+    CHECK_EQ(console_dispatch_arg_i32("-", -10, 10, &value), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_arg_i32("--1", -10, 10, &value), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_arg_i32("1.5", -10, 10, &value), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_arg_i32("0x10", -10, 100, &value), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_arg_i32(" 1", -10, 10, &value), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_dispatch_arg_i32(NULL, -10, 10, &value), ESP_ERR_INVALID_ARG);
+}
+
+static void test_arg_bool(void)
+{
+    const char *on[] = { "on", "1", "true" };
+    const char *off[] = { "off", "0", "false" };
+    const char *invalid[] = { "ON", "yes", "2", "", "of" };
+    bool value;
+
+    for (size_t i = 0; i < sizeof(on) / sizeof(on[0]); i++) {
+        value = false;
+        CHECK_EQ(console_dispatch_arg_bool(on[i], &value), ESP_OK);
+        CHECK(value);
+    }
+    for (size_t i = 0; i < sizeof(off) / sizeof(off[0]); i++) {
+        value = true;
+        CHECK_EQ(console_dispatch_arg_bool(off[i], &value), ESP_OK);
+        CHECK(!value);
+    }
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        CHECK_EQ(console_dispatch_arg_bool(invalid[i], &value), ESP_ERR_INVALID_ARG);
+    }
+    CHECK_EQ(console_dispatch_arg_bool(NULL, &value), ESP_ERR_INVALID_ARG);
+}
+
+int main(void)
+{
+    RUN_TEST(test_tokenize);
+    RUN_TEST(test_tokenize_edge_cases);
+    RUN_TEST(test_register_and_find);
+    RUN_TEST(test_run_line);
+    RUN_TEST(test_subcmd);
+    RUN_TEST(test_subcmd_invalid);
+    RUN_TEST(test_arg_u32);
+    RUN_TEST(test_arg_i32);
+    RUN_TEST(test_arg_bool);
+    return test_summary("test_console_dispatch");
+}
@@ -0,0 +1,133 @@
+/**
+ * @file test_console_rpc_proto.c
+ * @brief RPC帧编解码测试：CRC16与COBS
+ *
+ * 固件和主机端共用 console_rpc_proto.h 中的内联实现，这里覆盖标准测试向量、
+ * 0x00与254字节分块边界、随机数据往返和非法输入。
+ */
+
+#include <string.h>
+#include "console_rpc_proto.h"
+#include "test_util.h"
+
+#define COBS_MAX_ENCODED(len)   ((len) + (len) / 254 + 1)
+
+// 编码后检查：不含0x00、长度不超过上界、解码还原
+static void check_round_trip(const uint8_t *src, size_t len)
+{
+    uint8_t encoded[COBS_MAX_ENCODED(1024)];
+    uint8_t decoded[1024];
+
+    size_t enc_len = console_rpc_cobs_encode(src, len, encoded);
+    CHECK(enc_len <= COBS_MAX_ENCODED(len));
+    CHECK(memchr(encoded, 0, enc_len) == NULL);
+    CHECK_EQ(console_rpc_cobs_decode(encoded, enc_len, decoded, sizeof(decoded)), len);
+    CHECK(memcmp(decoded, src, len) == 0);
+}
+
+static void check_encoding(const uint8_t *src, size_t len, const uint8_t *expected, size_t expected_len)
+{
+    uint8_t encoded[COBS_MAX_ENCODED(512)];
+    size_t enc_len = console_rpc_cobs_encode(src, len, encoded);
+    CHECK_EQ(enc_len, expected_len);
+    CHECK(enc_len == expected_len && memcmp(encoded, expected, enc_len) == 0);
+    check_round_trip(src, len);
+}
+
+// ==================== 测试 ====================
+
+static void test_crc16_check_value(void)
+{
+    // CRC-16/CCITT-FALSE 的标准校验值
+    const uint8_t check[] = "123456789";
+    CHECK_EQ(console_rpc_crc16(0xFFFF, check, 9), 0x29B1);
+    CHECK_EQ(console_rpc_crc16(0xFFFF, NULL, 0), 0xFFFF);
+
+    // 分段计算与一次计算相同
+    uint16_t crc = console_rpc_crc16(0xFFFF, check, 4);
+    CHECK_EQ(console_rpc_crc16(crc, check + 4, 5), 0x29B1);
+}
+
+static void test_cobs_vectors(void)
+{
+    check_encoding((const uint8_t[]){ 0x00 }, 1, (const uint8_t[]){ 0x01, 0x01 }, 2);
+    check_encoding((const uint8_t[]){ 0x00, 0x00 }, 2, (const uint8_t[]){ 0x01, 0x01, 0x01 }, 3);
+    check_encoding((const uint8_t[]){ 0x11, 0x22, 0x00, 0x33 }, 4,
+                   (const uint8_t[]){ 0x03, 0x11, 0x22, 0x02, 0x33 }, 5);
+    check_encoding((const uint8_t[]){ 0x11, 0x22, 0x33, 0x44 }, 4,
+                   (const uint8_t[]){ 0x05, 0x11, 0x22, 0x33, 0x44 }, 5);
+    check_encoding((const uint8_t[]){ 0x11, 0x00, 0x00, 0x00 }, 4,
+                   (const uint8_t[]){ 0x02, 0x11, 0x01, 0x01, 0x01 }, 5);
+}
+
+static void test_cobs_block_boundaries(void)
+{
+    uint8_t src[512];
+    uint8_t expected[520];
+
+    // 254个非零字节正好填满一块
+    for (int i = 0; i < 254; i++) {
+        src[i] = (uint8_t)(i + 1);
+    }
+    check_round_trip(src, 254);
+
+    // 255个非零字节：满块后接一个1字节的块
+    for (int i = 0; i < 255; i++) {
+        src[i] = (uint8_t)(i + 1);
+    }
+    expected[0] = 0xFF;
+    memcpy(&expected[1], src, 254);
+    expected[255] = 0x02;
+    expected[256] = 0xFF;
+    check_encoding(src, 255, expected, 257);
+
+    // 满块后紧跟0x00，以及长串0x00
+    src[254] = 0x00;
+    check_round_trip(src, 255);
+    memset(src, 0, 300);
+    check_round_trip(src, 300);
+
+    // 两个满块之间没有0x00
+    memset(src, 0xAA, 508);
+    check_round_trip(src, 508);
+}
+
+static void test_cobs_random_round_trip(void)
+{
+    uint8_t src[600];
+    uint32_t state = 12345;
+
+    for (size_t len = 0; len <= sizeof(src); len += 7) {
+        for (size_t i = 0; i < len; i++) {
+            state = state * 1103515245u + 12345u;
+            // 约1/8的字节为0x00
+            src[i] = (state >> 16) % 8 == 0 ? 0 : (uint8_t)(state >> 24);
+        }
+        check_round_trip(src, len);
+    }
+}
+
+static void test_cobs_decode_invalid(void)
+{
+    uint8_t out[16];
+
+    // 编码数据中出现0x00
+    CHECK_EQ(console_rpc_cobs_decode((const uint8_t[]){ 0x03, 0x11, 0x00 }, 3, out, sizeof(out)), 0);
+    CHECK_EQ(console_rpc_cobs_decode((const uint8_t[]){ 0x00, 0x11 }, 2, out, sizeof(out)), 0);
+    // 块长度超出数据
+    CHECK_EQ(console_rpc_cobs_decode((const uint8_t[]){ 0x05, 0x11, 0x22 }, 3, out, sizeof(out)), 0);
+    // 输出缓冲区不足
+    CHECK_EQ(console_rpc_cobs_decode((const uint8_t[]){ 0x05, 0x11, 0x22, 0x33, 0x44 }, 5, out, 3), 0);
+    CHECK_EQ(console_rpc_cobs_decode((const uint8_t[]){ 0x03, 0x11, 0x22, 0x02, 0x33 }, 5, out, 2), 0);
+    CHECK_EQ(console_rpc_cobs_decode((const uint8_t[]){ 0x03, 0x11, 0x22, 0x02, 0x33 }, 5, out, 4), 4);
+}
+
+int main(void)
+{
+    RUN_TEST(test_crc16_check_value);
+    RUN_TEST(test_cobs_vectors);
+    RUN_TEST(test_cobs_block_boundaries);
+    RUN_TEST(test_cobs_random_round_trip);
+    RUN_TEST(test_cobs_decode_invalid);
+    return test_summary("test_console_rpc_proto");
+}
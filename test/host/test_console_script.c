@@ -0,0 +1,401 @@
+/**
+ * @file test_console_script.c
+ * @brief 控制台批处理与宏测试：编译、反编译、条件执行、嵌套和NVS载入校验
+ *
+ * 命令由假的执行函数处理：`ok` 返回0，`fail` 返回1，`mrun <宏>` 执行宏，
+ * 其他命令返回 ESP_ERR_NOT_FOUND。NVS是 stubs/stubs.c 中的内存实现。
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "console_script.h"
+#include "esp_rom_crc.h"
+#include "nvs.h"
+#include "test_util.h"
+
+#define MACRO_NAMESPACE     "console_macros"
+
+static char s_trace[256];          // 执行过的命令名，以空格分隔
+static bool s_running_seen;
+
+static esp_err_t fake_exec(int argc, char **argv, int *ret)
+{
+    strncat(s_trace, argv[0], sizeof(s_trace) - strlen(s_trace) - 2);
+    strcat(s_trace, " ");
+    s_running_seen = console_script_running();
+
+    if (strcmp(argv[0], "ok") == 0) {
+        *ret = 0;
+    } else if (strcmp(argv[0], "fail") == 0) {
+        *ret = 1;
+    } else if (strcmp(argv[0], "mrun") == 0 && argc == 2) {
+        console_script_result_t result;
+        esp_err_t err = console_script_macro_run(argv[1], &result);
+        if (err != ESP_OK) {
+            return err;
+        }
+        *ret = result.status;
+    } else {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+// 与 console_script.c 中的 macro_blob_header_t 一致
+typedef struct __attribute__((packed)) {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t steps;
+    uint16_t code_len;
+    uint16_t crc16;
+} blob_header_t;
+
+// 直接写入一条宏记录，crc_delta 非0时写入错误的CRC
+static void put_macro_blob(const char *key, const console_script_program_t *program, uint16_t crc_delta)
+{
+    uint8_t blob[sizeof(blob_header_t) + CONSOLE_SCRIPT_MAX_CODE];
+    blob_header_t header = {
+        .magic = 0x434D,
+        .version = 1,
+        .steps = program->steps,
+        .code_len = program->len,
+        .crc16 = (uint16_t)(esp_rom_crc16_le(0, program->code, program->len) + crc_delta),
+    };
+    memcpy(blob, &header, sizeof(header));
+    memcpy(blob + sizeof(header), program->code, program->len);
+
+    nvs_handle_t handle;
+    CHECK_EQ(nvs_open(MACRO_NAMESPACE, NVS_READWRITE, &handle), ESP_OK);
+    CHECK_EQ(nvs_set_blob(handle, key, blob, sizeof(header) + program->len), ESP_OK);
+    nvs_close(handle);
+}
+
+static bool macro_in_nvs(const char *key)
+{
+    nvs_handle_t handle;
+    size_t length = 0;
+    if (nvs_open(MACRO_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+    esp_err_t ret = nvs_get_blob(handle, key, NULL, &length);
+    nvs_close(handle);
+    return ret == ESP_OK;
+}
+
+// 编译后反编译，结果应为 expected，且再次编译得到相同的程序
+static void check_decompile(const char *text, const char *expected)
+{
+    console_script_program_t program, again;
+    char buf[256];
+
+    CHECK_EQ(console_script_compile(text, &program), ESP_OK);
+    CHECK_EQ(console_script_decompile(&program, buf, sizeof(buf)), ESP_OK);
+    if (strcmp(buf, expected) != 0) {
+        printf("  decompile '%s' -> '%s', expected '%s'\n", text, buf, expected);
+    }
+    CHECK(strcmp(buf, expected) == 0);
+    CHECK_EQ(console_script_compile(buf, &again), ESP_OK);
+    CHECK(again.len == program.len && again.steps == program.steps &&
+          memcmp(again.code, program.code, program.len) == 0);
+}
+
+// ==================== 编译 ====================
+
+static void test_is_batch(void)
+{
+    CHECK(console_script_is_batch("a ; b"));
+    CHECK(console_script_is_batch("a&&b"));
+    CHECK(console_script_is_batch("a || b"));
+    CHECK(!console_script_is_batch("led on"));
+    CHECK(!console_script_is_batch("echo \"a;b && c\""));
+    CHECK(!console_script_is_batch("echo a\\;b"));
+    CHECK(!console_script_is_batch("a & b | c"));
+}
+
+static void test_compile_layout(void)
+{
+    console_script_program_t program;
+    CHECK_EQ(console_script_compile("  led on && power off", &program), ESP_OK);
+    CHECK_EQ(program.steps, 2);
+
+    // 每条命令：操作符、参数个数、以'\0'结尾的参数
+    static const uint8_t expected[] = {
+        CONSOLE_SCRIPT_OP_SEQ, 2, 'l', 'e', 'd', 0, 'o', 'n', 0,
+        CONSOLE_SCRIPT_OP_AND, 2, 'p', 'o', 'w', 'e', 'r', 0, 'o', 'f', 'f', 0,
+    };
+    CHECK_EQ(program.len, sizeof(expected));
+    CHECK(memcmp(program.code, expected, sizeof(expected)) == 0);
+}
+
+static void test_compile_decompile(void)
+{
+    check_decompile("led on&&power off||echo fail", "led on && power off || echo fail");
+    check_decompile(" a ;; b ; ", "a ; b");
+    check_decompile("echo \"a b\" \"\" x\\\"y \"c;d\"", "echo \"a b\" \"\" \"x\\\"y\" \"c;d\"");
+    check_decompile("echo a\\|\\|b", "echo \"a||b\"");
+}
+
+static void test_compile_errors(void)
+{
+    console_script_program_t program;
+
+    CHECK_EQ(console_script_compile("", &program), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_script_compile(" ; ;", &program), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_script_compile("&& a", &program), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_script_compile("a ||", &program), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_script_compile("a && ; b", &program), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_script_compile("echo \"abc", &program), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_script_compile(NULL, &program), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_script_compile("a", NULL), ESP_ERR_INVALID_ARG);
+}
+
+static void test_compile_limits(void)
+{
+    console_script_program_t program;
+    char text[512];
+    size_t out;
+
+    // 命令数
+    out = 0;
+    for (int i = 0; i < CONSOLE_SCRIPT_MAX_STEPS; i++) {
+        out += (size_t)snprintf(text + out, sizeof(text) - out, "%sa", i > 0 ? ";" : "");
+    }
+    CHECK_EQ(console_script_compile(text, &program), ESP_OK);
+    CHECK_EQ(program.steps, CONSOLE_SCRIPT_MAX_STEPS);
+    snprintf(text + out, sizeof(text) - out, ";a");
+    CHECK_EQ(console_script_compile(text, &program), ESP_ERR_INVALID_SIZE);
+
+    // 参数个数
+    out = 0;
+    for (int i = 0; i < CONSOLE_SCRIPT_MAX_ARGS; i++) {
+        out += (size_t)snprintf(text + out, sizeof(text) - out, "x ");
+    }
+    CHECK_EQ(console_script_compile(text, &program), ESP_OK);
+    snprintf(text + out, sizeof(text) - out, "x");
+    CHECK_EQ(console_script_compile(text, &program), ESP_ERR_INVALID_SIZE);
+
+    // 总长度
+    memset(text, 'a', CONSOLE_SCRIPT_MAX_CODE);
+    text[CONSOLE_SCRIPT_MAX_CODE] = '\0';
+    CHECK_EQ(console_script_compile(text, &program), ESP_ERR_INVALID_SIZE);
+    text[CONSOLE_SCRIPT_MAX_CODE - 3] = '\0';       // 2字节命令头 + 参数 + '\0'
+    CHECK_EQ(console_script_compile(text, &program), ESP_OK);
+    CHECK_EQ(program.len, CONSOLE_SCRIPT_MAX_CODE);
+}
+
+static void test_decompile_truncated(void)
+{
+    console_script_program_t program;
+    char buf[8];
+
+    CHECK_EQ(console_script_compile("led on && power off", &program), ESP_OK);
+    memset(buf, 'x', sizeof(buf));
+    CHECK_EQ(console_script_decompile(&program, buf, sizeof(buf)), ESP_ERR_INVALID_SIZE);
+    CHECK(strcmp(buf, "led on ") == 0);
+    CHECK_EQ(console_script_decompile(&program, buf, 0), ESP_ERR_INVALID_ARG);
+}
+
+// ==================== 执行 ====================
+
+static console_script_result_t run_text(const char *text)
+{
+    console_script_program_t program;
+    console_script_result_t result;
+    memset(&result, 0xFF, sizeof(result));
+    s_trace[0] = '\0';
+    CHECK_EQ(console_script_compile(text, &program), ESP_OK);
+    CHECK_EQ(console_script_run(&program, &result), ESP_OK);
+    return result;
+}
+
+static void test_run_before_init(void)
+{
+    console_script_program_t program;
+    int ret = 0;
+    CHECK_EQ(console_script_compile("ok", &program), ESP_OK);
+    CHECK_EQ(console_script_run(&program, NULL), ESP_ERR_INVALID_STATE);
+    CHECK_EQ(console_script_run_line("ok", &ret), ESP_ERR_INVALID_STATE);
+    CHECK_EQ(console_script_macro_define("m", "ok"), ESP_ERR_INVALID_STATE);
+}
+
+static void test_load_validates_nvs(void)
+{
+    console_script_program_t program;
+
+    // 初始化前写入NVS：一条有效记录和几条损坏的记录
+    nvs_stub_erase_all();
+    CHECK_EQ(console_script_compile("ok && fail", &program), ESP_OK);
+    put_macro_blob("good", &program, 0);
+    put_macro_blob("badcrc", &program, 1);
+    put_macro_blob("bad-name", &program, 0);
+
+    console_script_program_t broken = program;
+    broken.code[1] = 0;                             // 参数个数为0
+    put_macro_blob("noargs", &broken, 0);
+    broken = program;
+    broken.steps = 3;                               // 命令数与令牌不符
+    put_macro_blob("steps", &broken, 0);
+    broken = program;
+    broken.code[0] = CONSOLE_SCRIPT_OP_OR + 1;      // 未知操作符
+    put_macro_blob("badop", &broken, 0);
+    broken = program;
+    broken.len--;                                   // 最后一个参数没有'\0'
+    put_macro_blob("noterm", &broken, 0);
+
+    CHECK_EQ(console_script_init(NULL), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_script_init(fake_exec), ESP_OK);
+
+    console_script_macro_info_t info;
+    CHECK_EQ(console_script_macro_get_info("good", &info), ESP_OK);
+    CHECK_EQ(info.steps, 2);
+    CHECK_EQ(info.code_len, program.len);
+    CHECK_EQ(console_script_macro_get_info("badcrc", &info), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(console_script_macro_get_info("bad-name", &info), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(console_script_macro_get_info("noargs", &info), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(console_script_macro_get_info("steps", &info), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(console_script_macro_get_info("badop", &info), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(console_script_macro_get_info("noterm", &info), ESP_ERR_NOT_FOUND);
+
+    console_script_result_t result;
+    s_trace[0] = '\0';
+    CHECK_EQ(console_script_macro_run("good", &result), ESP_OK);
+    CHECK_EQ(result.status, 1);
+    CHECK(strcmp(s_trace, "ok fail ") == 0);
+}
+
+static void test_conditional_run(void)
+{
+    console_script_result_t result;
+
+    result = run_text("fail && ok || ok");
+    CHECK(strcmp(s_trace, "fail ok ") == 0);
+    CHECK_EQ(result.steps, 3);
+    CHECK_EQ(result.executed, 2);
+    CHECK_EQ(result.skipped, 1);
+    CHECK_EQ(result.status, 0);
+
+    // 跳过的命令不改变结果
+    result = run_text("ok && fail && ok || fail ; ok");
+    CHECK(strcmp(s_trace, "ok fail fail ok ") == 0);
+    CHECK_EQ(result.skipped, 1);
+    CHECK_EQ(result.status, 0);
+
+    result = run_text("ok || fail || fail");
+    CHECK(strcmp(s_trace, "ok ") == 0);
+    CHECK_EQ(result.skipped, 2);
+
+    // 未知命令记为1
+    result = run_text("nope && ok");
+    CHECK_EQ(result.executed, 1);
+    CHECK_EQ(result.status, 1);
+    CHECK(!console_script_running());
+}
+
+static void test_run_line(void)
+{
+    int ret = -1;
+    CHECK_EQ(console_script_run_line("ok ; fail", &ret), ESP_OK);
+    CHECK_EQ(ret, 1);
+    CHECK(s_running_seen);
+
+    // 语法错误只提示，返回值为1
+    ret = 0;
+    CHECK_EQ(console_script_run_line("ok &&", &ret), ESP_OK);
+    CHECK_EQ(ret, 1);
+}
+
+// ==================== 宏 ====================
+
+static void test_macro_define_run_delete(void)
+{
+    console_script_macro_info_t info;
+    console_script_result_t result;
+
+    CHECK_EQ(console_script_macro_define("a b", "ok"), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_script_macro_define("", "ok"), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_script_macro_define("name_too_long_16", "ok"), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(console_script_macro_define("m1", "ok &&"), ESP_ERR_INVALID_ARG);
+    CHECK(!macro_in_nvs("m1"));
+
+    CHECK_EQ(console_script_macro_define("m1", "ok ; fail"), ESP_OK);
+    CHECK(macro_in_nvs("m1"));
+    CHECK_EQ(console_script_macro_run("m1", &result), ESP_OK);
+    CHECK_EQ(console_script_macro_run("m1", &result), ESP_OK);
+    CHECK_EQ(result.status, 1);
+    CHECK_EQ(console_script_macro_get_info("m1", &info), ESP_OK);
+    CHECK_EQ(info.runs, 2);
+    CHECK_EQ(info.failures, 2);
+    CHECK(info.total_us >= info.max_us);
+
+    // 重新定义时统计清零
+    CHECK_EQ(console_script_macro_define("m1", "ok"), ESP_OK);
+    CHECK_EQ(console_script_macro_get_info("m1", &info), ESP_OK);
+    CHECK_EQ(info.runs, 0);
+    CHECK_EQ(info.steps, 1);
+
+    CHECK_EQ(console_script_macro_delete("m1"), ESP_OK);
+    CHECK(!macro_in_nvs("m1"));
+    CHECK_EQ(console_script_macro_delete("m1"), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(console_script_macro_run("m1", &result), ESP_ERR_NOT_FOUND);
+}
+
+static void test_macro_nesting(void)
+{
+    console_script_result_t result;
+
+    CHECK_EQ(console_script_macro_define("inner", "ok"), ESP_OK);
+    CHECK_EQ(console_script_macro_define("outer", "mrun inner && ok"), ESP_OK);
+    s_trace[0] = '\0';
+    CHECK_EQ(console_script_macro_run("outer", &result), ESP_OK);
+    CHECK(strcmp(s_trace, "mrun ok ok ") == 0);
+    CHECK_EQ(result.status, 0);
+
+    // 自身递归在达到最大深度时失败，不会无限嵌套
+    CHECK_EQ(console_script_macro_define("loop", "mrun loop"), ESP_OK);
+    s_trace[0] = '\0';
+    CHECK_EQ(console_script_macro_run("loop", &result), ESP_OK);
+    CHECK_EQ(result.status, 1);
+    int calls = 0;
+    for (const char *p = s_trace; (p = strstr(p, "mrun")) != NULL; p++) {
+        calls++;
+    }
+    CHECK_EQ(calls, CONSOLE_SCRIPT_MAX_DEPTH);
+    CHECK(!console_script_running());
+}
+
+static void test_macro_table_full(void)
+{
+    char name[8];
+    int defined = 0;
+
+    // 已有 good、inner、outer、loop
+    for (int i = 0; i < CONSOLE_SCRIPT_MAX_MACROS; i++) {
+        snprintf(name, sizeof(name), "f%d", i);
+        if (console_script_macro_define(name, "ok") == ESP_OK) {
+            defined++;
+        }
+    }
+    CHECK_EQ(defined, CONSOLE_SCRIPT_MAX_MACROS - 4);
+    CHECK_EQ(console_script_macro_define("extra", "ok"), ESP_ERR_NO_MEM);
+    CHECK(!macro_in_nvs("extra"));
+    // 替换已有的宏不需要新槽
+    CHECK_EQ(console_script_macro_define("f0", "fail"), ESP_OK);
+}
+
+int main(void)
+{
+    RUN_TEST(test_is_batch);
+    RUN_TEST(test_compile_layout);
+    RUN_TEST(test_compile_decompile);
+    RUN_TEST(test_compile_errors);
+    RUN_TEST(test_compile_limits);
+    RUN_TEST(test_decompile_truncated);
+    RUN_TEST(test_run_before_init);
+    RUN_TEST(test_load_validates_nvs);
+    RUN_TEST(test_conditional_run);
+    RUN_TEST(test_run_line);
+    RUN_TEST(test_macro_define_run_delete);
+    RUN_TEST(test_macro_nesting);
+    RUN_TEST(test_macro_table_full);
+    return test_summary("test_console_script");
+}
@@ -0,0 +1,55 @@
+/**
+ * @file test_util.h
+ * @brief 主机单元测试的断言与计数
+ */
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <stdio.h>
+
+static int s_test_checks;
+static int s_test_failures;
+
+/**
+ * @brief 检查条件，失败时打印位置并计数，不中止
+ */
+#define CHECK(cond) do { \
+    s_test_checks++; \
+    if (!(cond)) { \
+        s_test_failures++; \
+        printf("%s:%d: FAIL: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+/**
+ * @brief 检查两个整数相等，失败时打印两边的值
+ */
+#define CHECK_EQ(a, b) do { \
+    long long _a = (long long)(a), _b = (long long)(b); \
+    s_test_checks++; \
+    if (_a != _b) { \
+        s_test_failures++; \
+        printf("%s:%d: FAIL: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+    } \
+} while (0)
+
+/**
+ * @brief 运行一个测试函数
+ */
+#define RUN_TEST(fn) do { \
+    int _before = s_test_failures; \
+    fn(); \
+    printf("%-40s %s\n", #fn, s_test_failures == _before ? "ok" : "FAIL"); \
+} while (0)
+
+/**
+ * @brief 打印汇总，返回进程退出码
+ */
+static inline int test_summary(const char *name)
+{
+    printf("%s: %d checks, %d failures\n", name, s_test_checks, s_test_failures);
+    return s_test_failures == 0 ? 0 : 1;
+}
+
+#endif /* TEST_UTIL_H */
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+解析控制台 `bench` 的机器可读输出，比较两次固件构建的基准测试结果。
+
+用法:
+    idf.py monitor | tee new.log        # 在控制台执行 bench all
+    python3 tools/bench_compare.py new.log                   # 显示单次结果
+    python3 tools/bench_compare.py old.log new.log           # 比较，回退时退出码为1
+    python3 tools/bench_compare.py old.log new.log --threshold 5 --json diff.json
+
+输入可以是完整的串口日志，只解析 BENCH BEGIN 与 BENCH END 之间的行；
+同一用例出现多次时使用最后一次结果。
+"""
+
+import argparse
+import json
+import re
+import sys
+
+ANSI_RE = re.compile(r"\x1b\[[0-9;]*m")
+
+RESULT_FIELDS = ["name", "mode", "status", "ops", "elapsed_us", "ops_per_sec", "mean_ns",
+                 "p50_ns", "p99_ns", "max_ns", "cycles_per_op", "cpu_mhz"]
+TEXT_FIELDS = {"name", "mode", "status"}
+
+# 比较的指标及方向: True 表示越大越好
+METRICS = [("ops_per_sec", True), ("mean_ns", False), ("p99_ns", False), ("cycles_per_op", False)]
+
+
+def parse_log(lines):
+    """返回 (build, {name: result})，build 为最后一次 BENCH BEGIN 的构建信息。"""
+    build = None
+    results = {}
+    in_block = False
+    for raw in lines:
+        line = ANSI_RE.sub("", raw).strip()
+        idx = line.find("BENCH ")
+        if idx < 0:
+            continue
+        fields = line[idx:].split()
+        kind = fields[1] if len(fields) > 1 else ""
+        if kind == "BEGIN" and len(fields) >= 7:
+            build = {"version": int(fields[2]), "firmware": fields[3], "elf_sha256": fields[4],
+                     "idf": fields[5], "cpu_mhz": int(fields[6])}
+            in_block = True
+        elif kind == "RESULT" and in_block and len(fields) >= 2 + len(RESULT_FIELDS):
+            result = {}
+            for key, value in zip(RESULT_FIELDS, fields[2:]):
+                result[key] = value if key in TEXT_FIELDS else int(value)
+            results[result["name"]] = result
+        elif kind == "END":
+            in_block = False
+    if build is None:
+        raise ValueError("no BENCH BEGIN found in input")
+    return build, results
+
+
+def read_log(path):
+    with open(path, encoding="utf-8", errors="replace") as f:
+        return parse_log(f)
+
+
+def change_percent(old, new):
+    if old == 0:
+        return 0.0
+    return (new - old) * 100.0 / old
+
+
+def compare(old_results, new_results, threshold):
+    """返回 [(name, metric, old, new, change%, regressed)]。"""
+    rows = []
+    for name in sorted(set(old_results) & set(new_results)):
+        old, new = old_results[name], new_results[name]
+        for metric, higher_better in METRICS:
+            change = change_percent(old[metric], new[metric])
+            worse = -change if higher_better else change
+            rows.append((name, metric, old[metric], new[metric], change, worse > threshold))
+    return rows
+
+
+def print_results(build, results):
+    print("firmware %s  elf %s  idf %s  %d MHz" % (build["firmware"], build["elf_sha256"],
+                                                  build["idf"], build["cpu_mhz"]))
+    print("%-16s %10s %10s %10s %10s %10s" % ("name", "ops/s", "mean_ns", "p99_ns", "max_ns", "cycles/op"))
+    for name in sorted(results):
+        r = results[name]
+        status = "" if r["status"] == "ESP_OK" else "  (%s)" % r["status"]
+        print("%-16s %10d %10d %10d %10d %10d%s" % (name, r["ops_per_sec"], r["mean_ns"], r["p99_ns"],
+                                                   r["max_ns"], r["cycles_per_op"], status))
+
+
+def print_comparison(old_build, new_build, rows, old_results, new_results):
+    print("old: %s (%s)" % (old_build["firmware"], old_build["elf_sha256"]))
+    print("new: %s (%s)" % (new_build["firmware"], new_build["elf_sha256"]))
+    if old_build["cpu_mhz"] != new_build["cpu_mhz"]:
+        print("warning: CPU frequency differs (%d vs %d MHz)" % (old_build["cpu_mhz"], new_build["cpu_mhz"]))
+    print("%-16s %-14s %12s %12s %9s" % ("name", "metric", "old", "new", "change"))
+    for name, metric, old, new, change, regressed in rows:
+        print("%-16s %-14s %12d %12d %+8.1f%%%s" % (name, metric, old, new, change,
+                                                    "  REGRESSION" if regressed else ""))
+    for name in sorted(set(old_results) - set(new_results)):
+        print("%-16s only in old" % name)
+    for name in sorted(set(new_results) - set(old_results)):
+        print("%-16s only in new" % name)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare ESP32S3 benchmark results between firmware builds")
+    parser.add_argument("old", help="serial log containing 'bench' output (baseline, or the only log)")
+    parser.add_argument("new", nargs="?", help="serial log to compare against the baseline")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="percent change counted as a regression (default: 10)")
+    parser.add_argument("--json", help="write parsed results and comparison to a JSON file")
+    args = parser.parse_args()
+
+    old_build, old_results = read_log(args.old)
+    if args.new is None:
+        print_results(old_build, old_results)
+        if args.json:
+            with open(args.json, "w", encoding="utf-8") as f:
+                json.dump({"build": old_build, "results": old_results}, f, indent=1)
+        return 0
+
+    new_build, new_results = read_log(args.new)
+    rows = compare(old_results, new_results, args.threshold)
+    print_comparison(old_build, new_build, rows, old_results, new_results)
+
+    if args.json:
+        with open(args.json, "w", encoding="utf-8") as f:
+            json.dump({"old": {"build": old_build, "results": old_results},
+                       "new": {"build": new_build, "results": new_results},
+                       "threshold": args.threshold,
+                       "changes": [{"name": r[0], "metric": r[1], "old": r[2], "new": r[3],
+                                    "change_percent": round(r[4], 2), "regression": r[5]} for r in rows]},
+                      f, indent=1)
+
+    regressions = sum(1 for r in rows if r[5])
+    if regressions:
+        print("%d regression(s) above %.1f%%" % (regressions, args.threshold), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
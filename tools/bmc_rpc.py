@@ -0,0 +1,736 @@
+#!/usr/bin/env python3
+"""
+控制台二进制RPC的主机端库与命令行工具（协议见 components/console_interface/include/console_rpc_proto.h）。
+
+用法:
+    python3 tools/bmc_rpc.py --port /dev/ttyUSB0 version
+    python3 tools/bmc_rpc.py --port /dev/ttyUSB0 call fan_set_speed 30
+    python3 tools/bmc_rpc.py --port /dev/ttyUSB0 call hw_get_status
+    python3 tools/bmc_rpc.py --port /dev/ttyUSB0 baud --save
+    python3 tools/bmc_rpc.py --sim build/rm01-esp32s3-bsp.elf loopback
+
+作为库使用:
+    from bmc_rpc import BmcRpc
+    with BmcRpc.open_serial("/dev/ttyUSB0") as bmc:
+        bmc.orin_reset()
+        print(bmc.hw_get_status())
+
+二进制帧与文本shell共用串口：0x00分隔的字节是帧，其余字节是控制台文本输出，
+收到后保存在 BmcRpc.text 中。不依赖pyserial，串口用termios配置为原始模式。
+--sim 在伪终端(PTY)上启动Linux仿真固件，loopback 对每类消息做一次往返检查。
+baud 依次协商更高的波特率并测量每个速率下的实际吞吐，最后停在最快且无错误的速率。
+"""
+
+import argparse
+import collections
+import os
+import pty
+import random
+import select
+import struct
+import subprocess
+import sys
+import termios
+import time
+import tty
+
+PROTO_VERSION = 2
+MAX_PAYLOAD = 128
+RESPONSE_FLAG = 0x80
+DELIMITER = 0
+NAME_LEN = 16
+
+ESP_OK = 0
+ESP_ERR_NAMES = {
+    -1: "ESP_FAIL", 0x101: "ESP_ERR_NO_MEM", 0x102: "ESP_ERR_INVALID_ARG",
+    0x103: "ESP_ERR_INVALID_STATE", 0x104: "ESP_ERR_INVALID_SIZE", 0x105: "ESP_ERR_NOT_FOUND",
+    0x106: "ESP_ERR_NOT_SUPPORTED", 0x107: "ESP_ERR_TIMEOUT",
+}
+STATUS_BUSY = 0x107     # 资源被后台任务占用，稍后重试
+
+# hw_txn_field_t
+HW_TXN_FAN = 1 << 0
+HW_TXN_BOARD_COLOR = 1 << 1
+HW_TXN_BOARD_BRIGHTNESS = 1 << 2
+HW_TXN_TOUCH_COLOR = 1 << 3
+HW_TXN_TOUCH_BRIGHTNESS = 1 << 4
+HW_TXN_USB_MUX = 1 << 5
+HW_TXN_GPIO = 1 << 6
+
+SETTINGS_FMT = "9B"
+HW_STATUS_FMT = "B" + SETTINGS_FMT + "3B"
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE"""
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_idx = 0
+    code = 1
+    for b in data:
+        if b == 0:
+            out[code_idx] = code
+            code_idx = len(out)
+            out.append(0)
+            code = 1
+        else:
+            out.append(b)
+            code += 1
+            if code == 0xFF:
+                out[code_idx] = code
+                code_idx = len(out)
+                out.append(0)
+                code = 1
+    out[code_idx] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        i += 1
+        if code == 0 or i + code - 1 > len(data):
+            raise ValueError("invalid COBS data")
+        out += data[i:i + code - 1]
+        i += code - 1
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def err_name(status):
+    return ESP_ERR_NAMES.get(status, "0x%x" % status)
+
+
+class RpcError(Exception):
+    def __init__(self, msg, status):
+        super().__init__("%s failed: %s" % (msg, err_name(status)))
+        self.status = status
+
+
+class RpcTimeout(Exception):
+    pass
+
+
+# ==================== 负载编解码 ====================
+
+def _name(name):
+    raw = name.encode("ascii")
+    if len(raw) >= NAME_LEN:
+        raise ValueError("profile name too long")
+    return raw.ljust(NAME_LEN, b"\0")
+
+
+def _settings(values):
+    return {"fan_speed": values[0], "board_led_color": tuple(values[1:4]),
+            "board_led_brightness": values[4], "touch_led_color": tuple(values[5:8]),
+            "touch_led_brightness": values[8]}
+
+
+def _pack_settings(s):
+    return struct.pack("<" + SETTINGS_FMT, s["fan_speed"], *s["board_led_color"], s["board_led_brightness"],
+                       *s["touch_led_color"], s["touch_led_brightness"])
+
+
+def _hw_status(values):
+    return {"initialized": bool(values[0]), **_settings(values[1:10]),
+            "usb_mux_target": values[10], "orin_power_state": values[11], "n305_power_state": values[12]}
+
+
+def _u8(data):
+    return data[0]
+
+
+def _u32(data):
+    return struct.unpack("<I", data)[0]
+
+
+def _version(data):
+    proto, max_payload, iface, text = struct.unpack("<HHI32s", data)
+    return {"proto_version": proto, "max_payload": max_payload, "interface_version": iface,
+            "version": text.split(b"\0", 1)[0].decode("ascii", "replace")}
+
+
+RPC_STATS_FIELDS = ["frames_rx", "frames_tx", "retransmits", "crc_errors", "framing_errors",
+                    "unknown_msgs", "bad_length", "dispatch_last_us", "dispatch_max_us", "busy", "jobs"]
+
+
+def _rpc_stats(data):
+    return dict(zip(RPC_STATS_FIELDS, struct.unpack("<11I", data)))
+
+
+# console_job_state_t
+JOB_STATES = ["queued", "running", "done", "failed", "cancelled"]
+
+
+def _job(data):
+    job_id, state, result, queued_ms, run_ms = struct.unpack("<IBiII", data)
+    return {"id": job_id, "state": JOB_STATES[state] if state < len(JOB_STATES) else state,
+            "result": result, "queued_ms": queued_ms, "run_ms": run_ms}
+
+
+def _job_ref(data):
+    """提交为后台任务的消息返回任务号，直接执行完成的返回None"""
+    return _u32(data) if len(data) == 4 else None
+
+
+def _dev_status(data):
+    v = struct.unpack("<IBB" + HW_STATUS_FMT + "IIIQ", data)
+    return {"interface_version": v[0], "hardware_available": bool(v[1]), "monitor_available": bool(v[2]),
+            "hardware": _hw_status(v[3:16]), "cpu_freq_mhz": v[16], "free_heap": v[17],
+            "min_free_heap": v[18], "uptime_ms": v[19]}
+
+
+def _profile_result(data):
+    return dict(zip(["first_commit_us", "total_us", "steps"], struct.unpack("<III", data)))
+
+
+def _profile(data):
+    v = struct.unpack("<16s" + SETTINGS_FMT, data)
+    return {"name": v[0].split(b"\0", 1)[0].decode("ascii", "replace"), "settings": _settings(v[1:])}
+
+
+AUTOSAVE_FIELDS = ["enabled", "pending", "quiet_ms", "change_events", "commits", "unchanged_skips",
+                   "writes_avoided", "failures", "bytes_written", "last_commit_us"]
+
+
+def _autosave_stats(data):
+    return dict(zip(AUTOSAVE_FIELDS, struct.unpack("<BB7Iq", data)))
+
+
+# console_baud_state_t
+BAUD_STATE_STABLE = 0
+BAUD_STATE_PENDING = 1
+BAUD_STATE_CONFIRMING = 2
+BAUD_RATES = [115200, 230400, 460800, 921600, 1500000, 2000000]
+BAUD_FIELDS = ["current", "previous", "saved", "state", "switches", "confirms", "fallbacks"]
+
+
+def _baud_status(data):
+    return dict(zip(BAUD_FIELDS, struct.unpack("<IIIB3I", data)))
+
+
+# 名称 -> (消息号, 请求打包函数, 响应解析函数)
+MESSAGES = {
+    "ping": (0x00, lambda data=b"": data.encode() if isinstance(data, str) else bytes(data), bytes),
+    "get_version": (0x01, None, _version),
+    "get_rpc_stats": (0x02, None, _rpc_stats),
+    "baud_set": (0x03, lambda baud, confirm_ms=0, persist=False:
+                 struct.pack("<IHB", baud, confirm_ms, 1 if persist else 0), None),
+    "baud_get": (0x04, None, _baud_status),
+    "job_get": (0x05, lambda job_id: struct.pack("<I", job_id), _job),
+
+    "fan_set_speed": (0x10, lambda speed: struct.pack("<B", speed), None),
+    "fan_get_speed": (0x11, None, _u8),
+    "fan_start": (0x12, None, None),
+    "fan_stop": (0x13, None, None),
+    "board_led_set_color": (0x14, lambda r, g, b: struct.pack("<3B", r, g, b), None),
+    "board_led_set_brightness": (0x15, lambda brightness: struct.pack("<B", brightness), None),
+    "board_led_set_effect": (0x16, lambda effect: struct.pack("<B", effect), None),
+    "board_led_off": (0x17, None, None),
+    "board_led_get_brightness": (0x18, None, _u8),
+    "touch_led_set_color": (0x19, lambda r, g, b: struct.pack("<3B", r, g, b), None),
+    "touch_led_set_brightness": (0x1A, lambda brightness: struct.pack("<B", brightness), None),
+    "touch_led_off": (0x1B, None, None),
+    "touch_led_get_brightness": (0x1C, None, _u8),
+    "board_led_get_color": (0x1D, None, lambda d: struct.unpack("<3B", d)),
+    "touch_led_get_color": (0x1E, None, lambda d: struct.unpack("<3B", d)),
+
+    "gpio_set_output": (0x20, lambda pin, level: struct.pack("<BB", pin, level), None),
+    "gpio_read_input": (0x21, lambda pin: struct.pack("<B", pin), _u8),
+    "gpio_read_input_mode": (0x22, lambda pin: struct.pack("<B", pin), _u8),
+    "gpio_toggle": (0x23, lambda pin: struct.pack("<B", pin), None),
+    "usb_mux_set": (0x24, lambda target: struct.pack("<B", target), None),
+    "usb_mux_get": (0x25, None, _u8),
+
+    "orin_power_on": (0x30, None, None),
+    "orin_power_off": (0x31, None, None),
+    "orin_reset": (0x32, None, None),
+    "orin_recovery": (0x33, None, _job_ref),
+    "n305_power_toggle": (0x34, None, None),
+    "n305_reset": (0x35, None, None),
+    "orin_get_power_state": (0x36, None, _u8),
+    "n305_get_power_state": (0x37, None, _u8),
+
+    "hw_test": (0x40, lambda test, pin=0: struct.pack("<BB", test, pin), _job_ref),
+    "hw_get_status": (0x41, None, lambda d: _hw_status(struct.unpack("<" + HW_STATUS_FMT, d))),
+    "hw_get_settings": (0x42, None, lambda d: _settings(struct.unpack("<" + SETTINGS_FMT, d))),
+    "hw_apply_settings": (0x43, _pack_settings, None),
+    "hw_txn_commit": (0x44, lambda fields, settings, usb_mux_target=0, gpio_high_mask=0, gpio_low_mask=0:
+                      struct.pack("<I", fields) + _pack_settings(settings) +
+                      struct.pack("<BQQ", usb_mux_target, gpio_high_mask, gpio_low_mask), None),
+
+    "dev_quick_setup": (0x50, lambda fan, board, touch: struct.pack("<7B", fan, *board, *touch), None),
+    "dev_shutdown_all": (0x51, None, None),
+    "dev_reset_default": (0x52, None, None),
+    "dev_sleep": (0x53, None, None),
+    "dev_wake": (0x54, None, None),
+    "dev_get_status": (0x55, None, _dev_status),
+    "dev_run_test": (0x56, lambda test, duration_ms=0: struct.pack("<BI", test, duration_ms), _job_ref),
+    "dev_save_config": (0x57, None, None),
+    "dev_load_config": (0x58, None, None),
+    "dev_clear_config": (0x59, None, None),
+    "dev_config_benchmark": (0x5A, lambda iterations=0: struct.pack("<I", iterations), None),
+
+    "profile_save": (0x60, _name, None),
+    "profile_delete": (0x61, _name, None),
+    "profile_apply": (0x62, lambda name, fade_ms=0: _name(name) + struct.pack("<I", fade_ms), _profile_result),
+    "profile_get_count": (0x63, None, _u32),
+    "profile_get": (0x64, lambda index: struct.pack("<I", index), _profile),
+
+    "autosave_enable": (0x70, lambda enable: struct.pack("<B", 1 if enable else 0), None),
+    "autosave_set_quiet": (0x71, lambda quiet_ms: struct.pack("<I", quiet_ms), None),
+    "autosave_flush": (0x72, None, None),
+    "autosave_get_stats": (0x73, None, _autosave_stats),
+}
+
+# 响应超时 (s)，与 console_rpc_proto.h 的 console_rpc_timeout_ms() 一致
+TIMEOUT = 1.0
+SLOW_TIMEOUT = 10.0     # 电源时序、NVS写入
+TEST_TIMEOUT = 60.0     # 硬件自检、配置基准测试
+SLOW_MESSAGES = {0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x51, 0x52, 0x53, 0x54, 0x57, 0x58, 0x59,
+                 0x60, 0x61, 0x72}
+DEV_TEST_STRESS = 2
+
+# 唤醒前导：链路空闲后先发几个0x00唤醒浅睡眠中的固件（触发唤醒的字节丢失）
+WAKE_IDLE = 1.0
+WAKE_PREAMBLE = bytes(4)
+WAKE_DELAY = 0.005
+
+
+def timeout_for(msg_id, payload=b""):
+    """消息的响应超时：处理函数的最长执行时间加余量"""
+    if msg_id in (0x40, 0x5A):
+        return TEST_TIMEOUT
+    if msg_id == 0x56:
+        if len(payload) == 5 and payload[0] == DEV_TEST_STRESS:
+            return struct.unpack("<I", payload[1:5])[0] / 1000.0 + SLOW_TIMEOUT
+        return TEST_TIMEOUT
+    if msg_id == 0x62:
+        fade_ms = struct.unpack("<I", payload[NAME_LEN:NAME_LEN + 4])[0] if len(payload) == NAME_LEN + 4 else 0
+        return fade_ms / 1000.0 + SLOW_TIMEOUT
+    if msg_id in SLOW_MESSAGES:
+        return SLOW_TIMEOUT
+    return TIMEOUT
+
+
+# ==================== 传输 ====================
+
+class BmcRpc:
+    def __init__(self, fd, timeout=TIMEOUT, retries=3, proc=None):
+        self.fd = fd
+        self.timeout = timeout
+        self.retries = retries
+        self.proc = proc
+        self.text = bytearray()         # 帧之外收到的控制台文本
+        self._seq = random.randrange(256)
+        self._last_tx = 0.0
+        self._rx = bytearray()
+        self._in_frame = False
+        self._frames = collections.deque()
+
+    @classmethod
+    def open_serial(cls, path, baud=115200, **kwargs):
+        fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+        termios.tcflush(fd, termios.TCIOFLUSH)
+        return cls(fd, **kwargs)
+
+    @classmethod
+    def spawn_sim(cls, elf, boot_timeout=10.0, **kwargs):
+        """在PTY上启动Linux仿真固件，等到控制台可用后返回"""
+        master, slave = pty.openpty()
+        tty.setraw(slave)
+        proc = subprocess.Popen([elf], stdin=slave, stdout=slave, stderr=subprocess.DEVNULL,
+                                close_fds=True)
+        os.close(slave)
+        rpc = cls(master, proc=proc, **kwargs)
+        deadline = time.monotonic() + boot_timeout
+        while time.monotonic() < deadline:
+            try:
+                rpc.call("ping", timeout=0.5, retries=1)
+                return rpc
+            except RpcTimeout:
+                continue
+        rpc.close()
+        raise RpcTimeout("simulator did not answer within %.1f s" % boot_timeout)
+
+    def close(self):
+        if self.proc is not None:
+            self.proc.terminate()
+            try:
+                self.proc.wait(timeout=2)
+            except subprocess.TimeoutExpired:
+                self.proc.kill()
+            self.proc = None
+        if self.fd is not None:
+            os.close(self.fd)
+            self.fd = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def send_raw(self, data):
+        if time.monotonic() - self._last_tx > WAKE_IDLE:
+            os.write(self.fd, WAKE_PREAMBLE)
+            time.sleep(WAKE_DELAY)
+        os.write(self.fd, data)
+        self._last_tx = time.monotonic()
+
+    def _feed(self, chunk):
+        for b in chunk:
+            if b == DELIMITER:
+                if self._in_frame and self._rx:
+                    self._frames.append(bytes(self._rx))
+                    self._rx.clear()
+                    self._in_frame = False
+                else:
+                    # 连续的0x00视为同一个帧起始分隔符
+                    self._in_frame = True
+            elif self._in_frame:
+                self._rx.append(b)
+            else:
+                self.text.append(b)
+
+    def _next_frame(self, deadline):
+        """返回下一个完整帧（COBS编码，不含分隔符），超时返回None"""
+        while not self._frames:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return None
+            ready, _, _ = select.select([self.fd], [], [], remaining)
+            if not ready:
+                return None
+            try:
+                chunk = os.read(self.fd, 4096)
+            except OSError:
+                return None
+            if not chunk:
+                return None
+            self._feed(chunk)
+        return self._frames.popleft()
+
+    def call_raw(self, msg_id, payload=b"", timeout=None, retries=None):
+        """发送请求，返回 (status, 响应负载)。超时按同一seq重发，固件不会重复执行。
+
+        未指定 timeout 时取 self.timeout 与 timeout_for() 的较大值，长耗时消息
+        不会在执行期间被判为超时。
+        """
+        if len(payload) > MAX_PAYLOAD:
+            raise ValueError("payload too large")
+        self._seq = (self._seq + 1) & 0xFF
+        seq = self._seq
+        body = bytes([seq, msg_id]) + payload
+        frame = body + struct.pack("<H", crc16(body))
+        wire = bytes([DELIMITER]) + cobs_encode(frame) + bytes([DELIMITER])
+
+        timeout = max(self.timeout, timeout_for(msg_id, payload)) if timeout is None else timeout
+        retries = self.retries if retries is None else retries
+        for _ in range(max(1, retries)):
+            self.send_raw(wire)
+            deadline = time.monotonic() + timeout
+            while True:
+                encoded = self._next_frame(deadline)
+                if encoded is None:
+                    break
+                try:
+                    resp = cobs_decode(encoded)
+                except ValueError:
+                    continue
+                if len(resp) < 8 or crc16(resp[:-2]) != struct.unpack("<H", resp[-2:])[0]:
+                    continue
+                if resp[0] != seq or resp[1] != (msg_id | RESPONSE_FLAG):
+                    continue    # 之前超时请求的迟到响应
+                status = struct.unpack("<i", resp[2:6])[0]
+                return status, resp[6:-2]
+        raise RpcTimeout("no response to message 0x%02x" % msg_id)
+
+    def call(self, name, *args, timeout=None, retries=None, **kwargs):
+        msg_id, pack, parse = MESSAGES[name]
+        payload = pack(*args, **kwargs) if pack else b""
+        status, data = self.call_raw(msg_id, payload, timeout=timeout, retries=retries)
+        if status != ESP_OK:
+            raise RpcError(name, status)
+        return parse(data) if parse else None
+
+    def wait_job(self, job_id, timeout=120.0, poll=0.2):
+        """轮询后台任务直到结束，返回 job_get 的结果；超时抛出 RpcTimeout"""
+        deadline = time.monotonic() + timeout
+        while True:
+            job = self.job_get(job_id)
+            if job["state"] not in ("queued", "running"):
+                return job
+            if time.monotonic() > deadline:
+                raise RpcTimeout("job %d still %s" % (job_id, job["state"]))
+            time.sleep(poll)
+
+    def __getattr__(self, name):
+        if name in MESSAGES:
+            return lambda *args, **kwargs: self.call(name, *args, **kwargs)
+        raise AttributeError(name)
+
+    # ==================== 波特率协商 ====================
+
+    def _set_host_baud(self, baud):
+        if not os.isatty(self.fd) or self.proc is not None:
+            return      # 仿真PTY没有物理波特率
+        attrs = termios.tcgetattr(self.fd)
+        attrs[4] = attrs[5] = getattr(termios, "B%d" % baud)
+        termios.tcsetattr(self.fd, termios.TCSADRAIN, attrs)
+        termios.tcflush(self.fd, termios.TCIFLUSH)
+
+    def set_baud(self, baud, confirm_ms=2000, persist=False):
+        """切换到新波特率：当前速率下请求，双方切换后在新速率下用 baud_get 确认。
+
+        确认失败时等固件确认期超时恢复原速率，主机同样恢复后抛出 RpcTimeout。
+        """
+        old = self.baud_get()["current"]
+        self.baud_set(baud, confirm_ms, persist)
+        if os.isatty(self.fd):
+            termios.tcdrain(self.fd)
+        time.sleep(0.05)    # 等固件发完响应并切换
+        self._set_host_baud(baud)
+        self._rx.clear()
+        self._in_frame = False
+        self._frames.clear()
+        deadline = time.monotonic() + confirm_ms / 1000.0 * 0.8
+        while time.monotonic() < deadline:
+            try:
+                status = self.call("baud_get", timeout=0.2, retries=1)
+            except RpcTimeout:
+                continue
+            if status["current"] == baud and status["state"] == BAUD_STATE_STABLE:
+                return status
+        time.sleep(confirm_ms / 1000.0 * 0.3)
+        self._set_host_baud(old)
+        raise RpcTimeout("peer did not confirm %d baud, fell back to %d" % (baud, old))
+
+    def measure_throughput(self, duration=1.0, size=MAX_PAYLOAD):
+        """用满负载ping测量往返吞吐，返回每个方向的负载字节/秒"""
+        payload = bytes(random.randrange(1, 256) for _ in range(size))
+        count = 0
+        start = time.perf_counter()
+        while time.perf_counter() - start < duration:
+            if self.ping(payload) != payload:
+                raise RpcError("ping", -1)
+            count += 1
+        return count * size / (time.perf_counter() - start)
+
+
+# ==================== PTY回环检查 ====================
+
+def loopback(bmc):
+    """对仿真固件逐类消息做往返检查，返回失败数"""
+    failures = 0
+
+    def check(label, cond, detail=""):
+        nonlocal failures
+        print("%-32s %s %s" % (label, "ok" if cond else "FAIL", detail))
+        if not cond:
+            failures += 1
+
+    start = time.perf_counter()
+    n = 200
+    for i in range(n):
+        assert bmc.ping(bytes([i & 0xFF, 0, 0x0D, 0x0A])) == bytes([i & 0xFF, 0, 0x0D, 0x0A])
+    rtt_us = (time.perf_counter() - start) / n * 1e6
+    check("ping x%d (0x00/CR/LF in payload)" % n, True, "%.0f us/round trip" % rtt_us)
+
+    version = bmc.get_version()
+    check("get_version", version["proto_version"] == PROTO_VERSION, version["version"])
+
+    bmc.fan_set_speed(37)
+    check("fan_set_speed/get_speed", bmc.fan_get_speed() == 37)
+    bmc.board_led_set_color(1, 2, 3)
+    bmc.board_led_set_brightness(40)
+    check("board_led brightness", bmc.board_led_get_brightness() == 40)
+    check("board_led color", bmc.board_led_get_color() == (1, 2, 3))
+    bmc.touch_led_set_color(4, 5, 6)
+    check("touch_led color", bmc.touch_led_get_color() == (4, 5, 6))
+    bmc.touch_led_set_brightness(20)
+    check("touch_led brightness", bmc.touch_led_get_brightness() == 20)
+
+    settings = {"fan_speed": 60, "board_led_color": (10, 20, 30), "board_led_brightness": 55,
+                "touch_led_color": (0, 0, 255), "touch_led_brightness": 15}
+    bmc.hw_apply_settings(settings)
+    check("hw_apply_settings/get_settings", bmc.hw_get_settings() == settings)
+
+    bmc.hw_txn_commit(HW_TXN_FAN | HW_TXN_USB_MUX, dict(settings, fan_speed=25), usb_mux_target=1)
+    check("hw_txn_commit", bmc.fan_get_speed() == 25 and bmc.usb_mux_get() == 1)
+    bmc.usb_mux_set(0)
+
+    status = bmc.dev_get_status()
+    check("dev_get_status", status["hardware_available"] and status["hardware"]["fan_speed"] == 25,
+          "uptime %d ms" % status["uptime_ms"])
+
+    bmc.profile_save("rpc_test")
+    count = bmc.profile_get_count()
+    names = [bmc.profile_get(i)["name"] for i in range(count)]
+    check("profile_save/get", "rpc_test" in names)
+    result = bmc.profile_apply("rpc_test", 0)
+    check("profile_apply", result["steps"] == 1, "%d us" % result["total_us"])
+    bmc.profile_delete("rpc_test")
+
+    try:
+        bmc.profile_apply("no_such_profile")
+        check("error status", False)
+    except RpcError as e:
+        check("error status", e.status == 0x105, err_name(e.status))
+
+    status, _ = bmc.call_raw(0x7E)
+    check("unknown message", status == 0x106, err_name(status))
+
+    # CRC错误的帧不响应；文本命令仍可用
+    before = bmc.get_rpc_stats()
+    text_before = len(bmc.text)
+    body = bytes([0x42, 0x00, 1, 2, 3])
+    bmc.send_raw(b"\0" + cobs_encode(body + b"\xde\xad") + b"\0")
+    bmc.send_raw(b"rpc\n")
+    time.sleep(0.3)
+    after = bmc.get_rpc_stats()
+    check("crc error dropped", after["crc_errors"] == before["crc_errors"] + 1)
+    check("text shell on same port", len(bmc.text) > text_before)
+
+    # 相同seq与内容的请求只执行一次
+    bmc._seq = (bmc._seq - 1) & 0xFF
+    bmc.get_rpc_stats()
+    check("retransmit served from cache", bmc.get_rpc_stats()["retransmits"] == after["retransmits"] + 1)
+
+    # 长耗时消息作为后台任务执行，执行期间占用相同资源的消息返回忙
+    job_id = bmc.orin_recovery()
+    time.sleep(0.2)
+    try:
+        bmc.orin_power_on()
+        check("busy while job holds orin", False)
+    except RpcError as e:
+        check("busy while job holds orin", e.status == STATUS_BUSY, err_name(e.status))
+    check("fan not blocked by orin job", bmc.fan_get_speed() == 25)
+    job = bmc.wait_job(job_id)
+    check("orin_recovery job", job_id is not None and job["state"] == "done", "%d ms" % job["run_ms"])
+
+    stats = bmc.get_rpc_stats()
+    check("dispatch time", True, "last %d us, max %d us" % (stats["dispatch_last_us"], stats["dispatch_max_us"]))
+
+    # 波特率：确认后生效；不确认则超时恢复
+    status = bmc.set_baud(921600, confirm_ms=1000)
+    check("baud switch confirmed", status["current"] == 921600 and status["confirms"] >= 1)
+    fallbacks = status["fallbacks"]
+    bmc.baud_set(460800, 300)
+    time.sleep(0.6)
+    status = bmc.baud_get()
+    check("baud fallback without confirm", status["current"] == 921600 and status["fallbacks"] == fallbacks + 1)
+    try:
+        bmc.baud_set(12345)
+        check("unsupported baud rejected", False)
+    except RpcError as e:
+        check("unsupported baud rejected", e.status == 0x106, err_name(e.status))
+    bmc.set_baud(BAUD_RATES[0], confirm_ms=1000)
+    return failures
+
+
+def negotiate(bmc, rates, confirm_ms, duration, save):
+    """逐个切换到候选波特率并测吞吐，停在最快且往返无错误的速率"""
+    best = None
+    for baud in rates:
+        try:
+            bmc.set_baud(baud, confirm_ms=confirm_ms)
+            rate = bmc.measure_throughput(duration)
+        except (RpcError, RpcTimeout) as e:
+            print("%8d  failed: %s" % (baud, e))
+            break
+        print("%8d  %8.0f B/s  (%.0f%% of %d B/s)" % (baud, rate, rate * 100.0 / (baud / 10), baud // 10))
+        if best is None or rate > best[1]:
+            best = (baud, rate)
+    if best is None:
+        return None
+    bmc.set_baud(best[0], confirm_ms=confirm_ms, persist=save)
+    print("selected %d baud%s" % (best[0], " (saved)" if save else ""))
+    return best[0]
+
+
+# ==================== 命令行 ====================
+
+def parse_value(text):
+    if text.lower() in ("true", "false"):
+        return text.lower() == "true"
+    try:
+        return int(text, 0)
+    except ValueError:
+        return text
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Binary RPC client for the ESP32S3 BMC console")
+    target = parser.add_mutually_exclusive_group(required=True)
+    target.add_argument("--port", help="serial device of the console UART")
+    target.add_argument("--sim", help="Linux simulator ELF, run on a PTY")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baud rate")
+    parser.add_argument("--timeout", type=float, default=1.0, help="minimum response timeout per attempt (s)")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    sub.add_parser("version", help="show protocol and firmware version")
+    sub.add_parser("stats", help="show RPC statistics")
+    sub.add_parser("list", help="list available messages")
+    call = sub.add_parser("call", help="call one message: call <name> [args...]")
+    call.add_argument("name")
+    call.add_argument("args", nargs="*")
+    sub.add_parser("loopback", help="round-trip every message class and report")
+    baud = sub.add_parser("baud", help="negotiate the fastest working baud rate")
+    baud.add_argument("--rates", type=lambda t: [int(r) for r in t.split(",")], default=BAUD_RATES[1:],
+                      help="comma separated candidate rates, ascending")
+    baud.add_argument("--confirm-ms", type=int, default=2000, help="firmware confirmation window (ms)")
+    baud.add_argument("--duration", type=float, default=1.0, help="throughput test per rate (s)")
+    baud.add_argument("--save", action="store_true", help="persist the selected rate in NVS")
+    args = parser.parse_args()
+
+    if args.cmd == "list":
+        for name, (msg_id, _, _) in MESSAGES.items():
+            print("0x%02x %s" % (msg_id, name))
+        return 0
+
+    if args.port:
+        bmc = BmcRpc.open_serial(args.port, args.baud, timeout=args.timeout)
+    else:
+        bmc = BmcRpc.spawn_sim(args.sim, timeout=args.timeout)
+
+    with bmc:
+        try:
+            if args.cmd == "version":
+                print(bmc.get_version())
+            elif args.cmd == "stats":
+                print(bmc.get_rpc_stats())
+            elif args.cmd == "call":
+                if args.name not in MESSAGES:
+                    print("unknown message: %s" % args.name, file=sys.stderr)
+                    return 2
+                result = bmc.call(args.name, *[parse_value(a) for a in args.args])
+                print("ok" if result is None else result)
+            elif args.cmd == "loopback":
+                failures = loopback(bmc)
+                print("%d failure(s)" % failures)
+                return 1 if failures else 0
+            elif args.cmd == "baud":
+                return 0 if negotiate(bmc, args.rates, args.confirm_ms, args.duration, args.save) else 1
+        except (RpcError, RpcTimeout) as e:
+            print(e, file=sys.stderr)
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,229 @@
+/**
+ * @file bmc_rpc_host.c
+ * @brief 控制台二进制RPC的主机端C库实现
+ */
+
+#define _DEFAULT_SOURCE     // cfmakeraw, usleep
+#include "bmc_rpc_host.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+static int64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static speed_t baud_to_speed(int baud)
+{
+    switch (baud) {
+        case 9600:      return B9600;
+        case 57600:     return B57600;
+        case 115200:    return B115200;
+        case 230400:    return B230400;
+#ifdef B460800
+        case 460800:    return B460800;
+#endif
+#ifdef B921600
+        case 921600:    return B921600;
+#endif
+        default:        return 0;
+    }
+}
+
+void bmc_rpc_host_attach(bmc_rpc_host_t *host, int fd)
+{
+    memset(host, 0, sizeof(*host));
+    host->fd = fd;
+    host->seq = (uint8_t)(now_ms() ^ getpid());  // 避免与上次运行的最后一个请求同号
+    host->timeout_ms = BMC_RPC_HOST_DEFAULT_TIMEOUT_MS;
+    host->retries = BMC_RPC_HOST_DEFAULT_RETRIES;
+}
+
+int bmc_rpc_host_open(bmc_rpc_host_t *host, const char *path, int baud)
+{
+    speed_t speed = baud_to_speed(baud);
+    if (host == NULL || path == NULL || speed == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    tio.c_cflag |= CLOCAL | CREAD;
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+
+    bmc_rpc_host_attach(host, fd);
+    return 0;
+}
+
+void bmc_rpc_host_close(bmc_rpc_host_t *host)
+{
+    if (host != NULL && host->fd >= 0) {
+        close(host->fd);
+        host->fd = -1;
+    }
+}
+
+static int write_all(int fd, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// 读取到一个完整帧（COBS编码）时返回其长度，超时返回0
+static size_t read_frame(bmc_rpc_host_t *host, int64_t deadline, uint8_t *frame)
+{
+    for (;;) {
+        int64_t remaining = deadline - now_ms();
+        if (remaining <= 0) {
+            return 0;
+        }
+        struct pollfd pfd = { .fd = host->fd, .events = POLLIN };
+        if (poll(&pfd, 1, remaining > INT32_MAX ? INT32_MAX : (int)remaining) <= 0) {
+            return 0;
+        }
+
+        // 逐字节读取，帧之后的字节留给下一次调用
+        uint8_t c;
+        ssize_t n = read(host->fd, &c, 1);
+        if (n <= 0) {
+            return 0;
+        }
+        if (c == CONSOLE_RPC_DELIMITER) {
+            if (host->in_frame && host->rx_len > 0) {
+                size_t len = host->rx_len;
+                memcpy(frame, host->rx, len);
+                host->rx_len = 0;
+                host->in_frame = 0;
+                return len;
+            }
+            host->in_frame = 1;
+            host->rx_len = 0;
+        } else if (host->in_frame) {
+            if (host->rx_len < sizeof(host->rx)) {
+                host->rx[host->rx_len++] = c;
+            } else {
+                host->in_frame = 0;
+            }
+        }
+    }
+}
+
+// 空闲后先发唤醒前导，浅睡眠中的固件丢失的是前导而不是请求
+static int send_request(bmc_rpc_host_t *host, const uint8_t *wire, size_t len)
+{
+    if (now_ms() - host->last_tx_ms > CONSOLE_RPC_WAKE_IDLE_MS) {
+        static const uint8_t preamble[CONSOLE_RPC_WAKE_PREAMBLE_LEN] = {0};
+        if (write_all(host->fd, preamble, sizeof(preamble)) != 0) {
+            return -1;
+        }
+        usleep(CONSOLE_RPC_WAKE_DELAY_MS * 1000);
+    }
+    if (write_all(host->fd, wire, len) != 0) {
+        return -1;
+    }
+    host->last_tx_ms = now_ms();
+    return 0;
+}
+
+int bmc_rpc_host_call(bmc_rpc_host_t *host, uint8_t msg, const void *req, size_t req_len,
+                      void *resp, size_t resp_size, size_t *resp_len, int32_t *status)
+{
+    if (host == NULL || status == NULL || req_len > CONSOLE_RPC_MAX_PAYLOAD || (req == NULL && req_len > 0)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    uint8_t seq = ++host->seq;
+    uint8_t frame[CONSOLE_RPC_MAX_FRAME];
+    frame[0] = seq;
+    frame[1] = msg;
+    if (req_len > 0) {
+        memcpy(frame + CONSOLE_RPC_REQ_HEADER_LEN, req, req_len);
+    }
+    size_t len = CONSOLE_RPC_REQ_HEADER_LEN + req_len;
+    uint16_t crc = console_rpc_crc16(0xFFFF, frame, len);
+    frame[len++] = (uint8_t)(crc & 0xFF);
+    frame[len++] = (uint8_t)(crc >> 8);
+
+    uint8_t wire[CONSOLE_RPC_MAX_ENCODED + 2];
+    size_t wire_len = 0;
+    wire[wire_len++] = CONSOLE_RPC_DELIMITER;
+    wire_len += console_rpc_cobs_encode(frame, len, wire + wire_len);
+    wire[wire_len++] = CONSOLE_RPC_DELIMITER;
+
+    // 长耗时消息按处理函数的执行时间放宽，重发只在处理函数确实超时后才发生
+    uint32_t timeout_ms = console_rpc_timeout_ms(msg, req, req_len);
+    if (timeout_ms < host->timeout_ms) {
+        timeout_ms = host->timeout_ms;
+    }
+
+    uint8_t encoded[CONSOLE_RPC_MAX_ENCODED];
+    uint8_t decoded[CONSOLE_RPC_MAX_FRAME];
+    for (uint32_t attempt = 0; attempt < (host->retries ? host->retries : 1); attempt++) {
+        if (send_request(host, wire, wire_len) != 0) {
+            return -1;
+        }
+        int64_t deadline = now_ms() + timeout_ms;
+        size_t enc_len;
+        while ((enc_len = read_frame(host, deadline, encoded)) > 0) {
+            size_t n = console_rpc_cobs_decode(encoded, enc_len, decoded, sizeof(decoded));
+            if (n < CONSOLE_RPC_RESP_HEADER_LEN + CONSOLE_RPC_CRC_LEN) {
+                continue;
+            }
+            uint16_t rx_crc = (uint16_t)(decoded[n - 2] | (decoded[n - 1] << 8));
+            if (console_rpc_crc16(0xFFFF, decoded, n - CONSOLE_RPC_CRC_LEN) != rx_crc) {
+                continue;
+            }
+            if (decoded[0] != seq || decoded[1] != (msg | CONSOLE_RPC_RESPONSE_FLAG)) {
+                continue;   // 之前超时请求的迟到响应
+            }
+
+            memcpy(status, decoded + 2, sizeof(*status));
+            size_t payload_len = n - CONSOLE_RPC_RESP_HEADER_LEN - CONSOLE_RPC_CRC_LEN;
+            if (resp != NULL) {
+                memcpy(resp, decoded + CONSOLE_RPC_RESP_HEADER_LEN, payload_len < resp_size ? payload_len : resp_size);
+            }
+            if (resp_len != NULL) {
+                *resp_len = payload_len;
+            }
+            return 0;
+        }
+    }
+
+    errno = ETIMEDOUT;
+    return -1;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file bmc_rpc_host.h
+ * @brief 控制台二进制RPC的主机端C库（Linux/macOS）
+ *
+ * 负载类型与消息号直接使用固件的 console_rpc_proto.h：
+ *
+ *     gcc -I components/console_interface/include tools/bmc_rpc_host.c my_tool.c
+ *
+ *     bmc_rpc_host_t bmc;
+ *     bmc_rpc_host_open(&bmc, "/dev/ttyUSB0", 115200);
+ *     console_rpc_hw_status_t status;
+ *     int32_t err;
+ *     bmc_rpc_host_call(&bmc, CONSOLE_RPC_MSG_HW_GET_STATUS, NULL, 0, &status, sizeof(status), NULL, &err);
+ *
+ * 帧之外收到的控制台文本被丢弃。超时后以相同seq重发，固件不会重复执行。
+ * 每次尝试的超时取 timeout_ms 与 console_rpc_timeout_ms() 的较大值，
+ * 电源时序、自检、渐变等长耗时消息不会在执行期间被判为超时。
+ * 链路空闲超过 CONSOLE_RPC_WAKE_IDLE_MS 后先发送唤醒前导，固件可能处于浅睡眠。
+ */
+
+#ifndef BMC_RPC_HOST_H
+#define BMC_RPC_HOST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "console_rpc_proto.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BMC_RPC_HOST_DEFAULT_TIMEOUT_MS CONSOLE_RPC_TIMEOUT_MS /*!< 每次尝试的默认超时 (ms) */
+#define BMC_RPC_HOST_DEFAULT_RETRIES    3       /*!< 默认尝试次数 */
+
+/**
+ * @brief 连接句柄
+ */
+typedef struct {
+    int fd;                                     /*!< 串口或PTY文件描述符 */
+    uint8_t seq;                                /*!< 上一个请求的序号 */
+    uint32_t timeout_ms;                        /*!< 每次尝试的最短超时 (ms) */
+    uint32_t retries;                           /*!< 尝试次数 */
+    int64_t last_tx_ms;                         /*!< 上一次发送的时间，判断是否需要唤醒前导 */
+    uint8_t rx[CONSOLE_RPC_MAX_ENCODED];        /*!< 接收中的帧 */
+    size_t rx_len;                              /*!< 已接收长度 */
+    int in_frame;                               /*!< 是否在帧内 */
+} bmc_rpc_host_t;
+
+/**
+ * @brief 打开串口（原始模式）
+ *
+ * @param host 句柄
+ * @param path 串口设备
+ * @param baud 波特率
+ * @return 0成功，-1失败（errno）
+ */
+int bmc_rpc_host_open(bmc_rpc_host_t *host, const char *path, int baud);
+
+/**
+ * @brief 使用已打开的文件描述符（如PTY主端）
+ *
+ * @param host 句柄
+ * @param fd 文件描述符，由调用者配置为原始模式
+ */
+void bmc_rpc_host_attach(bmc_rpc_host_t *host, int fd);
+
+/**
+ * @brief 关闭连接
+ *
+ * @param host 句柄
+ */
+void bmc_rpc_host_close(bmc_rpc_host_t *host);
+
+/**
+ * @brief 发送请求并等待响应
+ *
+ * @param host 句柄
+ * @param msg 消息号 (console_rpc_msg_t)
+ * @param req 请求负载，可为NULL
+ * @param req_len 请求负载长度
+ * @param resp 响应负载缓冲区，可为NULL
+ * @param resp_size 响应负载缓冲区大小
+ * @param resp_len 返回响应负载长度，可为NULL
+ * @param status 返回固件的错误码 (esp_err_t)
+ * @return 0收到响应（结果见status），-1参数无效或超时
+ */
+int bmc_rpc_host_call(bmc_rpc_host_t *host, uint8_t msg, const void *req, size_t req_len,
+                      void *resp, size_t resp_size, size_t *resp_len, int32_t *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BMC_RPC_HOST_H */
@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+"""
+解码控制台 `trace dump` 的输出，生成 Chrome trace JSON。
+
+用法:
+    idf.py monitor | tee trace.log      # 在控制台执行 trace dump
+    python3 tools/trace_decode.py trace.log -o trace.json
+
+生成的文件可在 chrome://tracing 或 https://ui.perfetto.dev 中打开。
+输入可以是完整的串口日志，只解析 TRACE BEGIN 与 TRACE END 之间的行，
+若日志中有多次导出则使用最后一次。
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+RECORD_SIZE = 12
+PHASE_MASK = 0xC000
+CODE_MASK = 0x3FFF
+PHASE_INSTANT = 0x0000
+PHASE_BEGIN = 0x4000
+PHASE_END = 0x8000
+CODE_SYNC = 0x0000
+
+USB_MUX_TARGETS = {0: "ESP32S3", 1: "AGX", 2: "N305"}
+LED_STRIPS = {0: "board", 1: "touch"}
+
+ANSI_RE = re.compile(r"\x1b\[[0-9;]*m")
+
+
+def parse_dump(lines):
+    """返回 (version, cpu_mhz, names, {core: [record, ...]})，记录按时间从旧到新。"""
+    dump = None
+    current = None
+    for raw in lines:
+        line = ANSI_RE.sub("", raw).strip()
+        idx = line.find("TRACE ")
+        if idx < 0:
+            if current is not None and dump is not None and re.fullmatch(r"[0-9a-fA-F]+", line):
+                dump["cores"][current].extend(unpack_records(line))
+            continue
+        fields = line[idx:].split()
+        kind = fields[1] if len(fields) > 1 else ""
+        if kind == "BEGIN":
+            dump = {"version": int(fields[2]), "mhz": int(fields[4]), "names": {}, "cores": {}}
+            current = None
+        elif dump is None:
+            continue
+        elif kind == "NAME":
+            dump["names"][int(fields[2], 16)] = fields[3]
+        elif kind == "CORE":
+            current = int(fields[2])
+            dump["cores"][current] = []
+        elif kind == "END":
+            current = None
+    if dump is None:
+        raise ValueError("no TRACE BEGIN found in input")
+    return dump["version"], dump["mhz"], dump["names"], dump["cores"]
+
+
+def unpack_records(hex_line):
+    data = bytes.fromhex(hex_line)
+    records = []
+    for off in range(0, len(data) - RECORD_SIZE + 1, RECORD_SIZE):
+        stamp, event_id, arg0, arg1 = struct.unpack_from("<IHHI", data, off)
+        records.append((stamp, event_id, arg0, arg1))
+    return records
+
+
+def to_signed32(value):
+    value &= 0xFFFFFFFF
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def timestamp_records(records, default_mhz, version=2):
+    """按SYNC事件还原每条记录的完整时间 (us)，返回 [(us, id, arg0, arg1)]。"""
+    syncs = [(i, r) for i, r in enumerate(records)
+             if r[1] == (PHASE_INSTANT | CODE_SYNC)]
+    if not syncs:
+        return []
+    if version < 2:
+        return timestamp_cycles(records, syncs, default_mhz)
+
+    # 版本2: 记录为esp_timer低32位，SYNC的arg1为同一时刻的高32位
+    out = []
+    sync_idx = 0
+    for i, r in enumerate(records):
+        while sync_idx + 1 < len(syncs) and syncs[sync_idx + 1][0] <= i:
+            sync_idx += 1
+        _, sync = syncs[sync_idx]
+        us = ((sync[3] << 32) | sync[0]) + to_signed32(r[0] - sync[0])
+        out.append((us, r[1], r[2], r[3]))
+    return out
+
+
+def timestamp_cycles(records, syncs, default_mhz):
+    """版本1: 记录为所在核心的CPU周期，SYNC的arg1为esp_timer低32位。"""
+    # esp_timer 只导出了低32位，按顺序展开
+    sync_us = []
+    base = 0
+    prev = None
+    for _, r in syncs:
+        if prev is not None and r[3] < prev:
+            base += 1 << 32
+        prev = r[3]
+        sync_us.append(base + r[3])
+
+    out = []
+    sync_idx = 0
+    for i, r in enumerate(records):
+        while sync_idx + 1 < len(syncs) and syncs[sync_idx + 1][0] <= i:
+            sync_idx += 1
+        _, sync = syncs[sync_idx]
+        mhz = sync[2] or default_mhz
+        us = sync_us[sync_idx] + to_signed32(r[0] - sync[0]) / mhz
+        out.append((us, r[1], r[2], r[3]))
+    return out
+
+
+def unpack_str(value):
+    return struct.pack("<I", value).split(b"\0", 1)[0].decode("ascii", "replace")
+
+
+def event_args(code, name, arg0, arg1, phase):
+    if name == "power_pulse":
+        return {"gpio": arg0, "pulse_ms": arg1}
+    if name == "usb_mux":
+        return {"target": USB_MUX_TARGETS.get(arg0, arg0)}
+    if name == "led_refresh":
+        return {"strip": LED_STRIPS.get(arg0, arg0), "leds": arg1}
+    if name == "fan_set":
+        return {"speed": arg0}
+    if name == "console_cmd":
+        args = {"cmd": unpack_str(arg1)}
+        if phase == PHASE_END:
+            args["ret"] = arg0 - 0x10000 if arg0 & 0x8000 else arg0
+        return args
+    if name == "console_rpc":
+        if phase == PHASE_BEGIN:
+            return {"msg": "0x%02x" % arg0, "seq": arg1}
+        return {"status": arg0 - 0x10000 if arg0 & 0x8000 else arg0, "seq": arg1}
+    if name == "orin_recovery":
+        return {"result": arg1} if phase == PHASE_END else {}
+    if name == "monitor_cycle":
+        if phase == PHASE_BEGIN:
+            return {"wake": "timer" if arg0 == 0 else "event 0x%x" % arg0}
+        return {"free_heap": arg1}
+    if name == "boot_phase":
+        return {"index": arg0}
+    return {"arg0": arg0, "arg1": arg1}
+
+
+def build_trace(mhz, names, cores, show_sync=False, version=2):
+    events = []
+    for core, records in sorted(cores.items()):
+        for us, event_id, arg0, arg1 in timestamp_records(records, mhz, version):
+            events.append((us, core, event_id, arg0, arg1))
+    events.sort(key=lambda e: e[0])
+
+    trace = []
+    open_spans = {}
+    end_us = events[-1][0] if events else 0
+
+    for us, core, event_id, arg0, arg1 in events:
+        code = event_id & CODE_MASK
+        phase = event_id & PHASE_MASK
+        if code == CODE_SYNC and not show_sync:
+            continue
+        name = names.get(code, "event_%04x" % code)
+        args = event_args(code, name, arg0, arg1, phase)
+
+        if phase == PHASE_BEGIN:
+            open_spans.setdefault(code, []).append((us, core, name, args))
+        elif phase == PHASE_END and open_spans.get(code):
+            # 同一事件码按后进先出配对，支持嵌套（如恢复模式中的复位脉冲）
+            begin_us, begin_core, _, begin_args = open_spans[code].pop()
+            merged = dict(begin_args)
+            merged.update(args)
+            if core != begin_core:
+                merged["end_core"] = core
+            trace.append({"name": name, "ph": "X", "ts": begin_us, "dur": us - begin_us,
+                          "pid": 0, "tid": begin_core, "args": merged})
+        else:
+            trace.append({"name": name, "ph": "i", "s": "t", "ts": us,
+                          "pid": 0, "tid": core, "args": args})
+
+    for spans in open_spans.values():
+        for begin_us, begin_core, name, args in spans:
+            args = dict(args, incomplete=True)
+            trace.append({"name": name, "ph": "X", "ts": begin_us, "dur": end_us - begin_us,
+                          "pid": 0, "tid": begin_core, "args": args})
+
+    for core in sorted(cores):
+        trace.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": core,
+                      "args": {"name": "core %d" % core}})
+    trace.append({"name": "process_name", "ph": "M", "pid": 0,
+                  "args": {"name": "ESP32S3"}})
+    return trace
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode ESP32S3 event trace dump to Chrome trace JSON")
+    parser.add_argument("input", nargs="?", help="serial log containing 'trace dump' output (default: stdin)")
+    parser.add_argument("-o", "--output", help="output JSON file (default: stdout)")
+    parser.add_argument("--show-sync", action="store_true", help="include SYNC events in the timeline")
+    args = parser.parse_args()
+
+    with (open(args.input, encoding="utf-8", errors="replace") if args.input else sys.stdin) as f:
+        version, mhz, names, cores = parse_dump(f)
+
+    trace = build_trace(mhz, names, cores, args.show_sync, version)
+    output = json.dumps({"traceEvents": trace, "displayTimeUnit": "ms"}, ensure_ascii=False, indent=1)
+
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            f.write(output)
+        total = sum(len(r) for r in cores.values())
+        print("decoded %d records from %d cores -> %s" % (total, len(cores), args.output), file=sys.stderr)
+    else:
+        print(output)
+
+
+if __name__ == "__main__":
+    main()